@@ -0,0 +1,13 @@
+// Entry point of aleph3_bench. Results go to the console, or as JSON with
+// --benchmark_format=json, or to a file with --benchmark_out=<file> --benchmark_out_format=json.
+#include "evaluator/BuiltInFunctions.hpp"
+#include <benchmark/benchmark.h>
+
+int main(int argc, char** argv) {
+    aleph3::register_built_in_functions();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    // A fresh context per run, so definitions and caches do not carry over
+    ExprPtr run(const ExprPtr& expr) {
+        EvaluationContext ctx;
+        return evaluate(expr, ctx);
+    }
+
+    // 1 + x + 2*x + ... + n*x, which collects into one term
+    void BM_EvaluateFlatSum(benchmark::State& state) {
+        std::string source = "1";
+        for (int64_t i = 1; i <= state.range(0); ++i) source += " + " + std::to_string(i) + "*x";
+        const auto expr = parse_expression(source);
+        for (auto _ : state) benchmark::DoNotOptimize(run(expr));
+        state.SetComplexityN(state.range(0));
+    }
+
+    // x + (x + (x + ... )), nested n deep
+    void BM_EvaluateNestedSum(benchmark::State& state) {
+        std::string source;
+        for (int64_t i = 0; i < state.range(0); ++i) source += "x + (";
+        source += "1" + std::string(static_cast<size_t>(state.range(0)), ')');
+        const auto expr = parse_expression(source);
+        for (auto _ : state) benchmark::DoNotOptimize(run(expr));
+    }
+
+    // Doubly recursive user function, with no memoization
+    void BM_Fibonacci(benchmark::State& state) {
+        const auto definition = parse_expression("fib[n_] := If[n < 2, n, fib[n - 1] + fib[n - 2]]");
+        const auto call = parse_expression("fib[" + std::to_string(state.range(0)) + "]");
+        for (auto _ : state) {
+            EvaluationContext ctx;
+            evaluate(definition, ctx);
+            benchmark::DoNotOptimize(evaluate(call, ctx));
+        }
+    }
+
+    // Listable arithmetic over whole lists
+    void BM_ListableArithmetic(benchmark::State& state) {
+        const auto n = std::to_string(state.range(0));
+        const auto expr = parse_expression("2*Range[" + n + "] + Range[" + n + "]^2 - 1");
+        for (auto _ : state) benchmark::DoNotOptimize(run(expr));
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(BM_EvaluateFlatSum)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK(BM_EvaluateNestedSum)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Fibonacci)->Arg(15)->Arg(20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ListableArithmetic)->Arg(1000)->Arg(1000000)->Unit(benchmark::kMillisecond);
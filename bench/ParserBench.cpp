@@ -0,0 +1,41 @@
+#include "parser/Parser.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    // c1*x1^2 + c2*x2^2 + ... with n terms
+    std::string long_sum(int64_t n) {
+        std::string source;
+        for (int64_t i = 1; i <= n; ++i) {
+            if (i > 1) source += " + ";
+            source += std::to_string(i) + "*x" + std::to_string(i) + "^2";
+        }
+        return source;
+    }
+
+    // f[f[...f[x, 1]..., n - 1], n]
+    std::string nested_calls(int64_t n) {
+        std::string source;
+        for (int64_t i = 0; i < n; ++i) source += "f[";
+        source += "x";
+        for (int64_t i = 1; i <= n; ++i) source += ", " + std::to_string(i) + "]";
+        return source;
+    }
+
+    void BM_ParseLongSum(benchmark::State& state) {
+        const auto source = long_sum(state.range(0));
+        for (auto _ : state) benchmark::DoNotOptimize(parse_expression(source));
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+    }
+
+    void BM_ParseNestedCalls(benchmark::State& state) {
+        const auto source = nested_calls(state.range(0));
+        for (auto _ : state) benchmark::DoNotOptimize(parse_expression(source));
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+    }
+}
+
+BENCHMARK(BM_ParseLongSum)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseNestedCalls)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
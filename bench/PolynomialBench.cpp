@@ -0,0 +1,103 @@
+#include "algebra/PolyUtils.hpp"
+#include "algebra/Polynomial.hpp"
+#include "algebra/PolynomialGcd.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    IntegerPolynomial integer(const std::string& source, const std::vector<std::string>& variables) {
+        return expr_to_polynomial<IntegerRing>(run(source), variables);
+    }
+
+    const std::vector<std::string> XYZT{ "x", "y", "z", "t" };
+
+    // (1 + x + y + z + t)^n, the operands of Fateman's benchmark f * (f + 1)
+    IntegerPolynomial fateman(int64_t n) {
+        return integer("Expand[(1 + x + y + z + t)^" + std::to_string(n) + "]", XYZT);
+    }
+
+    void BM_FatemanProduct(benchmark::State& state) {
+        const auto f = fateman(state.range(0));
+        const auto g = f + IntegerPolynomial::constant(f.ring_ptr(), BigInt(1));
+        for (auto _ : state) benchmark::DoNotOptimize(f * g);
+        state.counters["terms"] = static_cast<double>((f * g).size());
+    }
+
+    // Every monomial of a box present
+    void BM_DenseProduct(benchmark::State& state) {
+        const std::vector<std::string> xy{ "x", "y" };
+        const auto n = std::to_string(state.range(0));
+        const auto a = integer("Expand[(1 + 2*x + 3*y + x*y)^" + n + "]", xy);
+        const auto b = integer("Expand[(5 + x - 7*y + x*y)^" + n + "]", xy);
+        for (auto _ : state) benchmark::DoNotOptimize(a * b);
+    }
+
+    // A few terms spread over a huge box
+    void BM_SparseProduct(benchmark::State& state) {
+        const auto n = std::to_string(state.range(0));
+        const auto a = integer("Expand[(1 + x^37*y + y^53*z^2 + z^71*t^5 + t^97)^" + n + "]", XYZT);
+        const auto b = integer("Expand[(3 + x^89 + y^29*t^3 + z^43 + x^11*t^61)^" + n + "]", XYZT);
+        for (auto _ : state) benchmark::DoNotOptimize(a * b);
+    }
+
+    // The map-based Polynomial on the smaller Fateman operands
+    void BM_MapPolynomialProduct(benchmark::State& state) {
+        const auto f = to_polynomial(fateman(state.range(0)));
+        const auto g = f + Polynomial(1.0);
+        for (auto _ : state) benchmark::DoNotOptimize(f * g);
+    }
+
+    // gcd(p q, p r) for dense multivariate cofactors
+    void BM_MultivariateGcd(benchmark::State& state) {
+        const std::vector<std::string> xyz{ "x", "y", "z" };
+        const auto n = std::to_string(state.range(0));
+        const auto p = integer("Expand[(1 + x + 2*y - z)^" + n + "]", xyz);
+        const auto q = integer("Expand[(3 - x*y + z^2)^" + n + "]", xyz);
+        const auto r = integer("Expand[(x - y + 5*z + 7)^" + n + "]", xyz);
+        const auto a = p * q, b = p * r;
+        for (auto _ : state) benchmark::DoNotOptimize(gcd(a, b));
+    }
+
+    void BM_UnivariateMapGcd(benchmark::State& state) {
+        const std::vector<std::string> x{ "x" };
+        const auto n = std::to_string(state.range(0));
+        const auto a = to_polynomial(integer("Expand[(x + 1)^" + n + "*(x - 2)]", x));
+        const auto b = to_polynomial(integer("Expand[(x + 1)^" + n + "*(x + 3)]", x));
+        for (auto _ : state) benchmark::DoNotOptimize(Polynomial::gcd(a, b, "x"));
+    }
+
+    void BM_Expand(benchmark::State& state) {
+        const auto expr = parse_expression("Expand[(1 + x + y + z)^" + std::to_string(state.range(0)) + "]");
+        for (auto _ : state) {
+            EvaluationContext ctx;
+            benchmark::DoNotOptimize(evaluate(expr, ctx));
+        }
+    }
+
+    void BM_Simplify(benchmark::State& state) {
+        const auto expr = parse_expression("Simplify[(x^2 - 1)/(x - 1) + Sin[y]^2 + Cos[y]^2 + (a + b)^2 - a^2 - 2*a*b]");
+        for (auto _ : state) {
+            EvaluationContext ctx;
+            benchmark::DoNotOptimize(evaluate(expr, ctx));
+        }
+    }
+}
+
+BENCHMARK(BM_FatemanProduct)->Arg(10)->Arg(20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DenseProduct)->Arg(10)->Arg(30)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SparseProduct)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MapPolynomialProduct)->Arg(5)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MultivariateGcd)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnivariateMapGcd)->Arg(5)->Arg(15)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Expand)->Arg(10)->Arg(30)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Simplify)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,29 @@
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    void BM_PrintExpansion(benchmark::State& state) {
+        EvaluationContext ctx;
+        const auto expr = evaluate(parse_expression("Expand[(1 + x + y + z)^" + std::to_string(state.range(0)) + "]"), ctx);
+        size_t bytes = 0;
+        for (auto _ : state) {
+            const auto text = to_string(expr);
+            bytes = text.size();
+            benchmark::DoNotOptimize(text.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    }
+
+    void BM_PrintList(benchmark::State& state) {
+        EvaluationContext ctx;
+        const auto expr = evaluate(parse_expression("Range[" + std::to_string(state.range(0)) + "]^2/7"), ctx);
+        for (auto _ : state) benchmark::DoNotOptimize(to_string(expr));
+    }
+}
+
+BENCHMARK(BM_PrintExpansion)->Arg(10)->Arg(30)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PrintList)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,201 @@
+/*
+ * Coefficients.hpp
+ * ----------------
+ * Coefficient domains for BasicSparsePolynomial. A domain is a small value type that adds,
+ * multiplies and tests its coefficients, so one term layout and one set of product
+ * algorithms serve every ring:
+ *
+ *   - RealField: doubles. Coefficients below 1e-10 count as zero, as in Polynomial.
+ *   - IntegerRing: BigInt, i.e. int64_t arithmetic that promotes to limbs on overflow.
+ *   - RationalField: Fractions of BigInts, reduced, with a positive denominator.
+ *   - ModularField: Z/pZ for an odd prime p < 2^63. Coefficients are stored in Montgomery
+ *     form (x * 2^64 mod p), so a product is one 64x64 -> 128-bit multiply and a REDC.
+ *     Integers coming in are reduced with a precomputed Barrett reciprocal.
+ *
+ * Besides value_type, every domain has zero(), one(), is_zero, add, sub, mul, neg, the
+ * conversions from_number (a double that must be integral outside RealField),
+ * from_rational and to_double, and operator== for "same ring". The fields also have
+ * inverse and divide.
+ */
+#pragma once
+
+#include "expr/BigInt.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace aleph3 {
+
+    class RealField {
+    public:
+        using value_type = double;
+        static constexpr double ZERO_TOLERANCE = 1e-10;
+
+        double zero() const { return 0.0; }
+        double one() const { return 1.0; }
+        bool is_zero(double a) const { return std::abs(a) < ZERO_TOLERANCE; }
+        double add(double a, double b) const { return a + b; }
+        double sub(double a, double b) const { return a - b; }
+        double mul(double a, double b) const { return a * b; }
+        double neg(double a) const { return -a; }
+        // Throws std::domain_error for a zero divisor
+        double inverse(double a) const;
+        double divide(double a, double b) const { return a * inverse(b); }
+
+        double from_number(double value) const { return value; }
+        double from_rational(const BigInt& num, const BigInt& den) const { return BigInt::ratio(num, den); }
+        double to_double(double a) const { return a; }
+
+        bool operator==(const RealField&) const { return true; }
+    };
+
+    class IntegerRing {
+    public:
+        using value_type = BigInt;
+
+        BigInt zero() const { return BigInt(0); }
+        BigInt one() const { return BigInt(1); }
+        bool is_zero(const BigInt& a) const { return a.is_zero(); }
+        BigInt add(const BigInt& a, const BigInt& b) const { return a + b; }
+        BigInt sub(const BigInt& a, const BigInt& b) const { return a - b; }
+        BigInt mul(const BigInt& a, const BigInt& b) const { return a * b; }
+        BigInt neg(const BigInt& a) const { return -a; }
+
+        // Both throw std::domain_error for values that are not integers
+        BigInt from_number(double value) const;
+        BigInt from_rational(const BigInt& num, const BigInt& den) const;
+        double to_double(const BigInt& a) const { return a.to_double(); }
+
+        bool operator==(const IntegerRing&) const { return true; }
+    };
+
+    // num / den in lowest terms with den > 0
+    struct Fraction {
+        BigInt num = 0;
+        BigInt den = 1;
+
+        friend bool operator==(const Fraction&, const Fraction&) = default;
+    };
+
+    class RationalField {
+    public:
+        using value_type = Fraction;
+
+        Fraction zero() const { return {}; }
+        Fraction one() const { return { 1, 1 }; }
+        bool is_zero(const Fraction& a) const { return a.num.is_zero(); }
+        Fraction add(const Fraction& a, const Fraction& b) const;
+        Fraction sub(const Fraction& a, const Fraction& b) const;
+        Fraction mul(const Fraction& a, const Fraction& b) const;
+        Fraction neg(const Fraction& a) const { return { -a.num, a.den }; }
+        // Throws std::domain_error for a zero divisor
+        Fraction inverse(const Fraction& a) const;
+        Fraction divide(const Fraction& a, const Fraction& b) const { return mul(a, inverse(b)); }
+
+        // Reduces num / den; throws std::domain_error for a non-integral double or den = 0
+        Fraction from_number(double value) const;
+        Fraction from_rational(const BigInt& num, const BigInt& den) const;
+        double to_double(const Fraction& a) const { return BigInt::ratio(a.num, a.den); }
+
+        bool operator==(const RationalField&) const { return true; }
+    };
+
+    namespace detail {
+        // hi:lo = a * b
+        inline void mul_wide(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo) {
+#if defined(__GNUC__) || defined(__clang__)
+            const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+            hi = static_cast<uint64_t>(p >> 64);
+            lo = static_cast<uint64_t>(p);
+#else
+            const uint64_t a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+            const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+            const uint64_t middle = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+            lo = (middle << 32) | (p00 & 0xffffffffu);
+            hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+#endif
+        }
+    }
+
+    class ModularField {
+    public:
+        using value_type = uint64_t;  // Montgomery form
+
+        // Largest prime below 2^63
+        static constexpr uint64_t DEFAULT_PRIME = 9223372036854775783ull;
+
+        // Throws std::invalid_argument unless p is an odd prime below 2^63
+        explicit ModularField(uint64_t p = DEFAULT_PRIME);
+
+        uint64_t modulus() const { return p_; }
+
+        // Deterministic for all n below 2^63; false above
+        static bool is_prime(uint64_t n);
+
+        uint64_t zero() const { return 0; }
+        uint64_t one() const { return one_; }
+        bool is_zero(uint64_t a) const { return a == 0; }
+        uint64_t add(uint64_t a, uint64_t b) const {
+            const uint64_t s = a + b;  // No wraparound: a, b < p < 2^63
+            return s >= p_ ? s - p_ : s;
+        }
+        uint64_t sub(uint64_t a, uint64_t b) const { return a >= b ? a - b : a + p_ - b; }
+        uint64_t neg(uint64_t a) const { return a == 0 ? 0 : p_ - a; }
+        uint64_t mul(uint64_t a, uint64_t b) const {
+            uint64_t hi, lo;
+            detail::mul_wide(a, b, hi, lo);
+            return redc(hi, lo);
+        }
+        // The Montgomery form of a sum of products of Montgomery-form values. Callers
+        // accumulate plain 64-bit products when they cannot overflow and reduce once.
+        uint64_t reduce_sum(uint64_t sum) const { return redc(0, sum); }
+        uint64_t pow(uint64_t a, uint64_t exponent) const;
+        // Throws std::domain_error for zero
+        uint64_t inverse(uint64_t a) const;
+        uint64_t divide(uint64_t a, uint64_t b) const { return mul(a, inverse(b)); }
+
+        // x mod p into Montgomery form and back to the representative in [0, p)
+        uint64_t from_uint(uint64_t x) const { return mul(barrett(x), r2_); }
+        uint64_t to_uint(uint64_t a) const { return redc(0, a); }
+
+        uint64_t from_integer(const BigInt& n) const;
+        // Throws std::domain_error for a non-integral double or a denominator divisible by p
+        uint64_t from_number(double value) const;
+        uint64_t from_rational(const BigInt& num, const BigInt& den) const;
+        double to_double(uint64_t a) const { return static_cast<double>(to_uint(a)); }
+
+        bool operator==(const ModularField& other) const { return p_ == other.p_; }
+
+    private:
+        struct Unchecked {};
+        ModularField(uint64_t p, Unchecked);
+        bool passes_miller_rabin() const;
+
+        uint64_t p_;
+        uint64_t p_neg_inv_;  // -p^-1 mod 2^64
+        uint64_t r2_;         // 2^128 mod p
+        uint64_t one_;        // 2^64 mod p
+        uint64_t barrett_;    // floor((2^64 - 1) / p)
+
+        // hi:lo * 2^-64 mod p, for hi:lo < p * 2^64
+        uint64_t redc(uint64_t hi, uint64_t lo) const {
+            uint64_t mp_hi, mp_lo;
+            detail::mul_wide(lo * p_neg_inv_, p_, mp_hi, mp_lo);
+            // lo + mp_lo is 0 mod 2^64 and carries exactly when lo != 0
+            const uint64_t t = hi + mp_hi + (lo != 0);
+            return t >= p_ ? t - p_ : t;
+        }
+
+        // x mod p
+        uint64_t barrett(uint64_t x) const {
+            uint64_t q, unused;
+            detail::mul_wide(x, barrett_, q, unused);
+            uint64_t r = x - q * p_;
+            while (r >= p_) r -= p_;
+            return r;
+        }
+    };
+
+} // namespace aleph3
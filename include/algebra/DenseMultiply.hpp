@@ -0,0 +1,46 @@
+/*
+ * DenseMultiply.hpp
+ * -----------------
+ * Products of dense univariate coefficient vectors, where c[k] is the coefficient of x^k.
+ * SparsePolynomial uses them after Kronecker substitution: a multivariate polynomial with
+ * a small exponent box maps to one univariate polynomial. Each variable becomes a digit of
+ * a mixed-radix power of x.
+ *
+ * The automatic method depends on the length of the shorter factor. Schoolbook is used
+ * below KARATSUBA_LENGTH, then Karatsuba, then Toom-3 from TOOM3_LENGTH. Past that a
+ * transform takes over:
+ *
+ *   - NTT from NTT_LENGTH when every coefficient is an integer and the result fits below
+ *     the bound the three NTT primes give. That is about 2^84 per coefficient, so the
+ *     result is exact wherever a double can hold it. Exact inputs shorter than that stay
+ *     on Toom-3, which is exact too.
+ *   - A double-precision complex FFT from FFT_LENGTH otherwise, with rounding error
+ *     relative to the largest coefficients.
+ *
+ * Very unbalanced factors are cut into pieces of the shorter length before Karatsuba or
+ * Toom-3.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aleph3::dense {
+
+    enum class Method : uint8_t { Automatic, Schoolbook, Karatsuba, Toom3, FFT, NTT };
+
+    inline constexpr size_t KARATSUBA_LENGTH = 32;
+    inline constexpr size_t TOOM3_LENGTH = 192;
+    inline constexpr size_t FFT_LENGTH = 512;
+    inline constexpr size_t NTT_LENGTH = 4096;
+
+    // a * b; empty if either factor is empty. Method::NTT throws std::domain_error when
+    // ntt_exact(a, b) is false.
+    std::vector<double> multiply(const std::vector<double>& a, const std::vector<double>& b,
+                                 Method method = Method::Automatic);
+
+    // True if the coefficients are integers and the exact product is within the NTT bound
+    bool ntt_exact(const std::vector<double>& a, const std::vector<double>& b);
+
+} // namespace aleph3::dense
@@ -0,0 +1,67 @@
+/*
+ * Groebner.hpp
+ * ------------
+ * Multivariate division and Groebner bases over a coefficient field, with respect to a
+ * monomial order.
+ *
+ * Terms of a BasicSparsePolynomial are kept in the ring's lexicographic order. The other
+ * orders compare total degree first, then either lexicographically (DegreeLexicographic) or
+ * by the smaller exponent of the last variable where they differ (DegreeReverseLexicographic).
+ * The algorithms here sort the terms they work on by the order that was asked for.
+ *
+ * reduce() is the division algorithm: f = sum q_i g_i + r, where no term of r is divisible
+ * by the leading monomial of any g_i. Each leading term of f is divided by the first g_i
+ * that divides it.
+ *
+ * groebner_basis() is Faugere's F4. Each round takes the critical pairs of lowest degree
+ * (the normal strategy). Their two halves, m/lm(f) * f and m/lm(g) * g for the lcm m, go
+ * into a matrix. Symbolic preprocessing then adds a multiple of a basis element for every
+ * monomial of the matrix that some leading monomial divides. Columns are the matrix's
+ * monomials in decreasing order and rows are sparse. The first row with each leading column
+ * is a pivot. Every other row is reduced by the pivots alone, independently of the others,
+ * on the ThreadPool. The remainders are then put in echelon form among themselves. The
+ * nonzero rows that come out have new leading monomials and join the basis. Pairs are
+ * pruned with the Gebauer-Moeller criteria. The result is the reduced basis: monic, each
+ * tail reduced by the others, sorted by increasing leading monomial.
+ */
+#pragma once
+
+#include "algebra/SparsePolynomial.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace aleph3 {
+
+    enum class MonomialOrder : uint8_t { Lexicographic, DegreeLexicographic, DegreeReverseLexicographic };
+
+    // The order as the MonomialOrder option names it, or nullopt
+    std::optional<MonomialOrder> monomial_order_named(std::string_view name);
+
+    // Whether a comes after b in `order`
+    bool monomial_greater(const PolynomialRing& ring, MonomialOrder order, const Exponents& a, const Exponents& b);
+
+    // Largest monomial of a nonzero p in `order`
+    template <class Domain>
+    Exponents leading_monomial(const BasicSparsePolynomial<Domain>& p, MonomialOrder order);
+
+    template <class Domain>
+    struct Reduction {
+        std::vector<BasicSparsePolynomial<Domain>> quotients;  // One per divisor
+        BasicSparsePolynomial<Domain> remainder;
+    };
+
+    // f divided by the divisors. Throws std::domain_error if a divisor is zero and
+    // std::invalid_argument unless all polynomials share a ring.
+    template <class Domain>
+    Reduction<Domain> reduce(const BasicSparsePolynomial<Domain>& f, const std::vector<BasicSparsePolynomial<Domain>>& divisors,
+                             MonomialOrder order);
+
+    // The reduced Groebner basis of the ideal of `generators`; {} for the zero ideal
+    template <class Domain>
+    std::vector<BasicSparsePolynomial<Domain>> groebner_basis(const std::vector<BasicSparsePolynomial<Domain>>& generators,
+                                                              MonomialOrder order);
+
+} // namespace aleph3
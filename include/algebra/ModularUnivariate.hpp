@@ -0,0 +1,52 @@
+/*
+ * ModularUnivariate.hpp
+ * ---------------------
+ * Dense univariate polynomials over Z/pZ for the modular GCD and factorization code,
+ * where a[k] is the coefficient of x^k in the ModularField's Montgomery form. Results are
+ * trimmed, so the zero polynomial is empty and a.back() is the leading coefficient.
+ *
+ * Products of long operands go through dense::multiply while the representatives are
+ * small enough for its double-precision kernels to stay exact. Otherwise, and for short
+ * operands, they use schoolbook multiplication. For primes below 2^32, schoolbook products
+ * and remainders add up plain 64-bit products and make one Montgomery reduction per
+ * coefficient, while the sums cannot overflow.
+ */
+#pragma once
+
+#include "algebra/Coefficients.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aleph3::modular {
+
+    using Poly = std::vector<uint64_t>;
+
+    void trim(Poly& a);
+
+    // Degree of a non-zero polynomial
+    inline size_t degree(const Poly& a) { return a.size() - 1; }
+
+    Poly add(const ModularField& field, const Poly& a, const Poly& b);
+    Poly sub(const ModularField& field, const Poly& a, const Poly& b);
+    Poly mul(const ModularField& field, const Poly& a, const Poly& b);
+    Poly scale(const ModularField& field, Poly a, uint64_t factor);
+
+    // Quotient and remainder; throws std::domain_error if b is zero
+    std::pair<Poly, Poly> divmod(const ModularField& field, const Poly& a, const Poly& b);
+    Poly rem(const ModularField& field, Poly a, const Poly& b);
+
+    Poly monic(const ModularField& field, Poly a);
+    // Monic; gcd(0, 0) = 0
+    Poly gcd(const ModularField& field, Poly a, Poly b);
+    // Monic g = s * a + t * b, with deg s < deg b and deg t < deg a when both exceed g
+    Poly extended_gcd(const ModularField& field, const Poly& a, const Poly& b, Poly& s, Poly& t);
+
+    uint64_t evaluate(const ModularField& field, const Poly& a, uint64_t x);
+    Poly derivative(const ModularField& field, const Poly& a);
+    // base^exponent mod m, by repeated squaring
+    Poly powmod(const ModularField& field, Poly base, uint64_t exponent, const Poly& m);
+
+} // namespace aleph3::modular
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "Polynomial.hpp"
+#include "SparsePolynomial.hpp"
+#include "Groebner.hpp"
 #include "expr/Expr.hpp"
 #include "evaluator/EvaluationContext.hpp"
+#include <cstdint>
 #include <vector>
 #include <utility>
+#include <variant>
 #include <stdexcept>
 #include <string>
 
@@ -14,9 +18,43 @@ namespace aleph3 {
     // For multivariate polynomials, variable list may be inferred or passed as argument if needed
     ExprPtr expand_polynomial(const ExprPtr& expr, EvaluationContext& ctx);
     ExprPtr factor_polynomial(const ExprPtr& expr, EvaluationContext& ctx);
+    // expr as a sum over the powers of variables[0], whose coefficients are collected in
+    // variables[1], and so on; the innermost coefficients are polynomials in the other symbols
     ExprPtr collect_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, EvaluationContext& ctx);
+    // Coefficient of the monomial prod variables[i]^exponents[i] in expr, the other symbols
+    // being free
+    ExprPtr coefficient_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables,
+                                   const std::vector<uint32_t>& exponents, EvaluationContext& ctx);
+    // Nested lists of the coefficients of expr, indexed by the exponent of each variable from
+    // 0 to its degree; {} for 0. The lists are List calls, for the evaluator to pack.
+    ExprPtr coefficient_list_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, EvaluationContext& ctx);
+    // Largest exponent of `variable` in expr, or -Infinity for 0
+    ExprPtr exponent_polynomial(const ExprPtr& expr, const std::string& variable, EvaluationContext& ctx);
     ExprPtr gcd_polynomial(const ExprPtr& a, const ExprPtr& b, const std::vector<std::string>& variables, EvaluationContext& ctx);
     std::pair<ExprPtr, ExprPtr> divide_polynomial(const ExprPtr& dividend, const ExprPtr& divisor, const std::vector<std::string>& variables, EvaluationContext& ctx);
+    // Reduced Groebner basis of the polynomials in `variables`, as a List call: over Q, each
+    // element scaled to a primitive integer polynomial with a positive leading coefficient,
+    // or over Z/pZ for a nonzero modulus p, each element monic
+    ExprPtr groebner_basis_polynomial(const std::vector<ExprPtr>& polys, const std::vector<std::string>& variables,
+                                      MonomialOrder order, uint64_t modulus, EvaluationContext& ctx);
+    // {{q1, q2, ...}, r} with f = q1 g1 + q2 g2 + ... + r and no term of r divisible by a
+    // leading monomial of the divisors, as List calls; over Q or Z/pZ as for GroebnerBasis
+    ExprPtr reduce_polynomial(const ExprPtr& f, const std::vector<ExprPtr>& divisors, const std::vector<std::string>& variables,
+                              MonomialOrder order, uint64_t modulus, EvaluationContext& ctx);
+    // Res_x(a, b), Discriminant_x(f) and the principal subresultant coefficients
+    // {psc_0, ..., psc_n} of a and b in x, as a List call. Coefficients must be exact;
+    // rational ones are scaled to integers and the results scaled back.
+    ExprPtr resultant_polynomial(const ExprPtr& a, const ExprPtr& b, const std::string& variable, EvaluationContext& ctx);
+    ExprPtr discriminant_polynomial(const ExprPtr& f, const std::string& variable, EvaluationContext& ctx);
+    ExprPtr subresultants_polynomial(const ExprPtr& a, const ExprPtr& b, const std::string& variable, EvaluationContext& ctx);
+    // expr as one fraction num / den of expanded polynomials in its symbols, with no common
+    // factor; Cancel does the same for each summand of a sum on its own. Coefficients must be
+    // exact and exponents integers.
+    ExprPtr together_polynomial(const ExprPtr& expr, EvaluationContext& ctx);
+    ExprPtr cancel_polynomial(const ExprPtr& expr, EvaluationContext& ctx);
+    // Values of expr at each point, as reals: points is a list (or packed array) of numbers for
+    // one variable, or of coordinate lists in the order of `variables`
+    ExprPtr evaluate_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, const ExprPtr& points, EvaluationContext& ctx);
 
     // Low-level API: operate directly on Polynomial objects
     Polynomial expand(const Polynomial& poly);
@@ -25,8 +63,30 @@ namespace aleph3 {
     Polynomial gcd(const Polynomial& a, const Polynomial& b, const std::vector<std::string>& variables);
     std::pair<Polynomial, Polynomial> divide(const Polynomial& dividend, const Polynomial& divisor, const std::vector<std::string>& variables);
 
-    // Conversion utilities
-    Polynomial expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables);
+    // A polynomial over the coefficient ring its input needs
+    using AnyPolynomial = std::variant<IntegerPolynomial, RationalPolynomial, SparsePolynomial>;
+
+    // Conversion utilities. expr_to_polynomial expands sums and products into the ring of
+    // `variables` (in that order), and throws for anything that is not a polynomial in them.
+    // Without a domain it picks the ring from the input: integers stay in IntegerPolynomial,
+    // Rationals in RationalPolynomial, and any other Number makes the polynomial real.
+    AnyPolynomial expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables);
+    template <class Domain>
+    BasicSparsePolynomial<Domain> expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables,
+                                                     Domain domain = Domain());
+
+    // Integer and modular coefficients become Numbers, exact fractions Rationals
+    template <class Domain>
+    ExprPtr polynomial_to_expr(const BasicSparsePolynomial<Domain>& poly);
+    ExprPtr polynomial_to_expr(const AnyPolynomial& poly);
     ExprPtr polynomial_to_expr(const Polynomial& poly);
 
+    // The map-based Polynomial with the nearest double coefficients
+    template <class Domain>
+    Polynomial to_polynomial(const BasicSparsePolynomial<Domain>& poly);
+    Polynomial to_polynomial(const AnyPolynomial& poly);
+
+    // Sorted names of all symbols in expr; shared subtrees are visited once
+    std::vector<std::string> infer_variables(const ExprPtr& expr);
+
 } // namespace aleph3
\ No newline at end of file
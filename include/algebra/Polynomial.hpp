@@ -49,15 +49,26 @@ namespace aleph3 {
         // Normalize the polynomial by removing zero coefficients
         void normalize();
 
-        // Polynomial addition
-        Polynomial operator+(const Polynomial& other) const;
+        // Polynomial addition; a temporary left operand is updated in place
+        Polynomial operator+(const Polynomial& other) const&;
+        Polynomial operator+(const Polynomial& other) &&;
 
         // Polynomial subtraction
-        Polynomial operator-(const Polynomial& other) const;
+        Polynomial operator-(const Polynomial& other) const&;
+        Polynomial operator-(const Polynomial& other) &&;
 
         // Polynomial multiplication
         Polynomial operator*(const Polynomial& other) const;
 
+        // In-place arithmetic. These touch only the monomials of the other operand and
+        // drop the ones that cancel, instead of rescanning every term.
+        Polynomial& operator+=(const Polynomial& other);
+        Polynomial& operator-=(const Polynomial& other);
+        Polynomial& operator*=(const Polynomial& other);
+
+        // *this += a * b, accumulating each product of terms straight into this polynomial
+        Polynomial& addmul(const Polynomial& a, const Polynomial& b);
+
         // Polynomial division (returns quotient and remainder)
         std::pair<Polynomial, Polynomial> divide(const Polynomial& divisor) const;
 
@@ -0,0 +1,38 @@
+/*
+ * PolynomialCoefficients.hpp
+ * --------------------------
+ * A packed polynomial viewed in its first variables (the main variables), with the
+ * coefficients polynomials in the rest: the layout behind Collect, Coefficient,
+ * CoefficientList and Exponent.
+ *
+ * The main variables lead the ring, so they hold the most significant exponent fields and
+ * the terms, sorted by decreasing monomial, are already grouped by their main exponents. The
+ * relayout is then one pass over the terms, after the O(n log n) sort that built the
+ * polynomial. Each group is made of consecutive terms with the main exponents cleared,
+ * which keeps them sorted.
+ *
+ * Example: in the ring (x, a, b) with one main variable, a*x^2 + b*x^2 + x + 3 is the groups
+ *   { {2}: a + b, {1}: 1, {0}: 3 }
+ */
+#pragma once
+
+#include "algebra/SparsePolynomial.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace aleph3 {
+
+    template <class Domain>
+    struct CoefficientGroup {
+        std::vector<uint32_t> exponents;           // Of the main variables
+        BasicSparsePolynomial<Domain> coefficient;  // In the same ring, free of the main variables
+    };
+
+    // The groups of poly by the exponents of its first `main` variables, in decreasing
+    // lexicographic order of those exponents. Throws std::invalid_argument if `main` is
+    // larger than the ring.
+    template <class Domain>
+    std::vector<CoefficientGroup<Domain>> group_by_main_variables(const BasicSparsePolynomial<Domain>& poly, size_t main);
+
+} // namespace aleph3
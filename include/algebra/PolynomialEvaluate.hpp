@@ -0,0 +1,93 @@
+/*
+ * PolynomialEvaluate.hpp
+ * ----------------------
+ * Compiled form of a polynomial for evaluation at many points.
+ *
+ * The polynomial is nested by the ring's variable order: a polynomial in x_1 whose
+ * coefficients are polynomials in x_2, and so on. The result is compiled into a short
+ * program of multivariate Horner steps. Each step is r = r * x_v^gap + c, where c is a
+ * constant or an inner Horner result, and the gaps come from the exponents that are
+ * present. Only the powers the program uses are tabulated.
+ *
+ * Points are evaluated in blocks of LANES. Each register holds one value per point of the
+ * block, and the power tables are built once per block. The block loop is a plain loop over
+ * the lanes, compiled for AVX-512, AVX2 and baseline SSE2 and picked at load time like
+ * VectorKernels. Batches of at least PARALLEL_POINTS points run on the ThreadPool.
+ *
+ * A dense univariate polynomial of degree at least SPLIT_DEGREE, evaluated at fewer points
+ * than a block holds, uses a second-order Horner scheme instead:
+ *   p(x) = sum over r < LANES of x^r * q_r(x^LANES)
+ * with all the q_r evaluated together, one per lane. A subproduct-tree multipoint
+ * evaluation would be faster asymptotically, but in double precision its remainders
+ * lose all accuracy well before the degrees where it pays off.
+ */
+#pragma once
+
+#include "algebra/Polynomial.hpp"
+#include "algebra/SparsePolynomial.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aleph3 {
+
+    class CompiledPolynomial {
+    public:
+        // Points per block
+        static constexpr size_t LANES = 16;
+        static constexpr size_t PARALLEL_POINTS = size_t(1) << 14;
+        static constexpr uint32_t SPLIT_DEGREE = 256;
+
+        explicit CompiledPolynomial(const SparsePolynomial& p);
+        // Throws std::invalid_argument if p has a variable that is not in `variables`
+        CompiledPolynomial(const Polynomial& p, const std::vector<std::string>& variables);
+
+        // Coordinates per point
+        size_t variables() const { return variables_; }
+
+        // p at one point with variables() coordinates
+        double operator()(const double* point) const;
+
+        // values[i] = p(points + i * variables()) for `count` points stored row-major
+        void evaluate(const double* points, size_t count, double* values) const;
+        std::vector<double> evaluate(const std::vector<double>& points) const;
+
+        // Horner steps on registers of LANES values; r is the register a step writes
+        struct Step {
+            enum class Op : uint8_t {
+                Constant,        // r = c
+                MulAddConstant,  // r = r * power + c
+                MulAdd,          // r = r * power + (r + 1)
+                Multiply         // r = r * power
+            } op;
+            uint8_t r;
+            uint32_t power;      // Index into the power table
+            double c;
+        };
+
+        // x_variable^exponent, one table entry per block
+        struct Power {
+            uint32_t variable;
+            uint32_t exponent;
+
+            friend auto operator<=>(const Power&, const Power&) = default;
+            friend bool operator==(const Power&, const Power&) = default;
+        };
+
+    private:
+        size_t variables_ = 0;
+        size_t registers_ = 1;
+        std::vector<Step> program_;
+        std::vector<Power> powers_;  // Sorted by variable, then exponent
+        // Coefficients of 1, x, x^2, ... for the second-order Horner scheme; empty unless
+        // the polynomial is univariate, dense and of degree at least SPLIT_DEGREE
+        std::vector<double> dense_;
+
+        void compile(const SparsePolynomial& p);
+        void evaluate_blocks(const double* points, size_t count, double* values) const;
+        double evaluate_split(double x) const;
+    };
+
+} // namespace aleph3
@@ -0,0 +1,63 @@
+/*
+ * PolynomialFactor.hpp
+ * --------------------
+ * Factorization of integer polynomials into irreducibles over Z.
+ *
+ * The pipeline, for a primitive polynomial:
+ *
+ *   1. Content and primitive part. The integer content becomes the unit. Then, for one
+ *      variable x, the content in x (the gcd of the coefficients of the powers of x),
+ *      which is factored recursively in the remaining variables.
+ *   2. Square-free decomposition by Yun's algorithm with respect to x, using the modular
+ *      GCD.
+ *   3. For each square-free univariate part, factorization modulo a few small primes:
+ *      distinct-degree factorization, then Cantor-Zassenhaus equal-degree splitting. Both
+ *      raise to the p-th power with a precomputed Frobenius matrix. The prime with the
+ *      fewest modular factors is kept.
+ *   4. Quadratic Hensel lifting of those factors along a balanced factor tree, up to a
+ *      power of p beyond twice the leading coefficient times the Mignotte bound.
+ *   5. Zassenhaus recombination. Subsets of the lifted factors, smallest first, are
+ *      multiplied, scaled by the leading coefficient and tested by exact division. A
+ *      constant-term divisibility test rules out most subsets cheaply.
+ *
+ * Multivariate square-free parts reduce to the univariate case by Kronecker substitution
+ * x_i -> t^(D_0 * ... * D_(i-1)), with D_i one more than the degree in x_i. The
+ * substitution is a ring homomorphism, so every true factor maps to a product of the
+ * image's factors. Those products are mapped back and tested by exact division.
+ */
+#pragma once
+
+#include "algebra/ModularUnivariate.hpp"
+#include "algebra/SparsePolynomial.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    // p = unit * product of factors[i].first ^ factors[i].second
+    struct Factorization {
+        BigInt unit = 1;
+        // Irreducible, primitive, with a positive leading coefficient; ordered by total
+        // degree, then lexicographically
+        std::vector<std::pair<IntegerPolynomial, uint32_t>> factors;
+    };
+
+    // Largest degree of a Kronecker image
+    inline constexpr uint32_t MAX_KRONECKER_DEGREE = 1u << 16;
+
+    // Complete factorization over Z; factor(0) has unit 0 and no factors. Throws
+    // std::runtime_error if a Kronecker image would pass MAX_KRONECKER_DEGREE.
+    Factorization factor(const IntegerPolynomial& p);
+
+    // Pairwise coprime square-free parts, with the content as the unit. The decomposition
+    // is with respect to the first variable p depends on; p's content in that variable is
+    // decomposed recursively.
+    Factorization square_free(const IntegerPolynomial& p);
+
+    // Monic irreducible factors of a monic square-free polynomial over Z/pZ, ordered by
+    // degree. Throws std::domain_error for a polynomial that is not monic.
+    std::vector<modular::Poly> factor_modular(const ModularField& field, const modular::Poly& f);
+
+} // namespace aleph3
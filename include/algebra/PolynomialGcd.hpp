@@ -0,0 +1,48 @@
+/*
+ * PolynomialGcd.hpp
+ * -----------------
+ * Greatest common divisors of multivariate polynomials by modular reduction, with Brown's
+ * dense algorithm.
+ *
+ * Over Z the two inputs are reduced modulo word-sized primes. The gcd of each image is
+ * computed in Z/pZ and scaled by gcd(lc(a), lc(b)) mod p. The scaled images are then
+ * combined by the Chinese remainder theorem. Once another prime no longer changes the
+ * result, its primitive part is checked by exact division, and the loop stops if it
+ * divides both inputs. Primes that yield a larger leading monomial are unlucky and are
+ * skipped. A prime with a smaller one discards every image so far. The images for a batch
+ * of primes are independent, so they run on the ThreadPool, one prime per chunk.
+ *
+ * In Z/pZ the last variable is eliminated by evaluation. The gcd in the remaining
+ * variables is computed recursively and then rebuilt by Newton interpolation. Contents and
+ * leading coefficients in that variable are handled as univariate gcds.
+ */
+#pragma once
+
+#include "algebra/SparsePolynomial.hpp"
+
+#include <optional>
+
+namespace aleph3 {
+
+    // Monic in the ring's lex order; gcd(0, 0) = 0
+    ModularPolynomial gcd(const ModularPolynomial& a, const ModularPolynomial& b);
+
+    // With a positive leading coefficient; its integer content is the gcd of the contents
+    IntegerPolynomial gcd(const IntegerPolynomial& a, const IntegerPolynomial& b);
+
+    // a / b when b divides a exactly (over Z, with integer coefficients), else nullopt.
+    // Throws std::domain_error if b is zero.
+    template <class Domain>
+    std::optional<BasicSparsePolynomial<Domain>> divide_exact(const BasicSparsePolynomial<Domain>& a,
+                                                              const BasicSparsePolynomial<Domain>& b);
+
+    // Non-negative gcd of the coefficients, and p divided by it with a positive leading coefficient
+    BigInt content(const IntegerPolynomial& p);
+    IntegerPolynomial primitive_part(const IntegerPolynomial& p);
+
+    // The primes used for modular images: the largest primes below 2^62, in decreasing order
+    uint64_t modular_prime(size_t index);
+    // The field of modular_prime(index), whose primality is checked only the first time
+    ModularField modular_field(size_t index);
+
+} // namespace aleph3
@@ -0,0 +1,75 @@
+/*
+ * RationalFunction.hpp
+ * --------------------
+ * Quotients of integer polynomials sharing one ring, so one variable ordering.
+ *
+ * Arithmetic follows Henrici: it cancels only gcds of the smaller parts, never the full
+ * gcd of the numerator and denominator of the result. For reduced a/b and c/d:
+ * - a/b * c/d = (a/g1 * c/g2) / (b/g2 * d/g1) with g1 = gcd(a, d) and g2 = gcd(c, b),
+ *   which is reduced again
+ * - a/b + c/d = (a d' + c b') / (b' d) with g = gcd(b, d), b = b' g and d = d' g. Any
+ *   common factor of the sum with its denominator divides g. Cancelling it is deferred,
+ *   so the result is marked unreduced unless g is a constant.
+ * Products of unreduced operands are valid but may be unreduced too. When both
+ * denominators are constants there are no gcds to take at all.
+ *
+ * normalize() cancels the full gcd, the common integer content too, and gives the
+ * denominator a positive leading coefficient. Together and Cancel call it explicitly.
+ * Otherwise an unreduced result normalizes itself once it has more than
+ * RATIONAL_NORMALIZE_TERMS terms and twice as many as after its last normalization, so
+ * the full gcds stay amortized over a long chain of additions.
+ */
+#pragma once
+
+#include "algebra/SparsePolynomial.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aleph3 {
+
+    inline constexpr size_t RATIONAL_NORMALIZE_TERMS = 64;
+
+    class RationalFunction {
+    public:
+        // numerator / denominator. Throws std::domain_error if the denominator is zero and
+        // std::invalid_argument unless both share a ring.
+        RationalFunction(IntegerPolynomial numerator, IntegerPolynomial denominator);
+        // p / 1
+        explicit RationalFunction(IntegerPolynomial p);
+
+        const IntegerPolynomial& numerator() const { return num_; }
+        const IntegerPolynomial& denominator() const { return den_; }
+        const std::shared_ptr<const PolynomialRing>& ring_ptr() const { return num_.ring_ptr(); }
+
+        bool is_zero() const { return num_.is_zero(); }
+        // Whether the numerator and denominator are known to be coprime
+        bool is_reduced() const { return reduced_; }
+        // Terms of the numerator and denominator together
+        size_t size() const { return num_.size() + den_.size(); }
+
+        RationalFunction& normalize();
+
+        RationalFunction operator+(const RationalFunction& other) const;
+        RationalFunction operator-(const RationalFunction& other) const;
+        RationalFunction operator*(const RationalFunction& other) const;
+        // Throws std::domain_error if other is zero
+        RationalFunction operator/(const RationalFunction& other) const;
+        RationalFunction operator-() const;
+
+        // Throws std::domain_error for a negative power of zero
+        friend RationalFunction power(const RationalFunction& base, int64_t exponent);
+
+    private:
+        IntegerPolynomial num_;
+        IntegerPolynomial den_;
+        bool reduced_ = false;
+        size_t settled_ = 0;  // size() after the last normalization
+
+        RationalFunction(IntegerPolynomial numerator, IntegerPolynomial denominator, bool reduced, size_t settled);
+        // Normalizes an unreduced result once it has grown enough
+        RationalFunction& settle();
+        void make_leading_positive();
+    };
+
+} // namespace aleph3
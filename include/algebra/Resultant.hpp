@@ -0,0 +1,62 @@
+/*
+ * Resultant.hpp
+ * -------------
+ * Resultants, discriminants and principal subresultant coefficients of polynomials over Z
+ * and Z/pZ, with respect to one variable x_v of their ring. The other variables make up
+ * the coefficient ring D, and results keep the ring with x_v absent.
+ *
+ * The subresultant pseudo-remainder sequence (Cohen, Algorithm 3.3.7) works in D[x_v].
+ * Each pseudo-remainder is divided exactly by g h^delta, which keeps the coefficients the
+ * size of minors of the Sylvester matrix instead of letting them grow exponentially. With
+ * D = Z the coefficients are plain BigInts, and that is the fastest way for low degrees.
+ *
+ * The modular algorithm reduces the inputs modulo word-sized primes, enough of them to
+ * pass twice the bound |a|_1^deg(b) |b|_1^deg(a) on the result's coefficients, and
+ * combines the images by the Chinese remainder theorem. A batch of primes runs on the
+ * ThreadPool, one prime per chunk. Primes that divide a leading coefficient in x_v are
+ * skipped. In Z/pZ the inputs are dense arrays. The last other variable x_w is evaluated
+ * at enough points to cover its degree in the result, deg_v(b) deg_w(a) + deg_v(a)
+ * deg_w(b); points where a leading coefficient in x_v vanishes are skipped. Each
+ * evaluation recurses on the remaining variables, and the values are rebuilt by Newton
+ * interpolation. Once only x_v is left, the resultant is a Euclidean remainder sequence.
+ *
+ * The j-th principal subresultant coefficient psc_j is the determinant of the rows
+ * x_v^k a for k < deg(b) - j and x_v^k b for k < deg(a) - j of the Sylvester matrix,
+ * restricted to the columns of x_v^j and above. psc_0 is the resultant, and psc_n for
+ * n = min(deg a, deg b) is a power of a leading coefficient (1 for equal degrees). The
+ * first k vanish exactly when gcd(a, b) has degree k in x_v. They are computed by
+ * fraction-free (Bareiss) elimination with exact division.
+ */
+#pragma once
+
+#include "algebra/SparsePolynomial.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace aleph3 {
+
+    // Res_{x_v}(a, b): 0 if either is 0, and a^deg_v(b) if a does not contain x_v. Over Z it
+    // takes the subresultant sequence when x_v is the only variable and the degrees add up
+    // to less than RESULTANT_MODULAR_DEGREE, else the modular algorithm. Throws
+    // std::invalid_argument unless a and b share a ring, and over Z/pZ std::length_error if
+    // a dense image would have more than DENSE_BOX_LIMIT coefficients.
+    IntegerPolynomial resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v);
+    ModularPolynomial resultant(const ModularPolynomial& a, const ModularPolynomial& b, size_t v);
+
+    // deg_v(a) + deg_v(b) from which resultant() over Z goes modular in one variable
+    inline constexpr size_t RESULTANT_MODULAR_DEGREE = 8;
+
+    // Each of the two algorithms over Z, whatever the degrees. The modular one falls back to
+    // the subresultant sequence when the dense images would be too large.
+    IntegerPolynomial subresultant_resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v);
+    IntegerPolynomial modular_resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v);
+
+    // (-1)^(n (n - 1) / 2) Res_{x_v}(f, df/dx_v) / lc_v(f) for n = deg_v(f); 0 if f does not
+    // contain x_v
+    IntegerPolynomial discriminant(const IntegerPolynomial& f, size_t v);
+
+    // {psc_0, ..., psc_n} for n = min(deg_v(a), deg_v(b)); {} if either is 0
+    std::vector<IntegerPolynomial> principal_subresultants(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v);
+
+} // namespace aleph3
@@ -0,0 +1,245 @@
+/*
+ * SparsePolynomial.hpp
+ * --------------------
+ * Multivariate polynomials with packed exponent vectors, for large expansions.
+ *
+ * A PolynomialRing fixes the variables and their order. It also fixes how a monomial's
+ * exponents are packed into two 64-bit words. Each variable gets a field of equal width,
+ * with the first variable in the most significant field. Comparing two packed monomials
+ * as integers is then the lexicographic order on the ring's variables. Multiplying two
+ * monomials is a word-wise add. The top bit of every field is a guard bit, which detects
+ * exponent overflow after the add.
+ *
+ * A BasicSparsePolynomial is a flat vector of (exponents, coefficient) terms over one of the
+ * coefficient domains in Coefficients.hpp. Terms are sorted by decreasing monomial and have
+ * no zero coefficients. With double coefficients (SparsePolynomial) a term costs 24 bytes
+ * and no allocations. IntegerPolynomial and RationalPolynomial are exact, and
+ * ModularPolynomial works in Z/pZ. The member templates are instantiated in
+ * SparsePolynomial.cpp for these four domains.
+ *
+ * Products come out in sorted order. The method depends on the product's exponent box
+ * (every exponent up to the sum of the factors' degrees):
+ *
+ *   - Kronecker substitution (double and integer coefficients) when the box is much
+ *     smaller than the number of term pairs. Both factors map to dense univariate
+ *     polynomials in DenseMultiply.hpp, so long dense products get Karatsuba, Toom-3 or
+ *     an NTT/FFT.
+ *   - A dense accumulator when the box is small next to the number of term pairs. Terms
+ *     are added into an array indexed by the box.
+ *   - Otherwise a heap merge (Johnson's algorithm, in the Monagan-Pearce form) over the
+ *     smaller factor. It holds at most one entry per term of that factor and emits each
+ *     product monomial once, in order.
+ *
+ * Over Z the dense and heap products add up coefficients in 128-bit words when every
+ * coefficient fits 64 bits and no sum can pass 2^126, so a BigInt is made once per term.
+ * Large dense and heap products run on the ThreadPool, one range of monomials at a time.
+ *
+ * Powers are generated by the multinomial theorem when the base has few terms for its
+ * exponent box. There is one output term per way of splitting the exponent among the base's
+ * terms. Otherwise they use repeated squaring, which sends the large squarings to the fast
+ * kernels above.
+ *
+ * Example: in the ring (x, y), 3*x^2*y + 2*y^3 is the terms
+ *   { pack(2, 1): 3.0, pack(0, 3): 2.0 }
+ *
+ * The map-based Polynomial class stays as the small general-purpose type. Use
+ * expr_to_polynomial / polynomial_to_expr in PolyUtils.hpp to convert from and to ExprPtr.
+ */
+#pragma once
+
+#include "algebra/Coefficients.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    // Packed exponent vector; compares as the 128-bit integer hi:lo
+    struct Exponents {
+        uint64_t hi = 0;
+        uint64_t lo = 0;
+
+        friend bool operator==(const Exponents&, const Exponents&) = default;
+        friend auto operator<=>(const Exponents&, const Exponents&) = default;
+    };
+
+    class PolynomialRing {
+    public:
+        static constexpr size_t MAX_VARIABLES = 32;
+
+        // Throws std::invalid_argument for more than MAX_VARIABLES variables
+        explicit PolynomialRing(std::vector<std::string> variables);
+
+        const std::vector<std::string>& variables() const { return variables_; }
+        size_t size() const { return variables_.size(); }
+        std::optional<size_t> index_of(const std::string& variable) const;
+
+        // Largest exponent a field holds: 2^31 - 1 for up to 4 variables, 2^15 - 1 for up
+        // to 8, 127 for up to 16 and 7 for up to 32
+        uint32_t max_exponent() const { return (uint32_t(1) << (bits_ - 1)) - 1; }
+
+        // Throws std::overflow_error if an exponent exceeds max_exponent()
+        Exponents pack(const std::vector<uint32_t>& exponents) const;
+        Exponents power_of(size_t variable, uint32_t exponent) const;
+        uint32_t exponent(const Exponents& e, size_t variable) const;
+        uint32_t total_degree(const Exponents& e) const;
+
+        // Product of two monomials; throws std::overflow_error if an exponent overflows
+        Exponents multiply(const Exponents& a, const Exponents& b) const;
+        // a / b, or nullopt if b does not divide a
+        std::optional<Exponents> divide(const Exponents& a, const Exponents& b) const;
+        // e with the exponent of `variable` set to 0
+        Exponents without(const Exponents& e, size_t variable) const;
+
+        bool operator==(const PolynomialRing& other) const { return variables_ == other.variables_; }
+
+    private:
+        std::vector<std::string> variables_;
+        unsigned bits_ = 32;       // Field width, guard bit included
+        unsigned per_word_ = 2;    // Fields per word
+        Exponents guards_;
+
+        // Word and shift of a variable's field
+        uint64_t& word(Exponents& e, size_t variable) const { return variable < per_word_ ? e.hi : e.lo; }
+        uint64_t word(const Exponents& e, size_t variable) const { return variable < per_word_ ? e.hi : e.lo; }
+        unsigned shift(size_t variable) const { return 64 - bits_ * (static_cast<unsigned>(variable % per_word_) + 1); }
+    };
+
+    template <class Domain>
+    class BasicSparsePolynomial {
+    public:
+        using Coeff = typename Domain::value_type;
+
+        struct Term {
+            Exponents exponents;
+            Coeff coeff;
+        };
+
+        // The zero polynomial of `ring`
+        explicit BasicSparsePolynomial(std::shared_ptr<const PolynomialRing> ring, Domain domain = Domain());
+
+        static BasicSparsePolynomial constant(std::shared_ptr<const PolynomialRing> ring, Coeff value, Domain domain = Domain());
+        static BasicSparsePolynomial variable(std::shared_ptr<const PolynomialRing> ring, size_t index, uint32_t exponent = 1,
+                                              Domain domain = Domain());
+
+        // Sorts terms given in any order and adds up repeated monomials
+        static BasicSparsePolynomial from_terms(std::shared_ptr<const PolynomialRing> ring, std::vector<Term> terms,
+                                                Domain domain = Domain());
+
+        const PolynomialRing& ring() const { return *ring_; }
+        const std::shared_ptr<const PolynomialRing>& ring_ptr() const { return ring_; }
+        const Domain& domain() const { return domain_; }
+
+        // Sorted by decreasing monomial, without zero coefficients
+        const std::vector<Term>& terms() const { return terms_; }
+        size_t size() const { return terms_.size(); }
+        bool is_zero() const { return terms_.empty(); }
+
+        Coeff coefficient(const Exponents& monomial) const;
+        uint32_t total_degree() const;
+        uint32_t degree(size_t variable) const;
+
+        // A temporary left operand is updated in place and moved into the result
+        BasicSparsePolynomial operator+(const BasicSparsePolynomial& other) const&;
+        BasicSparsePolynomial operator+(const BasicSparsePolynomial& other) &&;
+        BasicSparsePolynomial operator-(const BasicSparsePolynomial& other) const&;
+        BasicSparsePolynomial operator-(const BasicSparsePolynomial& other) &&;
+        BasicSparsePolynomial operator*(const BasicSparsePolynomial& other) const;
+        BasicSparsePolynomial operator*(const Coeff& scalar) const&;
+        BasicSparsePolynomial operator*(const Coeff& scalar) &&;
+
+        // Merges from the back into this polynomial's own storage, so a sum that fits
+        // the capacity allocates nothing
+        BasicSparsePolynomial& operator+=(const BasicSparsePolynomial& other);
+        BasicSparsePolynomial& operator-=(const BasicSparsePolynomial& other);
+        BasicSparsePolynomial& operator*=(const BasicSparsePolynomial& other);
+        BasicSparsePolynomial& operator*=(const Coeff& scalar);
+        // *this += a * b; a one-term factor shifts the other in the merge, with no product
+        BasicSparsePolynomial& addmul(const BasicSparsePolynomial& a, const BasicSparsePolynomial& b);
+
+        // The sum of all parts in one k-way merge, dropping zero coefficients only once
+        // each monomial is complete. Throws std::invalid_argument unless every part is in
+        // `ring` and `domain`.
+        static BasicSparsePolynomial sum(std::shared_ptr<const PolynomialRing> ring, std::vector<BasicSparsePolynomial> parts,
+                                         Domain domain = Domain());
+
+        // The product by one algorithm or another; operator* picks between them
+        template <class D>
+        friend BasicSparsePolynomial<D> multiply_heap(const BasicSparsePolynomial<D>& a, const BasicSparsePolynomial<D>& b);
+        template <class D>
+        friend BasicSparsePolynomial<D> multiply_dense(const BasicSparsePolynomial<D>& a, const BasicSparsePolynomial<D>& b);
+        friend BasicSparsePolynomial<RealField> multiply_kronecker(const BasicSparsePolynomial<RealField>& a,
+                                                                   const BasicSparsePolynomial<RealField>& b);
+        friend BasicSparsePolynomial<IntegerRing> multiply_kronecker(const BasicSparsePolynomial<IntegerRing>& a,
+                                                                     const BasicSparsePolynomial<IntegerRing>& b);
+        template <class D>
+        friend std::pair<BasicSparsePolynomial<D>, BasicSparsePolynomial<D>> divide(const BasicSparsePolynomial<D>& a,
+                                                                                    const BasicSparsePolynomial<D>& b,
+                                                                                    bool stop_at_remainder);
+
+    private:
+        std::shared_ptr<const PolynomialRing> ring_;
+        Domain domain_;
+        std::vector<Term> terms_;
+
+        // Throws std::invalid_argument unless both have the same variables and domain
+        void check_ring(const BasicSparsePolynomial& other) const;
+        // Adds transform(t) for each term t of other, a sorted vector of terms. The
+        // transform must keep them sorted.
+        template <class Terms, class Transform>
+        void merge_in(Terms& other, Transform transform);
+    };
+
+    using SparsePolynomial = BasicSparsePolynomial<RealField>;
+    using IntegerPolynomial = BasicSparsePolynomial<IntegerRing>;
+    using RationalPolynomial = BasicSparsePolynomial<RationalField>;
+    using ModularPolynomial = BasicSparsePolynomial<ModularField>;
+
+    // Largest exponent box the dense product allocates, in coefficients
+    inline constexpr size_t DENSE_BOX_LIMIT = size_t(1) << 22;
+
+    // Heap and dense products with at least this many term pairs run on the ThreadPool.
+    // The output's monomials are cut into PRODUCT_SLICES ranges of about equal numbers of
+    // term pairs, estimated from a sample of them. Each slice is computed on its own, and the
+    // results are concatenated in order. The cuts do not depend on the thread count, so
+    // the result does not either.
+    inline constexpr size_t PARALLEL_PAIRS = size_t(1) << 20;
+    inline constexpr size_t PRODUCT_SLICES = 64;
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> multiply_heap(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b);
+
+    // Both throw std::length_error if the exponent box has more than DENSE_BOX_LIMIT cells.
+    // The integer Kronecker product maps coefficients to doubles: when the product could
+    // leave the exactly representable range it falls back to multiply_dense.
+    template <class Domain>
+    BasicSparsePolynomial<Domain> multiply_dense(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b);
+    SparsePolynomial multiply_kronecker(const SparsePolynomial& a, const SparsePolynomial& b);
+    IntegerPolynomial multiply_kronecker(const IntegerPolynomial& a, const IntegerPolynomial& b);
+
+    // Heap division (Monagan and Pearce): a = q * b + r, where no term of r is divisible by
+    // the leading term of b. Over Z that means, with the monomial, the coefficient too. The
+    // heap holds one entry per quotient term, for the next product of that term with b. With
+    // stop_at_remainder it returns at the first remainder term, with q incomplete. Throws
+    // std::domain_error if b is zero.
+    template <class Domain>
+    std::pair<BasicSparsePolynomial<Domain>, BasicSparsePolynomial<Domain>> divide(const BasicSparsePolynomial<Domain>& a,
+                                                                                  const BasicSparsePolynomial<Domain>& b,
+                                                                                  bool stop_at_remainder = false);
+
+    // base^exponent, with 0^0 = 1; throws std::overflow_error if an exponent of the result
+    // passes the ring's max_exponent()
+    template <class Domain>
+    BasicSparsePolynomial<Domain> power(const BasicSparsePolynomial<Domain>& base, uint32_t exponent);
+
+    extern template class BasicSparsePolynomial<RealField>;
+    extern template class BasicSparsePolynomial<IntegerRing>;
+    extern template class BasicSparsePolynomial<RationalField>;
+    extern template class BasicSparsePolynomial<ModularField>;
+
+} // namespace aleph3
@@ -0,0 +1,81 @@
+/*
+ * Batch.hpp
+ * ---------
+ * Non-interactive runs of the aleph3 executable: `aleph3 -f script.m`, or a script piped
+ * into standard input.
+ *
+ * The script is split into statements (see Statements.hpp), which are parsed in parallel a
+ * window at a time and evaluated in order in one EvaluationContext. Each result goes on its own line with no prompt, no colors and no
+ * Out[n] label, and nothing is flushed until the writer's buffer fills or the run ends.
+ * Statements ended by ';' and definitions print nothing. An error is written to the error
+ * stream with the line of its statement, and the run continues with the next statement
+ * unless stop_on_error is set.
+ */
+#pragma once
+
+#include "evaluator/EvaluationContext.hpp"
+#include "expr/Printer.hpp"
+#include "parser/Statements.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aleph3 {
+
+    struct BatchOptions {
+        bool labels = false;         // Print Out[n]= before each result, as the REPL does
+        bool stop_on_error = false;
+        std::string source_name = "<stdin>"; // For error messages
+        size_t block_size = size_t(1) << 20; // Bytes per read when streaming
+    };
+
+    // Evaluates one statement in ctx and writes what it prints to `out`, after `label`. Returns
+    // false, having written nothing, for a silent statement, or for a definition unless
+    // show_definitions is set. Parse and evaluation errors are thrown.
+    bool write_statement(const Statement& statement, EvaluationContext& ctx, OutputBuffer& out,
+                         std::string_view label = {}, bool show_definitions = false);
+
+    // As above, for a statement already parsed into `expr`
+    bool write_statement(const ExprPtr& expr, bool silent, EvaluationContext& ctx, OutputBuffer& out,
+                         std::string_view label = {}, bool show_definitions = false);
+
+    // What write_statement would write, without a label, or nothing if it writes nothing
+    std::optional<std::string> evaluate_statement(const Statement& statement, EvaluationContext& ctx,
+                                                  bool show_definitions = false);
+
+    class BatchRunner {
+    public:
+        BatchRunner(EvaluationContext& ctx, std::ostream& out, std::ostream& err, BatchOptions options = {});
+
+        // Runs every statement of a script held in memory
+        void run(std::string_view source);
+
+        // Reads `in` to the end in blocks of options.block_size, running each statement once
+        // the next one has begun, so a large script never has to be held whole
+        void run(std::istream& in);
+
+        size_t failures() const { return failures_; }
+        // True once stop_on_error has ended the run
+        bool stopped() const { return stopped_; }
+
+    private:
+        EvaluationContext& ctx_;
+        std::ostream& out_;
+        std::ostream& err_;
+        BatchOptions options_;
+        size_t counter_ = 1;    // n of the next Out[n]
+        size_t line_base_ = 0;  // Lines consumed by earlier blocks
+        size_t failures_ = 0;
+        bool stopped_ = false;
+
+        // Parses statements [begin, end) in parallel, then evaluates them in order
+        void run_statements(const std::vector<Statement>& statements, size_t begin, size_t end);
+        void run_statement(const Statement& statement, const ParsedStatement& parsed);
+    };
+
+} // namespace aleph3
@@ -0,0 +1,125 @@
+/*
+ * Engine.hpp
+ * ----------
+ * Interface for embedding aleph3 in a multithreaded program.
+ *
+ *   Engine engine;
+ *   Session session = engine.open_session();
+ *   std::future<ExprPtr> value = session.evaluate_async("x = 2; x^2 + 1");
+ *   to_string(value.get());  // "5"
+ *
+ * An Engine owns a frozen FunctionRegistry with the built-in functions, plus any that
+ * EngineOptions::extend registers, and a set of evaluation threads. A Session owns the
+ * bindings and symbol attributes of one client. Sessions of one engine share only the
+ * registry, which nothing writes once it is frozen.
+ *
+ * Evaluations of one session run one at a time, in the order they were submitted. Those
+ * of different sessions run concurrently on the engine's threads, which take ready
+ * sessions round-robin, one evaluation at a time, so one busy session cannot starve the
+ * others. Each evaluation runs under a budget (Budget.hpp): the one it was given, or else
+ * EngineOptions::budget. It also watches the session's cancel token, so cancel() stops
+ * every evaluation submitted before it, whether it is running or still queued.
+ *
+ * A failed evaluation stores its exception in the future: BudgetExceeded, or the
+ * std::runtime_error of a parse or evaluation error. Bindings made before the failure are
+ * kept.
+ *
+ * Thread safety:
+ * - The members of Engine and Session may be called from any thread, also concurrently.
+ * - Expressions are immutable once built, and may be passed between sessions and threads.
+ * - The engine must outlive its sessions. Destroying it waits for the evaluations already
+ *   submitted. Destroying a Session handle lets its submitted evaluations finish.
+ *
+ * The process-wide state that remains is synchronized and holds nothing of any one
+ * session: the atom table, the expression pool, ResultCache, the Profiler, and the
+ * ThreadPool behind the Parallel* built-ins, whose jobs run one at a time.
+ */
+#pragma once
+
+#include "evaluator/Budget.hpp"
+#include "evaluator/FunctionRegistry.hpp"
+#include "expr/Expr.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aleph3 {
+
+    struct EngineOptions {
+        size_t threads = 0;        // 0: one per hardware thread
+        EvaluationBudget budget;   // For evaluations given none
+        // Registers the host's own functions, after the built-ins and before the registry
+        // is frozen
+        std::function<void(FunctionRegistry&)> extend;
+    };
+
+    class Session;
+
+    class Engine {
+    public:
+        explicit Engine(EngineOptions options = {});
+        // Finishes the evaluations already submitted, then stops the threads
+        ~Engine();
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        const FunctionRegistry& registry() const { return registry_; }
+        size_t threads() const { return workers_.size(); }
+
+        // A session with no bindings
+        Session open_session();
+
+    private:
+        friend class Session;
+        struct State;
+        struct Task;
+
+        EngineOptions options_;
+        FunctionRegistry registry_;
+        std::vector<std::thread> workers_;
+
+        std::mutex mutex_;                 // Guards the fields below and the sessions' queues
+        std::condition_variable work_;     // A session became ready, or stopping
+        std::deque<std::shared_ptr<State>> ready_;
+        bool stopping_ = false;
+
+        std::future<ExprPtr> submit(const std::shared_ptr<State>& session, std::function<ExprPtr(EvaluationContext&)> work,
+                                    std::optional<EvaluationBudget> budget);
+        void cancel(State& session);
+        void worker_loop();
+    };
+
+    // Handle of a session; copies refer to the same session
+    class Session {
+    public:
+        // Evaluates the statements of `source` (see Statements.hpp) in order, to the value
+        // of the last one, or Null if there is none or it ends with ';'
+        std::future<ExprPtr> evaluate_async(std::string source, std::optional<EvaluationBudget> budget = std::nullopt);
+        std::future<ExprPtr> evaluate_async(ExprPtr expr, std::optional<EvaluationBudget> budget = std::nullopt);
+
+        // evaluate_async(...).get()
+        ExprPtr evaluate(std::string source) { return evaluate_async(std::move(source)).get(); }
+        ExprPtr evaluate(ExprPtr expr) { return evaluate_async(std::move(expr)).get(); }
+
+        // Stops the evaluations submitted so far; later ones run as usual
+        void cancel();
+
+    private:
+        friend class Engine;
+        Session(Engine& engine, std::shared_ptr<Engine::State> state) : engine_(&engine), state_(std::move(state)) {}
+
+        Engine* engine_;
+        std::shared_ptr<Engine::State> state_;
+    };
+
+} // namespace aleph3
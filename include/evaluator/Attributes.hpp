@@ -0,0 +1,136 @@
+/*
+ * Attributes.hpp
+ * --------------
+ * Attributes of heads, which decide how a call's arguments are treated before the head
+ * sees them (see prepare_arguments in Evaluator.hpp):
+ * - HoldFirst, HoldRest, HoldAll: the first, the other, or all arguments are passed
+ *   unevaluated; a user function binds held arguments as they are written
+ * - Listable: f[{a, b}, c] threads to {f[a, c], f[b, c]}; lists must have equal lengths
+ * - Flat: f[a, f[b, c]] becomes f[a, b, c]
+ * - Orderless: arguments are sorted into canonical order (ExprOrder.hpp)
+ * - NumericFunction: the value is a number when the arguments are numbers
+ *
+ * Built-in heads have fixed attributes (BUILTIN_ATTRIBUTES in BuiltinTables.hpp); other
+ * symbols get theirs from SetAttributes and keep them in a SymbolAttributes table: the
+ * FunctionRegistry's, or the one an EvaluationContext names (each Engine Session has its
+ * own, see Engine.hpp).
+ */
+#pragma once
+
+#include "expr/Atom.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    enum class Attribute : uint8_t {
+        HoldFirst = 1 << 0,
+        HoldRest = 1 << 1,
+        HoldAll = HoldFirst | HoldRest,
+        Listable = 1 << 2,
+        Flat = 1 << 3,
+        Orderless = 1 << 4,
+        NumericFunction = 1 << 5,
+    };
+
+    class Attributes {
+    public:
+        constexpr Attributes() = default;
+        constexpr Attributes(Attribute a) : bits_(static_cast<uint8_t>(a)) {}
+
+        constexpr bool has(Attribute a) const {
+            const auto bits = static_cast<uint8_t>(a);
+            return (bits_ & bits) == bits;
+        }
+        constexpr bool empty() const { return bits_ == 0; }
+        constexpr uint8_t bits() const { return bits_; }
+
+        constexpr Attributes operator|(Attributes other) const { return from_bits(bits_ | other.bits_); }
+        constexpr Attributes without(Attributes other) const { return from_bits(bits_ & ~other.bits_); }
+        constexpr bool operator==(const Attributes&) const = default;
+
+        // Whether argument `i` (0-based) is held
+        constexpr bool holds(size_t i) const { return has(i == 0 ? Attribute::HoldFirst : Attribute::HoldRest); }
+
+    private:
+        uint8_t bits_ = 0;
+
+        static constexpr Attributes from_bits(unsigned bits) {
+            Attributes a;
+            a.bits_ = static_cast<uint8_t>(bits);
+            return a;
+        }
+    };
+
+    constexpr Attributes operator|(Attribute a, Attribute b) { return Attributes(a) | Attributes(b); }
+
+    // Names as SetAttributes reads them and Attributes[] prints them, in alphabetical order.
+    // HoldAll comes before HoldFirst and HoldRest, which it includes.
+    inline constexpr std::array<std::pair<std::string_view, Attribute>, 7> ATTRIBUTE_NAMES = { {
+        { "Flat", Attribute::Flat },
+        { "HoldAll", Attribute::HoldAll },
+        { "HoldFirst", Attribute::HoldFirst },
+        { "HoldRest", Attribute::HoldRest },
+        { "Listable", Attribute::Listable },
+        { "NumericFunction", Attribute::NumericFunction },
+        { "Orderless", Attribute::Orderless },
+    } };
+
+    inline std::optional<Attribute> attribute_named(std::string_view name) {
+        for (const auto& [n, a] : ATTRIBUTE_NAMES) {
+            if (n == name) return a;
+        }
+        return std::nullopt;
+    }
+
+    // Attributes of non-built-in symbols. Reads and writes may come from several threads;
+    // while the table is empty a read is one atomic load.
+    class SymbolAttributes {
+    public:
+        Attributes get(Atom name) const {
+            if (!nonempty_.load(std::memory_order_acquire)) return {};
+            std::shared_lock lock(mutex_);
+            auto it = table_.find(name);
+            return it != table_.end() ? it->second : Attributes();
+        }
+
+        void set(Atom name, Attributes attrs) {
+            std::unique_lock lock(mutex_);
+            if (attrs.empty()) table_.erase(name);
+            else table_[name] = attrs;
+            nonempty_.store(!table_.empty(), std::memory_order_release);
+        }
+
+        void clear() {
+            std::unique_lock lock(mutex_);
+            table_.clear();
+            nonempty_.store(false, std::memory_order_release);
+        }
+
+    private:
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<Atom, Attributes> table_;
+        std::atomic<bool> nonempty_{ false };
+    };
+
+    // Names of the attributes in `attrs`, HoldAll standing for HoldFirst and HoldRest
+    inline std::vector<std::string_view> attribute_names(Attributes attrs) {
+        std::vector<std::string_view> names;
+        const bool all = attrs.has(Attribute::HoldAll);
+        for (const auto& [n, a] : ATTRIBUTE_NAMES) {
+            if (all && (a == Attribute::HoldFirst || a == Attribute::HoldRest)) continue;
+            if (attrs.has(a)) names.push_back(n);
+        }
+        return names;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,181 @@
+/*
+ * Budget.hpp
+ * ----------
+ * Limits on evaluations running on the current thread: wall-clock time, evaluation steps,
+ * recursion depth and the bytes of expression nodes allocated, plus cancellation from
+ * another thread.
+ *
+ * A BudgetScope applies an EvaluationBudget until it closes. Nested scopes keep the
+ * tighter of each limit, and a cancel token of any open scope stops the evaluation. The
+ * state is thread-local rather than a member of EvaluationContext, so built-ins and the
+ * algebra code check it without being handed anything.
+ *
+ * Each evaluate() call is one step and one level of depth, both checked exactly. Depth is
+ * always limited, to RECURSION_LIMIT unless a scope asks for less, and to what the
+ * thread's stack holds less a reserve for the work below the deepest call, so a runaway
+ * recursive definition fails with an error instead of overflowing the stack. The other limits are
+ * checked by poll_budget(), which evaluate() and the long loops of the parser and of
+ * polynomial multiplication call: it reads the clock, the allocation counter and the
+ * cancel tokens only once every POLL_INTERVAL polls, and costs a single thread-local test
+ * while no scope is open.
+ *
+ * An exceeded limit throws BudgetExceeded, so the evaluation unwinds from wherever it is,
+ * and bindings made before that point stay made. Limits stay exceeded until their scope
+ * closes: a built-in that swallows the error meets it again at its next poll. Work handed
+ * to other threads (ThreadPool jobs) is not limited and its allocations are not counted.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace aleph3 {
+
+    enum class BudgetLimit : uint8_t { Time, Steps, Depth, Memory, Cancelled };
+
+    struct BudgetExceeded : std::runtime_error {
+        BudgetExceeded(BudgetLimit limit, uint64_t scope, const std::string& what)
+            : std::runtime_error(what), limit(limit), scope(scope) {}
+
+        BudgetLimit limit;
+        uint64_t scope;  // id() of the BudgetScope that set the limit; 0 for the default depth limits
+    };
+
+    // Nested evaluate() calls allowed outside any scope that sets a depth
+    inline constexpr size_t RECURSION_LIMIT = 65536;
+
+    // Shared flag that stops the evaluations watching it. Copies share the flag, and
+    // cancel() may be called from any thread.
+    class CancelToken {
+    public:
+        CancelToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+        void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+        bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+    private:
+        friend class BudgetScope;
+        std::shared_ptr<std::atomic<bool>> flag_;
+    };
+
+    // Zero leaves a limit to the enclosing scopes
+    struct EvaluationBudget {
+        std::chrono::steady_clock::duration time{ 0 };
+        uint64_t steps = 0;   // evaluate() calls
+        size_t depth = 0;     // Nested evaluate() calls, counted from the scope
+        size_t memory = 0;    // Bytes of expression nodes allocated on this thread
+        std::optional<CancelToken> cancel;
+    };
+
+    namespace detail {
+        inline constexpr uint32_t POLL_INTERVAL = 1024;
+        inline constexpr uint64_t UNLIMITED = std::numeric_limits<uint64_t>::max();
+
+        struct CancelLink {
+            const std::atomic<bool>* flag;
+            const CancelLink* next;  // The enclosing scopes' tokens
+        };
+
+        // Limits as absolute values of the counters, with the scope that set each
+        struct BudgetLimits {
+            bool polled = false;  // Time, memory or cancellation to poll for
+            bool timed = false;
+            std::chrono::steady_clock::time_point at;
+            uint64_t step_at = UNLIMITED;
+            uint64_t depth_at = RECURSION_LIMIT;
+            uint64_t memory_at = UNLIMITED;
+            uint64_t time_scope = 0, step_scope = 0, depth_scope = 0, memory_scope = 0;
+            const CancelLink* cancels = nullptr;
+        };
+
+        struct Budget {
+            BudgetLimits limits;
+            uint32_t countdown = POLL_INTERVAL;
+            uint64_t steps = 0;
+            uint64_t depth = 0;
+            uint64_t scopes = 0;  // Ids handed out
+            uintptr_t stack_floor = 0;  // Lowest stack address a call may start at; set by the first
+        };
+
+        inline thread_local Budget budget;
+
+        // stack_floor for the thread running at `here`
+        uintptr_t find_stack_floor(const void* here);
+
+        // The clock, allocation and cancellation checks behind poll_budget()
+        void check_budget();
+        [[noreturn]] void exceed(BudgetLimit limit, uint64_t scope);
+    }
+
+    class BudgetScope {
+    public:
+        explicit BudgetScope(const EvaluationBudget& budget);
+        ~BudgetScope();
+
+        BudgetScope(const BudgetScope&) = delete;
+        BudgetScope& operator=(const BudgetScope&) = delete;
+
+        // Matches BudgetExceeded::scope when a limit set by this scope is exceeded
+        uint64_t id() const { return id_; }
+
+    private:
+        uint64_t id_;
+        detail::BudgetLimits saved_;
+        std::optional<CancelToken> token_;
+        detail::CancelLink link_{};
+    };
+
+    // Throws BudgetExceeded if the current thread's time or memory has run out or its
+    // evaluation was cancelled
+    inline void poll_budget() {
+        auto& b = detail::budget;
+        if (!b.limits.polled || --b.countdown != 0) return;
+        detail::check_budget();
+    }
+
+    // One evaluate() call: a step, a level of depth and a poll
+    class BudgetFrame {
+    public:
+        BudgetFrame() {
+            auto& b = detail::budget;
+            if (++b.steps > b.limits.step_at) detail::exceed(BudgetLimit::Steps, b.limits.step_scope);
+            if (b.depth >= b.limits.depth_at) detail::exceed(BudgetLimit::Depth, b.limits.depth_scope);
+            const char here = 0;
+            if (b.stack_floor == 0) b.stack_floor = detail::find_stack_floor(&here);
+            if (reinterpret_cast<uintptr_t>(&here) < b.stack_floor) detail::exceed(BudgetLimit::Depth, 0);
+            poll_budget();
+            ++b.depth;
+        }
+        ~BudgetFrame() { --detail::budget.depth; }
+
+        BudgetFrame(const BudgetFrame&) = delete;
+        BudgetFrame& operator=(const BudgetFrame&) = delete;
+    };
+
+    // body() under `budget`, or nullopt if one of the budget's own limits was exceeded, by
+    // the time it returns at the latest. Limits of enclosing scopes and cancellation
+    // propagate.
+    template <class Body>
+    auto run_constrained(const EvaluationBudget& budget, Body&& body) -> std::optional<decltype(body())> {
+        uint64_t id = 0;
+        try {
+            BudgetScope scope(budget);
+            id = scope.id();
+            auto value = body();
+            detail::check_budget();
+            return value;
+        }
+        catch (const BudgetExceeded& ex) {
+            if (ex.scope != id || ex.limit == BudgetLimit::Cancelled) throw;
+            return std::nullopt;
+        }
+    }
+
+} // namespace aleph3
@@ -2,7 +2,11 @@
 
 namespace aleph3 {
 
+    class FunctionRegistry;
+
     // Registers all built-in functions in the FunctionRegistry
     void register_built_in_functions();
+    // The same into `registry`, such as an Engine's own
+    void register_built_in_functions(FunctionRegistry& registry);
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,111 @@
+/*
+ * BuiltinTables.hpp
+ * -----------------
+ * Metadata of the built-in numeric heads that evaluate_function dispatches on: which heads
+ * have a machine-number form, their inverses, which heads are pure and their attributes. Each table is an
+ * AtomTable or AtomSet built at compile time, and each numeric form is a switch over an
+ * enum, so dispatch never hashes, allocates or calls through std::function. The unary
+ * functions share the kernels' table (kernels::unary_kernel in VectorKernels.hpp).
+ */
+#pragma once
+
+#include "expr/AtomTable.hpp"
+#include "evaluator/Attributes.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace aleph3 {
+
+    // Two-argument heads with a machine-number form
+    enum class BinaryBuiltin : uint8_t { Plus, Minus, Times, Divide, Power, Log, ArcTan };
+
+    inline constexpr AtomTable<BinaryBuiltin> BINARY_BUILTINS = {
+        { "Plus", BinaryBuiltin::Plus }, { "Minus", BinaryBuiltin::Minus }, { "Times", BinaryBuiltin::Times },
+        { "Divide", BinaryBuiltin::Divide }, { "Power", BinaryBuiltin::Power }, { "Log", BinaryBuiltin::Log },
+        { "ArcTan", BinaryBuiltin::ArcTan },
+    };
+
+    inline double apply_builtin(BinaryBuiltin op, double a, double b) {
+        switch (op) {
+        case BinaryBuiltin::Plus:   return a + b;
+        case BinaryBuiltin::Minus:  return a - b;
+        case BinaryBuiltin::Times:  return a * b;
+        case BinaryBuiltin::Divide: return a / b;
+        case BinaryBuiltin::Power:  return std::pow(a, b);
+        case BinaryBuiltin::Log:    return std::log(b) / std::log(a);  // Log[base, x]
+        case BinaryBuiltin::ArcTan: return std::atan2(b, a);           // ArcTan[x, y]
+        }
+        return a;
+    }
+
+    enum class Comparison : uint8_t { Equal, NotEqual, Less, Greater, LessEqual, GreaterEqual };
+
+    inline constexpr AtomTable<Comparison> COMPARISONS = {
+        { "Equal", Comparison::Equal }, { "NotEqual", Comparison::NotEqual }, { "Less", Comparison::Less },
+        { "Greater", Comparison::Greater }, { "LessEqual", Comparison::LessEqual },
+        { "GreaterEqual", Comparison::GreaterEqual },
+    };
+
+    inline bool compare(Comparison op, double a, double b) {
+        switch (op) {
+        case Comparison::Equal:        return a == b;
+        case Comparison::NotEqual:     return a != b;
+        case Comparison::Less:         return a < b;
+        case Comparison::Greater:      return a > b;
+        case Comparison::LessEqual:    return a <= b;
+        case Comparison::GreaterEqual: return a >= b;
+        }
+        return false;
+    }
+
+    // f[g[x]] evaluates to x for these pairs {f, g}
+    inline constexpr AtomTable<Atom> INVERSE_FUNCTIONS = {
+        { "Sin", builtin_atom("ArcSin") }, { "Cos", builtin_atom("ArcCos") }, { "Tan", builtin_atom("ArcTan") },
+        { "Exp", builtin_atom("Log") }, { "Log", builtin_atom("Exp") }, { "Abs", builtin_atom("Abs") },
+        { "ArcSin", builtin_atom("Sin") }, { "ArcCos", builtin_atom("Cos") }, { "ArcTan", builtin_atom("Tan") },
+    };
+
+    inline constexpr AtomSet POLYNOMIAL_FUNCTIONS = {
+        "Expand", "Factor", "Collect", "GCD", "PolynomialQuotient", "PolynomialEvaluate",
+        "Coefficient", "CoefficientList", "Exponent", "GroebnerBasis", "PolynomialReduce",
+        "Resultant", "Discriminant", "Subresultants", "Together", "Cancel",
+    };
+
+    // Heads whose built-in evaluation needs nothing but their evaluated arguments and has no
+    // side effects
+    inline constexpr AtomSet PURE_HEADS = {
+        "Plus", "Times", "Minus", "Divide", "Power", "Negate",
+        "List", "And", "Or", "Not",
+        "Equal", "NotEqual", "Less", "Greater", "LessEqual", "GreaterEqual",
+        "Sin", "Cos", "Tan", "Csc", "Sec", "Cot", "Sinc", "Sinh", "Cosh", "Tanh", "Coth", "Sech", "Csch",
+        "ArcSin", "ArcCos", "ArcTan", "Abs", "Sqrt", "Exp", "Log", "Floor", "Ceiling", "Round", "Gamma",
+    };
+
+    // Attributes of the built-in heads, as Attributes[] reports them. Built-ins evaluate their
+    // own arguments in the way these describe.
+    namespace detail {
+        inline constexpr Attributes ARITHMETIC = Attribute::Listable | Attribute::NumericFunction;
+        inline constexpr Attributes ASSOCIATIVE = ARITHMETIC | Attribute::Flat | Attribute::Orderless;
+    }
+
+    inline constexpr AtomTable<Attributes> BUILTIN_ATTRIBUTES = {
+        { "Plus", detail::ASSOCIATIVE }, { "Times", detail::ASSOCIATIVE },
+        { "Minus", detail::ARITHMETIC }, { "Divide", detail::ARITHMETIC }, { "Power", detail::ARITHMETIC },
+        { "Negate", detail::ARITHMETIC },
+        { "Sin", detail::ARITHMETIC }, { "Cos", detail::ARITHMETIC }, { "Tan", detail::ARITHMETIC },
+        { "Csc", detail::ARITHMETIC }, { "Sec", detail::ARITHMETIC }, { "Cot", detail::ARITHMETIC },
+        { "Sinc", detail::ARITHMETIC }, { "Sinh", detail::ARITHMETIC }, { "Cosh", detail::ARITHMETIC },
+        { "Tanh", detail::ARITHMETIC }, { "Coth", detail::ARITHMETIC }, { "Sech", detail::ARITHMETIC },
+        { "Csch", detail::ARITHMETIC }, { "ArcSin", detail::ARITHMETIC }, { "ArcCos", detail::ARITHMETIC },
+        { "ArcTan", detail::ARITHMETIC }, { "Abs", detail::ARITHMETIC }, { "Sqrt", detail::ARITHMETIC },
+        { "Exp", detail::ARITHMETIC }, { "Log", detail::ARITHMETIC }, { "Floor", detail::ARITHMETIC },
+        { "Ceiling", detail::ARITHMETIC }, { "Round", detail::ARITHMETIC }, { "Gamma", detail::ARITHMETIC },
+        { "And", Attribute::HoldAll | Attribute::Flat }, { "Or", Attribute::HoldAll | Attribute::Flat },
+        { "If", Attribute::HoldRest }, { "Set", Attribute::HoldFirst }, { "Condition", Attribute::HoldAll },
+        { "Table", Attribute::HoldAll }, { "Compile", Attribute::HoldAll },
+        { "Timing", Attribute::HoldAll }, { "AbsoluteTiming", Attribute::HoldAll },
+        { "TimeConstrained", Attribute::HoldAll }, { "MemoryConstrained", Attribute::HoldAll },
+    };
+
+} // namespace aleph3
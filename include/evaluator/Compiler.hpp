@@ -0,0 +1,87 @@
+/*
+ * Compiler.hpp
+ * ------------
+ * Lowers numeric expressions to a register bytecode over machine reals or complex numbers,
+ * for Compile[{x, ...}, body] and for user definitions whose body is purely numeric.
+ *
+ * A program runs without touching the evaluator, the context or the node pool: parameters
+ * and constants are loaded into registers, then each instruction computes one register.
+ * run_compiled() reports failure (nullptr) instead of guessing when an argument is not a
+ * machine number or a value leaves the machine domain (out of a function's real domain,
+ * infinite or NaN); callers then evaluate the body symbolically.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/VectorKernels.hpp"
+
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace aleph3 {
+
+    enum class CompileMode : uint8_t {
+        Machine,    // Compile[]: constants such as Pi and rationals become reals
+        Definition, // User definitions: no exact constants, so the evaluator would compute the same reals
+    };
+
+    struct CompiledFunction {
+        enum class Op : uint8_t {
+            Add, Sub, Mul, Div, Pow, Unary,
+            Less, Greater, LessEqual, GreaterEqual, Equal, NotEqual, And, Or, Not,
+            Move, Jump, JumpIfFalse,
+        };
+
+        struct Instruction {
+            Op op;
+            kernels::Unary fn;  // Op::Unary only
+            uint32_t dst;
+            uint32_t a;
+            uint32_t b;         // Second operand, or the jump target
+        };
+
+        struct Constant {
+            uint32_t reg;
+            std::complex<double> value;
+        };
+
+        std::vector<Atom> params;              // Registers [0, params.size())
+        std::vector<Constant> constants;       // Loaded before the code runs
+        std::vector<Instruction> code;
+        std::vector<Atom> heads;               // Built-ins the program stands in for
+        uint32_t registers = 0;
+        uint32_t result = 0;
+        bool complex = false;                  // Registers hold complex values; otherwise reals
+        bool boolean_result = false;
+        CompileMode mode = CompileMode::Machine;
+    };
+
+    // Program for `body` (normalized) in `params`, or nullptr if it is not numeric in that mode
+    std::shared_ptr<const CompiledFunction> compile_function(const std::vector<Atom>& params,
+        const ExprPtr& body, CompileMode mode);
+
+    // Program standing in for the body of `def` (CompileMode::Definition), or nullptr
+    std::shared_ptr<const CompiledFunction> compile_definition(const FunctionDefinition& def);
+
+    // Raw entry for real programs: no allocation. False if the program left the machine domain.
+    bool run_compiled(const CompiledFunction& program, const double* args, double& result);
+
+    // Value of the program at `args`, or nullptr if an argument is not a machine number or the
+    // computation left the machine domain
+    ExprPtr run_compiled(const CompiledFunction& program, std::span<const ExprPtr> args);
+
+    // CompiledFunction[{params}, body], the value of Compile[]
+    inline bool is_compiled_function(const Expr& e) {
+        auto f = std::get_if<FunctionCall>(&e);
+        return f && f->head == atoms::CompiledFunction && f->args.size() == 2 &&
+            std::holds_alternative<List>(*f->args[0]);
+    }
+
+    // The program of a CompiledFunction[{params}, body] node returned by Compile[], compiled on
+    // first use and then shared by all structurally equal nodes; nullptr for any other node
+    std::shared_ptr<const CompiledFunction> compiled_function_of(const ExprPtr& expr);
+
+} // namespace aleph3
@@ -0,0 +1,31 @@
+/*
+ * ConstantFolding.hpp
+ * -------------------
+ * Optimization pass over parsed expressions, run on a definition's body once when it is
+ * stored rather than on every call.
+ *
+ * optimize_expr() canonicalizes the tree (normalize_expr: differences become sums of
+ * Times[-1, x], nested sums and products are flattened) and then folds constants: every
+ * call to Plus, Times, Minus, Divide, Power or Negate whose arguments are all numbers,
+ * rationals or complex numbers, after folding below it, is replaced by its value, and
+ * the numeric terms of a sum or product that also has other terms are combined into one
+ * (Times[-1, 3, y] becomes Times[-3, y]).
+ *
+ * Values are computed by the evaluator in an empty context, so they are exactly what
+ * evaluating the calls would give. Calls that throw, or give anything but a finite
+ * numeric atom (1/0), are left for evaluation to report. Folded subtrees are atoms, which
+ * the evaluator returns as they are; subtrees without constants are shared with the input.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+namespace aleph3 {
+
+    // Replaces constant arithmetic subtrees of `expr` by their values
+    ExprPtr fold_constants(const ExprPtr& expr);
+
+    // normalize_expr(), then fold_constants()
+    ExprPtr optimize_expr(const ExprPtr& expr);
+
+} // namespace aleph3
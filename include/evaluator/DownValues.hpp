@@ -0,0 +1,118 @@
+/*
+ * DownValues.hpp
+ * --------------
+ * Specific-value definitions attached to a user function, e.g. `f[0] = 1` or the memo
+ * entries written by `f[n_] := f[n] = ...`.
+ *
+ * Entries are keyed on the evaluated call `f[args...]` and are consulted before the
+ * pattern definition. An entry written in the scope that owns the definition is a
+ * definition in its own right and persists. An entry written from inside a call (a memo)
+ * is a cached result: it is dropped as soon as the owning scope's variables or functions
+ * change, since the value may depend on them.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/ExprHash.hpp"
+#include "evaluator/EvaluationContext.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+struct DownValues {
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+    };
+
+    // Value stored for `key`, or nullptr
+    ExprPtr lookup(const ExprPtr& key, const EvaluationContext& owner) {
+        std::lock_guard lock(mutex);
+        sync(owner);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++misses;
+            return nullptr;
+        }
+        ++hits;
+        return it->second.value;
+    }
+
+    void store(const ExprPtr& key, const ExprPtr& value, bool memo, const EvaluationContext& owner) {
+        std::lock_guard lock(mutex);
+        sync(owner);
+        auto& entry = entries[key];
+        // An explicit definition is never demoted to a memo
+        entry.memo = entry.value ? entry.memo && memo : memo;
+        entry.value = value;
+    }
+
+    // An explicit definition made outside evaluation, e.g. one read from a snapshot
+    void define(const ExprPtr& key, const ExprPtr& value) {
+        std::lock_guard lock(mutex);
+        entries[key] = { value, false };
+    }
+
+    // Explicit definitions (not memos), in no particular order
+    std::vector<std::pair<ExprPtr, ExprPtr>> definitions() {
+        std::lock_guard lock(mutex);
+        std::vector<std::pair<ExprPtr, ExprPtr>> out;
+        for (const auto& [key, entry] : entries) {
+            if (!entry.memo) out.emplace_back(key, entry.value);
+        }
+        return out;
+    }
+
+    Stats stats() {
+        std::lock_guard lock(mutex);
+        return { hits, misses, entries.size() };
+    }
+
+private:
+    struct Entry {
+        ExprPtr value;
+        bool memo = false;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<ExprPtr, Entry, ExprPtrHash, ExprPtrEqual> entries;
+    uint64_t variables_version = 0;  // Owner state the memo entries were computed under
+    uint64_t functions_version = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    void sync(const EvaluationContext& owner) {
+        if (owner.variables.version() == variables_version && owner.user_functions.version() == functions_version) {
+            return;
+        }
+        std::erase_if(entries, [](const auto& kv) { return kv.second.memo; });
+        variables_version = owner.variables.version();
+        functions_version = owner.user_functions.version();
+    }
+};
+
+// Downvalue table of `def`, or null if none is attached yet. The pointer is read atomically,
+// as another thread may be attaching one in downvalues_of().
+inline std::shared_ptr<DownValues> attached_downvalues(const FunctionDefinition& def) {
+    return std::atomic_load(&def.downvalues);
+}
+
+// Downvalue table of `def`, created on first use; copies of a definition share it
+inline DownValues& downvalues_of(const FunctionDefinition& def) {
+    auto attached = std::atomic_load(&def.downvalues);
+    if (!attached) {
+        auto fresh = std::make_shared<DownValues>();
+        // Another thread may have attached one since; then `attached` is that one
+        if (std::atomic_compare_exchange_strong(&def.downvalues, &attached, fresh)) attached = std::move(fresh);
+    }
+    return *attached;
+}
+
+} // namespace aleph3
@@ -1,14 +1,191 @@
 #pragma once
 
 #include <unordered_map>
+#include <memory>
+#include <vector>
 #include <string>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
 #include "expr/Expr.hpp"
 
 namespace aleph3 {
 
+class FunctionRegistry;
+class SymbolAttributes;
+
+namespace detail {
+    // Process-wide clock for state versions, so versions from different scopes never collide
+    inline std::atomic<uint64_t> state_clock{0};
+
+    inline uint64_t next_state_version() {
+        return state_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Bumped by changes that are global rather than scoped: builtin registration and
+    // specific-value definitions such as f[0] = 1
+    inline std::atomic<uint64_t> definitions_epoch{1};
+
+    inline void bump_definitions_epoch() {
+        definitions_epoch.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Entries of a Bindings map held elsewhere until first use, such as the definitions of a
+// snapshot (see Snapshot.hpp). get() may be called from several threads at once, and the
+// pointer it returns stays valid for the lifetime of the source.
+template <typename V>
+struct LazyBindings {
+    virtual ~LazyBindings() = default;
+    // The entry for `key`, materialized on the first call; nullptr if there is none
+    virtual const V* get(Atom key) const = 0;
+    virtual std::vector<Atom> names() const = 0;
+};
+
+// Atom-keyed map that records a fresh state version on every write: operator[], emplace(),
+// erase(), clear() and attach(). operator[] counts as a write because the reference it
+// returns is how entries are assigned; an entry changed through an iterator is not
+// recorded. Lookups never change the version.
+//
+// A map may also have a lazy source of entries. lookup(), count() and for_each() see those
+// entries without copying them. operator[] and non-const find() copy a lazy entry into the
+// map first. erase(), emplace(), non-const iteration and attach() copy in every lazy entry.
+// Const find() and const iteration see only the entries already in the map.
+template <typename V>
+class Bindings {
+    using Map = std::unordered_map<Atom, V>;
+
+public:
+    using iterator = typename Map::iterator;
+    using const_iterator = typename Map::const_iterator;
+
+    V& operator[](Atom key) { touch(); pull(key); return map[key]; }
+
+    iterator find(Atom key) { pull(key); return map.find(key); }
+    const_iterator find(Atom key) const { return map.find(key); }
+
+    iterator begin() { pull_all(); return map.begin(); }
+    iterator end() { pull_all(); return map.end(); }
+    const_iterator begin() const { return map.begin(); }
+    const_iterator end() const { return map.end(); }
+
+    // Entry for `key` in the map or the lazy source, or nullptr
+    const V* lookup(Atom key) const {
+        if (auto it = map.find(key); it != map.end()) return &it->second;
+        return lazy ? lazy->get(key) : nullptr;
+    }
+
+    // f(key, value) for every entry, lazy ones included
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& [key, value] : map) f(key, value);
+        if (!lazy) return;
+        for (Atom key : lazy->names()) {
+            if (!map.count(key)) f(key, *lazy->get(key));
+        }
+    }
+
+    size_t count(Atom key) const { return lookup(key) ? 1 : 0; }
+    bool contains(Atom key) const { return lookup(key) != nullptr; }
+    size_t size() const {
+        size_t n = map.size();
+        if (lazy) {
+            for (Atom key : lazy->names()) n += map.count(key) ? 0 : 1;
+        }
+        return n;
+    }
+    bool empty() const { return size() == 0; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { touch(); pull_all(); return map.emplace(std::forward<Args>(args)...); }
+    size_t erase(Atom key) { touch(); pull_all(); return map.erase(key); }
+    void clear() { touch(); lazy.reset(); map.clear(); }
+
+    // Makes `source` the lazy source, replacing entries of the same names in the map
+    void attach(std::shared_ptr<const LazyBindings<V>> source) {
+        touch();
+        pull_all();
+        for (Atom key : source->names()) map.erase(key);
+        lazy = std::move(source);
+    }
+
+    // Version of the last write (0 = never written)
+    uint64_t version() const { return version_; }
+
+private:
+    Map map;
+    std::shared_ptr<const LazyBindings<V>> lazy;
+    uint64_t version_ = 0;
+
+    void touch() { version_ = detail::next_state_version(); }
+
+    void pull(Atom key) {
+        if (!lazy || map.count(key)) return;
+        if (const V* value = lazy->get(key)) map.emplace(key, *value);
+    }
+
+    void pull_all() {
+        if (!lazy) return;
+        for (Atom key : lazy->names()) pull(key);
+        lazy.reset();
+    }
+};
+
+// A scope of variable and function bindings.
+//
+// `variables` and `user_functions` hold only this frame's own bindings; lookups that miss
+// fall through to the enclosing frame. A user-function call runs in a child frame that binds
+// just its parameters, so entering a call costs O(#params) no matter how much is in scope.
+// Writes always go to the frame they are made in and vanish with it.
 struct EvaluationContext {
-    std::unordered_map<std::string, ExprPtr> variables;
-    std::unordered_map<std::string, FunctionDefinition> user_functions;
+    Bindings<ExprPtr> variables;
+    Bindings<FunctionDefinition> user_functions;
+    // Enclosing scope. It must outlive this frame and must not be modified while this frame
+    // has bindings of its own (bind parameters after evaluating arguments), which is what
+    // makes state_token() exact.
+    const EvaluationContext* parent = nullptr;
+    // Built-ins to evaluate with, and where SetAttributes writes; nullptr for
+    // FunctionRegistry::instance() and its table. Nested frames inherit both. Neither is
+    // owned, and both must outlive the frame.
+    const FunctionRegistry* registry = nullptr;
+    SymbolAttributes* attributes = nullptr;
+
+    EvaluationContext() = default;
+
+    // New empty frame nested inside `enclosing`
+    explicit EvaluationContext(const EvaluationContext* enclosing)
+        : parent(enclosing), registry(enclosing->registry), attributes(enclosing->attributes) {}
+
+    // Innermost binding of `name`, or nullptr
+    const ExprPtr* find_variable(Atom name) const {
+        for (const EvaluationContext* frame = this; frame; frame = frame->parent) {
+            if (const ExprPtr* value = frame->variables.lookup(name)) return value;
+        }
+        return nullptr;
+    }
+
+    // Innermost definition of `name`, or nullptr; `owner` receives the frame holding it
+    const FunctionDefinition* find_function(Atom name, const EvaluationContext** owner = nullptr) const {
+        for (const EvaluationContext* frame = this; frame; frame = frame->parent) {
+            if (const FunctionDefinition* def = frame->user_functions.lookup(name)) {
+                if (owner) *owner = frame;
+                return def;
+            }
+        }
+        return nullptr;
+    }
+
+    // Changes whenever a binding visible from this frame may have changed; two frames with
+    // equal tokens see the same bindings. Versions come from one increasing clock and inner
+    // frames are written after their parents, so the newest version on the chain identifies
+    // the whole chain's state.
+    uint64_t state_token() const {
+        uint64_t token = 0;
+        for (const EvaluationContext* frame = this; frame; frame = frame->parent) {
+            token = std::max({ token, frame->variables.version(), frame->user_functions.version() });
+        }
+        return token;
+    }
 };
 
 }
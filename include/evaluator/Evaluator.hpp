@@ -18,10 +18,25 @@
 #include "expr/Expr.hpp"
 #include "evaluator/EvaluationContext.hpp"
 #include "evaluator/FunctionRegistry.hpp"
+#include "evaluator/Attributes.hpp"
 #include "evaluator/SimplificationRules.hpp"
+#include "evaluator/DownValues.hpp"
+#include "evaluator/ResultCache.hpp"
+#include "evaluator/Compiler.hpp"
+#include "evaluator/SpecialValues.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "evaluator/Threading.hpp"
+#include "evaluator/Budget.hpp"
+#include "evaluator/Profiler.hpp"
+#include "evaluator/BuiltinTables.hpp"
+#include "evaluator/ConstantFolding.hpp"
 #include "normalizer/Normalizer.hpp"
 #include "util/Overloaded.hpp"
 #include "expr/ExprUtils.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprOrder.hpp"
+#include "expr/PackedArray.hpp"
+#include "expr/LazyList.hpp"
 #include "transforms/Transforms.hpp"
 #include "ExtraMath.hpp"
 #include "Constants.hpp"
@@ -33,40 +48,221 @@
 #include <functional>
 #include <algorithm>
 #include <unordered_set>
+#include <optional>
 
 namespace aleph3 {
 
 ExprPtr evaluate(const ExprPtr& expr, EvaluationContext& ctx);
+ExprPtr evaluate_normalized(const ExprPtr& expr, EvaluationContext& ctx);
 
 ExprPtr evaluate_polynomial_function(const FunctionCall& func, EvaluationContext& ctx);
 
-inline bool is_polynomial_function(const std::string& name) {
-    static const std::unordered_set<std::string> poly_functions = {
-        "Expand", "Factor", "Collect", "GCD", "PolynomialQuotient"
-    };
-    return poly_functions.count(name) > 0;
+inline bool is_polynomial_function(Atom name) {
+    return POLYNOMIAL_FUNCTIONS.contains(name);
+}
+
+// State that evaluation results depend on: the visible bindings and the global definitions
+struct EvalState {
+    uint64_t token;
+    uint64_t epoch;
+
+    bool operator==(const EvalState&) const = default;
+};
+
+inline EvalState evaluation_state(const EvaluationContext& ctx) {
+    return { ctx.state_token(), detail::definitions_epoch.load(std::memory_order_relaxed) };
+}
+
+// The arguments of `func` as the attributes of its head ask for them (see Attributes.hpp):
+// evaluated in ctx unless held, calls to the same Flat head spliced in, sorted if
+// Orderless. If the head is Listable and an argument is a list, returns the threaded
+// result instead, each element call evaluated; otherwise nullptr.
+inline ExprPtr prepare_arguments(const FunctionCall& func, Attributes attrs, EvaluationContext& ctx, std::vector<ExprPtr>& args) {
+    args.clear();
+    args.reserve(func.args.size());
+    for (size_t i = 0; i < func.args.size(); ++i) {
+        args.push_back(attrs.holds(i) ? func.args[i] : evaluate(func.args[i], ctx));
+    }
+
+    if (attrs.has(Attribute::Flat)) {
+        std::vector<ExprPtr> flat;
+        for (auto& arg : args) {
+            if (auto inner = std::get_if<FunctionCall>(arg.get()); inner && inner->head == func.head) {
+                flat.insert(flat.end(), inner->args.begin(), inner->args.end());
+            }
+            else {
+                flat.push_back(std::move(arg));
+            }
+        }
+        args = std::move(flat);
+    }
+
+    if (attrs.has(Attribute::Listable)) {
+        std::optional<size_t> length;
+        for (auto& arg : args) {
+            if (!std::holds_alternative<List>(*arg) && !std::holds_alternative<PackedArray>(*arg) &&
+                !std::holds_alternative<LazyList>(*arg)) {
+                continue;
+            }
+            arg = unpack(materialize(arg));
+            const size_t n = std::get<List>(*arg).elements.size();
+            if (length && *length != n) {
+                throw std::runtime_error("Listable function " + func.head.str() + " expects lists of equal length");
+            }
+            length = n;
+        }
+        if (length) {
+            std::vector<ExprPtr> results;
+            results.reserve(*length);
+            std::vector<ExprPtr> element_args(args.size());
+            for (size_t k = 0; k < *length; ++k) {
+                for (size_t i = 0; i < args.size(); ++i) {
+                    auto list = std::get_if<List>(args[i].get());
+                    element_args[i] = list ? list->elements[k] : args[i];
+                }
+                results.push_back(evaluate_normalized(make_fcall(func.head, element_args), ctx));
+            }
+            return make_list_auto_packed(std::move(results));
+        }
+    }
+
+    if (attrs.has(Attribute::Orderless)) {
+        std::stable_sort(args.begin(), args.end(), CanonicalLess());
+    }
+    return nullptr;
 }
 
-inline std::string expr_to_key(const ExprPtr& expr) {
-    auto norm = normalize_expr(expr);
-    std::string s = to_string_raw(norm);
-    s.erase(std::remove(s.begin(), s.end(), ' '), s.end());
-    return s;
+// Applies the user definition `def`, held by frame `owner`, to `func`: specific values
+// first, then the pattern definition in a child frame binding the parameters
+inline ExprPtr apply_user_function(const FunctionCall& func, const FunctionDefinition& def,
+                                   const EvaluationContext& owner, EvaluationContext& ctx) {
+    // Arguments are prepared in the caller's scope before opening the child frame
+    std::vector<ExprPtr> args;
+    if (auto threaded = prepare_arguments(func, registry_of(ctx).attributes(func.head, ctx), ctx, args)) {
+        return threaded;
+    }
+
+    if (auto downvalues = attached_downvalues(def)) {
+        if (auto value = downvalues->lookup(make_fcall(func.head, args), owner)) {
+            return value;
+        }
+    }
+    if (!def.body) {
+        // Only specific values are defined, and none matched
+        return make_fcall(func.head, args);
+    }
+
+    size_t param_count = def.params.size();
+    size_t arg_count = args.size();
+    if (arg_count > param_count) {
+        throw std::runtime_error("Function " + func.head.str() + " expects at most " +
+            std::to_string(param_count) + " arguments, got " +
+            std::to_string(arg_count));
+    }
+    // Fill in defaults for missing trailing arguments
+    for (size_t i = arg_count; i < param_count; ++i) {
+        if (def.params[i].default_value == nullptr) {
+            throw std::runtime_error("Function " + func.head.str() + " expects at least " +
+                std::to_string(i + 1) + " arguments, got " +
+                std::to_string(arg_count));
+        }
+        args.push_back(evaluate(def.params[i].default_value, ctx));
+    }
+
+    // A numeric body runs as bytecode while every argument is a machine number, unless a
+    // function it relies on has since been given a user definition
+    if (def.compiled) {
+        const auto& heads = def.compiled->heads;
+        const bool redefined = std::any_of(heads.begin(), heads.end(), [&ctx](Atom head) {
+            return ctx.find_function(head) != nullptr;
+        });
+        if (!redefined) {
+            if (auto value = run_compiled(*def.compiled, args)) return value;
+        }
+    }
+
+    // Child frame holding only the parameter bindings
+    EvaluationContext local_ctx(&ctx);
+    for (size_t i = 0; i < param_count; ++i) {
+        local_ctx.variables[def.params[i].name] = args[i];
+    }
+    return evaluate(def.body, local_ctx);
+}
+
+// Applies `compiled`, a CompiledFunction[{params}, body] value, to `func`: as bytecode on
+// machine numbers, otherwise by evaluating the body with the parameters bound
+inline ExprPtr apply_compiled_function(const FunctionCall& func, const ExprPtr& compiled, EvaluationContext& ctx) {
+    const auto& node = std::get<FunctionCall>(*compiled);
+    const auto& params = std::get<List>(*node.args[0]).elements;
+    if (func.args.size() != params.size()) {
+        throw std::runtime_error("CompiledFunction expects " + std::to_string(params.size()) +
+            " arguments, got " + std::to_string(func.args.size()));
+    }
+    std::vector<ExprPtr> args;
+    args.reserve(func.args.size());
+    for (const auto& arg : func.args) {
+        args.push_back(evaluate(arg, ctx));
+    }
+    if (auto program = compiled_function_of(compiled)) {
+        if (auto value = run_compiled(*program, args)) return value;
+    }
+
+    EvaluationContext local_ctx(&ctx);
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (auto sym = std::get_if<Symbol>(params[i].get())) local_ctx.variables[sym->name] = args[i];
+    }
+    return evaluate(node.args[1], local_ctx);
+}
+
+// Set[lhs, rhs]: a variable assignment, or a specific value such as f[0] = 1. Written from
+// inside a call to f's own scope chain it is a memo (f[n_] := f[n] = ...).
+inline ExprPtr evaluate_set(const FunctionCall& func, EvaluationContext& ctx) {
+    if (func.args.size() != 2) throw std::runtime_error("Set expects exactly 2 arguments");
+    auto value = evaluate(func.args[1], ctx);
+    if (auto sym = std::get_if<Symbol>(func.args[0].get())) {
+        ctx.variables[sym->name] = value;
+        return value;
+    }
+    auto* target = std::get_if<FunctionCall>(func.args[0].get());
+    if (!target) {
+        throw std::runtime_error("Set: cannot assign to " + to_string(func.args[0]));
+    }
+    std::vector<ExprPtr> args;
+    args.reserve(target->args.size());
+    for (const auto& arg : target->args) {
+        args.push_back(evaluate(arg, ctx));
+    }
+
+    const EvaluationContext* owner = nullptr;
+    const FunctionDefinition* def = ctx.find_function(target->head, &owner);
+    if (!def) {
+        ctx.user_functions[target->head] = FunctionDefinition(target->head, {}, nullptr, true);
+        def = ctx.find_function(target->head, &owner);
+    }
+    const bool memo = owner != &ctx;
+    downvalues_of(*def).store(make_fcall(target->head, args), value, memo, *owner);
+    if (!memo) {
+        // A new definition can change results stamped as final
+        detail::bump_definitions_epoch();
+    }
+    return value;
 }
 
 inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ctx) {
-    const std::string& name = func.head;
+    Atom name = func.head;
     size_t nargs = func.args.size();
 
     // 1. Try FunctionRegistry (for extensible built-ins)
-    auto& registry = FunctionRegistry::instance();
-    if (registry.has_function(name)) {
-        auto handler = registry.get_function(name);
-        return handler(func, ctx);
+    const auto& registry = registry_of(ctx);
+    if (FunctionHandle handle = registry.resolve(func); handle != NO_FUNCTION) {
+        return registry.handler(handle)(func, ctx);
     }
 
     // 2. Special forms
-    if (name == "If") {
+    if (name == atoms::Set) {
+        return evaluate_set(func, ctx);
+    }
+    if (name == atoms::If) {
         if (nargs != 3) throw std::runtime_error("If expects exactly 3 arguments");
         auto condition = evaluate(func.args[0], ctx);
         if (std::holds_alternative<Boolean>(*condition)) {
@@ -75,12 +271,12 @@ inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ct
         }
         return make_expr<FunctionCall>(name, func.args);
     }
-    if (name == "Expand") {
+    if (name == atoms::Expand) {
         if (nargs != 1) throw std::runtime_error("Expand expects exactly one argument");
         auto arg = evaluate(func.args[0], ctx);
         return expand(arg);
     }
-    if (name == "Negate") {
+    if (name == atoms::Negate) {
         if (nargs != 1) throw std::runtime_error("Negate expects exactly 1 argument");
         auto arg = evaluate(func.args[0], ctx);
         if (std::holds_alternative<Number>(*arg)) {
@@ -93,7 +289,7 @@ inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ct
         }
         // If arg is already Times(-1, ...), flatten
         if (auto inner = std::get_if<FunctionCall>(arg.get())) {
-            if (inner->head == "Times" && !inner->args.empty()) {
+            if (inner->head == atoms::Times && !inner->args.empty()) {
                 if (auto n = std::get_if<Number>(inner->args[0].get()); n && n->value == -1) {
                     // Already normalized
                     return arg;
@@ -101,362 +297,87 @@ inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ct
             }
         }
         // Otherwise, return Times(-1, arg)
-        return make_fcall("Times", { make_expr<Number>(-1), arg });
-    }
-
-    // 3. Built-in function maps
-    static const std::unordered_map<std::string, std::function<double(double)>> unary_functions = {
-        {"Sin",   [](double x) { return std::sin(x); }},
-        {"Cos",   [](double x) { return std::cos(x); }},
-        {"Tan",   [](double x) { return std::tan(x); }},
-        {"Csc",   [](double x) { return csc(x); }},
-        {"Sec",   [](double x) { return sec(x); }},
-        {"Sinh",  [](double x) { return std::sinh(x); }},
-        {"Cosh",  [](double x) { return std::cosh(x); }},
-        {"Tanh",  [](double x) { return std::tanh(x); }},
-        {"Coth",  [](double x) { return coth(x); }},
-        {"Sech",  [](double x) { return sech(x); }},
-        {"Csch",  [](double x) { return csch(x); }},
-        {"Cot",   [](double x) { return cot(x); }},
-        {"Abs",   [](double x) { return std::fabs(x); }},
-        {"Sqrt",  [](double x) { return std::sqrt(x); }},
-        {"Exp",   [](double x) { return std::exp(x); }},
-        {"Log",   [](double x) { return std::log(x); }},
-        {"Floor", [](double x) { return std::floor(x); }},
-        {"Ceiling",[](double x) { return std::ceil(x); }},
-        {"Round", [](double x) { return std::round(x); }},
-        {"ArcSin",[](double x) { return std::asin(x); }},
-        {"ArcCos",[](double x) { return std::acos(x); }},
-        {"ArcTan",[](double x) { return std::atan(x); }},
-        {"Gamma", [](double x) { return std::tgamma(x); }}
-    };
-    static const std::unordered_map<std::string, std::function<double(double, double)>> binary_functions = {
-        {"Plus",   [](double a, double b) { return a + b; }},
-        {"Minus",  [](double a, double b) { return a - b; }},
-        {"Times",  [](double a, double b) { return a * b; }},
-        {"Divide", [](double a, double b) { return a / b; }},
-        {"Power",  [](double a, double b) { return std::pow(a, b); }},
-        {"Log",    [](double b, double x) { return std::log(x) / std::log(b); }},
-        {"ArcTan", [](double x, double y) { return std::atan2(y, x); }}
-    };
-    static const std::unordered_map<std::string, std::function<bool(double, double)>> comparison_functions = {
-        {"Equal",         [](double a, double b) { return a == b; }},
-        {"NotEqual",      [](double a, double b) { return a != b; }},
-        {"Less",          [](double a, double b) { return a < b; }},
-        {"Greater",       [](double a, double b) { return a > b; }},
-        {"LessEqual",     [](double a, double b) { return a <= b; }},
-        {"GreaterEqual",  [](double a, double b) { return a >= b; }}
-    };
-
-    static const std::unordered_map<std::string, std::unordered_map<std::string, ExprPtr>> known_symbolic_unary = {
-        {"Sin", {
-            {"0", make_expr<Number>(0.0)},
-            {"Pi", make_expr<Number>(0.0)},
-            {"2*Pi", make_expr<Number>(0.0)},
-            {"-1*Pi", make_expr<Number>(0.0)},
-            {"Pi/2", make_expr<Number>(1.0)},
-            {"-1*Pi/2", make_expr<Number>(-1.0)},
-            {"Pi/4", make_expr<Number>(std::sqrt(2.0) / 2.0)},
-            {"-1*Pi/4", make_expr<Number>(-std::sqrt(2.0) / 2.0)},
-            {"3*Pi/2", make_expr<Number>(-1.0)},
-            {"-1*3*Pi/2", make_expr<Number>(1.0)}
-        }},
-        {"Cos", {
-            {"0", make_expr<Number>(1.0)},
-            {"Pi", make_expr<Number>(-1.0)},
-            {"2*Pi", make_expr<Number>(1.0)},
-            {"-1*Pi", make_expr<Number>(-1.0)},
-            {"Pi/2", make_expr<Number>(0.0)},
-            {"-1*Pi/2", make_expr<Number>(0.0)},
-            {"Pi/4", make_expr<Number>(std::sqrt(2.0) / 2.0)},
-            {"-1*Pi/4", make_expr<Number>(std::sqrt(2.0) / 2.0)},
-            {"3*Pi/2", make_expr<Number>(0.0)},
-            {"-1*3*Pi/2", make_expr<Number>(0.0)}
-        }},
-        {"Tan", {
-            {"0", make_expr<Number>(0.0)},
-            {"Pi", make_expr<Number>(0.0)},
-            {"2*Pi", make_expr<Number>(0.0)},
-            {"-1*Pi", make_expr<Number>(0.0)},
-            {"Pi/4", make_expr<Number>(1.0)},
-            {"-1*Pi/4", make_expr<Number>(-1.0)},
-            {"Pi/6", make_expr<Number>(std::tan(PI / 6))},
-            {"-1*Pi/6", make_expr<Number>(std::tan(-PI / 6))},
-            {"Pi/3", make_expr<Number>(std::tan(PI / 3))},
-            {"-1*Pi/3", make_expr<Number>(std::tan(-PI / 3))}
-        }},
-        {"Sinc", {
-            {"0", make_expr<Number>(1.0)},
-            {"Pi", make_expr<Number>(std::sin(PI) / PI)},
-            {"-1*Pi", make_expr<Number>(std::sin(-PI) / -PI)},
-            {"2*Pi", make_expr<Number>(std::sin(2 * PI) / (2 * PI))},
-            {"-1*2*Pi", make_expr<Number>(std::sin(-2 * PI) / (-2 * PI))}
-        }},
-        {"Cot", {
-            {"0", make_expr<Infinity>()},
-            {"Pi/4", make_expr<Number>(1.0)},
-            {"-1*Pi/4", make_expr<Number>(-1.0)},
-            {"Pi/2", make_expr<Number>(0.0)},
-            {"-1*Pi/2", make_expr<Number>(0.0)},
-            {"Pi", make_expr<Infinity>()},
-            {"-1*Pi", make_expr<Infinity>()}
-        }},
-        {"Csc", {
-            {"0", make_expr<Infinity>()},
-            {"Pi/2", make_expr<Number>(1.0)},
-            {"-1*Pi/2", make_expr<Number>(-1.0)},
-            {"Pi", make_expr<Infinity>()},
-            {"-1*Pi", make_expr<Infinity>()},
-            {"Pi/6", make_expr<Number>(2.0)},
-            {"-1*Pi/6", make_expr<Number>(-2.0)}
-        }}
-    };
-
-    static const std::unordered_map<std::string, std::function<bool(double)>> unary_real_domains = {
-        // Inverse trig
-        {"ArcSin", [](double x) { return x >= -1.0 && x <= 1.0; }},
-        {"ArcCos", [](double x) { return x >= -1.0 && x <= 1.0; }},
-        {"ArcTan", [](double) { return true; }},
-
-        // Logarithm
-        {"Log",    [](double x) { return x > 0.0; }},
-        {"Ln",     [](double x) { return x > 0.0; }},
-
-        // Square root and roots
-        {"Sqrt",   [](double x) { return x >= 0.0; }},
-        {"Root",   [](double x) { return x >= 0.0; }}, // for even roots
-
-        // Reciprocal trig
-        {"ArcSec", [](double x) { return std::abs(x) >= 1.0; }},
-        {"ArcCsc", [](double x) { return std::abs(x) >= 1.0; }},
-        {"ArcCot", [](double) { return true; }},
-
-        // Factorial/Gamma
-        {"Gamma",  [](double x) { return x > 0.0; }}, // real-valued for x > 0
-    };
-
-    static const std::unordered_map<std::string, std::string> inverse_unary_pairs = {
-        {"Sin", "ArcSin"},
-        {"Cos", "ArcCos"},
-        {"Tan", "ArcTan"},
-        {"Exp", "Log"},
-        {"Log", "Exp"},
-        {"Abs", "Abs"},
-        {"ArcSin", "Sin"},
-        {"ArcCos", "Cos"},
-        {"ArcTan", "Tan"}
-    };
-
-    // 4. Elementwise/broadcasted binary operations
-    auto elementwise = [&ctx](const std::string& op, const ExprPtr& a, const ExprPtr& b) -> ExprPtr {
-        if (std::holds_alternative<List>(*a) && std::holds_alternative<List>(*b)) {
-            const auto& l1 = std::get<List>(*a).elements;
-            const auto& l2 = std::get<List>(*b).elements;
-            if (l1.size() != l2.size())
-                throw std::runtime_error("List sizes must match for elementwise operation");
-            std::vector<ExprPtr> result;
-            for (size_t i = 0; i < l1.size(); ++i) {
-                result.push_back(evaluate(make_fcall(op, { l1[i], l2[i] }), ctx));
-            }
-            return std::make_shared<Expr>(List{ result });
-        }
-        if (std::holds_alternative<List>(*a)) {
-            const auto& l1 = std::get<List>(*a).elements;
-            std::vector<ExprPtr> result;
-            for (const auto& elem : l1) {
-                result.push_back(evaluate(make_fcall(op, { elem, b }), ctx));
-            }
-            return std::make_shared<Expr>(List{ result });
-        }
-        if (std::holds_alternative<List>(*b)) {
-            const auto& l2 = std::get<List>(*b).elements;
-            std::vector<ExprPtr> result;
-            for (const auto& elem : l2) {
-                result.push_back(evaluate(make_fcall(op, { a, elem }), ctx));
-            }
-            return std::make_shared<Expr>(List{ result });
-        }
-        return nullptr;
-        };
+        return make_fcall(atoms::Times, { make_expr<Number>(-1), arg });
+    }
 
-    // 5. Built-in unary
+    // 4. Built-in unary
     if (nargs == 1) {
-        auto it = unary_functions.find(name);
-        if (it != unary_functions.end()) {
+        if (const auto unary = kernels::unary_kernel(name)) {
             auto arg_eval = evaluate(func.args[0], ctx);
 
-            // 5.1 Inverse function simplification (table-driven)
-            auto inv_it = inverse_unary_pairs.find(name);
-            if (inv_it != inverse_unary_pairs.end()) {
+            // 4.1 Inverse function simplification (table-driven)
+            if (const Atom* inverse = INVERSE_FUNCTIONS.find(name)) {
                 auto* inner_call = std::get_if<FunctionCall>(arg_eval.get());
-                if (inner_call && inner_call->head == inv_it->second && inner_call->args.size() == 1) {
+                if (inner_call && inner_call->head == *inverse && inner_call->args.size() == 1) {
                     return evaluate(inner_call->args[0], ctx);
                 }
             }
 
-            // 5.2 Check for known symbolic values
-            auto known_func = known_symbolic_unary.find(name);
-            if (known_func != known_symbolic_unary.end()) {
-                std::string key = expr_to_key(arg_eval);
-                auto val_it = known_func->second.find(key);
-                if (val_it != known_func->second.end()) {
-                    return val_it->second;
-                }
+            // 4.2 Listable: lazy and packed arrays run through the vector kernels, lists thread per element
+            auto apply_to = [&](const ExprPtr& elem) {
+                return evaluate_normalized(make_fcall(name, { elem }), ctx);
+            };
+            arg_eval = materialize(arg_eval);
+            if (std::holds_alternative<PackedArray>(*arg_eval)) {
+                if (auto result = packed_unary(*unary, arg_eval, apply_to)) return result;
+                arg_eval = unpack(arg_eval);
+            }
+            if (auto list = std::get_if<List>(arg_eval.get())) {
+                std::vector<ExprPtr> result;
+                result.reserve(list->elements.size());
+                for (const auto& elem : list->elements) result.push_back(apply_to(elem));
+                return make_list_auto_packed(std::move(result));
+            }
+
+            // 4.3 Check for known symbolic values
+            if (auto known = special_value(name, arg_eval)) return known;
+
+            // 4.4 Complex arguments
+            if (auto z = std::get_if<Complex>(arg_eval.get())) {
+                if (auto value = complex_unary(name, *z)) return value;
             }
 
-            // 5.3 If argument is a known constant symbol, convert to number for numeric evaluation
+            // 4.5 If argument is a known constant symbol, convert to number for numeric evaluation
             if (std::holds_alternative<Symbol>(*arg_eval)) {
                 const auto& sym = std::get<Symbol>(*arg_eval);
-                if (sym.name == "E") arg_eval = make_expr<Number>(E);
-                else if (sym.name == "Pi") arg_eval = make_expr<Number>(PI);
-                else if (sym.name == "Degree") arg_eval = make_expr<Number>(PI / 180.0);
+                if (sym.name == atoms::E) arg_eval = make_expr<Number>(E);
+                else if (sym.name == atoms::Pi) arg_eval = make_expr<Number>(PI);
+                else if (sym.name == atoms::Degree) arg_eval = make_expr<Number>(PI / 180.0);
             }
 
-            // 5.4 Numeric evaluation if argument is now a number
+            // 4.6 Numeric evaluation if argument is now a number
             if (std::holds_alternative<Number>(*arg_eval)) {
                 double arg = get_number_value(arg_eval);
-                auto domain_it = unary_real_domains.find(name);
-                if (domain_it != unary_real_domains.end() && !domain_it->second(arg)) {
+                if (!kernels::in_real_domain(*unary, arg)) {
                     // Out of domain, return symbolic
                     return make_fcall(name, { arg_eval });
                 }
-                return make_expr<Number>(it->second(arg));
+                return make_expr<Number>(kernels::apply_unary(*unary, arg));
             }
 
-            // 5.5 Fallback: symbolic
+            // 4.7 Fallback: symbolic
             return make_fcall(name, { arg_eval });
         }
     }
 
-    // 6. Built-in binary (with elementwise support)
+    // 5. Built-in binary (with elementwise support)
     if (nargs == 2) {
-        auto it = binary_functions.find(name);
-        if (it != binary_functions.end()) {
+        if (const BinaryBuiltin* binary = BINARY_BUILTINS.find(name)) {
             auto left = evaluate(func.args[0], ctx);
             auto right = evaluate(func.args[1], ctx);
-            if (auto ew = elementwise(name, left, right)) return ew;
-            // Complex ops
-            if ((name == "Plus" || name == "Minus") &&
-                std::holds_alternative<Number>(*left)) {
-                double real = std::get<Number>(*left).value;
-                int sign = (name == "Plus") ? 1 : -1;
-                if (auto* times = std::get_if<FunctionCall>(right.get())) {
-                    if (times->head == "Times" && times->args.size() == 2) {
-                        if (std::holds_alternative<Number>(*times->args[0]) &&
-                            std::holds_alternative<Complex>(*times->args[1])) {
-                            double imag = std::get<Number>(*times->args[0]).value;
-                            const auto& c = std::get<Complex>(*times->args[1]);
-                            if (c.real == 0.0 && c.imag == 1.0) {
-                                return make_expr<Complex>(real, sign * imag);
-                            }
-                        }
-                    }
-                }
-            }
-            // Complex + Complex
-            if (name == "Plus" &&
-                std::holds_alternative<Complex>(*left) &&
-                std::holds_alternative<Complex>(*right)) {
-                const auto& a = std::get<Complex>(*left);
-                const auto& b = std::get<Complex>(*right);
-                return make_expr<Complex>(a.real + b.real, a.imag + b.imag);
-            }
-            // Complex * Complex
-            if (name == "Times" &&
-                std::holds_alternative<Complex>(*left) &&
-                std::holds_alternative<Complex>(*right)) {
-                const auto& a = std::get<Complex>(*left);
-                const auto& b = std::get<Complex>(*right);
-                double real = a.real * b.real - a.imag * b.imag;
-                double imag = a.real * b.imag + a.imag * b.real;
-                return make_expr<Complex>(real, imag);
-            }
-            // Complex + Number or Number + Complex
-            if (name == "Plus") {
-                if (std::holds_alternative<Complex>(*left) && std::holds_alternative<Number>(*right)) {
-                    const auto& c = std::get<Complex>(*left);
-                    double n = std::get<Number>(*right).value;
-                    return make_expr<Complex>(c.real + n, c.imag);
-                }
-                if (std::holds_alternative<Number>(*left) && std::holds_alternative<Complex>(*right)) {
-                    double n = std::get<Number>(*left).value;
-                    const auto& c = std::get<Complex>(*right);
-                    return make_expr<Complex>(n + c.real, c.imag);
-                }
-            }
-
-            // Complex * Number or Number * Complex
-            if (name == "Times") {
-                if (std::holds_alternative<Complex>(*left) && std::holds_alternative<Number>(*right)) {
-                    const auto& c = std::get<Complex>(*left);
-                    double n = std::get<Number>(*right).value;
-                    return make_expr<Complex>(c.real * n, c.imag * n);
-                }
-                if (std::holds_alternative<Number>(*left) && std::holds_alternative<Complex>(*right)) {
-                    double n = std::get<Number>(*left).value;
-                    const auto& c = std::get<Complex>(*right);
-                    return make_expr<Complex>(n * c.real, n * c.imag);
-                }
-            }
-            // Rational op Rational
-            if (std::holds_alternative<Rational>(*left) && std::holds_alternative<Rational>(*right)) {
-                const auto& a = std::get<Rational>(*left);
-                const auto& b = std::get<Rational>(*right);
-                if (name == "Plus") {
-                    auto [n, d] = normalize_rational(a.numerator * b.denominator + b.numerator * a.denominator,
-                        a.denominator * b.denominator);
-                    return make_expr<Rational>(n, d);
-                }
-                if (name == "Minus") {
-                    auto [n, d] = normalize_rational(a.numerator * b.denominator - b.numerator * a.denominator,
-                        a.denominator * b.denominator);
-                    return make_expr<Rational>(n, d);
-                }
-                if (name == "Times") {
-                    auto [n, d] = normalize_rational(a.numerator * b.numerator, a.denominator * b.denominator);
-                    return make_expr<Rational>(n, d);
-                }
-                if (name == "Divide") {
-                    if (b.numerator == 0) throw std::runtime_error("Division by zero");
-                    auto [n, d] = normalize_rational(a.numerator * b.denominator, a.denominator * b.numerator);
-                    return make_expr<Rational>(n, d);
-                }
-            }
-            // Rational op Number
-            if (std::holds_alternative<Rational>(*left) && std::holds_alternative<Number>(*right)) {
-                const auto& a = std::get<Rational>(*left);
-                double b = std::get<Number>(*right).value;
-                if (std::floor(b) == b) {
-                    auto b_rat = Rational(static_cast<int64_t>(b), 1);
-                    return evaluate(make_fcall(name, { left, make_expr<Rational>(b_rat.numerator, b_rat.denominator) }), ctx);
-                }
-                else {
-                    double a_val = static_cast<double>(a.numerator) / a.denominator;
-                    return make_expr<Number>(it->second(a_val, b));
-                }
-            }
-            // Number op Rational
-            if (std::holds_alternative<Number>(*left) && std::holds_alternative<Rational>(*right)) {
-                double a = std::get<Number>(*left).value;
-                const auto& b = std::get<Rational>(*right);
-                if (std::floor(a) == a) {
-                    auto a_rat = Rational(static_cast<int64_t>(a), 1);
-                    return evaluate(make_fcall(name, { make_expr<Rational>(a_rat.numerator, a_rat.denominator), right }), ctx);
-                }
-                else {
-                    double b_val = static_cast<double>(b.numerator) / b.denominator;
-                    return make_expr<Number>(it->second(a, b_val));
-                }
-            }
+            // Numbers, rationals, complex numbers and packed arrays: one dispatch on the pair of types
+            if (auto value = numeric_binary(name, left, right)) return value;
+            if (auto ew = thread_binary(name, left, right, ctx, evaluate_normalized)) return ew;
+            // Binary forms outside the arithmetic table (Log, ArcTan)
             if (std::holds_alternative<Number>(*left) && std::holds_alternative<Number>(*right)) {
                 double a = get_number_value(left);
                 double b = get_number_value(right);
-                return make_expr<Number>(it->second(a, b));
+                return make_expr<Number>(apply_builtin(*binary, a, b));
             }
             // If we reach here, try the simplification rule for this operation
             auto simp_it = simplification_rules.find(name);
             if (simp_it != simplification_rules.end()) {
-                return simp_it->second({left, right}, ctx, evaluate);
+                return simp_it->second({left, right}, ctx, evaluate_normalized);
             }
             ALEPH3_LOG("No numeric/special case for " << name << " with args: "
                 << to_string_raw(left) << ", " << to_string_raw(right)
@@ -465,90 +386,78 @@ inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ct
             return make_fcall(name, { left, right });
         }
         // Comparison functions
-        auto cmp = comparison_functions.find(name);
-        if (cmp != comparison_functions.end()) {
+        if (const Comparison* cmp = COMPARISONS.find(name)) {
             auto left = evaluate(func.args[0], ctx);
             auto right = evaluate(func.args[1], ctx);
             if (std::holds_alternative<Number>(*left) && std::holds_alternative<Number>(*right)) {
                 double arg1 = get_number_value(left);
                 double arg2 = get_number_value(right);
-                return make_expr<Boolean>(cmp->second(arg1, arg2));
+                return make_expr<Boolean>(compare(*cmp, arg1, arg2));
             }
             // Rational op Rational
             if (std::holds_alternative<Rational>(*left) && std::holds_alternative<Rational>(*right)) {
                 const auto& a = std::get<Rational>(*left);
                 const auto& b = std::get<Rational>(*right);
-                if (name == "Equal")
+                if (name == atoms::Equal)
                     return make_expr<Boolean>(a.numerator == b.numerator && a.denominator == b.denominator);
-                if (name == "NotEqual")
+                if (name == atoms::NotEqual)
                     return make_expr<Boolean>(a.numerator != b.numerator || a.denominator != b.denominator);
-                if (name == "Less")
+                if (name == atoms::Less)
                     return make_expr<Boolean>(a.numerator * b.denominator < b.numerator * a.denominator);
-                if (name == "Greater")
+                if (name == atoms::Greater)
                     return make_expr<Boolean>(a.numerator * b.denominator > b.numerator * a.denominator);
-                if (name == "LessEqual")
+                if (name == atoms::LessEqual)
                     return make_expr<Boolean>(a.numerator * b.denominator <= b.numerator * a.denominator);
-                if (name == "GreaterEqual")
+                if (name == atoms::GreaterEqual)
                     return make_expr<Boolean>(a.numerator * b.denominator >= b.numerator * a.denominator);
             }
             // Rational op Number
             if (std::holds_alternative<Rational>(*left) && std::holds_alternative<Number>(*right)) {
                 const auto& a = std::get<Rational>(*left);
                 double b = std::get<Number>(*right).value;
-                double a_val = static_cast<double>(a.numerator) / a.denominator;
-                return make_expr<Boolean>(cmp->second(a_val, b));
+                double a_val = a.value();
+                return make_expr<Boolean>(compare(*cmp, a_val, b));
             }
             // Number op Rational
             if (std::holds_alternative<Number>(*left) && std::holds_alternative<Rational>(*right)) {
                 double a = std::get<Number>(*left).value;
                 const auto& b = std::get<Rational>(*right);
-                double b_val = static_cast<double>(b.numerator) / b.denominator;
-                return make_expr<Boolean>(cmp->second(a, b_val));
+                double b_val = b.value();
+                return make_expr<Boolean>(compare(*cmp, a, b_val));
+            }
+            if (name == atoms::Equal || name == atoms::NotEqual) {
+                if (auto equal = complex_equal(left, right)) return make_expr<Boolean>(*equal == (name == atoms::Equal));
             }
             // Return unevaluated symbolic comparison if not both numbers
             return make_fcall(name, { left, right });
         }
     }
 
-    // 7. Centralized simplification for known functions
+    // 6. Centralized simplification for known functions
     auto simp_it = simplification_rules.find(name);
     if (simp_it != simplification_rules.end()) {
-        return simp_it->second(func.args, ctx, evaluate);
-    }
-
-    // 8. User-defined functions
-    auto user_it = ctx.user_functions.find(name);
-    if (user_it != ctx.user_functions.end()) {
-        const FunctionDefinition& def = user_it->second;
-        size_t param_count = def.params.size();
-        size_t arg_count = func.args.size();
-        std::vector<ExprPtr> final_args;
-        for (size_t i = 0; i < param_count; ++i) {
-            if (i < arg_count) {
-                final_args.push_back(func.args[i]);
-            }
-            else if (def.params[i].default_value != nullptr) {
-                final_args.push_back(def.params[i].default_value);
-            }
-            else {
-                throw std::runtime_error("Function " + name + " expects at least " +
-                    std::to_string(i + 1) + " arguments, got " +
-                    std::to_string(arg_count));
-            }
-        }
-        if (arg_count > param_count) {
-            throw std::runtime_error("Function " + name + " expects at most " +
-                std::to_string(param_count) + " arguments, got " +
-                std::to_string(arg_count));
-        }
-        EvaluationContext local_ctx = ctx;
-        for (size_t i = 0; i < param_count; ++i) {
-            local_ctx.variables[def.params[i].name] = final_args[i];
-        }
-        return evaluate(def.body, local_ctx);
+        return simp_it->second(func.args, ctx, evaluate_normalized);
     }
 
-    // 9. Fallback: return unevaluated
+    // 7. User-defined functions
+    const EvaluationContext* owner = nullptr;
+    if (const FunctionDefinition* def = ctx.find_function(name, &owner)) {
+        return apply_user_function(func, *def, *owner, ctx);
+    }
+
+    // 8. A variable holding a compiled function, as in cf = Compile[{x}, ...]; cf[2]
+    if (const ExprPtr* bound = ctx.find_variable(name); bound && is_compiled_function(**bound)) {
+        return apply_compiled_function(func, *bound, ctx);
+    }
+
+    // 9. A symbol with attributes (SetAttributes) gets its arguments prepared by them
+    if (const Attributes attrs = registry.attributes(name, ctx); !attrs.empty()) {
+        std::vector<ExprPtr> args;
+        if (auto threaded = prepare_arguments(func, attrs, ctx, args)) return threaded;
+        return make_fcall(name, std::move(args));
+    }
+
+    // 10. Fallback: return unevaluated
     std::vector<ExprPtr> unevaluated_args;
     for (const auto& arg : func.args) {
         unevaluated_args.push_back(arg);
@@ -556,112 +465,114 @@ inline ExprPtr evaluate_function(const FunctionCall& func, EvaluationContext& ct
     return make_expr<FunctionCall>(name, unevaluated_args);
 }
 
-inline ExprPtr evaluate(const ExprPtr& expr, EvaluationContext& ctx, std::unordered_set<std::string>& visited) {
+inline const EvalStamp* eval_stamp(const Expr& e) {
+    if (auto f = std::get_if<FunctionCall>(&e)) return &f->evaluated;
+    if (auto l = std::get_if<List>(&e)) return &l->evaluated;
+    return nullptr;
+}
+
+inline ExprPtr evaluate(const ExprPtr& expr, EvaluationContext& ctx, std::unordered_set<Atom>& visited) {
+    // A node already evaluated in the current state is a fixed point
+    const EvalState state = evaluation_state(ctx);
+    if (const EvalStamp* stamp = eval_stamp(*expr); stamp && stamp->matches(state.token, state.epoch)) {
+        return expr;
+    }
+    BudgetFrame frame;
     ALEPH3_LOG("evaluate: input = " << to_string_raw(expr));
     auto result = std::visit(overloaded{
-        [](const Number& num) -> ExprPtr {
-            return make_expr<Number>(num.value);
-        },
-        [](const Complex& c) -> ExprPtr {
-            return make_expr<Complex>(c.real, c.imag);
-        },
-        [](const Rational& r) -> ExprPtr {
+        // Atoms evaluate to themselves; return the input node rather than a copy
+        [&](const Number&) -> ExprPtr { return expr; },
+        [&](const Complex&) -> ExprPtr { return expr; },
+        [&](const Rational& r) -> ExprPtr {
             auto [n, d] = normalize_rational(r.numerator, r.denominator);
+            if (n == r.numerator && d == r.denominator) return expr;
             return make_expr<Rational>(n, d);
         },
-        [](const Boolean& boolean) -> ExprPtr {
-            return make_expr<Boolean>(boolean.value);
-        },
-        [](const String& str) -> ExprPtr {
-            return make_expr<String>(str.value);
-        },
+        [&](const Boolean&) -> ExprPtr { return expr; },
+        [&](const String&) -> ExprPtr { return expr; },
         [&](const Symbol& sym) -> ExprPtr {
             if (visited.count(sym.name)) {
                 // Detected recursion, return symbol unevaluated
-                return make_expr<Symbol>(sym.name);
+                return expr;
             }
-            auto it = ctx.variables.find(sym.name);
-            if (it == ctx.variables.end()) {
-                return make_expr<Symbol>(sym.name);
+            const ExprPtr* bound = ctx.find_variable(sym.name);
+            if (!bound) {
+                return expr;
             }
             visited.insert(sym.name);
-            auto result = evaluate(it->second, ctx, visited);
+            auto result = evaluate(*bound, ctx, visited);
             visited.erase(sym.name);
             return result;
         },
         [&ctx](const FunctionCall& func) -> ExprPtr {
+            ProfileScope profile(func.head);
             if (is_polynomial_function(func.head)) {
-                return evaluate_polynomial_function(func, ctx);
+                auto& cache = ResultCache::instance();
+                if (!cache.enabled()) {
+                    return evaluate_polynomial_function(func, ctx);
+                }
+                // Pure built-ins: key the cache on the call with evaluated arguments
+                std::vector<ExprPtr> args;
+                args.reserve(func.args.size());
+                for (const auto& arg : func.args) {
+                    args.push_back(evaluate(arg, ctx));
+                }
+                auto key = make_fcall(func.head, args);
+                const EvalState state = evaluation_state(ctx);
+                if (auto cached = cache.lookup(key, state.token, state.epoch)) {
+                    return cached;
+                }
+                auto result = evaluate_polynomial_function(std::get<FunctionCall>(*key), ctx);
+                cache.store(key, result, state.token, state.epoch);
+                return result;
             }
             // Special case: List
-            if (func.head == "List") {
+            if (func.head == atoms::List) {
                 std::vector<ExprPtr> evaluated_elements;
+                evaluated_elements.reserve(func.args.size());
                 for (const auto& arg : func.args) {
                     evaluated_elements.push_back(evaluate(arg, ctx));
                 }
-                return std::make_shared<Expr>(List{evaluated_elements});
+                return make_list_auto_packed(std::move(evaluated_elements));
             }
 
             // Check for user-defined functions
-            auto user_it = ctx.user_functions.find(func.head);
-            if (user_it != ctx.user_functions.end()) {
-                const FunctionDefinition& def = user_it->second;
-                size_t param_count = def.params.size();
-                size_t arg_count = func.args.size();
-
-                // Prepare argument list, filling in defaults if needed
-                std::vector<ExprPtr> final_args;
-                for (size_t i = 0; i < param_count; ++i) {
-                    if (i < arg_count) {
-                        final_args.push_back(func.args[i]);
-                    }
-                    else if (def.params[i].default_value != nullptr) {
-                        final_args.push_back(def.params[i].default_value);
-                    }
-                    else {
-                        throw std::runtime_error("Function " + func.head + " expects at least " +
-                            std::to_string(i + 1) + " arguments, got " +
-                            std::to_string(arg_count));
-                    }
-                }
-
-                // Too many arguments
-                if (arg_count > param_count) {
-                    throw std::runtime_error("Function " + func.head + " expects at most " +
-                        std::to_string(param_count) + " arguments, got " +
-                        std::to_string(arg_count));
-                }
-
-                // Create a new context for the function evaluation
-                EvaluationContext local_ctx = ctx;
-
-                // Bind formal parameters to actual arguments
-                for (size_t i = 0; i < param_count; ++i) {
-                    auto arg_value = evaluate(final_args[i], ctx);
-                    local_ctx.variables[def.params[i].name] = arg_value;
-                }
-
-                // Evaluate the function body in the new context
-                return evaluate(def.body, local_ctx);
+            const EvaluationContext* owner = nullptr;
+            if (const FunctionDefinition* def = ctx.find_function(func.head, &owner)) {
+                return apply_user_function(func, *def, *owner, ctx);
             }
             // If not a user-defined function, evaluate as a built-in function
             return evaluate_function(func, ctx);
         },
         [&ctx](const FunctionDefinition& def) -> ExprPtr {
 
+            // Specific values already given for this name in this frame stay in effect
+            std::shared_ptr<DownValues> downvalues;
+            const auto& frame_functions = ctx.user_functions;
+            if (const FunctionDefinition* existing = frame_functions.lookup(def.name)) {
+                downvalues = attached_downvalues(*existing);
+            }
+
             // Store the function definition in the context
             if (def.delayed) {
                 // Delayed assignment: store the unevaluated body
-                ctx.user_functions[def.name] = def;
+                auto& stored = ctx.user_functions[def.name];
+                stored = def;
+                if (def.body) stored.body = optimize_expr(def.body); // Once, not on every call
+                stored.compiled = compile_definition(stored);
+                stored.downvalues = downvalues;
             }
             else {
                 // Immediate assignment: evaluate the body immediately
-                EvaluationContext local_ctx = ctx;
+                EvaluationContext local_ctx(&ctx);
                 for (const auto& param : def.params) {
                     local_ctx.variables[param.name] = make_expr<Symbol>(param.name); // Bind parameters symbolically
                 }
                 auto evaluated_body = evaluate(def.body, local_ctx);
-                ctx.user_functions[def.name] = FunctionDefinition(def.name, def.params, evaluated_body, false);
+                auto& stored = ctx.user_functions[def.name];
+                stored = FunctionDefinition(def.name, def.params, evaluated_body, false);
+                stored.compiled = compile_definition(stored);
+                stored.downvalues = downvalues;
                 return evaluated_body;
             }
             // Return the full function definition as feedback
@@ -679,26 +590,152 @@ inline ExprPtr evaluate(const ExprPtr& expr, EvaluationContext& ctx, std::unorde
             auto rhs = evaluate(rule.rhs, ctx, visited);
             return make_expr<Rule>(lhs, rhs);
         },
-        [](const List& list) -> ExprPtr {
+        [&](const List&) -> ExprPtr {
             // Lists are already evaluated, just return as-is
-            return std::make_shared<Expr>(list);
-        },
-        [](const Infinity&) -> ExprPtr {
-            return make_expr<Infinity>();
-        },
-        [](const Indeterminate&) -> ExprPtr {
-            return make_expr<Indeterminate>();
+            return expr;
         },
+        [&](const Infinity&) -> ExprPtr { return expr; },
+        [&](const Indeterminate&) -> ExprPtr { return expr; },
+        [&](const PackedArray&) -> ExprPtr { return expr; },
+        [&](const LazyList&) -> ExprPtr { return expr; },
         }, 
         *expr);
         ALEPH3_LOG("evaluate: result = " << to_string_raw(result));
+        // Stamp the result unless evaluation changed the state it depends on, or ran under a
+        // recursion guard (then it may not be a fixed point)
+        if (const EvalStamp* stamp = eval_stamp(*result); stamp && visited.empty() && evaluation_state(ctx) == state) {
+            stamp->set(state.token, state.epoch);
+        }
         return result;
 }
 
+// Heads whose built-in evaluation needs nothing but their evaluated arguments and has no
+// side effects, so sibling subtrees can be evaluated in any order
+inline bool is_pure_head(Atom head, const EvaluationContext& ctx) {
+    return PURE_HEADS.contains(head) && !ctx.find_function(head);
+}
+
+inline bool is_current(const Expr& e, const EvalState& state) {
+    const EvalStamp* stamp = eval_stamp(e);
+    return stamp && stamp->matches(state.token, state.epoch);
+}
+
+// Evaluates the pure subcalls of `expr` bottom-up on an explicit stack and returns `expr`
+// with them replaced by their (stamped) values. Each built-in then finds its arguments
+// already evaluated, so evaluating the root recurses only one level however deep the tree
+// is. Trees containing anything impure (assignments, control flow, user functions, rules)
+// are returned unchanged and evaluate in the usual order, recursively: their depth is
+// bounded by the depth limit and stack guard of Budget.hpp, which end a too-deep
+// evaluation with BudgetExceeded. Simplifying and expanding the result recurse as well.
+//
+// The tree may be a DAG: a node shared by several parents (the same pointer, or equal
+// subtrees after hash-consing) is checked and evaluated once, and every parent gets the
+// same value, so the work is linear in the distinct nodes.
+inline ExprPtr pre_evaluate_arguments(const ExprPtr& expr, EvaluationContext& ctx) {
+    const EvalState state = evaluation_state(ctx);
+    auto is_pending_call = [&](const ExprPtr& e) {
+        return std::holds_alternative<FunctionCall>(*e) && !is_current(*e, state);
+    };
+
+    // Pass 1: the whole unevaluated part of the tree must be pure
+    bool deep = false;
+    {
+        std::vector<const FunctionCall*> todo{ &std::get<FunctionCall>(*expr) };
+        std::unordered_set<const Expr*> seen; // Shared nodes already queued
+        while (!todo.empty()) {
+            const FunctionCall* f = todo.back();
+            todo.pop_back();
+            if (!is_pure_head(f->head, ctx)) return expr;
+            for (const auto& arg : f->args) {
+                if (std::holds_alternative<Rule>(*arg) || std::holds_alternative<Assignment>(*arg) ||
+                    std::holds_alternative<FunctionDefinition>(*arg)) {
+                    return expr;
+                }
+                if (is_pending_call(arg)) {
+                    deep |= f != &std::get<FunctionCall>(*expr);
+                    if (arg.use_count() > 1 && !seen.insert(arg.get()).second) continue;
+                    todo.push_back(&std::get<FunctionCall>(*arg));
+                }
+            }
+        }
+    }
+    if (!deep) return expr; // Nothing below the first level; the root evaluates it directly
+
+    // Pass 2: post-order evaluation of the calls below the root
+    struct Frame {
+        ExprPtr node;
+        size_t next = 0;
+        std::vector<ExprPtr> args;
+        bool changed = false;
+    };
+    std::vector<Frame> stack;
+    size_t depth = 0;
+    std::unordered_map<const Expr*, ExprPtr> shared; // Values of nodes with several parents
+    auto push = [&](const ExprPtr& node) {
+        if (depth == stack.size()) stack.emplace_back();
+        Frame& frame = stack[depth++];
+        frame.node = node;
+        frame.next = 0;
+        frame.args.clear();
+        frame.args.reserve(std::get<FunctionCall>(*node).args.size());
+        frame.changed = false;
+    };
+
+    push(expr);
+    ExprPtr result;
+    while (depth > 0) {
+        Frame& top = stack[depth - 1];
+        const auto& args = std::get<FunctionCall>(*top.node).args;
+        if (top.next < args.size()) {
+            const ExprPtr& arg = args[top.next++];
+            if (auto it = arg.use_count() > 1 ? shared.find(arg.get()) : shared.end(); it != shared.end()) {
+                top.changed |= it->second != arg;
+                top.args.push_back(it->second);
+            }
+            else if (is_pending_call(arg)) {
+                push(arg); // may reallocate `stack`; `top` is not used again this iteration
+            }
+            else {
+                top.args.push_back(arg);
+            }
+            continue;
+        }
+
+        ExprPtr node = top.changed ? make_fcall(std::get<FunctionCall>(*top.node).head, top.args) : top.node;
+        top.node.reset();
+        --depth;
+        if (depth == 0) {
+            result = std::move(node);
+            break;
+        }
+        std::unordered_set<Atom> visited;
+        ExprPtr value = evaluate(node, ctx, visited);
+        Frame& parent = stack[depth - 1];
+        const ExprPtr& original = std::get<FunctionCall>(*parent.node).args[parent.next - 1];
+        if (original.use_count() > 1) shared.emplace(original.get(), value);
+        parent.changed |= value != original;
+        parent.args.push_back(std::move(value));
+    }
+    return result;
+}
+
+// Public entry point: canonicalizes `expr` (only the parts not normalized before), then
+// evaluates it
 inline ExprPtr evaluate(const ExprPtr& expr, EvaluationContext& ctx) {
     ExprPtr norm = normalize_expr(expr);
-    std::unordered_set<std::string> visited;
+    if (std::holds_alternative<FunctionCall>(*norm) && !is_current(*norm, evaluation_state(ctx))) {
+        norm = pre_evaluate_arguments(norm, ctx);
+    }
+    std::unordered_set<Atom> visited;
     return evaluate(norm, ctx, visited);
 }
 
+// Internal entry point for nodes built by the evaluator itself on top of normalized or
+// evaluated operands: only the new root is normalized
+inline ExprPtr evaluate_normalized(const ExprPtr& expr, EvaluationContext& ctx) {
+    std::unordered_set<Atom> visited;
+    if (detail::is_normal_node(*expr)) return evaluate(expr, ctx, visited);
+    return evaluate(detail::mark_normal(detail::normalize_node(expr)), ctx, visited);
+}
+
 }
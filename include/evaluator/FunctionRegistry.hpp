@@ -1,15 +1,46 @@
+/*
+ * FunctionRegistry.hpp
+ * --------------------
+ * Handlers of the built-in heads, looked up by atom id.
+ *
+ * FunctionRegistry::instance() is the process-wide registry that the CLI, the server and
+ * plain EvaluationContexts use. An Engine (Engine.hpp) builds a registry of its own and
+ * freezes it, after which it is only read and may be shared by any number of threads.
+ * Registering is not synchronized: a registry must not be read while it is being filled.
+ *
+ * Call nodes cache the handle of their head together with the generation of the registry
+ * that resolved it. Generations come from one process-wide counter, so a node evaluated
+ * under two registries never takes one's handle for the other's.
+ */
 #pragma once
 
 #include "expr/Expr.hpp"
 #include "evaluator/EvaluationContext.hpp"
-#include <unordered_map>
+#include "evaluator/BuiltinTables.hpp"
+#include <deque>
+#include <vector>
 #include <functional>
 #include <stdexcept>
+#include <cstdint>
+#include <atomic>
 
 namespace aleph3 {
 
 using FunctionHandler = std::function<ExprPtr(const FunctionCall&, EvaluationContext&)>;
 
+// Stable index of a registered handler; NO_FUNCTION means "no handler for this head"
+using FunctionHandle = uint32_t;
+inline constexpr FunctionHandle NO_FUNCTION = 0;
+
+namespace detail {
+    // Generations handed out to registries; 0 marks an empty node cache
+    inline std::atomic<uint32_t> registry_generations{ 0 };
+
+    inline uint32_t next_registry_generation() {
+        return registry_generations.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+}
+
 class FunctionRegistry {
 public:
     static FunctionRegistry& instance() {
@@ -17,27 +48,114 @@ public:
         return registry;
     }
 
-    void register_function(const std::string& name, FunctionHandler handler) {
-        handlers[name] = handler;
+    FunctionRegistry() = default;
+
+    FunctionRegistry(const FunctionRegistry&) = delete;
+    FunctionRegistry& operator=(const FunctionRegistry&) = delete;
+
+    // Registers (or replaces) the handler for `name`; the returned handle never changes.
+    // Throws std::logic_error once the registry is frozen.
+    FunctionHandle register_function(Atom name, FunctionHandler handler) {
+        if (frozen_) throw std::logic_error("Cannot register " + name.str() + ": the function registry is frozen");
+        if (by_atom.size() <= name.id()) by_atom.resize(name.id() + 1, NO_FUNCTION);
+        FunctionHandle& slot = by_atom[name.id()];
+        if (slot == NO_FUNCTION) {
+            handlers.push_back(std::move(handler));
+            slot = static_cast<FunctionHandle>(handlers.size() - 1);
+        }
+        else {
+            handlers[slot] = std::move(handler);
+        }
+        // Cached misses and results evaluated under the old handlers are stale
+        generation_ = detail::next_registry_generation();
+        detail::bump_definitions_epoch();
+        return slot;
+    }
+
+    // One array index; no hashing
+    FunctionHandle resolve(Atom name) const {
+        return name.id() < by_atom.size() ? by_atom[name.id()] : NO_FUNCTION;
     }
 
-    FunctionHandler get_function(const std::string& name) const {
-        auto it = handlers.find(name);
-        if (it != handlers.end()) {
-            return it->second;
+    // Handle for `func.head`, served from the node's dispatch cache while it is current
+    FunctionHandle resolve(const FunctionCall& func) const {
+        uint32_t cached_generation;
+        uint32_t handle;
+        if (func.dispatch_cache.load(cached_generation, handle) && cached_generation == generation_) {
+            return handle;
         }
-        throw std::runtime_error("Unknown function: " + name);
+        handle = resolve(func.head);
+        func.dispatch_cache.store(generation_, handle);
+        return handle;
     }
 
-    bool has_function(const std::string& name) const {
-        return handlers.find(name) != handlers.end();
+    // The reference stays valid while other functions are registered (a handler may register
+    // one), since the handlers live in a deque; replacing this function's handler overwrites it
+    const FunctionHandler& handler(FunctionHandle handle) const {
+        return handlers[handle];
     }
 
-private:
-    std::unordered_map<std::string, FunctionHandler> handlers;
+    const FunctionHandler& get_function(Atom name) const {
+        FunctionHandle handle = resolve(name);
+        if (handle != NO_FUNCTION) {
+            return handlers[handle];
+        }
+        throw std::runtime_error("Unknown function: " + name.str());
+    }
 
-    // Private constructor for singleton pattern
-    FunctionRegistry() = default;
+    bool has_function(Atom name) const {
+        return resolve(name) != NO_FUNCTION;
+    }
+
+    // Changes on every registration
+    uint32_t generation() const { return generation_; }
+
+    // Makes further register_function() calls throw, so the registry can be shared
+    void freeze() { frozen_ = true; }
+    bool frozen() const { return frozen_; }
+
+    // Attributes of `name`: fixed for built-in heads, otherwise as given by set_attributes()
+    Attributes attributes(Atom name) const {
+        if (const Attributes* builtin = BUILTIN_ATTRIBUTES.find(name)) return *builtin;
+        return user_attributes_.get(name);
+    }
+
+    // Attributes of `name` as a call evaluated in `ctx` sees them: from the context's
+    // table if it names one
+    Attributes attributes(Atom name, const EvaluationContext& ctx) const {
+        if (const Attributes* builtin = BUILTIN_ATTRIBUTES.find(name)) return *builtin;
+        return symbol_attributes(ctx).get(name);
+    }
+
+    // The table SetAttributes writes to in `ctx`. Symbol attributes are not part of what
+    // freeze() fixes; the table synchronizes itself.
+    SymbolAttributes& symbol_attributes(const EvaluationContext& ctx) const {
+        return ctx.attributes ? *ctx.attributes : user_attributes_;
+    }
+
+    // Whether `name` is a built-in head, whose attributes cannot be changed
+    bool is_builtin(Atom name) const {
+        return name.id() < BUILTIN_ATOM_COUNT || has_function(name);
+    }
+
+    // Replaces the attributes of the symbol `name`. Results evaluated under the old ones
+    // are stale.
+    void set_attributes(Atom name, Attributes attrs) {
+        user_attributes_.set(name, attrs);
+        detail::bump_definitions_epoch();
+    }
+
+private:
+    std::deque<FunctionHandler> handlers{ FunctionHandler() };  // Slot 0 is NO_FUNCTION
+    std::vector<FunctionHandle> by_atom;                        // Indexed by Atom::id()
+    uint32_t generation_ = detail::next_registry_generation();
+    bool frozen_ = false;
+    mutable SymbolAttributes user_attributes_;                  // Symbols given attributes by SetAttributes
 };
 
-}
\ No newline at end of file
+// The registry `ctx` evaluates with
+inline const FunctionRegistry& registry_of(const EvaluationContext& ctx) {
+    return ctx.registry ? *ctx.registry : FunctionRegistry::instance();
+}
+
+}
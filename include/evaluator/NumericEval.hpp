@@ -0,0 +1,30 @@
+/*
+ * NumericEval.hpp
+ * ---------------
+ * Machine-precision evaluation for N[] that does not build intermediate expressions.
+ *
+ * The first time an expression is seen it is compiled (Compiler.hpp, CompileMode::Machine)
+ * with its free symbols as parameters, and the program is cached by structure. Each call
+ * then fills the parameter slots from the variable bindings in the context, runs the
+ * bytecode on this thread's registers and allocates only the final Number, Complex or
+ * Boolean. Pi, E, Degree and rationals become register constants.
+ *
+ * numeric_value() returns nullptr when this does not apply, and N[] then evaluates the
+ * expression exactly before converting it. That happens when a free symbol is unbound or
+ * not bound to a number, when a function the expression uses has a user definition, when
+ * the result leaves the machine domain, when the expression has no free symbols at all,
+ * and when an exact constant sits below a transcendental function or Power. In the last
+ * two cases exact evaluation gives special values (Sin[Pi] -> 0, Log[E] -> 1) that
+ * machine arithmetic only approximates.
+ */
+#pragma once
+
+#include "evaluator/EvaluationContext.hpp"
+#include "expr/Expr.hpp"
+
+namespace aleph3 {
+
+    // N[expr] for a normalized `expr`, computed with machine numbers, or nullptr
+    ExprPtr numeric_value(const ExprPtr& expr, const EvaluationContext& ctx);
+
+} // namespace aleph3
@@ -0,0 +1,47 @@
+/*
+ * NumericTower.hpp
+ * ----------------
+ * Arithmetic between numeric atoms: machine reals (Number), exact rationals and machine
+ * complex numbers.
+ *
+ * numeric_binary() makes one indirect call through a table indexed by the operation and
+ * the variant indices of its two operands, instead of a chain of type tests. The table is
+ * generated at compile time from the Expr alternatives: numeric pairs get an arithmetic
+ * handler, a packed or lazy array with an array or a numeric scalar goes to the buffer
+ * kernels (affine maps of a lazy range stay lazy), and every other pair is empty. Exact operands stay exact: rational pairs, and rationals with integer Numbers, give
+ * rationals. Any complex operand makes the result a machine complex, collapsed to a
+ * Number when its imaginary part is 0. Integer powers of complex numbers are computed by
+ * repeated squaring, so Gaussian integers stay exact while they fit in a double.
+ *
+ * Results that need the evaluator's rules (exact powers such as 4^(1/2), division of a
+ * complex by 0, non-finite values) come back as nullptr and the caller goes on to
+ * SimplificationRules.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/VectorKernels.hpp"
+
+#include <optional>
+
+namespace aleph3 {
+
+    enum class NumericKind : uint8_t { Number, Rational, Complex };
+
+    // Kind of a numeric atom, or nullopt for anything else
+    std::optional<NumericKind> numeric_kind(const Expr& e);
+
+    // a op b for op in Plus, Minus, Times, Divide and Power on numeric atoms and packed
+    // arrays, or nullptr. Throws on an exact division by zero.
+    ExprPtr numeric_binary(Atom op, const ExprPtr& a, const ExprPtr& b);
+    ExprPtr numeric_binary(kernels::Binary op, const ExprPtr& a, const ExprPtr& b);
+
+    // a == b for numeric atoms of which at least one is complex; nullopt otherwise. Order
+    // comparisons are not defined on complex numbers.
+    std::optional<bool> complex_equal(const ExprPtr& a, const ExprPtr& b);
+
+    // f[z] for an elementary f with a complex form (Exp, Log, Sqrt, Abs, the trigonometric
+    // and hyperbolic functions and their inverses), or nullptr
+    ExprPtr complex_unary(Atom f, const Complex& z);
+
+} // namespace aleph3
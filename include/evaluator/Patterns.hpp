@@ -0,0 +1,103 @@
+/*
+ * Patterns.hpp
+ * ------------
+ * Pattern matching and rule application: ReplaceAll (expr /. rules) and ReplaceRepeated
+ * (expr //. rules).
+ *
+ * Patterns are symbols spelled with blanks, as the parser reads them:
+ * - x_ matches any one expression and binds it to x; _ matches without binding
+ * - x__ matches a sequence of one or more arguments, x___ of zero or more; the sequence
+ *   is bound as Sequence[...] and spliced into argument lists it is substituted into
+ * - a head after the blanks restricts what matches: x_Integer, __Symbol, _f (one of
+ *   Integer, Real, Rational, Complex, String, Symbol, List, Rule, or a call's head)
+ * - Condition[p, test], written p /; test, matches what p matches if test, with the
+ *   bindings substituted, evaluates to True. A rule lhs -> rhs /; test applies only if
+ *   test holds.
+ * A name used twice must bind the same expression both times. Arguments are matched in
+ * order; f[x_, y_] does not match f[a] and x_ + y_ matches a sum of exactly two terms.
+ *
+ * A RuleSet compiles its rules once and indexes their left sides in a discrimination
+ * net: each left side is read in preorder as a path of keys (a call's head and arity, an
+ * atom's hash, the head a blank requires, or a wildcard), and the paths share a trie. Finding the
+ * rules that may match an expression walks the trie along the expression, so the cost
+ * depends on the depth of the left sides and not on how many rules there are. Only the
+ * rules found are tried, in their original order, and the first that matches applies.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "evaluator/EvaluationContext.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    enum class BlankKind : uint8_t { Blank, BlankSequence, BlankNullSequence };
+
+    // A symbol read as a pattern: name empty for _, head empty for any expression
+    struct BlankSymbol {
+        Atom name;
+        BlankKind kind;
+        Atom head;
+    };
+
+    // The pattern a symbol name spells, as x_, x__Integer or ___, or nullopt
+    std::optional<BlankSymbol> parse_blank(std::string_view symbol);
+
+    // Integer, Real, Rational, Complex, String, Symbol, List, Rule, or the head of a call
+    Atom expr_head(const Expr& expr);
+
+    // Values bound to the names of a pattern, in order of binding
+    using PatternBindings = std::vector<std::pair<Atom, ExprPtr>>;
+
+    // `expr` with the bound names replaced by their values
+    ExprPtr substitute(const ExprPtr& expr, const PatternBindings& bindings);
+
+    // PatternBindings of the first match of `pattern` against `expr`, or nullopt. Conditions are
+    // evaluated in `ctx`.
+    std::optional<PatternBindings> match_pattern(const ExprPtr& pattern, const ExprPtr& expr, EvaluationContext& ctx);
+
+    class RuleSet {
+    public:
+        // A Rule, or a list of them; throws std::runtime_error for anything else
+        explicit RuleSet(const ExprPtr& rules);
+        ~RuleSet();
+
+        RuleSet(const RuleSet&) = delete;
+        RuleSet& operator=(const RuleSet&) = delete;
+
+        // The right side of the first rule whose left side matches `expr`, with the
+        // bindings substituted (not evaluated), or nullptr
+        ExprPtr apply(const ExprPtr& expr, EvaluationContext& ctx) const;
+
+        // Indices of the rules the net finds for `expr`, ascending: every rule that can
+        // match is among them
+        std::vector<uint32_t> candidates(const ExprPtr& expr) const;
+
+        size_t size() const;
+
+    private:
+        struct Compiled;
+        std::unique_ptr<Compiled> compiled_;
+    };
+
+    // The compiled rule set for `rules`, shared with earlier calls on the same node
+    std::shared_ptr<const RuleSet> compile_rules(const ExprPtr& rules);
+
+    // `expr` with each outermost subexpression a rule matches replaced once, not
+    // evaluated; `changed` is set if any rule applied
+    ExprPtr replace_all(const ExprPtr& expr, const RuleSet& rules, EvaluationContext& ctx, bool* changed = nullptr);
+
+    // Most passes of ReplaceRepeated before it gives up
+    inline constexpr size_t MAX_REPLACE_ITERATIONS = 65536;
+
+    // Evaluated replace_all() passes until the result no longer changes; throws
+    // std::runtime_error after MAX_REPLACE_ITERATIONS
+    ExprPtr replace_repeated(const ExprPtr& expr, const RuleSet& rules, EvaluationContext& ctx);
+
+} // namespace aleph3
@@ -0,0 +1,94 @@
+/*
+ * Profiler.hpp
+ * ------------
+ * Instrumentation of evaluate() that is switched at run time: calls and time per head, and
+ * optionally a trace of every call in the Chrome trace-event format (chrome://tracing,
+ * Perfetto).
+ *
+ * While the profiler is off, a ProfileScope costs one relaxed atomic load. While it is on,
+ * each call reads the steady clock on entry and exit and updates counters kept per thread,
+ * so threads never contend. Self time excludes the calls nested inside; total time counts
+ * a recursive head only at its outermost call. Traces keep at most TRACE_EVENT_LIMIT
+ * events per thread and count the rest as dropped.
+ *
+ * Scopes opened while the profiler is on are recorded even if it is stopped before they
+ * close. start() clears what earlier runs gathered.
+ */
+#pragma once
+
+#include "expr/Atom.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace aleph3 {
+
+    inline constexpr size_t TRACE_EVENT_LIMIT = size_t(1) << 20;
+
+    struct HeadProfile {
+        Atom head;
+        uint64_t calls = 0;
+        std::chrono::nanoseconds self{ 0 };
+        std::chrono::nanoseconds total{ 0 };
+    };
+
+    struct ProfileReport {
+        std::vector<HeadProfile> heads;  // By decreasing self time
+        size_t trace_events = 0;
+        size_t dropped_events = 0;
+    };
+
+    namespace detail {
+        inline std::atomic<bool> profiling{ false };
+    }
+
+    class Profiler {
+    public:
+        static Profiler& instance();
+
+        bool enabled() const { return detail::profiling.load(std::memory_order_relaxed); }
+        bool tracing() const { return tracing_.load(std::memory_order_relaxed); }
+
+        // Clears the counters and the trace, and starts recording
+        void start(bool trace = false);
+        void stop();
+
+        ProfileReport report() const;
+        // A table of the heads by self time, then the expression pool's memory counters
+        void write_flat_profile(std::ostream& out) const;
+        // The trace as a JSON object with a traceEvents array of complete ("X") events
+        void write_trace(std::ostream& out) const;
+
+        // Used by ProfileScope
+        void enter(Atom head);
+        void leave();
+
+    private:
+        Profiler() = default;
+
+        std::atomic<bool> tracing_{ false };
+        std::atomic<uint64_t> generation_{ 0 };  // Bumped by start(); stale thread counters reset lazily
+    };
+
+    // Records one call to `head` in the profiler, if it is on when the scope opens
+    class ProfileScope {
+    public:
+        explicit ProfileScope(Atom head) : armed_(detail::profiling.load(std::memory_order_relaxed)) {
+            if (armed_) Profiler::instance().enter(head);
+        }
+        ~ProfileScope() {
+            if (armed_) Profiler::instance().leave();
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        bool armed_;
+    };
+
+} // namespace aleph3
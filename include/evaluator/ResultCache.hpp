@@ -0,0 +1,68 @@
+/*
+ * ResultCache.hpp
+ * ---------------
+ * Opt-in, bounded LRU cache of results of pure built-ins (the polynomial functions Expand,
+ * Factor, Collect, GCD, PolynomialQuotient, PolynomialEvaluate, Coefficient, CoefficientList,
+ * Exponent, GroebnerBasis, PolynomialReduce, Resultant, Discriminant, Subresultants,
+ * Together and Cancel), keyed on the call with its arguments already evaluated.
+ *
+ * Entries remember the evaluation state they were computed in and only hit in the same
+ * state, so any change to visible variables or definitions invalidates them. The cache is
+ * disabled (capacity 0) until set_capacity() is called.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/ExprHash.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace aleph3 {
+
+class ResultCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t capacity = 0;
+    };
+
+    static ResultCache& instance();
+
+    // Maximum number of entries; 0 disables the cache and drops its contents
+    void set_capacity(size_t capacity);
+    bool enabled() const { return capacity_.load(std::memory_order_relaxed) > 0; }
+
+    // Cached result of `call` computed in state (token, epoch), or nullptr
+    ExprPtr lookup(const ExprPtr& call, uint64_t token, uint64_t epoch);
+    void store(const ExprPtr& call, const ExprPtr& result, uint64_t token, uint64_t epoch);
+
+    void clear();
+    Stats stats();
+
+private:
+    struct Entry {
+        ExprPtr call;
+        ExprPtr result;
+        uint64_t token;
+        uint64_t epoch;
+    };
+    using Order = std::list<Entry>; // Most recently used first
+
+    std::mutex mutex;
+    std::atomic<size_t> capacity_{0};
+    Order order;
+    std::unordered_map<ExprPtr, Order::iterator, ExprPtrHash, ExprPtrEqual> index;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    ResultCache() = default;
+    void evict_to(size_t size);
+};
+
+} // namespace aleph3
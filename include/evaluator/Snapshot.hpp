@@ -0,0 +1,35 @@
+/*
+ * Snapshot.hpp
+ * ------------
+ * Session snapshots: the variables and user functions of an EvaluationContext saved to one
+ * file and attached to another context without re-evaluating the code that made them.
+ *
+ * A snapshot holds an index of names followed by one expression per binding in the binary
+ * format of Serialize.hpp. A function is stored with its parameters, their defaults, its
+ * body and its specific values such as f[0] = 1; memo entries are not saved.
+ *
+ * load_snapshot() maps the file into memory and reads only the index. Each binding is
+ * deserialized on the first lookup of its name (see LazyBindings), so loading tens of
+ * thousands of definitions costs about as much as reading their names. The mapping stays
+ * open as long as the context refers to it, and the file must not change meanwhile.
+ */
+#pragma once
+
+#include "evaluator/EvaluationContext.hpp"
+
+#include <string>
+
+namespace aleph3 {
+
+    inline constexpr uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+
+    // Writes every binding visible from ctx, its enclosing frames included, to `path`.
+    // Throws SerializationError if the file cannot be written.
+    void save_snapshot(const EvaluationContext& ctx, const std::string& path);
+
+    // Attaches the bindings of the snapshot at `path` to ctx's own frame; they replace
+    // bindings of the same names. Throws SerializationError if the file cannot be read or
+    // its index is malformed; a corrupt binding throws when it is first looked up.
+    void load_snapshot(EvaluationContext& ctx, const std::string& path);
+
+} // namespace aleph3
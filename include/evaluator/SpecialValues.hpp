@@ -0,0 +1,34 @@
+/*
+ * SpecialValues.hpp
+ * -----------------
+ * Known values of elementary functions at exact arguments, such as Sin[Pi/2] or Cot[0].
+ *
+ * Arguments are indexed structurally, as an exact rational multiple of a unit: Pi for
+ * arguments like 3*Pi/2, Times[Rational[3, 2], Pi] or -(Pi/4), and 1 for plain integers
+ * and rationals. No printing or normalizing is involved. A table can be periodic in Pi, so
+ * one entry covers every argument congruent to its key. Machine numbers other than 0 never
+ * match Pi-multiple keys, and tables without rational keys reject them at once.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <optional>
+
+namespace aleph3 {
+
+    // p/q * unit in lowest terms with q > 0; unit is Pi, or empty for a plain rational.
+    // Zero always has an empty unit.
+    struct RationalMultiple {
+        Atom unit;
+        BigInt p;
+        BigInt q;
+    };
+
+    // `e` as an exact rational multiple of Pi or of 1, or nullopt
+    std::optional<RationalMultiple> rational_multiple(const Expr& e);
+
+    // Known value of head[arg], or nullptr if there is none
+    ExprPtr special_value(Atom head, const ExprPtr& arg);
+
+} // namespace aleph3
@@ -0,0 +1,31 @@
+/*
+ * Threading.hpp
+ * -------------
+ * Listable binary arithmetic over lists, as Plus, Times, Power and the other binary
+ * built-ins thread: {a, b} op {c, d} is {a op c, b op d}, a scalar pairs with every
+ * element, and nested lists thread level by level, so {{1, 2}, {3, 4}} + {10, 20} is
+ * {{11, 12}, {23, 24}}.
+ *
+ * The operation is resolved once. Numeric elements, and packed rows, are combined directly
+ * by the numeric tower (numeric_binary, which runs packed arrays on their buffers), so
+ * adding two numeric lists builds no call nodes; only pairs that need symbolic rules are
+ * built as op[x, y] and evaluated. Elements are already evaluated, and the walk uses an
+ * explicit stack, so deep nesting does not recurse.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "evaluator/EvaluationContext.hpp"
+
+#include <functional>
+
+namespace aleph3 {
+
+    using ElementEvaluator = std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>;
+
+    // a op b threaded over the lists in a and b, or nullptr if neither is a list. Pairs
+    // without a numeric value are evaluated by `eval`; lists paired at the same level must
+    // have equal lengths.
+    ExprPtr thread_binary(Atom op, const ExprPtr& a, const ExprPtr& b, EvaluationContext& ctx, const ElementEvaluator& eval);
+
+} // namespace aleph3
@@ -0,0 +1,206 @@
+/*
+ * Atom.hpp
+ * --------
+ * Interned symbol and head names for Aleph3.
+ *
+ * An Atom is a small integer ID standing for a name in a process-wide atom table.
+ * Creating an Atom from a string costs one hash lookup; copying, hashing and comparing
+ * Atoms are single integer operations. Symbol names, function heads and context keys
+ * are all Atoms, so the evaluator never hashes or compares strings on its hot paths.
+ *
+ * Well-known names used by the evaluator ("Plus", "Times", "List", ...) are seeded into
+ * the table in a fixed order, so they are available as compile-time constants in
+ * `aleph3::atoms` (e.g. `f.head == atoms::Plus`).
+ */
+#pragma once
+
+#include <iterator>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace aleph3 {
+
+// Names pre-interned with fixed IDs; index 0 is the empty name.
+inline constexpr std::string_view BUILTIN_ATOM_NAMES[] = {
+    "",
+    // Arithmetic
+    "Plus", "Times", "Minus", "Divide", "Power", "Negate",
+    // Structural heads
+    "List", "Rule", "Rational", "Complex", "Set",
+    // Control flow and logic
+    "If", "And", "Or", "Not",
+    // Comparison
+    "Equal", "NotEqual", "Less", "Greater", "LessEqual", "GreaterEqual",
+    // Polynomial functions
+    "Expand", "Factor", "Collect", "GCD", "PolynomialQuotient", "PolynomialEvaluate",
+    "Coefficient", "CoefficientList", "Exponent", "GroebnerBasis", "PolynomialReduce",
+    "Resultant", "Discriminant", "Subresultants", "Together", "Cancel",
+    // Strings
+    "StringJoin",
+    // Constants and literals
+    "Pi", "E", "Degree", "I", "True", "False", "Infinity", "Indeterminate",
+    // Elementary functions
+    "Sin", "Cos", "Tan", "Csc", "Sec", "Cot", "Sinc",
+    "Sinh", "Cosh", "Tanh", "Coth", "Sech", "Csch",
+    "ArcSin", "ArcCos", "ArcTan", "Abs", "Sqrt", "Exp", "Log",
+    "Floor", "Ceiling", "Round", "Gamma",
+    // Lists
+    "Range", "Table", "Map", "Select",
+    // Misc
+    "N", "Length", "FullForm", "Short", "DirectedInfinity", "Sequence",
+    // Instrumentation
+    "Timing", "AbsoluteTiming", "TimeConstrained", "MemoryConstrained",
+    // Compilation
+    "Compile", "CompiledFunction",
+    // Patterns and rules
+    "ReplaceAll", "ReplaceRepeated", "Condition", "Integer", "Real", "String", "Symbol",
+    // Calculus
+    "D", "Grad",
+};
+
+class Atom {
+public:
+    // The empty atom
+    constexpr Atom() : id_(0) {}
+
+    // Intern a name (one hash lookup)
+    Atom(const char* name) : Atom(std::string_view(name)) {}
+    Atom(const std::string& name) : Atom(std::string_view(name)) {}
+    Atom(std::string_view name) : id_(intern(name)) {}
+
+    // Build an atom from a table ID (no validation)
+    static constexpr Atom from_id(uint32_t id) {
+        Atom a;
+        a.id_ = id;
+        return a;
+    }
+
+    constexpr uint32_t id() const { return id_; }
+
+    // Interned name; the reference stays valid for the lifetime of the process
+    const std::string& str() const;
+
+    operator const std::string&() const { return str(); }
+
+    bool empty() const { return id_ == 0; }
+
+    constexpr bool operator==(const Atom& other) const { return id_ == other.id_; }
+    // Orders by interning order, not alphabetically
+    constexpr bool operator<(const Atom& other) const { return id_ < other.id_; }
+
+    friend bool operator==(const Atom& a, const char* s) { return a.str() == s; }
+    friend bool operator==(const Atom& a, const std::string& s) { return a.str() == s; }
+    friend bool operator==(const Atom& a, std::string_view s) { return a.str() == s; }
+
+    friend std::ostream& operator<<(std::ostream& os, const Atom& a) { return os << a.str(); }
+
+    // Number of atoms interned so far
+    static size_t table_size();
+
+private:
+    uint32_t id_;
+
+    static uint32_t intern(std::string_view name);
+};
+
+// Compile-time lookup of a pre-interned name; fails to compile for unknown names
+consteval Atom builtin_atom(std::string_view name) {
+    for (size_t i = 0; i < std::size(BUILTIN_ATOM_NAMES); ++i) {
+        if (BUILTIN_ATOM_NAMES[i] == name) return Atom::from_id(static_cast<uint32_t>(i));
+    }
+    throw "builtin_atom: name is not in BUILTIN_ATOM_NAMES";
+}
+
+namespace atoms {
+    inline constexpr Atom Plus = builtin_atom("Plus");
+    inline constexpr Atom Times = builtin_atom("Times");
+    inline constexpr Atom Minus = builtin_atom("Minus");
+    inline constexpr Atom Divide = builtin_atom("Divide");
+    inline constexpr Atom Power = builtin_atom("Power");
+    inline constexpr Atom Negate = builtin_atom("Negate");
+    inline constexpr Atom List = builtin_atom("List");
+    inline constexpr Atom Rule = builtin_atom("Rule");
+    inline constexpr Atom Rational = builtin_atom("Rational");
+    inline constexpr Atom Complex = builtin_atom("Complex");
+    inline constexpr Atom Set = builtin_atom("Set");
+    inline constexpr Atom If = builtin_atom("If");
+    inline constexpr Atom And = builtin_atom("And");
+    inline constexpr Atom Or = builtin_atom("Or");
+    inline constexpr Atom Not = builtin_atom("Not");
+    inline constexpr Atom Equal = builtin_atom("Equal");
+    inline constexpr Atom NotEqual = builtin_atom("NotEqual");
+    inline constexpr Atom Less = builtin_atom("Less");
+    inline constexpr Atom Greater = builtin_atom("Greater");
+    inline constexpr Atom LessEqual = builtin_atom("LessEqual");
+    inline constexpr Atom GreaterEqual = builtin_atom("GreaterEqual");
+    inline constexpr Atom Expand = builtin_atom("Expand");
+    inline constexpr Atom Factor = builtin_atom("Factor");
+    inline constexpr Atom Collect = builtin_atom("Collect");
+    inline constexpr Atom GCD = builtin_atom("GCD");
+    inline constexpr Atom PolynomialQuotient = builtin_atom("PolynomialQuotient");
+    inline constexpr Atom PolynomialEvaluate = builtin_atom("PolynomialEvaluate");
+    inline constexpr Atom Coefficient = builtin_atom("Coefficient");
+    inline constexpr Atom CoefficientList = builtin_atom("CoefficientList");
+    inline constexpr Atom Exponent = builtin_atom("Exponent");
+    inline constexpr Atom GroebnerBasis = builtin_atom("GroebnerBasis");
+    inline constexpr Atom PolynomialReduce = builtin_atom("PolynomialReduce");
+    inline constexpr Atom Resultant = builtin_atom("Resultant");
+    inline constexpr Atom Discriminant = builtin_atom("Discriminant");
+    inline constexpr Atom Subresultants = builtin_atom("Subresultants");
+    inline constexpr Atom Together = builtin_atom("Together");
+    inline constexpr Atom Cancel = builtin_atom("Cancel");
+    inline constexpr Atom StringJoin = builtin_atom("StringJoin");
+    inline constexpr Atom Pi = builtin_atom("Pi");
+    inline constexpr Atom E = builtin_atom("E");
+    inline constexpr Atom Degree = builtin_atom("Degree");
+    inline constexpr Atom I = builtin_atom("I");
+    inline constexpr Atom True = builtin_atom("True");
+    inline constexpr Atom False = builtin_atom("False");
+    inline constexpr Atom Sin = builtin_atom("Sin");
+    inline constexpr Atom Cos = builtin_atom("Cos");
+    inline constexpr Atom Tan = builtin_atom("Tan");
+    inline constexpr Atom Csc = builtin_atom("Csc");
+    inline constexpr Atom Cot = builtin_atom("Cot");
+    inline constexpr Atom Sinc = builtin_atom("Sinc");
+    inline constexpr Atom Sec = builtin_atom("Sec");
+    inline constexpr Atom Sinh = builtin_atom("Sinh");
+    inline constexpr Atom Cosh = builtin_atom("Cosh");
+    inline constexpr Atom Tanh = builtin_atom("Tanh");
+    inline constexpr Atom Coth = builtin_atom("Coth");
+    inline constexpr Atom Sech = builtin_atom("Sech");
+    inline constexpr Atom Csch = builtin_atom("Csch");
+    inline constexpr Atom ArcSin = builtin_atom("ArcSin");
+    inline constexpr Atom ArcCos = builtin_atom("ArcCos");
+    inline constexpr Atom ArcTan = builtin_atom("ArcTan");
+    inline constexpr Atom Sqrt = builtin_atom("Sqrt");
+    inline constexpr Atom Exp = builtin_atom("Exp");
+    inline constexpr Atom Log = builtin_atom("Log");
+    inline constexpr Atom Table = builtin_atom("Table");
+    inline constexpr Atom Map = builtin_atom("Map");
+    inline constexpr Atom Select = builtin_atom("Select");
+    inline constexpr Atom N = builtin_atom("N");
+    inline constexpr Atom FullForm = builtin_atom("FullForm");
+    inline constexpr Atom Short = builtin_atom("Short");
+    inline constexpr Atom Compile = builtin_atom("Compile");
+    inline constexpr Atom CompiledFunction = builtin_atom("CompiledFunction");
+    inline constexpr Atom Sequence = builtin_atom("Sequence");
+    inline constexpr Atom Timing = builtin_atom("Timing");
+    inline constexpr Atom AbsoluteTiming = builtin_atom("AbsoluteTiming");
+    inline constexpr Atom TimeConstrained = builtin_atom("TimeConstrained");
+    inline constexpr Atom MemoryConstrained = builtin_atom("MemoryConstrained");
+    inline constexpr Atom ReplaceAll = builtin_atom("ReplaceAll");
+    inline constexpr Atom ReplaceRepeated = builtin_atom("ReplaceRepeated");
+    inline constexpr Atom Condition = builtin_atom("Condition");
+    inline constexpr Atom D = builtin_atom("D");
+    inline constexpr Atom Grad = builtin_atom("Grad");
+}
+
+} // namespace aleph3
+
+template <>
+struct std::hash<aleph3::Atom> {
+    size_t operator()(const aleph3::Atom& a) const noexcept { return a.id(); }
+};
@@ -0,0 +1,67 @@
+/*
+ * AtomTable.hpp
+ * -------------
+ * Compile-time lookup tables keyed on built-in atoms.
+ *
+ * Every name in BUILTIN_ATOM_NAMES has a fixed ID below BUILTIN_ATOM_COUNT, so the ID is a
+ * minimal perfect hash of the built-in heads: a table is a constexpr array indexed by it,
+ * and a lookup is one bounds check and one load. Atoms interned at run time have larger
+ * IDs and are never found. Tables are built by consteval constructors, so a name missing
+ * from BUILTIN_ATOM_NAMES fails to compile, and nothing runs at startup.
+ */
+#pragma once
+
+#include "expr/Atom.hpp"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+
+namespace aleph3 {
+
+    inline constexpr size_t BUILTIN_ATOM_COUNT = std::size(BUILTIN_ATOM_NAMES);
+
+    // Map from built-in atoms to values of T
+    template <typename T>
+    class AtomTable {
+    public:
+        consteval AtomTable(std::initializer_list<std::pair<std::string_view, T>> entries) {
+            for (const auto& [name, value] : entries) {
+                const uint32_t id = builtin_atom(name).id();
+                if (present_[id]) throw "AtomTable: duplicate name";
+                present_[id] = true;
+                values_[id] = value;
+            }
+        }
+
+        // The value for `name`, or nullptr
+        constexpr const T* find(Atom name) const {
+            const uint32_t id = name.id();
+            return id < BUILTIN_ATOM_COUNT && present_[id] ? &values_[id] : nullptr;
+        }
+
+        constexpr bool contains(Atom name) const { return find(name) != nullptr; }
+
+    private:
+        std::array<T, BUILTIN_ATOM_COUNT> values_{};
+        std::array<bool, BUILTIN_ATOM_COUNT> present_{};
+    };
+
+    // Set of built-in atoms
+    class AtomSet {
+    public:
+        consteval AtomSet(std::initializer_list<std::string_view> names) {
+            for (std::string_view name : names) members_[builtin_atom(name).id()] = true;
+        }
+
+        constexpr bool contains(Atom name) const {
+            return name.id() < BUILTIN_ATOM_COUNT && members_[name.id()];
+        }
+
+    private:
+        std::array<bool, BUILTIN_ATOM_COUNT> members_{};
+    };
+
+} // namespace aleph3
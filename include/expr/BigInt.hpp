@@ -0,0 +1,136 @@
+/*
+ * BigInt.hpp
+ * ----------
+ * Exact integers for Rational: an int64_t while the value fits, promoted to a shared,
+ * immutable array of 32-bit limbs when an operation overflows.
+ *
+ * The arithmetic operators try the int64_t path inline (one overflow-checked instruction)
+ * and only call into BigInt.cpp when an operand is already big or the result overflows.
+ * Values that fit in an int64_t are always stored small, so equality and hashing never
+ * depend on how a value was computed. Multiplication switches from schoolbook to
+ * Karatsuba above KARATSUBA_THRESHOLD limbs.
+ */
+#pragma once
+
+#include "util/Checked.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace aleph3 {
+
+    class BigInt {
+    public:
+        // Limbs per operand from which multiplication uses Karatsuba
+        static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+        BigInt(int64_t value = 0) noexcept : small_(value) {}
+
+        // Decimal digits with an optional leading '-'; throws std::invalid_argument otherwise
+        static BigInt from_string(const std::string& digits);
+        // Exact value of a finite, integral double; throws std::domain_error otherwise
+        static BigInt from_double(double value);
+
+        bool is_small() const { return !big_; }
+        int64_t small_value() const { return small_; } // Only meaningful if is_small()
+        int sign() const;
+        bool is_zero() const { return !big_ && small_ == 0; }
+        bool is_even() const;
+        size_t bit_length() const;
+
+        // Little-endian 32-bit limbs of the absolute value, empty for zero, and the
+        // non-negative value that such limbs spell. For packing many values into one.
+        std::vector<uint32_t> magnitude() const;
+        static BigInt from_magnitude(std::vector<uint32_t> limbs);
+
+        // Nearest double (infinite beyond its range)
+        double to_double() const;
+        explicit operator double() const { return to_double(); }
+        // n / d as a double, accurate even when both are far outside the double range
+        static double ratio(const BigInt& n, const BigInt& d);
+
+        std::string to_string() const;
+        size_t hash() const;
+
+        friend BigInt operator+(const BigInt& a, const BigInt& b) {
+            int64_t r;
+            if (!a.big_ && !b.big_ && !detail::add_overflows(a.small_, b.small_, r)) return BigInt(r);
+            return add_slow(a, b, false);
+        }
+        friend BigInt operator-(const BigInt& a, const BigInt& b) {
+            int64_t r;
+            if (!a.big_ && !b.big_ && !detail::sub_overflows(a.small_, b.small_, r)) return BigInt(r);
+            return add_slow(a, b, true);
+        }
+        friend BigInt operator*(const BigInt& a, const BigInt& b) {
+            int64_t r;
+            if (!a.big_ && !b.big_ && !detail::mul_overflows(a.small_, b.small_, r)) return BigInt(r);
+            return mul_slow(a, b);
+        }
+        // Truncates toward zero; throws std::domain_error on division by zero
+        friend BigInt operator/(const BigInt& a, const BigInt& b) {
+            if (!a.big_ && !b.big_ && b.small_ != 0 && !(b.small_ == -1 && a.small_ == INT64_MIN)) {
+                return BigInt(a.small_ / b.small_);
+            }
+            return divmod_slow(a, b, false);
+        }
+        // Remainder with the sign of a
+        friend BigInt operator%(const BigInt& a, const BigInt& b) {
+            if (!a.big_ && !b.big_ && b.small_ != 0 && b.small_ != -1) return BigInt(a.small_ % b.small_);
+            if (!a.big_ && !b.big_ && b.small_ == -1) return BigInt(0);
+            return divmod_slow(a, b, true);
+        }
+        BigInt operator-() const {
+            if (!big_ && small_ != INT64_MIN) return BigInt(-small_);
+            return BigInt(0) - *this;
+        }
+
+        BigInt& operator+=(const BigInt& b) { return *this = *this + b; }
+        BigInt& operator-=(const BigInt& b) { return *this = *this - b; }
+        BigInt& operator*=(const BigInt& b) { return *this = *this * b; }
+        BigInt& operator/=(const BigInt& b) { return *this = *this / b; }
+
+        friend bool operator==(const BigInt& a, const BigInt& b) {
+            if (!a.big_ && !b.big_) return a.small_ == b.small_;
+            return compare_slow(a, b) == 0;
+        }
+        friend std::strong_ordering operator<=>(const BigInt& a, const BigInt& b) {
+            if (!a.big_ && !b.big_) return a.small_ <=> b.small_;
+            return compare_slow(a, b) <=> 0;
+        }
+
+        friend BigInt abs(const BigInt& a) { return a.sign() < 0 ? -a : a; }
+        // Non-negative greatest common divisor; gcd(0, 0) = 0
+        friend BigInt gcd(const BigInt& a, const BigInt& b) {
+            if (!a.big_ && !b.big_ && a.small_ != INT64_MIN && b.small_ != INT64_MIN) {
+                return BigInt(std::gcd(a.small_, b.small_));
+            }
+            return gcd_slow(a, b);
+        }
+        friend BigInt pow(const BigInt& base, uint64_t exponent);
+
+        friend std::ostream& operator<<(std::ostream& out, const BigInt& a);
+
+    private:
+        struct Limbs;                     // Magnitude and sign of a value outside the int64_t range
+        int64_t small_ = 0;
+        std::shared_ptr<const Limbs> big_;
+
+        static BigInt add_slow(const BigInt& a, const BigInt& b, bool subtract);
+        static BigInt mul_slow(const BigInt& a, const BigInt& b);
+        static BigInt divmod_slow(const BigInt& a, const BigInt& b, bool remainder);
+        static BigInt gcd_slow(const BigInt& a, const BigInt& b);
+        static int compare_slow(const BigInt& a, const BigInt& b);
+        static Limbs limbs_of(const BigInt& a);
+        static BigInt from_limbs(Limbs value);
+    };
+
+    inline std::string to_string(const BigInt& a) { return a.to_string(); }
+
+} // namespace aleph3
@@ -21,6 +21,10 @@
 #include <vector>
 #include <iostream>
 #include <cstdint>
+#include <atomic>
+#include "expr/Atom.hpp"
+#include "expr/BigInt.hpp"
+#include "expr/ExprPool.hpp"
 
 namespace aleph3 {
 
@@ -38,25 +42,102 @@ struct Rule;
 struct List;
 struct Infinity;
 struct Indeterminate;
+struct PackedArray;
+struct LazyList;
+struct PackedData;
+struct DownValues;
+struct CompiledFunction;
 
 // Core Expression type: variant of all expression types
-using Expr = std::variant < Symbol, Number, Complex, Rational, Boolean, String, FunctionCall, FunctionDefinition, Assignment, Rule, List, Infinity, Indeterminate > ;
+using Expr = std::variant < Symbol, Number, Complex, Rational, Boolean, String, FunctionCall, FunctionDefinition, Assignment, Rule, List, Infinity, Indeterminate, PackedArray, LazyList > ;
 
 // Smart pointer to expressions
 using ExprPtr = std::shared_ptr<Expr>;
 
-// Factory function to make an ExprPtr
+namespace detail {
+    // Set by set_hash_consing() in ExprHash.hpp
+    inline std::atomic<bool> hash_consing_enabled{false};
+    ExprPtr hash_cons_node(ExprPtr node);
+}
+
+// Factory function to make an ExprPtr; node and control block come from the node pool.
+// With hash-consing enabled, structurally identical nodes are shared.
 template <typename T, typename... Args>
 ExprPtr make_expr(Args&&... args) {
-    return std::make_shared<Expr>(T{std::forward<Args>(args)...});
+    auto node = std::allocate_shared<Expr>(PoolAllocator<Expr>(), T{std::forward<Args>(args)...});
+    if (detail::hash_consing_enabled.load(std::memory_order_relaxed)) {
+        return detail::hash_cons_node(std::move(node));
+    }
+    return node;
 }
 
+// Lazily computed structural hash of a compound node (0 = not computed yet).
+// Copies start empty, since a copied node is usually edited before it is hashed again.
+struct HashCache {
+    mutable std::atomic<size_t> value{0};
+
+    HashCache() = default;
+    HashCache(const HashCache&) noexcept {}
+    HashCache& operator=(const HashCache&) noexcept {
+        value.store(0, std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+// Handler resolved for a FunctionCall's head, tagged with the registry generation it was
+// resolved under (generation 0 = empty). Copies start empty, like HashCache.
+struct DispatchCache {
+    mutable std::atomic<uint64_t> packed{0};
+
+    DispatchCache() = default;
+    DispatchCache(const DispatchCache&) noexcept {}
+    DispatchCache& operator=(const DispatchCache&) noexcept {
+        packed.store(0, std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool load(uint32_t& generation, uint32_t& handle) const {
+        uint64_t v = packed.load(std::memory_order_relaxed);
+        generation = static_cast<uint32_t>(v >> 32);
+        handle = static_cast<uint32_t>(v);
+        return generation != 0;
+    }
+
+    void store(uint32_t generation, uint32_t handle) const {
+        packed.store((static_cast<uint64_t>(generation) << 32) | handle, std::memory_order_relaxed);
+    }
+};
+
+// Scope state token and definitions epoch under which a node is known to be fully evaluated
+// (epoch 0 = never), so that evaluating it again in the same state returns it unchanged.
+// Copies start unstamped.
+struct EvalStamp {
+    mutable std::atomic<uint64_t> token{0};
+    mutable std::atomic<uint64_t> epoch{0};
+
+    EvalStamp() = default;
+    EvalStamp(const EvalStamp&) noexcept {}
+    EvalStamp& operator=(const EvalStamp&) noexcept {
+        epoch.store(0, std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool matches(uint64_t t, uint64_t e) const {
+        return epoch.load(std::memory_order_relaxed) == e && token.load(std::memory_order_relaxed) == t;
+    }
+
+    void set(uint64_t t, uint64_t e) const {
+        token.store(t, std::memory_order_relaxed);
+        epoch.store(e, std::memory_order_relaxed);
+    }
+};
+
 // Expression types
 
 struct Symbol {
-    std::string name;
+    Atom name;
 
-    Symbol(const std::string& n) : name(n) {}
+    Symbol(Atom n) : name(n) {}
 };
 
 struct String {
@@ -77,10 +158,13 @@ struct Complex {
     double imag;
 };
 
+// Exact quotient; numerator and denominator stay machine integers until they overflow
 struct Rational {
-    int64_t numerator;
-    int64_t denominator;
-    Rational(int64_t n, int64_t d) : numerator(n), denominator(d) {}
+    BigInt numerator;
+    BigInt denominator;
+    Rational(BigInt n, BigInt d) : numerator(std::move(n)), denominator(std::move(d)) {}
+
+    double value() const { return BigInt::ratio(numerator, denominator); }
 };
 
 struct Boolean {
@@ -89,45 +173,91 @@ struct Boolean {
     Boolean(bool v) : value(v) {}
 };
 
+namespace detail {
+    // Releases `children` without recursing, so dropping a deep tree cannot overflow the
+    // stack: nodes whose last reference goes away are queued and destroyed in a loop.
+    void release_children(std::vector<ExprPtr>& children) noexcept;
+}
+
+// Set once a node is known to be in normal form (see normalize_expr), so canonicalization
+// runs once per node. Copies start clear.
+struct NormalFlag {
+    mutable std::atomic<bool> value{false};
+
+    NormalFlag() = default;
+    NormalFlag(const NormalFlag&) noexcept {}
+    NormalFlag& operator=(const NormalFlag&) noexcept {
+        value.store(false, std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool is_set() const { return value.load(std::memory_order_relaxed); }
+    void set() const { value.store(true, std::memory_order_relaxed); }
+};
+
 struct List {
     std::vector<ExprPtr> elements;
+    HashCache hash_cache;
+    EvalStamp evaluated;
+    NormalFlag normal;
+
+    List() = default;
+    List(std::vector<ExprPtr> elems) : elements(std::move(elems)) {}
+    List(const List&) = default;
+    List(List&&) = default;
+    List& operator=(const List&) = default;
+    List& operator=(List&&) = default;
+    ~List() { detail::release_children(elements); }
 };
 
 struct FunctionCall {
-    std::string head;            // Like "Plus", "Times", "Sin"
+    Atom head;                   // Like "Plus", "Times", "Sin"
     std::vector<ExprPtr> args;    // Arguments
+    HashCache hash_cache;
+    DispatchCache dispatch_cache; // See FunctionRegistry::resolve
+    EvalStamp evaluated;
+    NormalFlag normal;
 
-    FunctionCall(std::string h, const std::vector<ExprPtr>& a)
+    FunctionCall(Atom h, const std::vector<ExprPtr>& a)
         : head(h), args(a) {}
+    FunctionCall(Atom h, std::vector<ExprPtr>&& a)
+        : head(h), args(std::move(a)) {}
+    FunctionCall(const FunctionCall&) = default;
+    FunctionCall(FunctionCall&&) = default;
+    FunctionCall& operator=(const FunctionCall&) = default;
+    FunctionCall& operator=(FunctionCall&&) = default;
+    ~FunctionCall() { detail::release_children(args); }
 };
 
 struct Parameter {
-    std::string name;
+    Atom name;
     ExprPtr default_value; // nullptr if no default
 
-    Parameter(const std::string& n, ExprPtr def = nullptr)
+    Parameter(Atom n, ExprPtr def = nullptr)
         : name(n), default_value(def) {
     }
 };
 
 struct FunctionDefinition {
-    std::string name;                       // Function name
+    Atom name;                              // Function name
     std::vector<Parameter> params;          // Parameters (with optional defaults)
-    ExprPtr body;                           // Function body
+    ExprPtr body;                           // Function body; nullptr if only specific values are defined
     bool delayed;                           // True for `:=`, false for `=`
+    mutable std::shared_ptr<DownValues> downvalues; // Specific values such as f[0] = 1 (see DownValues.hpp)
+    std::shared_ptr<const CompiledFunction> compiled; // Bytecode for a numeric body (see Compiler.hpp)
 
-    FunctionDefinition() : name(""), params(), body(nullptr), delayed(true) {}
+    FunctionDefinition() : name(), params(), body(nullptr), delayed(true) {}
 
-    FunctionDefinition(const std::string& name, const std::vector<Parameter>& params, const ExprPtr& body, bool delayed)
+    FunctionDefinition(Atom name, const std::vector<Parameter>& params, const ExprPtr& body, bool delayed)
         : name(name), params(params), body(body), delayed(delayed) {
     }
 };
 
 struct Assignment {
-    std::string name; // Variable name
+    Atom name;        // Variable name
     ExprPtr value;    // Assigned value
 
-    Assignment(const std::string& name, const ExprPtr& value)
+    Assignment(Atom name, const ExprPtr& value)
         : name(name), value(value) {
     }
 };
@@ -142,6 +272,25 @@ struct Infinity {};
 
 struct Indeterminate {};
 
+// Numeric array stored contiguously, in place of a List of numbers (see expr/PackedArray.hpp).
+// The buffer is immutable and shared, so copying the node is cheap.
+struct PackedArray {
+    std::shared_ptr<const PackedData> data;
+    HashCache hash_cache;
+
+    explicit PackedArray(std::shared_ptr<const PackedData> d) : data(std::move(d)) {}
+};
+
+// Arithmetic progression start, start + step, ... of `count` numbers, held as its parameters
+// instead of its elements (see expr/LazyList.hpp). Entries are machine integers when
+// `integer` is set, reals otherwise.
+struct LazyList {
+    double start;
+    double step;
+    size_t count;
+    bool integer;
+};
+
 // Utility functions
 
 inline std::string to_string(int64_t v) {
@@ -150,6 +299,9 @@ inline std::string to_string(int64_t v) {
 inline std::string to_string_raw(int64_t v) {
     return std::to_string(v);
 }
+inline std::string to_string_raw(const BigInt& v) {
+    return v.to_string();
+}
 
 std::string to_string(const Expr& expr);
 
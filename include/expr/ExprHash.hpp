@@ -0,0 +1,47 @@
+/*
+ * ExprHash.hpp
+ * ------------
+ * Structural hashing, equality and optional hash-consing for Expr trees.
+ *
+ * expr_hash() combines the hashes of a node's children; compound nodes (FunctionCall, List)
+ * cache their hash on first use, so hashing an already-seen subtree is O(1). expr_equal()
+ * short-circuits on pointer identity and on mismatched cached hashes before walking children.
+ *
+ * Hash-consing is off by default. When enabled, make_expr returns the existing node for any
+ * structurally identical expression still alive, so repeated subtrees share one node and
+ * compare equal by pointer. Nodes are treated as immutable once built.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include <cstddef>
+
+namespace aleph3 {
+
+    size_t expr_hash(const Expr& expr);
+    size_t expr_hash(const ExprPtr& expr);
+
+    // Structural equality; numbers compare by value
+    bool expr_equal(const Expr& a, const Expr& b);
+    bool expr_equal(const ExprPtr& a, const ExprPtr& b);
+
+    // Hash and equality functors for unordered containers keyed on expression structure
+    struct ExprPtrHash {
+        size_t operator()(const ExprPtr& e) const { return expr_hash(e); }
+    };
+
+    struct ExprPtrEqual {
+        bool operator()(const ExprPtr& a, const ExprPtr& b) const { return expr_equal(a, b); }
+    };
+
+    // Enable or disable sharing of structurally identical nodes created by make_expr
+    void set_hash_consing(bool enabled);
+    bool hash_consing_enabled();
+
+    // Canonical shared node for `expr` (inserting it if none is alive), regardless of the mode
+    ExprPtr hash_cons(const ExprPtr& expr);
+
+    // Number of live nodes tracked by the hash-consing table
+    size_t hash_cons_table_size();
+
+} // namespace aleph3
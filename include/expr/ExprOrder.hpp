@@ -0,0 +1,24 @@
+/*
+ * ExprOrder.hpp
+ * -------------
+ * Canonical ordering of expressions, used to sort the arguments of Orderless heads
+ * (Plus, Times) so that equal sums and products have one representation.
+ *
+ * Numbers come first, by value. Other terms are ordered by their non-numeric factors,
+ * comparing bases before exponents, so x < 2 x < x^2 < y and like terms end up adjacent.
+ * The numeric coefficient only breaks ties.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+namespace aleph3 {
+
+    // Negative, zero or positive as a sorts before, together with, or after b
+    int canonical_compare(const ExprPtr& a, const ExprPtr& b);
+
+    struct CanonicalLess {
+        bool operator()(const ExprPtr& a, const ExprPtr& b) const { return canonical_compare(a, b) < 0; }
+    };
+
+} // namespace aleph3
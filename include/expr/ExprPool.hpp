@@ -0,0 +1,81 @@
+/*
+ * ExprPool.hpp
+ * ------------
+ * Pooled storage for Expr nodes.
+ *
+ * Every ExprPtr created through make_expr is allocated with std::allocate_shared and a
+ * PoolAllocator, so the node and its shared_ptr control block live in one fixed-size block
+ * taken from a size-class pool instead of a separate malloc.
+ *
+ * Each thread keeps a private free list per size class and refills it in batches from a
+ * global reserve of chunks, so the common allocate/free pair touches no lock. Blocks freed
+ * on another thread simply join that thread's free list. Chunks are never returned to the
+ * system; the pool grows to the high-water mark of live nodes and then recycles.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace aleph3 {
+
+    namespace detail {
+        // Largest request served by the pool; bigger ones fall through to operator new
+        constexpr size_t POOL_MAX_BLOCK = 256;
+        constexpr size_t POOL_ALIGNMENT = 16;
+
+        void* pool_allocate(size_t size);
+        void pool_deallocate(void* p, size_t size) noexcept;
+
+        // Bytes of pool blocks the calling thread has allocated so far, counting each block
+        // as the size asked for
+        uint64_t thread_allocated_bytes();
+    }
+
+    // Blocks count as in use from when a thread takes them from the global reserve until
+    // it hands them back, so live nodes plus the spares in thread caches. Each thread adds
+    // its allocations to the total in batches, so those of other threads lag by at most a
+    // batch each.
+    struct ExprPoolStats {
+        size_t chunks = 0;              // Chunks reserved from the system
+        size_t bytes_reserved = 0;      // Total bytes held by the pool
+        size_t bytes_in_use = 0;
+        size_t peak_bytes_in_use = 0;
+        uint64_t allocations = 0;       // Blocks handed out since the start
+    };
+
+    ExprPoolStats expr_pool_stats();
+
+    // Stateless allocator backed by the node pool; all instances compare equal
+    template <typename T>
+    struct PoolAllocator {
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        T* allocate(size_t n) {
+            if constexpr (sizeof(T) <= detail::POOL_MAX_BLOCK && alignof(T) <= detail::POOL_ALIGNMENT) {
+                if (n == 1) return static_cast<T*>(detail::pool_allocate(sizeof(T)));
+            }
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            if constexpr (sizeof(T) <= detail::POOL_MAX_BLOCK && alignof(T) <= detail::POOL_ALIGNMENT) {
+                if (n == 1) {
+                    detail::pool_deallocate(p, sizeof(T));
+                    return;
+                }
+            }
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    };
+
+} // namespace aleph3
@@ -1,21 +1,58 @@
 #pragma once
 
 #include "expr/Expr.hpp"
+#include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 namespace aleph3 {
 
-    inline std::pair<int64_t, int64_t> normalize_rational(int64_t num, int64_t den) {
-        if (den == 0) throw std::runtime_error("Denominator cannot be zero");
-        int64_t g = std::gcd(num, den);
-        num /= g;
-        den /= g;
+    inline std::pair<BigInt, BigInt> normalize_rational(const BigInt& num, const BigInt& den) {
+        if (den.is_zero()) throw std::runtime_error("Denominator cannot be zero");
+        if (num.is_small() && den.is_small() && num.small_value() != INT64_MIN && den.small_value() != INT64_MIN) {
+            int64_t n = num.small_value(), d = den.small_value();
+            const int64_t g = std::gcd(n, d);
+            n /= g;
+            d /= g;
+            if (d < 0) {
+                n = -n;
+                d = -d;
+            }
+            return {n, d};
+        }
+        BigInt g = gcd(num, den);
+        BigInt n = num / g;
+        BigInt d = den / g;
         // Move sign to numerator, denominator always positive
-        if (den < 0) {
+        if (d.sign() < 0) {
+            n = -n;
+            d = -d;
+        }
+        return {std::move(n), std::move(d)};
+    }
+
+    // Exact powers are computed while the result stays below about this many bits
+    inline constexpr size_t MAX_EXACT_POWER_BITS = size_t{1} << 22;
+
+    // base^exponent as an exact Rational (Infinity for 0^-n), or nullptr if it would be too large
+    inline ExprPtr rational_power(const Rational& base, const BigInt& exponent) {
+        if (!exponent.is_small()) return nullptr;
+        const int64_t e = exponent.small_value();
+        const uint64_t n = e < 0 ? 0 - static_cast<uint64_t>(e) : static_cast<uint64_t>(e);
+        const size_t bits = std::max(base.numerator.bit_length(), base.denominator.bit_length());
+        if (bits > 1 && n > MAX_EXACT_POWER_BITS / bits) return nullptr;
+        BigInt num = pow(base.numerator, n);
+        BigInt den = pow(base.denominator, n);
+        if (e < 0) {
+            if (num.is_zero()) return make_expr<Infinity>();
+            std::swap(num, den);
+        }
+        // Powers of coprime numbers are coprime; only the sign may need moving
+        if (den.sign() < 0) {
             num = -num;
             den = -den;
         }
-        return {num, den};
+        return make_expr<Rational>(std::move(num), std::move(den));
     }
 
     inline double get_number_value(const ExprPtr& expr) {
@@ -42,7 +79,7 @@ namespace aleph3 {
         return std::holds_alternative<Number>(*e) && get_number_value(e) == 1.0;
     }
 
-    inline bool is_function(const ExprPtr& e, const std::string& name) {
+    inline bool is_function(const ExprPtr& e, Atom name) {
         auto f = std::get_if<FunctionCall>(e.get());
         return f && f->head == name;
     }
@@ -52,15 +89,15 @@ namespace aleph3 {
     }
 
     inline ExprPtr make_plus(const ExprPtr& a, const ExprPtr& b) {
-        return make_expr<FunctionCall>("Plus", std::vector<ExprPtr>{a, b});
+        return make_expr<FunctionCall>(atoms::Plus, std::vector<ExprPtr>{a, b});
     }
 
     inline ExprPtr make_plus(std::initializer_list<ExprPtr> args) {
-        return make_expr<FunctionCall>("Plus", std::vector<ExprPtr>(args));
+        return make_expr<FunctionCall>(atoms::Plus, std::vector<ExprPtr>(args));
     }
 
     inline ExprPtr make_plus(const std::vector<ExprPtr>& args) {
-        return make_expr<FunctionCall>("Plus", args);
+        return make_expr<FunctionCall>(atoms::Plus, args);
     }
 
     inline ExprPtr make_times(const std::vector<ExprPtr>& args) {
@@ -73,7 +110,7 @@ namespace aleph3 {
             if (auto num = std::get_if<Number>(arg.get())) {
                 coefficient *= num->value;
             }
-            else if (is_function(arg, "Times")) {
+            else if (is_function(arg, atoms::Times)) {
                 const auto& inner = std::get<FunctionCall>(*arg);
                 for (const auto& inner_arg : inner.args) {
                     flattened.push_back(inner_arg);
@@ -96,7 +133,7 @@ namespace aleph3 {
             return flattened[0]; // no need for Times head
         }
 
-        return make_expr<FunctionCall>("Times", flattened);
+        return make_expr<FunctionCall>(atoms::Times, flattened);
     }
 
     inline ExprPtr make_times(const ExprPtr& a, const ExprPtr& b) {
@@ -108,7 +145,7 @@ namespace aleph3 {
     }
 
     inline ExprPtr make_pow(const ExprPtr& base, int exponent) {
-        return make_expr<FunctionCall>("Power", std::vector<ExprPtr>{
+        return make_expr<FunctionCall>(atoms::Power, std::vector<ExprPtr>{
             base, make_expr<Number>((double)exponent)
         });
     }
@@ -124,19 +161,19 @@ namespace aleph3 {
         throw std::runtime_error("Expected integer number");
     }
 
-    inline ExprPtr make_fcall(std::string name, const std::vector<ExprPtr>& args) {
+    inline ExprPtr make_fcall(Atom name, const std::vector<ExprPtr>& args) {
         return make_expr<FunctionCall>(name, args);
     }
 
-    inline ExprPtr make_fcall(std::string name, std::initializer_list<ExprPtr> args) {
+    inline ExprPtr make_fcall(Atom name, std::initializer_list<ExprPtr> args) {
         return make_expr<FunctionCall>(name, std::vector<ExprPtr>(args));
     }
 
-    inline ExprPtr make_fdef(std::string name, std::initializer_list<Parameter> params, const ExprPtr& body, bool delayed) {
+    inline ExprPtr make_fdef(Atom name, std::initializer_list<Parameter> params, const ExprPtr& body, bool delayed) {
         return make_expr<FunctionDefinition>(name, std::vector<Parameter>(params), body, delayed);
     }
 
-    inline ExprPtr make_fdef(std::string name, std::initializer_list<std::string> args, const ExprPtr& body, bool delayed) {
+    inline ExprPtr make_fdef(Atom name, std::initializer_list<std::string> args, const ExprPtr& body, bool delayed) {
         std::vector<Parameter> params;
         for (const auto& arg : args) {
             params.emplace_back(arg);
@@ -145,6 +182,6 @@ namespace aleph3 {
     }
 
     inline ExprPtr make_expr(const Indeterminate&) {
-        return std::make_shared<Expr>(Indeterminate{});
+        return make_expr<Indeterminate>();
     }
 }
@@ -0,0 +1,39 @@
+/*
+ * LazyList.hpp
+ * ------------
+ * Lazy lists: long arithmetic progressions held as start, step and length instead of one
+ * entry per element. Range gives one when it would have at least LAZY_RANGE_LENGTH
+ * elements, and a packed array otherwise.
+ *
+ * Length, Total, Max and Min read a lazy list in O(1), Part computes the single element it
+ * asks for, and adding, subtracting or multiplying by a real number gives another lazy
+ * list. Anything that needs the elements themselves (printing, hashing against other lists,
+ * listable functions) materializes the progression into a packed array or unpacks it.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/VectorKernels.hpp"
+
+namespace aleph3 {
+
+    // Ranges of at least this many elements are held lazily
+    inline constexpr size_t LAZY_RANGE_LENGTH = size_t(1) << 20;
+
+    // `count` values start, start + step, ...: a lazy list if count >= LAZY_RANGE_LENGTH,
+    // otherwise a packed array (of integers when start and step are integers), or {} if empty
+    ExprPtr make_range(double start, double step, size_t count);
+
+    // Element `index` (0-based)
+    double lazy_value(const LazyList& list, size_t index);
+    ExprPtr lazy_part(const LazyList& list, size_t index);
+
+    // Packed array of the elements of a lazy list; other nodes are returned as is
+    ExprPtr materialize(const ExprPtr& expr);
+    ExprPtr materialize(const LazyList& list);
+
+    // list op x or x op list for op in Plus, Minus and Times and a real x (or Divide by a
+    // real x other than 0) as another progression; nullptr if not applicable
+    ExprPtr lazy_affine(kernels::Binary op, const ExprPtr& a, const ExprPtr& b);
+
+} // namespace aleph3
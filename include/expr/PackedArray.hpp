@@ -0,0 +1,76 @@
+/*
+ * PackedArray.hpp
+ * ---------------
+ * Packed numeric arrays: rank-N data of machine integers, reals or complex numbers held in
+ * one contiguous row-major buffer, instead of one heap node per element as in List.
+ *
+ * Lists of at least AUTO_PACK_LENGTH numbers (and Range, Table) are packed automatically;
+ * unpack() turns an array back into nested Lists for code that needs elements as nodes.
+ * Arithmetic between packed arrays, or with a numeric scalar, runs on the buffers. Complex
+ * arrays store interleaved (re, im) pairs and use the complex kernels.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+#include "expr/VectorKernels.hpp"
+
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <variant>
+#include <vector>
+
+namespace aleph3 {
+
+    // Lists with at least this many numeric entries in total are packed when evaluated
+    inline constexpr size_t AUTO_PACK_LENGTH = 250;
+
+    struct PackedData {
+        enum class Type : uint8_t { Integer, Real, Complex };
+
+        std::vector<size_t> shape; // Row-major dimensions; never empty
+        std::variant<std::vector<int64_t>, std::vector<double>, std::vector<std::complex<double>>> values;
+
+        Type type() const { return static_cast<Type>(values.index()); }
+        size_t rank() const { return shape.size(); }
+        size_t length() const { return shape[0]; }
+        size_t size() const;
+    };
+
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<int64_t> values);
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<double> values);
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<std::complex<double>> values);
+
+    // Packed form of a list with these elements if every entry is a Number or Complex and
+    // nested lists are rectangular; nullptr otherwise
+    ExprPtr try_pack(const std::vector<ExprPtr>& elements);
+
+    // A List of `elements`, packed instead when it holds at least AUTO_PACK_LENGTH numbers
+    ExprPtr make_list_auto_packed(std::vector<ExprPtr> elements);
+
+    // Nested Lists of Numbers/Complex equal to a packed array or a lazy list; other nodes are
+    // returned as is
+    ExprPtr unpack(const ExprPtr& expr);
+    ExprPtr unpack(const PackedArray& array);
+
+    // Element `index` (0-based) along the first dimension: a number, or a packed row
+    ExprPtr packed_part(const PackedData& array, size_t index);
+
+    // Value of entry `flat_index` in row-major order
+    std::complex<double> packed_value(const PackedData& array, size_t flat_index);
+
+    // Plus, Times, Minus, Divide or Power of two equal-shape packed arrays or of a packed
+    // array and a numeric scalar, computed on the buffers; nullptr if not applicable
+    ExprPtr packed_elementwise(Atom op, const ExprPtr& a, const ExprPtr& b);
+
+    // f applied to every entry of a packed array, on its buffer. Entries outside the real domain
+    // of f (for real and integer arrays) or with a non-finite result become fallback(entry),
+    // which unpacks the result. Complex arrays need an f with a complex form, or give nullptr;
+    // Abs of a complex array is real.
+    ExprPtr packed_unary(kernels::Unary f, const ExprPtr& array,
+        const std::function<ExprPtr(const ExprPtr&)>& fallback);
+
+    // A packed array with integer entries converted to reals; others are returned as is
+    ExprPtr packed_to_real(const ExprPtr& array);
+
+} // namespace aleph3
@@ -0,0 +1,89 @@
+/*
+ * Printer.hpp
+ * -----------
+ * Streaming output of expressions in input form (to_string) and FullForm (to_fullform).
+ *
+ * The printers walk an expression once and append its text to an OutputBuffer, which
+ * either grows a caller's std::string or passes fixed-size chunks on to a std::ostream, so
+ * printing a result never builds a string per subexpression. Numbers are formatted with
+ * std::to_chars. Packed arrays and lazy lists are printed straight from their buffers and
+ * parameters, without unpacking them into nodes.
+ *
+ * Short[expr, n] prints as expr cut to about n lines of SHORT_LINE_WIDTH characters: once
+ * that many characters are out, the remaining elements after the first of each open list,
+ * sum, product or argument sequence are replaced by <<k>>, k being how many were left out.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace aleph3 {
+
+    // Characters per line of Short[expr, n]
+    inline constexpr size_t SHORT_LINE_WIDTH = 78;
+
+    class OutputBuffer {
+    public:
+        // Appends to `target`
+        explicit OutputBuffer(std::string& target) : text_(&target) {}
+
+        // Collects up to CHUNK_SIZE characters at a time and writes them to `target`
+        explicit OutputBuffer(std::ostream& target) : text_(&chunk_), stream_(&target) {
+            chunk_.reserve(CHUNK_SIZE);
+        }
+
+        ~OutputBuffer() { flush(); }
+
+        OutputBuffer(const OutputBuffer&) = delete;
+        OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+        void append(std::string_view text) {
+            text_->append(text);
+            written_ += text.size();
+            if (stream_ && chunk_.size() >= CHUNK_SIZE) flush();
+        }
+
+        void push_back(char c) {
+            text_->push_back(c);
+            ++written_;
+            if (stream_ && chunk_.size() >= CHUNK_SIZE) flush();
+        }
+
+        // Writes what is held to the stream, if there is one
+        void flush() {
+            if (!stream_ || chunk_.empty()) return;
+            stream_->write(chunk_.data(), static_cast<std::streamsize>(chunk_.size()));
+            chunk_.clear();
+        }
+
+        // Characters written so far
+        size_t size() const { return written_; }
+
+    private:
+        static constexpr size_t CHUNK_SIZE = size_t(1) << 16;
+
+        std::string chunk_;
+        std::string* text_;
+        std::ostream* stream_ = nullptr;
+        size_t written_ = 0;
+    };
+
+    // Input form, as to_string(expr); at most about `limit` characters, as for Short
+    void write_expr(OutputBuffer& out, const Expr& expr, size_t limit = std::numeric_limits<size_t>::max());
+    void write_expr(std::ostream& out, const ExprPtr& expr);
+
+    // FullForm, as to_fullform(expr)
+    void write_fullform(OutputBuffer& out, const ExprPtr& expr);
+    void write_fullform(std::ostream& out, const ExprPtr& expr);
+
+    // Integers without decimals, other reals with up to 6 decimals and no trailing zeros
+    void write_number(OutputBuffer& out, double value);
+    std::string format_number(double value);
+
+} // namespace aleph3
@@ -0,0 +1,74 @@
+/*
+ * Serialize.hpp
+ * -------------
+ * Versioned binary format for Expr trees, read back without going through the Parser.
+ *
+ * Layout (all integers are LEB128 varints unless noted):
+ *   "A3EX", format version
+ *   atom table: count, then each name as length and bytes
+ *   root node
+ * A node starts with a header (tag << 1 | shared), tag one of SerialTag. Symbols and heads
+ * refer to the atom table by index. Numbers, complex parts and lazy-list bounds are raw
+ * little-endian doubles, and packed arrays store their buffer as raw little-endian entries.
+ * Integers inside Rational are zigzag varints, or sign and 32-bit limbs when big. A Number
+ * with an integral value below 2^53, as most numbers in polynomial data are, is written as
+ * a zigzag varint instead (tag IntegralNumber). Children follow their parent, in order.
+ *
+ * A node referenced from more than one place (use_count() > 1) is written once with the
+ * shared bit set and numbered in order of appearance; later occurrences become a BackRef
+ * with that number, so a DAG stays a DAG and its size on disk is the number of distinct
+ * nodes. Reading rebuilds the same sharing.
+ *
+ * Evaluation caches (stamps, normal flags, downvalues, compiled bytecode) are not written.
+ * Writing and reading use explicit stacks, so tree depth is bounded only by memory.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace aleph3 {
+
+    inline constexpr uint32_t SERIAL_FORMAT_VERSION = 1;
+
+    enum class SerialTag : uint8_t {
+        BackRef,
+        Symbol,
+        Number,
+        Complex,
+        Rational,
+        Boolean,
+        String,
+        FunctionCall,
+        FunctionDefinition,
+        Assignment,
+        Rule,
+        List,
+        Infinity,
+        Indeterminate,
+        PackedArray,
+        LazyList,
+        IntegralNumber,  // A Number with an integral value, as a zigzag varint
+    };
+
+    // Malformed, truncated or unsupported input
+    struct SerializationError : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // The bytes of `expr`
+    std::string serialize(const ExprPtr& expr);
+
+    // Throws SerializationError unless `bytes` is exactly one serialized expression
+    ExprPtr deserialize(std::string_view bytes);
+
+    // serialize() to and deserialize() from a file; throw SerializationError if the file
+    // cannot be written or read
+    void write_serialized(const std::string& path, const ExprPtr& expr);
+    ExprPtr read_serialized(const std::string& path);
+
+} // namespace aleph3
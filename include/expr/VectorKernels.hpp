@@ -0,0 +1,97 @@
+/*
+ * VectorKernels.hpp
+ * -----------------
+ * Loops over contiguous double buffers for the listable numeric built-ins, used by packed
+ * arrays instead of one evaluator call per element.
+ *
+ * The loops are branch-free so the compiler vectorizes them; on x86-64 each kernel is built
+ * for AVX-512, AVX2 and baseline SSE2 and the best one is picked at load time. On AArch64
+ * the baseline build uses NEON. Sin, Cos, Tan, Exp and Log have their own vectorizable
+ * implementations; lanes outside their reduced range are recomputed with <cmath>.
+ *
+ * Complex buffers are std::complex<double> arrays, i.e. interleaved (re, im) pairs. Their
+ * arithmetic is written out on the two parts so that it vectorizes as well; Plus and Minus
+ * simply run the real loops over twice as many doubles.
+ */
+#pragma once
+
+#include "expr/AtomTable.hpp"
+
+#include <cstddef>
+#include <complex>
+#include <cstdint>
+#include <optional>
+
+namespace aleph3::kernels {
+
+    enum class Unary : uint8_t {
+        Sin, Cos, Tan, Csc, Sec, Cot, Sinh, Cosh, Tanh, Coth, Sech, Csch,
+        Abs, Sqrt, Exp, Log, Floor, Ceiling, Round, ArcSin, ArcCos, ArcTan, Gamma
+    };
+
+    enum class Binary : uint8_t { Plus, Minus, Times, Divide, Power };
+
+    inline constexpr AtomTable<Unary> UNARY_KERNELS = {
+        { "Sin", Unary::Sin }, { "Cos", Unary::Cos }, { "Tan", Unary::Tan }, { "Csc", Unary::Csc },
+        { "Sec", Unary::Sec }, { "Cot", Unary::Cot }, { "Sinh", Unary::Sinh }, { "Cosh", Unary::Cosh },
+        { "Tanh", Unary::Tanh }, { "Coth", Unary::Coth }, { "Sech", Unary::Sech }, { "Csch", Unary::Csch },
+        { "Abs", Unary::Abs }, { "Sqrt", Unary::Sqrt }, { "Exp", Unary::Exp }, { "Log", Unary::Log },
+        { "Floor", Unary::Floor }, { "Ceiling", Unary::Ceiling }, { "Round", Unary::Round },
+        { "ArcSin", Unary::ArcSin }, { "ArcCos", Unary::ArcCos }, { "ArcTan", Unary::ArcTan },
+        { "Gamma", Unary::Gamma },
+    };
+
+    inline constexpr AtomTable<Binary> BINARY_KERNELS = {
+        { "Plus", Binary::Plus }, { "Minus", Binary::Minus }, { "Times", Binary::Times },
+        { "Divide", Binary::Divide }, { "Power", Binary::Power },
+    };
+
+    // The kernel of a built-in head, if it has one
+    constexpr std::optional<Unary> unary_kernel(Atom name) {
+        const Unary* f = UNARY_KERNELS.find(name);
+        return f ? std::optional<Unary>(*f) : std::nullopt;
+    }
+    constexpr std::optional<Binary> binary_kernel(Atom name) {
+        const Binary* op = BINARY_KERNELS.find(name);
+        return op ? std::optional<Binary>(*op) : std::nullopt;
+    }
+
+    // Instruction set the kernels run with on this machine: "avx512", "avx2", "neon" or "scalar"
+    const char* active_isa();
+
+    // out[i] = f(x[i]); out may alias x
+    void apply_unary(Unary f, const double* x, double* out, size_t n);
+
+    // f(x) and its real domain for one value, with the same <cmath> functions as the evaluator
+    double apply_unary(Unary f, double x);
+    bool in_real_domain(Unary f, double x);
+
+    // mask[i] = 1 where x[i] lies in the real domain of f, 0 elsewhere; returns the number of 1s
+    size_t domain_mask(Unary f, const double* x, uint8_t* mask, size_t n);
+
+    // Clears mask[i] where x[i] is infinite or NaN; returns the number of 1s left
+    size_t keep_finite(const double* x, uint8_t* mask, size_t n);
+
+    // out[i] = a[i] op b[i], a[i] op b or a op b[i]; out may alias an input
+    void apply_binary(Binary op, const double* a, const double* b, double* out, size_t n);
+    void apply_binary(Binary op, const double* a, double b, double* out, size_t n);
+    void apply_binary(Binary op, double a, const double* b, double* out, size_t n);
+
+    // Functions with a std::complex counterpart used for complex arguments
+    bool has_complex_form(Unary f);
+
+    // f(x) for complex x; false if f has no complex form
+    bool apply_unary(Unary f, const std::complex<double>& x, std::complex<double>& out);
+
+    // out[i] = f(x[i]) for a function with a complex form; out may alias x
+    void apply_unary(Unary f, const std::complex<double>* x, std::complex<double>* out, size_t n);
+
+    // Complex counterparts of apply_binary(); out may alias an input
+    void apply_binary(Binary op, const std::complex<double>* a, const std::complex<double>* b,
+        std::complex<double>* out, size_t n);
+    void apply_binary(Binary op, const std::complex<double>* a, std::complex<double> b,
+        std::complex<double>* out, size_t n);
+    void apply_binary(Binary op, std::complex<double> a, const std::complex<double>* b,
+        std::complex<double>* out, size_t n);
+
+} // namespace aleph3::kernels
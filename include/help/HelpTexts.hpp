@@ -1,90 +1,161 @@
 ﻿#pragma once
-#include <string>
-#include <unordered_map>
+#include "util/PerfectHash.hpp"
+
+#include <array>
+#include <span>
+#include <string_view>
 
 namespace aleph3 {
 
     struct HelpEntry {
-        std::string name;
-        std::string description;
-        std::string category;
+        std::string_view name;
+        std::string_view description;
+        std::string_view category;
+    };
+
+    inline constexpr HelpEntry HELP_ENTRIES[] = {
+        // Trigonometric
+        {"Sin", "Sin[x]: Sine of x (x in radians)", "Trigonometric"},
+        {"Cos", "Cos[x]: Cosine of x (x in radians)", "Trigonometric"},
+        {"Tan", "Tan[x]: Tangent of x (x in radians)", "Trigonometric"},
+        {"ArcSin", "ArcSin[x]: Inverse sine of x", "Trigonometric"},
+        {"ArcCos", "ArcCos[x]: Inverse cosine of x", "Trigonometric"},
+        {"ArcTan", "ArcTan[x]: Inverse tangent of x", "Trigonometric"},
+        {"Csc", "Csc[x]: Cosecant of x (1/sin(x))", "Trigonometric"},
+        {"Sec", "Sec[x]: Secant of x (1/cos(x))", "Trigonometric"},
+        {"Cot", "Cot[x]: Cotangent of x (1/tan(x))", "Trigonometric"},
+
+        // Arithmetic (binary)
+        {"Plus", "Plus[a, b]: a + b (addition)", "Arithmetic"},
+        {"Minus", "Minus[a, b]: a - b (subtraction)", "Arithmetic"},
+        {"Times", "Times[a, b]: a * b (multiplication)", "Arithmetic"},
+        {"Divide", "Divide[a, b]: a / b (division)", "Arithmetic"},
+        {"Power", "Power[a, b]: a^b (exponentiation)", "Arithmetic"},
+        {"Log", "Log[b, x]: Logarithm of x with base b", "Exponential/Logarithmic"},
+        {"ArcTan", "ArcTan[x, y]: Two-argument arctangent (atan2)", "Trigonometric"},
+
+        // Hyperbolic
+        {"Sinh", "Sinh[x]: Hyperbolic sine of x", "Hyperbolic"},
+        {"Cosh", "Cosh[x]: Hyperbolic cosine of x", "Hyperbolic"},
+        {"Tanh", "Tanh[x]: Hyperbolic tangent of x", "Hyperbolic"},
+        {"Coth", "Coth[x]: Hyperbolic cotangent of x", "Hyperbolic"},
+        {"Sech", "Sech[x]: Hyperbolic secant of x", "Hyperbolic"},
+        {"Csch", "Csch[x]: Hyperbolic cosecant of x", "Hyperbolic"},
+
+        // Exponential/Logarithmic
+        {"Exp", "Exp[x]: Exponential function e^x", "Exponential/Logarithmic"},
+        {"Log", "Log[x]: Natural logarithm of x", "Exponential/Logarithmic"},
+
+        // Other math
+        {"Abs", "Abs[x]: Absolute value of x", "Other"},
+        {"Floor", "Floor[x]: Greatest integer <= x", "Other"},
+        {"Ceiling", "Ceiling[x]: Smallest integer >= x", "Other"},
+        {"Sqrt", "Sqrt[x]: Square root of x", "Other"},
+        {"Round", "Round[x]: Round x to the nearest integer", "Other"},
+        {"Gamma", "Gamma[x]: Gamma function of x", "Other"},
+        {"Rational", "Rational[n, d]: Rational number n/d (exact)", "Other"},
+
+        // Polynomial manipulation
+        {"Expand", "Expand[expr]: Expand out products and powers in a polynomial expression", "Polynomial"},
+        {"Simplify", "Simplify[expr]: Apply the simplification rules until expr no longer changes", "Polynomial"},
+        {"FullSimplify", "FullSimplify[expr]: Search equal forms of expr, expanded and factored, for the simplest", "Polynomial"},
+        {"Factor", "Factor[expr]: Factor a polynomial expression over the integers", "Polynomial"},
+        {"Collect", "Collect[expr, x]: Collect terms in expr by powers of x; Collect[expr, {x, y}] nests the coefficients in y", "Polynomial"},
+        {"GCD", "GCD[a, b]: Greatest common divisor of two polynomials or integers", "Polynomial"},
+        {"PolynomialQuotient", "PolynomialQuotient[a, b, x]: Quotient of a divided by b with respect to variable x", "Polynomial"},
+        {"Coefficient", "Coefficient[expr, form]: Coefficient of the monomial form in expr; Coefficient[expr, x, n] of x^n", "Polynomial"},
+        {"CoefficientList", "CoefficientList[expr, {x, y}]: Nested lists of coefficients, indexed by the powers of x and y from 0", "Polynomial"},
+        {"Exponent", "Exponent[expr, x]: Largest power of x in expr", "Polynomial"},
+        {"GroebnerBasis", "GroebnerBasis[{p1, p2, ...}, {x, y, ...}]: Reduced Groebner basis; options MonomialOrder -> Lexicographic, DegreeLexicographic or DegreeReverseLexicographic, and Modulus -> p", "Polynomial"},
+        {"PolynomialReduce", "PolynomialReduce[p, {g1, g2, ...}, {x, y, ...}]: {{q1, q2, ...}, r} with p = q1 g1 + q2 g2 + ... + r; options as for GroebnerBasis", "Polynomial"},
+        {"Resultant", "Resultant[p, q, x]: Resultant of p and q with respect to x, which is zero exactly when they share a root in x", "Polynomial"},
+        {"Discriminant", "Discriminant[p, x]: Discriminant of p with respect to x, which is zero exactly when p has a repeated root in x", "Polynomial"},
+        {"Subresultants", "Subresultants[p, q, x]: Principal subresultant coefficients of p and q in x, starting with their resultant; the first k vanish when their GCD has degree k", "Polynomial"},
+        {"Together", "Together[expr]: Puts a rational function over a common denominator, cancelling common factors", "Polynomial"},
+        {"Cancel", "Cancel[expr]: Cancels common factors between the numerator and denominator of each term of expr", "Polynomial"},
+        {"PolynomialEvaluate", "PolynomialEvaluate[p, {x, y}, {{x1, y1}, ...}]: Numeric values of p at many points, compiled once", "Polynomial"},
+
+        // Calculus
+        {"D", "D[expr, x] or D[expr, {x, n}]: Derivative of expr with respect to x, or the nth derivative", "Calculus"},
+        {"Grad", "Grad[expr, {x, y, ...}]: List of the partial derivatives of expr with respect to each variable", "Calculus"},
+        
+        // Definitions
+        {"Set", "Set[lhs, rhs] or lhs = rhs: Assign a variable or a specific value such as f[0] = 1; f[n_] := f[n] = ... memoizes f", "Definitions"},
+        {"SetAttributes", "SetAttributes[f, attr] or SetAttributes[f, {attr, ...}]: Give the symbol f attributes such as HoldAll, Listable, Flat, Orderless or NumericFunction", "Definitions"},
+        {"ClearAttributes", "ClearAttributes[f, attr]: Remove attributes from the symbol f", "Definitions"},
+        {"Attributes", "Attributes[f]: List of the attributes of f", "Definitions"},
+        {"SaveSnapshot", "SaveSnapshot[file]: Write every variable and function definition in scope to file", "Definitions"},
+        {"LoadSnapshot", "LoadSnapshot[file]: Restore the definitions saved by SaveSnapshot; each is read on first use", "Definitions"},
+
+        // Rules and patterns
+        {"ReplaceAll", "ReplaceAll[expr, rules] or expr /. rules: Replace each outermost part of expr that a rule matches, e.g. f[2] /. f[n_Integer] -> n^2", "Rules"},
+        {"ReplaceRepeated", "ReplaceRepeated[expr, rules] or expr //. rules: Apply ReplaceAll until expr no longer changes", "Rules"},
+        {"Condition", "Condition[patt, test] or patt /; test: Pattern that matches only when test holds, e.g. x_ /; x > 0", "Rules"},
+
+        // Logical
+        {"And", "And[a, b, ...]: Logical AND (True if all arguments are True)", "Logical"},
+        {"Or", "Or[a, b, ...]: Logical OR (True if any argument is True)", "Logical"},
+
+        // String functions
+        {"StringJoin", "StringJoin[str1, str2, ...]: Concatenate strings", "String"},
+        {"StringLength", "StringLength[str]: Length of a string", "String"},
+        {"StringReplace", "StringReplace[str, rule]: Replace substrings using a rule", "String"},
+        {"StringTake", "StringTake[str, n or {start, end}]: Take substring by count or range", "String"},
+
+        // List functions
+        {"Length", "Length[list]: Number of elements in a list", "List"},
+        {"Range", "Range[n], Range[min, max] or Range[min, max, step]: Packed list of numbers from min (default 1) to max; held lazily from 2^20 elements", "List"},
+        {"Part", "Part[expr, i]: Element i of a list or argument i of a call; negative i counts from the end and 0 gives the head", "List"},
+        {"Total", "Total[list]: Sum of the elements of a list", "List"},
+        {"Max", "Max[x, y, ...]: Largest of the numbers and list elements given", "List"},
+        {"Min", "Min[x, y, ...]: Smallest of the numbers and list elements given", "List"},
+        {"Select", "Select[list, pred]: Elements e of list for which pred[e] is True", "List"},
+        {"Table", "Table[expr, {i, min, max, step}, ...]: List of expr for each value of the iterators; also {i, max}, {i, {values}} and a bare count n", "List"},
+        {"Sum", "Sum[expr, {i, min, max, step}, ...]: Sum of expr over the values of the iterators, which take the same forms as in Table", "List"},
+        {"Map", "Map[f, expr]: Applies f to each element of a list, or to each argument of a call", "List"},
+        {"ParallelTable", "ParallelTable[expr, iterators...]: Table with the points evaluated on all cores", "List"},
+        {"ParallelSum", "ParallelSum[expr, iterators...]: Sum with the terms evaluated on all cores; gives the same result as Sum", "List"},
+        {"ParallelMap", "ParallelMap[f, expr]: Map with f applied on all cores", "List"},
+
+        // Numeric
+        {"N", "N[expr]: Evaluate numerically", "Numeric"},
+        {"Compile", "Compile[{x, ...}, body]: Function of x, ... evaluated as machine-number bytecode, falling back to symbolic evaluation", "Numeric"},
+
+        // Output/Display
+        {"FullForm", "FullForm[expr]: Show the internal structure of expr", "Other"},
+        {"Short", "Short[expr, n]: Print expr cut to about n lines, with <<k>> for k omitted elements", "Other"},
+        {"CSE", "CSE[expr]: Name each repeated subexpression once, giving With[{c1 -> ..., ...}, body]", "Other"},
+        {"BinarySerialize", "BinarySerialize[expr] or BinarySerialize[expr, file]: Bytes of expr in the binary exchange format, as a list or written to file", "Other"},
+        {"BinaryDeserialize", "BinaryDeserialize[bytes] or BinaryDeserialize[file]: Expression read back from BinarySerialize output", "Other"},
+        {"Timing", "Timing[expr]: {seconds, value} with the processor time taken to evaluate expr", "Other"},
+        {"AbsoluteTiming", "AbsoluteTiming[expr]: {seconds, value} with the wall-clock time taken to evaluate expr", "Other"},
+        {"MemoryInUse", "MemoryInUse[]: Bytes of expression storage in use", "Other"},
+        {"TimeConstrained", "TimeConstrained[expr, t] or TimeConstrained[expr, t, failexpr]: expr if it evaluates within t seconds, else $Aborted or failexpr", "Other"},
+        {"MemoryConstrained", "MemoryConstrained[expr, b] or MemoryConstrained[expr, b, failexpr]: expr if evaluating it allocates at most b bytes of expressions, else $Aborted or failexpr", "Other"},
+        {"MaxMemoryUsed", "MaxMemoryUsed[]: Most bytes of expression storage in use at once so far", "Other"},
+
+        // Constants (not functions, but useful for help)
+        {"Pi", "Pi: The mathematical constant π ≈ 3.14159", "Constants"},
+        {"E", "E: The mathematical constant e ≈ 2.71828", "Constants"},
+        {"Degree", "Degree: 1 degree = Pi/180 radians", "Constants"},
     };
 
-    inline const std::vector<HelpEntry>& get_help_entries() {
-        static const std::vector<HelpEntry> entries = {
-            // Trigonometric
-            {"Sin", "Sin[x]: Sine of x (x in radians)", "Trigonometric"},
-            {"Cos", "Cos[x]: Cosine of x (x in radians)", "Trigonometric"},
-            {"Tan", "Tan[x]: Tangent of x (x in radians)", "Trigonometric"},
-            {"ArcSin", "ArcSin[x]: Inverse sine of x", "Trigonometric"},
-            {"ArcCos", "ArcCos[x]: Inverse cosine of x", "Trigonometric"},
-            {"ArcTan", "ArcTan[x]: Inverse tangent of x", "Trigonometric"},
-            {"Csc", "Csc[x]: Cosecant of x (1/sin(x))", "Trigonometric"},
-            {"Sec", "Sec[x]: Secant of x (1/cos(x))", "Trigonometric"},
-            {"Cot", "Cot[x]: Cotangent of x (1/tan(x))", "Trigonometric"},
-
-            // Arithmetic (binary)
-            {"Plus", "Plus[a, b]: a + b (addition)", "Arithmetic"},
-            {"Minus", "Minus[a, b]: a - b (subtraction)", "Arithmetic"},
-            {"Times", "Times[a, b]: a * b (multiplication)", "Arithmetic"},
-            {"Divide", "Divide[a, b]: a / b (division)", "Arithmetic"},
-            {"Power", "Power[a, b]: a^b (exponentiation)", "Arithmetic"},
-            {"Log", "Log[b, x]: Logarithm of x with base b", "Exponential/Logarithmic"},
-            {"ArcTan", "ArcTan[x, y]: Two-argument arctangent (atan2)", "Trigonometric"},
-
-            // Hyperbolic
-            {"Sinh", "Sinh[x]: Hyperbolic sine of x", "Hyperbolic"},
-            {"Cosh", "Cosh[x]: Hyperbolic cosine of x", "Hyperbolic"},
-            {"Tanh", "Tanh[x]: Hyperbolic tangent of x", "Hyperbolic"},
-            {"Coth", "Coth[x]: Hyperbolic cotangent of x", "Hyperbolic"},
-            {"Sech", "Sech[x]: Hyperbolic secant of x", "Hyperbolic"},
-            {"Csch", "Csch[x]: Hyperbolic cosecant of x", "Hyperbolic"},
-
-            // Exponential/Logarithmic
-            {"Exp", "Exp[x]: Exponential function e^x", "Exponential/Logarithmic"},
-            {"Log", "Log[x]: Natural logarithm of x", "Exponential/Logarithmic"},
-
-            // Other math
-            {"Abs", "Abs[x]: Absolute value of x", "Other"},
-            {"Floor", "Floor[x]: Greatest integer <= x", "Other"},
-            {"Ceiling", "Ceiling[x]: Smallest integer >= x", "Other"},
-            {"Sqrt", "Sqrt[x]: Square root of x", "Other"},
-            {"Round", "Round[x]: Round x to the nearest integer", "Other"},
-            {"Gamma", "Gamma[x]: Gamma function of x", "Other"},
-            {"Rational", "Rational[n, d]: Rational number n/d (exact)", "Other"},
-
-            // Polynomial manipulation
-            {"Expand", "Expand[expr]: Expand out products and powers in a polynomial expression", "Polynomial"},
-            {"Factor", "Factor[expr]: Factor a polynomial expression over the integers", "Polynomial"},
-            {"Collect", "Collect[expr, x]: Collect terms in expr by powers of x", "Polynomial"},
-            {"GCD", "GCD[a, b]: Greatest common divisor of two polynomials or integers", "Polynomial"},
-            {"PolynomialQuotient", "PolynomialQuotient[a, b, x]: Quotient of a divided by b with respect to variable x", "Polynomial"},
-            
-            // Logical
-            {"And", "And[a, b, ...]: Logical AND (True if all arguments are True)", "Logical"},
-            {"Or", "Or[a, b, ...]: Logical OR (True if any argument is True)", "Logical"},
-
-            // String functions
-            {"StringJoin", "StringJoin[str1, str2, ...]: Concatenate strings", "String"},
-            {"StringLength", "StringLength[str]: Length of a string", "String"},
-            {"StringReplace", "StringReplace[str, rule]: Replace substrings using a rule", "String"},
-            {"StringTake", "StringTake[str, n or {start, end}]: Take substring by count or range", "String"},
-
-            // List functions
-            {"Length", "Length[list]: Number of elements in a list", "List"},
-
-            // Numeric
-            {"N", "N[expr]: Evaluate numerically", "Numeric"},
-
-            // Output/Display
-            {"FullForm", "FullForm[expr]: Show the internal structure of expr", "Other"},
-
-            // Constants (not functions, but useful for help)
-            {"Pi", "Pi: The mathematical constant π ≈ 3.14159", "Constants"},
-            {"E", "E: The mathematical constant e ≈ 2.71828", "Constants"},
-            {"Degree", "Degree: 1 degree = Pi/180 radians", "Constants"},
-        };
-        return entries;
+    namespace help_detail {
+        consteval std::array<std::string_view, std::size(HELP_ENTRIES)> names() {
+            std::array<std::string_view, std::size(HELP_ENTRIES)> out{};
+            for (size_t i = 0; i < out.size(); ++i) out[i] = HELP_ENTRIES[i].name;
+            return out;
+        }
+
+        inline constexpr PerfectHash<std::size(HELP_ENTRIES)> index(names());
+    }
+
+    inline constexpr std::span<const HelpEntry> get_help_entries() { return HELP_ENTRIES; }
+
+    // The first entry named `name`, or nullptr
+    inline constexpr const HelpEntry* find_help_entry(std::string_view name) {
+        const size_t i = help_detail::index.find(name);
+        return i == help_detail::index.NOT_FOUND ? nullptr : &HELP_ENTRIES[i];
     }
 
-}
\ No newline at end of file
+}
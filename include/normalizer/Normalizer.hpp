@@ -4,56 +4,105 @@
 #include "util/Overloaded.hpp"
 #include <memory>
 #include <algorithm>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 namespace aleph3 {
 
-inline ExprPtr normalize_expr(const ExprPtr& expr) {
+namespace detail {
+
+inline bool is_flat_head(Atom head) {
+    return head == atoms::Plus || head == atoms::Times;
+}
+
+inline bool is_difference(const ExprPtr& e) {
+    auto f = std::get_if<FunctionCall>(e.get());
+    return f && f->head == atoms::Minus && f->args.size() == 2;
+}
+
+// Whether flattening changes `f`: a nested call to the same head, or a difference in a sum
+inline bool has_nested(const FunctionCall& f) {
+    for (const auto& arg : f.args) {
+        if (auto inner = std::get_if<FunctionCall>(arg.get()); inner && inner->head == f.head) return true;
+        if (f.head == atoms::Plus && is_difference(arg)) return true;
+    }
+    return false;
+}
+
+// Appends `args` to `out`, replacing calls to `head` by their arguments at any depth. In a
+// sum, a difference a - b contributes the terms of a and then Times(-1, b).
+inline void flatten_into(Atom head, const std::vector<ExprPtr>& args, std::vector<ExprPtr>& out) {
+    struct Pending {
+        const std::vector<ExprPtr>* list;
+        size_t next;
+        bool difference;
+    };
+    std::vector<Pending> stack{ { &args, 0, false } };
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        if (top.next == top.list->size()) {
+            stack.pop_back();
+            continue;
+        }
+        const size_t index = top.next++;
+        const ExprPtr& arg = (*top.list)[index];
+        if (top.difference && index == 1) {
+            out.push_back(make_fcall(atoms::Times, { make_expr<Number>(-1), arg }));
+            continue;
+        }
+        auto inner = std::get_if<FunctionCall>(arg.get());
+        if (inner && inner->head == head) {
+            stack.push_back({ &inner->args, 0, false }); // invalidates `top`
+        }
+        else if (head == atoms::Plus && is_difference(arg)) {
+            stack.push_back({ &inner->args, 0, true });
+        }
+        else {
+            out.push_back(arg);
+        }
+    }
+}
+
+// Applies the normalization rules at the root of `expr`, whose children are already normal
+inline ExprPtr normalize_node(const ExprPtr& expr) {
     return std::visit(overloaded{
-        [](const Number& num) -> ExprPtr {
-            return make_expr<Number>(num.value);
-        },
-        [](const Complex& c) -> ExprPtr {
-            return make_expr<Complex>(c.real, c.imag);
-        },
-        [](const Rational& r) -> ExprPtr {
-            return make_expr<Rational>(r.numerator, r.denominator);
-        },
-        [](const Boolean& boolean) -> ExprPtr {
-            return make_expr<Boolean>(boolean.value);
-        },
-        [](const String& str) -> ExprPtr {
-            return make_expr<String>(str.value);
-        },
-        [](const Infinity&) -> ExprPtr {
-            return make_expr<Infinity>();
-        },
-        [](const Indeterminate&) -> ExprPtr {
-            return make_expr<Indeterminate>();
-        },
-        [](const Symbol& sym) -> ExprPtr {
-            return make_expr<Symbol>(sym.name);
-        },
-        [](const FunctionCall& f) -> ExprPtr {
-            if (f.head == "Minus" && f.args.size() == 2) {
+        // Atoms are already normal; keep the node so caches attached to the tree survive
+        [&](const Number&) -> ExprPtr { return expr; },
+        [&](const Complex&) -> ExprPtr { return expr; },
+        [&](const Rational&) -> ExprPtr { return expr; },
+        [&](const Boolean&) -> ExprPtr { return expr; },
+        [&](const String&) -> ExprPtr { return expr; },
+        [&](const Infinity&) -> ExprPtr { return expr; },
+        [&](const Indeterminate&) -> ExprPtr { return expr; },
+        [&](const PackedArray&) -> ExprPtr { return expr; },
+        [&](const LazyList&) -> ExprPtr { return expr; },
+        [&](const Symbol&) -> ExprPtr { return expr; },
+        [&](const FunctionCall& f) -> ExprPtr {
+            if (is_flat_head(f.head) && has_nested(f)) {
+                // Plus and Times are associative: splice nested calls into one n-ary call
+                std::vector<ExprPtr> flat;
+                flatten_into(f.head, f.args, flat);
+                return normalize_node(make_fcall(f.head, flat));
+            }
+            if (f.head == atoms::Minus && f.args.size() == 2) {
                 // Normalize Minus(a, b) -> Plus(a, Times(-1, b))
-                auto a = normalize_expr(f.args[0]);
-                auto b = normalize_expr(f.args[1]);
-                return normalize_expr(make_fcall("Plus", {a, make_fcall("Times", {make_expr<Number>(-1), b})}));
+                auto negated = normalize_node(make_fcall(atoms::Times, {make_expr<Number>(-1), f.args[1]}));
+                return normalize_node(make_fcall(atoms::Plus, {f.args[0], negated}));
             }
-            if (f.head == "Plus" && f.args.size() == 2) {
+            if (f.head == atoms::Plus && f.args.size() == 2) {
                 const auto& a = f.args[0];
                 const auto& b = f.args[1];
                 if (std::holds_alternative<Number>(*a)) {
                     // Times(Number, I) and Times(Number, -1, I)
                     if (auto* times = std::get_if<FunctionCall>(b.get())) {
-                        if (times->head == "Times") {
+                        if (times->head == atoms::Times) {
                             // Case: Times(Number, I)
                             if (times->args.size() == 2 &&
                                 std::holds_alternative<Number>(*times->args[0])) {
                                 // Times(Number, Symbol("I"))
                                 if (std::holds_alternative<Symbol>(*times->args[1]) &&
-                                    std::get<Symbol>(*times->args[1]).name == "I") {
+                                    std::get<Symbol>(*times->args[1]).name == atoms::I) {
                                     return make_expr<Complex>(
                                         std::get<Number>(*a).value,
                                         std::get<Number>(*times->args[0]).value
@@ -75,7 +124,7 @@ inline ExprPtr normalize_expr(const ExprPtr& expr) {
                                 std::holds_alternative<Number>(*times->args[0]) &&
                                 std::holds_alternative<Number>(*times->args[1]) &&
                                 std::holds_alternative<Symbol>(*times->args[2]) &&
-                                std::get<Symbol>(*times->args[2]).name == "I") {
+                                std::get<Symbol>(*times->args[2]).name == atoms::I) {
                                 double coeff = std::get<Number>(*times->args[0]).value *
                                             std::get<Number>(*times->args[1]).value;
                                 return make_expr<Complex>(
@@ -103,7 +152,7 @@ inline ExprPtr normalize_expr(const ExprPtr& expr) {
                                 std::holds_alternative<Number>(*times->args[0]) &&
                                 std::holds_alternative<Number>(*times->args[1]) &&
                                 std::holds_alternative<Symbol>(*times->args[2]) &&
-                                std::get<Symbol>(*times->args[2]).name == "I") {
+                                std::get<Symbol>(*times->args[2]).name == atoms::I) {
                                 double coeff = std::get<Number>(*times->args[0]).value *
                                             std::get<Number>(*times->args[1]).value;
                                 return make_expr<Complex>(
@@ -116,15 +165,15 @@ inline ExprPtr normalize_expr(const ExprPtr& expr) {
                 }
             }
             // Normalize Negate(x)
-            if (f.head == "Negate" && f.args.size() == 1) {
-                auto arg = normalize_expr(f.args[0]);
+            if (f.head == atoms::Negate && f.args.size() == 1) {
+                const auto& arg = f.args[0];
                 // If arg is Number, just negate it
                 if (auto num = std::get_if<Number>(arg.get())) {
                     return make_expr<Number>(-num->value);
                 }
                 // If arg is already Times(-1, ...), flatten
                 if (auto inner = std::get_if<FunctionCall>(arg.get())) {
-                    if (inner->head == "Times" && !inner->args.empty()) {
+                    if (inner->head == atoms::Times && !inner->args.empty()) {
                         if (auto n = std::get_if<Number>(inner->args[0].get()); n && n->value == -1) {
                             // Already normalized
                             return arg;
@@ -132,48 +181,161 @@ inline ExprPtr normalize_expr(const ExprPtr& expr) {
                     }
                 }
                 // Otherwise, return Times(-1, arg)
-                return make_fcall("Times", { make_expr<Number>(-1), arg });
+                return make_fcall(atoms::Times, { make_expr<Number>(-1), arg });
             }
-            // Normalize Times
-            if (f.head == "Times") {
-                std::vector<ExprPtr> norm_args;
-                for (const auto& arg : f.args) {
-                    norm_args.push_back(normalize_expr(arg));
-                }
-                return make_fcall("Times", norm_args);
+            // Times, Divide, Power and everything else are normal once their arguments are
+            return expr;
+        },
+        [&](const List&) -> ExprPtr { return expr; },
+        [&](const FunctionDefinition&) -> ExprPtr { return expr; },
+        [&](const Assignment&) -> ExprPtr { return expr; },
+        [&](const Rule&) -> ExprPtr { return expr; }
+        }, *expr);
+}
+
+// Nodes already normalized, and results of evaluation, are not normalized again
+inline bool is_normal_node(const Expr& e) {
+    if (auto f = std::get_if<FunctionCall>(&e)) {
+        return f->normal.is_set() || f->evaluated.epoch.load(std::memory_order_relaxed) != 0;
+    }
+    if (auto l = std::get_if<List>(&e)) {
+        return l->normal.is_set() || l->evaluated.epoch.load(std::memory_order_relaxed) != 0;
+    }
+    return false;
+}
+
+inline ExprPtr mark_normal(ExprPtr e) {
+    if (auto f = std::get_if<FunctionCall>(e.get())) f->normal.set();
+    else if (auto l = std::get_if<List>(e.get())) l->normal.set();
+    return e;
+}
+
+} // namespace detail
+
+// Canonicalizes `expr` bottom-up on an explicit stack, so depth is bounded only by memory.
+// Subtrees that need no change are shared with the input. Every call and list in the result
+// is flagged as normal, so normalizing it again, or a tree built on top of it, only visits
+// the new nodes.
+inline ExprPtr normalize_expr(const ExprPtr& expr) {
+    struct Frame {
+        ExprPtr node;
+        Atom head;                              // Head of the rebuilt call
+        std::vector<ExprPtr> owned;             // Children of a Rule, or a flattened call
+        const std::vector<ExprPtr>* children;
+        size_t next = 0;
+        std::vector<ExprPtr> normalized;
+        bool changed = false;
+        bool shared = false;                    // Referenced from elsewhere too
+    };
+
+    auto has_children = [](const ExprPtr& e) {
+        return std::holds_alternative<FunctionCall>(*e) || std::holds_alternative<List>(*e) ||
+            std::holds_alternative<Rule>(*e);
+    };
+    if (detail::is_normal_node(*expr)) return expr;
+    if (!has_children(expr)) return detail::normalize_node(expr);
+
+    // Frames are kept when popped so their vectors' storage is reused at that depth. A deque
+    // keeps `children` valid when it points at a frame's own `owned` vector.
+    std::deque<Frame> stack;
+    size_t depth = 0;
+    // Results for nodes shared between several parents, so a DAG is normalized in time
+    // linear in its distinct nodes rather than in the size of the tree it unfolds to
+    std::unordered_map<const Expr*, ExprPtr> shared;
+    auto push = [&](const ExprPtr& node) {
+        if (depth == stack.size()) stack.emplace_back();
+        Frame& frame = stack[depth++];
+        frame.shared = node.use_count() > 1;
+        frame.node = node;
+        frame.next = 0;
+        frame.normalized.clear();
+        frame.changed = false;
+        if (auto f = std::get_if<FunctionCall>(node.get())) {
+            frame.head = f->head;
+            frame.children = &f->args;
+            if (detail::is_difference(node)) {
+                // A chain of differences becomes one sum
+                frame.head = atoms::Plus;
+                frame.owned.clear();
+                detail::flatten_into(atoms::Plus, { node }, frame.owned);
+                frame.children = &frame.owned;
+                frame.changed = true;
+            }
+            else if (detail::is_flat_head(f->head) && detail::has_nested(*f)) {
+                // Walk the whole nested chain as this node's children: splicing level by
+                // level would copy a long sum once per level
+                frame.owned.clear();
+                detail::flatten_into(f->head, f->args, frame.owned);
+                frame.children = &frame.owned;
+                frame.changed = true;
+            }
+        }
+        else if (auto l = std::get_if<List>(node.get())) {
+            frame.children = &l->elements;
+        }
+        else {
+            const auto& rule = std::get<Rule>(*node);
+            frame.owned = { rule.lhs, rule.rhs };
+            frame.children = &frame.owned;
+        }
+        frame.normalized.reserve(frame.children->size());
+    };
+
+    push(expr);
+    ExprPtr result;
+    while (depth > 0) {
+        Frame& top = stack[depth - 1];
+        if (top.next < top.children->size()) {
+            const ExprPtr& child = (*top.children)[top.next++];
+            if (detail::is_normal_node(*child)) {
+                top.normalized.push_back(child);
+                continue;
             }
-            // Normalize Divide
-            if (f.head == "Divide" && f.args.size() == 2) {
-                return make_fcall("Divide", { normalize_expr(f.args[0]), normalize_expr(f.args[1]) });
+            if (has_children(child)) {
+                if (auto it = shared.find(child.get()); it != shared.end()) {
+                    top.changed |= it->second != child;
+                    top.normalized.push_back(it->second);
+                    continue;
+                }
+                push(child);
+                continue;
             }
-            // Normalize Power
-            if (f.head == "Power" && f.args.size() == 2) {
-                return make_fcall("Power", { normalize_expr(f.args[0]), normalize_expr(f.args[1]) });
+            auto norm = detail::normalize_node(child);
+            top.changed |= norm != child;
+            top.normalized.push_back(std::move(norm));
+            continue;
+        }
+
+        // All children are normal: rebuild if any changed, then apply the rules at this node
+        ExprPtr node = top.node;
+        if (top.changed) {
+            if (std::holds_alternative<FunctionCall>(*node)) {
+                node = make_fcall(top.head, top.normalized);
             }
-            // Default: normalize all arguments
-            std::vector<ExprPtr> norm_args;
-            for (const auto& arg : f.args) {
-                norm_args.push_back(normalize_expr(arg));
+            else if (std::holds_alternative<List>(*node)) {
+                node = make_expr<List>(top.normalized);
             }
-            return make_fcall(f.head, norm_args);
-        },
-        [](const List& list) -> ExprPtr {
-            std::vector<ExprPtr> norm_elems;
-            for (const auto& elem : list.elements) {
-                norm_elems.push_back(normalize_expr(elem));
+            else {
+                node = make_expr<Rule>(top.normalized[0], top.normalized[1]);
             }
-            return std::make_shared<Expr>(List{norm_elems});
-        },
-        [](const FunctionDefinition& def) -> ExprPtr {
-            return make_expr<FunctionDefinition>(def.name, def.params, def.body, def.delayed);
-        },
-        [](const Assignment& assign) -> ExprPtr {
-            return make_expr<Assignment>(assign.name, assign.value);
-        },
-        [](const Rule& rule) -> ExprPtr {
-            return make_expr<Rule>(normalize_expr(rule.lhs), normalize_expr(rule.rhs));
         }
-        }, *expr);
+        const Expr* original = top.node.get();
+        const bool is_shared = top.shared;
+        top.node.reset();
+        top.owned.clear();
+        --depth;
+        auto norm = detail::mark_normal(detail::normalize_node(node));
+        if (is_shared && depth > 0 && norm.get() != original) shared.emplace(original, norm); // Unchanged nodes are flagged normal
+        if (depth == 0) {
+            result = std::move(norm);
+        }
+        else {
+            Frame& parent = stack[depth - 1];
+            parent.changed |= norm != (*parent.children)[parent.next - 1];
+            parent.normalized.push_back(std::move(norm));
+        }
+    }
+    return result;
 }
 
 }
\ No newline at end of file
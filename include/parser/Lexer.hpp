@@ -0,0 +1,227 @@
+/*
+ * Lexer.hpp
+ * ---------
+ * Splits parser input into tokens that point into the source buffer.
+ *
+ * Bytes are classified through a 256-entry table, so plain ASCII input never decodes UTF-8.
+ * Any byte of 0x80 or above counts as a letter, which keeps non-ASCII code points inside
+ * symbols. A symbol that contains such bytes is checked once for valid UTF-8 when it is cut.
+ * Operators are recognized by a switch on their first byte, longest match first. Comments,
+ * (* ... *), which may nest, are skipped like whitespace.
+ *
+ * No text is copied: a Token holds a std::string_view into the source, and the source must
+ * outlive the tokens.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "utf8.h"
+
+namespace aleph3 {
+
+    enum class TokenKind : uint8_t {
+        End,
+        Number,              // [0-9.]+
+        String,              // Text between the quotes
+        UnterminatedString,  // A '"' with no closing quote; text runs to the end
+        Symbol,              // '_' alone, or a letter followed by letters, digits and '_'
+        InvalidUtf8,         // A symbol whose non-ASCII bytes are not valid UTF-8
+        Rule,                // ->
+        ReplaceAll,          // /. not followed by a digit (x/.5 divides by .5)
+        ReplaceRepeated,     // //.
+        Condition,           // /;
+        Equal,               // ==
+        NotEqual,            // !=
+        LessEqual,           // <=
+        GreaterEqual,        // >=
+        Less,                // <
+        Greater,             // >
+        Or,                  // ||
+        And,                 // &&
+        StringJoin,          // <>
+        Plus,
+        Minus,
+        Times,
+        Divide,
+        Power,
+        LeftParen,
+        RightParen,
+        LeftBracket,
+        RightBracket,
+        LeftBrace,
+        RightBrace,
+        Comma,
+        Set,                 // =
+        SetDelayed,          // :=
+        Colon,
+        Semicolon,           // Ends a statement (see Statements.hpp)
+        Unknown              // Any other single byte
+    };
+
+    struct Token {
+        TokenKind kind;
+        std::string_view text;
+    };
+
+    namespace lexer_detail {
+        enum : uint8_t { SPACE = 1, DIGIT = 2, LETTER = 4, UNDERSCORE = 8, DOT = 16 };
+
+        constexpr std::array<uint8_t, 256> make_classes() {
+            std::array<uint8_t, 256> classes{};
+            for (int c : { ' ', '\t', '\n', '\r', '\f', '\v' }) classes[c] = SPACE;
+            for (int c = '0'; c <= '9'; ++c) classes[c] = DIGIT;
+            for (int c = 'A'; c <= 'Z'; ++c) classes[c] = LETTER;
+            for (int c = 'a'; c <= 'z'; ++c) classes[c] = LETTER;
+            for (int c = 0x80; c < 256; ++c) classes[c] = LETTER;
+            classes['_'] = UNDERSCORE;
+            classes['.'] = DOT;
+            return classes;
+        }
+
+        inline constexpr std::array<uint8_t, 256> CLASSES = make_classes();
+
+        inline bool is(char c, uint8_t mask) { return (CLASSES[static_cast<unsigned char>(c)] & mask) != 0; }
+    }
+
+    // True if c can start a symbol other than '_'
+    inline bool is_letter(char c) { return lexer_detail::is(c, lexer_detail::LETTER); }
+
+    inline bool is_digit(char c) { return lexer_detail::is(c, lexer_detail::DIGIT); }
+
+    class Lexer {
+    public:
+        explicit Lexer(std::string_view source) : source_(source), pos_(0) {}
+
+        // The next token; End, with empty text at the end of the source, once it is exhausted
+        Token next() {
+            using namespace lexer_detail;
+            const size_t n = source_.size();
+            skip_space();
+            if (pos_ == n) return { TokenKind::End, source_.substr(n) };
+
+            const size_t start = pos_;
+            const char c = source_[pos_];
+            if (is(c, DIGIT | DOT)) {
+                while (pos_ < n && is(source_[pos_], DIGIT | DOT)) ++pos_;
+                return cut(TokenKind::Number, start);
+            }
+            if (is(c, LETTER)) {
+                bool ascii = true;
+                while (pos_ < n && is(source_[pos_], LETTER | DIGIT | UNDERSCORE)) {
+                    ascii &= static_cast<unsigned char>(source_[pos_]) < 0x80;
+                    ++pos_;
+                }
+                Token token = cut(TokenKind::Symbol, start);
+                if (!ascii && !utf8::is_valid(token.text.begin(), token.text.end())) token.kind = TokenKind::InvalidUtf8;
+                return token;
+            }
+
+            ++pos_;
+            switch (c) {
+            case '_': return cut(TokenKind::Symbol, start);
+            case '"': {
+                const size_t close = source_.find('"', pos_);
+                if (close == std::string_view::npos) {
+                    pos_ = n;
+                    return { TokenKind::UnterminatedString, source_.substr(start + 1) };
+                }
+                pos_ = close + 1;
+                return { TokenKind::String, source_.substr(start + 1, close - start - 1) };
+            }
+            case '-': return pair('>', TokenKind::Rule, TokenKind::Minus, start);
+            case '=': return pair('=', TokenKind::Equal, TokenKind::Set, start);
+            case '!': return pair('=', TokenKind::NotEqual, TokenKind::Unknown, start);
+            case '>': return pair('=', TokenKind::GreaterEqual, TokenKind::Greater, start);
+            case '|': return pair('|', TokenKind::Or, TokenKind::Unknown, start);
+            case '&': return pair('&', TokenKind::And, TokenKind::Unknown, start);
+            case ':': return pair('=', TokenKind::SetDelayed, TokenKind::Colon, start);
+            case '<':
+                if (pos_ < n && source_[pos_] == '>') {
+                    ++pos_;
+                    return cut(TokenKind::StringJoin, start);
+                }
+                return pair('=', TokenKind::LessEqual, TokenKind::Less, start);
+            case '+': return cut(TokenKind::Plus, start);
+            case '*': return cut(TokenKind::Times, start);
+            case '/':
+                if (source_.compare(pos_, 2, "/.") == 0) {
+                    pos_ += 2;
+                    return cut(TokenKind::ReplaceRepeated, start);
+                }
+                if (pos_ < n && source_[pos_] == '.' && !(pos_ + 1 < n && is_digit(source_[pos_ + 1]))) {
+                    ++pos_;
+                    return cut(TokenKind::ReplaceAll, start);
+                }
+                return pair(';', TokenKind::Condition, TokenKind::Divide, start);
+            case '^': return cut(TokenKind::Power, start);
+            case '(': return cut(TokenKind::LeftParen, start);
+            case ')': return cut(TokenKind::RightParen, start);
+            case '[': return cut(TokenKind::LeftBracket, start);
+            case ']': return cut(TokenKind::RightBracket, start);
+            case '{': return cut(TokenKind::LeftBrace, start);
+            case '}': return cut(TokenKind::RightBrace, start);
+            case ',': return cut(TokenKind::Comma, start);
+            case ';': return cut(TokenKind::Semicolon, start);
+            default: return cut(TokenKind::Unknown, start);
+            }
+        }
+
+        // Every token of source, ending with End
+        static std::vector<Token> tokenize(std::string_view source) {
+            std::vector<Token> tokens;
+            // Generated input averages a few bytes per token
+            tokens.reserve(source.size() / 3 + 1);
+            Lexer lexer(source);
+            do {
+                tokens.push_back(lexer.next());
+            } while (tokens.back().kind != TokenKind::End);
+            return tokens;
+        }
+
+    private:
+        std::string_view source_;
+        size_t pos_;
+
+        // Skips whitespace and comments; an unterminated comment runs to the end
+        void skip_space() {
+            using namespace lexer_detail;
+            const size_t n = source_.size();
+            while (pos_ < n) {
+                if (is(source_[pos_], SPACE)) {
+                    ++pos_;
+                    continue;
+                }
+                if (source_.compare(pos_, 2, "(*") != 0) return;
+                size_t depth = 0;
+                while (pos_ < n) {
+                    if (source_.compare(pos_, 2, "(*") == 0) {
+                        ++depth;
+                        pos_ += 2;
+                    }
+                    else if (source_.compare(pos_, 2, "*)") == 0) {
+                        pos_ += 2;
+                        if (--depth == 0) break;
+                    }
+                    else {
+                        ++pos_;
+                    }
+                }
+            }
+        }
+
+        Token cut(TokenKind kind, size_t start) const { return { kind, source_.substr(start, pos_ - start) }; }
+
+        // `two` if the byte after the first one is `second`, otherwise `one`
+        Token pair(char second, TokenKind two, TokenKind one, size_t start) {
+            if (pos_ < source_.size() && source_[pos_] == second) {
+                ++pos_;
+                return cut(two, start);
+            }
+            return cut(one, start);
+        }
+    };
+
+} // namespace aleph3
@@ -10,19 +10,25 @@
  * - Support for numbers, rationals, symbols, functions, and lists
  * - Error handling for invalid syntax
  *
+ * The input is split into tokens by the Lexer (see Lexer.hpp) before parsing starts, and the
+ * parser reads them with a fixed lookahead: it never rewinds and never looks at characters.
+ *
  * See README.md for project overview.
  */
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <cctype>
+#include <charconv>
 #include <stdexcept>
 #include <cmath>
 #include "expr/Expr.hpp"
 #include "expr/ExprUtils.hpp"
-#include "utf8.h"
+#include "evaluator/Budget.hpp"
+#include "parser/Lexer.hpp"
 
 namespace aleph3 {
 
@@ -31,784 +37,825 @@ namespace aleph3 {
     struct OperatorInfo {
         int precedence;
         Assoc assoc;
-        std::string ast_name; // "Plus", "Times", "Rule", etc.
-    };
-
-    // Operator table: precedence (higher = tighter), associativity, AST head
-    static const std::vector<std::pair<std::string, OperatorInfo>> infix_operators = {
-        {"->",   {1, Assoc::Right, "Rule"}},
-        {"==",   {2, Assoc::Left,  "Equal"}},
-        {"!=",   {2, Assoc::Left,  "NotEqual"}},
-        {"<=",   {2, Assoc::Left,  "LessEqual"}},
-        {">=",   {2, Assoc::Left,  "GreaterEqual"}},
-        {"<",    {2, Assoc::Left,  "Less"}},
-        {">",    {2, Assoc::Left,  "Greater"}},
-        {"||",   {3, Assoc::Left,  "Or"}},
-        {"&&",   {4, Assoc::Left,  "And"}},
-        {"<>",   {5, Assoc::Left,  "StringJoin"}},
-        {"+",    {6, Assoc::Left,  "Plus"}},
-        {"-",    {6, Assoc::Left,  "Minus"}},
-        {"*",    {7, Assoc::Left,  "Times"}},
-        {"/",    {7, Assoc::Left,  "Divide"}},
-        {"^",    {8, Assoc::Right, "Power"}},
+        Atom head; // Plus, Times, Rule, etc.
     };
 
-    static bool is_letter(uint32_t cp) {
-        return (cp >= 'A' && cp <= 'Z') ||
-            (cp >= 'a' && cp <= 'z') ||
-            (cp > 127);
-    }
-
-    static bool is_digit(uint32_t cp) {
-        return (cp >= '0' && cp <= '9');
-    }
-
-    static bool is_identifier_start(uint32_t cp) {
-        return cp == '_' || is_letter(cp);
-    }
-
-    static bool is_identifier_body_char(uint32_t cp) {
-        return is_digit(cp) || is_letter(cp);
-    }
-
-    static bool is_symbol_body_char(uint32_t cp) {
-        return cp == '_' || is_digit(cp) || is_letter(cp);
+    // Infix operators: precedence (higher = tighter), associativity, AST head. Tokens that are
+    // not infix operators have precedence 0.
+    constexpr OperatorInfo infix_operator(TokenKind kind) {
+        switch (kind) {
+        case TokenKind::ReplaceAll:      return { 1,  Assoc::Left,  atoms::ReplaceAll };
+        case TokenKind::ReplaceRepeated: return { 1,  Assoc::Left,  atoms::ReplaceRepeated };
+        case TokenKind::Rule:            return { 2,  Assoc::Right, atoms::Rule };
+        case TokenKind::Condition:       return { 3,  Assoc::Left,  atoms::Condition };
+        case TokenKind::Equal:           return { 4,  Assoc::Left,  atoms::Equal };
+        case TokenKind::NotEqual:        return { 4,  Assoc::Left,  atoms::NotEqual };
+        case TokenKind::LessEqual:       return { 4,  Assoc::Left,  atoms::LessEqual };
+        case TokenKind::GreaterEqual:    return { 4,  Assoc::Left,  atoms::GreaterEqual };
+        case TokenKind::Less:            return { 4,  Assoc::Left,  atoms::Less };
+        case TokenKind::Greater:         return { 4,  Assoc::Left,  atoms::Greater };
+        case TokenKind::Or:              return { 5,  Assoc::Left,  atoms::Or };
+        case TokenKind::And:             return { 6,  Assoc::Left,  atoms::And };
+        case TokenKind::StringJoin:      return { 7,  Assoc::Left,  atoms::StringJoin };
+        case TokenKind::Plus:            return { 8,  Assoc::Left,  atoms::Plus };
+        case TokenKind::Minus:           return { 8,  Assoc::Left,  atoms::Minus };
+        case TokenKind::Times:           return { 9,  Assoc::Left,  atoms::Times };
+        case TokenKind::Divide:          return { 9,  Assoc::Left,  atoms::Divide };
+        case TokenKind::Power:           return { 10, Assoc::Right, atoms::Power };
+        default:                         return { 0,  Assoc::Left,  Atom() };
+        }
     }
 
-    static bool is_ascii_whitespace(uint32_t cp) {
-        return cp == ' ' || cp == '\t' || cp == '\n' || cp == '\r' || cp == '\f' || cp == '\v';
+    // Length of the identifier a symbol starts with: '_' alone, or up to the first '_'
+    inline size_t identifier_length(std::string_view symbol) {
+        if (symbol.front() == '_') return 1;
+        return std::min(symbol.find('_'), symbol.size());
     }
 
     class Parser {
         friend class ParserTestHelper;
 
     public:
-        Parser(const std::string& input) : input(input), pos(0), paren_depth(0) {}
+        // The parser reads input in place; it must outlive the parser
+        Parser(std::string_view input) : input(input), tokens(Lexer::tokenize(input)), index(0) {}
 
         ExprPtr parse() {
-            skip_whitespace();
-            size_t backup = pos;
-
-            // Try parsing function definition
-            if (is_identifier_start(peek())) {
-                auto name = parse_identifier();
-                skip_whitespace();
+            const Token first = peek();
+            if (first.kind == TokenKind::Symbol && identifier_length(first.text) == first.text.size()) {
+                const TokenKind after = peek(1).kind;
 
                 // Special case: If statement
-                if (name == "If" && match('[')) {
-                    pos -= 3; // Reset position to re-parse the "If[" in parse_if
+                if (first.text == "If" && after == TokenKind::LeftBracket) {
                     return parse_if();
                 }
 
-                // Check if it's an assignment (e.g., x = 2)
-                if (peek_string(2) != "==" && match('=')) {
+                // Assignment (e.g., x = 2)
+                if (after == TokenKind::Set) {
+                    index += 2;
                     auto value = parse_expression(); // Parse the assigned value
-                    return make_expr<Assignment>(name, value);
+                    return make_expr<Assignment>(first.text, value);
                 }
 
-                // If it's followed by '[', maybe it's a definition
-                if (match('[')) {
-                    std::vector<Parameter> params;
-                    bool is_def = true;
-
-                    while (true) {
-                        skip_whitespace();
-                        size_t id_backup = pos;
-                        std::string arg;
-                        try {
-                            arg = parse_identifier();
-                        }
-                        catch (...) {
-                            is_def = false;
-                            break;
-                        }
-                        skip_whitespace();
-                        if (!match('_')) {
-                            is_def = false;
-                            break;
-                        }
-                        skip_whitespace();
-                        ExprPtr default_value = nullptr;
-                        if (match(':')) {
-                            // Parse the default value expression
-                            default_value = parse_expression();
-                        }
-                        params.emplace_back(arg, default_value);
-                        skip_whitespace();
-                        if (match(']')) break;
-                        if (!match(',')) {
-                            is_def = false;
-                            break;
-                        }
-                    }
-
-                    skip_whitespace();
-                    // Handle both `:=` and `=` for function definitions
-                    if (is_def && (match_string(":=") || match('='))) {
-                        bool delayed = input[pos - 2] == ':'; // Check if `:=` was matched
-                        auto body = parse_expression();
-                        return make_expr<FunctionDefinition>(name, params, body, delayed);
-                    }
-                    else {
-                        // Not a definition; reset and fall through to expression
-                        pos = backup;
-                    }
-                }
-                else {
-                    // Not a function definition; reset
-                    pos = backup;
+                // Function definition, e.g. f[x_, y_:1] := ...
+                if (after == TokenKind::LeftBracket && is_definition()) {
+                    return parse_definition();
                 }
             }
 
             // Delegate to Pratt parser for general expressions
-            return parse_expression();
+            return parse_set();
         }
 
     private:
-        std::string input;
-        size_t pos;
-        int paren_depth;
+        std::string_view input;
+        std::vector<Token> tokens; // Ends with an End token
+        size_t index;
+
+        // True if the tokens after `name[` are parameters and a closing ']' followed by `:=` or
+        // `=`. Only brackets are counted, so this is decided before anything is parsed.
+        bool is_definition() const {
+            size_t i = index + 2;
+            while (true) {
+                // x_, or x _
+                const Token& arg = at(i);
+                if (arg.kind != TokenKind::Symbol) return false;
+                const size_t length = identifier_length(arg.text);
+                if (length == arg.text.size()) {
+                    if (at(i + 1).kind != TokenKind::Symbol || at(i + 1).text != "_") return false;
+                    i += 2;
+                }
+                else if (length + 1 == arg.text.size() && arg.text.back() == '_') {
+                    ++i;
+                }
+                else {
+                    return false;
+                }
 
-        // Pratt/precedence climbing parser
-        ExprPtr parse_expression(int min_precedence = 1) {
-            auto left = parse_factor();
+                // A default value runs to the next ',' or ']' outside brackets
+                if (at(i).kind == TokenKind::Colon) {
+                    int depth = 0;
+                    for (++i;; ++i) {
+                        const TokenKind kind = at(i).kind;
+                        if (kind == TokenKind::End) return false;
+                        if (depth == 0 && (kind == TokenKind::Comma || kind == TokenKind::RightBracket)) break;
+                        if (kind == TokenKind::LeftParen || kind == TokenKind::LeftBracket || kind == TokenKind::LeftBrace) ++depth;
+                        if (kind == TokenKind::RightParen || kind == TokenKind::RightBracket || kind == TokenKind::RightBrace) --depth;
+                    }
+                }
+                if (at(i).kind == TokenKind::RightBracket) break;
+                if (at(i).kind != TokenKind::Comma) return false;
+                ++i;
+            }
+            const TokenKind assign = at(i + 1).kind;
+            return assign == TokenKind::SetDelayed || assign == TokenKind::Set;
+        }
 
+        ExprPtr parse_definition() {
+            const std::string_view name = next().text;
+            next(); // '['
+            std::vector<Parameter> params;
             while (true) {
-                skip_whitespace();
-                std::string op = peek_operator();
-                if (op.empty()) break;
+                const std::string_view arg = parse_identifier();
+                next(); // '_'
+                ExprPtr default_value = nullptr;
+                if (match(TokenKind::Colon)) {
+                    // Parse the default value expression
+                    default_value = parse_expression();
+                }
+                params.emplace_back(arg, default_value);
+                if (match(TokenKind::RightBracket)) break;
+                if (!match(TokenKind::Comma)) {
+                    error("Expected ',' or ']' in parameter list");
+                }
+            }
+            // Handle both `:=` and `=` for function definitions
+            const bool delayed = next().kind == TokenKind::SetDelayed;
+            auto body = parse_set();
+            return make_expr<FunctionDefinition>(name, params, body, delayed);
+        }
 
-                OperatorInfo info = get_operator_info(op);
-                if (info.precedence < min_precedence) break;
+        // expr, or `lhs = rhs` as Set[lhs, rhs] (e.g. f[0] = 1, or the memo in f[n_] := f[n] = ...)
+        ExprPtr parse_set() {
+            auto lhs = parse_expression();
+            if (match(TokenKind::Set)) {
+                auto rhs = parse_set();
+                return make_expr<FunctionCall>(atoms::Set, std::vector<ExprPtr>{ lhs, rhs });
+            }
+            return lhs;
+        }
 
-                pos += op.size(); // consume operator
+        // --- Operator-precedence parsing ---
+        //
+        // Expressions are parsed without recursion. Every construct that is still open (an
+        // infix expression, a list, the arguments of a call, a parenthesis, ...) is a Frame on
+        // an explicit stack, and the values it has collected so far wait on shared stacks, so
+        // neither the length of a sum nor the depth of nesting is limited by the call stack.
+
+        enum class FrameKind : uint8_t {
+            Expression,       // Infix operators and operands so far, in operators and operands
+            List,             // Elements so far, in items
+            Call,             // Arguments of `head` so far, in items
+            NegatedArgument,  // A call argument written right after '[' or ',' as -expr
+            Paren,
+            RationalArgs,     // Rational[n, d], arguments so far in items
+            ComplexArgs,      // Complex[re, im], arguments so far in items
+            UnaryPlus,
+            NegatedQuotient,  // -n/factor, with `number` = n
+            NegatedProduct,   // -n factor, with the first factor in items
+            Negation,         // -factor
+            Product           // Implicit multiplication, factors so far in items
+        };
+
+        struct Frame {
+            FrameKind kind;
+            size_t base = 0;           // Size of items, or of operands for an Expression, at the start
+            size_t operator_base = 0;  // Size of operators at the start of an Expression
+            Atom head{};               // Call
+            double number = 0.0;       // NegatedQuotient
+        };
+
+        // A parsed value. A sum or product written as a chain (a + b + c, a*b*c or a b c) stays
+        // open, with `chain` as its head and its arguments in `args`, until something other than
+        // a further argument uses it, so the node it becomes is flat. Parentheses close it.
+        struct Operand {
+            ExprPtr expr;
+            Atom chain{};
+            std::vector<ExprPtr> args{};
+        };
+
+        // What the parse loop does next: start a factor at the current token, or hand a
+        // finished factor or expression to the innermost open frame
+        enum class Step { Factor, FactorDone, ExpressionDone };
+
+        std::vector<Frame> frames;
+        std::vector<ExprPtr> items;
+        std::vector<Operand> operands;
+        std::vector<OperatorInfo> operators;
+
+        ExprPtr parse_expression() {
+            const size_t base = frames.size();
+            start_expression();
+            return run(base, Step::Factor, Operand{}, false);
+        }
 
-                int next_min_prec = info.assoc == Assoc::Left ? info.precedence + 1 : info.precedence;
-                auto right = parse_expression(next_min_prec);
+        ExprPtr parse_symbol() {
+            const size_t base = frames.size();
+            Operand value;
+            bool product = false;
+            const Step step = start_symbol(value, product);
+            return run(base, step, std::move(value), product);
+        }
 
-                if (info.ast_name == "Rule") {
-                    left = make_expr<Rule>(left, right);
+        // Runs the parse loop until only `base` frames are open, and returns the value that
+        // closed the last of the others
+        ExprPtr run(size_t base, Step step, Operand value, bool product) {
+            while (true) {
+                poll_budget();
+                if (step == Step::Factor) {
+                    step = start_factor(value, product);
+                    continue;
                 }
-                else if (info.ast_name == "StringJoin") {
-                    // Flatten left if it's also a StringJoin
-                    std::vector<ExprPtr> args;
-                    if (auto* left_call = std::get_if<FunctionCall>(&(*left));
-                        left_call && left_call->head == "StringJoin") {
-                        args = left_call->args;
+                if (frames.size() == base) return close(std::move(value));
+                const Frame top = frames.back();
+
+                if (step == Step::FactorDone) {
+                    // Implicit multiplication: -2x, 2(x), x y, ...
+                    if (top.kind == FrameKind::Product) {
+                        append(items, std::move(value), atoms::Times);
+                        if (starts_product(peek())) {
+                            step = Step::Factor;
+                            continue;
+                        }
+                        frames.pop_back();
+                        value = Operand{ nullptr, atoms::Times, take_items(top.base) };
+                        product = false;
+                        continue;
+                    }
+                    if (product && starts_product(peek())) {
+                        frames.push_back({ FrameKind::Product, items.size() });
+                        append(items, std::move(value), atoms::Times);
+                        step = Step::Factor;
+                        continue;
+                    }
+
+                    switch (top.kind) {
+                    case FrameKind::Expression: {
+                        operands.push_back(std::move(value));
+                        const OperatorInfo info = infix_operator(peek().kind);
+                        if (info.precedence == 0) {
+                            while (operators.size() > top.operator_base) reduce();
+                            value = std::move(operands.back());
+                            operands.pop_back();
+                            frames.pop_back();
+                            step = Step::ExpressionDone;
+                            break;
+                        }
+                        // Left operators bind to the left at equal precedence, right ones wait
+                        while (operators.size() > top.operator_base &&
+                               (operators.back().precedence > info.precedence ||
+                                (operators.back().precedence == info.precedence && info.assoc == Assoc::Left))) {
+                            reduce();
+                        }
+                        operators.push_back(info);
+                        next(); // consume operator
+                        step = Step::Factor;
+                        break;
+                    }
+                    case FrameKind::UnaryPlus:
+                        frames.pop_back();
+                        product = true;
+                        break;
+                    case FrameKind::NegatedQuotient:
+                        // Not a number: treat as a full factor (e.g. -2/(3x))
+                        frames.pop_back();
+                        value = Operand{ make_expr<FunctionCall>(atoms::Divide, std::vector<ExprPtr>{
+                            make_expr<Number>(-top.number), close(std::move(value))
+                        }) };
+                        product = false;
+                        break;
+                    case FrameKind::NegatedProduct: {
+                        frames.pop_back();
+                        std::vector<ExprPtr> factors = take_items(top.base);
+                        append(factors, std::move(value), atoms::Times);
+                        value = Operand{ nullptr, atoms::Times, std::move(factors) };
+                        product = false;
+                        break;
+                    }
+                    case FrameKind::Negation:
+                        frames.pop_back();
+                        value = Operand{ negation(close(std::move(value))) };
+                        product = true;
+                        break;
+                    default:
+                        error("Unexpected factor");
+                    }
+                    continue;
+                }
+
+                // step == Step::ExpressionDone
+                switch (top.kind) {
+                case FrameKind::NegatedArgument:
+                    frames.pop_back();
+                    value = Operand{ make_expr<FunctionCall>(atoms::Negate, std::vector<ExprPtr>{ close(std::move(value)) }) };
+                    break;
+                case FrameKind::List:
+                    items.push_back(close(std::move(value)));
+                    if (match(TokenKind::RightBrace)) {
+                        frames.pop_back();
+                        value = Operand{ make_expr<FunctionCall>(atoms::List, take_items(top.base)) };
+                        step = Step::FactorDone;
+                        product = true;
+                    }
+                    else if (match(TokenKind::Comma)) {
+                        start_expression();
+                        step = Step::Factor;
                     }
                     else {
-                        args.push_back(left);
+                        error("Expected ',' or '}' in list");
                     }
-                    // Flatten right if it's also a StringJoin (rare, but for completeness)
-                    if (auto* right_call = std::get_if<FunctionCall>(&(*right));
-                        right_call && right_call->head == "StringJoin") {
-                        args.insert(args.end(), right_call->args.begin(), right_call->args.end());
+                    break;
+                case FrameKind::Call:
+                    items.push_back(close(std::move(value)));
+                    if (match(TokenKind::RightBracket)) {
+                        frames.pop_back();
+                        value = Operand{ make_expr<FunctionCall>(top.head, take_items(top.base)) };
+                        step = Step::FactorDone;
+                        product = true;
+                    }
+                    else if (match(TokenKind::Comma)) {
+                        start_argument();
+                        step = Step::Factor;
                     }
                     else {
-                        args.push_back(right);
+                        error("Expected ',' or ']' in function call");
+                    }
+                    break;
+                case FrameKind::Paren:
+                    if (!match(TokenKind::RightParen)) {
+                        error("Expected ')'");
                     }
-                    left = make_fcall("StringJoin", args);
+                    frames.pop_back();
+                    value = Operand{ close(std::move(value)) };
+                    step = Step::FactorDone;
+                    product = true;
+                    break;
+                case FrameKind::RationalArgs:
+                case FrameKind::ComplexArgs: {
+                    const bool rational = top.kind == FrameKind::RationalArgs;
+                    items.push_back(close(std::move(value)));
+                    if (items.size() - top.base == 1) {
+                        if (!match(TokenKind::Comma)) error(rational ? "Expected ',' in Rational" : "Expected ',' in Complex");
+                        start_expression();
+                        step = Step::Factor;
+                        break;
+                    }
+                    if (!match(TokenKind::RightBracket)) error(rational ? "Expected ']' in Rational" : "Expected ']' in Complex");
+                    frames.pop_back();
+                    std::vector<ExprPtr> args = take_items(top.base);
+                    value = Operand{ rational ? rational_literal(args, product) : complex_literal(args, product) };
+                    step = Step::FactorDone;
+                    break;
                 }
-                else {
-                    left = make_fcall(info.ast_name, { left, right });
+                default:
+                    error("Unexpected expression");
                 }
             }
-            return left;
         }
 
-        ExprPtr parse_factor() {
-            skip_whitespace();
-            ExprPtr left;
-            bool pending_negate = false;
+        // Opens the frames for the factor at the current token, or reads it whole into value.
+        // product is set if implicit multiplication may follow the factor.
+        Step start_factor(Operand& value, bool& product) {
+            const Token token = peek();
 
             // Handle lists: { ... }
-            if (match('{')) {
-                std::vector<ExprPtr> elements;
-                skip_whitespace();
-                if (!match('}')) { // Non-empty list
-                    while (true) {
-                        elements.push_back(parse_expression());
-                        skip_whitespace();
-                        if (match('}')) break;
-                        if (!match(',')) {
-                            error("Expected ',' or '}' in list");
-                        }
-                    }
+            if (match(TokenKind::LeftBrace)) {
+                if (match(TokenKind::RightBrace)) {
+                    value = Operand{ make_expr<FunctionCall>(atoms::List, std::vector<ExprPtr>{}) };
+                    product = true;
+                    return Step::FactorDone;
                 }
-                left = make_expr<FunctionCall>("List", elements);
+                frames.push_back({ FrameKind::List, items.size() });
+                start_expression();
+                return Step::Factor;
             }
             // Handle strings
-            else if (match('"')) {
-                size_t start = pos;
-                while (pos < input.size() && input[pos] != '"') {
-                    ++pos;
-                }
-                if (pos >= input.size() || input[pos] != '"') {
-                    error("Unterminated string");
-                }
-                std::string value = input.substr(start, pos - start);
-                ++pos; // Consume the closing quote
-                left = make_expr<String>(value);
+            if (token.kind == TokenKind::String) {
+                next();
+                value = Operand{ make_expr<String>(std::string(token.text)) };
+                product = true;
+                return Step::FactorDone;
+            }
+            if (token.kind == TokenKind::UnterminatedString) {
+                error("Unterminated string");
             }
             // Handle unary plus/minus
-            else if (match('+')) {
-                left = parse_factor(); // Simply parse the factor after '+'
-            }
-            else if (match('-')) {
-                skip_whitespace();
-                size_t backup = pos;
-                if ((std::isdigit(peek()) || peek() == '.')) {
-                    auto num = parse_number();
-                    skip_whitespace();
-                    if (peek() == '/') {
-                        ++pos;
-                        skip_whitespace();
-                        bool denom_negative = false;
-                        if (peek() == '-') {
-                            denom_negative = true;
-                            ++pos;
-                            skip_whitespace();
-                        }                        
-
-                        skip_whitespace();
-                        ExprPtr denom;
-                        bool denom_is_number = false;
-                        double dval = 0.0;
-
-                        if (std::isdigit(peek()) || peek() == '.') {
-                            denom = parse_number();
-                            skip_whitespace();
-                            if (auto* denom_n = std::get_if<Number>(&(*denom))) {
-                                dval = denom_n->value;
-                                denom_is_number = (std::floor(dval) == dval);
-                            }
-                        } else {
-                            denom = parse_factor();
-                            skip_whitespace();
-                        }
-
-                        // If denominator is a number, we can build a Rational
-                        if (denom_is_number) {
-                            if (auto* num_n = std::get_if<Number>(&(*num))) {
-                                double nval = num_n->value;
-                                int64_t n = -static_cast<int64_t>(nval); // unary minus on numerator
-                                int64_t d = static_cast<int64_t>(dval);
-                                if (denom_negative) d = -d;
-                                // Normalize: if both negative, make both positive
-                                if (n < 0 && d < 0) {
-                                    n = -n;
-                                    d = -d;
-                                }
-                                if (peek() == '*') {
-                                    // Explicit multiplication: -2/3*x -> Times[Rational[-2,3], x]
-                                    left = make_expr<Rational>(n, d);
-                                    return left;
-                                } else {
-                                    // Implicit multiplication or end: build Rational, but do NOT return yet!
-                                    if (n < 0 && d > 0) {
-                                        left = make_expr<Rational>(n, d); // Keep numerator negative
-                                    } else if (n > 0 && d > 0) {
-                                        left = make_expr<Rational>(n, d);
-                                    } else if (d < 0) {
-                                        left = make_expr<Rational>(-n, -d);
-                                    } else {
-                                        left = make_expr<Rational>(n, d);
-                                    }
-                                    // Do NOT return here! Let implicit multiplication loop handle the next token.
-                                }
-                            }
-                        } else {
-                            // Not a number: treat as a full factor (e.g. -2/(3x))
-                            if (auto* num_n = std::get_if<Number>(&(*num))) {
-                                double nval = num_n->value;
-                                left = make_expr<FunctionCall>("Divide", std::vector<ExprPtr>{
-                                    make_expr<Number>(-nval), denom
-                                });
-                                return left;
-                            }
-                        }
-                    }
-                    skip_whitespace();
-                    if (peek() == '*') {
-                        if (auto* num_n = std::get_if<Number>(&(*num))) {
-                            double nval = num_n->value;
-                            if (std::floor(nval) == nval) {
-                                left = make_expr<Number>(-nval);
-                                return left;
-                            }
-                        }
-                    }
-                    // Handle implicit multiplication: -2x, -2(x), etc.
-                    char next = peek();
-                    if (std::isalpha(next) || next == '(') {
-                        ExprPtr right = parse_factor();
-                        ExprPtr lhs = left ? left : make_expr<Number>(-std::get<Number>(*num).value);
-                        left = make_expr<FunctionCall>("Times", std::vector<ExprPtr>{lhs, right});
-                        return left;
-                    }
-                    // Only here, if left is not already set, set it to a negative number
-                    if (!left) {
-                        left = make_expr<Number>(-std::get<Number>(*num).value);
-                        return left;
-                    }
+            if (match(TokenKind::Plus)) {
+                frames.push_back({ FrameKind::UnaryPlus });
+                return Step::Factor;
+            }
+            if (match(TokenKind::Minus)) {
+                if (peek().kind != TokenKind::Number) {
+                    // Negate the next factor as a whole
+                    frames.push_back({ FrameKind::Negation });
+                    return Step::Factor;
                 }
-                // Fallback: Negate the next factor as a whole
-                if (!left) {
-                    ExprPtr factor = parse_factor();
-                    // If factor is a Rational, fold the minus into the numerator
-                    if (auto* rat = std::get_if<Rational>(&(*factor))) {
-                        left = make_expr<Rational>(-rat->numerator, rat->denominator);
+                const double nval = number_value(next());
+                ExprPtr left;
+                if (match(TokenKind::Divide)) {
+                    if (peek().kind != TokenKind::Number && !(peek().kind == TokenKind::Minus && peek(1).kind == TokenKind::Number)) {
+                        frames.push_back({ FrameKind::NegatedQuotient, 0, 0, Atom(), nval });
+                        return Step::Factor;
                     }
-                    else if (auto* times = std::get_if<FunctionCall>(&(*factor))) {
-                        // Handle -(Rational * x) as Times[Rational[-n, d], x]
-                        if (times->head == "Times" && !times->args.empty()) {
-                            if (auto* rat = std::get_if<Rational>(&(*times->args[0]))) {
-                                std::vector<ExprPtr> new_args = times->args;
-                                new_args[0] = make_expr<Rational>(-rat->numerator, rat->denominator);
-                                left = make_expr<FunctionCall>("Times", new_args);
-                            }
-                            else {
-                                left = make_expr<FunctionCall>("Negate", std::vector<ExprPtr>{factor});
-                            }
-                        }
-                        else {
-                            left = make_expr<FunctionCall>("Negate", std::vector<ExprPtr>{factor});
-                        }
+                    const bool denom_negative = match(TokenKind::Minus);
+                    const double dval = number_value(next());
+                    if (std::floor(dval) != dval) {
+                        value = Operand{ make_expr<FunctionCall>(atoms::Divide, std::vector<ExprPtr>{
+                            make_expr<Number>(-nval), make_expr<Number>(denom_negative ? -dval : dval)
+                        }) };
+                        product = false;
+                        return Step::FactorDone;
                     }
-                    else if (auto* sym = std::get_if<Symbol>(&(*factor))) {
-                        // -b -> Times[-1, b]
-                        left = make_expr<FunctionCall>("Times", std::vector<ExprPtr>{
-                            make_expr<Number>(-1), factor
-                        });
+                    // The denominator is an integer, so we can build a Rational
+                    int64_t n = -static_cast<int64_t>(nval); // unary minus on numerator
+                    int64_t d = static_cast<int64_t>(dval);
+                    if (denom_negative) d = -d;
+                    // Normalize: if both negative, make both positive
+                    if (n < 0 && d < 0) {
+                        n = -n;
+                        d = -d;
                     }
-                    else {
-                        left = make_expr<FunctionCall>("Negate", std::vector<ExprPtr>{factor});
+                    if (peek().kind == TokenKind::Times) {
+                        // Explicit multiplication: -2/3*x -> Times[Rational[-2,3], x]
+                        value = Operand{ make_expr<Rational>(n, d) };
+                        product = false;
+                        return Step::FactorDone;
                     }
+                    // Keep the sign in the numerator
+                    if (d < 0) {
+                        n = -n;
+                        d = -d;
+                    }
+                    left = make_expr<Rational>(n, d);
                 }
-            }
-            else if (match('(')) {
-                ++paren_depth;
-                left = parse_expression();
-                if (!match(')')) {
-                    error("Expected ')'");
+                else if (peek().kind == TokenKind::Times && std::floor(nval) == nval) {
+                    value = Operand{ make_expr<Number>(-nval) };
+                    product = false;
+                    return Step::FactorDone;
                 }
-                --paren_depth;
+                // Handle implicit multiplication: -2x, -2(x), etc.
+                const Token after = peek();
+                if ((after.kind == TokenKind::Symbol && is_letter(after.text.front())) || after.kind == TokenKind::LeftParen) {
+                    frames.push_back({ FrameKind::NegatedProduct, items.size() });
+                    items.push_back(left ? left : make_expr<Number>(-nval));
+                    return Step::Factor;
+                }
+                // A rational is still open to implicit multiplication; a negative number is not
+                value = Operand{ left ? left : make_expr<Number>(-nval) };
+                product = left != nullptr;
+                return Step::FactorDone;
+            }
+            if (match(TokenKind::LeftParen)) {
+                frames.push_back({ FrameKind::Paren });
+                start_expression();
+                return Step::Factor;
             }
             // Handle numbers and rationals in infix form
-            else if (std::isdigit(peek()) || peek() == '.') {
-                size_t backup = pos;
-                left = parse_number();
-                skip_whitespace();
-                if (peek() == '/') {
-                    ++pos; // consume '/'
-                    skip_whitespace();
-                    bool denom_negative = false;
-                    if (peek() == '-') {
-                        denom_negative = true;
-                        ++pos;
-                        skip_whitespace();
-                    }
-                    auto right = parse_number();
-                    if (auto* left_num = std::get_if<Number>(&(*left))) {
-                        double left_val = left_num->value;
-                        if (std::floor(left_val) == left_val) {
-                            if (auto* right_num = std::get_if<Number>(&(*right))) {
-                                double right_val = right_num->value;
-                                if (std::floor(right_val) == right_val) {
-                                    int64_t n = static_cast<int64_t>(left_val);
-                                    int64_t d = static_cast<int64_t>(right_val);
-                                    if (denom_negative) d = -d;
-                                    if (d == 0) {
-                                        if (n == 0) return make_expr<Indeterminate>();
-                                        return make_expr<Infinity>();
-                                    }
-                                    left = make_expr<Rational>(n, d);
-                                    // Do not parse more as denominator! Let implicit multiplication handle next token.
-                                }
-                            }
-                        }
-                    }
-                    // If not integer/integer, fallback to Divide node
-                    else {
-                        pos = backup;
-                        auto left_expr = parse_number();
-                        skip_whitespace();
-                        if (peek() == '/') {
-                            ++pos;
-                            auto right_expr = parse_factor();
-                            left = make_fcall("Divide", { left_expr, right_expr });
+            if (token.kind == TokenKind::Number) {
+                ExprPtr left = parse_number();
+                product = true;
+                // n/d and n/-d with integer literals are Rationals; any other quotient is left
+                // to the Divide operator
+                const bool denom_negative = peek(1).kind == TokenKind::Minus;
+                const Token denom = peek(denom_negative ? 2 : 1);
+                if (peek().kind == TokenKind::Divide && denom.kind == TokenKind::Number) {
+                    double left_val = std::get<Number>(*left).value;
+                    double right_val = number_value(denom);
+                    if (std::floor(left_val) == left_val && std::floor(right_val) == right_val) {
+                        index += denom_negative ? 3 : 2;
+                        int64_t n = static_cast<int64_t>(left_val);
+                        int64_t d = static_cast<int64_t>(right_val);
+                        if (denom_negative) d = -d;
+                        if (d == 0) {
+                            value = Operand{ n == 0 ? make_expr<Indeterminate>() : make_expr<Infinity>() };
+                            product = false;
+                            return Step::FactorDone;
                         }
+                        // Do not parse more as denominator! Let implicit multiplication handle next token.
+                        left = make_expr<Rational>(n, d);
                     }
                 }
+                value = Operand{ left };
+                return Step::FactorDone;
             }
             // Handle symbols (variables) or function calls
-            else if (is_letter(peek())) {
-                size_t id_start = pos;
-                std::string name = parse_identifier();
-                skip_whitespace();
-                if (name == "Rational" && match('[')) {
-                    auto num_expr = parse_expression();
-                    skip_whitespace();
-                    if (!match(',')) error("Expected ',' in Rational");
-                    auto den_expr = parse_expression();
-                    skip_whitespace();
-                    if (!match(']')) error("Expected ']' in Rational");
-                    // Only allow integer literals
-                    auto extract_int = [](const ExprPtr& expr, int64_t& out) -> bool {
-                        if (auto* num = std::get_if<Number>(&(*expr))) {
-                            double val = num->value;
-                            if (std::floor(val) == val) {
-                                out = static_cast<int64_t>(val);
-                                return true;
-                            }
-                        }
-                        if (auto* neg = std::get_if<FunctionCall>(&(*expr))) {
-                            if (neg->head == "Negate" && neg->args.size() == 1) {
-                                if (auto* num = std::get_if<Number>(&(*neg->args[0]))) {
-                                    double val = num->value;
-                                    if (std::floor(val) == val) {
-                                        out = -static_cast<int64_t>(val);
-                                        return true;
-                                    }
-                                }
-                            }
-                        }
-                        return false;
-                        };
-
-                    int64_t n, d;
-                    if (extract_int(num_expr, n) && extract_int(den_expr, d)) {
-                        if (d == 0) {
-                            if (n == 0) return make_expr<Indeterminate>();
-                            return make_expr<Infinity>();
-                        }
-                        return make_expr<Rational>(n, d);
-                    }
-                    std::vector<ExprPtr> args = { num_expr, den_expr };
-                    left = make_expr<FunctionCall>("Rational", args);
-                }
-                else if (name == "Complex" && match('[')) {
-                    auto re_expr = parse_expression();
-                    skip_whitespace();
-                    if (!match(',')) error("Expected ',' in Complex");
-                    auto im_expr = parse_expression();
-                    skip_whitespace();
-                    if (!match(']')) error("Expected ']' in Complex");
-                    // Only allow number literals for now
-                    auto extract_num = [](const ExprPtr& expr, double& out) -> bool {
-                        if (auto* num = std::get_if<Number>(&(*expr))) {
-                            out = num->value;
-                            return true;
-                        }
-                        return false;
-                    };
-                    double re = 0, im = 0;
-                    if (extract_num(re_expr, re) && extract_num(im_expr, im)) {
-                        return make_expr<Complex>(re, im);
-                    }
-                    std::vector<ExprPtr> args = { re_expr, im_expr };
-                    return make_expr<FunctionCall>("Complex", args);
-                }
-                else {
-                    pos = id_start;
-                    left = parse_symbol();
+            if (token.kind == TokenKind::Symbol && is_letter(token.text.front())) {
+                if ((token.text == "Rational" || token.text == "Complex") && peek(1).kind == TokenKind::LeftBracket) {
+                    index += 2;
+                    frames.push_back({ token.text == "Rational" ? FrameKind::RationalArgs : FrameKind::ComplexArgs, items.size() });
+                    start_expression();
+                    return Step::Factor;
                 }
+                return start_symbol(value, product);
             }
-            else {
-                error("Expected a number, symbol, or '('");
-            }
-
-            // --- Implicit multiplication loop ---
-            while (true) {
-                skip_whitespace();
-                uint32_t next = peek();
-                // If next token is '(', a digit, or a letter, treat as implicit multiplication
-                if (next == '(' || is_digit(next) || is_letter(next)) {
-                    ExprPtr right = parse_factor();
-                    left = make_expr<FunctionCall>("Times", std::vector<ExprPtr>{left, right});
-                }
-                else {
-                    break;
-                }
+            // Anonymous pattern: _, __ or ___, with an optional head as in _Integer
+            if (token.kind == TokenKind::Symbol) {
+                value = Operand{ make_expr<Symbol>(parse_blank()) };
+                product = true;
+                return Step::FactorDone;
             }
-
-            if (pending_negate) {
-                left = make_expr<FunctionCall>("Negate", std::vector<ExprPtr>{left});
+            if (token.kind == TokenKind::InvalidUtf8) {
+                error("Invalid UTF-8 in symbol");
             }
-            return left;
+            error("Expected a number, symbol, or '('");
         }
 
-        ExprPtr parse_if() {
-            skip_whitespace();
-            if (!match_string("If[")) {
-                error("Expected 'If['");
+        // A symbol, literal or function call at the current token
+        Step start_symbol(Operand& value, bool& product) {
+            if (peek().kind == TokenKind::InvalidUtf8) {
+                error("Invalid UTF-8 in symbol");
             }
-
-            // Parse the condition
-            auto condition = parse_expression();
-            skip_whitespace();
-            if (!match(',')) {
-                error("Expected ',' after condition in If");
+            if (peek().kind != TokenKind::Symbol) {
+                error("Expected symbol");
             }
+            const std::string_view name = next().text;
+            product = true;
 
-            // Parse the true branch
-            auto true_branch = parse_expression();
-            skip_whitespace();
-            if (!match(',')) {
-                error("Expected ',' after true branch in If");
+            // Handle Boolean literals
+            if (name == "True") {
+                value = Operand{ make_expr<Boolean>(true) };
             }
-
-            // Parse the false branch
-            auto false_branch = parse_expression();
-            skip_whitespace();
-            if (!match(']')) {
-                error("Expected ']' at the end of If");
+            else if (name == "False") {
+                value = Operand{ make_expr<Boolean>(false) };
             }
-
-            // Return the parsed If expression as a FunctionCall
-            return make_expr<FunctionCall>("If", std::vector<ExprPtr>{condition, true_branch, false_branch});
+            // Handle imaginary unit
+            else if (name == "I") {
+                value = Operand{ make_expr<Complex>(0.0, 1.0) };
+            }
+            else if (match(TokenKind::LeftBracket)) {
+                // It's a function call
+                if (match(TokenKind::RightBracket)) { // Handle empty argument list
+                    value = Operand{ make_expr<FunctionCall>(Atom(name), std::vector<ExprPtr>{}) };
+                    return Step::FactorDone;
+                }
+                frames.push_back({ FrameKind::Call, items.size(), 0, Atom(name) });
+                start_argument();
+                return Step::Factor;
+            }
+            else {
+                // Otherwise, it's a plain symbol (variable)
+                value = Operand{ make_expr<Symbol>(name) };
+            }
+            return Step::FactorDone;
         }
 
-        ExprPtr parse_symbol() {
-            skip_whitespace();
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            std::string name;
+        void start_expression() {
+            frames.push_back({ FrameKind::Expression, operands.size(), operators.size() });
+        }
 
-            if (it == end) {
-                error("Expected symbol");
+        void start_argument() {
+            // Handle unary minus
+            if (peek().kind == TokenKind::Minus && adjacent()) {
+                next();
+                frames.push_back({ FrameKind::NegatedArgument });
             }
-            uint32_t cp = utf8::peek_next(it, end);
+            start_expression();
+        }
 
-            // Allow anonymous pattern symbol '_'
-            if (cp == '_') {
-                cp = utf8::next(it, end);
-                utf8::append(cp, std::back_inserter(name));
-                pos = std::distance(input.begin(), it);
-            } else {
-                // Otherwise, must be a valid identifier start (not '_')
-                if (!is_identifier_start(cp) || cp == '_') {
-                    error("Expected symbol");
-                }
-                cp = utf8::next(it, end);
-                utf8::append(cp, std::back_inserter(name));
+        // Applies the operator on top of the stack to the last two operands
+        void reduce() {
+            const OperatorInfo info = operators.back();
+            operators.pop_back();
+            Operand right = std::move(operands.back());
+            operands.pop_back();
+            Operand& left = operands.back();
 
-                // Subsequent characters: allow '_' in symbol names
-                while (it != end) {
-                    cp = utf8::peek_next(it, end);
-                    if (!is_symbol_body_char(cp)) break;
-                    cp = utf8::next(it, end);
-                    utf8::append(cp, std::back_inserter(name));
+            if (info.head == atoms::Plus || info.head == atoms::Times) {
+                if (left.chain != info.head) {
+                    std::vector<ExprPtr> args;
+                    append(args, std::move(left), info.head);
+                    left = Operand{ nullptr, info.head, std::move(args) };
                 }
-                pos = std::distance(input.begin(), it);
-            }
-
-            // Handle Boolean literals
-            if (name == "True") {
-                return make_expr<Boolean>(true);
+                append(left.args, std::move(right), info.head);
             }
-            if (name == "False") {
-                return make_expr<Boolean>(false);
+            else if (info.head == atoms::Rule) {
+                left = Operand{ make_expr<Rule>(close(std::move(left)), close(std::move(right))) };
             }
-            // Handle imaginary unit
-            if (name == "I") {
-                return make_expr<Complex>(0.0, 1.0);
-            }
-
-            skip_whitespace();
-            if (match('[')) {
-                // It's a function call
+            else if (info.head == atoms::StringJoin) {
+                // Flatten StringJoin on either side
                 std::vector<ExprPtr> args;
-                if (!match(']')) { // Handle empty argument list
-                    while (true) {
-                        // Handle unary minus
-                        if (match('-')) {
-                            args.push_back(make_expr<FunctionCall>("Negate", std::vector<ExprPtr>{parse_expression()}));
-                        }
-                        else {
-                            args.push_back(parse_expression());
-                        }
-                        skip_whitespace();
-                        if (match(']')) {
-                            break;
-                        }
-                        if (!match(',')) {
-                            error("Expected ',' or ']' in function call");
-                        }
+                for (ExprPtr side : { close(std::move(left)), close(std::move(right)) }) {
+                    if (auto* call = std::get_if<FunctionCall>(&(*side)); call && call->head == atoms::StringJoin) {
+                        args.insert(args.end(), call->args.begin(), call->args.end());
+                    }
+                    else {
+                        args.push_back(side);
                     }
                 }
-                return make_expr<FunctionCall>(name, args);
+                left = Operand{ make_fcall(atoms::StringJoin, args) };
             }
+            else {
+                left = Operand{ make_fcall(info.head, { close(std::move(left)), close(std::move(right)) }) };
+            }
+        }
 
-            // Otherwise, it's a plain symbol (variable)
-            return make_expr<Symbol>(name);
+        // The node an operand stands for
+        static ExprPtr close(Operand&& operand) {
+            if (operand.chain.empty()) return std::move(operand.expr);
+            return make_expr<FunctionCall>(operand.chain, std::move(operand.args));
         }
 
-        // --- Operator helpers ---
-        OperatorInfo get_operator_info(const std::string& op) {
-            for (const auto& pair : infix_operators) {
-                if (op == pair.first) return pair.second;
+        // Adds operand to the arguments of a `head` node, splicing in an open chain of the same head
+        static void append(std::vector<ExprPtr>& args, Operand&& operand, Atom head) {
+            if (operand.chain == head) {
+                args.insert(args.end(), std::make_move_iterator(operand.args.begin()), std::make_move_iterator(operand.args.end()));
             }
-            return { -1, Assoc::Left, "" }; // Not found
+            else {
+                args.push_back(close(std::move(operand)));
+            }
+        }
+
+        std::vector<ExprPtr> take_items(size_t base) {
+            std::vector<ExprPtr> taken(std::make_move_iterator(items.begin() + base), std::make_move_iterator(items.end()));
+            items.resize(base);
+            return taken;
         }
 
-        std::string peek_operator() {
-            skip_whitespace();
-            // Try to match the longest operator first
-            size_t max_len = 0;
-            std::string matched_op;
-            for (const auto& pair : infix_operators) {
-                const std::string& op = pair.first;
-                if (input.substr(pos, op.size()) == op && op.size() > max_len) {
-                    matched_op = op;
-                    max_len = op.size();
+        // -factor
+        static ExprPtr negation(const ExprPtr& factor) {
+            // If factor is a Rational, fold the minus into the numerator
+            if (auto* rat = std::get_if<Rational>(&(*factor))) {
+                return make_expr<Rational>(-rat->numerator, rat->denominator);
+            }
+            // Handle -(Rational * x) as Times[Rational[-n, d], x]
+            if (auto* times = std::get_if<FunctionCall>(&(*factor))) {
+                if (times->head == atoms::Times && !times->args.empty()) {
+                    if (auto* rat = std::get_if<Rational>(&(*times->args[0]))) {
+                        std::vector<ExprPtr> new_args = times->args;
+                        new_args[0] = make_expr<Rational>(-rat->numerator, rat->denominator);
+                        return make_expr<FunctionCall>(atoms::Times, std::move(new_args));
+                    }
                 }
+                return make_expr<FunctionCall>(atoms::Negate, std::vector<ExprPtr>{ factor });
             }
-            return matched_op;
+            // -b -> Times[-1, b]
+            if (std::holds_alternative<Symbol>(*factor)) {
+                return make_expr<FunctionCall>(atoms::Times, std::vector<ExprPtr>{ make_expr<Number>(-1), factor });
+            }
+            return make_expr<FunctionCall>(atoms::Negate, std::vector<ExprPtr>{ factor });
         }
 
-        ExprPtr parse_number() {
-            skip_whitespace();
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            auto start_it = it;
+        // Rational[n, d] with integer literals, or the call itself; product is set unless it is a literal
+        static ExprPtr rational_literal(std::vector<ExprPtr>& args, bool& product) {
+            // Only allow integer literals
+            auto extract_int = [](const ExprPtr& expr, int64_t& out) -> bool {
+                if (auto* num = std::get_if<Number>(&(*expr))) {
+                    double val = num->value;
+                    if (std::floor(val) == val) {
+                        out = static_cast<int64_t>(val);
+                        return true;
+                    }
+                }
+                if (auto* neg = std::get_if<FunctionCall>(&(*expr))) {
+                    if (neg->head == atoms::Negate && neg->args.size() == 1) {
+                        if (auto* num = std::get_if<Number>(&(*neg->args[0]))) {
+                            double val = num->value;
+                            if (std::floor(val) == val) {
+                                out = -static_cast<int64_t>(val);
+                                return true;
+                            }
+                        }
+                    }
+                }
+                return false;
+            };
 
-            while (it != end) {
-                uint32_t cp = utf8::peek_next(it, end);
-                if (!is_digit(cp) && cp != '.') break;
-                utf8::next(it, end);
+            int64_t n, d;
+            product = !(extract_int(args[0], n) && extract_int(args[1], d));
+            if (product) return make_expr<FunctionCall>(atoms::Rational, std::move(args));
+            if (d == 0) {
+                if (n == 0) return make_expr<Indeterminate>();
+                return make_expr<Infinity>();
             }
+            return make_expr<Rational>(n, d);
+        }
 
-            if (start_it == it) {
-                error("Expected number");
+        // Complex[re, im] with number literals, or the call itself
+        static ExprPtr complex_literal(std::vector<ExprPtr>& args, bool& product) {
+            product = false;
+            // Only allow number literals for now
+            auto* re = std::get_if<Number>(&(*args[0]));
+            auto* im = std::get_if<Number>(&(*args[1]));
+            if (re && im) {
+                return make_expr<Complex>(re->value, im->value);
             }
-
-            std::string num_str(start_it, it);
-            pos = std::distance(input.begin(), it);
-
-            double value = std::stod(num_str);
-            return make_expr<Number>(value);
+            return make_expr<FunctionCall>(atoms::Complex, std::move(args));
         }
 
-        std::string parse_identifier() {
-            // Use iterators for UTF-8 safety
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            std::string result;
+        ExprPtr parse_if() {
+            if (!(peek().kind == TokenKind::Symbol && peek().text == "If" && peek(1).kind == TokenKind::LeftBracket)) {
+                error("Expected 'If['");
+            }
+            index += 2;
 
-            // Skip whitespace using iterators
-            while (it != end) {
-                uint32_t cp = utf8::peek_next(it, end);
-                if (!is_ascii_whitespace(cp)) break;
-                utf8::next(it, end);
+            // Parse the condition
+            auto condition = parse_expression();
+            if (!match(TokenKind::Comma)) {
+                error("Expected ',' after condition in If");
             }
 
-            if (it == end) error("Expected identifier");
-            uint32_t cp = utf8::peek_next(it, end);
+            // Parse the true branch
+            auto true_branch = parse_expression();
+            if (!match(TokenKind::Comma)) {
+                error("Expected ',' after true branch in If");
+            }
 
-            // Anonymous pattern: just '_'
-            if (cp == '_') {
-                cp = utf8::next(it, end);
-                utf8::append(cp, std::back_inserter(result));
-                pos = std::distance(input.begin(), it);
-                return result;
+            // Parse the false branch
+            auto false_branch = parse_expression();
+            if (!match(TokenKind::RightBracket)) {
+                error("Expected ']' at the end of If");
             }
 
-            // Otherwise, must be a valid identifier start (not '_')
-            if (!is_identifier_start(cp) || cp == '_') {
-                error("Expected identifier");
+            // Return the parsed If expression as a FunctionCall
+            return make_expr<FunctionCall>(atoms::If, std::vector<ExprPtr>{condition, true_branch, false_branch});
+        }
+
+        ExprPtr parse_number() {
+            if (peek().kind != TokenKind::Number) {
+                error("Expected number");
             }
-            cp = utf8::next(it, end);
-            utf8::append(cp, std::back_inserter(result));
+            const double value = number_value(peek());
+            next();
+            return make_expr<Number>(value);
+        }
 
-            // Subsequent characters: identifier body (no '_')
-            while (it != end) {
-                cp = utf8::peek_next(it, end);
-                if (!is_identifier_body_char(cp)) break;
-                cp = utf8::next(it, end);
-                utf8::append(cp, std::back_inserter(result));
+        // The value of a Number token; digits after a second '.' are ignored
+        double number_value(const Token& token) const {
+            double value = 0.0;
+            const auto [end, status] = std::from_chars(token.text.data(), token.text.data() + token.text.size(), value);
+            if (status != std::errc()) {
+                error(status == std::errc::result_out_of_range ? "Number out of range" : "Expected number");
             }
+            return value;
+        }
 
-            pos = std::distance(input.begin(), it);
-            return result;
+        // The identifier a symbol starts with (see identifier_length). The rest of the symbol,
+        // such as the '_' of a parameter x_, is left as the current token.
+        std::string_view parse_identifier() {
+            if (peek().kind != TokenKind::Symbol) {
+                error("Expected identifier");
+            }
+            Token& token = tokens[index];
+            const std::string_view identifier = token.text.substr(0, identifier_length(token.text));
+            if (identifier.size() == token.text.size()) ++index;
+            else token.text.remove_prefix(identifier.size());
+            return identifier;
         }
 
-        void skip_whitespace() {
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            while (it != end) {
-                uint32_t cp = utf8::peek_next(it, end);
-                if (!is_ascii_whitespace(cp)) break;
-                utf8::next(it, end);
+        // An anonymous pattern written as adjacent tokens: up to three '_' and a head. The
+        // result is the source text, like the single token of a named pattern such as x__h.
+        std::string_view parse_blank() {
+            const char* begin = next().text.data();
+            for (int blanks = 1; blanks < 3 && peek().kind == TokenKind::Symbol && peek().text == "_" && adjacent(); ++blanks) {
+                next();
+            }
+            if (peek().kind == TokenKind::Symbol && is_letter(peek().text.front()) &&
+                identifier_length(peek().text) == peek().text.size() && adjacent()) {
+                next();
             }
-            pos = std::distance(input.begin(), it);
+            const Token& last = tokens[index - 1];
+            return std::string_view(begin, static_cast<size_t>(last.text.data() + last.text.size() - begin));
         }
 
-        bool match(char expected) {
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            if (it == end) return false;
-            uint32_t cp = utf8::peek_next(it, end);
-            if (cp == static_cast<unsigned char>(expected)) {
-                utf8::next(it, end);
-                pos = std::distance(input.begin(), it);
-                return true;
-            }
-            return false;
+        static bool starts_product(const Token& token) {
+            switch (token.kind) {
+            case TokenKind::LeftParen: return true;
+            case TokenKind::Number: return is_digit(token.text.front());
+            case TokenKind::Symbol:
+            case TokenKind::InvalidUtf8: return is_letter(token.text.front());
+            default: return false;
+            }
         }
 
-        bool match_string(const std::string& s) {
-            skip_whitespace();
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            auto sit = s.begin();
-            auto send = s.end();
-
-            auto temp_it = it;
-            while (sit != send && temp_it != end) {
-                uint32_t cp_input = utf8::peek_next(temp_it, end);
-                uint32_t cp_s = utf8::peek_next(sit, send);
-                if (cp_input != cp_s) return false;
-                utf8::next(temp_it, end);
-                utf8::next(sit, send);
-            }
-            if (sit == send) {
-                pos = std::distance(input.begin(), temp_it);
-                return true;
-            }
-            return false;
+        // --- Token helpers ---
+        const Token& at(size_t i) const { return tokens[std::min(i, tokens.size() - 1)]; }
+
+        const Token& peek(size_t ahead = 0) const { return at(index + ahead); }
+
+        Token next() {
+            const Token token = peek();
+            if (index + 1 < tokens.size()) ++index;
+            return token;
         }
 
-        uint32_t peek() const {
-            auto it = input.begin() + pos;
-            auto end = input.end();
-            if (it == end) return 0;
-            return utf8::peek_next(it, end);
+        // True if nothing separates the current token from the previous one
+        bool adjacent() const {
+            const Token& previous = tokens[index - 1];
+            return previous.text.data() + previous.text.size() == peek().text.data();
         }
 
-        std::string peek_string(size_t length) {
-            // Ensure we don't go out of bounds
-            if (pos + length > input.size()) {
-                return ""; // Return an empty string if the requested length exceeds input
-            }
-            return input.substr(pos, length);
+        bool match(TokenKind kind) {
+            if (peek().kind != kind) return false;
+            next();
+            return true;
         }
 
         [[noreturn]] void error(const std::string& message) const {
+            const size_t pos = static_cast<size_t>(peek().text.data() - input.data());
             std::string pointer_line(input.size(), ' ');
             if (pos < pointer_line.size()) pointer_line[pos] = '^'; // mark where error is
 
             throw std::runtime_error(
-                message + "\n" + input + "\n" + pointer_line
+                message + "\n" + std::string(input) + "\n" + pointer_line
             );
         }
     };
 
+
     inline ExprPtr try_make_complex(const ExprPtr& expr) {
         // Recognize Plus(a, Times(b, I)) and similar forms
         if (auto* call = std::get_if<FunctionCall>(&(*expr))) {
             // Handle a + b*I and a - b*I
-            if (call->head == "Plus" && call->args.size() == 2) {
+            if (call->head == atoms::Plus && call->args.size() == 2) {
                 double real = 0, imag = 0;
                 bool real_ok = false, imag_ok = false;
 
@@ -819,7 +866,7 @@ namespace aleph3 {
                 }
                 // Right as imaginary
                 if (auto* times = std::get_if<FunctionCall>(call->args[1].get())) {
-                    if (times->head == "Times" && times->args.size() == 2) {
+                    if (times->head == atoms::Times && times->args.size() == 2) {
                         // b*I
                         if (auto* n = std::get_if<Number>(times->args[0].get())) {
                             if (auto* i = std::get_if<Complex>(times->args[1].get())) {
@@ -850,7 +897,7 @@ namespace aleph3 {
                 // Left as imaginary
                 if (!imag_ok) {
                     if (auto* times = std::get_if<FunctionCall>(call->args[0].get())) {
-                        if (times->head == "Times" && times->args.size() == 2) {
+                        if (times->head == atoms::Times && times->args.size() == 2) {
                             // b*I
                             if (auto* n = std::get_if<Number>(times->args[0].get())) {
                                 if (auto* i = std::get_if<Complex>(times->args[1].get())) {
@@ -877,7 +924,7 @@ namespace aleph3 {
                 }
             }
             // Handle pure imaginary: Times(Number, I) or Times(I, Number)
-            if (call->head == "Times" && call->args.size() == 2) {
+            if (call->head == atoms::Times && call->args.size() == 2) {
                 if (auto* n = std::get_if<Number>(call->args[0].get())) {
                     if (auto* i = std::get_if<Complex>(call->args[1].get())) {
                         if (i->real == 0.0 && i->imag == 1.0) {
@@ -904,7 +951,7 @@ namespace aleph3 {
     }
 
     // Helper function to simplify usage
-    inline ExprPtr parse_expression(const std::string& input) {
+    inline ExprPtr parse_expression(std::string_view input) {
         Parser parser(input);
         auto expr = parser.parse();
         return try_make_complex(expr);
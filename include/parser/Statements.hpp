@@ -0,0 +1,140 @@
+/*
+ * Statements.hpp
+ * --------------
+ * Splits a script into its top-level statements without parsing them.
+ *
+ * A statement ends at a ';' or at a line break outside brackets, unless the line ends with
+ * something that needs more input (an infix operator, '=', ':=', ':' or ','), so
+ *   f[x_] := x +
+ *            1
+ * is one statement. A statement ended by ';' is silent: its value is not printed.
+ * Strings and comments are read by the Lexer, so brackets and ';' inside them do not count.
+ *
+ * Statements parse independently of each other, so parse_statements() parses a batch of
+ * them on the ThreadPool; the caller still evaluates them one at a time in source order.
+ */
+#pragma once
+
+#include "parser/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "util/ThreadPool.hpp"
+
+#include <exception>
+#include <string_view>
+#include <vector>
+
+namespace aleph3 {
+
+    struct Statement {
+        std::string_view text;  // Without the ';'
+        size_t line;            // 1-based line of the first token
+        bool silent;            // Ended by ';'
+    };
+
+    // A statement's expression, or the exception its parse threw
+    struct ParsedStatement {
+        ExprPtr expr;
+        std::exception_ptr error;
+    };
+
+    // Statements per chunk of a parallel parse; batches of at most one chunk parse serially
+    inline constexpr size_t PARSE_GRAIN = 64;
+
+    namespace statements_detail {
+        // True if a statement cannot end after a token of this kind
+        inline bool continues(TokenKind kind) {
+            switch (kind) {
+            case TokenKind::Set:
+            case TokenKind::SetDelayed:
+            case TokenKind::Colon:
+            case TokenKind::Comma:
+                return true;
+            default:
+                return infix_operator(kind).precedence > 0;
+            }
+        }
+    }
+
+    inline std::vector<Statement> split_statements(std::string_view source) {
+        std::vector<Statement> statements;
+        Lexer lexer(source);
+        size_t start = std::string_view::npos;  // Offset of the open statement's first token
+        size_t start_line = 0, line = 1, scanned = 0;
+        size_t end = 0;                         // End of the previous token
+        TokenKind previous = TokenKind::End;
+        int depth = 0;
+
+        // Lines up to offset, counted incrementally
+        auto line_at = [&](size_t offset) {
+            for (; scanned < offset; ++scanned) line += source[scanned] == '\n';
+            return line;
+        };
+        auto close = [&](size_t stop, bool silent) {
+            statements.push_back({ source.substr(start, stop - start), start_line, silent });
+            start = std::string_view::npos;
+            depth = 0;
+        };
+
+        while (true) {
+            const Token token = lexer.next();
+            if (token.kind == TokenKind::End) break;
+            // String tokens leave out their quotes
+            const bool quoted = token.kind == TokenKind::String || token.kind == TokenKind::UnterminatedString;
+            const size_t offset = static_cast<size_t>(token.text.data() - source.data()) - (quoted ? 1 : 0);
+
+            if (start != std::string_view::npos && depth == 0 && !statements_detail::continues(previous) &&
+                source.substr(end, offset - end).find('\n') != std::string_view::npos) {
+                close(end, false);
+            }
+            if (token.kind == TokenKind::Semicolon) {
+                if (start != std::string_view::npos && depth == 0) close(offset, true);
+            }
+            else if (start == std::string_view::npos) {
+                start = offset;
+                start_line = line_at(offset);
+            }
+
+            switch (token.kind) {
+            case TokenKind::LeftParen:
+            case TokenKind::LeftBracket:
+            case TokenKind::LeftBrace:
+                ++depth;
+                break;
+            case TokenKind::RightParen:
+            case TokenKind::RightBracket:
+            case TokenKind::RightBrace:
+                if (depth > 0) --depth;
+                break;
+            default:
+                break;
+            }
+            previous = token.kind;
+            end = static_cast<size_t>(token.text.data() - source.data()) + token.text.size() +
+                  (token.kind == TokenKind::String ? 1 : 0);
+        }
+        if (start != std::string_view::npos) close(end, false);
+        return statements;
+    }
+
+    // Parses statements [begin, end), on all cores of the ThreadPool when there are more
+    // than PARSE_GRAIN of them. Parse errors are kept with their statement, not thrown.
+    inline std::vector<ParsedStatement> parse_statements(const std::vector<Statement>& statements,
+                                                         size_t begin, size_t end) {
+        std::vector<ParsedStatement> parsed(end - begin);
+        auto parse = [&](size_t, size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                try {
+                    parsed[i].expr = parse_expression(statements[begin + i].text);
+                }
+                catch (...) {
+                    parsed[i].error = std::current_exception();
+                }
+            }
+        };
+        if (parsed.size() > PARSE_GRAIN) ThreadPool::instance().parallel_for(parsed.size(), PARSE_GRAIN, parse);
+        else parse(0, 0, parsed.size());
+        return parsed;
+    }
+
+} // namespace aleph3
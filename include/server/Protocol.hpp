@@ -0,0 +1,66 @@
+/*
+ * Protocol.hpp
+ * ------------
+ * Wire format of the aleph3 server: JSON lines, one request object per line in and one
+ * response object per line out.
+ *
+ *   {"id": 7, "session": "alice", "input": "x = 2; x^2 + 1", "timeout_ms": 500}
+ *   {"id": 7, "session": "alice", "ok": true, "results": ["5"]}
+ *
+ *   {"id": 8, "session": "alice", "input": "1 +"}
+ *   {"id": 8, "session": "alice", "ok": false, "results": [], "code": "error", "line": 1,
+ *    "error": "..."}
+ *
+ * `input` holds statements as in a batch script (see Statements.hpp). `results` holds what
+ * each non-silent statement printed. `id` may be any JSON value and is echoed back as is;
+ * responses to different sessions can arrive out of order. `op` is "eval" (the default),
+ * "close", which discards the session's bindings, or "cancel", which is answered at once and
+ * stops the session's requests that arrived before it, running or queued. `session` defaults to "default".
+ * Members that are not recognized are ignored.
+ *
+ * Error codes: "error" (a parse or evaluation error), "timeout", "cancelled", "busy" (too
+ * many sessions) and "bad_request" (the line is not a valid request).
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aleph3 {
+
+    struct ProtocolError : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Request {
+        std::string id = "null";  // JSON text of the id member
+        std::string session = "default";
+        std::string op = "eval";
+        std::string input;
+        std::optional<int64_t> timeout_ms;
+    };
+
+    struct Response {
+        std::string id = "null";
+        std::string session;
+        bool ok = true;
+        std::vector<std::string> results;
+        std::string code;   // Set when !ok
+        std::string error;
+        size_t line = 0;    // Line of the failing statement, 0 if none
+    };
+
+    // Throws ProtocolError if `line` is not a JSON object with members of the right types
+    Request parse_request(std::string_view line);
+
+    // One line of JSON, without the newline
+    std::string format_response(const Response& response);
+
+    // s as a JSON string literal
+    std::string json_quote(std::string_view s);
+
+} // namespace aleph3
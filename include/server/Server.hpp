@@ -0,0 +1,111 @@
+/*
+ * Server.hpp
+ * ----------
+ * Long-lived aleph3 process that evaluates requests for many clients (`aleph3 --serve`).
+ * The wire format is in Protocol.hpp.
+ *
+ * Each session name owns its own EvaluationContext and symbol attributes, created by the
+ * first request that names it and discarded by "close". Requests of one session run one at
+ * a time, in the order they arrived. Requests of different sessions run concurrently on the
+ * server's workers, which take ready sessions round-robin, one request at a time, so one
+ * busy session cannot starve the others.
+ *
+ * Backpressure: at most max_pending requests may be queued or running over all
+ * connections. A connection that would go past the limit stops reading until a request
+ * finishes, so the client's writes block instead of growing the server's queues.
+ *
+ * Each request runs under a budget (BudgetScope, see Budget.hpp): a time limit of its own
+ * timeout_ms, capped at max_timeout, or default_timeout if it gives none, an optional step
+ * limit, and a cancel token that a later "cancel" request for its session triggers. A statement
+ * that runs out of time fails with code "timeout", one that is cancelled with "cancelled",
+ * and the statements after it in the request are skipped. Bindings the request made
+ * before that are kept.
+ *
+ * The built-in functions must be registered before the server starts.
+ */
+#pragma once
+
+#include "server/Protocol.hpp"
+#include "evaluator/Budget.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace aleph3 {
+
+    struct ServerOptions {
+        size_t workers = 0;             // 0: one per hardware thread
+        size_t max_pending = 256;       // Requests queued or running before readers wait
+        size_t max_sessions = 1024;     // Further new sessions are refused with "busy"
+        size_t max_request_bytes = size_t(1) << 20;
+        std::chrono::milliseconds default_timeout{ 10000 };  // 0: no limit
+        std::chrono::milliseconds max_timeout{ 60000 };      // 0: no cap
+        uint64_t max_steps = 0;         // evaluate() calls per request; 0: no limit
+    };
+
+    class Server {
+    public:
+        explicit Server(ServerOptions options = {});
+        // Finishes the requests already queued, then stops the workers
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Serves one connection: reads requests from `in` until it ends and writes one
+        // response per request to `out`. Returns once every response has been written.
+        void serve(std::istream& in, std::ostream& out);
+
+        // Accepts connections on `address` until stop(), serving each connection on its own
+        // thread. The address is "unix:PATH" or "tcp:[HOST:]PORT" (HOST defaults to
+        // 127.0.0.1; port 0 picks a free port, see port()). Throws std::runtime_error if
+        // the address cannot be bound.
+        void listen(const std::string& address);
+
+        // Makes listen() close its connections and return; safe to call from a signal handler
+        void stop() { stop_requested.store(true); }
+
+        // Bound TCP port once listen() is accepting, 0 before
+        int port() const { return bound_port.load(); }
+
+        size_t session_count();
+
+    private:
+        struct Session;
+        struct Connection;
+        struct Task;
+
+        ServerOptions options;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;                  // Guards the fields below
+        std::condition_variable work;      // A session became ready, or stopping
+        std::condition_variable space;     // pending dropped below max_pending
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+        std::deque<std::shared_ptr<Session>> ready;
+        size_t pending = 0;
+        bool stopping = false;
+
+        std::atomic<bool> stop_requested{ false };
+        std::atomic<int> bound_port{ 0 };
+
+        // Parses `line` and queues it, waiting for room; protocol errors are answered at once
+        void submit(std::string_view line, const std::shared_ptr<Connection>& connection);
+        void worker_loop();
+        Response execute(Session& session, const Request& request, const CancelToken& cancel);
+        void serve_socket(int fd);
+    };
+
+} // namespace aleph3
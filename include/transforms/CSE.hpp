@@ -0,0 +1,34 @@
+/*
+ * CSE.hpp
+ * -------
+ * Common-subexpression elimination: CSE[expr] names each call that occurs more than once
+ * and gives the expression as a let-bound DAG,
+ *
+ *     With[{c1 -> a + b, c2 -> c1^2}, c2 + Sin[c2]]
+ *
+ * where each binding may use the earlier ones. Occurrences are found by structure, so equal
+ * subtrees are shared whether or not they are the same node, and a call is named only if
+ * it is used by two different parents (a + b inside a single shared (a + b)^2 is not). The
+ * walk visits every distinct node once, so a DAG that unfolds to an exponentially large
+ * tree is handled in linear time.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    struct CommonSubexpressions {
+        std::vector<std::pair<Atom, ExprPtr>> bindings; // In dependency order
+        ExprPtr body;
+    };
+
+    CommonSubexpressions eliminate_common_subexpressions(const ExprPtr& expr);
+
+    // With[{name -> value, ...}, body], or the body alone when nothing is shared
+    ExprPtr to_with(const CommonSubexpressions& cse);
+
+} // namespace aleph3
@@ -0,0 +1,35 @@
+/*
+ * Derivative.hpp
+ * --------------
+ * Symbolic differentiation on expression DAGs: D[expr, x], D[expr, {x, n}] and
+ * Grad[expr, {x, y, ...}].
+ *
+ * Both modes visit each distinct node of `expr` once (a node shared by several parents is
+ * the same pointer, as after hash-consing or evaluation), so the work and the size of the
+ * result are linear in the DAG and not in the tree it unfolds to. The result refers to
+ * the nodes of `expr` instead of copying them.
+ *
+ * differentiate() is forward mode: the derivative of a node is the sum over its arguments
+ * of the partial derivative times the argument's derivative, memoized per node. gradient()
+ * is reverse mode: one pass from the root accumulates the adjoint of every node, which
+ * gives the derivatives with respect to all variables at once.
+ *
+ * Partial derivatives are known for Plus, Times, Minus, Divide, Negate, Power and the
+ * elementary functions; a call to any other head that depends on x is left as D[call, x].
+ * Results are not simplified; evaluate them.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <vector>
+
+namespace aleph3 {
+
+    // d expr / dx
+    ExprPtr differentiate(const ExprPtr& expr, Atom x);
+
+    // {d expr / dv for each v in vars}, as a list
+    ExprPtr gradient(const ExprPtr& expr, const std::vector<Atom>& vars);
+
+} // namespace aleph3
@@ -0,0 +1,76 @@
+/*
+ * EGraph.hpp
+ * ----------
+ * E-graph for equality saturation (see full_simplify in Simplifier.hpp).
+ *
+ * An e-graph holds many equivalent forms of an expression at once. Each e-class is a set
+ * of e-nodes known to be equal; an e-node is a head applied to e-classes, or a leaf (any
+ * expression that is not a call). Nodes are hash-consed, so a term is stored once however
+ * often it occurs, and merge() records that two classes are equal. rebuild() restores
+ * congruence after merges: nodes whose children became equal are merged too. extract()
+ * then reads out the cheapest form of a class.
+ *
+ * Arguments keep their order: f[a, b] and f[b, a] are different nodes.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace aleph3 {
+
+    using EClassId = uint32_t;
+
+    struct ENode {
+        Atom head;                       // Calls
+        ExprPtr leaf;                    // Anything else; nullptr for a call
+        std::vector<EClassId> children;
+
+        bool operator==(const ENode& other) const;
+    };
+
+    struct ENodeHash {
+        size_t operator()(const ENode& node) const;
+    };
+
+    class EGraph {
+    public:
+        // The class of `expr`, adding the nodes it needs
+        EClassId add(const ExprPtr& expr);
+        EClassId add(ENode node);
+
+        // The canonical class of `id`
+        EClassId find(EClassId id) const;
+
+        // Records that the classes are equal; false if they already were
+        bool merge(EClassId a, EClassId b);
+
+        // Merges nodes made equal by earlier merges, until none are left
+        void rebuild();
+
+        // Nodes of the class of `id`, with canonical children after rebuild()
+        const std::vector<ENode>& nodes(EClassId id) const { return classes_[find(id)]; }
+
+        // Canonical classes
+        std::vector<EClassId> classes() const;
+
+        // A leaf of the class of `id` that is a number, rational or complex number, or nullptr
+        const ExprPtr* constant(EClassId id) const;
+
+        size_t node_count() const { return memo_.size(); }
+
+        // The form of the class of `id` with the fewest leaves and heads (LeafCount)
+        ExprPtr extract(EClassId id) const;
+
+    private:
+        mutable std::vector<EClassId> parent_;      // Union-find
+        std::vector<std::vector<ENode>> classes_;  // Nodes, for canonical ids
+        std::unordered_map<ENode, EClassId, ENodeHash> memo_;
+
+        ENode canonical(ENode node) const;
+    };
+
+} // namespace aleph3
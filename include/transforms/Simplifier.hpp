@@ -0,0 +1,39 @@
+/*
+ * Simplifier.hpp
+ * --------------
+ * Drivers over the rewrites of simplify() (Transforms.hpp).
+ *
+ * simplify_to_fixed_point() repeats simplify() until the expression stops changing or the
+ * pass budget runs out, and returns the smallest form it saw; a rewrite cycle ends it
+ * early. simplify() memoizes its result per node, so each pass only does work on the
+ * parts the previous one changed.
+ *
+ * full_simplify() runs equality saturation: the expression goes into an e-graph, algebraic
+ * identities (constant folding, x + 0, x * 1, x * 0, like terms, like powers, nested
+ * powers, inverse functions, Sin^2 + Cos^2, distributing and factoring out a common
+ * factor) add equal forms until no rule adds anything or the node budget is reached, and
+ * the form with the least LeafCount is extracted. Rules are applied in both directions,
+ * as with expanding and factoring, without any risk of looping, since no form is lost.
+ */
+#pragma once
+
+#include "expr/Expr.hpp"
+
+#include <cstddef>
+
+namespace aleph3 {
+
+    struct SimplifyOptions {
+        size_t max_passes = 64;        // simplify_to_fixed_point: passes of simplify()
+        size_t max_iterations = 16;    // full_simplify: rounds of rule application
+        size_t max_nodes = 20000;      // full_simplify: e-nodes before saturation stops
+    };
+
+    // Heads and atoms in expr, as Mathematica's LeafCount
+    size_t leaf_count(const ExprPtr& expr);
+
+    ExprPtr simplify_to_fixed_point(const ExprPtr& expr, const SimplifyOptions& options = {});
+
+    ExprPtr full_simplify(const ExprPtr& expr, const SimplifyOptions& options = {});
+
+} // namespace aleph3
@@ -1,10 +1,26 @@
 #pragma once
 #include "expr/Expr.hpp"
 
+#include <cstddef>
+
 namespace aleph3 {
 
+    // One round of local rewrites (like terms, powers of products, numeric comparisons).
+    // Results are memoized per node, so shared and repeated subtrees, and results passed in
+    // again, are simplified once.
     ExprPtr simplify(const ExprPtr& expr);
 
     ExprPtr expand(const ExprPtr& expr);
 
-}
\ No newline at end of file
+    struct SimplifyStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+    };
+
+    SimplifyStats simplify_stats();
+
+    // Drops the memoized results and resets the counts
+    void clear_simplify_memo();
+
+}
@@ -0,0 +1,39 @@
+/*
+ * Checked.hpp
+ * -----------
+ * Overflow-checked int64_t arithmetic. Each function returns true if the exact result does
+ * not fit, and otherwise stores it in `r`. GCC and Clang use their single-instruction
+ * builtins; other compilers (MSVC) get portable range checks.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace aleph3::detail {
+
+#if defined(__GNUC__) || defined(__clang__)
+    inline bool add_overflows(int64_t a, int64_t b, int64_t& r) { return __builtin_add_overflow(a, b, &r); }
+    inline bool sub_overflows(int64_t a, int64_t b, int64_t& r) { return __builtin_sub_overflow(a, b, &r); }
+    inline bool mul_overflows(int64_t a, int64_t b, int64_t& r) { return __builtin_mul_overflow(a, b, &r); }
+#else
+    inline bool add_overflows(int64_t a, int64_t b, int64_t& r) {
+        if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) return true;
+        r = a + b;
+        return false;
+    }
+    inline bool sub_overflows(int64_t a, int64_t b, int64_t& r) {
+        if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b)) return true;
+        r = a - b;
+        return false;
+    }
+    inline bool mul_overflows(int64_t a, int64_t b, int64_t& r) {
+        if (a == 0 || b == 0) { r = 0; return false; }
+        if ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN)) return true;
+        const int64_t p = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+        if (p / b != a) return true;
+        r = p;
+        return false;
+    }
+#endif
+
+} // namespace aleph3::detail
@@ -1,8 +1,14 @@
 #pragma once
 
+// Debug builds log to std::clog while the ALEPH3_LOG environment variable is set; the
+// message is only built then
 #ifdef _DEBUG
+#include <cstdlib>
 #include <iostream>
-#define ALEPH3_LOG(msg) do { std::cout << "[ALEPH3] " << msg << std::endl; } while(0)
+namespace aleph3::detail {
+    inline const bool logging = std::getenv("ALEPH3_LOG") != nullptr;
+}
+#define ALEPH3_LOG(msg) do { if (::aleph3::detail::logging) std::clog << "[ALEPH3] " << msg << '\n'; } while(0)
 #else
 #define ALEPH3_LOG(msg) do {} while(0)
-#endif
\ No newline at end of file
+#endif
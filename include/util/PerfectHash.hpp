@@ -0,0 +1,99 @@
+/*
+ * PerfectHash.hpp
+ * ---------------
+ * Perfect hashing of a fixed set of strings, built at compile time.
+ *
+ * The keys are split into buckets by one hash, then each bucket gets the first seed under
+ * which a second hash sends all its keys to free slots (hash and displace). Buckets are
+ * placed largest first, so seeds stay small. A lookup is two hashes of the key, one seed
+ * load, one slot load and one string comparison. Repeated keys resolve to their first
+ * occurrence.
+ */
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace aleph3 {
+
+    template <size_t N>
+    class PerfectHash {
+    public:
+        static constexpr size_t NOT_FOUND = N;
+
+        consteval explicit PerfectHash(const std::array<std::string_view, N>& keys) : keys_(keys) {
+            slots_.fill(static_cast<uint16_t>(N));
+            std::array<size_t, BUCKETS> bucket_size{};
+            for (size_t i = 0; i < N; ++i) {
+                if (first_occurrence(i)) ++bucket_size[hash(0, keys_[i]) % BUCKETS];
+            }
+            // Largest buckets first
+            std::array<bool, BUCKETS> placed{};
+            for (size_t round = 0; round < BUCKETS; ++round) {
+                size_t bucket = BUCKETS;
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    if (!placed[b] && (bucket == BUCKETS || bucket_size[b] > bucket_size[bucket])) bucket = b;
+                }
+                placed[bucket] = true;
+                if (bucket_size[bucket] > 0) place(bucket);
+            }
+        }
+
+        // Index of `key` among the keys, or NOT_FOUND
+        constexpr size_t find(std::string_view key) const {
+            const uint32_t seed = seeds_[hash(0, key) % BUCKETS];
+            const size_t index = slots_[hash(seed, key) % SLOTS];
+            return index < N && keys_[index] == key ? index : NOT_FOUND;
+        }
+
+    private:
+        static_assert(N < UINT16_MAX, "PerfectHash: too many keys");
+
+        static constexpr size_t BUCKETS = N / 4 + 1;
+        static constexpr size_t SLOTS = std::bit_ceil(N + N / 2 + 1);
+
+        std::array<std::string_view, N> keys_;
+        std::array<uint32_t, BUCKETS> seeds_{};
+        std::array<uint16_t, SLOTS> slots_{};
+
+        // FNV-1a from a seeded offset basis, with a final mix of the high bits
+        static constexpr uint64_t hash(uint32_t seed, std::string_view key) {
+            uint64_t h = 0xcbf29ce484222325ULL ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ULL);
+            for (char c : key) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ULL;
+            }
+            return h ^ (h >> 32);
+        }
+
+        constexpr bool first_occurrence(size_t i) const {
+            for (size_t j = 0; j < i; ++j) {
+                if (keys_[j] == keys_[i]) return false;
+            }
+            return true;
+        }
+
+        consteval void place(size_t bucket) {
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed == 0x1000000) throw "PerfectHash: no seed found";
+                std::array<uint16_t, SLOTS> trial = slots_;
+                bool fits = true;
+                for (size_t i = 0; i < N && fits; ++i) {
+                    if (!first_occurrence(i) || hash(0, keys_[i]) % BUCKETS != bucket) continue;
+                    auto& slot = trial[hash(seed, keys_[i]) % SLOTS];
+                    if (slot != N) fits = false;
+                    else slot = static_cast<uint16_t>(i);
+                }
+                if (fits) {
+                    slots_ = trial;
+                    seeds_[bucket] = seed;
+                    return;
+                }
+            }
+        }
+    };
+
+} // namespace aleph3
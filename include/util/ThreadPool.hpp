@@ -0,0 +1,80 @@
+/*
+ * ThreadPool.hpp
+ * --------------
+ * Work-stealing pool behind the Parallel* built-ins.
+ *
+ * parallel_for() cuts [0, n) into chunks of `grain` indices and hands each participant
+ * (the workers and the calling thread) one contiguous run of chunks. A participant takes
+ * chunks from the front of its own run; when it runs dry it steals the back half of the
+ * largest remaining run. Chunk boundaries depend only on n and grain, never on the number
+ * of threads or on scheduling, so per-chunk reductions combined in chunk order are
+ * deterministic.
+ *
+ * One job runs at a time. A parallel_for() issued from inside a job (nested parallelism)
+ * runs serially on the calling thread.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aleph3 {
+
+class ThreadPool {
+public:
+    // body(chunk, begin, end) for one chunk of [0, n)
+    using Body = std::function<void(size_t chunk, size_t begin, size_t end)>;
+
+    // Pool shared by the evaluator, with one worker per extra hardware thread
+    static ThreadPool& instance();
+
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that take part in a job: the workers plus the caller
+    size_t concurrency() const { return workers.size() + 1; }
+
+    // Replaces the workers; waits for a running job to finish first
+    void resize(size_t workers);
+
+    // Number of chunks parallel_for(n, grain, ...) runs
+    static size_t chunk_count(size_t n, size_t grain) { return grain == 0 ? 0 : (n + grain - 1) / grain; }
+
+    // Runs body over all chunks of [0, n) and returns when every chunk is done. The first
+    // exception thrown by a chunk is rethrown here; chunks not yet started are skipped.
+    void parallel_for(size_t n, size_t grain, const Body& body);
+
+    // True on a thread currently running a chunk of some pool's job
+    static bool in_job();
+
+private:
+    struct Run;
+    struct Job;
+
+    std::vector<std::thread> workers;
+    std::mutex job_mutex;           // Serializes jobs and resize()
+    std::mutex mutex;               // Guards the fields below
+    std::condition_variable wake;
+    std::condition_variable done;
+    Job* job = nullptr;
+    uint64_t generation = 0;        // Incremented per job, so workers join each job once
+    size_t busy = 0;                // Workers still inside the current job
+    bool stopping = false;
+
+    void start(size_t count);
+    void stop();
+    void worker_loop(size_t slot, uint64_t seen);
+    static void participate(Job& job, size_t slot);
+};
+
+} // namespace aleph3
@@ -0,0 +1,159 @@
+#include "algebra/Coefficients.hpp"
+#include "expr/ExprUtils.hpp"
+
+#include <utility>
+
+namespace aleph3 {
+
+    namespace {
+        bool is_integral(double value) { return std::isfinite(value) && std::floor(value) == value; }
+
+        Fraction reduced(const BigInt& num, const BigInt& den) {
+            auto [n, d] = normalize_rational(num, den);
+            return { std::move(n), std::move(d) };
+        }
+    }
+
+    // --- RealField ---
+
+    double RealField::inverse(double a) const {
+        if (is_zero(a)) throw std::domain_error("Division by zero");
+        return 1.0 / a;
+    }
+
+    // --- IntegerRing ---
+
+    BigInt IntegerRing::from_number(double value) const {
+        if (!is_integral(value)) throw std::domain_error("Coefficient is not an integer");
+        return BigInt::from_double(value);
+    }
+
+    BigInt IntegerRing::from_rational(const BigInt& num, const BigInt& den) const {
+        if (den.is_zero() || !(num % den).is_zero()) throw std::domain_error("Coefficient is not an integer");
+        return num / den;
+    }
+
+    // --- RationalField ---
+
+    Fraction RationalField::add(const Fraction& a, const Fraction& b) const {
+        if (a.den == b.den) return reduced(a.num + b.num, a.den);
+        return reduced(a.num * b.den + b.num * a.den, a.den * b.den);
+    }
+
+    Fraction RationalField::sub(const Fraction& a, const Fraction& b) const {
+        return add(a, neg(b));
+    }
+
+    Fraction RationalField::mul(const Fraction& a, const Fraction& b) const {
+        if (a.den == 1 && b.den == 1) return { a.num * b.num, 1 };
+        return reduced(a.num * b.num, a.den * b.den);
+    }
+
+    Fraction RationalField::inverse(const Fraction& a) const {
+        if (a.num.is_zero()) throw std::domain_error("Division by zero");
+        return a.num.sign() < 0 ? Fraction{ -a.den, -a.num } : Fraction{ a.den, a.num };
+    }
+
+    Fraction RationalField::from_number(double value) const {
+        if (!is_integral(value)) throw std::domain_error("Coefficient is not an exact number");
+        return { BigInt::from_double(value), 1 };
+    }
+
+    Fraction RationalField::from_rational(const BigInt& num, const BigInt& den) const {
+        if (den.is_zero()) throw std::domain_error("Division by zero");
+        return reduced(num, den);
+    }
+
+    // --- ModularField ---
+
+    ModularField::ModularField(uint64_t p) : ModularField(p, Unchecked{}) {
+        if (!passes_miller_rabin()) {
+            throw std::invalid_argument("ModularField modulus " + std::to_string(p) + " is not prime");
+        }
+    }
+
+    ModularField::ModularField(uint64_t p, Unchecked) : p_(p) {
+        if (p < 3 || p % 2 == 0 || p >= (uint64_t(1) << 63)) {
+            throw std::invalid_argument("ModularField needs an odd prime below 2^63");
+        }
+        // Newton's iteration doubles the correct low bits of p^-1 each step, from 3
+        uint64_t inv = p;
+        for (int i = 0; i < 5; ++i) inv *= 2 - p * inv;
+        p_neg_inv_ = 0 - inv;
+        barrett_ = ~uint64_t(0) / p;
+        one_ = (0 - p) % p;
+        // 2^128 mod p by doubling 2^64 mod p another 64 times
+        r2_ = one_;
+        for (int i = 0; i < 64; ++i) r2_ = r2_ >= p - r2_ ? r2_ - (p - r2_) : r2_ + r2_;
+    }
+
+    bool ModularField::is_prime(uint64_t n) {
+        if (n == 2) return true;
+        if (n < 3 || n % 2 == 0 || n >= (uint64_t(1) << 63)) return false;
+        return ModularField(n, Unchecked{}).passes_miller_rabin();
+    }
+
+    bool ModularField::passes_miller_rabin() const {
+        // Miller-Rabin with these bases is deterministic below 2^64
+        uint64_t d = p_ - 1;
+        unsigned s = 0;
+        for (; d % 2 == 0; d /= 2) ++s;
+        const uint64_t minus_one = neg(one_);
+        for (uint64_t base : { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 }) {
+            if (base % p_ == 0) continue;
+            uint64_t x = pow(from_uint(base), d);
+            if (x == one_ || x == minus_one) continue;
+            bool witness = true;
+            for (unsigned r = 1; r < s && witness; ++r) {
+                x = mul(x, x);
+                if (x == minus_one) witness = false;
+            }
+            if (witness) return false;
+        }
+        return true;
+    }
+
+    uint64_t ModularField::pow(uint64_t a, uint64_t exponent) const {
+        uint64_t result = one_;
+        for (; exponent; exponent >>= 1) {
+            if (exponent & 1) result = mul(result, a);
+            a = mul(a, a);
+        }
+        return result;
+    }
+
+    uint64_t ModularField::inverse(uint64_t a) const {
+        if (a == 0) throw std::domain_error("Division by zero modulo " + std::to_string(p_));
+        // Extended Euclid on the representative; the Bezout coefficients stay below p in magnitude
+        uint64_t r0 = p_, r1 = to_uint(a);
+        int64_t t0 = 0, t1 = 1;
+        while (r1 != 0) {
+            const uint64_t q = r0 / r1;
+            r0 = std::exchange(r1, r0 - q * r1);
+            t0 = std::exchange(t1, t0 - static_cast<int64_t>(q) * t1);
+        }
+        return from_uint(t0 < 0 ? static_cast<uint64_t>(t0) + p_ : static_cast<uint64_t>(t0));
+    }
+
+    uint64_t ModularField::from_integer(const BigInt& n) const {
+        if (n.is_small()) {
+            const int64_t v = n.small_value();
+            const uint64_t magnitude = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+            const uint64_t a = from_uint(magnitude);
+            return v < 0 ? neg(a) : a;
+        }
+        const BigInt r = n % BigInt(static_cast<int64_t>(p_));
+        const int64_t v = r.small_value();
+        return v < 0 ? neg(from_uint(static_cast<uint64_t>(-v))) : from_uint(static_cast<uint64_t>(v));
+    }
+
+    uint64_t ModularField::from_number(double value) const {
+        if (!is_integral(value)) throw std::domain_error("Coefficient is not an integer");
+        return from_integer(BigInt::from_double(value));
+    }
+
+    uint64_t ModularField::from_rational(const BigInt& num, const BigInt& den) const {
+        return divide(from_integer(num), from_integer(den));
+    }
+
+} // namespace aleph3
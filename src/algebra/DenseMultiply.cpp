@@ -0,0 +1,310 @@
+#include "algebra/DenseMultiply.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <stdexcept>
+
+namespace aleph3::dense {
+
+    namespace {
+
+        using Coeffs = std::vector<double>;
+
+        Coeffs schoolbook(const double* a, size_t la, const double* b, size_t lb) {
+            Coeffs out(la + lb - 1, 0.0);
+            for (size_t i = 0; i < la; ++i) {
+                const double x = a[i];
+                if (x == 0.0) continue;
+                for (size_t j = 0; j < lb; ++j) out[i + j] += x * b[j];
+            }
+            return out;
+        }
+
+        // out[offset + k] += c[k]
+        void add_at(Coeffs& out, const Coeffs& c, size_t offset) {
+            for (size_t k = 0; k < c.size(); ++k) out[offset + k] += c[k];
+        }
+
+        // a[begin, end) padded with zeros to `length`
+        Coeffs slice(const Coeffs& a, size_t begin, size_t end, size_t length) {
+            Coeffs piece(length, 0.0);
+            if (begin < a.size()) std::copy(a.begin() + begin, a.begin() + std::min(end, a.size()), piece.begin());
+            return piece;
+        }
+
+        // --- Karatsuba and Toom-3, on factors of equal length ---
+
+        Coeffs karatsuba(const Coeffs& a, const Coeffs& b) {
+            const size_t n = a.size();
+            if (n < KARATSUBA_LENGTH) return schoolbook(a.data(), n, b.data(), n);
+            const size_t m = n / 2, h = n - m;
+            const Coeffs a0 = slice(a, 0, m, m), a1 = slice(a, m, n, h);
+            const Coeffs b0 = slice(b, 0, m, m), b1 = slice(b, m, n, h);
+            Coeffs sa = a1, sb = b1;
+            for (size_t k = 0; k < m; ++k) {
+                sa[k] += a0[k];
+                sb[k] += b0[k];
+            }
+            const Coeffs z0 = karatsuba(a0, b0), z2 = karatsuba(a1, b1);
+            Coeffs z1 = karatsuba(sa, sb);
+            for (size_t k = 0; k < z0.size(); ++k) z1[k] -= z0[k];
+            for (size_t k = 0; k < z2.size(); ++k) z1[k] -= z2[k];
+
+            Coeffs out(2 * n - 1, 0.0);
+            add_at(out, z0, 0);
+            add_at(out, z1, m);
+            add_at(out, z2, 2 * m);
+            return out;
+        }
+
+        // Evaluation at 0, 1, -1, -2 and infinity with Bodrato's interpolation sequence
+        Coeffs toom3(const Coeffs& a, const Coeffs& b) {
+            const size_t n = a.size();
+            if (n < TOOM3_LENGTH) return karatsuba(a, b);
+            const size_t k = (n + 2) / 3;
+
+            struct Points { Coeffs p0, p1, pm1, pm2, pinf; };
+            const auto evaluate = [&](const Coeffs& x) {
+                const Coeffs x0 = slice(x, 0, k, k), x1 = slice(x, k, 2 * k, k), x2 = slice(x, 2 * k, n, k);
+                Points p{ x0, Coeffs(k), Coeffs(k), Coeffs(k), x2 };
+                for (size_t i = 0; i < k; ++i) {
+                    const double even = x0[i] + x2[i];
+                    p.p1[i] = even + x1[i];
+                    p.pm1[i] = even - x1[i];
+                    p.pm2[i] = x0[i] - 2.0 * x1[i] + 4.0 * x2[i];
+                }
+                return p;
+            };
+            const Points pa = evaluate(a), pb = evaluate(b);
+            const Coeffs r0 = toom3(pa.p0, pb.p0), r4 = toom3(pa.pinf, pb.pinf);
+            const Coeffs v1 = toom3(pa.p1, pb.p1), vm1 = toom3(pa.pm1, pb.pm1), vm2 = toom3(pa.pm2, pb.pm2);
+
+            const size_t len = 2 * k - 1;
+            Coeffs r1(len), r2(len), r3(len);
+            for (size_t i = 0; i < len; ++i) {
+                r3[i] = (vm2[i] - v1[i]) / 3.0;
+                r1[i] = (v1[i] - vm1[i]) / 2.0;
+                r2[i] = vm1[i] - r0[i];
+                r3[i] = (r2[i] - r3[i]) / 2.0 + 2.0 * r4[i];
+                r2[i] = r2[i] + r1[i] - r4[i];
+                r1[i] = r1[i] - r3[i];
+            }
+
+            // Padding the last piece can leave (zero) coefficients past 2n - 2
+            Coeffs out(4 * k + len, 0.0);
+            add_at(out, r0, 0);
+            add_at(out, r1, k);
+            add_at(out, r2, 2 * k);
+            add_at(out, r3, 3 * k);
+            add_at(out, r4, 4 * k);
+            out.resize(2 * n - 1);
+            return out;
+        }
+
+        // Cuts the longer factor into pieces as long as the shorter one
+        Coeffs balanced(const Coeffs& a, const Coeffs& b, Coeffs (*kernel)(const Coeffs&, const Coeffs&)) {
+            const Coeffs& longer = a.size() >= b.size() ? a : b;
+            const Coeffs& shorter = a.size() >= b.size() ? b : a;
+            const size_t n = shorter.size();
+            Coeffs out(longer.size() + 2 * n, 0.0);
+            for (size_t offset = 0; offset < longer.size(); offset += n) {
+                add_at(out, kernel(slice(longer, offset, offset + n, n), shorter), offset);
+            }
+            out.resize(a.size() + b.size() - 1);
+            return out;
+        }
+
+        // --- Complex FFT ---
+
+        void fft(std::vector<std::complex<double>>& x, bool inverse) {
+            const size_t n = x.size();
+            for (size_t i = 1, j = 0; i < n; ++i) {
+                size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1) j ^= bit;
+                j ^= bit;
+                if (i < j) std::swap(x[i], x[j]);
+            }
+            // Roots computed directly rather than by repeated multiplication, for accuracy
+            std::vector<std::complex<double>> roots(n / 2);
+            const double sign = inverse ? 1.0 : -1.0;
+            for (size_t k = 0; k < n / 2; ++k) {
+                roots[k] = std::polar(1.0, sign * 2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n));
+            }
+            for (size_t len = 2; len <= n; len <<= 1) {
+                const size_t half = len / 2, stride = n / len;
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t k = 0; k < half; ++k) {
+                        const auto t = roots[k * stride] * x[i + k + half];
+                        x[i + k + half] = x[i + k] - t;
+                        x[i + k] += t;
+                    }
+                }
+            }
+            if (inverse) {
+                for (auto& v : x) v /= static_cast<double>(n);
+            }
+        }
+
+        size_t transform_size(size_t length) {
+            size_t n = 1;
+            while (n < length) n <<= 1;
+            return n;
+        }
+
+        Coeffs fft_multiply(const Coeffs& a, const Coeffs& b) {
+            const size_t length = a.size() + b.size() - 1, n = transform_size(length);
+            std::vector<std::complex<double>> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+            fa.resize(n);
+            fb.resize(n);
+            fft(fa, false);
+            fft(fb, false);
+            for (size_t i = 0; i < n; ++i) fa[i] *= fb[i];
+            fft(fa, true);
+            Coeffs out(length);
+            for (size_t i = 0; i < length; ++i) out[i] = fa[i].real();
+            return out;
+        }
+
+        // --- NTT modulo three primes, recombined by Garner's algorithm ---
+
+        struct Prime {
+            uint32_t p;
+            uint32_t root;  // Generator of the multiplicative group
+        };
+        // p - 1 is divisible by 2^23, 2^25 and 2^26 respectively
+        constexpr Prime PRIMES[3] = { { 998244353, 3 }, { 167772161, 3 }, { 469762049, 3 } };
+        constexpr size_t MAX_NTT_LENGTH = size_t(1) << 23;
+
+        uint64_t mul_mod(uint64_t a, uint64_t b, uint32_t p) { return a * b % p; }
+
+        uint64_t pow_mod(uint64_t base, uint64_t e, uint32_t p) {
+            uint64_t result = 1;
+            for (base %= p; e; e >>= 1) {
+                if (e & 1) result = mul_mod(result, base, p);
+                base = mul_mod(base, base, p);
+            }
+            return result;
+        }
+
+        uint32_t residue(double c, uint32_t p) {
+            const auto v = static_cast<int64_t>(c) % static_cast<int64_t>(p);
+            return static_cast<uint32_t>(v < 0 ? v + p : v);
+        }
+
+        void ntt(std::vector<uint32_t>& x, bool inverse, const Prime& prime) {
+            const size_t n = x.size();
+            const uint32_t p = prime.p;
+            for (size_t i = 1, j = 0; i < n; ++i) {
+                size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1) j ^= bit;
+                j ^= bit;
+                if (i < j) std::swap(x[i], x[j]);
+            }
+            for (size_t len = 2; len <= n; len <<= 1) {
+                uint64_t w = pow_mod(prime.root, (p - 1) / len, p);
+                if (inverse) w = pow_mod(w, p - 2, p);
+                std::vector<uint32_t> powers(len / 2);
+                powers[0] = 1;
+                for (size_t k = 1; k < len / 2; ++k) powers[k] = static_cast<uint32_t>(mul_mod(powers[k - 1], w, p));
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t k = 0; k < len / 2; ++k) {
+                        const uint32_t u = x[i + k];
+                        const auto v = static_cast<uint32_t>(mul_mod(x[i + k + len / 2], powers[k], p));
+                        x[i + k] = u + v >= p ? u + v - p : u + v;
+                        x[i + k + len / 2] = u >= v ? u - v : u + p - v;
+                    }
+                }
+            }
+            if (inverse) {
+                const uint64_t n_inv = pow_mod(n, p - 2, p);
+                for (auto& v : x) v = static_cast<uint32_t>(mul_mod(v, n_inv, p));
+            }
+        }
+
+        std::vector<uint32_t> ntt_multiply(const Coeffs& a, const Coeffs& b, const Prime& prime, size_t n) {
+            std::vector<uint32_t> fa(n, 0), fb(n, 0);
+            for (size_t i = 0; i < a.size(); ++i) fa[i] = residue(a[i], prime.p);
+            for (size_t i = 0; i < b.size(); ++i) fb[i] = residue(b[i], prime.p);
+            ntt(fa, false, prime);
+            ntt(fb, false, prime);
+            for (size_t i = 0; i < n; ++i) fa[i] = static_cast<uint32_t>(mul_mod(fa[i], fb[i], prime.p));
+            ntt(fa, true, prime);
+            return fa;
+        }
+
+        // Results lie strictly within +-p1 p2 HALF: the top Garner digit is then below HALF
+        // for non-negative values and above it for negative ones
+        constexpr uint64_t HALF = (PRIMES[2].p - 1) / 2;
+        const long double NTT_BOUND =
+            static_cast<long double>(PRIMES[0].p) * PRIMES[1].p * static_cast<long double>(HALF);
+
+        Coeffs exact_multiply(const Coeffs& a, const Coeffs& b) {
+            const size_t length = a.size() + b.size() - 1, n = transform_size(length);
+            const auto r1 = ntt_multiply(a, b, PRIMES[0], n);
+            const auto r2 = ntt_multiply(a, b, PRIMES[1], n);
+            const auto r3 = ntt_multiply(a, b, PRIMES[2], n);
+
+            const uint64_t p1 = PRIMES[0].p, p2 = PRIMES[1].p, p3 = PRIMES[2].p;
+            const uint64_t p1_inv_p2 = pow_mod(p1, p2 - 2, p2);
+            const uint64_t p1p2_inv_p3 = pow_mod(mul_mod(p1 % p3, p2 % p3, static_cast<uint32_t>(p3)), p3 - 2, static_cast<uint32_t>(p3));
+            Coeffs out(length);
+            for (size_t i = 0; i < length; ++i) {
+                // value = x1 + x2 p1 + x3 p1 p2 with x_k < p_k
+                const uint64_t x1 = r1[i];
+                const uint64_t x2 = mul_mod((r2[i] + p2 - x1 % p2) % p2, p1_inv_p2, static_cast<uint32_t>(p2));
+                const uint64_t partial = (x1 + mul_mod(x2, p1 % p3, static_cast<uint32_t>(p3))) % p3;
+                const uint64_t x3 = mul_mod((r3[i] + p3 - partial) % p3, p1p2_inv_p3, static_cast<uint32_t>(p3));
+                if (x3 <= HALF) {
+                    out[i] = static_cast<double>(x1) + static_cast<double>(p1) *
+                        (static_cast<double>(x2) + static_cast<double>(p2) * static_cast<double>(x3));
+                } else {
+                    // M - value has the digits (p_k - 1 - x_k), plus one
+                    const double magnitude = static_cast<double>(p1 - 1 - x1) + 1.0 + static_cast<double>(p1) *
+                        (static_cast<double>(p2 - 1 - x2) + static_cast<double>(p2) * static_cast<double>(p3 - 1 - x3));
+                    out[i] = -magnitude;
+                }
+            }
+            return out;
+        }
+
+    } // namespace
+
+    bool ntt_exact(const std::vector<double>& a, const std::vector<double>& b) {
+        if (a.empty() || b.empty() || a.size() + b.size() - 1 > MAX_NTT_LENGTH) return false;
+        const auto bound = [](const Coeffs& x, long double& largest) {
+            for (double c : x) {
+                if (!std::isfinite(c) || std::floor(c) != c || std::abs(c) > 9007199254740992.0) return false;
+                largest = std::max(largest, static_cast<long double>(std::abs(c)));
+            }
+            return true;
+        };
+        long double max_a = 0, max_b = 0;
+        if (!bound(a, max_a) || !bound(b, max_b)) return false;
+        return max_a * max_b * static_cast<long double>(std::min(a.size(), b.size())) < NTT_BOUND;
+    }
+
+    std::vector<double> multiply(const std::vector<double>& a, const std::vector<double>& b, Method method) {
+        if (a.empty() || b.empty()) return {};
+        if (method == Method::Automatic) {
+            const size_t n = std::min(a.size(), b.size());
+            if (n < KARATSUBA_LENGTH) method = Method::Schoolbook;
+            else if (n < TOOM3_LENGTH) method = Method::Karatsuba;
+            else if (ntt_exact(a, b)) method = n < NTT_LENGTH ? Method::Toom3 : Method::NTT;
+            else method = n < FFT_LENGTH ? Method::Toom3 : Method::FFT;
+        }
+        switch (method) {
+        case Method::Schoolbook: return schoolbook(a.data(), a.size(), b.data(), b.size());
+        case Method::Karatsuba:  return balanced(a, b, karatsuba);
+        case Method::Toom3:      return balanced(a, b, toom3);
+        case Method::FFT:        return fft_multiply(a, b);
+        case Method::NTT:
+            if (!ntt_exact(a, b)) throw std::domain_error("NTT multiplication needs integer coefficients within its bound");
+            return exact_multiply(a, b);
+        case Method::Automatic:  break;
+        }
+        return schoolbook(a.data(), a.size(), b.data(), b.size());
+    }
+
+} // namespace aleph3::dense
@@ -0,0 +1,410 @@
+#include "algebra/Groebner.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace aleph3 {
+
+    std::optional<MonomialOrder> monomial_order_named(std::string_view name) {
+        if (name == "Lexicographic") return MonomialOrder::Lexicographic;
+        if (name == "DegreeLexicographic") return MonomialOrder::DegreeLexicographic;
+        if (name == "DegreeReverseLexicographic") return MonomialOrder::DegreeReverseLexicographic;
+        return std::nullopt;
+    }
+
+    bool monomial_greater(const PolynomialRing& ring, MonomialOrder order, const Exponents& a, const Exponents& b) {
+        if (order == MonomialOrder::Lexicographic) return a > b;
+        const uint32_t da = ring.total_degree(a), db = ring.total_degree(b);
+        if (da != db) return da > db;
+        if (order == MonomialOrder::DegreeLexicographic) return a > b;
+        for (size_t v = ring.size(); v-- > 0;) {
+            const uint32_t ea = ring.exponent(a, v), eb = ring.exponent(b, v);
+            if (ea != eb) return ea < eb;
+        }
+        return false;
+    }
+
+    namespace {
+        struct ExponentsHash {
+            size_t operator()(const Exponents& e) const { return std::hash<uint64_t>()(e.hi * 0x9e3779b97f4a7c15ull ^ e.lo); }
+        };
+
+        // Decreasing in the order
+        struct Greater {
+            const PolynomialRing* ring;
+            MonomialOrder order;
+            bool operator()(const Exponents& a, const Exponents& b) const { return monomial_greater(*ring, order, a, b); }
+        };
+
+        Exponents lcm(const PolynomialRing& ring, const Exponents& a, const Exponents& b) {
+            std::vector<uint32_t> exponents(ring.size());
+            for (size_t v = 0; v < ring.size(); ++v) exponents[v] = std::max(ring.exponent(a, v), ring.exponent(b, v));
+            return ring.pack(exponents);
+        }
+
+        bool coprime(const PolynomialRing& ring, const Exponents& a, const Exponents& b) {
+            for (size_t v = 0; v < ring.size(); ++v) {
+                if (ring.exponent(a, v) != 0 && ring.exponent(b, v) != 0) return false;
+            }
+            return true;
+        }
+
+        bool divides(const PolynomialRing& ring, const Exponents& a, const Exponents& b) {
+            return ring.divide(b, a).has_value();
+        }
+
+        template <class Domain>
+        using Terms = std::vector<typename BasicSparsePolynomial<Domain>::Term>;
+
+        template <class Domain>
+        Terms<Domain> ordered_terms(const BasicSparsePolynomial<Domain>& p, const Greater& greater) {
+            Terms<Domain> terms = p.terms();
+            if (greater.order != MonomialOrder::Lexicographic) {
+                std::sort(terms.begin(), terms.end(), [&](const auto& s, const auto& t) { return greater(s.exponents, t.exponents); });
+            }
+            return terms;
+        }
+
+        // a[from:] - c * m * b, all in decreasing order; multiplying by a monomial keeps it
+        template <class Domain>
+        Terms<Domain> sub_mul(const Terms<Domain>& a, size_t from, const typename Domain::value_type& c, const Exponents& m,
+                              const Terms<Domain>& b, const PolynomialRing& ring, const Domain& d, const Greater& greater) {
+            Terms<Domain> out;
+            out.reserve(a.size() - from + b.size());
+            size_t i = from, j = 0;
+            while (i < a.size() || j < b.size()) {
+                if (j == b.size()) {
+                    out.push_back(a[i++]);
+                    continue;
+                }
+                const Exponents e = ring.multiply(b[j].exponents, m);
+                if (i < a.size() && a[i].exponents == e) {
+                    auto coeff = d.sub(a[i].coeff, d.mul(c, b[j].coeff));
+                    if (!d.is_zero(coeff)) out.push_back({ e, std::move(coeff) });
+                    ++i;
+                    ++j;
+                }
+                else if (i < a.size() && greater(a[i].exponents, e)) {
+                    out.push_back(a[i++]);
+                }
+                else {
+                    out.push_back({ e, d.neg(d.mul(c, b[j++].coeff)) });
+                }
+            }
+            return out;
+        }
+
+        // p = sum q_i g_i + r; the quotients are collected only if `quotients` is given
+        template <class Domain>
+        Terms<Domain> normal_form(Terms<Domain> p, const std::vector<const Terms<Domain>*>& divisors, const PolynomialRing& ring,
+                                  const Domain& d, const Greater& greater, std::vector<Terms<Domain>>* quotients) {
+            Terms<Domain> remainder;
+            size_t from = 0;
+            while (from < p.size()) {
+                const auto& lead = p[from];
+                bool divided = false;
+                for (size_t k = 0; k < divisors.size(); ++k) {
+                    const auto& g = *divisors[k];
+                    auto m = ring.divide(lead.exponents, g.front().exponents);
+                    if (!m) continue;
+                    const auto c = d.divide(lead.coeff, g.front().coeff);
+                    if (quotients) (*quotients)[k].push_back({ *m, c });
+                    p = sub_mul(p, from, c, *m, g, ring, d, greater);
+                    from = 0;
+                    divided = true;
+                    break;
+                }
+                if (!divided) remainder.push_back(p[from++]);
+            }
+            return remainder;
+        }
+
+        template <class Domain>
+        void make_monic(Terms<Domain>& p, const Domain& d) {
+            const auto inverse = d.inverse(p.front().coeff);
+            for (auto& t : p) t.coeff = d.mul(t.coeff, inverse);
+        }
+
+        template <class Domain>
+        class F4 {
+        public:
+            using Poly = BasicSparsePolynomial<Domain>;
+            using Coeff = typename Domain::value_type;
+
+            F4(std::shared_ptr<const PolynomialRing> ring, Domain domain, MonomialOrder order)
+                : ring_(std::move(ring)), d_(std::move(domain)), greater_{ ring_.get(), order } {}
+
+            std::vector<Poly> run(const std::vector<Poly>& generators) {
+                for (const auto& g : generators) {
+                    if (g.is_zero()) continue;
+                    Terms<Domain> terms = ordered_terms(g, greater_);
+                    make_monic(terms, d_);
+                    add(std::move(terms));
+                }
+                while (!pairs_.empty()) step();
+                return reduced_basis();
+            }
+
+        private:
+            struct Pair {
+                size_t i, j;
+                Exponents lcm;
+                uint32_t degree;
+            };
+
+            // A sparse matrix row: (column, coefficient), by increasing column
+            using Row = std::vector<std::pair<uint32_t, Coeff>>;
+
+            std::shared_ptr<const PolynomialRing> ring_;
+            Domain d_;
+            Greater greater_;
+            std::vector<Terms<Domain>> polys_;  // Monic, in decreasing order; never removed, as pairs refer to them
+            std::vector<size_t> basis_;         // Indices of the current basis in polys_
+            std::vector<Pair> pairs_;
+
+            const Exponents& lm(size_t i) const { return polys_[i].front().exponents; }
+
+            // Adds h to the basis, with the Gebauer-Moeller update of the pairs
+            void add(Terms<Domain> h) {
+                const PolynomialRing& ring = *ring_;
+                const size_t k = polys_.size();
+                polys_.push_back(std::move(h));
+                const Exponents& lh = lm(k);
+
+                std::vector<Pair> candidates;
+                for (size_t g : basis_) {
+                    const Exponents l = lcm(ring, lh, lm(g));
+                    candidates.push_back({ g, k, l, ring.total_degree(l) });
+                }
+                // Chain criterion among the new pairs: keep a pair only if no other one has an
+                // lcm dividing its own, unless its leading monomials are coprime (they go below)
+                std::vector<Pair> kept;
+                for (size_t a = 0; a < candidates.size(); ++a) {
+                    const Pair& p = candidates[a];
+                    bool redundant = false;
+                    if (!coprime(ring, lh, lm(p.i))) {
+                        for (size_t b = a + 1; b < candidates.size() && !redundant; ++b) redundant = divides(ring, candidates[b].lcm, p.lcm);
+                        for (const Pair& q : kept) {
+                            if (redundant) break;
+                            redundant = divides(ring, q.lcm, p.lcm);
+                        }
+                    }
+                    if (!redundant) kept.push_back(p);
+                }
+                // Old pairs whose lcm lm(h) divides strictly are covered by the new ones
+                std::erase_if(pairs_, [&](const Pair& p) {
+                    return divides(ring, lh, p.lcm) && lcm(ring, lm(p.i), lh) != p.lcm && lcm(ring, lm(p.j), lh) != p.lcm;
+                });
+                // Product criterion: coprime leading monomials reduce to zero
+                for (const Pair& p : kept) {
+                    if (!coprime(ring, lh, lm(p.i))) pairs_.push_back(p);
+                }
+                std::erase_if(basis_, [&](size_t g) { return divides(ring, lh, lm(g)); });
+                basis_.push_back(k);
+            }
+
+            // One reduction of the pairs of lowest degree
+            void step() {
+                const PolynomialRing& ring = *ring_;
+                uint32_t degree = pairs_.front().degree;
+                for (const Pair& p : pairs_) degree = std::min(degree, p.degree);
+                std::vector<std::pair<Exponents, size_t>> multiples;  // (multiplier, index in polys_)
+                std::erase_if(pairs_, [&](const Pair& p) {
+                    if (p.degree != degree) return false;
+                    multiples.push_back({ *ring.divide(p.lcm, lm(p.i)), p.i });
+                    multiples.push_back({ *ring.divide(p.lcm, lm(p.j)), p.j });
+                    return true;
+                });
+                std::sort(multiples.begin(), multiples.end());
+                multiples.erase(std::unique(multiples.begin(), multiples.end()), multiples.end());
+
+                // Symbolic preprocessing: a reducer for every monomial that a basis element's
+                // leading monomial divides
+                std::unordered_set<Exponents, ExponentsHash> monomials, done;
+                std::vector<Exponents> pending;
+                auto note = [&](const std::pair<Exponents, size_t>& multiple, bool skip_lead) {
+                    const auto& terms = polys_[multiple.second];
+                    for (size_t t = 0; t < terms.size(); ++t) {
+                        const Exponents e = ring.multiply(terms[t].exponents, multiple.first);
+                        if (monomials.insert(e).second && !(skip_lead && t == 0)) pending.push_back(e);
+                    }
+                };
+                for (const auto& multiple : multiples) {
+                    done.insert(ring.multiply(lm(multiple.second), multiple.first));
+                    note(multiple, true);
+                }
+                const size_t pair_rows = multiples.size();
+                while (!pending.empty()) {
+                    const Exponents m = pending.back();
+                    pending.pop_back();
+                    if (!done.insert(m).second) continue;
+                    for (size_t g : basis_) {
+                        if (auto q = ring.divide(m, lm(g))) {
+                            multiples.push_back({ *q, g });
+                            note(multiples.back(), true);
+                            break;
+                        }
+                    }
+                }
+
+                // Columns in decreasing order
+                std::vector<Exponents> columns(monomials.begin(), monomials.end());
+                std::sort(columns.begin(), columns.end(), greater_);
+                std::unordered_map<Exponents, uint32_t, ExponentsHash> column_of;
+                column_of.reserve(columns.size());
+                for (uint32_t c = 0; c < columns.size(); ++c) column_of.emplace(columns[c], c);
+
+                std::vector<Row> rows(multiples.size());
+                for (size_t r = 0; r < multiples.size(); ++r) {
+                    const auto& [m, index] = multiples[r];
+                    for (const auto& t : polys_[index]) rows[r].push_back({ column_of.at(ring.multiply(t.exponents, m)), t.coeff });
+                }
+
+                // The first row with each leading column is its pivot; the rows of
+                // preprocessing all lead distinct columns
+                constexpr size_t NONE = SIZE_MAX;
+                std::vector<size_t> pivot(columns.size(), NONE);
+                std::vector<size_t> others;
+                for (size_t r = 0; r < rows.size(); ++r) {
+                    size_t& slot = pivot[rows[r].front().first];
+                    if (slot == NONE) slot = r;
+                    else if (r < pair_rows) others.push_back(r);
+                }
+
+                // The other rows reduced by the pivots, each on its own
+                std::vector<Row> reduced(others.size());
+                ThreadPool::instance().parallel_for(others.size(), 4, [&](size_t, size_t begin, size_t end) {
+                    std::vector<Coeff> dense(columns.size(), d_.zero());
+                    for (size_t k = begin; k < end; ++k) reduced[k] = reduce_row(rows[others[k]], pivot, rows, dense);
+                });
+
+                // Echelon form of the remainders; their rows with new leading columns join the basis
+                std::vector<size_t> new_pivot(columns.size(), NONE);
+                std::vector<Row> fresh;
+                std::vector<Coeff> dense(columns.size(), d_.zero());
+                for (auto& row : reduced) {
+                    if (row.empty()) continue;
+                    if (!fresh.empty()) row = reduce_row(row, new_pivot, fresh, dense);
+                    if (row.empty()) continue;
+                    const Coeff inverse = d_.inverse(row.front().second);
+                    for (auto& entry : row) entry.second = d_.mul(entry.second, inverse);
+                    new_pivot[row.front().first] = fresh.size();
+                    fresh.push_back(std::move(row));
+                }
+                for (const auto& row : fresh) {
+                    Terms<Domain> h;
+                    h.reserve(row.size());
+                    for (const auto& [c, coeff] : row) h.push_back({ columns[c], coeff });
+                    add(std::move(h));
+                }
+            }
+
+            // row minus multiples of the monic pivot rows, until no pivot column is left
+            Row reduce_row(const Row& row, const std::vector<size_t>& pivot, const std::vector<Row>& pivots, std::vector<Coeff>& dense) const {
+                const uint32_t first = row.front().first;
+                for (const auto& [c, coeff] : row) dense[c] = coeff;
+                Row out;
+                for (uint32_t c = first; c < dense.size(); ++c) {
+                    if (d_.is_zero(dense[c])) continue;
+                    if (pivot[c] == SIZE_MAX) {
+                        out.push_back({ c, std::move(dense[c]) });
+                        dense[c] = d_.zero();
+                        continue;
+                    }
+                    const Coeff factor = std::move(dense[c]);
+                    dense[c] = d_.zero();
+                    const Row& p = pivots[pivot[c]];
+                    for (size_t t = 1; t < p.size(); ++t) dense[p[t].first] = d_.sub(dense[p[t].first], d_.mul(factor, p[t].second));
+                }
+                return out;
+            }
+
+            // The minimal basis, each element's tail reduced by the others, by increasing
+            // leading monomial. Generators went in unreduced, so some leading monomials can
+            // still be multiples of others.
+            std::vector<Poly> reduced_basis() const {
+                std::vector<size_t> sorted = basis_;
+                std::stable_sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) { return greater_(lm(b), lm(a)); });
+                std::vector<size_t> order;
+                for (size_t a : sorted) {
+                    const bool redundant = std::any_of(order.begin(), order.end(), [&](size_t b) { return divides(*ring_, lm(b), lm(a)); });
+                    if (!redundant) order.push_back(a);
+                }
+                std::vector<Poly> basis;
+                basis.reserve(order.size());
+                for (size_t a : order) {
+                    std::vector<const Terms<Domain>*> others;
+                    for (size_t b : order) {
+                        if (b != a) others.push_back(&polys_[b]);
+                    }
+                    // The leading term stays: no other leading monomial divides it
+                    Terms<Domain> tail(polys_[a].begin() + 1, polys_[a].end());
+                    Terms<Domain> terms{ polys_[a].front() };
+                    for (auto& t : normal_form(std::move(tail), others, *ring_, d_, greater_, nullptr)) terms.push_back(std::move(t));
+                    basis.push_back(Poly::from_terms(ring_, std::move(terms), d_));
+                }
+                return basis;
+            }
+        };
+    }
+
+    template <class Domain>
+    Exponents leading_monomial(const BasicSparsePolynomial<Domain>& p, MonomialOrder order) {
+        if (p.is_zero()) throw std::domain_error("leading_monomial: zero polynomial");
+        const Greater greater{ &p.ring(), order };
+        Exponents lead = p.terms().front().exponents;
+        for (const auto& t : p.terms()) {
+            if (greater(t.exponents, lead)) lead = t.exponents;
+        }
+        return lead;
+    }
+
+    template <class Domain>
+    Reduction<Domain> reduce(const BasicSparsePolynomial<Domain>& f, const std::vector<BasicSparsePolynomial<Domain>>& divisors,
+                             MonomialOrder order) {
+        using Poly = BasicSparsePolynomial<Domain>;
+        const Greater greater{ &f.ring(), order };
+        std::vector<Terms<Domain>> ordered;
+        ordered.reserve(divisors.size());
+        for (const auto& g : divisors) {
+            if (!(g.ring() == f.ring()) || !(g.domain() == f.domain())) throw std::invalid_argument("reduce: polynomials in different rings");
+            if (g.is_zero()) throw std::domain_error("reduce: division by zero");
+            ordered.push_back(ordered_terms(g, greater));
+        }
+        std::vector<const Terms<Domain>*> pointers;
+        for (const auto& g : ordered) pointers.push_back(&g);
+
+        std::vector<Terms<Domain>> quotients(divisors.size());
+        Terms<Domain> remainder = normal_form(ordered_terms(f, greater), pointers, f.ring(), f.domain(), greater, &quotients);
+        Reduction<Domain> result{ {}, Poly::from_terms(f.ring_ptr(), std::move(remainder), f.domain()) };
+        for (auto& q : quotients) result.quotients.push_back(Poly::from_terms(f.ring_ptr(), std::move(q), f.domain()));
+        return result;
+    }
+
+    template <class Domain>
+    std::vector<BasicSparsePolynomial<Domain>> groebner_basis(const std::vector<BasicSparsePolynomial<Domain>>& generators,
+                                                              MonomialOrder order) {
+        if (generators.empty()) return {};
+        for (const auto& g : generators) {
+            if (!(g.ring() == generators.front().ring()) || !(g.domain() == generators.front().domain()))
+                throw std::invalid_argument("groebner_basis: polynomials in different rings");
+        }
+        F4<Domain> engine(generators.front().ring_ptr(), generators.front().domain(), order);
+        return engine.run(generators);
+    }
+
+    template Exponents leading_monomial(const SparsePolynomial&, MonomialOrder);
+    template Exponents leading_monomial(const IntegerPolynomial&, MonomialOrder);
+    template Exponents leading_monomial(const RationalPolynomial&, MonomialOrder);
+    template Exponents leading_monomial(const ModularPolynomial&, MonomialOrder);
+    template Reduction<RealField> reduce(const SparsePolynomial&, const std::vector<SparsePolynomial>&, MonomialOrder);
+    template Reduction<RationalField> reduce(const RationalPolynomial&, const std::vector<RationalPolynomial>&, MonomialOrder);
+    template Reduction<ModularField> reduce(const ModularPolynomial&, const std::vector<ModularPolynomial>&, MonomialOrder);
+    template std::vector<RationalPolynomial> groebner_basis(const std::vector<RationalPolynomial>&, MonomialOrder);
+    template std::vector<ModularPolynomial> groebner_basis(const std::vector<ModularPolynomial>&, MonomialOrder);
+
+} // namespace aleph3
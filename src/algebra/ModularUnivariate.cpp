@@ -0,0 +1,204 @@
+#include "algebra/ModularUnivariate.hpp"
+#include "algebra/DenseMultiply.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace aleph3::modular {
+
+    namespace {
+        // Largest length * (max representative)^2 for which Karatsuba and Toom-3 on
+        // doubles stay exact, with room for their evaluation-point growth
+        constexpr double EXACT_DOUBLE_PRODUCTS = 9007199254740992.0 / 64;
+
+        // Whether sums of this many products of representatives fit in 64 bits, so they
+        // can be accumulated plainly and reduced once
+        bool accumulates(const ModularField& field, size_t terms) {
+            const uint64_t largest = field.modulus() - 1;
+            return largest <= UINT32_MAX && terms <= UINT64_MAX / (largest * largest);
+        }
+
+        Poly schoolbook(const ModularField& field, const Poly& a, const Poly& b) {
+            if (accumulates(field, std::min(a.size(), b.size()))) {
+                std::vector<uint64_t> sums(a.size() + b.size() - 1, 0);
+                for (size_t i = 0; i < a.size(); ++i) {
+                    for (size_t j = 0; j < b.size(); ++j) sums[i + j] += a[i] * b[j];
+                }
+                Poly out(sums.size());
+                for (size_t k = 0; k < sums.size(); ++k) out[k] = field.reduce_sum(sums[k]);
+                return out;
+            }
+            Poly out(a.size() + b.size() - 1, 0);
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i] == 0) continue;
+                for (size_t j = 0; j < b.size(); ++j) out[i + j] = field.add(out[i + j], field.mul(a[i], b[j]));
+            }
+            return out;
+        }
+
+        std::vector<double> representatives(const ModularField& field, const Poly& a) {
+            std::vector<double> out(a.size());
+            for (size_t i = 0; i < a.size(); ++i) out[i] = static_cast<double>(field.to_uint(a[i]));
+            return out;
+        }
+    }
+
+    void trim(Poly& a) {
+        while (!a.empty() && a.back() == 0) a.pop_back();
+    }
+
+    Poly add(const ModularField& field, const Poly& a, const Poly& b) {
+        Poly out(std::max(a.size(), b.size()), 0);
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = field.add(i < a.size() ? a[i] : 0, i < b.size() ? b[i] : 0);
+        }
+        trim(out);
+        return out;
+    }
+
+    Poly sub(const ModularField& field, const Poly& a, const Poly& b) {
+        Poly out(std::max(a.size(), b.size()), 0);
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = field.sub(i < a.size() ? a[i] : 0, i < b.size() ? b[i] : 0);
+        }
+        trim(out);
+        return out;
+    }
+
+    Poly mul(const ModularField& field, const Poly& a, const Poly& b) {
+        if (a.empty() || b.empty()) return {};
+        const size_t shorter = std::min(a.size(), b.size());
+        Poly out;
+        if (shorter >= dense::KARATSUBA_LENGTH) {
+            const double largest = static_cast<double>(field.modulus() - 1);
+            const auto ra = representatives(field, a), rb = representatives(field, b);
+            std::vector<double> product;
+            if (largest * largest * static_cast<double>(shorter) < EXACT_DOUBLE_PRODUCTS) product = dense::multiply(ra, rb);
+            else if (dense::ntt_exact(ra, rb)) product = dense::multiply(ra, rb, dense::Method::NTT);
+            if (!product.empty()) {
+                out.resize(product.size());
+                for (size_t k = 0; k < product.size(); ++k) out[k] = field.from_uint(static_cast<uint64_t>(product[k]));
+            }
+        }
+        if (out.empty()) out = schoolbook(field, a, b);
+        trim(out);
+        return out;
+    }
+
+    Poly scale(const ModularField& field, Poly a, uint64_t factor) {
+        for (auto& c : a) c = field.mul(c, factor);
+        trim(a);
+        return a;
+    }
+
+    std::pair<Poly, Poly> divmod(const ModularField& field, const Poly& a, const Poly& b) {
+        if (b.empty()) throw std::domain_error("Polynomial division by zero");
+        if (a.size() < b.size()) return { {}, a };
+        Poly r = a;
+        Poly q(a.size() - b.size() + 1, 0);
+        const uint64_t lead_inv = field.inverse(b.back());
+        for (size_t k = q.size(); k-- > 0;) {
+            const uint64_t factor = field.mul(r[k + b.size() - 1], lead_inv);
+            q[k] = factor;
+            if (factor == 0) continue;
+            for (size_t j = 0; j < b.size(); ++j) r[k + j] = field.sub(r[k + j], field.mul(factor, b[j]));
+        }
+        r.resize(b.size() - 1);
+        trim(r);
+        trim(q);
+        return { std::move(q), std::move(r) };
+    }
+
+    Poly rem(const ModularField& field, Poly a, const Poly& b) {
+        if (b.empty()) throw std::domain_error("Polynomial division by zero");
+        if (a.size() < b.size()) return a;
+        const uint64_t lead_inv = field.inverse(b.back());
+        if (accumulates(field, b.size())) {
+            // Each coefficient collects at most deg b products before it is read
+            std::vector<uint64_t> sums(a.size(), 0);
+            const auto settle = [&](size_t i) { return field.sub(a[i], field.reduce_sum(sums[i])); };
+            for (size_t k = a.size() - b.size() + 1; k-- > 0;) {
+                const uint64_t factor = field.mul(settle(k + b.size() - 1), lead_inv);
+                if (factor == 0) continue;
+                for (size_t j = 0; j + 1 < b.size(); ++j) sums[k + j] += factor * b[j];
+            }
+            for (size_t i = 0; i + 1 < b.size(); ++i) a[i] = settle(i);
+        } else {
+            for (size_t k = a.size() - b.size() + 1; k-- > 0;) {
+                const uint64_t factor = field.mul(a[k + b.size() - 1], lead_inv);
+                if (factor == 0) continue;
+                for (size_t j = 0; j < b.size(); ++j) a[k + j] = field.sub(a[k + j], field.mul(factor, b[j]));
+            }
+        }
+        a.resize(b.size() - 1);
+        trim(a);
+        return a;
+    }
+
+    Poly monic(const ModularField& field, Poly a) {
+        if (a.empty()) return a;
+        const uint64_t lead_inv = field.inverse(a.back());
+        return scale(field, std::move(a), lead_inv);
+    }
+
+    Poly gcd(const ModularField& field, Poly a, Poly b) {
+        while (!b.empty()) {
+            Poly r = rem(field, std::move(a), b);
+            a = std::move(b);
+            b = std::move(r);
+        }
+        return monic(field, std::move(a));
+    }
+
+    Poly extended_gcd(const ModularField& field, const Poly& a, const Poly& b, Poly& s, Poly& t) {
+        // Invariants: r0 = s0 * a + t0 * b and r1 = s1 * a + t1 * b
+        Poly r0 = a, r1 = b;
+        Poly s0{ field.one() }, s1, t0, t1{ field.one() };
+        while (!r1.empty()) {
+            auto [q, r] = divmod(field, r0, r1);
+            Poly s2 = sub(field, s0, mul(field, q, s1));
+            Poly t2 = sub(field, t0, mul(field, q, t1));
+            r0 = std::move(r1);
+            r1 = std::move(r);
+            s0 = std::move(s1);
+            s1 = std::move(s2);
+            t0 = std::move(t1);
+            t1 = std::move(t2);
+        }
+        if (r0.empty()) {
+            s.clear();
+            t.clear();
+            return r0;
+        }
+        const uint64_t lead_inv = field.inverse(r0.back());
+        s = scale(field, std::move(s0), lead_inv);
+        t = scale(field, std::move(t0), lead_inv);
+        return scale(field, std::move(r0), lead_inv);
+    }
+
+    uint64_t evaluate(const ModularField& field, const Poly& a, uint64_t x) {
+        uint64_t value = 0;
+        for (size_t k = a.size(); k-- > 0;) value = field.add(field.mul(value, x), a[k]);
+        return value;
+    }
+
+    Poly derivative(const ModularField& field, const Poly& a) {
+        if (a.size() <= 1) return {};
+        Poly out(a.size() - 1);
+        for (size_t k = 1; k < a.size(); ++k) out[k - 1] = field.mul(a[k], field.from_uint(k));
+        trim(out);
+        return out;
+    }
+
+    Poly powmod(const ModularField& field, Poly base, uint64_t exponent, const Poly& m) {
+        Poly result = rem(field, Poly{ field.one() }, m);
+        base = rem(field, std::move(base), m);
+        for (; exponent; exponent >>= 1) {
+            if (exponent & 1) result = rem(field, mul(field, result, base), m);
+            if (exponent > 1) base = rem(field, mul(field, base, base), m);
+        }
+        return result;
+    }
+
+} // namespace aleph3::modular
@@ -1,66 +1,158 @@
 #include "algebra/PolyUtils.hpp"
 #include "algebra/Polynomial.hpp"
+#include "algebra/PolynomialFactor.hpp"
+#include "algebra/PolynomialGcd.hpp"
+#include "algebra/PolynomialEvaluate.hpp"
+#include "algebra/PolynomialCoefficients.hpp"
+#include "algebra/RationalFunction.hpp"
+#include "algebra/Resultant.hpp"
 #include "expr/Expr.hpp"
 #include "expr/ExprUtils.hpp"
+#include "expr/PackedArray.hpp"
 #include <stdexcept>
+#include <optional>
 #include <utility>
 #include <set>
+#include <unordered_set>
 #include <algorithm>
 #include <functional>
+#include <cmath>
+#include <cstdint>
 
 namespace aleph3 {
 
     // --- Conversion utilities ---
 
-    // Convert ExprPtr to Polynomial (supports multivariate, basic Plus/Times/Power/Number/Symbol)
-    Polynomial expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables) {
-        if (!expr) throw std::runtime_error("Null expression");
+    namespace {
+        // Which ring expr_to_polynomial picks: the loosest one any number in expr needs
+        enum class CoefficientKind { Integer, Rational, Real };
 
-        // Helper: build a monomial from a variable->exponent map
-        auto make_monomial = [&](const std::map<std::string, int>& exps) -> Monomial {
-            Monomial m;
-            for (const auto& v : variables) {
-                auto it = exps.find(v);
-                if (it != exps.end() && it->second != 0)
-                    m[v] = it->second;
+        CoefficientKind coefficient_kind(const ExprPtr& expr) {
+            CoefficientKind kind = CoefficientKind::Integer;
+            std::vector<const Expr*> stack{ expr.get() };
+            while (!stack.empty()) {
+                const Expr* e = stack.back();
+                stack.pop_back();
+                if (auto num = std::get_if<Number>(e)) {
+                    if (!std::isfinite(num->value) || std::floor(num->value) != num->value) return CoefficientKind::Real;
+                }
+                else if (auto rat = std::get_if<Rational>(e)) {
+                    if (rat->denominator != 1) kind = CoefficientKind::Rational;
+                }
+                else if (auto func = std::get_if<FunctionCall>(e)) {
+                    for (const auto& arg : func->args) {
+                        if (arg) stack.push_back(arg.get());
+                    }
+                }
             }
-            return m;
+            return kind;
+        }
+
+        ExprPtr coefficient_expr(const RealField&, double c) { return make_expr<Number>(c); }
+        ExprPtr coefficient_expr(const IntegerRing&, const BigInt& c) { return make_expr<Number>(c.to_double()); }
+        ExprPtr coefficient_expr(const RationalField&, const Fraction& c) {
+            if (c.den == 1) return make_expr<Number>(c.num.to_double());
+            return make_expr<Rational>(c.num, c.den);
+        }
+        ExprPtr coefficient_expr(const ModularField& field, uint64_t c) {
+            return make_expr<Number>(static_cast<double>(field.to_uint(c)));
+        }
+    }
+
+    // Convert ExprPtr to a polynomial in the ring of `variables` (Plus/Times/Power/Number/Rational/Symbol)
+    template <class Domain>
+    BasicSparsePolynomial<Domain> expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, Domain domain) {
+        using Poly = BasicSparsePolynomial<Domain>;
+        if (!expr) throw std::runtime_error("Null expression");
+        const auto ring = std::make_shared<const PolynomialRing>(variables);
+
+        auto variable = [&](const Symbol& sym, uint32_t exponent) {
+            auto index = ring->index_of(sym.name);
+            if (!index) throw std::runtime_error("expr_to_polynomial: " + sym.name.str() + " is not a ring variable");
+            return Poly::variable(ring, *index, exponent, domain);
+        };
+
+        // A product of numbers and powers of ring variables, as an expansion's terms are,
+        // read as one term without multiplying polynomials
+        auto monomial = [&](const ExprPtr& e) -> std::optional<typename Poly::Term> {
+            typename Poly::Term term{ Exponents{}, domain.one() };
+            auto factor = [&](const ExprPtr& f) {
+                if (auto num = std::get_if<Number>(&*f)) {
+                    term.coeff = domain.mul(term.coeff, domain.from_number(num->value));
+                    return true;
+                }
+                if (auto rat = std::get_if<Rational>(&*f)) {
+                    term.coeff = domain.mul(term.coeff, domain.from_rational(rat->numerator, rat->denominator));
+                    return true;
+                }
+                const Symbol* sym = std::get_if<Symbol>(&*f);
+                uint32_t exponent = 1;
+                if (auto pow = std::get_if<FunctionCall>(&*f); pow && pow->head == atoms::Power && pow->args.size() == 2) {
+                    sym = std::get_if<Symbol>(&*pow->args[0]);
+                    auto n = std::get_if<Number>(&*pow->args[1]);
+                    if (!n || n->value < 0 || n->value > UINT32_MAX || std::floor(n->value) != n->value) return false;
+                    exponent = static_cast<uint32_t>(n->value);
+                }
+                if (!sym) return false;
+                auto index = ring->index_of(sym->name);
+                if (!index) return false;
+                term.exponents = ring->multiply(term.exponents, ring->power_of(*index, exponent));
+                return true;
             };
+            auto times = std::get_if<FunctionCall>(&*e);
+            if (!times || times->head != atoms::Times) return std::nullopt;
+            // Nested products, as polynomial_to_expr writes them, are read in the same pass
+            std::vector<const FunctionCall*> products{ times };
+            while (!products.empty()) {
+                const FunctionCall* product = products.back();
+                products.pop_back();
+                for (const auto& arg : product->args) {
+                    if (auto inner = std::get_if<FunctionCall>(&*arg); inner && inner->head == atoms::Times) products.push_back(inner);
+                    else if (!factor(arg)) return std::nullopt;
+                }
+            }
+            return term;
+        };
 
         // Recursive lambda
-        std::function<Polynomial(const ExprPtr&)> recur = [&](const ExprPtr& e) -> Polynomial {
+        std::function<Poly(const ExprPtr&)> recur = [&](const ExprPtr& e) -> Poly {
             if (auto num = std::get_if<Number>(&(*e))) {
-                return Polynomial(static_cast<double>(num->value));
+                return Poly::constant(ring, domain.from_number(num->value), domain);
+            }
+            if (auto rat = std::get_if<Rational>(&(*e))) {
+                return Poly::constant(ring, domain.from_rational(rat->numerator, rat->denominator), domain);
             }
             if (auto sym = std::get_if<Symbol>(&(*e))) {
-                std::map<std::string, int> exps;
-                exps[sym->name] = 1;
-                return Polynomial({ {make_monomial(exps), 1.0} });
+                return variable(*sym, 1);
             }
-            if (auto plus = std::get_if<FunctionCall>(&(*e)); plus && plus->head == "Plus") {
-                Polynomial result;
+            if (auto plus = std::get_if<FunctionCall>(&(*e)); plus && plus->head == atoms::Plus) {
+                // Every summand first, then one merge, rather than a pass per summand. Monomial
+                // summands are gathered into a single part, sorted once.
+                std::vector<Poly> parts;
+                std::vector<typename Poly::Term> monomials;
                 for (const auto& arg : plus->args) {
-                    result = result + recur(arg);
+                    if (auto term = monomial(arg)) monomials.push_back(std::move(*term));
+                    else parts.push_back(recur(arg));
                 }
-                return result;
+                if (!monomials.empty()) parts.push_back(Poly::from_terms(ring, std::move(monomials), domain));
+                return Poly::sum(ring, std::move(parts), domain);
             }
-            if (auto times = std::get_if<FunctionCall>(&(*e)); times && times->head == "Times") {
-                Polynomial result(1.0);
+            if (auto times = std::get_if<FunctionCall>(&(*e)); times && times->head == atoms::Times) {
+                Poly result = Poly::constant(ring, domain.one(), domain);
                 for (const auto& arg : times->args) {
-                    result = result * recur(arg);
+                    result *= recur(arg);
                 }
                 return result;
             }
-            if (auto pow = std::get_if<FunctionCall>(&(*e)); pow && pow->head == "Power") {
+            if (auto pow = std::get_if<FunctionCall>(&(*e)); pow && pow->head == atoms::Power) {
                 if (pow->args.size() == 2) {
                     auto base = pow->args[0];
                     auto exp = pow->args[1];
-                    if (auto s = std::get_if<Symbol>(&(*base))) {
-                        if (auto n = std::get_if<Number>(&(*exp))) {
-                            std::map<std::string, int> exps;
-                            exps[s->name] = static_cast<int>(n->value);
-                            return Polynomial({ {make_monomial(exps), 1.0} });
-                        }
+                    auto n = std::get_if<Number>(&(*exp));
+                    if (n && n->value >= 0 && n->value <= UINT32_MAX && std::floor(n->value) == n->value) {
+                        const auto exponent = static_cast<uint32_t>(n->value);
+                        if (auto s = std::get_if<Symbol>(&(*base))) return variable(*s, exponent);
+                        return power(recur(base), exponent);
                     }
                 }
             }
@@ -70,6 +162,46 @@ namespace aleph3 {
         return recur(expr);
     }
 
+    AnyPolynomial expr_to_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables) {
+        if (!expr) throw std::runtime_error("Null expression");
+        switch (coefficient_kind(expr)) {
+        case CoefficientKind::Integer:  return expr_to_polynomial<IntegerRing>(expr, variables);
+        case CoefficientKind::Rational: return expr_to_polynomial<RationalField>(expr, variables);
+        case CoefficientKind::Real:     break;
+        }
+        return expr_to_polynomial<RealField>(expr, variables);
+    }
+
+    // Convert a polynomial to ExprPtr: a sum of terms from the lowest monomial up
+    template <class Domain>
+    ExprPtr polynomial_to_expr(const BasicSparsePolynomial<Domain>& poly) {
+        const auto& ring = poly.ring();
+        std::vector<ExprPtr> terms;
+        terms.reserve(poly.size());
+        for (auto it = poly.terms().rbegin(); it != poly.terms().rend(); ++it) {
+            ExprPtr term = coefficient_expr(poly.domain(), it->coeff);
+            for (size_t v = 0; v < ring.size(); ++v) {
+                const uint32_t exp = ring.exponent(it->exponents, v);
+                if (exp == 0) continue;
+                ExprPtr var = make_expr<Symbol>(ring.variables()[v]);
+                if (exp == 1) {
+                    term = make_fcall(atoms::Times, { term, var });
+                }
+                else {
+                    term = make_fcall(atoms::Times, { term, make_fcall(atoms::Power, {var, make_expr<Number>(static_cast<double>(exp))}) });
+                }
+            }
+            terms.push_back(term);
+        }
+        if (terms.empty()) return make_expr<Number>(0.0);
+        if (terms.size() == 1) return terms[0];
+        return make_expr<FunctionCall>(atoms::Plus, terms);
+    }
+
+    ExprPtr polynomial_to_expr(const AnyPolynomial& poly) {
+        return std::visit([](const auto& p) { return polynomial_to_expr(p); }, poly);
+    }
+
     // Convert Polynomial to ExprPtr (sum of terms, supports multivariate)
     ExprPtr polynomial_to_expr(const Polynomial& poly) {
         std::vector<ExprPtr> terms;
@@ -79,80 +211,518 @@ namespace aleph3 {
             for (const auto& [var, exp] : mono) {
                 ExprPtr v = make_expr<Symbol>(var);
                 if (exp == 1) {
-                    term = make_fcall("Times", { term, v });
+                    term = make_fcall(atoms::Times, { term, v });
                 }
                 else {
-                    term = make_fcall("Times", { term, make_fcall("Power", {v, make_expr<Number>(static_cast<double>(exp))}) });
+                    term = make_fcall(atoms::Times, { term, make_fcall(atoms::Power, {v, make_expr<Number>(static_cast<double>(exp))}) });
                 }
             }
             terms.push_back(term);
         }
         if (terms.empty()) return make_expr<Number>(0.0);
         if (terms.size() == 1) return terms[0];
-        return make_expr<FunctionCall>("Plus", terms);
+        return make_expr<FunctionCall>(atoms::Plus, terms);
+    }
+
+    template <class Domain>
+    Polynomial to_polynomial(const BasicSparsePolynomial<Domain>& poly) {
+        const auto& ring = poly.ring();
+        std::map<Monomial, double> terms;
+        for (const auto& t : poly.terms()) {
+            Monomial m;
+            for (size_t v = 0; v < ring.size(); ++v) {
+                if (const uint32_t exp = ring.exponent(t.exponents, v)) m[ring.variables()[v]] = static_cast<int>(exp);
+            }
+            terms[m] = poly.domain().to_double(t.coeff);
+        }
+        return Polynomial(terms);
+    }
+
+    Polynomial to_polynomial(const AnyPolynomial& poly) {
+        return std::visit([](const auto& p) { return to_polynomial(p); }, poly);
+    }
+
+    template SparsePolynomial expr_to_polynomial(const ExprPtr&, const std::vector<std::string>&, RealField);
+    template IntegerPolynomial expr_to_polynomial(const ExprPtr&, const std::vector<std::string>&, IntegerRing);
+    template RationalPolynomial expr_to_polynomial(const ExprPtr&, const std::vector<std::string>&, RationalField);
+    template ModularPolynomial expr_to_polynomial(const ExprPtr&, const std::vector<std::string>&, ModularField);
+    template ExprPtr polynomial_to_expr(const SparsePolynomial&);
+    template ExprPtr polynomial_to_expr(const IntegerPolynomial&);
+    template ExprPtr polynomial_to_expr(const RationalPolynomial&);
+    template ExprPtr polynomial_to_expr(const ModularPolynomial&);
+    template Polynomial to_polynomial(const SparsePolynomial&);
+    template Polynomial to_polynomial(const IntegerPolynomial&);
+    template Polynomial to_polynomial(const RationalPolynomial&);
+    template Polynomial to_polynomial(const ModularPolynomial&);
+
+    std::vector<std::string> infer_variables(const ExprPtr& expr) {
+        std::unordered_set<const Expr*> seen_nodes;
+        std::unordered_set<Atom> seen_symbols;
+        std::vector<const Expr*> stack;
+        if (expr) stack.push_back(expr.get());
+        while (!stack.empty()) {
+            const Expr* e = stack.back();
+            stack.pop_back();
+            if (auto sym = std::get_if<Symbol>(e)) {
+                seen_symbols.insert(sym->name);
+            }
+            else if (auto func = std::get_if<FunctionCall>(e)) {
+                // Repeated subtrees (e.g. from hash-consing) share a node; walk each node once
+                if (!seen_nodes.insert(e).second) continue;
+                for (const auto& arg : func->args) {
+                    if (arg) stack.push_back(arg.get());
+                }
+            }
+        }
+        std::vector<std::string> variables;
+        variables.reserve(seen_symbols.size());
+        for (Atom a : seen_symbols) variables.push_back(a.str());
+        std::sort(variables.begin(), variables.end());
+        return variables;
     }
 
     // --- High-level API ---
 
     ExprPtr expand_polynomial(const ExprPtr& expr, EvaluationContext& ctx) {
         // Try to infer variables from expr (collect all symbols)
-        std::set<std::string> vars;
-        std::function<void(const ExprPtr&)> visit = [&](const ExprPtr& e) {
-            if (!e) return;
-            if (auto sym = std::get_if<Symbol>(&(*e))) {
-                vars.insert(sym->name);
+        auto variables = infer_variables(expr);
+
+        // Products and sums are expanded as they are converted
+        return polynomial_to_expr(expr_to_polynomial(expr, variables));
+    }
+
+    namespace {
+        // poly times `scale`, the lcm of its denominators, or nullopt for real coefficients
+        std::optional<IntegerPolynomial> integral_multiple(const AnyPolynomial& poly, BigInt& scale) {
+            scale = 1;
+            if (auto p = std::get_if<IntegerPolynomial>(&poly)) return *p;
+            auto q = std::get_if<RationalPolynomial>(&poly);
+            if (!q) return std::nullopt;
+            for (const auto& t : q->terms()) scale = scale / gcd(scale, t.coeff.den) * t.coeff.den;
+            std::vector<IntegerPolynomial::Term> terms;
+            terms.reserve(q->size());
+            for (const auto& t : q->terms()) terms.push_back({ t.exponents, t.coeff.num * (scale / t.coeff.den) });
+            return IntegerPolynomial::from_terms(q->ring_ptr(), std::move(terms));
+        }
+
+        // unit / scale times the product of the factors' powers
+        ExprPtr factorization_to_expr(const Factorization& f, const BigInt& scale) {
+            auto [num, den] = normalize_rational(f.unit, scale);
+            ExprPtr unit = den == 1 ? make_expr<Number>(num.to_double()) : make_expr<Rational>(num, den);
+            if (f.factors.empty()) return unit;
+
+            std::vector<ExprPtr> args;
+            if (!(num == 1 && den == 1)) args.push_back(unit);
+            for (const auto& [g, e] : f.factors) {
+                ExprPtr base = polynomial_to_expr(g);
+                args.push_back(e == 1 ? base : make_fcall(atoms::Power, { base, make_expr<Number>(static_cast<double>(e)) }));
             }
-            else if (auto func = std::get_if<FunctionCall>(&(*e))) {
-                for (const auto& arg : func->args) visit(arg);
+            if (args.size() == 1) return args.front();
+            return make_expr<FunctionCall>(atoms::Times, args);
+        }
+    }
+
+    // Exact inputs are factored over Z, after clearing denominators; real ones come back
+    // expanded
+    ExprPtr factor_polynomial(const ExprPtr& expr, EvaluationContext&) {
+        auto variables = infer_variables(expr);
+
+        AnyPolynomial poly = expr_to_polynomial(expr, variables);
+        BigInt scale;
+        auto integral = integral_multiple(poly, scale);
+        if (!integral) return polynomial_to_expr(poly);
+        return factorization_to_expr(factor(*integral), scale);
+    }
+
+    namespace {
+        // The ring for viewing expr in the distinct variables `main`: those first, in their
+        // order, then the other symbols of expr, sorted
+        std::vector<std::string> main_variables_first(const ExprPtr& expr, const std::vector<std::string>& main) {
+            std::vector<std::string> variables = main;
+            for (auto& v : infer_variables(expr)) {
+                if (std::find(main.begin(), main.end(), v) == main.end()) variables.push_back(std::move(v));
             }
-            };
-        visit(expr);
-        std::vector<std::string> variables(vars.begin(), vars.end());
+            return variables;
+        }
 
-        Polynomial poly = expr_to_polynomial(expr, variables);
-        Polynomial expanded = expand(poly);
-        return polynomial_to_expr(expanded);
+        // `variables` without repeats, in the order of their first appearance
+        std::vector<std::string> distinct(const std::vector<std::string>& variables) {
+            std::vector<std::string> out;
+            for (const auto& v : variables) {
+                if (std::find(out.begin(), out.end(), v) == out.end()) out.push_back(v);
+            }
+            return out;
+        }
+
+        // coefficient * variable^exponent, without factors of 1
+        ExprPtr times_power(ExprPtr coefficient, const std::string& variable, uint32_t exponent) {
+            if (exponent == 0) return coefficient;
+            ExprPtr power = make_expr<Symbol>(variable);
+            if (exponent > 1) power = make_fcall(atoms::Power, { power, make_expr<Number>(static_cast<double>(exponent)) });
+            if (auto n = std::get_if<Number>(coefficient.get()); n && n->value == 1.0) return power;
+            return make_fcall(atoms::Times, { std::move(coefficient), std::move(power) });
+        }
+
+        // The collected form of groups[begin, end), which agree on the exponents of the main
+        // variables before `level`: one term per exponent of main[level], the lowest first
+        template <class Domain>
+        ExprPtr collected_expr(const std::vector<CoefficientGroup<Domain>>& groups, size_t begin, size_t end, size_t level,
+                               const std::vector<std::string>& main) {
+            if (level == main.size()) return polynomial_to_expr(groups[begin].coefficient);
+            std::vector<ExprPtr> terms;
+            for (size_t i = begin; i < end;) {
+                const uint32_t exponent = groups[i].exponents[level];
+                size_t j = i;
+                while (j < end && groups[j].exponents[level] == exponent) ++j;
+                terms.push_back(times_power(collected_expr(groups, i, j, level + 1, main), main[level], exponent));
+                i = j;
+            }
+            std::reverse(terms.begin(), terms.end());
+            if (terms.size() == 1) return terms[0];
+            return make_expr<FunctionCall>(atoms::Plus, terms);
+        }
+
+        // f(groups) on expr in the ring with `main` first
+        template <class F>
+        ExprPtr with_groups(const ExprPtr& expr, const std::vector<std::string>& main, F f) {
+            const AnyPolynomial poly = expr_to_polynomial(expr, main_variables_first(expr, main));
+            return std::visit([&](const auto& p) { return f(group_by_main_variables(p, main.size())); }, poly);
+        }
     }
 
-    ExprPtr factor_polynomial(const ExprPtr& expr, EvaluationContext& ctx) {
-        std::set<std::string> vars;
-        std::function<void(const ExprPtr&)> visit = [&](const ExprPtr& e) {
-            if (!e) return;
-            if (auto sym = std::get_if<Symbol>(&(*e))) {
-                vars.insert(sym->name);
+    ExprPtr collect_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, EvaluationContext&) {
+        const auto main = distinct(variables);
+        return with_groups(expr, main, [&](const auto& groups) -> ExprPtr {
+            if (groups.empty()) return make_expr<Number>(0.0);
+            return collected_expr(groups, 0, groups.size(), 0, main);
+        });
+    }
+
+    ExprPtr coefficient_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables,
+                                   const std::vector<uint32_t>& exponents, EvaluationContext&) {
+        // Repeated variables multiply: x * x is x^2
+        std::vector<std::string> main;
+        std::vector<uint32_t> wanted;
+        for (size_t i = 0; i < variables.size(); ++i) {
+            auto it = std::find(main.begin(), main.end(), variables[i]);
+            if (it == main.end()) {
+                main.push_back(variables[i]);
+                wanted.push_back(exponents[i]);
             }
-            else if (auto func = std::get_if<FunctionCall>(&(*e))) {
-                for (const auto& arg : func->args) visit(arg);
+            else {
+                wanted[it - main.begin()] += exponents[i];
             }
-            };
-        visit(expr);
-        std::vector<std::string> variables(vars.begin(), vars.end());
+        }
+        return with_groups(expr, main, [&](const auto& groups) -> ExprPtr {
+            for (const auto& g : groups) {
+                if (g.exponents == wanted) return polynomial_to_expr(g.coefficient);
+            }
+            return make_expr<Number>(0.0);
+        });
+    }
 
-        Polynomial poly = expr_to_polynomial(expr, variables);
-        Polynomial factored = factor(poly);
-        return polynomial_to_expr(factored);
+    ExprPtr coefficient_list_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, EvaluationContext&) {
+        const auto main = distinct(variables);
+        if (main.empty()) throw std::runtime_error("CoefficientList expects at least one variable");
+        return with_groups(expr, main, [&](const auto& groups) -> ExprPtr {
+            if (groups.empty()) return make_fcall(atoms::List, {});
+
+            // Row-major dense array over the exponent box, the first variable outermost
+            std::vector<size_t> extent(main.size(), 1);
+            for (const auto& g : groups) {
+                for (size_t v = 0; v < main.size(); ++v) extent[v] = std::max<size_t>(extent[v], g.exponents[v] + size_t(1));
+            }
+            std::vector<size_t> stride(main.size(), 1);
+            for (size_t v = main.size() - 1; v > 0; --v) stride[v - 1] = stride[v] * extent[v];
+            std::vector<ExprPtr> dense(stride[0] * extent[0]);
+            for (const auto& g : groups) {
+                size_t at = 0;
+                for (size_t v = 0; v < main.size(); ++v) at += g.exponents[v] * stride[v];
+                dense[at] = polynomial_to_expr(g.coefficient);
+            }
+            const ExprPtr zero = make_expr<Number>(0.0);
+            for (auto& c : dense) {
+                if (!c) c = zero;
+            }
+
+            std::function<ExprPtr(size_t, size_t)> nest = [&](size_t level, size_t offset) -> ExprPtr {
+                std::vector<ExprPtr> elements;
+                elements.reserve(extent[level]);
+                for (size_t i = 0; i < extent[level]; ++i) {
+                    const size_t at = offset + i * stride[level];
+                    elements.push_back(level + 1 == main.size() ? dense[at] : nest(level + 1, at));
+                }
+                return make_fcall(atoms::List, std::move(elements));
+            };
+            return nest(0, 0);
+        });
     }
 
-    ExprPtr collect_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, EvaluationContext& ctx) {
-        Polynomial poly = expr_to_polynomial(expr, variables);
-        Polynomial collected = collect(poly, variables);
-        return polynomial_to_expr(collected);
+    ExprPtr exponent_polynomial(const ExprPtr& expr, const std::string& variable, EvaluationContext&) {
+        return with_groups(expr, { variable }, [&](const auto& groups) -> ExprPtr {
+            // Groups come in decreasing order of the exponent
+            if (groups.empty()) return make_fcall(atoms::Negate, { make_expr<Infinity>() });
+            return make_expr<Number>(static_cast<double>(groups.front().exponents[0]));
+        });
     }
 
+    // Exact inputs take the modular gcd; rational ones are first scaled to integers, so
+    // their gcd comes back primitive. Real ones keep the univariate Euclidean sequence.
     ExprPtr gcd_polynomial(const ExprPtr& a, const ExprPtr& b, const std::vector<std::string>& variables, EvaluationContext& ctx) {
-        Polynomial pa = expr_to_polynomial(a, variables);
-        Polynomial pb = expr_to_polynomial(b, variables);
-        Polynomial g = gcd(pa, pb, variables);
+        AnyPolynomial pa = expr_to_polynomial(a, variables);
+        AnyPolynomial pb = expr_to_polynomial(b, variables);
+        BigInt sa, sb;
+        auto ia = integral_multiple(pa, sa), ib = integral_multiple(pb, sb);
+        if (ia && ib) return polynomial_to_expr(gcd(*ia, *ib));
+        Polynomial g = gcd(to_polynomial(pa), to_polynomial(pb), variables);
         return polynomial_to_expr(g);
     }
 
+    // Several variables take the division algorithm in lexicographic order, exactly unless
+    // an input is real
     std::pair<ExprPtr, ExprPtr> divide_polynomial(const ExprPtr& dividend, const ExprPtr& divisor, const std::vector<std::string>& variables, EvaluationContext& ctx) {
-        Polynomial pdiv = expr_to_polynomial(dividend, variables);
-        Polynomial pdis = expr_to_polynomial(divisor, variables);
+        if (variables.size() > 1 && coefficient_kind(dividend) != CoefficientKind::Real && coefficient_kind(divisor) != CoefficientKind::Real) {
+            auto result = reduce(expr_to_polynomial<RationalField>(dividend, variables), { expr_to_polynomial<RationalField>(divisor, variables) },
+                                 MonomialOrder::Lexicographic);
+            return { polynomial_to_expr(result.quotients.front()), polynomial_to_expr(result.remainder) };
+        }
+        Polynomial pdiv = to_polynomial(expr_to_polynomial(dividend, variables));
+        Polynomial pdis = to_polynomial(expr_to_polynomial(divisor, variables));
         auto result = divide(pdiv, pdis, variables);
         return { polynomial_to_expr(result.first), polynomial_to_expr(result.second) };
     }
 
+    namespace {
+        // poly over Q scaled to a primitive integer polynomial whose leading coefficient in
+        // `order` is positive
+        ExprPtr primitive_expr(const RationalPolynomial& poly, MonomialOrder order) {
+            if (poly.is_zero()) return make_expr<Number>(0.0);
+            BigInt scale;
+            IntegerPolynomial integral = *integral_multiple(AnyPolynomial(poly), scale);
+            BigInt content = 0;
+            for (const auto& t : integral.terms()) content = gcd(content, t.coeff);
+            if (integral.coefficient(leading_monomial(integral, order)).sign() < 0) content = -content;
+            std::vector<IntegerPolynomial::Term> terms;
+            terms.reserve(integral.size());
+            for (const auto& t : integral.terms()) terms.push_back({ t.exponents, t.coeff / content });
+            return polynomial_to_expr(IntegerPolynomial::from_terms(integral.ring_ptr(), std::move(terms)));
+        }
+
+        ExprPtr list_call(std::vector<ExprPtr> elements) {
+            return make_fcall(atoms::List, std::move(elements));
+        }
+
+        template <class Domain>
+        std::vector<BasicSparsePolynomial<Domain>> to_polynomials(const std::vector<ExprPtr>& polys, const std::vector<std::string>& variables,
+                                                                  Domain domain) {
+            std::vector<BasicSparsePolynomial<Domain>> out;
+            out.reserve(polys.size());
+            for (const auto& p : polys) out.push_back(expr_to_polynomial<Domain>(p, variables, domain));
+            return out;
+        }
+    }
+
+    ExprPtr groebner_basis_polynomial(const std::vector<ExprPtr>& polys, const std::vector<std::string>& variables,
+                                      MonomialOrder order, uint64_t modulus, EvaluationContext&) {
+        std::vector<ExprPtr> basis;
+        if (modulus != 0) {
+            for (const auto& g : groebner_basis(to_polynomials(polys, variables, ModularField(modulus)), order)) basis.push_back(polynomial_to_expr(g));
+        }
+        else {
+            for (const auto& g : groebner_basis(to_polynomials(polys, variables, RationalField()), order)) basis.push_back(primitive_expr(g, order));
+        }
+        return list_call(std::move(basis));
+    }
+
+    ExprPtr reduce_polynomial(const ExprPtr& f, const std::vector<ExprPtr>& divisors, const std::vector<std::string>& variables,
+                              MonomialOrder order, uint64_t modulus, EvaluationContext&) {
+        auto result_of = [&](auto domain) {
+            auto reduction = reduce(expr_to_polynomial(f, variables, domain), to_polynomials(divisors, variables, domain), order);
+            std::vector<ExprPtr> quotients;
+            for (const auto& q : reduction.quotients) quotients.push_back(polynomial_to_expr(q));
+            return list_call({ list_call(std::move(quotients)), polynomial_to_expr(reduction.remainder) });
+        };
+        if (modulus != 0) return result_of(ModularField(modulus));
+        return result_of(RationalField());
+    }
+
+    namespace {
+        // expr over Q times `scale`, the lcm of its denominators
+        IntegerPolynomial integral_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, BigInt& scale) {
+            return *integral_multiple(AnyPolynomial(expr_to_polynomial<RationalField>(expr, variables)), scale);
+        }
+
+        ExprPtr divided_expr(const IntegerPolynomial& p, const BigInt& scale) {
+            if (scale == 1) return polynomial_to_expr(p);
+            const RationalField field;
+            std::vector<RationalPolynomial::Term> terms;
+            terms.reserve(p.size());
+            for (const auto& t : p.terms()) terms.push_back({ t.exponents, field.from_rational(t.coeff, scale) });
+            return polynomial_to_expr(RationalPolynomial::from_terms(p.ring_ptr(), std::move(terms)));
+        }
+
+        // The ring of x followed by the other symbols of a and b
+        std::vector<std::string> eliminating(const ExprPtr& a, const ExprPtr& b, const std::string& variable) {
+            return main_variables_first(make_fcall(atoms::List, { a, b }), { variable });
+        }
+    }
+
+    // Each coefficient is homogeneous in those of a and of b, so the scales come out as powers
+    ExprPtr resultant_polynomial(const ExprPtr& a, const ExprPtr& b, const std::string& variable, EvaluationContext&) {
+        const auto variables = eliminating(a, b, variable);
+        BigInt sa, sb;
+        const auto pa = integral_polynomial(a, variables, sa), pb = integral_polynomial(b, variables, sb);
+        return divided_expr(resultant(pa, pb, 0), pow(sa, pb.degree(0)) * pow(sb, pa.degree(0)));
+    }
+
+    ExprPtr discriminant_polynomial(const ExprPtr& f, const std::string& variable, EvaluationContext&) {
+        const auto variables = main_variables_first(f, { variable });
+        BigInt scale;
+        const auto p = integral_polynomial(f, variables, scale);
+        const uint32_t n = p.degree(0);
+        return divided_expr(discriminant(p, 0), n == 0 ? BigInt(1) : pow(scale, 2 * uint64_t(n) - 2));
+    }
+
+    ExprPtr subresultants_polynomial(const ExprPtr& a, const ExprPtr& b, const std::string& variable, EvaluationContext&) {
+        const auto variables = eliminating(a, b, variable);
+        BigInt sa, sb;
+        const auto pa = integral_polynomial(a, variables, sa), pb = integral_polynomial(b, variables, sb);
+        const uint64_t m = pa.degree(0), n = pb.degree(0);
+        std::vector<ExprPtr> coefficients;
+        const auto psc = principal_subresultants(pa, pb, 0);
+        for (size_t j = 0; j < psc.size(); ++j) coefficients.push_back(divided_expr(psc[j], pow(sa, n - j) * pow(sb, m - j)));
+        return list_call(std::move(coefficients));
+    }
+
+    namespace {
+        // expr in `ring`, with each operation done on rational functions
+        RationalFunction rational_function(const ExprPtr& expr, const std::shared_ptr<const PolynomialRing>& ring,
+                                           const std::string& caller) {
+            const std::runtime_error invalid(caller + " expects a rational function of symbols with exact coefficients");
+            auto constant = [&](const BigInt& value) { return RationalFunction(IntegerPolynomial::constant(ring, value)); };
+            std::function<RationalFunction(const ExprPtr&)> recur = [&](const ExprPtr& e) -> RationalFunction {
+                if (auto num = std::get_if<Number>(&*e)) {
+                    if (!std::isfinite(num->value) || std::floor(num->value) != num->value) throw invalid;
+                    return constant(BigInt::from_double(num->value));
+                }
+                if (auto rat = std::get_if<Rational>(&*e)) {
+                    return RationalFunction(IntegerPolynomial::constant(ring, rat->numerator), IntegerPolynomial::constant(ring, rat->denominator));
+                }
+                if (auto sym = std::get_if<Symbol>(&*e)) {
+                    return RationalFunction(IntegerPolynomial::variable(ring, *ring->index_of(sym->name)));
+                }
+                auto func = std::get_if<FunctionCall>(&*e);
+                if (!func || func->args.empty()) throw invalid;
+                const auto& args = func->args;
+                if (func->head == atoms::Plus || func->head == atoms::Times) {
+                    RationalFunction result = recur(args[0]);
+                    for (size_t i = 1; i < args.size(); ++i) {
+                        result = func->head == atoms::Plus ? result + recur(args[i]) : result * recur(args[i]);
+                    }
+                    return result;
+                }
+                if (func->head == atoms::Negate && args.size() == 1) return -recur(args[0]);
+                if (func->head == atoms::Minus && args.size() == 1) return -recur(args[0]);
+                if (func->head == atoms::Minus && args.size() == 2) return recur(args[0]) - recur(args[1]);
+                if (func->head == atoms::Divide && args.size() == 2) {
+                    const auto divisor = recur(args[1]);
+                    if (divisor.is_zero()) throw std::runtime_error(caller + ": division by zero");
+                    return recur(args[0]) / divisor;
+                }
+                if (func->head == atoms::Power && args.size() == 2) {
+                    auto n = std::get_if<Number>(&*args[1]);
+                    if (!n || std::floor(n->value) != n->value || std::abs(n->value) > UINT32_MAX) throw invalid;
+                    const auto base = recur(args[0]);
+                    if (n->value < 0 && base.is_zero()) throw std::runtime_error(caller + ": division by zero");
+                    return power(base, static_cast<int64_t>(n->value));
+                }
+                throw invalid;
+            };
+            return recur(expr);
+        }
+
+        // num / den, as Times[num, Power[den, -1]] unless den is an integer
+        ExprPtr rational_function_expr(const RationalFunction& f) {
+            const auto& den = f.denominator();
+            if (den.size() == 1 && den.terms().front().exponents == Exponents{}) return divided_expr(f.numerator(), den.terms().front().coeff);
+            return make_fcall(atoms::Times, { polynomial_to_expr(f.numerator()), make_fcall(atoms::Power, { polynomial_to_expr(den), make_expr<Number>(-1) }) });
+        }
+
+        ExprPtr reduced_expr(const ExprPtr& expr, const std::string& caller) {
+            const auto ring = std::make_shared<const PolynomialRing>(infer_variables(expr));
+            return rational_function_expr(rational_function(expr, ring, caller).normalize());
+        }
+    }
+
+    ExprPtr together_polynomial(const ExprPtr& expr, EvaluationContext&) {
+        return reduced_expr(expr, "Together");
+    }
+
+    ExprPtr cancel_polynomial(const ExprPtr& expr, EvaluationContext&) {
+        auto plus = std::get_if<FunctionCall>(&*expr);
+        if (!plus || plus->head != atoms::Plus) return reduced_expr(expr, "Cancel");
+        std::vector<ExprPtr> terms;
+        terms.reserve(plus->args.size());
+        for (const auto& arg : plus->args) terms.push_back(reduced_expr(arg, "Cancel"));
+        return make_fcall(atoms::Plus, std::move(terms));
+    }
+
+    namespace {
+        // Coordinates of the points, row-major, from a packed array or from nested lists of
+        // Numbers and Rationals; each point has `width` coordinates
+        std::vector<double> point_coordinates(const ExprPtr& points, size_t width) {
+            const std::runtime_error invalid("PolynomialEvaluate expects a list of points with " + std::to_string(width) +
+                                             (width == 1 ? " real coordinate" : " real coordinates"));
+            if (auto packed = std::get_if<PackedArray>(&*points)) {
+                const PackedData& data = *packed->data;
+                const bool shaped = width == 1 ? data.rank() == 1 || (data.rank() == 2 && data.shape[1] == 1)
+                                               : data.rank() == 2 && data.shape[1] == width;
+                if (!shaped || data.type() == PackedData::Type::Complex) throw invalid;
+                if (auto reals = std::get_if<std::vector<double>>(&data.values)) return *reals;
+                const auto& integers = std::get<std::vector<int64_t>>(data.values);
+                return std::vector<double>(integers.begin(), integers.end());
+            }
+            auto list = std::get_if<List>(&*points);
+            if (!list) throw invalid;
+            if (auto packed = try_pack(list->elements); packed && std::get<PackedArray>(*packed).data->type() != PackedData::Type::Complex) {
+                return point_coordinates(packed, width);
+            }
+            const auto real = [&](const ExprPtr& e) -> double {
+                if (auto n = std::get_if<Number>(&*e)) return n->value;
+                if (auto q = std::get_if<Rational>(&*e)) return q->value();
+                throw invalid;
+            };
+            std::vector<double> coordinates;
+            coordinates.reserve(list->elements.size() * width);
+            for (const auto& point : list->elements) {
+                auto row = std::get_if<List>(&*point);
+                if (!row) {
+                    if (width != 1) throw invalid;
+                    coordinates.push_back(real(point));
+                    continue;
+                }
+                if (row->elements.size() != width) throw invalid;
+                for (const auto& c : row->elements) coordinates.push_back(real(c));
+            }
+            return coordinates;
+        }
+    }
+
+    // One compiled program for all points; the polynomial's coefficients must be numeric
+    ExprPtr evaluate_polynomial(const ExprPtr& expr, const std::vector<std::string>& variables, const ExprPtr& points, EvaluationContext&) {
+        if (variables.empty()) throw std::runtime_error("PolynomialEvaluate expects at least one variable");
+        const CompiledPolynomial compiled(expr_to_polynomial<RealField>(expr, variables));
+        std::vector<double> values = compiled.evaluate(point_coordinates(points, variables.size()));
+        if (values.size() >= AUTO_PACK_LENGTH) {
+            std::vector<size_t> shape{ values.size() };
+            return make_packed(std::move(shape), std::move(values));
+        }
+        std::vector<ExprPtr> elements;
+        elements.reserve(values.size());
+        for (double v : values) elements.push_back(make_expr<Number>(v));
+        return make_expr<List>(std::move(elements));
+    }
+
     // --- Low-level API ---
 
     Polynomial expand(const Polynomial& poly) {
@@ -161,27 +731,32 @@ namespace aleph3 {
     }
 
     Polynomial factor(const Polynomial& poly) {
-        // Placeholder: no actual factorization
+        // A Polynomial is a sum and cannot hold the product; see factor(IntegerPolynomial)
         return poly;
     }
 
     Polynomial collect(const Polynomial& poly, const std::vector<std::string>& variables) {
-        // Placeholder: no actual collection, just returns input
+        // A Polynomial is a flat sum of monomials and cannot hold the nested form; see
+        // collect_polynomial
         return poly;
     }
 
     Polynomial gcd(const Polynomial& a, const Polynomial& b, const std::vector<std::string>& variables) {
-        // Only supports univariate GCD for now
+        BigInt sa, sb;
+        auto ia = integral_multiple(expr_to_polynomial(polynomial_to_expr(a), variables), sa);
+        auto ib = integral_multiple(expr_to_polynomial(polynomial_to_expr(b), variables), sb);
+        if (ia && ib) return to_polynomial(gcd(*ia, *ib));
         if (variables.size() != 1)
-            throw std::runtime_error("gcd: only univariate GCD is implemented");
+            throw std::runtime_error("gcd: multivariate GCD needs exact coefficients");
         return Polynomial::gcd(a, b, variables[0]);
     }
 
     std::pair<Polynomial, Polynomial> divide(const Polynomial& dividend, const Polynomial& divisor, const std::vector<std::string>& variables) {
-        // Only supports univariate division for now
-        if (variables.size() != 1)
-            throw std::runtime_error("divide: only univariate division is implemented");
-        return dividend.divide(divisor);
+        if (variables.size() == 1) return dividend.divide(divisor);
+        // The division algorithm in lexicographic order of `variables`
+        auto result = reduce(expr_to_polynomial<RealField>(polynomial_to_expr(dividend), variables),
+                             { expr_to_polynomial<RealField>(polynomial_to_expr(divisor), variables) }, MonomialOrder::Lexicographic);
+        return { to_polynomial(result.quotients.front()), to_polynomial(result.remainder) };
     }
 
 } // namespace aleph3
\ No newline at end of file
@@ -1,12 +1,108 @@
 #include "algebra/Polynomial.hpp"
+#include "algebra/SparsePolynomial.hpp"
+#include "evaluator/Budget.hpp"
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace aleph3 {
 
     constexpr double EPSILON = 1e-10;
 
+    namespace {
+        // Products and divisions with at least this many term pairs go through SparsePolynomial
+        constexpr size_t PACKED_PRODUCT_PAIRS = 1024;
+
+        // The ring of every variable in ps, or nullopt past PolynomialRing::MAX_VARIABLES
+        std::optional<std::vector<std::string>> variables_of(std::initializer_list<const Polynomial*> ps) {
+            std::vector<std::string> names;
+            for (const auto* p : ps) {
+                for (const auto& [mono, _] : p->terms) {
+                    for (const auto& [var, _e] : mono) names.push_back(var);
+                }
+            }
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            if (names.size() > PolynomialRing::MAX_VARIABLES) return std::nullopt;
+            return names;
+        }
+
+        // p with packed exponents, or nullopt if an exponent is negative or above `largest`
+        std::optional<SparsePolynomial> pack(const std::shared_ptr<const PolynomialRing>& ring, const Polynomial& p, uint32_t largest) {
+            std::vector<SparsePolynomial::Term> terms;
+            std::vector<uint32_t> exponents(ring->size());
+            for (const auto& [mono, coeff] : p.terms) {
+                std::fill(exponents.begin(), exponents.end(), 0);
+                for (const auto& [var, e] : mono) {
+                    if (e < 0 || static_cast<uint32_t>(e) > largest) return std::nullopt;
+                    exponents[*ring->index_of(var)] = static_cast<uint32_t>(e);
+                }
+                terms.push_back({ ring->pack(exponents), coeff });
+            }
+            return SparsePolynomial::from_terms(ring, std::move(terms));
+        }
+
+        Polynomial unpack(const SparsePolynomial& p) {
+            Polynomial result;
+            const PolynomialRing& ring = p.ring();
+            for (const auto& t : p.terms()) {
+                Monomial m;
+                for (size_t v = 0; v < ring.size(); ++v) {
+                    if (auto e = ring.exponent(t.exponents, v)) m[ring.variables()[v]] = static_cast<int>(e);
+                }
+                result.terms.emplace(std::move(m), t.coeff);
+            }
+            return result;
+        }
+
+        // a * b with packed exponents, or nullopt if an exponent is negative or too large
+        std::optional<Polynomial> packed_product(const Polynomial& a, const Polynomial& b) {
+            auto names = variables_of({ &a, &b });
+            if (!names) return std::nullopt;
+            const auto ring = std::make_shared<const PolynomialRing>(std::move(*names));
+            auto pa = pack(ring, a, ring->max_exponent() / 2), pb = pack(ring, b, ring->max_exponent() / 2);
+            if (!pa || !pb) return std::nullopt;
+            return unpack(*pa * *pb);
+        }
+
+        // Quotient and remainder of univariate a and b by heap division, or nullopt if
+        // another variable or a negative exponent appears
+        std::optional<std::pair<Polynomial, Polynomial>> packed_division(const Polynomial& a, const Polynomial& b) {
+            auto names = variables_of({ &a, &b });
+            if (!names || names->size() != 1) return std::nullopt;
+            const auto ring = std::make_shared<const PolynomialRing>(std::move(*names));
+            auto pa = pack(ring, a, ring->max_exponent()), pb = pack(ring, b, ring->max_exponent());
+            if (!pa || !pb) return std::nullopt;
+            auto [quotient, remainder] = divide(*pa, *pb);
+            Polynomial q = unpack(quotient), r = unpack(remainder);
+            q.normalize();
+            r.normalize();
+            return std::make_pair(std::move(q), std::move(r));
+        }
+
+        // terms[mono] += coeff, erasing the monomial if it cancels
+        void accumulate(std::map<Monomial, double>& terms, const Monomial& mono, double coeff) {
+            auto it = terms.try_emplace(mono, 0.0).first;
+            it->second += coeff;
+            if (std::abs(it->second) < EPSILON) terms.erase(it);
+        }
+
+        // The normalized form of the zero polynomial is a single zero constant, which
+        // goes once other terms appear
+        void settle(std::map<Monomial, double>& terms) {
+            if (terms.empty()) {
+                terms[Monomial{}] = 0.0;
+                return;
+            }
+            auto constant = terms.find(Monomial{});
+            if (terms.size() > 1 && constant != terms.end() && std::abs(constant->second) < EPSILON) terms.erase(constant);
+        }
+    }
+
     // Default constructor: zero polynomial
     Polynomial::Polynomial() : terms{} {}
 
@@ -34,39 +130,78 @@ namespace aleph3 {
     }
 
     // Addition
-    Polynomial Polynomial::operator+(const Polynomial& other) const {
+    Polynomial Polynomial::operator+(const Polynomial& other) const& {
         Polynomial result = *this;
-        for (const auto& [mono, coeff] : other.terms) {
-            result.terms[mono] += coeff;
-        }
-        result.normalize();
+        result += other;
         return result;
     }
 
+    Polynomial Polynomial::operator+(const Polynomial& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
     // Subtraction
-    Polynomial Polynomial::operator-(const Polynomial& other) const {
+    Polynomial Polynomial::operator-(const Polynomial& other) const& {
         Polynomial result = *this;
-        for (const auto& [mono, coeff] : other.terms) {
-            result.terms[mono] -= coeff;
-        }
-        result.normalize();
+        result -= other;
         return result;
     }
 
+    Polynomial Polynomial::operator-(const Polynomial& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
     // Multiplication
     Polynomial Polynomial::operator*(const Polynomial& other) const {
         Polynomial result;
-        for (const auto& [m1, c1] : terms) {
-            for (const auto& [m2, c2] : other.terms) {
+        result.addmul(*this, other);
+        return result;
+    }
+
+    Polynomial& Polynomial::operator+=(const Polynomial& other) {
+        if (this == &other) {
+            for (auto& [mono, coeff] : terms) coeff *= 2;
+            return *this;
+        }
+        for (const auto& [mono, coeff] : other.terms) accumulate(terms, mono, coeff);
+        settle(terms);
+        return *this;
+    }
+
+    Polynomial& Polynomial::operator-=(const Polynomial& other) {
+        if (this == &other) {
+            terms.clear();
+            settle(terms);
+            return *this;
+        }
+        for (const auto& [mono, coeff] : other.terms) accumulate(terms, mono, -coeff);
+        settle(terms);
+        return *this;
+    }
+
+    Polynomial& Polynomial::operator*=(const Polynomial& other) {
+        return *this = *this * other;
+    }
+
+    Polynomial& Polynomial::addmul(const Polynomial& a, const Polynomial& b) {
+        if (this == &a || this == &b) return *this += a * b;
+        if (a.terms.size() * b.terms.size() >= PACKED_PRODUCT_PAIRS) {
+            if (auto product = packed_product(a, b)) return *this += *product;
+        }
+        for (const auto& [m1, c1] : a.terms) {
+            poll_budget();
+            for (const auto& [m2, c2] : b.terms) {
                 Monomial m = m1;
                 for (const auto& [var, exp] : m2) {
                     m[var] += exp;
                 }
-                result.terms[m] += c1 * c2;
+                accumulate(terms, m, c1 * c2);
             }
         }
-        result.normalize();
-        return result;
+        settle(terms);
+        return *this;
     }
 
     // Division (univariate only for now)
@@ -100,6 +235,9 @@ namespace aleph3 {
             Polynomial remainder(0.0);
             return { quotient, remainder };
         }
+        if (terms.size() * divisor.terms.size() >= PACKED_PRODUCT_PAIRS) {
+            if (auto division = packed_division(*this, divisor)) return *division;
+        }
         Polynomial remainder = *this;
         Polynomial quotient;
 
@@ -157,8 +295,8 @@ namespace aleph3 {
             }
             double qcoeff = lead_coeff_r / lead_coeff_d;
             Polynomial qterm({ {qmono, qcoeff} });
-            quotient = quotient + qterm;
-            remainder = remainder - (divisor * qterm);
+            quotient += qterm;
+            remainder.addmul(divisor, Polynomial({ {qmono, -qcoeff} }));
             remainder.normalize();
         }
 
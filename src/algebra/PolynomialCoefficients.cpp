@@ -0,0 +1,46 @@
+#include "algebra/PolynomialCoefficients.hpp"
+
+#include <stdexcept>
+
+namespace aleph3 {
+
+    template <class Domain>
+    std::vector<CoefficientGroup<Domain>> group_by_main_variables(const BasicSparsePolynomial<Domain>& poly, size_t main) {
+        using Poly = BasicSparsePolynomial<Domain>;
+        const PolynomialRing& ring = poly.ring();
+        if (main > ring.size()) throw std::invalid_argument("group_by_main_variables: more main variables than the ring has");
+
+        // The exponents of the main variables alone, and of the others alone
+        auto main_part = [&](Exponents e) {
+            for (size_t v = main; v < ring.size(); ++v) e = ring.without(e, v);
+            return e;
+        };
+        auto rest_part = [&](Exponents e) {
+            for (size_t v = 0; v < main; ++v) e = ring.without(e, v);
+            return e;
+        };
+
+        std::vector<CoefficientGroup<Domain>> groups;
+        const auto& terms = poly.terms();
+        for (size_t begin = 0; begin < terms.size();) {
+            const Exponents key = main_part(terms[begin].exponents);
+            std::vector<typename Poly::Term> rest;
+            size_t end = begin;
+            for (; end < terms.size() && main_part(terms[end].exponents) == key; ++end) {
+                rest.push_back({ rest_part(terms[end].exponents), terms[end].coeff });
+            }
+            std::vector<uint32_t> exponents(main);
+            for (size_t v = 0; v < main; ++v) exponents[v] = ring.exponent(key, v);
+            // The terms stay in order, so the sort in from_terms has nothing to move
+            groups.push_back({ std::move(exponents), Poly::from_terms(poly.ring_ptr(), std::move(rest), poly.domain()) });
+            begin = end;
+        }
+        return groups;
+    }
+
+    template std::vector<CoefficientGroup<RealField>> group_by_main_variables(const SparsePolynomial&, size_t);
+    template std::vector<CoefficientGroup<IntegerRing>> group_by_main_variables(const IntegerPolynomial&, size_t);
+    template std::vector<CoefficientGroup<RationalField>> group_by_main_variables(const RationalPolynomial&, size_t);
+    template std::vector<CoefficientGroup<ModularField>> group_by_main_variables(const ModularPolynomial&, size_t);
+
+} // namespace aleph3
@@ -0,0 +1,247 @@
+#include "algebra/PolynomialEvaluate.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// The block loops are compiled once per instruction set and resolved at load time
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+#define ALEPH3_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define ALEPH3_KERNEL
+#endif
+
+namespace aleph3 {
+
+    namespace {
+        using Step = CompiledPolynomial::Step;
+        using Power = CompiledPolynomial::Power;
+        constexpr size_t LANES = CompiledPolynomial::LANES;
+
+        // Blocks per ThreadPool chunk
+        constexpr size_t BLOCK_GRAIN = 64;
+
+        // The Horner program of a polynomial, with the power each step uses
+        struct Emitter {
+            const PolynomialRing& ring;
+            const std::vector<SparsePolynomial::Term>& terms;
+            std::vector<Step> steps{};
+            std::vector<Power> powers{};  // One per step; Constant steps have none
+            size_t registers = 1;
+
+            void push(Step::Op op, size_t r, Power power, double c) {
+                steps.push_back({ op, static_cast<uint8_t>(r), 0, c });
+                powers.push_back(power);
+            }
+
+            // True if no variable after v occurs in t
+            bool constant_after(const SparsePolynomial::Term& t, size_t v) const {
+                for (size_t w = v + 1; w < ring.size(); ++w) {
+                    if (ring.exponent(t.exponents, w) != 0) return false;
+                }
+                return true;
+            }
+
+            // Leaves in register r the sum of terms [begin, end), which agree in the variables
+            // before v, with those variables left out. The terms are sorted, so the ones with
+            // the same exponent of v are adjacent, in decreasing exponent order.
+            void emit(size_t begin, size_t end, size_t v, size_t r) {
+                registers = std::max(registers, r + 1);
+                if (v == ring.size()) {
+                    push(Step::Op::Constant, r, {}, terms[begin].coeff);
+                    return;
+                }
+                uint32_t previous = 0;
+                for (size_t i = begin; i < end;) {
+                    const uint32_t e = ring.exponent(terms[i].exponents, v);
+                    size_t j = i + 1;
+                    while (j < end && ring.exponent(terms[j].exponents, v) == e) ++j;
+                    const Power gap{ static_cast<uint32_t>(v), previous - e };
+                    if (i == begin) {
+                        emit(i, j, v + 1, r);
+                    }
+                    else if (j == i + 1 && constant_after(terms[i], v)) {
+                        push(Step::Op::MulAddConstant, r, gap, terms[i].coeff);
+                    }
+                    else {
+                        emit(i, j, v + 1, r + 1);
+                        push(Step::Op::MulAdd, r, gap, 0.0);
+                    }
+                    previous = e;
+                    i = j;
+                }
+                if (previous > 0) push(Step::Op::Multiply, r, { static_cast<uint32_t>(v), previous }, 0.0);
+            }
+        };
+
+        // out[l] = p at lane l of x, where x holds LANES values per variable. table and regs
+        // are scratch for the powers and the registers.
+        ALEPH3_KERNEL void run_block(const Step* steps, size_t step_count, const Power* powers, size_t power_count,
+                                     const double* x, double* table, double* regs, double* out) {
+            for (size_t k = 0; k < power_count; ++k) {
+                // From the previous power of the same variable, or from 1
+                double* t = table + k * LANES;
+                const double* base = x + size_t(powers[k].variable) * LANES;
+                uint32_t n = powers[k].exponent;
+                if (k > 0 && powers[k - 1].variable == powers[k].variable) {
+                    n -= powers[k - 1].exponent;
+                    const double* below = t - LANES;
+                    for (size_t l = 0; l < LANES; ++l) t[l] = below[l];
+                }
+                else {
+                    for (size_t l = 0; l < LANES; ++l) t[l] = 1.0;
+                }
+                double square[LANES];
+                for (size_t l = 0; l < LANES; ++l) square[l] = base[l];
+                while (n != 0) {
+                    if (n & 1) {
+                        for (size_t l = 0; l < LANES; ++l) t[l] *= square[l];
+                    }
+                    n >>= 1;
+                    if (n != 0) {
+                        for (size_t l = 0; l < LANES; ++l) square[l] *= square[l];
+                    }
+                }
+            }
+
+            for (size_t s = 0; s < step_count; ++s) {
+                const Step& step = steps[s];
+                double* r = regs + size_t(step.r) * LANES;
+                const double* p = table + size_t(step.power) * LANES;
+                switch (step.op) {
+                case Step::Op::Constant:
+                    for (size_t l = 0; l < LANES; ++l) r[l] = step.c;
+                    break;
+                case Step::Op::MulAddConstant:
+                    for (size_t l = 0; l < LANES; ++l) r[l] = r[l] * p[l] + step.c;
+                    break;
+                case Step::Op::MulAdd:
+                    for (size_t l = 0; l < LANES; ++l) r[l] = r[l] * p[l] + r[l + LANES];
+                    break;
+                case Step::Op::Multiply:
+                    for (size_t l = 0; l < LANES; ++l) r[l] *= p[l];
+                    break;
+                }
+            }
+            for (size_t l = 0; l < LANES; ++l) out[l] = regs[l];
+        }
+
+        // acc[r] = sum over k of c[k * LANES + r] * y^k, for `rows` rows of coefficients
+        ALEPH3_KERNEL void split_horner(const double* c, size_t rows, double y, double* acc) {
+            for (size_t l = 0; l < LANES; ++l) acc[l] = 0.0;
+            for (size_t k = rows; k-- > 0;) {
+                for (size_t l = 0; l < LANES; ++l) acc[l] = acc[l] * y + c[k * LANES + l];
+            }
+        }
+    }
+
+    CompiledPolynomial::CompiledPolynomial(const SparsePolynomial& p) { compile(p); }
+
+    CompiledPolynomial::CompiledPolynomial(const Polynomial& p, const std::vector<std::string>& variables) {
+        auto ring = std::make_shared<const PolynomialRing>(variables);
+        std::vector<SparsePolynomial::Term> terms;
+        terms.reserve(p.terms.size());
+        for (const auto& [monomial, coeff] : p.terms) {
+            std::vector<uint32_t> exponents(ring->size(), 0);
+            for (const auto& [name, exponent] : monomial) {
+                const auto index = ring->index_of(name);
+                if (!index) throw std::invalid_argument("CompiledPolynomial: " + name + " is not an evaluation variable");
+                if (exponent < 0) throw std::invalid_argument("CompiledPolynomial: negative exponent of " + name);
+                exponents[*index] = static_cast<uint32_t>(exponent);
+            }
+            terms.push_back({ ring->pack(exponents), coeff });
+        }
+        compile(SparsePolynomial::from_terms(ring, std::move(terms)));
+    }
+
+    void CompiledPolynomial::compile(const SparsePolynomial& p) {
+        variables_ = p.ring().size();
+        if (p.is_zero()) {
+            program_.push_back({ Step::Op::Constant, 0, 0, 0.0 });
+            return;
+        }
+
+        Emitter emitter{ p.ring(), p.terms() };
+        emitter.emit(0, p.size(), 0, 0);
+        registers_ = emitter.registers;
+        program_ = std::move(emitter.steps);
+        for (size_t s = 0; s < program_.size(); ++s) {
+            if (program_[s].op != Step::Op::Constant) powers_.push_back(emitter.powers[s]);
+        }
+        std::sort(powers_.begin(), powers_.end());
+        powers_.erase(std::unique(powers_.begin(), powers_.end()), powers_.end());
+        for (size_t s = 0; s < program_.size(); ++s) {
+            if (program_[s].op == Step::Op::Constant) continue;
+            const auto it = std::lower_bound(powers_.begin(), powers_.end(), emitter.powers[s]);
+            program_[s].power = static_cast<uint32_t>(it - powers_.begin());
+        }
+
+        const uint32_t degree = variables_ == 1 ? p.degree(0) : 0;
+        if (variables_ == 1 && degree >= SPLIT_DEGREE && 2 * p.size() > degree) {
+            const size_t rows = degree / LANES + 1;
+            dense_.assign(rows * LANES, 0.0);
+            for (const auto& t : p.terms()) dense_[p.ring().exponent(t.exponents, 0)] = t.coeff;
+        }
+    }
+
+    double CompiledPolynomial::operator()(const double* point) const {
+        double value;
+        evaluate(point, 1, &value);
+        return value;
+    }
+
+    void CompiledPolynomial::evaluate(const double* points, size_t count, double* values) const {
+        if (!dense_.empty() && count < LANES) {
+            for (size_t i = 0; i < count; ++i) values[i] = evaluate_split(points[i]);
+            return;
+        }
+        if (count >= PARALLEL_POINTS && ThreadPool::instance().concurrency() > 1) {
+            const size_t blocks = (count + LANES - 1) / LANES;
+            ThreadPool::instance().parallel_for(blocks, BLOCK_GRAIN, [&](size_t, size_t begin, size_t end) {
+                const size_t first = begin * LANES, last = std::min(count, end * LANES);
+                evaluate_blocks(points + first * variables_, last - first, values + first);
+            });
+            return;
+        }
+        evaluate_blocks(points, count, values);
+    }
+
+    std::vector<double> CompiledPolynomial::evaluate(const std::vector<double>& points) const {
+        if (variables_ == 0) throw std::invalid_argument("CompiledPolynomial: a constant has no points to split");
+        if (points.size() % variables_ != 0) {
+            throw std::invalid_argument("CompiledPolynomial: points do not have " + std::to_string(variables_) + " coordinates");
+        }
+        std::vector<double> values(points.size() / variables_);
+        evaluate(points.data(), values.size(), values.data());
+        return values;
+    }
+
+    void CompiledPolynomial::evaluate_blocks(const double* points, size_t count, double* values) const {
+        std::vector<double> x(std::max<size_t>(variables_, 1) * LANES), table(powers_.size() * LANES),
+            regs(registers_ * LANES), out(LANES);
+        for (size_t base = 0; base < count; base += LANES) {
+            // A partial block repeats its last point in the unused lanes
+            const size_t lanes = std::min(LANES, count - base);
+            for (size_t l = 0; l < LANES; ++l) {
+                const double* point = points + (base + std::min(l, lanes - 1)) * variables_;
+                for (size_t v = 0; v < variables_; ++v) x[v * LANES + l] = point[v];
+            }
+            run_block(program_.data(), program_.size(), powers_.data(), powers_.size(), x.data(), table.data(), regs.data(),
+                      out.data());
+            std::copy(out.begin(), out.begin() + lanes, values + base);
+        }
+    }
+
+    double CompiledPolynomial::evaluate_split(double x) const {
+        double y = 1.0;
+        for (size_t l = 0; l < LANES; ++l) y *= x;
+        double acc[LANES];
+        split_horner(dense_.data(), dense_.size() / LANES, y, acc);
+        double value = 0.0;
+        for (size_t l = LANES; l-- > 0;) value = value * x + acc[l];
+        return value;
+    }
+
+} // namespace aleph3
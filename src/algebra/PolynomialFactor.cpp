@@ -0,0 +1,706 @@
+#include "algebra/PolynomialFactor.hpp"
+#include "algebra/PolynomialGcd.hpp"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+
+namespace aleph3 {
+
+    namespace {
+
+        using modular::Poly;
+        using modular::degree;
+
+        // Dense univariate polynomial over Z, a[k] the coefficient of x^k; trimmed
+        using ZPoly = std::vector<BigInt>;
+
+        // Primes for the modular factorizations lie below this, so products of their
+        // representatives stay on the exact double-precision kernels
+        constexpr uint64_t SMALL_PRIME_LIMIT = 1u << 16;
+        // Good primes tried before picking the one with the fewest modular factors
+        constexpr size_t TRIAL_PRIMES = 3;
+
+        // --- Dense polynomials over Z and over Z/mZ for large m ---
+
+        void trim(ZPoly& a) {
+            while (!a.empty() && a.back().is_zero()) a.pop_back();
+        }
+
+        // a mod m in [0, m)
+        BigInt mod(const BigInt& a, const BigInt& m) {
+            BigInt r = a % m;
+            return r.sign() < 0 ? r + m : r;
+        }
+
+        ZPoly reduce(ZPoly a, const BigInt& m) {
+            for (auto& c : a) c = mod(c, m);
+            trim(a);
+            return a;
+        }
+
+        ZPoly add(const ZPoly& a, const ZPoly& b, const BigInt& m) {
+            ZPoly out(std::max(a.size(), b.size()));
+            for (size_t i = 0; i < out.size(); ++i) {
+                out[i] = (i < a.size() ? a[i] : BigInt(0)) + (i < b.size() ? b[i] : BigInt(0));
+            }
+            return reduce(std::move(out), m);
+        }
+
+        ZPoly sub(const ZPoly& a, const ZPoly& b, const BigInt& m) {
+            ZPoly out(std::max(a.size(), b.size()));
+            for (size_t i = 0; i < out.size(); ++i) {
+                out[i] = (i < a.size() ? a[i] : BigInt(0)) - (i < b.size() ? b[i] : BigInt(0));
+            }
+            return reduce(std::move(out), m);
+        }
+
+        ZPoly mul(const ZPoly& a, const ZPoly& b) {
+            if (a.empty() || b.empty()) return {};
+            ZPoly out(a.size() + b.size() - 1);
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].is_zero()) continue;
+                for (size_t j = 0; j < b.size(); ++j) out[i + j] += a[i] * b[j];
+            }
+            trim(out);
+            return out;
+        }
+
+        // Operands shorter than this skip the packed product
+        constexpr size_t PACKED_LENGTH = 8;
+
+        // a * b mod m. Long operands with coefficients in [0, m) are multiplied as single
+        // integers after the Kronecker substitution x -> 2^(32 s): each coefficient of the
+        // product is below (shorter length) * m^2, which fits in a slot of s limbs, so
+        // the slots of the one big product, which uses BigInt's Karatsuba, are the
+        // coefficients.
+        ZPoly mul(const ZPoly& a, const ZPoly& b, const BigInt& m) {
+            const auto in_range = [&](const ZPoly& x) {
+                return std::all_of(x.begin(), x.end(), [&](const BigInt& c) { return c.sign() >= 0 && c < m; });
+            };
+            if (std::min(a.size(), b.size()) < PACKED_LENGTH || !in_range(a) || !in_range(b)) return reduce(mul(a, b), m);
+
+            const size_t slot = 2 * ((m.bit_length() + 31) / 32) + 1;
+            const auto pack = [&](const ZPoly& x) {
+                std::vector<uint32_t> limbs(x.size() * slot, 0);
+                for (size_t i = 0; i < x.size(); ++i) {
+                    const auto digits = x[i].magnitude();
+                    std::copy(digits.begin(), digits.end(), limbs.begin() + static_cast<std::ptrdiff_t>(i * slot));
+                }
+                return BigInt::from_magnitude(std::move(limbs));
+            };
+            const auto product = (pack(a) * pack(b)).magnitude();
+            ZPoly out(a.size() + b.size() - 1);
+            for (size_t i = 0; i < out.size() && i * slot < product.size(); ++i) {
+                const auto first = product.begin() + static_cast<std::ptrdiff_t>(i * slot);
+                const auto last = product.begin() + static_cast<std::ptrdiff_t>(std::min(product.size(), (i + 1) * slot));
+                out[i] = mod(BigInt::from_magnitude(std::vector<uint32_t>(first, last)), m);
+            }
+            trim(out);
+            return out;
+        }
+
+        // 1 / a mod (m, x^n) for a[0] = 1, by Newton's iteration g <- g (2 - a g), which
+        // doubles the precision per step
+        ZPoly series_inverse(const ZPoly& a, size_t n, const BigInt& m) {
+            ZPoly g{ BigInt(1) };
+            for (size_t precision = 1; precision < n;) {
+                precision = std::min(2 * precision, n);
+                ZPoly head(a.begin(), a.begin() + static_cast<std::ptrdiff_t>(std::min(a.size(), precision)));
+                ZPoly e = mul(head, g, m);
+                if (e.size() > precision) e.resize(precision);
+                g = mul(g, sub({ BigInt(2) }, e, m), m);
+                if (g.size() > precision) g.resize(precision);
+                trim(g);
+            }
+            return g;
+        }
+
+        // Division by a monic h modulo m, for a with coefficients in [0, m). Long quotients
+        // come from the reversed product rev(a) / rev(h) mod x^(deg q + 1), so all the work
+        // is in packed products.
+        std::pair<ZPoly, ZPoly> divmod(const ZPoly& a, const ZPoly& h, const BigInt& m) {
+            if (a.size() < h.size()) return { {}, a };
+            const size_t length = a.size() - h.size() + 1;
+            ZPoly q;
+            if (length < PACKED_LENGTH) {
+                ZPoly r = a;
+                q.resize(length);
+                for (size_t k = length; k-- > 0;) {
+                    q[k] = mod(r[k + h.size() - 1], m);
+                    if (q[k].is_zero()) continue;
+                    for (size_t j = 0; j < h.size(); ++j) r[k + j] = r[k + j] - q[k] * h[j];
+                }
+                trim(q);
+            } else {
+                const ZPoly reversed_h(h.rbegin(), h.rend());
+                ZPoly head(a.rbegin(), a.rbegin() + static_cast<std::ptrdiff_t>(length));
+                q = mul(head, series_inverse(reversed_h, length, m), m);
+                q.resize(length);
+                std::reverse(q.begin(), q.end());
+                trim(q);
+            }
+            ZPoly r = sub(a, mul(q, h, m), m);
+            return { std::move(q), std::move(r) };
+        }
+
+        // a / b over Z when the division is exact
+        std::optional<ZPoly> divide_exact(const ZPoly& a, const ZPoly& b) {
+            if (a.size() < b.size()) return a.empty() ? std::optional<ZPoly>(ZPoly{}) : std::nullopt;
+            ZPoly r = a;
+            ZPoly q(a.size() - b.size() + 1);
+            for (size_t k = q.size(); k-- > 0;) {
+                const BigInt& top = r[k + b.size() - 1];
+                if (top.is_zero()) continue;
+                if (!(top % b.back()).is_zero()) return std::nullopt;
+                q[k] = top / b.back();
+                for (size_t j = 0; j < b.size(); ++j) r[k + j] = r[k + j] - q[k] * b[j];
+            }
+            for (const auto& c : r) {
+                if (!c.is_zero()) return std::nullopt;
+            }
+            trim(q);
+            return q;
+        }
+
+        // Divided by its content, with a positive leading coefficient
+        ZPoly primitive(ZPoly a) {
+            BigInt g = 0;
+            for (const auto& c : a) g = gcd(g, c);
+            if (a.back().sign() < 0) g = -g;
+            for (auto& c : a) c = c / g;
+            return a;
+        }
+
+        ZPoly lift(const ModularField& field, const Poly& a) {
+            ZPoly out(a.size());
+            for (size_t i = 0; i < a.size(); ++i) out[i] = BigInt(static_cast<int64_t>(field.to_uint(a[i])));
+            return out;
+        }
+
+        Poly reduce(const ModularField& field, const ZPoly& a) {
+            Poly out(a.size());
+            for (size_t i = 0; i < a.size(); ++i) out[i] = field.from_integer(a[i]);
+            modular::trim(out);
+            return out;
+        }
+
+        // --- Factorization over Z/pZ ---
+
+        // rows[i] = x^(p i) mod g, so h^p mod g = sum of h[i] * rows[i]
+        using Frobenius = std::vector<Poly>;
+
+        Frobenius frobenius(const ModularField& field, const Poly& g) {
+            const size_t n = degree(g);
+            Frobenius rows(n);
+            if (n == 0) return rows;
+            rows[0] = { field.one() };
+            const Poly xp = modular::powmod(field, { 0, field.one() }, field.modulus(), g);
+            for (size_t i = 1; i < n; ++i) rows[i] = modular::rem(field, modular::mul(field, rows[i - 1], xp), g);
+            return rows;
+        }
+
+        // The rows for a divisor of the modulus they were built for
+        Frobenius restrict_to(const ModularField& field, const Frobenius& rows, const Poly& g) {
+            Frobenius out(degree(g));
+            for (size_t i = 0; i < out.size(); ++i) out[i] = modular::rem(field, rows[i], g);
+            return out;
+        }
+
+        Poly power_p(const ModularField& field, const Frobenius& rows, const Poly& h) {
+            // Below SMALL_PRIME_LIMIT, rows.size() products of representatives fit in 64 bits
+            std::vector<uint64_t> sums(rows.size(), 0);
+            for (size_t i = 0; i < h.size(); ++i) {
+                if (h[i] == 0) continue;
+                for (size_t j = 0; j < rows[i].size(); ++j) sums[j] += h[i] * rows[i][j];
+            }
+            Poly out(sums.size());
+            for (size_t j = 0; j < sums.size(); ++j) out[j] = field.reduce_sum(sums[j]);
+            modular::trim(out);
+            return out;
+        }
+
+        // Products of all irreducible factors of each degree d, for monic square-free f
+        std::vector<std::pair<Poly, size_t>> distinct_degree(const ModularField& field, const Poly& f, const Frobenius& rows) {
+            std::vector<std::pair<Poly, size_t>> out;
+            const Poly x{ 0, field.one() };
+            Poly rest = f;
+            Poly h = modular::rem(field, x, f);
+            for (size_t d = 1; 2 * d <= degree(rest); ++d) {
+                h = power_p(field, rows, h);  // x^(p^d) mod f
+                Poly g = modular::gcd(field, rest, modular::sub(field, h, x));
+                if (degree(g) == 0) continue;
+                rest = modular::divmod(field, rest, g).first;
+                out.push_back({ std::move(g), d });
+            }
+            if (degree(rest) > 0) out.push_back({ rest, degree(rest) });
+            return out;
+        }
+
+        // Cantor-Zassenhaus: g is a product of irreducibles of degree d. A random a splits
+        // g by gcd(g, a^((p^d - 1) / 2) - 1), where the exponent is (p - 1) / 2 times
+        // 1 + p + ... + p^(d - 1) and each power of p is one Frobenius step.
+        void equal_degree(const ModularField& field, const Poly& g, size_t d, const Frobenius& rows, std::mt19937_64& rng,
+                          std::vector<Poly>& out) {
+            const size_t n = degree(g);
+            if (n == d) {
+                out.push_back(g);
+                return;
+            }
+            std::uniform_int_distribution<uint64_t> coefficient(0, field.modulus() - 1);
+            for (;;) {
+                Poly a(n);
+                for (auto& c : a) c = field.from_uint(coefficient(rng));
+                modular::trim(a);
+                if (a.size() < 2) continue;
+
+                Poly norm = a, power = a;
+                for (size_t i = 1; i < d; ++i) {
+                    power = power_p(field, rows, power);
+                    norm = modular::rem(field, modular::mul(field, norm, power), g);
+                }
+                const Poly b = modular::powmod(field, norm, (field.modulus() - 1) / 2, g);
+                Poly u = modular::gcd(field, g, modular::sub(field, b, { field.one() }));
+                if (degree(u) == 0 || degree(u) == n) continue;
+
+                const Poly w = modular::divmod(field, g, u).first;
+                equal_degree(field, u, d, restrict_to(field, rows, u), rng, out);
+                equal_degree(field, w, d, restrict_to(field, rows, w), rng, out);
+                return;
+            }
+        }
+
+        // --- Hensel lifting ---
+
+        // p, p^2, p^4, ... up to the first power at least `bound`
+        std::vector<BigInt> lifting_moduli(uint64_t p, const BigInt& bound) {
+            std::vector<BigInt> moduli{ BigInt(static_cast<int64_t>(p)) };
+            while (moduli.back() < bound) moduli.push_back(moduli.back() * moduli.back());
+            return moduli;
+        }
+
+        // a^-1 modulo the last modulus, for a a unit mod p, by Newton's iteration
+        BigInt inverse(const ModularField& field, const BigInt& a, const std::vector<BigInt>& moduli) {
+            BigInt x(static_cast<int64_t>(field.to_uint(field.inverse(field.from_integer(a)))));
+            for (size_t k = 1; k < moduli.size(); ++k) x = mod(x * (BigInt(2) - a * x), moduli[k]);
+            return x;
+        }
+
+        // f = lc(f) * factors[begin] * ... * factors[end - 1] mod p, with monic factors.
+        // Writes monic lifts modulo moduli.back() whose product times lc(f) is f.
+        void hensel(const ModularField& field, ZPoly f, const std::vector<Poly>& factors, size_t begin, size_t end,
+                    const std::vector<BigInt>& moduli, std::vector<ZPoly>& out) {
+            const BigInt& m = moduli.back();
+            if (end - begin == 1) {
+                const BigInt scale = inverse(field, f.back(), moduli);
+                for (auto& c : f) c = mod(c * scale, m);
+                out[begin] = std::move(f);
+                return;
+            }
+
+            const size_t mid = begin + (end - begin) / 2;
+            Poly g0{ field.from_integer(f.back()) }, h0{ field.one() };
+            for (size_t i = begin; i < mid; ++i) g0 = modular::mul(field, g0, factors[i]);
+            for (size_t i = mid; i < end; ++i) h0 = modular::mul(field, h0, factors[i]);
+            Poly s0, t0;
+            modular::extended_gcd(field, g0, h0, s0, t0);
+
+            // von zur Gathen and Gerhard, Algorithm 15.10: from f = g h and s g + t h = 1
+            // mod q to the same mod q^2, keeping h monic
+            ZPoly g = lift(field, g0), h = lift(field, h0), s = lift(field, s0), t = lift(field, t0);
+            for (size_t k = 1; k < moduli.size(); ++k) {
+                const BigInt& q = moduli[k];
+                const ZPoly e = sub(reduce(f, q), mul(g, h, q), q);
+                auto [quotient, remainder] = divmod(mul(s, e, q), h, q);
+                ZPoly g2 = add(g, add(mul(t, e, q), mul(quotient, g, q), q), q);
+                ZPoly h2 = add(h, remainder, q);
+                if (k + 1 < moduli.size()) {
+                    const ZPoly b = sub(add(mul(s, g2, q), mul(t, h2, q), q), { BigInt(1) }, q);
+                    auto [c, d] = divmod(mul(s, b, q), h2, q);
+                    s = sub(s, d, q);
+                    t = sub(t, add(mul(t, b, q), mul(c, g2, q), q), q);
+                }
+                g = std::move(g2);
+                h = std::move(h2);
+            }
+            hensel(field, std::move(g), factors, begin, mid, moduli, out);
+            hensel(field, std::move(h), factors, mid, end, moduli, out);
+        }
+
+        // --- Recombination ---
+
+        // Advances a sorted k-subset of [0, n); false after the last one
+        bool next_subset(std::vector<size_t>& pick, size_t n) {
+            for (size_t i = pick.size(); i-- > 0;) {
+                if (pick[i] + (pick.size() - i) < n) {
+                    ++pick[i];
+                    for (size_t j = i + 1; j < pick.size(); ++j) pick[j] = pick[j - 1] + 1;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void erase_subset(std::vector<ZPoly>& items, const std::vector<size_t>& pick) {
+            for (size_t i = pick.size(); i-- > 0;) items.erase(items.begin() + static_cast<std::ptrdiff_t>(pick[i]));
+        }
+
+        // degrees[k] is true if some product of the factors has degree k
+        using DegreeSet = std::vector<bool>;
+
+        DegreeSet subset_degrees(const std::vector<std::pair<Poly, size_t>>& split, size_t n) {
+            DegreeSet degrees(n + 1, false);
+            degrees[0] = true;
+            for (const auto& [g, d] : split) {
+                for (size_t count = degree(g) / d; count-- > 0;) {
+                    for (size_t k = n + 1; k-- > d;) {
+                        if (degrees[k - d]) degrees[k] = true;
+                    }
+                }
+            }
+            return degrees;
+        }
+
+        // Zassenhaus: the true factors of f are the primitive parts of lc(f) times products
+        // of lifted factors, in the symmetric range modulo m. Only products whose degree is
+        // in `degrees` are tried. m only needs to cover factors of at most half the degree
+        // of f: a subset of larger degree is tested through its complement.
+        std::vector<ZPoly> recombine(ZPoly f, std::vector<ZPoly> lifted, const BigInt& m, const DegreeSet& degrees) {
+            std::vector<ZPoly> out;
+            const auto symmetric = [&](BigInt c) { return c * BigInt(2) > m ? c - m : c; };
+
+            // The divisor of f that lc(f) times the product of these factors stands for
+            const auto divisor = [&](const std::vector<size_t>& indices) -> std::optional<std::pair<ZPoly, ZPoly>> {
+                const BigInt& lead = f.back();
+                // The constant term of a factor divides lc(f) * f(0)
+                if (!f.front().is_zero()) {
+                    BigInt constant = lead;
+                    for (size_t i : indices) constant = mod(constant * lifted[i].front(), m);
+                    constant = symmetric(constant);
+                    if (constant.is_zero() || !((lead * f.front()) % constant).is_zero()) return std::nullopt;
+                }
+                ZPoly candidate{ lead };
+                for (size_t i : indices) candidate = mul(candidate, lifted[i], m);
+                for (auto& c : candidate) c = symmetric(c);
+                candidate = primitive(std::move(candidate));
+                auto quotient = divide_exact(f, candidate);
+                if (!quotient) return std::nullopt;
+                return std::make_pair(std::move(candidate), std::move(*quotient));
+            };
+
+            for (size_t size = 1; 2 * size <= lifted.size();) {
+                bool found = false;
+                std::vector<size_t> pick(size);
+                std::iota(pick.begin(), pick.end(), size_t(0));
+                do {
+                    size_t d = 0;
+                    for (size_t i : pick) d += lifted[i].size() - 1;
+                    if (!degrees[d]) continue;
+                    if (2 * d <= f.size() - 1) {
+                        auto split = divisor(pick);
+                        if (!split) continue;
+                        out.push_back(std::move(split->first));
+                        f = std::move(split->second);
+                        erase_subset(lifted, pick);
+                    }
+                    else {
+                        std::vector<size_t> rest;
+                        for (size_t i = 0, k = 0; i < lifted.size(); ++i) {
+                            if (k < pick.size() && pick[k] == i) ++k;
+                            else rest.push_back(i);
+                        }
+                        auto split = divisor(rest);
+                        if (!split) continue;
+                        out.push_back(std::move(split->second));
+                        f = std::move(split->first);
+                        std::vector<ZPoly> kept;
+                        for (size_t i : rest) kept.push_back(std::move(lifted[i]));
+                        lifted = std::move(kept);
+                    }
+                    found = true;
+                    break;
+                } while (next_subset(pick, lifted.size()));
+                if (!found) ++size;
+            }
+            out.push_back(std::move(f));
+            return out;
+        }
+
+        // Irreducible factors of a square-free, primitive f of positive degree
+        std::vector<ZPoly> factor_univariate(const ZPoly& f) {
+            const size_t n = f.size() - 1;
+            if (n == 1) return { f };
+
+            // Factor degrees must be possible modulo every prime tried
+            DegreeSet degrees(n + 1, true);
+            std::optional<ModularField> best;
+            Frobenius best_rows;
+            std::vector<std::pair<Poly, size_t>> best_split;
+            size_t best_count = 0, tried = 0;
+            for (uint64_t candidate = SMALL_PRIME_LIMIT - 1; tried < TRIAL_PRIMES && candidate > 2; candidate -= 2) {
+                if (!ModularField::is_prime(candidate)) continue;
+                const ModularField field(candidate);
+                if (field.from_integer(f.back()) == 0) continue;
+                const Poly fp = modular::monic(field, reduce(field, f));
+                if (degree(modular::gcd(field, fp, modular::derivative(field, fp))) > 0) continue;
+                ++tried;
+
+                Frobenius rows = frobenius(field, fp);
+                auto split = distinct_degree(field, fp, rows);
+                size_t count = 0;
+                for (const auto& [g, d] : split) count += degree(g) / d;
+                const DegreeSet possible = subset_degrees(split, n);
+                bool proper = false;
+                for (size_t k = 0; k <= n; ++k) {
+                    degrees[k] = degrees[k] && possible[k];
+                    proper = proper || (degrees[k] && k > 0 && k < n);
+                }
+                if (!proper) return { f };
+                if (!best || count < best_count) {
+                    best = field;
+                    best_rows = std::move(rows);
+                    best_split = std::move(split);
+                    best_count = count;
+                }
+            }
+            if (!best) throw std::runtime_error("Factor: no prime keeps the polynomial square-free");
+
+            std::mt19937_64 rng(0x5eed);
+            std::vector<Poly> factors;
+            for (const auto& [g, d] : best_split) {
+                equal_degree(*best, g, d, restrict_to(*best, best_rows, g), rng, factors);
+            }
+
+            // Factors of degree d have coefficients within 2^d ||f||_2 (Mignotte), and
+            // recombination only needs d <= n / 2. The lifted products carry an extra lc(f),
+            // and both signs must fit.
+            BigInt norm = 0;
+            for (const auto& c : f) norm += abs(c);
+            const BigInt bound = BigInt(2) * abs(f.back()) * pow(BigInt(2), n / 2) * norm;
+            const auto moduli = lifting_moduli(best->modulus(), bound);
+
+            std::vector<ZPoly> lifted(factors.size());
+            hensel(*best, reduce(f, moduli.back()), factors, 0, factors.size(), moduli, lifted);
+            return recombine(f, std::move(lifted), moduli.back(), degrees);
+        }
+
+        // --- Multivariate polynomials over Z ---
+
+        bool is_constant(const IntegerPolynomial& p) {
+            return p.is_zero() || (p.size() == 1 && p.terms().front().exponents == Exponents{});
+        }
+
+        IntegerPolynomial derivative(const IntegerPolynomial& p, size_t v) {
+            const PolynomialRing& ring = p.ring();
+            const Exponents step = ring.power_of(v, 1);
+            std::vector<IntegerPolynomial::Term> terms;
+            for (const auto& t : p.terms()) {
+                const uint32_t e = ring.exponent(t.exponents, v);
+                if (e > 0) terms.push_back({ *ring.divide(t.exponents, step), t.coeff * BigInt(static_cast<int64_t>(e)) });
+            }
+            return IntegerPolynomial::from_terms(p.ring_ptr(), std::move(terms));
+        }
+
+        // gcd of the coefficients of the powers of x_v
+        IntegerPolynomial content_in(const IntegerPolynomial& p, size_t v) {
+            std::map<uint32_t, std::vector<IntegerPolynomial::Term>> groups;
+            for (const auto& t : p.terms()) {
+                groups[p.ring().exponent(t.exponents, v)].push_back({ p.ring().without(t.exponents, v), t.coeff });
+            }
+            IntegerPolynomial g = IntegerPolynomial::constant(p.ring_ptr(), 0);
+            for (auto& [_, terms] : groups) {
+                g = gcd(g, IntegerPolynomial::from_terms(p.ring_ptr(), std::move(terms)));
+                if (is_constant(g)) break;
+            }
+            return g;
+        }
+
+        IntegerPolynomial quotient(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+            auto q = divide_exact(a, b);
+            if (!q) throw std::logic_error("Factor: expected an exact division");
+            return *q;
+        }
+
+        // Square-free parts of a primitive f with a positive leading coefficient, each
+        // with its multiplicity times `multiplicity`
+        void decompose(IntegerPolynomial f, uint32_t multiplicity, std::vector<std::pair<IntegerPolynomial, uint32_t>>& out) {
+            size_t v = 0;
+            while (v < f.ring().size() && f.degree(v) == 0) ++v;
+            if (v == f.ring().size()) return;
+
+            const auto content = content_in(f, v);
+            if (!is_constant(content)) {
+                decompose(content, multiplicity, out);
+                f = quotient(f, content);
+            }
+
+            // Yun: with a_0 = gcd(f, f'), b_1 = f / a_0 and d_1 = f' / a_0 - b_1', each
+            // a_i = gcd(b_i, d_i) is the product of the factors of multiplicity i
+            const auto df = derivative(f, v);
+            const auto a0 = gcd(f, df);
+            auto b = quotient(f, a0);
+            auto d = quotient(df, a0) - derivative(b, v);
+            for (uint32_t i = 1; !is_constant(b); ++i) {
+                const auto a = gcd(b, d);
+                if (!is_constant(a)) out.push_back({ a, i * multiplicity });
+                b = quotient(b, a);
+                d = quotient(d, a) - derivative(b, v);
+            }
+        }
+
+        ZPoly to_dense(const IntegerPolynomial& p, size_t v) {
+            ZPoly out(p.degree(v) + 1);
+            for (const auto& t : p.terms()) out[p.ring().exponent(t.exponents, v)] = t.coeff;
+            return out;
+        }
+
+        IntegerPolynomial from_dense(const IntegerPolynomial& like, const ZPoly& a, size_t v) {
+            std::vector<IntegerPolynomial::Term> terms;
+            for (size_t k = a.size(); k-- > 0;) {
+                if (!a[k].is_zero()) terms.push_back({ like.ring().power_of(v, static_cast<uint32_t>(k)), a[k] });
+            }
+            return IntegerPolynomial::from_terms(like.ring_ptr(), std::move(terms));
+        }
+
+        // Mixed-radix Kronecker substitution over the variables f depends on
+        struct Kronecker {
+            std::vector<size_t> variables;
+            std::vector<uint64_t> weights;  // Exponent of t for x_variables[i]
+            std::vector<uint32_t> radices;
+
+            explicit Kronecker(const IntegerPolynomial& f) {
+                uint64_t weight = 1;
+                for (size_t v = 0; v < f.ring().size(); ++v) {
+                    const uint32_t d = f.degree(v);
+                    if (d == 0) continue;
+                    variables.push_back(v);
+                    weights.push_back(weight);
+                    radices.push_back(d + 1);
+                    weight *= d + 1;
+                    if (weight > MAX_KRONECKER_DEGREE) {
+                        throw std::runtime_error("Factor: degrees too large for Kronecker substitution");
+                    }
+                }
+            }
+
+            ZPoly substitute(const IntegerPolynomial& f) const {
+                ZPoly out;
+                for (const auto& t : f.terms()) {
+                    uint64_t e = 0;
+                    for (size_t i = 0; i < variables.size(); ++i) e += weights[i] * f.ring().exponent(t.exponents, variables[i]);
+                    if (out.size() <= e) out.resize(e + 1);
+                    out[e] = t.coeff;
+                }
+                return out;
+            }
+
+            IntegerPolynomial restore(const IntegerPolynomial& like, const ZPoly& a) const {
+                const PolynomialRing& ring = like.ring();
+                std::vector<IntegerPolynomial::Term> terms;
+                for (size_t k = 0; k < a.size(); ++k) {
+                    if (a[k].is_zero()) continue;
+                    Exponents e{};
+                    uint64_t rest = k;
+                    for (size_t i = 0; i < variables.size(); ++i) {
+                        e = ring.multiply(e, ring.power_of(variables[i], static_cast<uint32_t>(rest % radices[i])));
+                        rest /= radices[i];
+                    }
+                    terms.push_back({ e, a[k] });
+                }
+                return IntegerPolynomial::from_terms(like.ring_ptr(), std::move(terms));
+            }
+        };
+
+        // Irreducible factors of a square-free, primitive, non-constant f
+        std::vector<IntegerPolynomial> irreducible_factors(IntegerPolynomial f) {
+            const Kronecker kronecker(f);
+            std::vector<IntegerPolynomial> out;
+            if (kronecker.variables.size() == 1) {
+                const size_t v = kronecker.variables.front();
+                for (const auto& g : factor_univariate(to_dense(f, v))) out.push_back(from_dense(f, g, v));
+                return out;
+            }
+
+            // Factor the image completely; it need not be square-free
+            const auto line = std::make_shared<const PolynomialRing>(std::vector<std::string>{ "t" });
+            const auto image = factor(from_dense(IntegerPolynomial::constant(line, 0), kronecker.substitute(f), 0));
+            std::vector<ZPoly> pieces;
+            for (const auto& [g, e] : image.factors) {
+                for (uint32_t i = 0; i < e; ++i) pieces.push_back(to_dense(g, 0));
+            }
+
+            for (size_t size = 1; 2 * size <= pieces.size();) {
+                bool found = false;
+                std::vector<size_t> pick(size);
+                std::iota(pick.begin(), pick.end(), size_t(0));
+                do {
+                    ZPoly product{ BigInt(1) };
+                    for (size_t i : pick) product = mul(product, pieces[i]);
+                    const auto candidate = primitive_part(kronecker.restore(f, product));
+                    auto q = divide_exact(f, candidate);
+                    if (!q) continue;
+                    out.push_back(candidate);
+                    f = std::move(*q);
+                    erase_subset(pieces, pick);
+                    found = true;
+                    break;
+                } while (next_subset(pick, pieces.size()));
+                if (!found) ++size;
+            }
+            out.push_back(std::move(f));
+            return out;
+        }
+
+        bool factor_order(const std::pair<IntegerPolynomial, uint32_t>& a, const std::pair<IntegerPolynomial, uint32_t>& b) {
+            const uint32_t da = a.first.total_degree(), db = b.first.total_degree();
+            if (da != db) return da < db;
+            const auto& ta = a.first.terms();
+            const auto& tb = b.first.terms();
+            return std::lexicographical_compare(ta.begin(), ta.end(), tb.begin(), tb.end(), [](const auto& x, const auto& y) {
+                if (x.exponents != y.exponents) return x.exponents < y.exponents;
+                return x.coeff < y.coeff;
+            });
+        }
+
+    } // namespace
+
+    std::vector<modular::Poly> factor_modular(const ModularField& field, const modular::Poly& f) {
+        if (f.empty() || f.back() != field.one()) throw std::domain_error("factor_modular needs a monic polynomial");
+        std::vector<Poly> factors;
+        if (degree(f) == 0) return factors;
+        const Frobenius rows = frobenius(field, f);
+        std::mt19937_64 rng(0x5eed);
+        for (const auto& [g, d] : distinct_degree(field, f, rows)) {
+            equal_degree(field, g, d, restrict_to(field, rows, g), rng, factors);
+        }
+        std::stable_sort(factors.begin(), factors.end(), [](const Poly& a, const Poly& b) { return a.size() < b.size(); });
+        return factors;
+    }
+
+    Factorization square_free(const IntegerPolynomial& p) {
+        Factorization result;
+        if (p.is_zero()) {
+            result.unit = 0;
+            return result;
+        }
+        result.unit = content(p) * BigInt(p.terms().front().coeff.sign());
+        decompose(primitive_part(p), 1, result.factors);
+        std::sort(result.factors.begin(), result.factors.end(), factor_order);
+        return result;
+    }
+
+    Factorization factor(const IntegerPolynomial& p) {
+        Factorization parts = square_free(p);
+        Factorization result;
+        result.unit = parts.unit;
+        for (const auto& [part, multiplicity] : parts.factors) {
+            for (auto& g : irreducible_factors(part)) result.factors.push_back({ std::move(g), multiplicity });
+        }
+        std::sort(result.factors.begin(), result.factors.end(), factor_order);
+        return result;
+    }
+
+} // namespace aleph3
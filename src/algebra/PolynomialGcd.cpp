@@ -0,0 +1,311 @@
+#include "algebra/PolynomialGcd.hpp"
+#include "algebra/ModularUnivariate.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+
+        using modular::Poly;
+        using modular::degree;
+
+        // --- Multivariate polynomials over Z/pZ, seen in one variable ---
+
+        ModularPolynomial from_dense(const ModularPolynomial& like, const Poly& d, size_t variable) {
+            std::vector<ModularPolynomial::Term> terms;
+            for (size_t k = d.size(); k-- > 0;) {
+                if (d[k]) terms.push_back({ like.ring().power_of(variable, static_cast<uint32_t>(k)), d[k] });
+            }
+            return ModularPolynomial::from_terms(like.ring_ptr(), std::move(terms), like.domain());
+        }
+
+        // Coefficients of p in Z/pZ[x_v], keyed by the monomial in the other variables,
+        // largest first
+        std::map<Exponents, Poly, std::greater<>> coefficients_in(const ModularPolynomial& p, size_t v) {
+            std::map<Exponents, Poly, std::greater<>> groups;
+            for (const auto& t : p.terms()) {
+                auto& d = groups[p.ring().without(t.exponents, v)];
+                const uint32_t e = p.ring().exponent(t.exponents, v);
+                if (d.size() <= e) d.resize(e + 1, 0);
+                d[e] = t.coeff;
+            }
+            return groups;
+        }
+
+        // Monic gcd of the coefficients in Z/pZ[x_v]
+        Poly content_in(const ModularPolynomial& p, size_t v) {
+            Poly g;
+            for (auto& [_, d] : coefficients_in(p, v)) {
+                g = modular::gcd(p.domain(), std::move(g), std::move(d));
+                if (g.size() == 1) break;
+            }
+            return g;
+        }
+
+        // p with x_v = x
+        ModularPolynomial evaluate_at(const ModularPolynomial& p, size_t v, uint64_t x) {
+            const ModularField& field = p.domain();
+            std::vector<ModularPolynomial::Term> terms;
+            terms.reserve(p.size());
+            for (const auto& t : p.terms()) {
+                const uint32_t e = p.ring().exponent(t.exponents, v);
+                terms.push_back({ p.ring().without(t.exponents, v), field.mul(t.coeff, field.pow(x, e)) });
+            }
+            return ModularPolynomial::from_terms(p.ring_ptr(), std::move(terms), field);
+        }
+
+        ModularPolynomial monic(const ModularPolynomial& p) {
+            if (p.is_zero()) return p;
+            return p * p.domain().inverse(p.terms().front().coeff);
+        }
+
+        bool is_constant(const ModularPolynomial& p) {
+            return p.size() == 1 && p.terms().front().exponents == Exponents{};
+        }
+
+        // Brown's algorithm for the monic gcd of a and b, which contain no variable after x_v
+        ModularPolynomial brown(const ModularPolynomial& a, const ModularPolynomial& b, size_t v) {
+            const ModularField& field = a.domain();
+            if (a.is_zero()) return monic(b);
+            if (b.is_zero()) return monic(a);
+            if (v == 0) {
+                const auto da = coefficients_in(a, 0), db = coefficients_in(b, 0);
+                return from_dense(a, modular::gcd(field, da.begin()->second, db.begin()->second), 0);
+            }
+
+            const Poly ca = content_in(a, v), cb = content_in(b, v);
+            const auto pa = *divide_exact(a, from_dense(a, ca, v));
+            const auto pb = *divide_exact(b, from_dense(b, cb, v));
+            const Poly c = modular::gcd(field, ca, cb);
+            const Poly lead_a = coefficients_in(pa, v).begin()->second, lead_b = coefficients_in(pb, v).begin()->second;
+            const Poly gamma = modular::gcd(field, lead_a, lead_b);
+            // Degree in x_v of gamma times the gcd of the primitive parts
+            const size_t bound = std::min(pa.degree(v), pb.degree(v)) + degree(gamma);
+
+            std::optional<ModularPolynomial> h;
+            Exponents lead{};
+            Poly q;  // Product of (x_v - point) over the points in h
+            for (uint64_t point = 1;; ++point) {
+                if (point >= field.modulus()) throw std::runtime_error("gcd: ran out of evaluation points");
+                const uint64_t x = field.from_uint(point);
+                // Points where a leading coefficient vanishes change the degrees
+                if (modular::evaluate(field, lead_a, x) == 0 || modular::evaluate(field, lead_b, x) == 0) continue;
+
+                auto image = brown(evaluate_at(pa, v, x), evaluate_at(pb, v, x), v - 1);
+                if (is_constant(image)) return monic(from_dense(a, c, v));
+                image = image * modular::evaluate(field, gamma, x);
+
+                const Exponents image_lead = image.terms().front().exponents;
+                if (h && image_lead > lead) continue;  // Unlucky point
+                bool stable = false;
+                if (!h || image_lead < lead) {
+                    h = image;
+                    lead = image_lead;
+                    q = { field.neg(x), field.one() };
+                }
+                else {
+                    const auto delta = image - evaluate_at(*h, v, x);
+                    stable = delta.is_zero();
+                    if (!stable) *h = *h + delta * field.inverse(modular::evaluate(field, q, x)) * from_dense(a, q, v);
+                    q = modular::mul(field, q, { field.neg(x), field.one() });
+                }
+
+                if (stable || degree(q) > bound) {
+                    const auto candidate = *divide_exact(*h, from_dense(a, content_in(*h, v), v));
+                    if (divide_exact(pa, candidate) && divide_exact(pb, candidate)) {
+                        return monic(candidate * from_dense(a, c, v));
+                    }
+                    if (degree(q) > 2 * bound + 8) throw std::runtime_error("gcd: interpolation did not converge");
+                }
+            }
+        }
+
+        // --- Integer polynomials ---
+
+        ModularPolynomial reduce(const IntegerPolynomial& p, const ModularField& field) {
+            std::vector<ModularPolynomial::Term> terms;
+            terms.reserve(p.size());
+            for (const auto& t : p.terms()) terms.push_back({ t.exponents, field.from_integer(t.coeff) });
+            return ModularPolynomial::from_terms(p.ring_ptr(), std::move(terms), field);
+        }
+
+        // Coefficients of a Chinese-remainder reconstruction, symmetric modulo `modulus`
+        struct Reconstruction {
+            std::vector<IntegerPolynomial::Term> terms;
+            BigInt modulus = 1;
+        };
+
+        // Folds in an image modulo field.modulus(); returns whether no coefficient changed
+        bool combine(Reconstruction& r, const ModularPolynomial& image) {
+            const ModularField& field = image.domain();
+            const BigInt p(static_cast<int64_t>(field.modulus()));
+            const BigInt next_modulus = r.modulus * p;
+            const uint64_t inverse = field.inverse(field.from_integer(r.modulus));
+            bool unchanged = true;
+
+            std::vector<IntegerPolynomial::Term> merged;
+            merged.reserve(std::max(r.terms.size(), image.size()));
+            auto old = r.terms.begin();
+            auto add = image.terms().begin();
+            while (old != r.terms.end() || add != image.terms().end()) {
+                Exponents e;
+                BigInt value = 0;
+                uint64_t residue = 0;
+                if (add == image.terms().end() || (old != r.terms.end() && old->exponents > add->exponents)) {
+                    e = old->exponents;
+                    value = (old++)->coeff;
+                }
+                else if (old == r.terms.end() || add->exponents > old->exponents) {
+                    e = add->exponents;
+                    residue = (add++)->coeff;
+                }
+                else {
+                    e = old->exponents;
+                    value = (old++)->coeff;
+                    residue = (add++)->coeff;
+                }
+                // value + modulus * t is residue mod p
+                const uint64_t t = field.to_uint(field.mul(field.sub(residue, field.from_integer(value)), inverse));
+                if (t != 0) {
+                    unchanged = false;
+                    value = value + r.modulus * BigInt(static_cast<int64_t>(t));
+                    if (value * BigInt(2) > next_modulus) value = value - next_modulus;
+                }
+                if (!value.is_zero()) merged.push_back({ e, std::move(value) });
+            }
+            r.terms = std::move(merged);
+            r.modulus = next_modulus;
+            return unchanged;
+        }
+
+    } // namespace
+
+    template <class Domain>
+    std::optional<BasicSparsePolynomial<Domain>> divide_exact(const BasicSparsePolynomial<Domain>& a,
+                                                              const BasicSparsePolynomial<Domain>& b) {
+        auto [quotient, remainder] = divide(a, b, true);
+        if (!remainder.is_zero()) return std::nullopt;
+        return std::move(quotient);
+    }
+
+    template std::optional<SparsePolynomial> divide_exact(const SparsePolynomial&, const SparsePolynomial&);
+    template std::optional<IntegerPolynomial> divide_exact(const IntegerPolynomial&, const IntegerPolynomial&);
+    template std::optional<RationalPolynomial> divide_exact(const RationalPolynomial&, const RationalPolynomial&);
+    template std::optional<ModularPolynomial> divide_exact(const ModularPolynomial&, const ModularPolynomial&);
+
+    ModularPolynomial gcd(const ModularPolynomial& a, const ModularPolynomial& b) {
+        if (!(a.ring() == b.ring()) || !(a.domain() == b.domain())) {
+            throw std::invalid_argument("Polynomials belong to different rings");
+        }
+        if (a.ring().size() == 0) {
+            if (a.is_zero() && b.is_zero()) return a;
+            return ModularPolynomial::constant(a.ring_ptr(), a.domain().one(), a.domain());
+        }
+        return brown(a, b, a.ring().size() - 1);
+    }
+
+    BigInt content(const IntegerPolynomial& p) {
+        BigInt g = 0;
+        for (const auto& t : p.terms()) {
+            g = gcd(g, t.coeff);
+            if (g == 1) break;
+        }
+        return g;
+    }
+
+    IntegerPolynomial primitive_part(const IntegerPolynomial& p) {
+        if (p.is_zero()) return p;
+        BigInt c = content(p);
+        if (p.terms().front().coeff.sign() < 0) c = -c;
+        std::vector<IntegerPolynomial::Term> terms;
+        terms.reserve(p.size());
+        for (const auto& t : p.terms()) terms.push_back({ t.exponents, t.coeff / c });
+        return IntegerPolynomial::from_terms(p.ring_ptr(), std::move(terms));
+    }
+
+    uint64_t modular_prime(size_t index) {
+        static std::mutex mutex;
+        static std::vector<uint64_t> primes;
+        std::lock_guard<std::mutex> lock(mutex);
+        while (primes.size() <= index) {
+            uint64_t candidate = primes.empty() ? (uint64_t(1) << 62) - 1 : primes.back() - 2;
+            while (!ModularField::is_prime(candidate)) candidate -= 2;
+            primes.push_back(candidate);
+        }
+        return primes[index];
+    }
+
+    ModularField modular_field(size_t index) {
+        static std::mutex mutex;
+        static std::vector<ModularField> fields;
+        std::lock_guard<std::mutex> lock(mutex);
+        while (fields.size() <= index) fields.emplace_back(modular_prime(fields.size()));
+        return fields[index];
+    }
+
+    IntegerPolynomial gcd(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+        if (!(a.ring() == b.ring())) throw std::invalid_argument("Polynomials belong to different rings");
+        if (a.is_zero()) return b.is_zero() ? b : b * BigInt(b.terms().front().coeff.sign());
+        if (b.is_zero()) return a * BigInt(a.terms().front().coeff.sign());
+
+        const BigInt common = gcd(content(a), content(b));
+        const auto scaled = [&](const IntegerPolynomial& p) { return p * common; };
+        const auto pa = primitive_part(a), pb = primitive_part(b);
+        const auto one = IntegerPolynomial::constant(a.ring_ptr(), 1);
+        if (a.ring().size() == 0) return scaled(one);
+
+        const BigInt& lead_a = pa.terms().front().coeff;
+        const BigInt& lead_b = pb.terms().front().coeff;
+        const BigInt gamma = gcd(lead_a, lead_b);
+        const size_t last = a.ring().size() - 1;
+
+        // Each batch reduces by one prime per participating thread
+        const size_t batch = ThreadPool::in_job() ? 1 : ThreadPool::instance().concurrency();
+        std::optional<Reconstruction> h;
+        Exponents lead{};
+        for (size_t next = 0;;) {
+            std::vector<ModularField> fields;
+            while (fields.size() < batch) {
+                ModularField field = modular_field(next++);
+                const BigInt p(static_cast<int64_t>(field.modulus()));
+                // Leading coefficients must survive the reduction
+                if ((lead_a % p).is_zero() || (lead_b % p).is_zero()) continue;
+                fields.push_back(field);
+            }
+
+            std::vector<std::optional<ModularPolynomial>> images(fields.size());
+            const auto image_of = [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const ModularField& field = fields[i];
+                    images[i] = brown(reduce(pa, field), reduce(pb, field), last) * field.from_integer(gamma);
+                }
+            };
+            if (fields.size() > 1) ThreadPool::instance().parallel_for(fields.size(), 1, image_of);
+            else image_of(0, 0, fields.size());
+
+            for (const auto& image : images) {
+                if (is_constant(*image)) return scaled(one);
+                const Exponents image_lead = image->terms().front().exponents;
+                if (h && image_lead > lead) continue;  // Unlucky prime
+                if (!h || image_lead < lead) {
+                    h.emplace();
+                    lead = image_lead;
+                    combine(*h, *image);
+                    continue;
+                }
+                if (!combine(*h, *image)) continue;
+                const auto candidate = primitive_part(IntegerPolynomial::from_terms(a.ring_ptr(), h->terms));
+                if (divide_exact(pa, candidate) && divide_exact(pb, candidate)) return scaled(candidate);
+            }
+        }
+    }
+
+} // namespace aleph3
@@ -0,0 +1,146 @@
+#include "algebra/RationalFunction.hpp"
+#include "algebra/PolynomialGcd.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace aleph3 {
+
+    namespace {
+        bool is_constant(const IntegerPolynomial& p) {
+            return p.size() <= 1 && (p.is_zero() || p.terms().front().exponents == Exponents{});
+        }
+
+        bool is_one(const IntegerPolynomial& p) {
+            return is_constant(p) && !p.is_zero() && p.terms().front().coeff == BigInt(1);
+        }
+
+        bool same(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+            return std::equal(a.terms().begin(), a.terms().end(), b.terms().begin(), b.terms().end(),
+                              [](const auto& s, const auto& t) { return s.exponents == t.exponents && s.coeff == t.coeff; });
+        }
+
+        // a / b for a divisor b found by gcd
+        IntegerPolynomial quotient(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+            if (is_one(b)) return a;
+            auto q = divide_exact(a, b);
+            if (!q) throw std::logic_error("RationalFunction: gcd does not divide exactly");
+            return std::move(*q);
+        }
+    }
+
+    RationalFunction::RationalFunction(IntegerPolynomial numerator, IntegerPolynomial denominator)
+        : RationalFunction(std::move(numerator), std::move(denominator), false, 0) {
+        if (den_.is_zero()) throw std::domain_error("RationalFunction: zero denominator");
+        if (!(num_.ring() == den_.ring())) throw std::invalid_argument("RationalFunction: numerator and denominator in different rings");
+        if (is_one(den_)) {
+            reduced_ = true;
+            settled_ = size();
+        }
+    }
+
+    RationalFunction::RationalFunction(IntegerPolynomial p)
+        : RationalFunction(p, IntegerPolynomial::constant(p.ring_ptr(), BigInt(1)), true, 0) {
+        settled_ = size();
+    }
+
+    RationalFunction::RationalFunction(IntegerPolynomial numerator, IntegerPolynomial denominator, bool reduced, size_t settled)
+        : num_(std::move(numerator)), den_(std::move(denominator)), reduced_(reduced), settled_(settled) {}
+
+    RationalFunction& RationalFunction::normalize() {
+        if (num_.is_zero()) {
+            den_ = IntegerPolynomial::constant(num_.ring_ptr(), BigInt(1));
+        } else {
+            // gcd has the common integer content and a positive leading coefficient, so the
+            // denominator keeps the sign of its own
+            const auto g = gcd(num_, den_);
+            num_ = quotient(num_, g);
+            den_ = quotient(den_, g);
+            make_leading_positive();
+        }
+        reduced_ = true;
+        settled_ = size();
+        return *this;
+    }
+
+    void RationalFunction::make_leading_positive() {
+        if (den_.terms().front().coeff < BigInt(0)) {
+            num_ *= BigInt(-1);
+            den_ *= BigInt(-1);
+        }
+    }
+
+    RationalFunction& RationalFunction::settle() {
+        if (!reduced_ && size() > std::max(RATIONAL_NORMALIZE_TERMS, 2 * settled_)) normalize();
+        return *this;
+    }
+
+    RationalFunction RationalFunction::operator+(const RationalFunction& other) const {
+        if (!(num_.ring() == other.num_.ring())) throw std::invalid_argument("RationalFunction: operands in different rings");
+        if (num_.is_zero()) return other;
+        if (other.num_.is_zero()) return *this;
+        const bool reduced = reduced_ && other.reduced_;
+        const size_t settled = std::max(settled_, other.settled_);
+        // Integer denominators take an integer gcd, whose cofactor in the sum is cheap to
+        // cancel right away. Over an equal denominator the sum may still cancel with all of it.
+        if (is_constant(den_) && is_constant(other.den_)) {
+            const BigInt g = gcd(den_.terms().front().coeff, other.den_.terms().front().coeff);
+            const BigInt b = den_.terms().front().coeff / g, d = other.den_.terms().front().coeff / g;
+            RationalFunction sum(num_ * d + other.num_ * b, den_ * d, false, settled);
+            return reduced ? sum.normalize() : sum.settle();
+        }
+        if (same(den_, other.den_)) {
+            RationalFunction sum(num_ + other.num_, den_, false, settled);
+            return sum.num_.is_zero() ? sum.normalize() : sum.settle();
+        }
+        // Henrici: a/b + c/d = (a d' + c b') / (b' d) with b = b' g and d = d' g. The sum is
+        // prime to b' and d' for reduced operands, so only factors of g could cancel.
+        const auto g = gcd(den_, other.den_);
+        const auto b = quotient(den_, g), d = quotient(other.den_, g);
+        RationalFunction sum(num_ * d + other.num_ * b, b * other.den_, reduced && is_constant(g), settled);
+        if (sum.num_.is_zero()) return sum.normalize();
+        return sum.settle();
+    }
+
+    RationalFunction RationalFunction::operator-(const RationalFunction& other) const {
+        return *this + -other;
+    }
+
+    RationalFunction RationalFunction::operator*(const RationalFunction& other) const {
+        if (!(num_.ring() == other.num_.ring())) throw std::invalid_argument("RationalFunction: operands in different rings");
+        if (num_.is_zero() || other.num_.is_zero()) return RationalFunction(IntegerPolynomial(ring_ptr()));
+        const bool reduced = reduced_ && other.reduced_;
+        const size_t settled = std::max(settled_, other.settled_);
+        // Henrici: with a/b and c/d reduced, only a with d and c with b can share factors
+        const auto g1 = is_one(other.den_) ? other.den_ : gcd(num_, other.den_);
+        const auto g2 = is_one(den_) ? den_ : gcd(other.num_, den_);
+        RationalFunction product(quotient(num_, g1) * quotient(other.num_, g2), quotient(den_, g2) * quotient(other.den_, g1),
+                                 reduced, settled);
+        product.make_leading_positive();
+        return product.settle();
+    }
+
+    RationalFunction RationalFunction::operator/(const RationalFunction& other) const {
+        if (other.num_.is_zero()) throw std::domain_error("RationalFunction: division by zero");
+        return *this * RationalFunction(other.den_, other.num_, other.reduced_, other.settled_);
+    }
+
+    RationalFunction RationalFunction::operator-() const {
+        return RationalFunction(num_ * BigInt(-1), den_, reduced_, settled_);
+    }
+
+    RationalFunction power(const RationalFunction& base, int64_t exponent) {
+        if (exponent < 0) {
+            if (base.is_zero()) throw std::domain_error("RationalFunction: negative power of zero");
+            return power(RationalFunction(base.den_, base.num_, base.reduced_, base.settled_), -exponent);
+        }
+        // Powers of coprime polynomials stay coprime
+        const auto e = static_cast<uint32_t>(exponent);
+        RationalFunction result(power(base.num_, e), power(base.den_, e), base.reduced_, 0);
+        result.make_leading_positive();
+        result.settled_ = base.reduced_ ? result.size() : base.settled_;
+        return result;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,501 @@
+#include "algebra/Resultant.hpp"
+#include "algebra/ModularUnivariate.hpp"
+#include "algebra/PolynomialGcd.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+
+        using modular::Poly;
+        using modular::degree;
+
+        template <class Domain>
+        void check_ring(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b) {
+            if (!(a.ring() == b.ring()) || !(a.domain() == b.domain())) {
+                throw std::invalid_argument("Polynomials belong to different rings");
+            }
+        }
+
+        template <class Domain>
+        BasicSparsePolynomial<Domain> one_like(const BasicSparsePolynomial<Domain>& p) {
+            return BasicSparsePolynomial<Domain>::constant(p.ring_ptr(), p.domain().one(), p.domain());
+        }
+
+        // Coefficients of the powers of x_v, without x_v, lowest first
+        template <class Domain>
+        std::vector<BasicSparsePolynomial<Domain>> coefficients_in(const BasicSparsePolynomial<Domain>& p, size_t v) {
+            using Poly = BasicSparsePolynomial<Domain>;
+            std::vector<std::vector<typename Poly::Term>> groups(p.degree(v) + 1);
+            for (const auto& t : p.terms()) groups[p.ring().exponent(t.exponents, v)].push_back({ p.ring().without(t.exponents, v), t.coeff });
+            std::vector<Poly> out;
+            out.reserve(groups.size());
+            for (auto& terms : groups) out.push_back(Poly::from_terms(p.ring_ptr(), std::move(terms), p.domain()));
+            return out;
+        }
+
+        // Leading coefficient in x_v, without x_v
+        template <class Domain>
+        BasicSparsePolynomial<Domain> leading_coefficient(const BasicSparsePolynomial<Domain>& p, size_t v) {
+            using Poly = BasicSparsePolynomial<Domain>;
+            const uint32_t n = p.degree(v);
+            std::vector<typename Poly::Term> terms;
+            for (const auto& t : p.terms()) {
+                if (p.ring().exponent(t.exponents, v) == n) terms.push_back({ p.ring().without(t.exponents, v), t.coeff });
+            }
+            return Poly::from_terms(p.ring_ptr(), std::move(terms), p.domain());
+        }
+
+        // The resultant when a or b does not contain x_v, with da = deg_v(a) and db = deg_v(b)
+        template <class Domain>
+        std::optional<BasicSparsePolynomial<Domain>> degenerate(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b,
+                                                                uint32_t da, uint32_t db) {
+            if (a.is_zero() || b.is_zero()) return BasicSparsePolynomial<Domain>(a.ring_ptr(), a.domain());
+            if (da == 0) return power(a, db);
+            if (db == 0) return power(b, da);
+            return std::nullopt;
+        }
+
+        // --- Subresultant sequence in D[x_v] ---
+
+        // D is Z (BigInt) when no other variable occurs, else the integer polynomials in them
+        using Dense = std::vector<IntegerPolynomial>;
+
+        bool is_one(const BigInt& c) { return c == 1; }
+        bool is_one(const IntegerPolynomial& p) {
+            return p.size() == 1 && p.terms().front().exponents == Exponents{} && p.terms().front().coeff == 1;
+        }
+
+        BigInt quotient(const BigInt& a, const BigInt& b) { return is_one(b) ? a : a / b; }
+        IntegerPolynomial quotient(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+            if (is_one(b)) return a;
+            auto q = divide_exact(a, b);
+            if (!q) throw std::logic_error("Resultant: expected an exact division");
+            return std::move(*q);
+        }
+
+        BigInt raise(const BigInt& c, size_t n) { return pow(c, n); }
+        IntegerPolynomial raise(const IntegerPolynomial& p, size_t n) { return power(p, static_cast<uint32_t>(n)); }
+
+        BigInt integer_content(const BigInt& c) { return abs(c); }
+        IntegerPolynomial without_content(const IntegerPolynomial& p, const BigInt& c) {
+            std::vector<IntegerPolynomial::Term> terms;
+            terms.reserve(p.size());
+            for (const auto& t : p.terms()) terms.push_back({ t.exponents, t.coeff / c });
+            return IntegerPolynomial::from_terms(p.ring_ptr(), std::move(terms));
+        }
+        BigInt integer_content(const IntegerPolynomial& p) { return content(p); }
+        BigInt without_content(const BigInt& a, const BigInt& c) { return a / c; }
+
+        template <class C>
+        void trim(std::vector<C>& a) {
+            while (!a.empty() && a.back().is_zero()) a.pop_back();
+        }
+
+        // lc(b)^(deg a - deg b + 1) a mod b, for deg a >= deg b
+        template <class C>
+        std::vector<C> pseudo_remainder(std::vector<C> r, const std::vector<C>& b) {
+            const size_t n = b.size() - 1;
+            const C& lead = b.back();
+            const bool monic = is_one(lead);
+            size_t unused = r.size() - b.size() + 1;
+            while (r.size() >= b.size()) {
+                const C c = std::move(r.back());
+                r.pop_back();
+                const size_t shift = r.size() - n;
+                if (!monic) {
+                    for (auto& coeff : r) coeff *= lead;
+                }
+                for (size_t k = 0; k < n; ++k) r[k + shift] -= c * b[k];
+                trim(r);
+                --unused;
+            }
+            if (unused > 0 && !monic) {
+                const C scale = raise(lead, unused);
+                for (auto& coeff : r) coeff *= scale;
+            }
+            return r;
+        }
+
+        // Cohen, Algorithm 3.3.7, for deg A >= deg B > 0, with the integer contents taken out
+        template <class C>
+        C subresultant_sequence(std::vector<C> A, std::vector<C> B, const C& zero, const C& one) {
+            const auto primitive = [](std::vector<C>& p) {
+                BigInt c = 0;
+                for (const auto& coeff : p) {
+                    c = gcd(c, integer_content(coeff));
+                    if (c == 1) return c;
+                }
+                for (auto& coeff : p) coeff = without_content(coeff, c);
+                return c;
+            };
+            const size_t m = A.size() - 1, n = B.size() - 1;
+            const BigInt ca = primitive(A), cb = primitive(B);
+            const BigInt scale = pow(ca, n) * pow(cb, m);
+
+            bool negate = false;
+            C g = one, h = one;
+            while (B.size() > 1) {
+                const size_t delta = A.size() - B.size();
+                if ((A.size() - 1) % 2 == 1 && (B.size() - 1) % 2 == 1) negate = !negate;
+                std::vector<C> R = pseudo_remainder(std::move(A), B);
+                if (R.empty()) return zero;
+                A = std::move(B);
+                const C divisor = g * raise(h, delta);
+                for (auto& coeff : R) coeff = quotient(coeff, divisor);
+                B = std::move(R);
+                g = A.back();
+                if (delta == 1) h = g;
+                else if (delta > 1) h = quotient(raise(g, delta), raise(h, delta - 1));
+            }
+            const size_t d = A.size() - 1;
+            h = d == 1 ? B[0] : quotient(raise(B[0], d), raise(h, d - 1));
+            return h * (negate ? -scale : scale);
+        }
+
+        // Whether x_v is the only variable in a or b
+        template <class Domain>
+        bool univariate_in(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b, size_t v) {
+            const auto in_v = [&](const auto& p) {
+                return std::all_of(p.terms().begin(), p.terms().end(), [&](const auto& t) { return p.ring().without(t.exponents, v) == Exponents{}; });
+            };
+            return in_v(a) && in_v(b);
+        }
+
+        // --- Dense images over Z/pZ ---
+
+        using Extents = std::vector<size_t>;
+
+        size_t volume(const Extents& extents, size_t count) {
+            size_t n = 1;
+            for (size_t i = 0; i < count; ++i) n *= extents[i];
+            return n;
+        }
+
+        // Dense coefficients are stored flat, with x_v outermost and then the other variables
+        // that occur, in ring order, the last one innermost
+        struct Layout {
+            std::vector<size_t> variables;  // v, then the others
+            Extents a, b;                   // Degrees plus one, per variable
+            Extents result;                 // Degree bounds plus one, per other variable
+        };
+
+        template <class Domain>
+        Layout layout_of(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b, size_t v) {
+            Layout layout;
+            layout.variables.push_back(v);
+            for (size_t w = 0; w < a.ring().size(); ++w) {
+                if (w != v && (a.degree(w) > 0 || b.degree(w) > 0)) layout.variables.push_back(w);
+            }
+            for (size_t w : layout.variables) {
+                layout.a.push_back(size_t(a.degree(w)) + 1);
+                layout.b.push_back(size_t(b.degree(w)) + 1);
+            }
+            const size_t da = layout.a[0] - 1, db = layout.b[0] - 1;
+            for (size_t i = 1; i < layout.variables.size(); ++i) layout.result.push_back(db * (layout.a[i] - 1) + da * (layout.b[i] - 1) + 1);
+            return layout;
+        }
+
+        bool fits(const Layout& layout) {
+            const size_t n = layout.variables.size();
+            return volume(layout.a, n) <= DENSE_BOX_LIMIT && volume(layout.b, n) <= DENSE_BOX_LIMIT &&
+                   volume(layout.result, n - 1) <= DENSE_BOX_LIMIT;
+        }
+
+        template <class Domain, class Convert>
+        Poly to_flat(const BasicSparsePolynomial<Domain>& p, const Layout& layout, const Extents& extents, Convert convert) {
+            Poly flat(volume(extents, extents.size()), 0);
+            for (const auto& t : p.terms()) {
+                size_t i = 0;
+                for (size_t k = 0; k < extents.size(); ++k) i = i * extents[k] + p.ring().exponent(t.exponents, layout.variables[k]);
+                flat[i] = convert(t.coeff);
+            }
+            return flat;
+        }
+
+        // The monomial of each flat index of the result
+        std::vector<Exponents> result_monomials(const PolynomialRing& ring, const Layout& layout) {
+            const size_t n = layout.result.size();
+            std::vector<Exponents> monomials(volume(layout.result, n));
+            for (size_t i = 0; i < monomials.size(); ++i) {
+                Exponents e{};
+                for (size_t k = n, rest = i; k-- > 0; rest /= layout.result[k]) {
+                    e = ring.multiply(e, ring.power_of(layout.variables[k + 1], static_cast<uint32_t>(rest % layout.result[k])));
+                }
+                monomials[i] = e;
+            }
+            return monomials;
+        }
+
+        // Whether the coefficient of the highest power of x_v, the last part of a flat array, is nonzero
+        bool keeps_degree(const Poly& flat, size_t slice) {
+            return std::any_of(flat.end() - static_cast<std::ptrdiff_t>(slice), flat.end(), [](uint64_t c) { return c != 0; });
+        }
+
+        // flat with its innermost variable, of extent `inner`, set to x
+        void evaluate_innermost(const ModularField& field, const Poly& flat, size_t inner, uint64_t x, Poly& out) {
+            out.resize(flat.size() / inner);
+            for (size_t o = 0; o < out.size(); ++o) {
+                const uint64_t* c = flat.data() + o * inner;
+                uint64_t value = 0;
+                for (size_t i = inner; i-- > 0;) value = field.add(field.mul(value, x), c[i]);
+                out[o] = value;
+            }
+        }
+
+        // Res(a, b) of univariate polynomials of positive degree, by the remainder sequence
+        // Res(a, b) = (-1)^(deg a deg b) lc(b)^(deg a - deg r) Res(b, r) for r = a mod b. The
+        // steps take pseudo-remainders c r, for c = lc(b)^(deg a - deg b + 1), and divide by
+        // c^deg b once at the end, so there is one inverse instead of one per step.
+        uint64_t euclidean_resultant(const ModularField& field, Poly a, Poly b) {
+            uint64_t numerator = field.one(), denominator = field.one();
+            while (degree(b) > 0) {
+                const size_t m = degree(a), n = degree(b);
+                const uint64_t lead = b.back();
+                for (size_t k = m + 1; k-- > n;) {
+                    const uint64_t c = a[k];
+                    for (size_t i = 0; i < k; ++i) a[i] = field.mul(a[i], lead);
+                    if (c == 0) continue;
+                    for (size_t j = 0; j < n; ++j) a[k - n + j] = field.sub(a[k - n + j], field.mul(c, b[j]));
+                }
+                a.resize(n);
+                modular::trim(a);
+                if (a.empty()) return field.zero();
+                if (m % 2 == 1 && n % 2 == 1) numerator = field.neg(numerator);
+                numerator = field.mul(numerator, field.pow(lead, m - degree(a)));
+                denominator = field.mul(denominator, field.pow(lead, (m - n + 1) * n));
+                std::swap(a, b);
+            }
+            numerator = field.mul(numerator, field.pow(b.back(), degree(a)));
+            return field.divide(numerator, denominator);
+        }
+
+        // Res(a, b) for flat a and b in x_v and the first `level` other variables, keeping
+        // their degree in x_v, as flat coefficients in those variables
+        Poly dense_resultant(const ModularField& field, const Poly& a, const Poly& b, const Layout& layout, size_t level) {
+            if (level == 0) return { euclidean_resultant(field, a, b) };
+
+            // Newton interpolation in the innermost variable: each coefficient of `result`
+            // agrees with the images at the points so far, and vanishing is their product
+            // of (x_w - point)
+            const size_t points = layout.result[level - 1], coefficients = volume(layout.result, level - 1);
+            const size_t slice_a = volume(layout.a, level) / layout.a[0], slice_b = volume(layout.b, level) / layout.b[0];
+            Poly result(coefficients * points, 0), vanishing{ field.one() }, ea, eb;
+            for (uint64_t k = 0, count = 0; count < points; ++k) {
+                const uint64_t point = field.from_uint(k);
+                evaluate_innermost(field, a, layout.a[level], point, ea);
+                evaluate_innermost(field, b, layout.b[level], point, eb);
+                if (!keeps_degree(ea, slice_a) || !keeps_degree(eb, slice_b)) continue;
+                const Poly image = dense_resultant(field, ea, eb, layout, level - 1);
+                const uint64_t scale = field.inverse(modular::evaluate(field, vanishing, point));
+                for (size_t i = 0; i < coefficients; ++i) {
+                    uint64_t* r = result.data() + i * points;
+                    uint64_t value = 0;
+                    for (size_t j = count; j-- > 0;) value = field.add(field.mul(value, point), r[j]);
+                    const uint64_t c = field.mul(field.sub(image[i], value), scale);
+                    if (c == 0) continue;
+                    for (size_t j = 0; j < vanishing.size(); ++j) r[j] = field.add(r[j], field.mul(c, vanishing[j]));
+                }
+                vanishing = modular::mul(field, vanishing, Poly{ field.neg(point), field.one() });
+                ++count;
+            }
+            return result;
+        }
+
+        // --- Integer polynomials ---
+
+        BigInt norm1(const IntegerPolynomial& p) {
+            BigInt sum = 0;
+            for (const auto& t : p.terms()) sum = sum + abs(t.coeff);
+            return sum;
+        }
+
+        // Folds an image modulo field.modulus() into the coefficients, kept symmetric modulo `modulus`
+        void combine(std::vector<BigInt>& values, BigInt& modulus, const Poly& image, const ModularField& field) {
+            const BigInt next_modulus = modulus * BigInt(static_cast<int64_t>(field.modulus()));
+            const uint64_t inverse = field.inverse(field.from_integer(modulus));
+            for (size_t i = 0; i < values.size(); ++i) {
+                // value + modulus * t is the residue mod p
+                const uint64_t t = field.to_uint(field.mul(field.sub(image[i], field.from_integer(values[i])), inverse));
+                if (t == 0) continue;
+                values[i] = values[i] + modulus * BigInt(static_cast<int64_t>(t));
+                if (values[i] * BigInt(2) > next_modulus) values[i] = values[i] - next_modulus;
+            }
+            modulus = next_modulus;
+        }
+
+        // Fraction-free determinant of a square matrix over D; rows are consumed
+        IntegerPolynomial determinant(std::vector<Dense> m, const IntegerPolynomial& one) {
+            const size_t n = m.size();
+            if (n == 0) return one;
+            bool negate = false;
+            IntegerPolynomial previous = one;
+            for (size_t k = 0; k < n; ++k) {
+                size_t pivot = k;
+                while (pivot < n && m[pivot][k].is_zero()) ++pivot;
+                if (pivot == n) return IntegerPolynomial(one.ring_ptr());
+                if (pivot != k) {
+                    std::swap(m[pivot], m[k]);
+                    negate = !negate;
+                }
+                for (size_t i = k + 1; i < n; ++i) {
+                    for (size_t j = k + 1; j < n; ++j) {
+                        m[i][j] = quotient(m[i][j] * m[k][k] - m[i][k] * m[k][j], previous);
+                    }
+                }
+                previous = m[k][k];
+            }
+            return negate ? m[n - 1][n - 1] * BigInt(-1) : m[n - 1][n - 1];
+        }
+
+    } // namespace
+
+    IntegerPolynomial resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v) {
+        if (size_t(a.degree(v)) + b.degree(v) < RESULTANT_MODULAR_DEGREE && univariate_in(a, b, v)) return subresultant_resultant(a, b, v);
+        return modular_resultant(a, b, v);
+    }
+
+    ModularPolynomial resultant(const ModularPolynomial& a, const ModularPolynomial& b, size_t v) {
+        check_ring(a, b);
+        const uint32_t da = a.degree(v), db = b.degree(v);
+        if (auto r = degenerate(a, b, da, db)) return std::move(*r);
+        const Layout layout = layout_of(a, b, v);
+        if (!fits(layout)) throw std::length_error("Resultant: the dense images are too large");
+
+        const ModularField& field = a.domain();
+        const auto same = [](uint64_t c) { return c; };
+        const Poly image = dense_resultant(field, to_flat(a, layout, layout.a, same), to_flat(b, layout, layout.b, same), layout,
+                                           layout.result.size());
+        const auto monomials = result_monomials(a.ring(), layout);
+        std::vector<ModularPolynomial::Term> terms;
+        for (size_t i = 0; i < image.size(); ++i) {
+            if (image[i] != 0) terms.push_back({ monomials[i], image[i] });
+        }
+        return ModularPolynomial::from_terms(a.ring_ptr(), std::move(terms), field);
+    }
+
+    IntegerPolynomial subresultant_resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v) {
+        check_ring(a, b);
+        if (auto r = degenerate(a, b, a.degree(v), b.degree(v))) return std::move(*r);
+        // Res(a, b) = (-1)^(deg a deg b) Res(b, a)
+        const bool swap = a.degree(v) < b.degree(v);
+        const IntegerPolynomial& A = swap ? b : a;
+        const IntegerPolynomial& B = swap ? a : b;
+        const bool negate = swap && a.degree(v) % 2 == 1 && b.degree(v) % 2 == 1;
+
+        IntegerPolynomial result(a.ring_ptr());
+        if (univariate_in(a, b, v)) {
+            const auto dense = [&](const IntegerPolynomial& p) {
+                std::vector<BigInt> d(p.degree(v) + 1, BigInt(0));
+                for (const auto& t : p.terms()) d[p.ring().exponent(t.exponents, v)] = t.coeff;
+                return d;
+            };
+            result = IntegerPolynomial::constant(a.ring_ptr(), subresultant_sequence(dense(A), dense(B), BigInt(0), BigInt(1)));
+        }
+        else {
+            result = subresultant_sequence(coefficients_in(A, v), coefficients_in(B, v), result, one_like(a));
+        }
+        return negate ? result * BigInt(-1) : result;
+    }
+
+    IntegerPolynomial modular_resultant(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v) {
+        check_ring(a, b);
+        const uint32_t da = a.degree(v), db = b.degree(v);
+        if (auto r = degenerate(a, b, da, db)) return std::move(*r);
+        const Layout layout = layout_of(a, b, v);
+        if (!fits(layout)) return subresultant_resultant(a, b, v);
+        const size_t others = layout.result.size();
+        const size_t slice_a = volume(layout.a, others + 1) / layout.a[0], slice_b = volume(layout.b, others + 1) / layout.b[0];
+
+        // Each prime passes 2^61, and the product must pass twice the bound on the coefficients
+        // for the symmetric residues to be exact
+        const size_t bits = size_t(db) * norm1(a).bit_length() + size_t(da) * norm1(b).bit_length() + 1;
+        const size_t threads = ThreadPool::in_job() ? 1 : ThreadPool::instance().concurrency();
+        std::vector<BigInt> values(volume(layout.result, others), BigInt(0));
+        BigInt modulus = 1;
+        for (size_t next = 0, missing = bits / 61 + 1; missing > 0;) {
+            // One prime per participating thread
+            std::vector<ModularField> fields;
+            std::vector<std::pair<Poly, Poly>> reduced;
+            while (fields.size() < std::min(threads, missing)) {
+                const ModularField field = modular_field(next++);
+                const auto convert = [&](const BigInt& c) { return field.from_integer(c); };
+                Poly fa = to_flat(a, layout, layout.a, convert), fb = to_flat(b, layout, layout.b, convert);
+                // Leading coefficients must survive the reduction
+                if (!keeps_degree(fa, slice_a) || !keeps_degree(fb, slice_b)) continue;
+                fields.push_back(field);
+                reduced.emplace_back(std::move(fa), std::move(fb));
+            }
+
+            std::vector<Poly> images(fields.size());
+            const auto image_of = [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) images[i] = dense_resultant(fields[i], reduced[i].first, reduced[i].second, layout, others);
+            };
+            if (fields.size() > 1) ThreadPool::instance().parallel_for(fields.size(), 1, image_of);
+            else image_of(0, 0, fields.size());
+            for (size_t i = 0; i < fields.size(); ++i) combine(values, modulus, images[i], fields[i]);
+            missing -= fields.size();
+        }
+
+        const auto monomials = result_monomials(a.ring(), layout);
+        std::vector<IntegerPolynomial::Term> terms;
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (!values[i].is_zero()) terms.push_back({ monomials[i], std::move(values[i]) });
+        }
+        return IntegerPolynomial::from_terms(a.ring_ptr(), std::move(terms));
+    }
+
+    IntegerPolynomial discriminant(const IntegerPolynomial& f, size_t v) {
+        const uint32_t n = f.degree(v);
+        if (n == 0) return IntegerPolynomial(f.ring_ptr());
+
+        const PolynomialRing& ring = f.ring();
+        const Exponents step = ring.power_of(v, 1);
+        std::vector<IntegerPolynomial::Term> terms;
+        for (const auto& t : f.terms()) {
+            const uint32_t e = ring.exponent(t.exponents, v);
+            if (e > 0) terms.push_back({ *ring.divide(t.exponents, step), t.coeff * BigInt(static_cast<int64_t>(e)) });
+        }
+        const IntegerPolynomial derivative = IntegerPolynomial::from_terms(f.ring_ptr(), std::move(terms));
+
+        IntegerPolynomial d = quotient(resultant(f, derivative, v), leading_coefficient(f, v));
+        return (size_t(n) * (n - 1) / 2) % 2 == 1 ? d * BigInt(-1) : d;
+    }
+
+    std::vector<IntegerPolynomial> principal_subresultants(const IntegerPolynomial& a, const IntegerPolynomial& b, size_t v) {
+        check_ring(a, b);
+        if (a.is_zero() || b.is_zero()) return {};
+        const Dense A = coefficients_in(a, v), B = coefficients_in(b, v);
+        const size_t m = A.size() - 1, n = B.size() - 1;
+        const IntegerPolynomial zero(a.ring_ptr()), one = one_like(a);
+
+        std::vector<IntegerPolynomial> out;
+        out.reserve(std::min(m, n) + 1);
+        for (size_t j = 0; j <= std::min(m, n); ++j) {
+            // Rows x^k a for k < n - j and x^k b for k < m - j; columns x^(m + n - j - 1) down to x^j
+            const size_t size = m + n - 2 * j, top = m + n - j - 1;
+            std::vector<Dense> rows;
+            rows.reserve(size);
+            const auto add_rows = [&](const Dense& p, size_t count) {
+                for (size_t k = count; k-- > 0;) {
+                    Dense row(size, zero);
+                    for (size_t i = 0; i < p.size(); ++i) {
+                        if (i + k >= j) row[top - (i + k)] = p[i];
+                    }
+                    rows.push_back(std::move(row));
+                }
+            };
+            add_rows(A, n - j);
+            add_rows(B, m - j);
+            out.push_back(determinant(std::move(rows), one));
+        }
+        return out;
+    }
+
+} // namespace aleph3
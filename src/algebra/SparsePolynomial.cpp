@@ -0,0 +1,967 @@
+#include "algebra/SparsePolynomial.hpp"
+#include "algebra/DenseMultiply.hpp"
+#include "evaluator/Budget.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace aleph3 {
+
+    namespace {
+        struct Decreasing {
+            template <class Term>
+            bool operator()(const Term& a, const Term& b) const { return a.exponents > b.exponents; }
+        };
+
+        // A dense product is used when its box has at most this many cells per term pair,
+        // and a Kronecker product when there are at least this many term pairs per cell
+        constexpr size_t DENSE_CELLS_PER_PAIR = 4;
+        constexpr size_t KRONECKER_PAIRS_PER_CELL = 32;
+
+        // Cells in the box of every exponent vector up to the degrees of a * b, saturating
+        // past DENSE_BOX_LIMIT
+        template <class P>
+        size_t exponent_box(const P& a, const P& b) {
+            size_t box = 1;
+            for (size_t v = 0; v < a.ring().size(); ++v) {
+                box *= size_t(a.degree(v)) + b.degree(v) + 1;
+                if (box > DENSE_BOX_LIMIT) return DENSE_BOX_LIMIT + 1;
+            }
+            return box;
+        }
+
+        // Mixed-radix index into the exponent box of a * b, with the first variable most
+        // significant, so that larger indices are larger monomials. Radices fit the
+        // product, so the index of a product is the sum of its factors' indices.
+        class BoxIndex {
+        public:
+            template <class P>
+            BoxIndex(const P& a, const P& b)
+                : ring_(a.ring()), stride_(a.ring().size(), 1), exponents_(a.ring().size()) {
+                for (size_t v = stride_.size(); v-- > 1;) stride_[v - 1] = stride_[v] * (a.degree(v) + b.degree(v) + 1);
+            }
+
+            const PolynomialRing& ring() const { return ring_; }
+
+            size_t index(const Exponents& e) const {
+                size_t index = 0;
+                for (size_t v = 0; v < stride_.size(); ++v) index += ring_.exponent(e, v) * stride_[v];
+                return index;
+            }
+
+            Exponents exponents(size_t index) {
+                for (size_t v = 0; v < stride_.size(); ++v) {
+                    exponents_[v] = static_cast<uint32_t>(index / stride_[v]);
+                    index %= stride_[v];
+                }
+                return ring_.pack(exponents_);
+            }
+
+        private:
+            const PolynomialRing& ring_;
+            std::vector<size_t> stride_;
+            std::vector<uint32_t> exponents_;
+        };
+
+        // Dense univariate images of a and b under the Kronecker substitution of `box`
+        template <class P, class ToDouble>
+        std::pair<std::vector<double>, std::vector<double>> substitute(const BoxIndex& box, const P& a, const P& b,
+                                                                       ToDouble to_double) {
+            const auto image = [&](const P& p) {
+                // The leading term has the largest index
+                std::vector<double> dense(box.index(p.terms().front().exponents) + 1, 0.0);
+                for (const auto& t : p.terms()) dense[box.index(t.exponents)] = to_double(t.coeff);
+                return dense;
+            };
+            return { image(a), image(b) };
+        }
+    }
+
+    namespace {
+        bool run_in_parallel(size_t pairs) {
+            return pairs >= PARALLEL_PAIRS && !ThreadPool::in_job() && ThreadPool::instance().concurrency() > 1;
+        }
+
+        // PRODUCT_SLICES - 1 decreasing monomials that cut the product of f and g into
+        // slices of about equal numbers of term pairs: quantiles of a sample of the pairs
+        template <class Term>
+        std::vector<Exponents> slice_bounds(const PolynomialRing& ring, const std::vector<Term>& f, const std::vector<Term>& g) {
+            constexpr size_t SAMPLES = PRODUCT_SLICES * 16;
+            std::vector<Exponents> sample;
+            sample.reserve(SAMPLES);
+            // Rows evenly spaced, columns from a fixed linear congruential sequence
+            uint64_t state = 0;
+            for (size_t k = 0; k < SAMPLES; ++k) {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                const size_t i = k * f.size() / SAMPLES, j = static_cast<size_t>((state >> 33) % g.size());
+                sample.push_back(ring.multiply(f[i].exponents, g[j].exponents));
+            }
+            std::sort(sample.begin(), sample.end(), std::greater<>());
+            std::vector<Exponents> bounds;
+            for (size_t r = 1; r < PRODUCT_SLICES; ++r) bounds.push_back(sample[r * SAMPLES / PRODUCT_SLICES]);
+            return bounds;
+        }
+
+        // The slices' terms in order. slice(upper, lower, out) writes the product's terms
+        // with lower <= monomial < upper, where a null bound is no bound.
+        template <class Term, class Slice>
+        std::vector<Term> product_slices(const std::vector<Exponents>& bounds, Slice slice) {
+            std::vector<std::vector<Term>> pieces(bounds.size() + 1);
+            ThreadPool::instance().parallel_for(pieces.size(), 1, [&](size_t, size_t begin, size_t end) {
+                for (size_t r = begin; r < end; ++r) {
+                    slice(r == 0 ? nullptr : &bounds[r - 1], r == bounds.size() ? nullptr : &bounds[r], pieces[r]);
+                }
+            });
+            size_t total = 0;
+            for (const auto& piece : pieces) total += piece.size();
+            std::vector<Term> out;
+            out.reserve(total);
+            for (auto& piece : pieces) std::move(piece.begin(), piece.end(), std::back_inserter(out));
+            return out;
+        }
+
+        // Number of leading indices k in [0, n) with at_least(k), for a predicate that holds
+        // on a prefix
+        template <class Predicate>
+        size_t prefix_length(size_t n, Predicate at_least) {
+            size_t lo = 0, hi = n;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (at_least(mid)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+
+        // How the product kernels add up products of coefficients: in the domain's own
+        // values, or for integer factors whose sums provably fit, in 128-bit words that
+        // become BigInts once per output term
+        template <class Domain>
+        struct DomainSums {
+            using Factor = typename Domain::value_type;
+            using Sum = typename Domain::value_type;
+            const Domain& domain;
+
+            template <class Term>
+            std::vector<Factor> factors(const std::vector<Term>& terms) const {
+                std::vector<Factor> out;
+                out.reserve(terms.size());
+                for (const auto& t : terms) out.push_back(t.coeff);
+                return out;
+            }
+            Sum zero() const { return domain.zero(); }
+            void add(Sum& sum, const Factor& x, const Factor& y) const { sum = domain.add(sum, domain.mul(x, y)); }
+            bool is_zero(const Sum& sum) const { return domain.is_zero(sum); }
+            Factor value(Sum& sum) const { return std::move(sum); }
+        };
+
+#if defined(__GNUC__) || defined(__clang__)
+        struct WideSums {
+            using Factor = int64_t;
+            using Sum = __int128;
+
+            // Every coefficient is a 64-bit word, and a sum of min(|f|, |g|) products stays
+            // below 2^126
+            template <class Term>
+            static bool fits(const std::vector<Term>& f, const std::vector<Term>& g) {
+                const auto largest = [](const std::vector<Term>& terms) -> std::optional<size_t> {
+                    size_t bits = 0;
+                    for (const auto& t : terms) {
+                        if (!t.coeff.is_small()) return std::nullopt;
+                        bits = std::max(bits, t.coeff.bit_length());
+                    }
+                    return bits;
+                };
+                const auto bf = largest(f), bg = largest(g);
+                return bf && bg && *bf + *bg + std::bit_width(std::min(f.size(), g.size())) <= 126;
+            }
+
+            template <class Term>
+            std::vector<Factor> factors(const std::vector<Term>& terms) const {
+                std::vector<Factor> out;
+                out.reserve(terms.size());
+                for (const auto& t : terms) out.push_back(t.coeff.small_value());
+                return out;
+            }
+            Sum zero() const { return 0; }
+            void add(Sum& sum, Factor x, Factor y) const { sum += static_cast<Sum>(x) * y; }
+            bool is_zero(Sum sum) const { return sum == 0; }
+            BigInt value(Sum sum) const {
+                const bool negative = sum < 0;
+                auto m = static_cast<unsigned __int128>(negative ? -sum : sum);
+                std::vector<uint32_t> limbs;
+                for (; m != 0; m >>= 32) limbs.push_back(static_cast<uint32_t>(m));
+                BigInt out = BigInt::from_magnitude(std::move(limbs));
+                return negative ? -out : out;
+            }
+        };
+#endif
+
+        // The coefficient of one monomial during a division, start - sum x * y. Over Z, the
+        // products of word-sized factors collect in a 128-bit word that spills into a BigInt
+        // on overflow, as the quotient's coefficients are not bounded in advance.
+        template <class Domain>
+        struct RunningDifference {
+            using Coeff = typename Domain::value_type;
+            const Domain& domain;
+            Coeff value;
+
+            void subtract(const Coeff& x, const Coeff& y) { value = domain.sub(value, domain.mul(x, y)); }
+            Coeff result() { return std::move(value); }
+        };
+
+#if defined(__GNUC__) || defined(__clang__)
+        template <>
+        struct RunningDifference<IntegerRing> {
+            const IntegerRing& domain;
+            BigInt value;
+            __int128 word = 0;
+
+            void subtract(const BigInt& x, const BigInt& y) {
+                if (x.is_small() && y.is_small()) {
+                    const __int128 product = static_cast<__int128>(x.small_value()) * y.small_value();
+                    __int128 next;
+                    if (__builtin_sub_overflow(word, product, &next)) {
+                        value = value + WideSums{}.value(word);
+                        next = -product;
+                    }
+                    word = next;
+                    return;
+                }
+                value = value - x * y;
+            }
+            BigInt result() { return word == 0 ? std::move(value) : value + WideSums{}.value(word); }
+        };
+#endif
+
+        // kernel(sums) with the fastest sums that are exact for f * g
+        template <class Domain, class Term, class Kernel>
+        auto with_sums(const Domain& domain, const std::vector<Term>& f, const std::vector<Term>& g, Kernel kernel) {
+#if defined(__GNUC__) || defined(__clang__)
+            if constexpr (std::is_same_v<Domain, IntegerRing>) {
+                if (WideSums::fits(f, g)) return kernel(WideSums{});
+            }
+#endif
+            return kernel(DomainSums<Domain>{ domain });
+        }
+
+        // Terms of f * g by the heap merge, where f is the smaller factor. Row i enters the
+        // heap once (i - 1, 0) is popped, and (i, j + 1) replaces (i, j), so the heap holds at
+        // most one entry per term of f.
+        template <class Term, class Sums>
+        std::vector<Term> heap_product(const PolynomialRing& ring, const std::vector<Term>& f, const std::vector<Term>& g,
+                                       const Sums& sums) {
+            // Entry (i, j) stands for f[i] * g[j]
+            struct Entry {
+                Exponents exponents;
+                uint32_t i, j;
+            };
+            const auto later = [](const Entry& x, const Entry& y) { return x.exponents < y.exponents; };
+            const auto cf = sums.factors(f), cg = sums.factors(g);
+
+            if (run_in_parallel(f.size() * g.size())) {
+                return product_slices<Term>(slice_bounds(ring, f, g), [&](const Exponents* upper, const Exponents* lower,
+                                                                          std::vector<Term>& out) {
+                    // Row i runs over the j in [start, stop[i]) whose products lie in the slice.
+                    // Rows no longer enter in turn, as a row's first product in the slice can
+                    // pass the previous row's.
+                    std::vector<Entry> heap;
+                    std::vector<uint32_t> stop(f.size());
+                    for (uint32_t i = 0; i < f.size(); ++i) {
+                        const auto reaching = [&](const Exponents& bound) {
+                            return prefix_length(g.size(), [&](size_t j) { return ring.multiply(f[i].exponents, g[j].exponents) >= bound; });
+                        };
+                        const auto start = static_cast<uint32_t>(upper ? reaching(*upper) : 0);
+                        stop[i] = static_cast<uint32_t>(lower ? reaching(*lower) : g.size());
+                        if (start < stop[i]) heap.push_back({ ring.multiply(f[i].exponents, g[start].exponents), i, start });
+                    }
+                    std::make_heap(heap.begin(), heap.end(), later);
+                    while (!heap.empty()) {
+                        poll_budget();
+                        const Exponents monomial = heap.front().exponents;
+                        auto sum = sums.zero();
+                        do {
+                            std::pop_heap(heap.begin(), heap.end(), later);
+                            Entry& e = heap.back();
+                            sums.add(sum, cf[e.i], cg[e.j]);
+                            if (++e.j < stop[e.i]) {
+                                e.exponents = ring.multiply(f[e.i].exponents, g[e.j].exponents);
+                                std::push_heap(heap.begin(), heap.end(), later);
+                            }
+                            else {
+                                heap.pop_back();
+                            }
+                        } while (!heap.empty() && heap.front().exponents == monomial);
+                        if (!sums.is_zero(sum)) out.push_back({ monomial, sums.value(sum) });
+                    }
+                });
+            }
+
+            std::vector<Term> out;
+            std::vector<Entry> heap;
+            heap.reserve(f.size());
+            heap.push_back({ ring.multiply(f[0].exponents, g[0].exponents), 0, 0 });
+            while (!heap.empty()) {
+                poll_budget();
+                const Exponents monomial = heap.front().exponents;
+                auto sum = sums.zero();
+                do {
+                    std::pop_heap(heap.begin(), heap.end(), later);
+                    const Entry e = heap.back();
+                    heap.pop_back();
+                    sums.add(sum, cf[e.i], cg[e.j]);
+                    if (e.j == 0 && e.i + 1 < f.size()) {
+                        heap.push_back({ ring.multiply(f[e.i + 1].exponents, g[0].exponents), e.i + 1, 0 });
+                        std::push_heap(heap.begin(), heap.end(), later);
+                    }
+                    if (e.j + 1 < g.size()) {
+                        heap.push_back({ ring.multiply(f[e.i].exponents, g[e.j + 1].exponents), e.i, e.j + 1 });
+                        std::push_heap(heap.begin(), heap.end(), later);
+                    }
+                } while (!heap.empty() && heap.front().exponents == monomial);
+                if (!sums.is_zero(sum)) out.push_back({ monomial, sums.value(sum) });
+            }
+            return out;
+        }
+
+        // Terms of a * b by adding into the cells of its exponent box
+        template <class Term, class Sums>
+        std::vector<Term> dense_product(const BoxIndex& box_index, size_t box, const std::vector<Term>& a,
+                                        const std::vector<Term>& b, const Sums& sums) {
+            const auto ca = sums.factors(a), cb = sums.factors(b);
+            std::vector<size_t> a_index(a.size()), b_index(b.size());
+            for (size_t i = 0; i < a.size(); ++i) a_index[i] = box_index.index(a[i].exponents);
+            for (size_t j = 0; j < b.size(); ++j) b_index[j] = box_index.index(b[j].exponents);
+
+            // The terms with monomials in the index range [lo, hi). Box indices follow the
+            // monomial order, so for each term of a the j that land there are a range too.
+            const auto cells_product = [&](size_t lo, size_t hi, std::vector<Term>& out) {
+                BoxIndex local = box_index;
+                std::vector<typename Sums::Sum> cells(hi - lo, sums.zero());
+                for (size_t i = 0; i < a.size(); ++i) {
+                    poll_budget();
+                    const size_t base = a_index[i];
+                    const auto reaching = [&](size_t bound) {
+                        return prefix_length(b.size(), [&](size_t j) { return base + b_index[j] >= bound; });
+                    };
+                    for (size_t j = reaching(hi), stop = reaching(lo); j < stop; ++j) {
+                        sums.add(cells[base + b_index[j] - lo], ca[i], cb[j]);
+                    }
+                }
+                for (size_t index = cells.size(); index-- > 0;) {
+                    if (!sums.is_zero(cells[index])) out.push_back({ local.exponents(lo + index), sums.value(cells[index]) });
+                }
+            };
+
+            if (run_in_parallel(a.size() * b.size())) {
+                return product_slices<Term>(slice_bounds(box_index.ring(), a, b), [&](const Exponents* upper, const Exponents* lower,
+                                                                                      std::vector<Term>& out) {
+                    cells_product(lower ? box_index.index(*lower) : 0, upper ? box_index.index(*upper) : box, out);
+                });
+            }
+            std::vector<Term> out;
+            cells_product(0, box, out);
+            return out;
+        }
+    }
+
+    // --- PolynomialRing ---
+
+    PolynomialRing::PolynomialRing(std::vector<std::string> variables) : variables_(std::move(variables)) {
+        const size_t n = variables_.size();
+        if (n > MAX_VARIABLES) {
+            throw std::invalid_argument("PolynomialRing supports at most " + std::to_string(MAX_VARIABLES) + " variables");
+        }
+        if (n <= 4) bits_ = 32;
+        else if (n <= 8) bits_ = 16;
+        else if (n <= 16) bits_ = 8;
+        else bits_ = 4;
+        per_word_ = 64 / bits_;
+        for (size_t v = 0; v < n; ++v) word(guards_, v) |= uint64_t(1) << (shift(v) + bits_ - 1);
+    }
+
+    std::optional<size_t> PolynomialRing::index_of(const std::string& variable) const {
+        auto it = std::find(variables_.begin(), variables_.end(), variable);
+        if (it == variables_.end()) return std::nullopt;
+        return static_cast<size_t>(it - variables_.begin());
+    }
+
+    Exponents PolynomialRing::pack(const std::vector<uint32_t>& exponents) const {
+        Exponents e;
+        for (size_t v = 0; v < exponents.size() && v < variables_.size(); ++v) {
+            if (exponents[v] > max_exponent()) throw std::overflow_error("Polynomial exponent overflow");
+            word(e, v) |= uint64_t(exponents[v]) << shift(v);
+        }
+        return e;
+    }
+
+    Exponents PolynomialRing::power_of(size_t variable, uint32_t exponent) const {
+        if (exponent > max_exponent()) throw std::overflow_error("Polynomial exponent overflow");
+        Exponents e;
+        word(e, variable) = uint64_t(exponent) << shift(variable);
+        return e;
+    }
+
+    uint32_t PolynomialRing::exponent(const Exponents& e, size_t variable) const {
+        const uint64_t mask = (uint64_t(1) << bits_) - 1;
+        return static_cast<uint32_t>((word(e, variable) >> shift(variable)) & mask);
+    }
+
+    uint32_t PolynomialRing::total_degree(const Exponents& e) const {
+        uint32_t degree = 0;
+        for (size_t v = 0; v < variables_.size(); ++v) degree += exponent(e, v);
+        return degree;
+    }
+
+    Exponents PolynomialRing::multiply(const Exponents& a, const Exponents& b) const {
+        const Exponents product{ a.hi + b.hi, a.lo + b.lo };
+        if ((product.hi & guards_.hi) | (product.lo & guards_.lo)) {
+            throw std::overflow_error("Polynomial exponent overflow");
+        }
+        return product;
+    }
+
+    std::optional<Exponents> PolynomialRing::divide(const Exponents& a, const Exponents& b) const {
+        // With every guard bit set, a field borrows from its guard exactly when it would go negative
+        const Exponents q{ (a.hi | guards_.hi) - b.hi, (a.lo | guards_.lo) - b.lo };
+        if ((q.hi & guards_.hi) != guards_.hi || (q.lo & guards_.lo) != guards_.lo) return std::nullopt;
+        return Exponents{ q.hi & ~guards_.hi, q.lo & ~guards_.lo };
+    }
+
+    Exponents PolynomialRing::without(const Exponents& e, size_t variable) const {
+        Exponents result = e;
+        word(result, variable) &= ~(((uint64_t(1) << bits_) - 1) << shift(variable));
+        return result;
+    }
+
+    // --- BasicSparsePolynomial ---
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>::BasicSparsePolynomial(std::shared_ptr<const PolynomialRing> ring, Domain domain)
+        : ring_(std::move(ring)), domain_(std::move(domain)) {}
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::constant(std::shared_ptr<const PolynomialRing> ring, Coeff value,
+                                                                          Domain domain) {
+        BasicSparsePolynomial p(std::move(ring), std::move(domain));
+        if (!p.domain_.is_zero(value)) p.terms_.push_back({ Exponents{}, std::move(value) });
+        return p;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::variable(std::shared_ptr<const PolynomialRing> ring, size_t index,
+                                                                          uint32_t exponent, Domain domain) {
+        BasicSparsePolynomial p(std::move(ring), std::move(domain));
+        p.terms_.push_back({ p.ring_->power_of(index, exponent), p.domain_.one() });
+        return p;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::from_terms(std::shared_ptr<const PolynomialRing> ring,
+                                                                            std::vector<Term> terms, Domain domain) {
+        std::sort(terms.begin(), terms.end(), Decreasing{});
+        BasicSparsePolynomial p(std::move(ring), std::move(domain));
+        p.terms_ = std::move(terms);
+        // Combine runs of equal monomials in place
+        size_t out = 0;
+        for (size_t i = 0; i < p.terms_.size();) {
+            Term t = std::move(p.terms_[i++]);
+            while (i < p.terms_.size() && p.terms_[i].exponents == t.exponents) t.coeff = p.domain_.add(t.coeff, p.terms_[i++].coeff);
+            if (!p.domain_.is_zero(t.coeff)) p.terms_[out++] = std::move(t);
+        }
+        p.terms_.resize(out);
+        return p;
+    }
+
+    template <class Domain>
+    typename Domain::value_type BasicSparsePolynomial<Domain>::coefficient(const Exponents& monomial) const {
+        auto it = std::lower_bound(terms_.begin(), terms_.end(), Term{ monomial, domain_.zero() }, Decreasing{});
+        return it != terms_.end() && it->exponents == monomial ? it->coeff : domain_.zero();
+    }
+
+    template <class Domain>
+    uint32_t BasicSparsePolynomial<Domain>::total_degree() const {
+        uint32_t degree = 0;
+        for (const auto& t : terms_) degree = std::max(degree, ring_->total_degree(t.exponents));
+        return degree;
+    }
+
+    template <class Domain>
+    uint32_t BasicSparsePolynomial<Domain>::degree(size_t variable) const {
+        uint32_t degree = 0;
+        for (const auto& t : terms_) degree = std::max(degree, ring_->exponent(t.exponents, variable));
+        return degree;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator+(const BasicSparsePolynomial& other) const& {
+        check_ring(other);
+        BasicSparsePolynomial result(ring_, domain_);
+        result.terms_.reserve(terms_.size() + other.terms_.size());
+        auto a = terms_.begin(), b = other.terms_.begin();
+        while (a != terms_.end() && b != other.terms_.end()) {
+            if (a->exponents > b->exponents) result.terms_.push_back(*a++);
+            else if (b->exponents > a->exponents) result.terms_.push_back(*b++);
+            else {
+                Coeff c = domain_.add(a->coeff, b->coeff);
+                if (!domain_.is_zero(c)) result.terms_.push_back({ a->exponents, std::move(c) });
+                ++a;
+                ++b;
+            }
+        }
+        result.terms_.insert(result.terms_.end(), a, terms_.end());
+        result.terms_.insert(result.terms_.end(), b, other.terms_.end());
+        return result;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator+(const BasicSparsePolynomial& other) && {
+        *this += other;
+        return std::move(*this);
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator-(const BasicSparsePolynomial& other) const& {
+        BasicSparsePolynomial result = *this;
+        result -= other;
+        return result;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator-(const BasicSparsePolynomial& other) && {
+        *this -= other;
+        return std::move(*this);
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator*(const Coeff& scalar) const& {
+        BasicSparsePolynomial result(ring_, domain_);
+        if (domain_.is_zero(scalar)) return result;
+        result.terms_.reserve(terms_.size());
+        for (const auto& t : terms_) {
+            Coeff c = domain_.mul(t.coeff, scalar);
+            if (!domain_.is_zero(c)) result.terms_.push_back({ t.exponents, std::move(c) });
+        }
+        return result;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator*(const Coeff& scalar) && {
+        *this *= scalar;
+        return std::move(*this);
+    }
+
+    template <class Domain>
+    template <class Terms, class Transform>
+    void BasicSparsePolynomial<Domain>::merge_in(Terms& other, Transform transform) {
+        if (other.empty()) return;
+        // Both run in decreasing order, so merging smallest first from the back never
+        // overwrites a term of this polynomial that is still to be read
+        const size_t n = terms_.size();
+        terms_.resize(n + other.size(), Term{ Exponents{}, domain_.zero() });
+        size_t out = terms_.size(), i = n, j = other.size();
+        std::optional<Term> next;
+        while (j > 0 || next) {
+            if (!next) next = transform(other[--j]);
+            if (i > 0 && terms_[i - 1].exponents < next->exponents) {
+                terms_[--out] = std::move(terms_[--i]);
+            } else if (i > 0 && terms_[i - 1].exponents == next->exponents) {
+                Coeff c = domain_.add(terms_[--i].coeff, next->coeff);
+                if (!domain_.is_zero(c)) terms_[--out] = Term{ next->exponents, std::move(c) };
+                next.reset();
+            } else {
+                if (!domain_.is_zero(next->coeff)) terms_[--out] = std::move(*next);
+                next.reset();
+            }
+        }
+        // What is left of this polynomial is already in place in front
+        if (out != i) {
+            std::move(terms_.begin() + static_cast<std::ptrdiff_t>(out), terms_.end(), terms_.begin() + static_cast<std::ptrdiff_t>(i));
+            terms_.resize(i + (terms_.size() - out));
+        }
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>& BasicSparsePolynomial<Domain>::operator+=(const BasicSparsePolynomial& other) {
+        check_ring(other);
+        if (this == &other) return *this *= domain_.add(domain_.one(), domain_.one());
+        merge_in(other.terms_, [](const Term& t) { return t; });
+        return *this;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>& BasicSparsePolynomial<Domain>::operator-=(const BasicSparsePolynomial& other) {
+        check_ring(other);
+        if (this == &other) {
+            terms_.clear();
+            return *this;
+        }
+        merge_in(other.terms_, [&](const Term& t) { return Term{ t.exponents, domain_.neg(t.coeff) }; });
+        return *this;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>& BasicSparsePolynomial<Domain>::operator*=(const BasicSparsePolynomial& other) {
+        return *this = *this * other;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>& BasicSparsePolynomial<Domain>::operator*=(const Coeff& scalar) {
+        for (auto& t : terms_) t.coeff = domain_.mul(t.coeff, scalar);
+        std::erase_if(terms_, [&](const Term& t) { return domain_.is_zero(t.coeff); });
+        return *this;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain>& BasicSparsePolynomial<Domain>::addmul(const BasicSparsePolynomial& a, const BasicSparsePolynomial& b) {
+        check_ring(a);
+        check_ring(b);
+        if (a.terms_.size() != 1 && b.terms_.size() != 1) return *this += a * b;
+        const Term& single = a.terms_.size() == 1 ? a.terms_.front() : b.terms_.front();
+        const auto& many = a.terms_.size() == 1 ? b.terms_ : a.terms_;
+        // Multiplying by a monomial keeps the order. The shifted terms are built first,
+        // so an exponent overflow leaves this polynomial as it was.
+        std::vector<Term> shifted;
+        shifted.reserve(many.size());
+        for (const auto& t : many) shifted.push_back({ ring_->multiply(t.exponents, single.exponents), domain_.mul(t.coeff, single.coeff) });
+        merge_in(shifted, [](Term& t) { return std::move(t); });
+        return *this;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::sum(std::shared_ptr<const PolynomialRing> ring,
+                                                                     std::vector<BasicSparsePolynomial> parts, Domain domain) {
+        BasicSparsePolynomial result(std::move(ring), std::move(domain));
+        size_t total = 0;
+        for (const auto& part : parts) {
+            result.check_ring(part);
+            total += part.terms_.size();
+        }
+        std::erase_if(parts, [](const BasicSparsePolynomial& part) { return part.is_zero(); });
+        if (parts.size() == 1) {
+            result.terms_ = std::move(parts.front().terms_);
+            return result;
+        }
+        result.terms_.reserve(total);
+
+        // The heap holds the next term of every part, largest monomial on top
+        struct Cursor {
+            Exponents exponents;
+            uint32_t part, position;
+        };
+        const auto later = [](const Cursor& x, const Cursor& y) { return x.exponents < y.exponents; };
+        std::vector<Cursor> heap;
+        heap.reserve(parts.size());
+        for (uint32_t k = 0; k < parts.size(); ++k) heap.push_back({ parts[k].terms_.front().exponents, k, 0 });
+        std::make_heap(heap.begin(), heap.end(), later);
+
+        while (!heap.empty()) {
+            const Exponents monomial = heap.front().exponents;
+            Coeff coeff = result.domain_.zero();
+            do {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                Cursor& c = heap.back();
+                auto& terms = parts[c.part].terms_;
+                coeff = result.domain_.add(coeff, terms[c.position].coeff);
+                if (++c.position < terms.size()) {
+                    c.exponents = terms[c.position].exponents;
+                    std::push_heap(heap.begin(), heap.end(), later);
+                } else {
+                    heap.pop_back();
+                }
+            } while (!heap.empty() && heap.front().exponents == monomial);
+            if (!result.domain_.is_zero(coeff)) result.terms_.push_back({ monomial, std::move(coeff) });
+        }
+        return result;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> BasicSparsePolynomial<Domain>::operator*(const BasicSparsePolynomial& other) const {
+        check_ring(other);
+        if (is_zero() || other.is_zero()) return BasicSparsePolynomial(ring_, domain_);
+        const size_t box = exponent_box(*this, other), pairs = terms_.size() * other.terms_.size();
+        if (box <= DENSE_BOX_LIMIT) {
+            if constexpr (std::is_same_v<Domain, RealField> || std::is_same_v<Domain, IntegerRing>) {
+                if (pairs / KRONECKER_PAIRS_PER_CELL >= box) return multiply_kronecker(*this, other);
+            }
+            if (box / DENSE_CELLS_PER_PAIR <= pairs) return multiply_dense(*this, other);
+        }
+        return multiply_heap(*this, other);
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> multiply_heap(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b) {
+        a.check_ring(b);
+        // f is the smaller factor: the heap holds at most one entry per term of f
+        const auto& f = a.terms_.size() <= b.terms_.size() ? a.terms_ : b.terms_;
+        const auto& g = a.terms_.size() <= b.terms_.size() ? b.terms_ : a.terms_;
+        BasicSparsePolynomial<Domain> result(a.ring_, a.domain_);
+        if (f.empty()) return result;
+        result.terms_ = with_sums(a.domain_, f, g, [&](const auto& sums) { return heap_product(*a.ring_, f, g, sums); });
+        return result;
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> multiply_dense(const BasicSparsePolynomial<Domain>& a, const BasicSparsePolynomial<Domain>& b) {
+        a.check_ring(b);
+        BasicSparsePolynomial<Domain> result(a.ring_, a.domain_);
+        if (a.is_zero() || b.is_zero()) return result;
+        const size_t box = exponent_box(a, b);
+        if (box > DENSE_BOX_LIMIT) throw std::length_error("Exponent box too large for a dense product");
+
+        const BoxIndex box_index(a, b);
+        result.terms_ = with_sums(a.domain_, a.terms_, b.terms_,
+                                  [&](const auto& sums) { return dense_product(box_index, box, a.terms_, b.terms_, sums); });
+        return result;
+    }
+
+    SparsePolynomial multiply_kronecker(const SparsePolynomial& a, const SparsePolynomial& b) {
+        a.check_ring(b);
+        SparsePolynomial result(a.ring_);
+        if (a.is_zero() || b.is_zero()) return result;
+        if (exponent_box(a, b) > DENSE_BOX_LIMIT) throw std::length_error("Exponent box too large for a Kronecker product");
+
+        BoxIndex box_index(a, b);
+        const auto [fa, fb] = substitute(box_index, a, b, [](double c) { return c; });
+        const auto product = dense::multiply(fa, fb);
+
+        // Inexact methods leave rounding noise in cells that should be zero
+        double noise = 0.0;
+        if (!dense::ntt_exact(fa, fb)) {
+            const auto largest = [](const SparsePolynomial& p) {
+                double m = 0.0;
+                for (const auto& t : p.terms_) m = std::max(m, std::abs(t.coeff));
+                return m;
+            };
+            noise = 64.0 * std::numeric_limits<double>::epsilon() * largest(a) * largest(b) *
+                static_cast<double>(std::min(a.size(), b.size()));
+        }
+        for (size_t index = product.size(); index-- > 0;) {
+            const double c = product[index];
+            if (std::abs(c) > noise && !a.domain_.is_zero(c)) result.terms_.push_back({ box_index.exponents(index), c });
+        }
+        return result;
+    }
+
+    IntegerPolynomial multiply_kronecker(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+        a.check_ring(b);
+        IntegerPolynomial result(a.ring_);
+        if (a.is_zero() || b.is_zero()) return result;
+        if (exponent_box(a, b) > DENSE_BOX_LIMIT) throw std::length_error("Exponent box too large for a Kronecker product");
+
+        // Every coefficient of the product, and every partial sum, must stay below 2^53
+        constexpr double EXACT = 9007199254740992.0;
+        const auto largest = [](const IntegerPolynomial& p) {
+            double m = 0.0;
+            for (const auto& t : p.terms_) m = std::max(m, std::abs(t.coeff.to_double()));
+            return m;
+        };
+        if (largest(a) * largest(b) * static_cast<double>(std::min(a.size(), b.size())) >= EXACT) return multiply_dense(a, b);
+
+        BoxIndex box_index(a, b);
+        const auto [fa, fb] = substitute(box_index, a, b, [](const BigInt& c) { return c.to_double(); });
+        const auto product = dense::multiply(fa, fb);
+        for (size_t index = product.size(); index-- > 0;) {
+            // Integer inputs within the bound take exact methods only
+            const double c = product[index];
+            if (c != 0.0) result.terms_.push_back({ box_index.exponents(index), BigInt(static_cast<int64_t>(c)) });
+        }
+        return result;
+    }
+
+    namespace {
+        // Saturating bound for the size estimates that pick a power algorithm
+        constexpr double SIZE_LIMIT = 1e18;
+
+        // C(n + k - 1, k - 1): the ways to split n among k terms, one per multinomial term
+        double splittings(size_t k, uint32_t n) {
+            double count = 1;
+            for (size_t i = 1; i < k && count < SIZE_LIMIT; ++i) count = count * (double(n) + double(i)) / double(i);
+            return count;
+        }
+
+        // Multinomial expansion of base^n. Each term of base gets an exponent a_i with
+        // sum n; the coefficient is the product over i of C(n - a_1 - ... - a_(i-1), a_i)
+        // c_i^a_i. Successive binomials come from the previous one, so there are no
+        // factorials.
+        template <class Domain>
+        class Multinomial {
+        public:
+            using Poly = BasicSparsePolynomial<Domain>;
+            using Coeff = typename Domain::value_type;
+            using Term = typename Poly::Term;
+
+            Multinomial(const Poly& base, uint32_t n) : base_(base), ring_(base.ring()), domain_(base.domain()), n_(n) {
+                // Powers 0..n of every term, coefficients and monomials
+                for (const auto& t : base.terms()) {
+                    std::vector<Term> powers{ { Exponents{}, domain_.one() } };
+                    powers.reserve(size_t(n) + 1);
+                    for (uint32_t a = 1; a <= n; ++a) {
+                        const Term& last = powers.back();
+                        powers.push_back({ ring_.multiply(last.exponents, t.exponents), domain_.mul(last.coeff, t.coeff) });
+                    }
+                    powers_.push_back(std::move(powers));
+                }
+            }
+
+            Poly expand() {
+                terms_.reserve(static_cast<size_t>(splittings(base_.size(), n_)));
+                visit(0, n_, Term{ Exponents{}, domain_.one() });
+                return Poly::from_terms(base_.ring_ptr(), std::move(terms_), domain_);
+            }
+
+        private:
+            const Poly& base_;
+            const PolynomialRing& ring_;
+            const Domain& domain_;
+            uint32_t n_;
+            std::vector<std::vector<Term>> powers_;
+            std::vector<Term> terms_;
+
+            void visit(size_t i, uint32_t remaining, const Term& partial) {
+                const auto& powers = powers_[i];
+                if (i + 1 == powers_.size()) {
+                    const Term& last = powers[remaining];
+                    terms_.push_back({ ring_.multiply(partial.exponents, last.exponents), domain_.mul(partial.coeff, last.coeff) });
+                    return;
+                }
+                // C(remaining, a) for a = 0, 1, ..., remaining
+                BigInt binomial(1);
+                for (uint32_t a = 0; a <= remaining; ++a) {
+                    if (a > 0) binomial = binomial * BigInt(int64_t(remaining - a + 1)) / BigInt(int64_t(a));
+                    Coeff coeff = domain_.mul(domain_.mul(partial.coeff, powers[a].coeff), domain_.from_rational(binomial, BigInt(1)));
+                    visit(i + 1, remaining - a, Term{ ring_.multiply(partial.exponents, powers[a].exponents), std::move(coeff) });
+                }
+            }
+        };
+    }
+
+    template <class Domain>
+    BasicSparsePolynomial<Domain> power(const BasicSparsePolynomial<Domain>& base, uint32_t exponent) {
+        using Poly = BasicSparsePolynomial<Domain>;
+        if (exponent == 0) return Poly::constant(base.ring_ptr(), base.domain().one(), base.domain());
+        if (base.is_zero() || exponent == 1) return base;
+        for (size_t v = 0; v < base.ring().size(); ++v) {
+            if (uint64_t(base.degree(v)) * exponent > base.ring().max_exponent()) throw std::overflow_error("Polynomial exponent overflow");
+        }
+
+        // The multinomial expansion makes one term per splitting; the result has at most
+        // one per cell of its exponent box
+        double box = 1;
+        for (size_t v = 0; v < base.ring().size() && box < SIZE_LIMIT; ++v) box *= double(base.degree(v)) * exponent + 1;
+        if (splittings(base.size(), exponent) <= box) return Multinomial<Domain>(base, exponent).expand();
+
+        Poly result = base;
+        for (int bit = std::bit_width(exponent) - 2; bit >= 0; --bit) {
+            result *= result;
+            if ((exponent >> bit) & 1) result *= base;
+        }
+        return result;
+    }
+
+    template <class Domain>
+    std::pair<BasicSparsePolynomial<Domain>, BasicSparsePolynomial<Domain>> divide(const BasicSparsePolynomial<Domain>& a,
+                                                                                  const BasicSparsePolynomial<Domain>& b,
+                                                                                  bool stop_at_remainder) {
+        using Coeff = typename Domain::value_type;
+        a.check_ring(b);
+        if (b.is_zero()) throw std::domain_error("Polynomial division by zero");
+        const PolynomialRing& ring = *a.ring_;
+        const Domain& domain = a.domain_;
+        BasicSparsePolynomial<Domain> quotient(a.ring_, a.domain_), remainder(a.ring_, a.domain_);
+        const auto& f = a.terms_;
+        const auto& g = b.terms_;
+        auto& q = quotient.terms_;
+        const auto& lead = g.front();
+
+        // Entry (i, j) stands for q[i] * g[j], for j >= 1; q[i] * g[0] cancelled the term
+        // that made q[i]. (i, j + 1) replaces (i, j).
+        struct Entry {
+            Exponents exponents;
+            uint32_t i, j;
+        };
+        const auto later = [](const Entry& x, const Entry& y) { return x.exponents < y.exponents; };
+        std::vector<Entry> heap;
+
+        size_t k = 0;
+        while (k < f.size() || !heap.empty()) {
+            const bool from_a = heap.empty() || (k < f.size() && f[k].exponents >= heap.front().exponents);
+            const Exponents monomial = from_a ? f[k].exponents : heap.front().exponents;
+            RunningDifference<Domain> running{ domain, domain.zero() };
+            if (k < f.size() && f[k].exponents == monomial) running.value = f[k++].coeff;
+            while (!heap.empty() && heap.front().exponents == monomial) {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                Entry& e = heap.back();
+                running.subtract(q[e.i].coeff, g[e.j].coeff);
+                if (++e.j < g.size()) {
+                    e.exponents = ring.multiply(q[e.i].exponents, g[e.j].exponents);
+                    std::push_heap(heap.begin(), heap.end(), later);
+                }
+                else {
+                    heap.pop_back();
+                }
+            }
+            Coeff coeff = running.result();
+            if (domain.is_zero(coeff)) continue;
+
+            std::optional<Coeff> factor;
+            const auto shift = ring.divide(monomial, lead.exponents);
+            if constexpr (std::is_same_v<Domain, IntegerRing>) {
+                if (shift && (coeff % lead.coeff).is_zero()) factor = coeff / lead.coeff;
+            }
+            else {
+                if (shift) factor = domain.divide(coeff, lead.coeff);
+            }
+            if (!factor) {
+                remainder.terms_.push_back({ monomial, std::move(coeff) });
+                if (stop_at_remainder) break;
+                continue;
+            }
+            q.push_back({ *shift, std::move(*factor) });
+            if (g.size() > 1) {
+                heap.push_back({ ring.multiply(*shift, g[1].exponents), static_cast<uint32_t>(q.size() - 1), 1 });
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+        return { std::move(quotient), std::move(remainder) };
+    }
+
+    template <class Domain>
+    void BasicSparsePolynomial<Domain>::check_ring(const BasicSparsePolynomial& other) const {
+        if ((ring_ != other.ring_ && !(*ring_ == *other.ring_)) || !(domain_ == other.domain_)) {
+            throw std::invalid_argument("Polynomials belong to different rings");
+        }
+    }
+
+    template class BasicSparsePolynomial<RealField>;
+    template class BasicSparsePolynomial<IntegerRing>;
+    template class BasicSparsePolynomial<RationalField>;
+    template class BasicSparsePolynomial<ModularField>;
+
+    template SparsePolynomial multiply_heap(const SparsePolynomial&, const SparsePolynomial&);
+    template IntegerPolynomial multiply_heap(const IntegerPolynomial&, const IntegerPolynomial&);
+    template RationalPolynomial multiply_heap(const RationalPolynomial&, const RationalPolynomial&);
+    template ModularPolynomial multiply_heap(const ModularPolynomial&, const ModularPolynomial&);
+    template SparsePolynomial multiply_dense(const SparsePolynomial&, const SparsePolynomial&);
+    template IntegerPolynomial multiply_dense(const IntegerPolynomial&, const IntegerPolynomial&);
+    template RationalPolynomial multiply_dense(const RationalPolynomial&, const RationalPolynomial&);
+    template ModularPolynomial multiply_dense(const ModularPolynomial&, const ModularPolynomial&);
+
+    template std::pair<SparsePolynomial, SparsePolynomial> divide(const SparsePolynomial&, const SparsePolynomial&, bool);
+    template std::pair<IntegerPolynomial, IntegerPolynomial> divide(const IntegerPolynomial&, const IntegerPolynomial&, bool);
+    template std::pair<RationalPolynomial, RationalPolynomial> divide(const RationalPolynomial&, const RationalPolynomial&, bool);
+    template std::pair<ModularPolynomial, ModularPolynomial> divide(const ModularPolynomial&, const ModularPolynomial&, bool);
+    template SparsePolynomial power(const SparsePolynomial&, uint32_t);
+    template IntegerPolynomial power(const IntegerPolynomial&, uint32_t);
+    template RationalPolynomial power(const RationalPolynomial&, uint32_t);
+    template ModularPolynomial power(const ModularPolynomial&, uint32_t);
+
+} // namespace aleph3
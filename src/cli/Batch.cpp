@@ -0,0 +1,116 @@
+#include "cli/Batch.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/FullForm.hpp"
+#include "parser/Parser.hpp"
+#include "transforms/Transforms.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <utility>
+
+namespace aleph3 {
+
+    BatchRunner::BatchRunner(EvaluationContext& ctx, std::ostream& out, std::ostream& err, BatchOptions options)
+        : ctx_(ctx), out_(out), err_(err), options_(std::move(options)) {}
+
+    void BatchRunner::run(std::string_view source) {
+        const auto statements = split_statements(source);
+        run_statements(statements, 0, statements.size());
+    }
+
+    void BatchRunner::run_statements(const std::vector<Statement>& statements, size_t begin, size_t end) {
+        // Parsed a window at a time, so a long script never holds all its expressions
+        const size_t window = PARSE_GRAIN * ThreadPool::instance().concurrency() * 4;
+        for (size_t from = begin; from < end && !stopped_; from += window) {
+            const size_t to = std::min(end, from + window);
+            const auto parsed = parse_statements(statements, from, to);
+            for (size_t i = from; i < to && !stopped_; ++i) run_statement(statements[i], parsed[i - from]);
+        }
+    }
+
+    void BatchRunner::run(std::istream& in) {
+        std::string buffer;
+        std::string block(options_.block_size, '\0');
+        while (!stopped_) {
+            in.read(block.data(), static_cast<std::streamsize>(block.size()));
+            buffer.append(block.data(), static_cast<size_t>(in.gcount()));
+            const bool done = !in;
+            const auto statements = split_statements(buffer);
+            if (done) {
+                run_statements(statements, 0, statements.size());
+                return;
+            }
+            // The last statement may go on in the next block
+            if (statements.size() < 2) continue;
+            run_statements(statements, 0, statements.size() - 1);
+            const size_t keep = static_cast<size_t>(statements.back().text.data() - buffer.data());
+            line_base_ += static_cast<size_t>(std::count(buffer.begin(), buffer.begin() + keep, '\n'));
+            buffer.erase(0, keep);
+        }
+    }
+
+    bool write_statement(const Statement& statement, EvaluationContext& ctx, OutputBuffer& out,
+                         std::string_view label, bool show_definitions) {
+        return write_statement(parse_expression(statement.text), statement.silent, ctx, out, label, show_definitions);
+    }
+
+    bool write_statement(const ExprPtr& expr, bool silent, EvaluationContext& ctx, OutputBuffer& out,
+                         std::string_view label, bool show_definitions) {
+        // Definitions print only as REPL bookkeeping
+        if (std::holds_alternative<FunctionDefinition>(*expr)) {
+            evaluate(expr, ctx);
+            if (!show_definitions || silent) return false;
+            out.append(label);
+            write_expr(out, *expr);
+            return true;
+        }
+
+        // FullForm[expr] shows the parsed structure
+        if (auto* call = std::get_if<FunctionCall>(&*expr); call && call->head == atoms::FullForm && call->args.size() == 1) {
+            if (silent) return false;
+            out.append(label);
+            write_fullform(out, call->args[0]);
+            return true;
+        }
+
+        // Evaluate and simplify expression
+        auto result = simplify(evaluate(expr, ctx));
+        if (silent) return false;
+        out.append(label);
+        if (auto* num = std::get_if<Number>(&*result)) {
+            // As an ostream prints a double
+            char buffer[32];
+            const auto end = std::to_chars(buffer, buffer + sizeof buffer, num->value, std::chars_format::general, 6).ptr;
+            out.append(std::string_view(buffer, static_cast<size_t>(end - buffer)));
+        }
+        else {
+            write_expr(out, *result);
+        }
+        return true;
+    }
+
+    std::optional<std::string> evaluate_statement(const Statement& statement, EvaluationContext& ctx,
+                                                  bool show_definitions) {
+        std::string text;
+        OutputBuffer out(text);
+        if (!write_statement(statement, ctx, out, {}, show_definitions)) return std::nullopt;
+        return text;
+    }
+
+    void BatchRunner::run_statement(const Statement& statement, const ParsedStatement& parsed) {
+        const size_t n = counter_++;
+        try {
+            if (parsed.error) std::rethrow_exception(parsed.error);
+            const std::string label = options_.labels ? "Out[" + std::to_string(n) + "]= " : std::string();
+            OutputBuffer out(out_);
+            if (write_statement(parsed.expr, statement.silent, ctx_, out, label, options_.labels)) out.push_back('\n');
+        }
+        catch (const std::exception& ex) {
+            ++failures_;
+            err_ << options_.source_name << ':' << line_base_ + statement.line << ": Error: " << ex.what() << '\n';
+            if (options_.stop_on_error) stopped_ = true;
+        }
+    }
+
+} // namespace aleph3
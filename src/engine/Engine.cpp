@@ -0,0 +1,131 @@
+#include "engine/Engine.hpp"
+#include "evaluator/BuiltInFunctions.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include "parser/Statements.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace aleph3 {
+
+    struct Engine::Task {
+        std::function<ExprPtr(EvaluationContext&)> work;
+        std::promise<ExprPtr> result;
+        EvaluationBudget budget;
+        CancelToken cancel;
+    };
+
+    struct Engine::State {
+        EvaluationContext ctx;
+        SymbolAttributes attributes;
+        std::deque<Task> queue;
+        bool scheduled = false;  // In `ready_` or running on a worker
+        CancelToken cancel;      // Shared by the evaluations submitted since the last cancel()
+
+        explicit State(const FunctionRegistry& registry) {
+            ctx.registry = &registry;
+            ctx.attributes = &attributes;
+        }
+    };
+
+    Engine::Engine(EngineOptions options) : options_(std::move(options)) {
+        register_built_in_functions(registry_);
+        if (options_.extend) options_.extend(registry_);
+        registry_.freeze();
+
+        size_t count = options_.threads;
+        if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(count);
+        for (size_t i = 0; i < count; ++i) workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    Engine::~Engine() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        work_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    Session Engine::open_session() {
+        return Session(*this, std::make_shared<State>(registry_));
+    }
+
+    std::future<ExprPtr> Engine::submit(const std::shared_ptr<State>& session, std::function<ExprPtr(EvaluationContext&)> work,
+                                        std::optional<EvaluationBudget> budget) {
+        Task task{ std::move(work), {}, budget ? std::move(*budget) : options_.budget, {} };
+        auto future = task.result.get_future();
+        std::lock_guard lock(mutex_);
+        task.cancel = session->cancel;
+        session->queue.push_back(std::move(task));
+        if (!session->scheduled) {
+            session->scheduled = true;
+            ready_.push_back(session);
+            work_.notify_one();
+        }
+        return future;
+    }
+
+    void Engine::cancel(State& session) {
+        std::lock_guard lock(mutex_);
+        session.cancel.cancel();
+        session.cancel = CancelToken();
+    }
+
+    void Engine::worker_loop() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            work_.wait(lock, [&] { return stopping_ || !ready_.empty(); });
+            if (ready_.empty()) return;
+            auto session = std::move(ready_.front());
+            ready_.pop_front();
+            Task task = std::move(session->queue.front());
+            session->queue.pop_front();
+            lock.unlock();
+
+            try {
+                EvaluationBudget cancellation;
+                cancellation.cancel = task.cancel;
+                BudgetScope cancelled(cancellation);
+                BudgetScope scope(task.budget);
+                task.result.set_value(task.work(session->ctx));
+            }
+            catch (...) {
+                task.result.set_exception(std::current_exception());
+            }
+
+            lock.lock();
+            if (!session->queue.empty()) {
+                // Back of the line, behind the other ready sessions
+                ready_.push_back(std::move(session));
+            }
+            else {
+                session->scheduled = false;
+            }
+        }
+    }
+
+    std::future<ExprPtr> Session::evaluate_async(std::string source, std::optional<EvaluationBudget> budget) {
+        return engine_->submit(state_, [source = std::move(source)](EvaluationContext& ctx) {
+            ExprPtr value = make_expr<Symbol>("Null");
+            for (const auto& statement : split_statements(source)) {
+                value = aleph3::evaluate(parse_expression(statement.text), ctx);
+                if (statement.silent) value = make_expr<Symbol>("Null");
+            }
+            return value;
+        }, std::move(budget));
+    }
+
+    std::future<ExprPtr> Session::evaluate_async(ExprPtr expr, std::optional<EvaluationBudget> budget) {
+        return engine_->submit(state_, [expr = std::move(expr)](EvaluationContext& ctx) { return aleph3::evaluate(expr, ctx); },
+                               std::move(budget));
+    }
+
+    void Session::cancel() {
+        engine_->cancel(*state_);
+    }
+
+} // namespace aleph3
@@ -0,0 +1,119 @@
+#include "evaluator/Budget.hpp"
+#include "expr/ExprPool.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace aleph3 {
+
+    namespace detail {
+        namespace {
+            // Stack kept free below the deepest evaluate() call, at least
+            constexpr size_t STACK_RESERVE = size_t(256) << 10;
+            // Stack assumed usable from the first call where its size cannot be queried
+            constexpr size_t STACK_FALLBACK = size_t(512) << 10;
+        }
+
+        uintptr_t find_stack_floor(const void* here) {
+            // Stacks grow down on the platforms we build for
+            const auto top = reinterpret_cast<uintptr_t>(here);
+#ifdef __linux__
+            pthread_attr_t attr;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+                void* low = nullptr;
+                size_t size = 0;
+                const bool known = pthread_attr_getstack(&attr, &low, &size) == 0;
+                pthread_attr_destroy(&attr);
+                if (known) return reinterpret_cast<uintptr_t>(low) + std::max(STACK_RESERVE, size / 16);
+            }
+#endif
+            return top > STACK_FALLBACK ? top - STACK_FALLBACK : 1;
+        }
+
+        void check_budget() {
+            auto& b = budget;
+            b.countdown = POLL_INTERVAL;
+            const auto& l = b.limits;
+            for (const CancelLink* link = l.cancels; link; link = link->next) {
+                if (link->flag->load(std::memory_order_relaxed)) exceed(BudgetLimit::Cancelled, 0);
+            }
+            if (l.timed && std::chrono::steady_clock::now() >= l.at) exceed(BudgetLimit::Time, l.time_scope);
+            if (l.memory_at != UNLIMITED && thread_allocated_bytes() >= l.memory_at) {
+                exceed(BudgetLimit::Memory, l.memory_scope);
+            }
+        }
+
+        void exceed(BudgetLimit limit, uint64_t scope) {
+            // The next poll checks again, so the limit stays exceeded for code that catches this
+            budget.countdown = 1;
+            switch (limit) {
+            case BudgetLimit::Time:      throw BudgetExceeded(limit, scope, "Time limit exceeded");
+            case BudgetLimit::Steps:     throw BudgetExceeded(limit, scope, "Step limit exceeded");
+            case BudgetLimit::Depth:     throw BudgetExceeded(limit, scope, "Recursion depth limit exceeded");
+            case BudgetLimit::Memory:    throw BudgetExceeded(limit, scope, "Memory limit exceeded");
+            case BudgetLimit::Cancelled: throw BudgetExceeded(limit, scope, "Evaluation cancelled");
+            }
+            throw BudgetExceeded(limit, scope, "Budget exceeded");
+        }
+
+        namespace {
+            // a + b, saturating at UNLIMITED
+            uint64_t offset(uint64_t a, uint64_t b) {
+                return b >= UNLIMITED - a ? UNLIMITED : a + b;
+            }
+        }
+    }
+
+    BudgetScope::BudgetScope(const EvaluationBudget& budget) {
+        auto& b = detail::budget;
+        id_ = ++b.scopes;
+        saved_ = b.limits;
+        auto& l = b.limits;
+        if (budget.time.count() > 0) {
+            const auto at = std::chrono::steady_clock::now() + budget.time;
+            if (!l.timed || at < l.at) {
+                l.at = at;
+                l.time_scope = id_;
+            }
+            l.timed = true;
+        }
+        if (budget.steps > 0) {
+            const uint64_t at = detail::offset(b.steps, budget.steps);
+            if (at < l.step_at) {
+                l.step_at = at;
+                l.step_scope = id_;
+            }
+        }
+        if (budget.depth > 0) {
+            const uint64_t at = detail::offset(b.depth, budget.depth);
+            if (at < l.depth_at) {
+                l.depth_at = at;
+                l.depth_scope = id_;
+            }
+        }
+        if (budget.memory > 0) {
+            const uint64_t at = detail::offset(detail::thread_allocated_bytes(), budget.memory);
+            if (at < l.memory_at) {
+                l.memory_at = at;
+                l.memory_scope = id_;
+            }
+        }
+        if (budget.cancel) {
+            token_ = budget.cancel;
+            link_ = { token_->flag_.get(), l.cancels };
+            l.cancels = &link_;
+        }
+        l.polled = l.timed || l.memory_at != detail::UNLIMITED || l.cancels;
+        b.countdown = 1;  // The first poll checks
+    }
+
+    BudgetScope::~BudgetScope() {
+        auto& b = detail::budget;
+        b.limits = saved_;
+        b.countdown = 1;
+    }
+
+} // namespace aleph3
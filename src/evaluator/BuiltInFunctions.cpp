@@ -1,8 +1,26 @@
+#include "evaluator/BuiltInFunctions.hpp"
 #include "evaluator/FunctionRegistry.hpp"
 #include "evaluator/Evaluator.hpp"
+#include "evaluator/NumericEval.hpp"
+#include "evaluator/Patterns.hpp"
+#include "evaluator/Snapshot.hpp"
+#include "expr/ExprPool.hpp"
 #include "expr/ExprUtils.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "expr/Serialize.hpp"
+#include "transforms/CSE.hpp"
+#include "transforms/Derivative.hpp"
+#include "transforms/Simplifier.hpp"
+#include "util/ThreadPool.hpp"
 #include "Constants.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <ctime>
+#include <iterator>
+#include <limits>
+#include <optional>
 
 namespace aleph3 {
 
@@ -12,14 +30,14 @@ namespace aleph3 {
             [](const Number& num) -> ExprPtr { return make_expr<Number>(num.value); },
             [](const Complex& c) -> ExprPtr { return make_expr<Complex>(c.real, c.imag); },
             [](const Rational& rat) -> ExprPtr {
-                return make_expr<Number>(static_cast<double>(rat.numerator) / rat.denominator);
+                return make_expr<Number>(rat.value());
             },
             [](const Boolean& boolean) -> ExprPtr { return make_expr<Boolean>(boolean.value); },
             [](const String& str) -> ExprPtr { return make_expr<String>(str.value); },
             [](const Symbol& sym) -> ExprPtr {
-                if (sym.name == "Pi") return make_expr<Number>(PI);
-                if (sym.name == "E") return make_expr<Number>(E);
-                if (sym.name == "Degree") return make_expr<Number>(PI / 180.0);
+                if (sym.name == atoms::Pi) return make_expr<Number>(PI);
+                if (sym.name == atoms::E) return make_expr<Number>(E);
+                if (sym.name == atoms::Degree) return make_expr<Number>(PI / 180.0);
                 // Add more constants as needed
                 return make_expr<Symbol>(sym.name);
             },
@@ -29,12 +47,18 @@ namespace aleph3 {
             [](const Indeterminate&) -> ExprPtr {
                 return make_expr<Indeterminate>();
             },
+            [&expr](const PackedArray&) -> ExprPtr {
+                return packed_to_real(expr);
+            },
+            [](const LazyList& list) -> ExprPtr {
+                return make_expr<LazyList>(list.start, list.step, list.count, false);
+            },
             [](const List& list) -> ExprPtr {
                 std::vector<ExprPtr> evaluated;
                 for (const auto& elem : list.elements) {
                     evaluated.push_back(numeric_eval(elem));
                 }
-                return std::make_shared<Expr>(List{evaluated});
+                return make_expr<List>(evaluated);
             },
             [](const FunctionDefinition& def) -> ExprPtr {
                 return make_expr<FunctionDefinition>(def.name, def.params, def.body, def.delayed);
@@ -55,8 +79,260 @@ namespace aleph3 {
             }, *expr);
     }
 
+    // Number of values start, start + step, ... not past stop
+    inline size_t range_count(double start, double stop, double step) {
+        const double span = std::floor((stop - start) / step + 1e-12);
+        return span < 0 ? 0 : static_cast<size_t>(span) + 1;
+    }
+
+    // Iterator of Table and Sum: a variable (empty for a bare count) and the values it takes,
+    // listed or as the progression start, start + step, ... of `count` numbers
+    struct Iterator {
+        Atom variable;
+        std::vector<ExprPtr> values;
+        bool listed = false;
+        double start = 1;
+        double step = 1;
+        size_t count = 0;
+
+        size_t size() const { return listed ? values.size() : count; }
+        ExprPtr value(size_t i) const {
+            return listed ? values[i] : make_expr<Number>(start + static_cast<double>(i) * step);
+        }
+    };
+
+    // Iterators func.args[1], ...; their bounds are evaluated once, in ctx
+    inline std::vector<Iterator> parse_iterators(const std::string& name, const FunctionCall& func, EvaluationContext& ctx) {
+        auto elements_of = [](const ExprPtr& e) -> const std::vector<ExprPtr>* {
+            if (auto f = std::get_if<FunctionCall>(e.get()); f && f->head == atoms::List) return &f->args;
+            if (auto l = std::get_if<List>(e.get())) return &l->elements;
+            return nullptr;
+        };
+        auto number = [&](const ExprPtr& e) {
+            auto v = evaluate(e, ctx);
+            if (!std::holds_alternative<Number>(*v)) throw std::runtime_error(name + " iterator bounds must be numbers");
+            return get_number_value(v);
+        };
+
+        std::vector<Iterator> iterators;
+        for (size_t k = 1; k < func.args.size(); ++k) {
+            Iterator it;
+            const auto* spec = elements_of(func.args[k]);
+            double start = 1, stop, step = 1;
+            if (!spec) {
+                stop = number(func.args[k]);
+            }
+            else {
+                if (spec->size() < 2 || spec->size() > 4 || !std::holds_alternative<Symbol>(*(*spec)[0])) {
+                    throw std::runtime_error(name + " expects iterators of the form {i, max}, {i, min, max, step} or {i, {values}}");
+                }
+                it.variable = std::get<Symbol>(*(*spec)[0]).name;
+                if (spec->size() == 2) {
+                    auto bound = evaluate((*spec)[1], ctx);
+                    if (auto lazy = std::get_if<LazyList>(bound.get())) {
+                        it.start = lazy->start;
+                        it.step = lazy->step;
+                        it.count = lazy->count;
+                        iterators.push_back(std::move(it));
+                        continue;
+                    }
+                    if (auto packed = std::get_if<PackedArray>(bound.get())) bound = unpack(*packed);
+                    if (auto values = elements_of(bound)) {
+                        it.values = *values;
+                        it.listed = true;
+                        iterators.push_back(std::move(it));
+                        continue;
+                    }
+                    stop = number(bound);
+                }
+                else {
+                    start = number((*spec)[1]);
+                    stop = number((*spec)[2]);
+                    if (spec->size() == 4) step = number((*spec)[3]);
+                }
+            }
+            if (step == 0) throw std::runtime_error(name + " step cannot be zero");
+            it.start = start;
+            it.step = step;
+            it.count = range_count(start, stop, step);
+            iterators.push_back(std::move(it));
+        }
+        return iterators;
+    }
+
+    // Points of the iterators' product, the last iterator varying fastest
+    inline size_t point_count(const std::vector<Iterator>& iterators) {
+        size_t total = 1;
+        for (const auto& it : iterators) total *= it.size();
+        return total;
+    }
+
+    // Binds the iterator variables to their values at point `index`
+    inline void bind_point(EvaluationContext& frame, const std::vector<Iterator>& iterators, size_t index) {
+        for (size_t k = iterators.size(); k-- > 0;) {
+            const auto& it = iterators[k];
+            if (!it.variable.empty()) frame.variables[it.variable] = it.value(index % it.size());
+            index /= it.size();
+        }
+    }
+
+    // Nested lists, one level per iterator, of the values at each point
+    inline ExprPtr reshape(const std::vector<Iterator>& iterators, const std::vector<ExprPtr>& values,
+        size_t depth = 0, size_t offset = 0) {
+        const size_t count = iterators[depth].size();
+        std::vector<ExprPtr> elements;
+        elements.reserve(count);
+        if (depth + 1 == iterators.size()) {
+            elements.assign(values.begin() + offset, values.begin() + offset + count);
+        }
+        else {
+            size_t inner = 1;
+            for (size_t k = depth + 1; k < iterators.size(); ++k) inner *= iterators[k].size();
+            for (size_t i = 0; i < count; ++i) {
+                elements.push_back(reshape(iterators, values, depth + 1, (offset + i) * inner));
+            }
+        }
+        return make_list_auto_packed(std::move(elements));
+    }
+
+    // Points per Sum chunk; fixed so that Sum and ParallelSum add in the same order
+    inline constexpr size_t SUM_CHUNK = 1024;
+
+    // Chunk size for parallel work: enough chunks per thread for stealing to balance uneven points
+    inline size_t parallel_grain(size_t total) {
+        return std::max<size_t>(1, total / (ThreadPool::instance().concurrency() * 16));
+    }
+
+    // Runs body over the chunks of [0, n), on the thread pool or in order on this thread
+    inline void for_each_chunk(bool parallel, size_t n, size_t grain, const ThreadPool::Body& body) {
+        if (parallel) {
+            ThreadPool::instance().parallel_for(n, grain, body);
+            return;
+        }
+        for (size_t chunk = 0, chunks = ThreadPool::chunk_count(n, grain); chunk < chunks; ++chunk) {
+            body(chunk, chunk * grain, std::min(n, (chunk + 1) * grain));
+        }
+    }
+
+    inline bool is_true(const ExprPtr& e) {
+        auto b = std::get_if<Boolean>(e.get());
+        return b && b->value;
+    }
+
+    // Elements of a reduction's held list argument, produced one at a time. Map[f, list],
+    // Select[list, pred] and one-iterator Table[body, it] run as stages of a pipeline: each
+    // element passes through every stage before the next one is made, and a lazy range at
+    // the base is read in place, so memory stays O(1) in the length of the list.
+    class ElementStream {
+    public:
+        ElementStream(const ExprPtr& held, EvaluationContext& ctx) : ctx_(ctx) { plan(held); }
+
+        // False if the argument is not a list; value() is then its evaluated value
+        bool is_list() const { return value_ == nullptr; }
+        const ExprPtr& value() const { return value_; }
+
+        // The base when it is a lazy range with no stages, for closed forms
+        const LazyList* lazy() const {
+            return stages_.empty() && base_ ? std::get_if<LazyList>(base_.get()) : nullptr;
+        }
+
+        // Number of elements, when known without producing them
+        std::optional<size_t> size() const {
+            if (!stages_.empty() || !base_) return std::nullopt;
+            if (auto lazy = std::get_if<LazyList>(base_.get())) return lazy->count;
+            if (auto packed = std::get_if<PackedArray>(base_.get())) return packed->data->length();
+            return std::get<List>(*base_).elements.size();
+        }
+
+        // Calls sink on each element in order until it returns false
+        void for_each(const std::function<bool(const ExprPtr&)>& sink) const {
+            auto emit = [&](ExprPtr e) {
+                for (auto stage = stages_.rbegin(); stage != stages_.rend(); ++stage) {
+                    auto result = evaluate(make_fcall(stage->f, { e }), ctx_);
+                    if (!stage->select) e = std::move(result);
+                    else if (!is_true(result)) return true;
+                }
+                return sink(e);
+            };
+            if (!base_) {
+                EvaluationContext frame(&ctx_);
+                for (size_t i = 0, n = point_count(iterators_); i < n; ++i) {
+                    bind_point(frame, iterators_, i);
+                    if (!emit(evaluate(table_->args[0], frame))) return;
+                }
+                return;
+            }
+            if (auto lazy = std::get_if<LazyList>(base_.get())) {
+                for (size_t i = 0; i < lazy->count; ++i) {
+                    if (!emit(lazy_part(*lazy, i))) return;
+                }
+                return;
+            }
+            if (auto packed = std::get_if<PackedArray>(base_.get())) {
+                for (size_t i = 0, n = packed->data->length(); i < n; ++i) {
+                    if (!emit(packed_part(*packed->data, i))) return;
+                }
+                return;
+            }
+            for (const auto& e : std::get<List>(*base_).elements) {
+                if (!emit(e)) return;
+            }
+        }
+
+    private:
+        struct Stage {
+            Atom f;
+            bool select;
+        };
+
+        EvaluationContext& ctx_;
+        std::vector<Stage> stages_;         // Outermost first
+        ExprPtr base_;                      // Evaluated base list, or nullptr for a Table
+        const FunctionCall* table_ = nullptr;
+        std::vector<Iterator> iterators_;
+        ExprPtr value_;
+
+        void plan(const ExprPtr& held) {
+            auto call = std::get_if<FunctionCall>(held.get());
+            if (call && call->args.size() == 2) {
+                auto f = std::get_if<Symbol>(call->args[0].get());
+                auto pred = std::get_if<Symbol>(call->args[1].get());
+                if (call->head == atoms::Map && f) {
+                    stages_.push_back({ f->name, false });
+                    plan(call->args[1]);
+                    return;
+                }
+                if (call->head == atoms::Select && pred) {
+                    stages_.push_back({ pred->name, true });
+                    plan(call->args[0]);
+                    return;
+                }
+                if (call->head == atoms::Table) {
+                    table_ = call;
+                    iterators_ = parse_iterators("Table", *call, ctx_);
+                    return;
+                }
+            }
+            base_ = evaluate(held, ctx_);
+            if (std::holds_alternative<List>(*base_) || std::holds_alternative<PackedArray>(*base_) ||
+                std::holds_alternative<LazyList>(*base_)) {
+                return;
+            }
+            // Not a list after all: the stages apply to it as they would unfused
+            value_ = base_;
+            for (auto stage = stages_.rbegin(); stage != stages_.rend(); ++stage) {
+                value_ = stage->select
+                    ? evaluate(make_fcall(atoms::Select, { value_, make_expr<Symbol>(stage->f) }), ctx_)
+                    : evaluate(make_fcall(atoms::Map, { make_expr<Symbol>(stage->f), value_ }), ctx_);
+            }
+        }
+    };
+
     void register_built_in_functions() {
-        auto& registry = FunctionRegistry::instance();
+        register_built_in_functions(FunctionRegistry::instance());
+    }
+
+    void register_built_in_functions(FunctionRegistry& registry) {
 
         // Logical operators
         registry.register_function("And", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
@@ -68,7 +344,7 @@ namespace aleph3 {
                     }
                 }
                 else {
-                    return make_expr<FunctionCall>("And", func.args); // Return unevaluated
+                    return make_expr<FunctionCall>(atoms::And, func.args); // Return unevaluated
                 }
             }
             return make_expr<Boolean>(true); // All arguments are True
@@ -83,7 +359,7 @@ namespace aleph3 {
                     }
                 }
                 else {
-                    return make_expr<FunctionCall>("Or", func.args); // Return unevaluated
+                    return make_expr<FunctionCall>(atoms::Or, func.args); // Return unevaluated
                 }
             }
             return make_expr<Boolean>(false); // All arguments are False
@@ -143,7 +419,7 @@ namespace aleph3 {
                 return make_expr<String>(str);
             }
             // If not a string, return unevaluated
-            return make_expr<FunctionCall>("StringReplace", std::vector<ExprPtr>{str_arg, rule_arg});
+            return make_expr<FunctionCall>(func.head, std::vector<ExprPtr>{str_arg, rule_arg});
             });
 
         registry.register_function("StringTake", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
@@ -193,26 +469,585 @@ namespace aleph3 {
             throw std::runtime_error("StringTake expects a valid index or range");
             });
 
+        // Length, Total, Max, Min and Select hold their list argument and read it through an
+        // ElementStream, so Map, Select and Table inside it are never built as lists
         registry.register_function("Length", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
             if (func.args.size() != 1) {
                 throw std::runtime_error("Length expects exactly 1 argument");
             }
-            auto arg = evaluate(func.args[0], ctx);
-            if (std::holds_alternative<List>(*arg)) {
-                const auto& list = std::get<List>(*arg);
-                return make_expr<Number>(static_cast<double>(list.elements.size()));
+            ElementStream stream(func.args[0], ctx);
+            if (!stream.is_list()) throw std::runtime_error("Length expects a list argument");
+            if (auto size = stream.size()) return make_expr<Number>(static_cast<double>(*size));
+            size_t count = 0;
+            stream.for_each([&](const ExprPtr&) { ++count; return true; });
+            return make_expr<Number>(static_cast<double>(count));
+            });
+
+        // Short[expr, n] stays as it is and prints as expr cut to about n lines (see Printer.hpp)
+        registry.register_function("Short", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.empty() || func.args.size() > 2) {
+                throw std::runtime_error("Short expects 1 or 2 arguments");
+            }
+            auto lines = func.args.size() == 2 ? evaluate(func.args[1], ctx) : make_expr<Number>(1);
+            auto* n = std::get_if<Number>(lines.get());
+            if (!n || !(n->value > 0)) throw std::runtime_error("Short expects a positive number of lines");
+            // simplify() of the printed result stops at Short, so the argument is simplified here
+            return make_fcall(atoms::Short, { simplify(evaluate(func.args[0], ctx)), lines });
+            });
+
+        // Machine numbers are added into one double, anything else is kept for Plus
+        registry.register_function("Total", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("Total expects exactly 1 argument");
+            }
+            ElementStream stream(func.args[0], ctx);
+            if (!stream.is_list()) return make_fcall(func.head, { stream.value() });
+            if (auto lazy = stream.lazy()) {
+                // n a + d n (n - 1) / 2, exact in the long double mantissa for integer ranges
+                const long double n = static_cast<long double>(lazy->count);
+                return make_expr<Number>(static_cast<double>(n * lazy->start + lazy->step * (n * (n - 1) / 2)));
+            }
+            double number = 0;
+            std::vector<ExprPtr> terms;
+            stream.for_each([&](const ExprPtr& e) {
+                if (auto n = std::get_if<Number>(e.get())) number += n->value;
+                else terms.push_back(e);
+                return true;
+                });
+            if (terms.empty()) return make_expr<Number>(number);
+            if (number != 0) terms.insert(terms.begin(), make_expr<Number>(number));
+            return evaluate(make_fcall(atoms::Plus, std::move(terms)), ctx);
+            });
+
+        // Max[...] and Min[...] of numbers, lists of them, or both; symbolic entries are kept
+        // in an unevaluated result next to the numeric extremum
+        auto extremum = [](bool max) {
+            return [max](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                ExprPtr best;
+                double best_value = 0;
+                std::vector<ExprPtr> symbolic;
+                std::function<bool(const ExprPtr&)> consider = [&](const ExprPtr& e) {
+                    const ExprPtr element = unpack(e);
+                    if (auto list = std::get_if<List>(element.get())) {
+                        for (const auto& x : list->elements) consider(x);
+                        return true;
+                    }
+                    std::optional<double> value;
+                    if (auto n = std::get_if<Number>(element.get())) value = n->value;
+                    else if (auto r = std::get_if<Rational>(element.get())) value = r->value();
+                    else if (std::holds_alternative<Infinity>(*element)) value = std::numeric_limits<double>::infinity();
+                    if (!value) symbolic.push_back(element);
+                    else if (!best || (max ? *value > best_value : *value < best_value)) {
+                        best = element;
+                        best_value = *value;
+                    }
+                    return true;
+                };
+                for (const auto& arg : func.args) {
+                    ElementStream stream(arg, ctx);
+                    if (!stream.is_list()) consider(stream.value());
+                    else if (auto lazy = stream.lazy()) {
+                        // A progression is monotonic: its extrema are its ends
+                        consider(lazy_part(*lazy, 0));
+                        consider(lazy_part(*lazy, lazy->count - 1));
+                    }
+                    else stream.for_each(consider);
+                }
+                if (symbolic.empty()) {
+                    if (best) return best;
+                    ExprPtr infinity = make_expr<Infinity>();
+                    return max ? evaluate(make_fcall(atoms::Times, { make_expr<Number>(-1.0), infinity }), ctx) : infinity;
+                }
+                if (best) symbolic.insert(symbolic.begin(), best);
+                return make_fcall(func.head, std::move(symbolic));
+            };
+        };
+        registry.register_function("Max", extremum(true));
+        registry.register_function("Min", extremum(false));
+
+        // Select[list, pred]: the elements e for which pred[e] is True
+        registry.register_function("Select", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 2) {
+                throw std::runtime_error("Select expects exactly 2 arguments");
+            }
+            auto pred = std::get_if<Symbol>(func.args[1].get());
+            if (!pred) throw std::runtime_error("Select expects a function name as its second argument");
+            ElementStream stream(func.args[0], ctx);
+            if (!stream.is_list()) return make_fcall(func.head, { stream.value(), func.args[1] });
+            std::vector<ExprPtr> kept;
+            stream.for_each([&](const ExprPtr& e) {
+                if (is_true(evaluate(make_fcall(pred->name, { e }), ctx))) kept.push_back(e);
+                return true;
+                });
+            return make_list_auto_packed(std::move(kept));
+            });
+
+        // Part[expr, i]: element i (1-based; negative counts from the end, 0 is the head).
+        // Lazy lists compute the one element asked for.
+        registry.register_function("Part", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 2) {
+                throw std::runtime_error("Part expects exactly 2 arguments");
+            }
+            auto target = evaluate(func.args[0], ctx);
+            auto index_arg = evaluate(func.args[1], ctx);
+            auto index = std::get_if<Number>(index_arg.get());
+            if (!index || std::floor(index->value) != index->value) return make_fcall(func.head, { target, index_arg });
+
+            auto call = std::get_if<FunctionCall>(target.get());
+            size_t length = 0;
+            if (auto list = std::get_if<List>(target.get())) length = list->elements.size();
+            else if (auto packed = std::get_if<PackedArray>(target.get())) length = packed->data->length();
+            else if (auto lazy = std::get_if<LazyList>(target.get())) length = lazy->count;
+            else if (call) length = call->args.size();
+            else throw std::runtime_error("Part expects an expression with parts");
+
+            const double i = index->value < 0 ? static_cast<double>(length) + index->value + 1 : index->value;
+            if (i == 0) {
+                if (call) return make_expr<Symbol>(call->head);
+                return make_expr<Symbol>(atoms::List);
             }
-            throw std::runtime_error("Length expects a list argument");
+            if (i < 1 || i > static_cast<double>(length)) throw std::runtime_error("Part index out of range");
+            const auto k = static_cast<size_t>(i) - 1;
+            if (auto list = std::get_if<List>(target.get())) return list->elements[k];
+            if (auto packed = std::get_if<PackedArray>(target.get())) return packed_part(*packed->data, k);
+            if (auto lazy = std::get_if<LazyList>(target.get())) return lazy_part(*lazy, k);
+            return call->args[k];
+            });
+
+        registry.register_function("Range", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.empty() || func.args.size() > 3) {
+                throw std::runtime_error("Range expects 1 to 3 arguments");
+            }
+            std::vector<ExprPtr> args;
+            for (const auto& arg : func.args) {
+                args.push_back(evaluate(arg, ctx));
+                if (!std::holds_alternative<Number>(*args.back())) {
+                    return make_fcall(func.head, args); // Symbolic bounds: leave unevaluated
+                }
+            }
+            double start = 1, stop = 1, step = 1;
+            if (args.size() == 1) {
+                stop = get_number_value(args[0]);
+            }
+            else {
+                start = get_number_value(args[0]);
+                stop = get_number_value(args[1]);
+                if (args.size() == 3) step = get_number_value(args[2]);
+            }
+            if (step == 0) throw std::runtime_error("Range step cannot be zero");
+
+            // Long ranges stay lazy; shorter ones are packed
+            return make_range(start, step, range_count(start, stop, step));
+            });
+
+        // Table and Sum hold their arguments: the body is evaluated once per iterator value,
+        // in a frame binding the iterator variables. The Parallel forms spread the points over
+        // the thread pool; each chunk gets its own frame nested in the caller's, which stays
+        // untouched until all chunks are done.
+        auto table = [](const std::string& name, bool parallel) {
+            return [name, parallel](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() < 2) {
+                    throw std::runtime_error(name + " expects an expression and at least one iterator");
+                }
+                const auto iterators = parse_iterators(name, func, ctx);
+                const size_t total = point_count(iterators);
+                std::vector<ExprPtr> results(total);
+                for_each_chunk(parallel, total, parallel_grain(total), [&](size_t, size_t begin, size_t end) {
+                    EvaluationContext frame(&ctx);
+                    for (size_t i = begin; i < end; ++i) {
+                        bind_point(frame, iterators, i);
+                        results[i] = evaluate(func.args[0], frame);
+                    }
+                    });
+                return reshape(iterators, results);
+            };
+        };
+        registry.register_function("Table", table("Table", false));
+        registry.register_function("ParallelTable", table("ParallelTable", true));
+
+        // Terms are added up per chunk of SUM_CHUNK points: machine numbers into one double,
+        // anything else kept for Plus. Chunks are fixed by the point count alone, so Sum and
+        // ParallelSum add in the same order and give identical results.
+        auto sum = [](const std::string& name, bool parallel) {
+            return [name, parallel](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() < 2) {
+                    throw std::runtime_error(name + " expects an expression and at least one iterator");
+                }
+                const auto iterators = parse_iterators(name, func, ctx);
+                const size_t total = point_count(iterators);
+                struct Partial {
+                    double number = 0;
+                    std::vector<ExprPtr> terms;
+                };
+                std::vector<Partial> partials(ThreadPool::chunk_count(total, SUM_CHUNK));
+                for_each_chunk(parallel, total, SUM_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+                    EvaluationContext frame(&ctx);
+                    Partial& partial = partials[chunk];
+                    for (size_t i = begin; i < end; ++i) {
+                        bind_point(frame, iterators, i);
+                        auto term = evaluate(func.args[0], frame);
+                        if (auto n = std::get_if<Number>(term.get())) partial.number += n->value;
+                        else partial.terms.push_back(std::move(term));
+                    }
+                    });
+                double number = 0;
+                std::vector<ExprPtr> terms;
+                for (auto& partial : partials) {
+                    number += partial.number;
+                    std::move(partial.terms.begin(), partial.terms.end(), std::back_inserter(terms));
+                }
+                if (terms.empty()) return make_expr<Number>(number);
+                if (number != 0) terms.insert(terms.begin(), make_expr<Number>(number));
+                return evaluate(make_fcall(atoms::Plus, std::move(terms)), ctx);
+            };
+        };
+        registry.register_function("Sum", sum("Sum", false));
+        registry.register_function("ParallelSum", sum("ParallelSum", true));
+
+        // Map[f, expr]: f applied to each element of a list, or each argument of a call
+        auto map = [](const std::string& name, bool parallel) {
+            return [name, parallel](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 2) {
+                    throw std::runtime_error(name + " expects exactly 2 arguments");
+                }
+                // Held, so a variable bound to a compiled function is applied rather than replaced
+                auto f = std::get_if<Symbol>(func.args[0].get());
+                if (!f) throw std::runtime_error(name + " expects a function name as its first argument");
+                auto target = evaluate(func.args[1], ctx);
+
+                const std::vector<ExprPtr>* elements = nullptr;
+                std::vector<ExprPtr> rows;
+                if (auto list = std::get_if<List>(target.get())) elements = &list->elements;
+                else if (auto call = std::get_if<FunctionCall>(target.get())) elements = &call->args;
+                else if (auto packed = std::get_if<PackedArray>(target.get())) {
+                    const size_t length = packed->data->length();
+                    rows.reserve(length);
+                    for (size_t i = 0; i < length; ++i) rows.push_back(packed_part(*packed->data, i));
+                    elements = &rows;
+                }
+                else if (auto lazy = std::get_if<LazyList>(target.get())) {
+                    rows.reserve(lazy->count);
+                    for (size_t i = 0; i < lazy->count; ++i) rows.push_back(lazy_part(*lazy, i));
+                    elements = &rows;
+                }
+                else {
+                    return target; // Atoms have no parts
+                }
+
+                std::vector<ExprPtr> results(elements->size());
+                auto apply = [&](EvaluationContext& frame, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        results[i] = evaluate(make_fcall(f->name, { (*elements)[i] }), frame);
+                    }
+                };
+                if (parallel) {
+                    for_each_chunk(true, results.size(), parallel_grain(results.size()), [&](size_t, size_t begin, size_t end) {
+                        EvaluationContext frame(&ctx);
+                        apply(frame, begin, end);
+                        });
+                }
+                else {
+                    apply(ctx, 0, results.size());
+                }
+                if (auto call = std::get_if<FunctionCall>(target.get())) {
+                    return evaluate(make_fcall(call->head, std::move(results)), ctx);
+                }
+                return make_list_auto_packed(std::move(results));
+            };
+        };
+        registry.register_function("Map", map("Map", false));
+        registry.register_function("ParallelMap", map("ParallelMap", true));
+
+        // ReplaceAll[expr, rules] and ReplaceRepeated[expr, rules]: rules are compiled once per node
+        auto replace = [](const char* name, bool repeated) {
+            return [name, repeated](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 2) {
+                    throw std::runtime_error(std::string(name) + " expects exactly 2 arguments");
+                }
+                auto target = evaluate(func.args[0], ctx);
+                auto rules = compile_rules(evaluate(func.args[1], ctx));
+                if (repeated) return replace_repeated(target, *rules, ctx);
+                return evaluate(replace_all(target, *rules, ctx), ctx);
+            };
+        };
+        registry.register_function("ReplaceAll", replace("ReplaceAll", false));
+        registry.register_function("ReplaceRepeated", replace("ReplaceRepeated", true));
+
+        // Simplify[expr] repeats the rewrites to a fixed point; FullSimplify[expr] also tries
+        // expanding and factoring in an e-graph and keeps the smallest form
+        registry.register_function("Simplify", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("Simplify expects exactly 1 argument");
+            }
+            return simplify_to_fixed_point(evaluate(func.args[0], ctx));
+            });
+        registry.register_function("FullSimplify", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("FullSimplify expects exactly 1 argument");
+            }
+            return evaluate(full_simplify(evaluate(func.args[0], ctx)), ctx);
+            });
+
+        // CSE[expr]: expr as With[{c1 -> ..., ...}, body], naming each repeated subexpression once
+        registry.register_function("CSE", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("CSE expects exactly 1 argument");
+            }
+            return to_with(eliminate_common_subexpressions(evaluate(func.args[0], ctx)));
+            });
+
+        // D[expr, x] and D[expr, {x, n}]: the variable is held, so x may have a value
+        registry.register_function("D", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 2) {
+                throw std::runtime_error("D expects exactly 2 arguments");
+            }
+            const ExprPtr& spec = func.args[1];
+            const std::vector<ExprPtr>* pair = nullptr;
+            if (auto l = std::get_if<List>(spec.get())) pair = &l->elements;
+            else if (auto f = std::get_if<FunctionCall>(spec.get()); f && f->head == atoms::List) pair = &f->args;
+            const Symbol* x = std::get_if<Symbol>(pair && pair->size() == 2 ? (*pair)[0].get() : spec.get());
+            double n = 1;
+            if (pair && x) {
+                auto order = evaluate((*pair)[1], ctx);
+                auto value = std::get_if<Number>(order.get());
+                n = value ? value->value : -1;
+            }
+            if (!x || (pair && pair->size() != 2) || n < 0 || std::floor(n) != n) {
+                throw std::runtime_error("D expects a symbol or {symbol, n} with n a non-negative integer as its second argument");
+            }
+            auto result = evaluate(func.args[0], ctx);
+            for (double k = 0; k < n; ++k) {
+                auto d = differentiate(result, x->name);
+                // No rule for the head itself: stays D[result, x] (or {x, n - k}), unevaluated
+                if (auto call = std::get_if<FunctionCall>(d.get()); call && call->head == atoms::D && call->args[0] == result) {
+                    if (n - k == 1) return d;
+                    return make_fcall(atoms::D, { result, make_expr<List>(std::vector<ExprPtr>{ call->args[1], make_number(n - k) }) });
+                }
+                result = evaluate(d, ctx);
+            }
+            return result;
+            });
+
+        // Grad[expr, {x, y, ...}]: all the partial derivatives in one reverse-mode pass
+        registry.register_function("Grad", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 2) {
+                throw std::runtime_error("Grad expects exactly 2 arguments");
+            }
+            const std::vector<ExprPtr>* vars = nullptr;
+            if (auto l = std::get_if<List>(func.args[1].get())) vars = &l->elements;
+            else if (auto f = std::get_if<FunctionCall>(func.args[1].get()); f && f->head == atoms::List) vars = &f->args;
+            if (!vars || !std::all_of(vars->begin(), vars->end(), [](const ExprPtr& v) { return std::holds_alternative<Symbol>(*v); })) {
+                throw std::runtime_error("Grad expects a list of symbols as its second argument");
+            }
+            std::vector<Atom> names;
+            names.reserve(vars->size());
+            for (const auto& v : *vars) names.push_back(std::get<Symbol>(*v).name);
+            return evaluate(gradient(evaluate(func.args[0], ctx), names), ctx);
             });
 
         registry.register_function("N", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
             if (func.args.size() != 1) {
                 throw std::runtime_error("N expects exactly 1 argument");
             }
+            if (auto value = numeric_value(func.args[0], ctx)) return value;
             auto arg = evaluate(func.args[0], ctx);
             auto num_arg = numeric_eval(arg);
             return evaluate(num_arg, ctx);
             });
+
+        // SetAttributes[f, attr] and ClearAttributes[f, attr], with attr a name or a list of
+        // names, change the attributes of the symbol f; Attributes[f] lists them. All hold
+        // their arguments.
+        auto attributes_list = [](Attributes attrs) {
+            std::vector<ExprPtr> names;
+            for (std::string_view name : attribute_names(attrs)) names.push_back(make_expr<Symbol>(std::string(name)));
+            return make_expr<List>(std::move(names));
+        };
+        auto change_attributes = [attributes_list](const char* name, bool set) {
+            return [name, set, attributes_list](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 2) {
+                    throw std::runtime_error(std::string(name) + " expects exactly 2 arguments");
+                }
+                auto symbol = std::get_if<Symbol>(func.args[0].get());
+                if (!symbol) throw std::runtime_error(std::string(name) + " expects a symbol as its first argument");
+                const auto& registry = registry_of(ctx);
+                if (registry.is_builtin(symbol->name)) {
+                    throw std::runtime_error(std::string(name) + " cannot change the attributes of built-in " + symbol->name.str());
+                }
+                std::vector<ExprPtr> specs{ func.args[1] };
+                if (auto l = std::get_if<List>(func.args[1].get())) specs = l->elements;
+                else if (auto f = std::get_if<FunctionCall>(func.args[1].get()); f && f->head == atoms::List) specs = f->args;
+                Attributes attrs = registry.attributes(symbol->name, ctx);
+                for (const auto& spec : specs) {
+                    auto attr_name = std::get_if<Symbol>(spec.get());
+                    auto attr = attr_name ? attribute_named(attr_name->name.str()) : std::nullopt;
+                    if (!attr) throw std::runtime_error(std::string(name) + ": unknown attribute " + to_string(spec));
+                    attrs = set ? attrs | *attr : attrs.without(*attr);
+                }
+                registry.symbol_attributes(ctx).set(symbol->name, attrs);
+                detail::bump_definitions_epoch();
+                return attributes_list(attrs);
+            };
+        };
+        registry.register_function("SetAttributes", change_attributes("SetAttributes", true));
+        registry.register_function("ClearAttributes", change_attributes("ClearAttributes", false));
+        registry.register_function("Attributes", [attributes_list](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("Attributes expects exactly 1 argument");
+            }
+            auto symbol = std::get_if<Symbol>(func.args[0].get());
+            if (!symbol) throw std::runtime_error("Attributes expects a symbol");
+            return attributes_list(registry_of(ctx).attributes(symbol->name, ctx));
+            });
+
+        // Compile[{x, ...}, body]: the body is held and compiled to bytecode on first call
+        registry.register_function("Compile", [](const FunctionCall& func, EvaluationContext&) -> ExprPtr {
+            if (func.args.size() != 2) {
+                throw std::runtime_error("Compile expects exactly 2 arguments");
+            }
+            // Held, so the parameter list is still a List[...] call
+            const std::vector<ExprPtr>* params = nullptr;
+            if (auto list = std::get_if<List>(func.args[0].get())) params = &list->elements;
+            else if (auto call = std::get_if<FunctionCall>(func.args[0].get()); call && call->head == atoms::List) params = &call->args;
+            if (!params || !std::all_of(params->begin(), params->end(),
+                [](const ExprPtr& p) { return std::holds_alternative<Symbol>(*p); })) {
+                throw std::runtime_error("Compile expects a list of symbols as its first argument");
+            }
+            return make_fcall(atoms::CompiledFunction, { make_expr<List>(*params), normalize_expr(func.args[1]) });
+            });
+
+        // The value of Compile[] is inert until applied
+        registry.register_function("CompiledFunction", [](const FunctionCall& func, EvaluationContext&) -> ExprPtr {
+            return make_fcall(atoms::CompiledFunction, func.args);
+            });
+
+        // BinarySerialize[expr] gives the bytes of expr as a packed list of integers 0..255;
+        // BinarySerialize[expr, file] writes them to file and gives the file name
+        registry.register_function("BinarySerialize", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1 && func.args.size() != 2) {
+                throw std::runtime_error("BinarySerialize expects 1 or 2 arguments");
+            }
+            auto expr = evaluate(func.args[0], ctx);
+            if (func.args.size() == 2) {
+                auto file = evaluate(func.args[1], ctx);
+                auto* path = std::get_if<String>(file.get());
+                if (!path) throw std::runtime_error("BinarySerialize expects a file name as its second argument");
+                write_serialized(path->value, expr);
+                return file;
+            }
+            const std::string bytes = serialize(expr);
+            std::vector<int64_t> values(bytes.begin(), bytes.end());
+            for (auto& v : values) v &= 0xFF;
+            return make_packed({ values.size() }, std::move(values));
+            });
+
+        // SaveSnapshot[file] writes every variable and function in scope to file;
+        // LoadSnapshot[file] brings them back, each read on its first use
+        auto snapshot = [](const char* name, bool save) {
+            return [name, save](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 1) {
+                    throw std::runtime_error(std::string(name) + " expects exactly 1 argument");
+                }
+                auto file = evaluate(func.args[0], ctx);
+                auto* path = std::get_if<String>(file.get());
+                if (!path) throw std::runtime_error(std::string(name) + " expects a file name");
+                if (save) save_snapshot(ctx, path->value);
+                else load_snapshot(ctx, path->value);
+                return file;
+            };
+        };
+        registry.register_function("SaveSnapshot", snapshot("SaveSnapshot", true));
+        registry.register_function("LoadSnapshot", snapshot("LoadSnapshot", false));
+
+        // BinaryDeserialize[bytes] or BinaryDeserialize[file]: the expression written by
+        // BinarySerialize
+        registry.register_function("BinaryDeserialize", [](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+            if (func.args.size() != 1) {
+                throw std::runtime_error("BinaryDeserialize expects exactly 1 argument");
+            }
+            auto arg = evaluate(func.args[0], ctx);
+            if (auto* path = std::get_if<String>(arg.get())) return read_serialized(path->value);
+
+            std::string bytes;
+            auto* packed = std::get_if<PackedArray>(arg.get());
+            if (packed && packed->data->type() == PackedData::Type::Integer && packed->data->rank() == 1) {
+                const auto& values = std::get<std::vector<int64_t>>(packed->data->values);
+                bytes.reserve(values.size());
+                for (int64_t v : values) {
+                    if (v < 0 || v > 255) throw std::runtime_error("BinaryDeserialize expects integers from 0 to 255");
+                    bytes.push_back(static_cast<char>(v));
+                }
+            }
+            else if (auto* list = std::get_if<List>(arg.get())) {
+                bytes.reserve(list->elements.size());
+                for (const auto& e : list->elements) {
+                    auto* n = std::get_if<Number>(e.get());
+                    if (!n || n->value < 0 || n->value > 255 || n->value != std::floor(n->value)) {
+                        throw std::runtime_error("BinaryDeserialize expects integers from 0 to 255");
+                    }
+                    bytes.push_back(static_cast<char>(static_cast<int>(n->value)));
+                }
+            }
+            else {
+                throw std::runtime_error("BinaryDeserialize expects a list of bytes or a file name");
+            }
+            return deserialize(bytes);
+            });
+
+        // Timing[expr] and AbsoluteTiming[expr]: {seconds, value of expr}, in processor time
+        // (of all threads) or wall-clock time
+        auto timing = [](const char* name, bool absolute) {
+            return [name, absolute](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 1) {
+                    throw std::runtime_error(std::string(name) + " expects exactly 1 argument");
+                }
+                const std::clock_t cpu_start = std::clock();
+                const auto wall_start = std::chrono::steady_clock::now();
+                auto value = evaluate(func.args[0], ctx);
+                const double seconds = absolute
+                    ? std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count()
+                    : double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+                return make_list_auto_packed({ make_expr<Number>(seconds), value });
+            };
+        };
+        registry.register_function("Timing", timing("Timing", false));
+        registry.register_function("AbsoluteTiming", timing("AbsoluteTiming", true));
+
+        // MemoryInUse[] and MaxMemoryUsed[]: bytes of the expression pool in use now and at
+        // most so far (see ExprPool.hpp)
+        auto memory = [](const char* name, bool peak) {
+            return [name, peak](const FunctionCall& func, EvaluationContext&) -> ExprPtr {
+                if (!func.args.empty()) throw std::runtime_error(std::string(name) + " expects no arguments");
+                const auto stats = expr_pool_stats();
+                return make_expr<Number>(static_cast<double>(peak ? stats.peak_bytes_in_use : stats.bytes_in_use));
+            };
+        };
+        registry.register_function("MemoryInUse", memory("MemoryInUse", false));
+        registry.register_function("MaxMemoryUsed", memory("MaxMemoryUsed", true));
+
+        // TimeConstrained[expr, seconds, failexpr] and MemoryConstrained[expr, bytes, failexpr]:
+        // expr evaluated under that budget (see Budget.hpp). When it runs out the
+        // evaluation stops and failexpr, by default $Aborted, is evaluated instead.
+        auto constrained = [](const char* name, bool time) {
+            return [name, time](const FunctionCall& func, EvaluationContext& ctx) -> ExprPtr {
+                if (func.args.size() != 2 && func.args.size() != 3) {
+                    throw std::runtime_error(std::string(name) + " expects 2 or 3 arguments");
+                }
+                auto limit = evaluate(func.args[1], ctx);
+                auto* n = std::get_if<Number>(limit.get());
+                if (!n || !(n->value > 0)) {
+                    throw std::runtime_error(std::string(name) + " expects a positive " + (time ? "time" : "byte count"));
+                }
+                EvaluationBudget budget;
+                if (time) budget.time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(n->value));
+                else budget.memory = static_cast<size_t>(std::min(n->value, 1e18));
+                if (auto value = run_constrained(budget, [&] { return evaluate(func.args[0], ctx); })) return *value;
+                if (func.args.size() == 3) return evaluate(func.args[2], ctx);
+                return make_expr<Symbol>("$Aborted");
+            };
+        };
+        registry.register_function("TimeConstrained", constrained("TimeConstrained", true));
+        registry.register_function("MemoryConstrained", constrained("MemoryConstrained", false));
     }
 
 }
@@ -0,0 +1,377 @@
+#include "evaluator/Compiler.hpp"
+#include "expr/ExprHash.hpp"
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+
+        using Op = CompiledFunction::Op;
+        using Instruction = CompiledFunction::Instruction;
+
+        // Deeper bodies are left to the evaluator rather than lowered recursively
+        constexpr size_t MAX_DEPTH = 2048;
+
+        enum class Kind : uint8_t { Number, Boolean };
+
+        struct Value {
+            uint32_t reg;
+            Kind kind;
+        };
+
+        class Lowering {
+        public:
+            explicit Lowering(CompiledFunction& program) : p(program) {}
+
+            std::optional<Value> lower(const ExprPtr& e, size_t depth) {
+                if (depth > MAX_DEPTH) return std::nullopt;
+                if (auto n = std::get_if<Number>(e.get())) return constant(n->value);
+                if (auto b = std::get_if<Boolean>(e.get())) return Value{ constant(b->value ? 1.0 : 0.0).reg, Kind::Boolean };
+                if (auto r = std::get_if<Rational>(e.get())) {
+                    if (p.mode == CompileMode::Definition) return std::nullopt; // Exact arithmetic
+                    return constant(r->value());
+                }
+                if (auto c = std::get_if<Complex>(e.get())) {
+                    if (p.mode == CompileMode::Definition) return std::nullopt;
+                    p.complex = true;
+                    return constant({ c->real, c->imag });
+                }
+                if (auto s = std::get_if<Symbol>(e.get())) return symbol(s->name);
+                if (auto f = std::get_if<FunctionCall>(e.get())) return call(*f, depth);
+                return std::nullopt;
+            }
+
+        private:
+            CompiledFunction& p;
+
+            uint32_t fresh() { return p.registers++; }
+
+            Value constant(std::complex<double> v) {
+                for (const auto& c : p.constants) {
+                    if (c.value == v) return { c.reg, Kind::Number };
+                }
+                const uint32_t reg = fresh();
+                p.constants.push_back({ reg, v });
+                return { reg, Kind::Number };
+            }
+
+            Value emit(Op op, uint32_t a, uint32_t b, Kind kind, kernels::Unary fn = {}) {
+                const uint32_t dst = fresh();
+                p.code.push_back({ op, fn, dst, a, b });
+                return { dst, kind };
+            }
+
+            void use(Atom head) {
+                if (std::find(p.heads.begin(), p.heads.end(), head) == p.heads.end()) p.heads.push_back(head);
+            }
+
+            std::optional<Value> symbol(Atom name) {
+                for (uint32_t i = 0; i < p.params.size(); ++i) {
+                    if (p.params[i] == name) return Value{ i, Kind::Number };
+                }
+                // Constants stay exact in the evaluator, so only Compile[] turns them into reals
+                if (p.mode == CompileMode::Definition) return std::nullopt;
+                if (name == atoms::Pi) return constant(PI);
+                if (name == atoms::E) return constant(E);
+                if (name == atoms::Degree) return constant(PI / 180.0);
+                if (name == atoms::I) {
+                    p.complex = true;
+                    return constant({ 0.0, 1.0 });
+                }
+                return std::nullopt;
+            }
+
+            std::optional<std::vector<Value>> operands(const FunctionCall& f, size_t depth, Kind kind) {
+                std::vector<Value> values;
+                values.reserve(f.args.size());
+                for (const auto& arg : f.args) {
+                    auto v = lower(arg, depth + 1);
+                    if (!v || v->kind != kind) return std::nullopt;
+                    values.push_back(*v);
+                }
+                return values;
+            }
+
+            // a op b op c ...
+            std::optional<Value> fold(Op op, const FunctionCall& f, size_t depth, Kind kind, Kind result) {
+                auto values = operands(f, depth, kind);
+                if (!values || values->empty()) return std::nullopt;
+                Value acc = (*values)[0];
+                for (size_t i = 1; i < values->size(); ++i) acc = emit(op, acc.reg, (*values)[i].reg, result);
+                return acc;
+            }
+
+            std::optional<Value> binary(Op op, const FunctionCall& f, size_t depth, Kind kind, Kind result) {
+                if (f.args.size() != 2) return std::nullopt;
+                return fold(op, f, depth, kind, result);
+            }
+
+            std::optional<Value> call(const FunctionCall& f, size_t depth) {
+                const Atom head = f.head;
+                use(head);
+                if (head == atoms::Plus) return fold(Op::Add, f, depth, Kind::Number, Kind::Number);
+                if (head == atoms::Times) return fold(Op::Mul, f, depth, Kind::Number, Kind::Number);
+                if (head == atoms::Minus) {
+                    if (f.args.size() == 1) {
+                        auto x = lower(f.args[0], depth + 1);
+                        if (!x || x->kind != Kind::Number) return std::nullopt;
+                        return emit(Op::Mul, constant(-1.0).reg, x->reg, Kind::Number);
+                    }
+                    return binary(Op::Sub, f, depth, Kind::Number, Kind::Number);
+                }
+                if (head == atoms::Negate) {
+                    if (f.args.size() != 1) return std::nullopt;
+                    auto x = lower(f.args[0], depth + 1);
+                    if (!x || x->kind != Kind::Number) return std::nullopt;
+                    return emit(Op::Mul, constant(-1.0).reg, x->reg, Kind::Number);
+                }
+                if (head == atoms::Divide) return binary(Op::Div, f, depth, Kind::Number, Kind::Number);
+                if (head == atoms::Power) return binary(Op::Pow, f, depth, Kind::Number, Kind::Number);
+                if (head == atoms::Less) return binary(Op::Less, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::Greater) return binary(Op::Greater, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::LessEqual) return binary(Op::LessEqual, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::GreaterEqual) return binary(Op::GreaterEqual, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::Equal) return binary(Op::Equal, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::NotEqual) return binary(Op::NotEqual, f, depth, Kind::Number, Kind::Boolean);
+                if (head == atoms::And) return fold(Op::And, f, depth, Kind::Boolean, Kind::Boolean);
+                if (head == atoms::Or) return fold(Op::Or, f, depth, Kind::Boolean, Kind::Boolean);
+                if (head == atoms::Not) {
+                    if (f.args.size() != 1) return std::nullopt;
+                    auto x = lower(f.args[0], depth + 1);
+                    if (!x || x->kind != Kind::Boolean) return std::nullopt;
+                    return emit(Op::Not, x->reg, 0, Kind::Boolean);
+                }
+                if (head == atoms::If) return conditional(f, depth);
+                if (auto fn = kernels::unary_kernel(head); fn && f.args.size() == 1) {
+                    auto x = lower(f.args[0], depth + 1);
+                    if (!x || x->kind != Kind::Number) return std::nullopt;
+                    return emit(Op::Unary, x->reg, 0, Kind::Number, *fn);
+                }
+                return std::nullopt;
+            }
+
+            // cond; JumpIfFalse cond, else; then; Move; Jump end; else: else; Move; end:
+            std::optional<Value> conditional(const FunctionCall& f, size_t depth) {
+                if (f.args.size() != 3) return std::nullopt;
+                auto cond = lower(f.args[0], depth + 1);
+                if (!cond || cond->kind != Kind::Boolean) return std::nullopt;
+                const uint32_t dst = fresh();
+                const size_t branch = p.code.size();
+                p.code.push_back({ Op::JumpIfFalse, {}, 0, cond->reg, 0 });
+
+                auto then_value = lower(f.args[1], depth + 1);
+                if (!then_value) return std::nullopt;
+                p.code.push_back({ Op::Move, {}, dst, then_value->reg, 0 });
+                const size_t skip = p.code.size();
+                p.code.push_back({ Op::Jump, {}, 0, 0, 0 });
+
+                p.code[branch].b = static_cast<uint32_t>(p.code.size());
+                auto else_value = lower(f.args[2], depth + 1);
+                if (!else_value || else_value->kind != then_value->kind) return std::nullopt;
+                p.code.push_back({ Op::Move, {}, dst, else_value->reg, 0 });
+                p.code[skip].b = static_cast<uint32_t>(p.code.size());
+                return Value{ dst, then_value->kind };
+            }
+        };
+
+        // Complex programs only order-compare and round real values, which they cannot promise
+        bool valid_complex_program(const CompiledFunction& p) {
+            return std::all_of(p.code.begin(), p.code.end(), [](const Instruction& in) {
+                switch (in.op) {
+                case Op::Less: case Op::Greater: case Op::LessEqual: case Op::GreaterEqual:
+                    return false;
+                case Op::Unary:
+                    return kernels::has_complex_form(in.fn);
+                default:
+                    return true;
+                }
+            });
+        }
+
+        bool finite(double v) { return std::isfinite(v); }
+        bool finite(const std::complex<double>& v) { return std::isfinite(v.real()) && std::isfinite(v.imag()); }
+
+        bool truth(double v) { return v != 0.0; }
+        bool truth(const std::complex<double>& v) { return v.real() != 0.0; }
+
+        double real_part(double v) { return v; }
+        double real_part(const std::complex<double>& v) { return v.real(); }
+
+        bool unary(kernels::Unary f, double x, double& out) {
+            if (!kernels::in_real_domain(f, x)) return false;
+            out = kernels::apply_unary(f, x);
+            return true;
+        }
+
+        bool unary(kernels::Unary f, const std::complex<double>& x, std::complex<double>& out) {
+            return kernels::apply_unary(f, x, out);
+        }
+
+        template <typename T>
+        bool execute(const CompiledFunction& p, T* r) {
+            for (const auto& c : p.constants) {
+                if constexpr (std::is_same_v<T, double>) r[c.reg] = c.value.real();
+                else r[c.reg] = c.value;
+            }
+            const Instruction* code = p.code.data();
+            const size_t size = p.code.size();
+            for (size_t pc = 0; pc < size;) {
+                const Instruction& in = code[pc++];
+                T& d = r[in.dst];
+                switch (in.op) {
+                case Op::Add: d = r[in.a] + r[in.b]; break;
+                case Op::Sub: d = r[in.a] - r[in.b]; break;
+                case Op::Mul: d = r[in.a] * r[in.b]; break;
+                case Op::Div: d = r[in.a] / r[in.b]; break;
+                case Op::Pow: d = std::pow(r[in.a], r[in.b]); break;
+                case Op::Unary:
+                    if (!unary(in.fn, r[in.a], d)) return false;
+                    break;
+                case Op::Less:         d = real_part(r[in.a]) < real_part(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::Greater:      d = real_part(r[in.a]) > real_part(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::LessEqual:    d = real_part(r[in.a]) <= real_part(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::GreaterEqual: d = real_part(r[in.a]) >= real_part(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::Equal:        d = r[in.a] == r[in.b] ? 1.0 : 0.0; continue;
+                case Op::NotEqual:     d = r[in.a] != r[in.b] ? 1.0 : 0.0; continue;
+                case Op::And:          d = truth(r[in.a]) && truth(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::Or:           d = truth(r[in.a]) || truth(r[in.b]) ? 1.0 : 0.0; continue;
+                case Op::Not:          d = truth(r[in.a]) ? 0.0 : 1.0; continue;
+                case Op::Move:         d = r[in.a]; continue;
+                case Op::Jump:         pc = in.b; continue;
+                case Op::JumpIfFalse:
+                    if (!truth(r[in.a])) pc = in.b;
+                    continue;
+                }
+                // Infinities and NaN are the evaluator's to handle (Infinity, Indeterminate, ...)
+                if (!finite(d)) return false;
+            }
+            return true;
+        }
+
+        // Registers reused across calls on this thread, so a run allocates nothing once warm
+        template <typename T>
+        T* registers_for(const CompiledFunction& p) {
+            thread_local std::vector<T> registers;
+            if (registers.size() < p.registers) registers.resize(p.registers);
+            return registers.data();
+        }
+
+        struct CompiledCache {
+            static constexpr size_t MAX_ENTRIES = 1024;
+            std::mutex mutex;
+            std::unordered_map<ExprPtr, std::shared_ptr<const CompiledFunction>, ExprPtrHash, ExprPtrEqual> entries;
+        };
+
+        CompiledCache& compiled_cache() {
+            static CompiledCache cache;
+            return cache;
+        }
+
+    } // namespace
+
+    std::shared_ptr<const CompiledFunction> compile_function(const std::vector<Atom>& params,
+        const ExprPtr& body, CompileMode mode) {
+        if (!body) return nullptr;
+        auto program = std::make_shared<CompiledFunction>();
+        program->params = params;
+        program->mode = mode;
+        program->registers = static_cast<uint32_t>(params.size());
+
+        Lowering lowering(*program);
+        auto value = lowering.lower(body, 0);
+        if (!value) return nullptr;
+        if (program->complex && !valid_complex_program(*program)) return nullptr;
+        program->result = value->reg;
+        program->boolean_result = value->kind == Kind::Boolean;
+        return program;
+    }
+
+    std::shared_ptr<const CompiledFunction> compile_definition(const FunctionDefinition& def) {
+        std::vector<Atom> params;
+        params.reserve(def.params.size());
+        for (const auto& param : def.params) params.push_back(param.name);
+        return compile_function(params, def.body, CompileMode::Definition);
+    }
+
+    bool run_compiled(const CompiledFunction& program, const double* args, double& result) {
+        if (program.complex) return false;
+        double* r = registers_for<double>(program);
+        std::copy(args, args + program.params.size(), r);
+        if (!execute(program, r)) return false;
+        result = r[program.result];
+        return true;
+    }
+
+    ExprPtr run_compiled(const CompiledFunction& program, std::span<const ExprPtr> args) {
+        if (args.size() != program.params.size()) return nullptr;
+
+        // Arguments: machine reals, and for Compile[] also rationals and (complex programs) complex
+        auto load = [&](auto* r) {
+            using T = std::remove_pointer_t<decltype(r)>;
+            for (size_t i = 0; i < args.size(); ++i) {
+                const Expr& arg = *args[i];
+                if (auto n = std::get_if<Number>(&arg)) {
+                    r[i] = n->value;
+                }
+                else if (auto q = std::get_if<Rational>(&arg); q && program.mode == CompileMode::Machine) {
+                    r[i] = q->value();
+                }
+                else if (auto c = std::get_if<Complex>(&arg)) {
+                    if constexpr (std::is_same_v<T, std::complex<double>>) r[i] = T(c->real, c->imag);
+                    else return false;
+                }
+                else {
+                    return false;
+                }
+            }
+            return execute(program, r);
+        };
+
+        if (!program.complex) {
+            double* r = registers_for<double>(program);
+            if (!load(r)) return nullptr;
+            if (program.boolean_result) return make_expr<Boolean>(r[program.result] != 0.0);
+            return make_expr<Number>(r[program.result]);
+        }
+        std::complex<double>* r = registers_for<std::complex<double>>(program);
+        if (!load(r)) return nullptr;
+        const std::complex<double> value = r[program.result];
+        if (program.boolean_result) return make_expr<Boolean>(value.real() != 0.0);
+        if (value.imag() == 0.0) return make_expr<Number>(value.real());
+        return make_expr<Complex>(value.real(), value.imag());
+    }
+
+    std::shared_ptr<const CompiledFunction> compiled_function_of(const ExprPtr& expr) {
+        if (!is_compiled_function(*expr)) return nullptr;
+        auto& cache = compiled_cache();
+        {
+            std::lock_guard lock(cache.mutex);
+            if (auto it = cache.entries.find(expr); it != cache.entries.end()) return it->second;
+        }
+
+        const auto& node = std::get<FunctionCall>(*expr);
+        std::vector<Atom> params;
+        bool symbols = true;
+        for (const auto& param : std::get<List>(*node.args[0]).elements) {
+            auto sym = std::get_if<Symbol>(param.get());
+            if (!sym) {
+                symbols = false;
+                break;
+            }
+            params.push_back(sym->name);
+        }
+        auto program = symbols ? compile_function(params, node.args[1], CompileMode::Machine) : nullptr;
+
+        std::lock_guard lock(cache.mutex);
+        if (cache.entries.size() >= CompiledCache::MAX_ENTRIES) cache.entries.clear();
+        cache.entries.emplace(expr, program); // Failures too, so they are not retried
+        return program;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,132 @@
+#include "evaluator/ConstantFolding.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/AtomTable.hpp"
+#include "normalizer/Normalizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+        constexpr AtomSet ARITHMETIC = { "Plus", "Times", "Minus", "Divide", "Power", "Negate" };
+
+        bool is_numeric(const ExprPtr& e) { return numeric_kind(*e).has_value(); }
+
+        bool has_children(const ExprPtr& e) {
+            return std::holds_alternative<FunctionCall>(*e) || std::holds_alternative<List>(*e) ||
+                std::holds_alternative<Rule>(*e);
+        }
+
+        // The value of a call on numeric atoms, or nullptr if it is not a numeric atom
+        ExprPtr fold(const ExprPtr& call, EvaluationContext& empty) {
+            try {
+                ExprPtr value = evaluate(call, empty);
+                if (auto n = std::get_if<Number>(value.get()); n && !std::isfinite(n->value)) return nullptr;
+                return is_numeric(value) ? value : nullptr;
+            }
+            catch (const std::exception&) {
+                return nullptr;  // Exact division by zero and the like are reported when evaluated
+            }
+        }
+
+        // A sum or product with its numeric terms combined into one, in place of the first
+        ExprPtr fold_terms(const FunctionCall& f, EvaluationContext& empty) {
+            std::vector<ExprPtr> numbers, args;
+            size_t first = f.args.size();
+            for (size_t i = 0; i < f.args.size(); ++i) {
+                if (!is_numeric(f.args[i])) {
+                    args.push_back(f.args[i]);
+                    continue;
+                }
+                if (numbers.empty()) first = args.size();
+                numbers.push_back(f.args[i]);
+            }
+            auto value = fold(make_fcall(f.head, numbers), empty);
+            if (!value) return nullptr;
+            args.insert(args.begin() + static_cast<std::ptrdiff_t>(first), std::move(value));
+            return detail::mark_normal(detail::normalize_node(make_fcall(f.head, std::move(args))));
+        }
+    }
+
+    ExprPtr fold_constants(const ExprPtr& expr) {
+        if (!has_children(expr)) return expr;
+
+        struct Frame {
+            ExprPtr node;
+            std::vector<ExprPtr> owned;  // Sides of a Rule
+            const std::vector<ExprPtr>* children;
+            size_t next = 0;
+            std::vector<ExprPtr> folded;
+            bool changed = false;
+        };
+        std::vector<Frame> stack;
+        auto push = [&](const ExprPtr& node) {
+            Frame& frame = stack.emplace_back();
+            frame.node = node;
+            if (auto f = std::get_if<FunctionCall>(node.get())) {
+                frame.children = &f->args;
+            }
+            else if (auto l = std::get_if<List>(node.get())) {
+                frame.children = &l->elements;
+            }
+            else {
+                const auto& rule = std::get<Rule>(*node);
+                frame.owned = { rule.lhs, rule.rhs };
+                frame.children = &frame.owned;
+            }
+            frame.folded.reserve(frame.children->size());
+        };
+
+        EvaluationContext empty;
+        push(expr);
+        ExprPtr result;
+        while (true) {
+            Frame& top = stack.back();
+            if (top.next < top.children->size()) {
+                const ExprPtr& child = (*top.children)[top.next++];
+                if (has_children(child)) push(child);  // Invalidates `top`
+                else top.folded.push_back(child);
+                continue;
+            }
+
+            ExprPtr node = std::move(top.node);
+            if (top.changed) {
+                if (auto f = std::get_if<FunctionCall>(node.get())) {
+                    node = detail::mark_normal(detail::normalize_node(make_fcall(f->head, std::move(top.folded))));
+                }
+                else if (std::holds_alternative<List>(*node)) {
+                    node = detail::mark_normal(make_expr<List>(std::move(top.folded)));
+                }
+                else {
+                    node = make_expr<Rule>(top.folded[0], top.folded[1]);
+                }
+            }
+            if (auto f = std::get_if<FunctionCall>(node.get()); f && ARITHMETIC.contains(f->head) && !f->args.empty()) {
+                const auto numeric = static_cast<size_t>(std::count_if(f->args.begin(), f->args.end(), is_numeric));
+                if (numeric == f->args.size()) {
+                    if (auto value = fold(node, empty)) node = std::move(value);
+                }
+                else if (numeric > 1 && (f->head == atoms::Plus || f->head == atoms::Times)) {
+                    if (auto value = fold_terms(*f, empty)) node = std::move(value);
+                }
+            }
+            stack.pop_back();
+            if (stack.empty()) {
+                result = std::move(node);
+                break;
+            }
+            Frame& parent = stack.back();
+            parent.changed |= node != (*parent.children)[parent.next - 1];
+            parent.folded.push_back(std::move(node));
+        }
+        return result;
+    }
+
+    ExprPtr optimize_expr(const ExprPtr& expr) {
+        return fold_constants(normalize_expr(expr));
+    }
+
+} // namespace aleph3
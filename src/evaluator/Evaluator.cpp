@@ -5,6 +5,10 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <cstdint>
 
 namespace aleph3 {
 
@@ -28,70 +32,187 @@ namespace aleph3 {
         throw std::runtime_error("Variable argument must be a symbol or list of symbols");
     }
 
+    // Helper: The symbols and exponents of a monomial form such as x, x^2 or x^2 * y, for Coefficient
+    void monomial_factors(const ExprPtr& form, std::vector<std::string>& variables, std::vector<uint32_t>& exponents) {
+        if (auto sym = std::get_if<Symbol>(form.get())) {
+            variables.push_back(sym->name);
+            exponents.push_back(1);
+            return;
+        }
+        if (auto f = std::get_if<FunctionCall>(form.get())) {
+            if (f->head == atoms::Times) {
+                for (const auto& factor : f->args) monomial_factors(factor, variables, exponents);
+                return;
+            }
+            if (f->head == atoms::Power && f->args.size() == 2) {
+                auto sym = std::get_if<Symbol>(f->args[0].get());
+                auto n = std::get_if<Number>(f->args[1].get());
+                if (sym && n && n->value >= 0 && std::floor(n->value) == n->value && n->value <= UINT32_MAX) {
+                    variables.push_back(sym->name);
+                    exponents.push_back(static_cast<uint32_t>(n->value));
+                    return;
+                }
+            }
+        }
+        throw std::runtime_error("Coefficient expects a product of powers of symbols as its form");
+    }
+
+    // Helper: The elements of a list argument, such as the polynomials of GroebnerBasis
+    std::vector<ExprPtr> list_elements(const ExprPtr& expr, const std::string& function) {
+        auto list = std::get_if<List>(&*materialize(unpack(expr)));
+        if (!list) throw std::runtime_error(function + " expects a list of polynomials");
+        return list->elements;
+    }
+
+    // Helper: The MonomialOrder and Modulus options of GroebnerBasis and PolynomialReduce
+    void groebner_options(const FunctionCall& func, size_t first, EvaluationContext& ctx, MonomialOrder& order, uint64_t& modulus) {
+        const std::string name = func.head.str();
+        for (size_t i = first; i < func.args.size(); ++i) {
+            auto option = evaluate(func.args[i], ctx);
+            auto rule = std::get_if<Rule>(option.get());
+            auto key = rule ? std::get_if<Symbol>(rule->lhs.get()) : nullptr;
+            if (key && key->name == "MonomialOrder") {
+                auto value = std::get_if<Symbol>(rule->rhs.get());
+                auto named = value ? monomial_order_named(value->name.str()) : std::nullopt;
+                if (!named) throw std::runtime_error(name + " expects MonomialOrder -> Lexicographic, DegreeLexicographic or DegreeReverseLexicographic");
+                order = *named;
+            }
+            else if (key && key->name == "Modulus") {
+                auto value = std::get_if<Number>(rule->rhs.get());
+                if (!value || value->value < 0 || std::floor(value->value) != value->value || value->value >= 9.2e18)
+                    throw std::runtime_error(name + " expects Modulus -> a prime");
+                modulus = static_cast<uint64_t>(value->value);
+            }
+            else {
+                throw std::runtime_error(name + " expects the options MonomialOrder and Modulus");
+            }
+        }
+    }
+
     ExprPtr evaluate_polynomial_function(const FunctionCall& func, EvaluationContext& ctx) {
-        const std::string& name = func.head;
+        Atom name = func.head;
         size_t nargs = func.args.size();
 
-        if (name == "Expand") {
+        if (name == atoms::Expand) {
             if (nargs != 1) throw std::runtime_error("Expand expects exactly one argument");
             auto arg = evaluate(func.args[0], ctx);
             return expand_polynomial(arg, ctx);
         }
-        if (name == "Factor") {
+        if (name == atoms::Factor) {
             if (nargs != 1) throw std::runtime_error("Factor expects exactly one argument");
             auto arg = evaluate(func.args[0], ctx);
-            return factor_polynomial(arg, ctx);
+            return evaluate(factor_polynomial(arg, ctx), ctx);
         }
-        if (name == "Collect") {
+        if (name == atoms::Collect) {
             if (nargs != 2) throw std::runtime_error("Collect expects exactly two arguments");
             auto arg = evaluate(func.args[0], ctx);
             auto var_arg = evaluate(func.args[1], ctx);
             auto variables = extract_variables(var_arg);
-            return collect_polynomial(arg, variables, ctx);
+            // Evaluated, which drops unit factors and orders each sum
+            return evaluate(collect_polynomial(arg, variables, ctx), ctx);
         }
-        if (name == "GCD") {
+        if (name == atoms::Coefficient) {
+            if (nargs != 2 && nargs != 3) throw std::runtime_error("Coefficient expects two or three arguments");
+            auto arg = evaluate(func.args[0], ctx);
+            auto form = evaluate(func.args[1], ctx);
+            std::vector<std::string> variables;
+            std::vector<uint32_t> exponents;
+            if (nargs == 3) {
+                auto var = std::get_if<Symbol>(form.get());
+                auto n = std::get_if<Number>(evaluate(func.args[2], ctx).get());
+                if (!var || !n || n->value < 0 || std::floor(n->value) != n->value || n->value > UINT32_MAX)
+                    throw std::runtime_error("Coefficient expects a symbol and a non-negative integer exponent");
+                variables.push_back(var->name);
+                exponents.push_back(static_cast<uint32_t>(n->value));
+            }
+            else {
+                monomial_factors(form, variables, exponents);
+            }
+            return evaluate(coefficient_polynomial(arg, variables, exponents, ctx), ctx);
+        }
+        if (name == atoms::CoefficientList) {
+            if (nargs != 2) throw std::runtime_error("CoefficientList expects exactly two arguments");
+            auto arg = evaluate(func.args[0], ctx);
+            auto variables = extract_variables(evaluate(func.args[1], ctx));
+            // Evaluating the List calls also packs numeric rows
+            return evaluate(coefficient_list_polynomial(arg, variables, ctx), ctx);
+        }
+        if (name == atoms::Exponent) {
+            if (nargs != 2) throw std::runtime_error("Exponent expects exactly two arguments");
+            auto arg = evaluate(func.args[0], ctx);
+            auto var = std::get_if<Symbol>(evaluate(func.args[1], ctx).get());
+            if (!var) throw std::runtime_error("Exponent expects a symbol as its second argument");
+            return exponent_polynomial(arg, var->name, ctx);
+        }
+        if (name == atoms::GCD) {
             if (nargs != 2) throw std::runtime_error("GCD expects exactly two arguments");
             auto arg1 = evaluate(func.args[0], ctx);
             auto arg2 = evaluate(func.args[1], ctx);
-            // For GCD, require user to specify variables as a third argument for multivariate, or infer from args
-            // Here we infer from arg1 (could be improved)
-            std::set<std::string> vars;
-            std::function<void(const ExprPtr&)> visit = [&](const ExprPtr& e) {
-                if (!e) return;
-                if (auto sym = std::get_if<Symbol>(&(*e))) {
-                    vars.insert(sym->name);
-                }
-                else if (auto func = std::get_if<FunctionCall>(&(*e))) {
-                    for (const auto& a : func->args) visit(a);
-                }
-                };
-            visit(arg1);
-            std::vector<std::string> variables(vars.begin(), vars.end());
+            // The variables of both arguments, sorted
+            auto variables = infer_variables(arg1);
+            auto others = infer_variables(arg2);
+            std::vector<std::string> all;
+            std::set_union(variables.begin(), variables.end(), others.begin(), others.end(), std::back_inserter(all));
+            variables = std::move(all);
             return gcd_polynomial(arg1, arg2, variables, ctx);
         }
-        if (name == "PolynomialQuotient") {
+        if (name == atoms::GroebnerBasis || name == atoms::PolynomialReduce) {
+            const bool basis = name == atoms::GroebnerBasis;
+            const size_t fixed = basis ? 2 : 3;
+            if (nargs < fixed) throw std::runtime_error(name.str() + (basis ? " expects polynomials and variables" : " expects a polynomial, divisors and variables"));
+            MonomialOrder order = MonomialOrder::Lexicographic;
+            uint64_t modulus = 0;
+            groebner_options(func, fixed, ctx, order, modulus);
+            auto variables = extract_variables(evaluate(func.args[fixed - 1], ctx));
+            if (basis) {
+                auto polys = list_elements(evaluate(func.args[0], ctx), name.str());
+                return evaluate(groebner_basis_polynomial(polys, variables, order, modulus, ctx), ctx);
+            }
+            auto f = evaluate(func.args[0], ctx);
+            auto divisors = list_elements(evaluate(func.args[1], ctx), name.str());
+            return evaluate(reduce_polynomial(f, divisors, variables, order, modulus, ctx), ctx);
+        }
+        if (name == atoms::Resultant || name == atoms::Subresultants || name == atoms::Discriminant) {
+            const size_t expected = name == atoms::Discriminant ? 2 : 3;
+            if (nargs != expected) throw std::runtime_error(name.str() + (expected == 2 ? " expects a polynomial and a variable" : " expects two polynomials and a variable"));
+            auto var = std::get_if<Symbol>(evaluate(func.args[expected - 1], ctx).get());
+            if (!var) throw std::runtime_error(name.str() + " expects a symbol as its last argument");
+            auto a = evaluate(func.args[0], ctx);
+            if (name == atoms::Discriminant) return evaluate(discriminant_polynomial(a, var->name, ctx), ctx);
+            auto b = evaluate(func.args[1], ctx);
+            if (name == atoms::Resultant) return evaluate(resultant_polynomial(a, b, var->name, ctx), ctx);
+            return evaluate(subresultants_polynomial(a, b, var->name, ctx), ctx);
+        }
+        if (name == atoms::Together || name == atoms::Cancel) {
+            if (nargs != 1) throw std::runtime_error(name.str() + " expects exactly one argument");
+            auto arg = evaluate(func.args[0], ctx);
+            if (name == atoms::Together) return evaluate(together_polynomial(arg, ctx), ctx);
+            return evaluate(cancel_polynomial(arg, ctx), ctx);
+        }
+        if (name == atoms::PolynomialQuotient) {
             if (nargs != 2) throw std::runtime_error("PolynomialQuotient expects exactly two arguments");
             auto dividend = evaluate(func.args[0], ctx);
             auto divisor = evaluate(func.args[1], ctx);
-            // Infer variables from dividend
-            std::set<std::string> vars;
-            std::function<void(const ExprPtr&)> visit = [&](const ExprPtr& e) {
-                if (!e) return;
-                if (auto sym = std::get_if<Symbol>(&(*e))) {
-                    vars.insert(sym->name);
-                }
-                else if (auto func = std::get_if<FunctionCall>(&(*e))) {
-                    for (const auto& a : func->args) visit(a);
-                }
-                };
-            visit(dividend);
-            std::vector<std::string> variables(vars.begin(), vars.end());
+            // The variables of both arguments, sorted
+            auto variables = infer_variables(dividend);
+            auto others = infer_variables(divisor);
+            std::vector<std::string> all;
+            std::set_union(variables.begin(), variables.end(), others.begin(), others.end(), std::back_inserter(all));
+            variables = std::move(all);
             auto result = divide_polynomial(dividend, divisor, variables, ctx);
             // Return as a list: {quotient, remainder}
             return make_expr<List>(std::vector<ExprPtr>{result.first, result.second});
         }
 
-        throw std::runtime_error("Unknown polynomial function: " + name);
+        if (name == atoms::PolynomialEvaluate) {
+            if (nargs != 3) throw std::runtime_error("PolynomialEvaluate expects exactly three arguments");
+            auto arg = evaluate(func.args[0], ctx);
+            auto variables = extract_variables(evaluate(func.args[1], ctx));
+            auto points = evaluate(func.args[2], ctx);
+            return evaluate_polynomial(arg, variables, points, ctx);
+        }
+
+        throw std::runtime_error("Unknown polynomial function: " + name.str());
     }
 
 } // namespace aleph3
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "evaluator/NumericEval.hpp"
+#include "evaluator/Compiler.hpp"
+#include "expr/ExprHash.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+
+        // Deeper expressions take the exact path, as in the compiler
+        constexpr size_t MAX_DEPTH = 2048;
+
+        bool is_exact_constant(const Expr& e) {
+            if (std::holds_alternative<Rational>(e)) return true;
+            auto s = std::get_if<Symbol>(&e);
+            return s && (s->name == atoms::Pi || s->name == atoms::E || s->name == atoms::Degree ||
+                s->name == atoms::I);
+        }
+
+        // Free symbols in order of first appearance, and whether the fast path must decline
+        struct Scan {
+            std::vector<Atom> symbols;
+            bool declined = false;
+
+            void visit(const ExprPtr& e, bool transcendental, size_t depth) {
+                if (declined) return;
+                if (depth > MAX_DEPTH || (transcendental && is_exact_constant(*e))) {
+                    declined = true;
+                    return;
+                }
+                if (auto s = std::get_if<Symbol>(e.get())) {
+                    if (!is_exact_constant(*e) &&
+                        std::find(symbols.begin(), symbols.end(), s->name) == symbols.end()) {
+                        symbols.push_back(s->name);
+                    }
+                    return;
+                }
+                if (auto f = std::get_if<FunctionCall>(e.get())) {
+                    const bool below = transcendental || f->head == atoms::Power ||
+                        kernels::unary_kernel(f->head).has_value();
+                    for (const auto& arg : f->args) visit(arg, below, depth + 1);
+                }
+            }
+        };
+
+        struct ProgramCache {
+            static constexpr size_t MAX_ENTRIES = 1024;
+            std::mutex mutex;
+            std::unordered_map<ExprPtr, std::shared_ptr<const CompiledFunction>, ExprPtrHash, ExprPtrEqual> entries;
+        };
+
+        ProgramCache& program_cache() {
+            static ProgramCache cache;
+            return cache;
+        }
+
+        // Program taking the free symbols of `expr` as parameters; nullptr if N[] must not use one
+        std::shared_ptr<const CompiledFunction> program_for(const ExprPtr& expr) {
+            auto& cache = program_cache();
+            {
+                std::lock_guard lock(cache.mutex);
+                if (auto it = cache.entries.find(expr); it != cache.entries.end()) return it->second;
+            }
+
+            Scan scan;
+            scan.visit(expr, false, 0);
+            std::shared_ptr<const CompiledFunction> program;
+            if (!scan.declined && !scan.symbols.empty()) {
+                program = compile_function(scan.symbols, expr, CompileMode::Machine);
+            }
+
+            std::lock_guard lock(cache.mutex);
+            if (cache.entries.size() >= ProgramCache::MAX_ENTRIES) cache.entries.clear();
+            cache.entries.emplace(expr, program); // Failures too, so they are not retried
+            return program;
+        }
+
+    } // namespace
+
+    ExprPtr numeric_value(const ExprPtr& expr, const EvaluationContext& ctx) {
+        if (!std::holds_alternative<FunctionCall>(*expr)) return nullptr;
+        auto program = program_for(expr);
+        if (!program) return nullptr;
+
+        const auto& heads = program->heads;
+        const bool redefined = std::any_of(heads.begin(), heads.end(), [&ctx](Atom head) {
+            return ctx.find_function(head) != nullptr;
+        });
+        if (redefined) return nullptr;
+
+        // Slot table reused across calls on this thread; run_compiled() checks that each
+        // binding is a machine number
+        thread_local std::vector<ExprPtr> slots;
+        slots.clear();
+        for (Atom name : program->params) {
+            const ExprPtr* value = ctx.find_variable(name);
+            if (!value || !*value) {
+                slots.clear();
+                return nullptr;
+            }
+            slots.push_back(*value);
+        }
+        auto result = run_compiled(*program, slots);
+        slots.clear(); // Do not keep the bindings alive
+        return result;
+    }
+
+} // namespace aleph3
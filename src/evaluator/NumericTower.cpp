@@ -0,0 +1,238 @@
+#include "evaluator/NumericTower.hpp"
+#include "expr/ExprUtils.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "expr/VectorKernels.hpp"
+#include "Constants.hpp"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace aleph3 {
+
+    namespace {
+
+        using kernels::Binary;
+        using Handler = ExprPtr(*)(const ExprPtr& a, const ExprPtr& b);
+
+        // Exponents up to this size are applied to complex bases by repeated squaring
+        constexpr double MAX_SQUARING_EXPONENT = 1024.0;
+
+        bool is_integer(double v) { return std::isfinite(v) && std::floor(v) == v; }
+
+        std::complex<double> complex_of(const Expr& e) {
+            if (auto n = std::get_if<Number>(&e)) return n->value;
+            if (auto r = std::get_if<Rational>(&e)) return r->value();
+            const auto& c = std::get<Complex>(e);
+            return { c.real, c.imag };
+        }
+
+        ExprPtr complex_node(const std::complex<double>& z) {
+            if (!std::isfinite(z.real()) || !std::isfinite(z.imag())) return nullptr;
+            if (z.imag() == 0.0) return make_expr<Number>(z.real());
+            return make_expr<Complex>(z.real(), z.imag());
+        }
+
+        std::complex<double> integer_power(std::complex<double> base, double exponent) {
+            const bool invert = exponent < 0;
+            auto n = static_cast<uint64_t>(std::abs(exponent));
+            std::complex<double> result = 1.0;
+            while (n) {
+                if (n & 1) result *= base;
+                base *= base;
+                n >>= 1;
+            }
+            return invert ? 1.0 / result : result;
+        }
+
+        // Principal value of a^b for a < 0 and non-integer b: |a|^b e^(i Pi b)
+        ExprPtr negative_real_power(double a, double b) {
+            const double r = std::pow(-a, b);
+            const double k = std::floor(b);
+            if (b - k == 0.5) return complex_node({ 0.0, std::fmod(k, 2.0) == 0.0 ? r : -r }); // +-i r exactly
+            return complex_node({ r * std::cos(PI * b), r * std::sin(PI * b) });
+        }
+
+        double real_op(Binary op, double x, double y) {
+            switch (op) {
+            case Binary::Plus:   return x + y;
+            case Binary::Minus:  return x - y;
+            case Binary::Times:  return x * y;
+            case Binary::Divide: return x / y;
+            case Binary::Power:  return std::pow(x, y);
+            }
+            return x;
+        }
+
+        // Powers leaving the reals become complex; everything else is IEEE arithmetic
+        ExprPtr number_number(Binary op, const Expr& a, const Expr& b) {
+            const double x = std::get<Number>(a).value, y = std::get<Number>(b).value;
+            if (op == Binary::Power && x < 0 && std::isfinite(y) && !is_integer(y)) return negative_real_power(x, y);
+            return make_expr<Number>(real_op(op, x, y));
+        }
+
+        ExprPtr rational_result(const BigInt& n, const BigInt& d) {
+            auto [num, den] = normalize_rational(n, d);
+            return make_expr<Rational>(std::move(num), std::move(den));
+        }
+
+        ExprPtr exact(Binary op, const BigInt& an, const BigInt& ad, const BigInt& bn, const BigInt& bd) {
+            switch (op) {
+            case Binary::Plus:   return rational_result(an * bd + bn * ad, ad * bd);
+            case Binary::Minus:  return rational_result(an * bd - bn * ad, ad * bd);
+            case Binary::Times:  return rational_result(an * bn, ad * bd);
+            case Binary::Divide:
+                if (bn.is_zero()) throw std::runtime_error("Division by zero");
+                return rational_result(an * bd, ad * bn);
+            case Binary::Power:  return nullptr; // Exact powers and roots are SimplificationRules'
+            }
+            return nullptr;
+        }
+
+        ExprPtr rational_rational(Binary op, const Expr& a, const Expr& b) {
+            const auto& x = std::get<Rational>(a);
+            const auto& y = std::get<Rational>(b);
+            return exact(op, x.numerator, x.denominator, y.numerator, y.denominator);
+        }
+
+        // Integer Numbers join the rational exactly; other reals make the result a real
+        ExprPtr rational_number(Binary op, const Expr& a, const Expr& b) {
+            const auto& x = std::get<Rational>(a);
+            const double y = std::get<Number>(b).value;
+            if (is_integer(y)) return exact(op, x.numerator, x.denominator, BigInt::from_double(y), 1);
+            if (op == Binary::Power && x.numerator.sign() < 0) return negative_real_power(x.value(), y);
+            return make_expr<Number>(real_op(op, x.value(), y));
+        }
+
+        ExprPtr number_rational(Binary op, const Expr& a, const Expr& b) {
+            const double x = std::get<Number>(a).value;
+            const auto& y = std::get<Rational>(b);
+            if (is_integer(x)) return exact(op, BigInt::from_double(x), 1, y.numerator, y.denominator);
+            if (op == Binary::Power && x < 0) return negative_real_power(x, y.value());
+            return make_expr<Number>(real_op(op, x, y.value()));
+        }
+
+        ExprPtr with_complex(Binary op, const Expr& a, const Expr& b) {
+            const std::complex<double> x = complex_of(a), y = complex_of(b);
+            switch (op) {
+            case Binary::Plus:  return complex_node(x + y);
+            case Binary::Minus: return complex_node(x - y);
+            case Binary::Times: return complex_node(x * y);
+            case Binary::Divide:
+                if (y == 0.0) return nullptr; // ComplexInfinity and friends are the rules' to decide
+                return complex_node(x / y);
+            case Binary::Power:
+                if (x == 0.0) return nullptr;
+                if (y.imag() == 0.0 && is_integer(y.real()) && std::abs(y.real()) <= MAX_SQUARING_EXPONENT) {
+                    return complex_node(integer_power(x, y.real()));
+                }
+                return complex_node(std::pow(x, y));
+            }
+            return nullptr;
+        }
+
+        Atom op_name(Binary op) {
+            switch (op) {
+            case Binary::Plus:   return atoms::Plus;
+            case Binary::Minus:  return atoms::Minus;
+            case Binary::Times:  return atoms::Times;
+            case Binary::Divide: return atoms::Divide;
+            case Binary::Power:  return atoms::Power;
+            }
+            return atoms::Plus;
+        }
+
+        template <typename T>
+        constexpr bool is_scalar_v = std::is_same_v<T, Number> || std::is_same_v<T, Rational> || std::is_same_v<T, Complex>;
+
+        template <typename T>
+        constexpr bool is_array_v = std::is_same_v<T, PackedArray> || std::is_same_v<T, LazyList>;
+
+        // Operands a packed buffer combines with (see packed_elementwise)
+        template <typename T>
+        constexpr bool is_packed_operand_v = is_array_v<T> || std::is_same_v<T, Number> || std::is_same_v<T, Complex>;
+
+        template <Binary Op, typename A, typename B>
+        ExprPtr pair(const ExprPtr& a, const ExprPtr& b) {
+            if constexpr (std::is_same_v<A, LazyList> || std::is_same_v<B, LazyList>) {
+                // Affine maps keep a progression lazy; anything else needs its elements
+                if (auto lazy = lazy_affine(Op, a, b)) return lazy;
+                return packed_elementwise(op_name(Op), materialize(a), materialize(b));
+            } else if constexpr (is_array_v<A> || is_array_v<B>) {
+                return packed_elementwise(op_name(Op), a, b);
+            } else if constexpr (std::is_same_v<A, Complex> || std::is_same_v<B, Complex>) {
+                return with_complex(Op, *a, *b);
+            } else if constexpr (std::is_same_v<A, Rational> && std::is_same_v<B, Rational>) {
+                return rational_rational(Op, *a, *b);
+            } else if constexpr (std::is_same_v<A, Rational>) {
+                return rational_number(Op, *a, *b);
+            } else if constexpr (std::is_same_v<B, Rational>) {
+                return number_rational(Op, *a, *b);
+            } else {
+                return number_number(Op, *a, *b);
+            }
+        }
+
+        constexpr size_t ALTERNATIVES = std::variant_size_v<Expr>;
+        constexpr size_t OPS = static_cast<size_t>(Binary::Power) + 1;
+
+        template <Binary Op, size_t I, size_t J>
+        constexpr Handler entry() {
+            using A = std::variant_alternative_t<I, Expr>;
+            using B = std::variant_alternative_t<J, Expr>;
+            constexpr bool packed = is_array_v<A> || is_array_v<B>;
+            if constexpr (is_scalar_v<A> && is_scalar_v<B>) return &pair<Op, A, B>;
+            else if constexpr (packed && is_packed_operand_v<A> && is_packed_operand_v<B>) return &pair<Op, A, B>;
+            else return nullptr;
+        }
+
+        template <Binary Op, size_t... K>
+        constexpr std::array<Handler, ALTERNATIVES * ALTERNATIVES> op_table(std::index_sequence<K...>) {
+            return { entry<Op, K / ALTERNATIVES, K % ALTERNATIVES>()... };
+        }
+
+        template <size_t... Op>
+        constexpr auto make_dispatch(std::index_sequence<Op...>) {
+            return std::array{ op_table<static_cast<Binary>(Op)>(std::make_index_sequence<ALTERNATIVES * ALTERNATIVES>{})... };
+        }
+
+        // Indexed [op][a.index() * ALTERNATIVES + b.index()]; pairs without arithmetic are nullptr
+        constexpr auto DISPATCH = make_dispatch(std::make_index_sequence<OPS>{});
+
+    } // namespace
+
+    std::optional<NumericKind> numeric_kind(const Expr& e) {
+        if (std::holds_alternative<Number>(e)) return NumericKind::Number;
+        if (std::holds_alternative<Rational>(e)) return NumericKind::Rational;
+        if (std::holds_alternative<Complex>(e)) return NumericKind::Complex;
+        return std::nullopt;
+    }
+
+    ExprPtr numeric_binary(Atom op, const ExprPtr& a, const ExprPtr& b) {
+        const auto kernel = kernels::binary_kernel(op);
+        return kernel ? numeric_binary(*kernel, a, b) : nullptr;
+    }
+
+    ExprPtr numeric_binary(kernels::Binary op, const ExprPtr& a, const ExprPtr& b) {
+        const Handler handler = DISPATCH[static_cast<size_t>(op)][a->index() * ALTERNATIVES + b->index()];
+        return handler ? handler(a, b) : nullptr;
+    }
+
+    std::optional<bool> complex_equal(const ExprPtr& a, const ExprPtr& b) {
+        const auto ka = numeric_kind(*a), kb = numeric_kind(*b);
+        if (!ka || !kb || (*ka != NumericKind::Complex && *kb != NumericKind::Complex)) return std::nullopt;
+        return complex_of(*a) == complex_of(*b);
+    }
+
+    ExprPtr complex_unary(Atom f, const Complex& z) {
+        const auto kernel = kernels::unary_kernel(f);
+        std::complex<double> out;
+        if (!kernel || !kernels::apply_unary(*kernel, std::complex<double>(z.real, z.imag), out)) return nullptr;
+        return complex_node(out);
+    }
+
+} // namespace aleph3
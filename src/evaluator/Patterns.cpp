@@ -0,0 +1,590 @@
+#include "evaluator/Patterns.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "parser/Lexer.hpp"
+#include "util/Overloaded.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+        constexpr Atom INTEGER = builtin_atom("Integer");
+        constexpr Atom REAL = builtin_atom("Real");
+        constexpr Atom STRING = builtin_atom("String");
+        constexpr Atom SYMBOL = builtin_atom("Symbol");
+
+        // Elements of a compound expression, or nullptr for an atom. Packed arrays and lazy
+        // lists have no vector of elements; theirs are put in `storage`.
+        const std::vector<ExprPtr>* elements(const ExprPtr& e, std::vector<ExprPtr>& storage) {
+            if (auto f = std::get_if<FunctionCall>(e.get())) return &f->args;
+            if (auto l = std::get_if<List>(e.get())) return &l->elements;
+            if (auto r = std::get_if<Rule>(e.get())) {
+                storage = { r->lhs, r->rhs };
+                return &storage;
+            }
+            if (auto p = std::get_if<PackedArray>(e.get())) {
+                storage.clear();
+                storage.reserve(p->data->length());
+                for (size_t i = 0; i < p->data->length(); ++i) storage.push_back(packed_part(*p->data, i));
+                return &storage;
+            }
+            if (auto lazy = std::get_if<LazyList>(e.get())) {
+                storage.clear();
+                storage.reserve(lazy->count);
+                for (size_t i = 0; i < lazy->count; ++i) storage.push_back(lazy_part(*lazy, i));
+                return &storage;
+            }
+            return nullptr;
+        }
+
+        bool is_compound(const Expr& e) {
+            return std::holds_alternative<FunctionCall>(e) || std::holds_alternative<List>(e) ||
+                std::holds_alternative<Rule>(e) || std::holds_alternative<PackedArray>(e) ||
+                std::holds_alternative<LazyList>(e);
+        }
+
+        // Length of a compound expression
+        size_t arity(const Expr& e) {
+            if (auto f = std::get_if<FunctionCall>(&e)) return f->args.size();
+            if (auto l = std::get_if<List>(&e)) return l->elements.size();
+            if (auto p = std::get_if<PackedArray>(&e)) return p->data->length();
+            if (auto lazy = std::get_if<LazyList>(&e)) return lazy->count;
+            return 2; // Rule
+        }
+
+        std::optional<BlankSymbol> blank_of(const Expr& e) {
+            auto sym = std::get_if<Symbol>(&e);
+            if (!sym || sym->name.str().find('_') == std::string::npos) return std::nullopt;
+            return parse_blank(sym->name.str());
+        }
+
+        bool is_condition(const Expr& e) {
+            auto f = std::get_if<FunctionCall>(&e);
+            return f && f->head == atoms::Condition && f->args.size() == 2;
+        }
+
+        bool has_pattern(const ExprPtr& e) {
+            if (blank_of(*e) || is_condition(*e)) return true;
+            if (auto f = std::get_if<FunctionCall>(e.get())) {
+                return std::any_of(f->args.begin(), f->args.end(), has_pattern);
+            }
+            if (auto l = std::get_if<List>(e.get())) {
+                return std::any_of(l->elements.begin(), l->elements.end(), has_pattern);
+            }
+            if (auto r = std::get_if<Rule>(e.get())) return has_pattern(r->lhs) || has_pattern(r->rhs);
+            return false;
+        }
+
+        // A pattern argument that takes a sequence: x__ or x___, under any conditions
+        bool is_sequence(const ExprPtr& e) {
+            const ExprPtr* p = &e;
+            while (is_condition(**p)) p = &std::get<FunctionCall>(**p).args[0];
+            auto blank = blank_of(**p);
+            return blank && blank->kind != BlankKind::Blank;
+        }
+
+        struct PatternNode {
+            enum class Kind : uint8_t { Literal, Blank, Call, Condition };
+
+            Kind kind = Kind::Literal;
+            ExprPtr expr;                   // Literal: the expression; Condition: the test
+            BlankSymbol blank{};            // Blank
+            Atom head;                      // Call
+            std::vector<PatternNode> args;  // Call: the arguments; Condition: the pattern tested
+            bool sequence = false;          // Takes a sequence of arguments (x__, x___)
+            bool variadic = false;          // Call: some argument is a sequence
+            size_t min_rest = 0;            // Least number of arguments this one and those after it take
+        };
+
+        PatternNode compile(const ExprPtr& e) {
+            PatternNode node;
+            if (auto blank = blank_of(*e)) {
+                node.kind = PatternNode::Kind::Blank;
+                node.blank = *blank;
+                node.sequence = blank->kind != BlankKind::Blank;
+                return node;
+            }
+            if (is_condition(*e)) {
+                const auto& f = std::get<FunctionCall>(*e);
+                node.kind = PatternNode::Kind::Condition;
+                node.expr = f.args[1];
+                node.args.push_back(compile(f.args[0]));
+                node.sequence = node.args[0].sequence;
+                node.blank = node.args[0].blank;
+                return node;
+            }
+            if (!is_compound(*e) || !has_pattern(e)) {
+                node.expr = e;
+                return node;
+            }
+            std::vector<ExprPtr> storage;
+            const auto& children = *elements(e, storage);
+            node.kind = PatternNode::Kind::Call;
+            node.head = expr_head(*e);
+            node.args.reserve(children.size());
+            for (const auto& child : children) {
+                node.args.push_back(compile(child));
+                node.variadic |= node.args.back().sequence;
+            }
+            size_t rest = 0;
+            for (auto it = node.args.rbegin(); it != node.args.rend(); ++it) {
+                const bool optional = it->sequence && it->blank.kind == BlankKind::BlankNullSequence;
+                rest += optional ? 0 : 1;
+                it->min_rest = rest;
+            }
+            return node;
+        }
+
+        // Non-owning reference to a callable taking nothing and returning bool. The matcher
+        // passes what is left to match as one of these, so a match can backtrack into the
+        // choices made before it.
+        class Continuation {
+        public:
+            template <typename F>
+                requires (!std::is_same_v<std::decay_t<F>, Continuation>)
+            Continuation(const F& f)
+                : object_(&f), call_([](const void* object) { return (*static_cast<const F*>(object))(); }) {}
+
+            bool operator()() const { return call_(object_); }
+
+        private:
+            const void* object_;
+            bool (*call_)(const void*);
+        };
+
+        class Matcher {
+        public:
+            explicit Matcher(EvaluationContext& ctx) : ctx_(ctx) {}
+
+            PatternBindings bindings;
+
+            bool match(const PatternNode& p, const ExprPtr& e, Continuation k) {
+                switch (p.kind) {
+                case PatternNode::Kind::Literal:
+                    return expr_equal(p.expr, e) && k();
+                case PatternNode::Kind::Blank:
+                    if (!p.blank.head.empty() && expr_head(*e) != p.blank.head) return false;
+                    return bind(p.blank.name, e, k);
+                case PatternNode::Kind::Condition:
+                    return match(p.args[0], e, [&] { return holds(p.expr) && k(); });
+                case PatternNode::Kind::Call: {
+                    if (!is_compound(*e) || expr_head(*e) != p.head) return false;
+                    const size_t n = arity(*e);
+                    if (p.variadic ? n < p.args.front().min_rest : n != p.args.size()) return false;
+                    std::vector<ExprPtr> storage;
+                    return match_args(p.args, 0, *elements(e, storage), 0, k);
+                }
+                }
+                return false;
+            }
+
+            // Test of a condition, with the bindings so far
+            bool holds(const ExprPtr& test) {
+                auto value = evaluate(substitute(test, bindings), ctx_);
+                auto boolean = std::get_if<Boolean>(value.get());
+                return boolean && boolean->value;
+            }
+
+        private:
+            EvaluationContext& ctx_;
+
+            bool bind(Atom name, const ExprPtr& value, Continuation k) {
+                if (name.empty()) return k();
+                for (const auto& [bound, existing] : bindings) {
+                    if (bound == name) return expr_equal(existing, value) && k();
+                }
+                bindings.emplace_back(name, value);
+                if (k()) return true;
+                bindings.pop_back();
+                return false;
+            }
+
+            bool match_args(const std::vector<PatternNode>& ps, size_t i, const std::vector<ExprPtr>& es, size_t j, Continuation k) {
+                if (i == ps.size()) return j == es.size() && k();
+                const PatternNode& p = ps[i];
+                if (!p.sequence) {
+                    if (j == es.size()) return false;
+                    return match(p, es[j], [&] { return match_args(ps, i + 1, es, j + 1, k); });
+                }
+                // Shortest sequence first, leaving enough arguments for the patterns after it
+                const size_t after = i + 1 < ps.size() ? ps[i + 1].min_rest : 0;
+                if (es.size() < j + after) return false;
+                const size_t longest = es.size() - j - after;
+                const size_t shortest = p.blank.kind == BlankKind::BlankNullSequence ? 0 : 1;
+                for (size_t length = shortest; length <= longest; ++length) {
+                    const size_t next = j + length;
+                    if (match_sequence(p, es, j, length, [&] { return match_args(ps, i + 1, es, next, k); })) return true;
+                }
+                return false;
+            }
+
+            bool match_sequence(const PatternNode& p, const std::vector<ExprPtr>& es, size_t j, size_t length, Continuation k) {
+                if (p.kind == PatternNode::Kind::Condition) {
+                    return match_sequence(p.args[0], es, j, length, [&] { return holds(p.expr) && k(); });
+                }
+                if (!p.blank.head.empty()) {
+                    for (size_t m = j; m < j + length; ++m) {
+                        if (expr_head(*es[m]) != p.blank.head) return false;
+                    }
+                }
+                if (p.blank.name.empty()) return k();
+                auto begin = es.begin() + static_cast<std::ptrdiff_t>(j);
+                return bind(p.blank.name, make_fcall(atoms::Sequence, std::vector<ExprPtr>(begin, begin + static_cast<std::ptrdiff_t>(length))), k);
+            }
+        };
+
+        // --- Discrimination net ---
+
+        // An atom, a call of fixed arity (followed by its arguments), a call with sequence
+        // arguments or a blank restricted to a head (both of which end the path there)
+        enum class KeyKind : uint8_t { Atom, Call, Variadic, Head };
+
+        struct NetKey {
+            KeyKind kind;
+            uint32_t head = 0;   // Call, Variadic, Head
+            uint64_t value = 0;  // Call: the arity; Atom: the hash
+
+            bool operator==(const NetKey&) const = default;
+        };
+
+        struct NetKeyHash {
+            size_t operator()(const NetKey& key) const {
+                uint64_t h = key.value * 0x9e3779b97f4a7c15ULL;
+                h ^= (static_cast<uint64_t>(key.head) << 8 | static_cast<uint64_t>(key.kind)) + 0x632be59bd9b4e019ULL + (h << 6) + (h >> 2);
+                return static_cast<size_t>(h);
+            }
+        };
+
+        constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+        struct NetNode {
+            std::unordered_map<NetKey, uint32_t, NetKeyHash> edges;
+            uint32_t wildcard = NO_NODE;
+            std::vector<uint32_t> rules;  // Rules whose left side ends here
+        };
+
+        NetKey atom_key(const ExprPtr& e) { return { KeyKind::Atom, 0, expr_hash(e) }; }
+    }
+
+    std::optional<BlankSymbol> parse_blank(std::string_view symbol) {
+        const size_t first = symbol.find('_');
+        if (first == std::string_view::npos) return std::nullopt;
+        size_t end = first;
+        while (end < symbol.size() && symbol[end] == '_') ++end;
+        const size_t blanks = end - first;
+        const std::string_view name = symbol.substr(0, first);
+        const std::string_view head = symbol.substr(end);
+        if (blanks > 3 || head.find('_') != std::string_view::npos) return std::nullopt;
+        if (!head.empty() && !is_letter(head.front())) return std::nullopt;
+        const BlankKind kind = blanks == 1 ? BlankKind::Blank : blanks == 2 ? BlankKind::BlankSequence : BlankKind::BlankNullSequence;
+        return BlankSymbol{ name.empty() ? Atom() : Atom(name), kind, head.empty() ? Atom() : Atom(head) };
+    }
+
+    Atom expr_head(const Expr& expr) {
+        return std::visit(overloaded{
+            [](const Number& n) { return std::isfinite(n.value) && std::floor(n.value) == n.value ? INTEGER : REAL; },
+            [](const Complex&) { return atoms::Complex; },
+            [](const Rational&) { return atoms::Rational; },
+            [](const String&) { return STRING; },
+            [](const FunctionCall& f) { return f.head; },
+            [](const List&) { return atoms::List; },
+            [](const PackedArray&) { return atoms::List; },
+            [](const LazyList&) { return atoms::List; },
+            [](const Rule&) { return atoms::Rule; },
+            [](const auto&) { return SYMBOL; },
+        }, expr);
+    }
+
+    ExprPtr substitute(const ExprPtr& expr, const PatternBindings& bindings) {
+        if (bindings.empty()) return expr;
+        if (auto sym = std::get_if<Symbol>(expr.get())) {
+            for (const auto& [name, value] : bindings) {
+                if (name == sym->name) return value;
+            }
+            return expr;
+        }
+        // Arguments with sequences spliced in; nullopt if none changed
+        auto substitute_args = [&](const std::vector<ExprPtr>& args) -> std::optional<std::vector<ExprPtr>> {
+            std::vector<ExprPtr> out;
+            bool changed = false;
+            out.reserve(args.size());
+            for (const auto& arg : args) {
+                ExprPtr value = substitute(arg, bindings);
+                changed |= value != arg;
+                if (auto f = std::get_if<FunctionCall>(value.get()); f && f->head == atoms::Sequence && value != arg) {
+                    out.insert(out.end(), f->args.begin(), f->args.end());
+                }
+                else {
+                    out.push_back(std::move(value));
+                }
+            }
+            if (!changed) return std::nullopt;
+            return out;
+        };
+        if (auto f = std::get_if<FunctionCall>(expr.get())) {
+            auto args = substitute_args(f->args);
+            return args ? make_fcall(f->head, *args) : expr;
+        }
+        if (auto l = std::get_if<List>(expr.get())) {
+            auto elements = substitute_args(l->elements);
+            return elements ? make_expr<List>(std::move(*elements)) : expr;
+        }
+        if (auto r = std::get_if<Rule>(expr.get())) {
+            auto lhs = substitute(r->lhs, bindings);
+            auto rhs = substitute(r->rhs, bindings);
+            return lhs == r->lhs && rhs == r->rhs ? expr : make_expr<Rule>(lhs, rhs);
+        }
+        return expr;
+    }
+
+    std::optional<PatternBindings> match_pattern(const ExprPtr& pattern, const ExprPtr& expr, EvaluationContext& ctx) {
+        const PatternNode node = compile(pattern);
+        Matcher matcher(ctx);
+        if (!matcher.match(node, expr, [] { return true; })) return std::nullopt;
+        return std::move(matcher.bindings);
+    }
+
+    struct RuleSet::Compiled {
+        struct CompiledRule {
+            PatternNode lhs;
+            ExprPtr rhs;
+            ExprPtr condition;  // lhs -> rhs /; condition, or nullptr
+        };
+
+        std::vector<CompiledRule> rules;
+        std::vector<NetNode> nodes{ 1 };  // nodes[0] is the root
+
+        // Adds the preorder keys of `e` to the path from `node`; returns where it ends
+        uint32_t insert(uint32_t node, const ExprPtr& e) {
+            auto child = [&](NetKey key) {
+                auto [it, added] = nodes[node].edges.try_emplace(key, static_cast<uint32_t>(nodes.size()));
+                if (added) nodes.emplace_back();
+                return it->second;
+            };
+            if (auto blank = blank_of(*e)) {
+                if (!blank->head.empty()) return child({ KeyKind::Head, blank->head.id(), 0 });
+                if (nodes[node].wildcard == NO_NODE) {
+                    nodes[node].wildcard = static_cast<uint32_t>(nodes.size());
+                    nodes.emplace_back();
+                }
+                return nodes[node].wildcard;
+            }
+            if (is_condition(*e)) return insert(node, std::get<FunctionCall>(*e).args[0]);
+            if (!is_compound(*e)) return child(atom_key(e));
+
+            std::vector<ExprPtr> storage;
+            const auto& children = *elements(e, storage);
+            const uint32_t head = expr_head(*e).id();
+            if (std::any_of(children.begin(), children.end(), is_sequence)) {
+                return child({ KeyKind::Variadic, head, 0 });
+            }
+            node = child({ KeyKind::Call, head, children.size() });
+            for (const auto& c : children) node = insert(node, c);
+            return node;
+        }
+
+        // Rules at the ends of the paths that `pending` (subterms still to read, the next
+        // one last) leads to from `node`
+        void collect(uint32_t node, std::vector<ExprPtr>& pending, std::vector<uint32_t>& out) const {
+            const NetNode& net = nodes[node];
+            if (pending.empty()) {
+                out.insert(out.end(), net.rules.begin(), net.rules.end());
+                return;
+            }
+            ExprPtr term = std::move(pending.back());
+            pending.pop_back();
+            if (net.wildcard != NO_NODE) collect(net.wildcard, pending, out);
+            if (!net.edges.empty()) {
+                if (auto it = net.edges.find({ KeyKind::Head, expr_head(*term).id(), 0 }); it != net.edges.end()) {
+                    collect(it->second, pending, out);
+                }
+                if (!is_compound(*term)) {
+                    if (auto it = net.edges.find(atom_key(term)); it != net.edges.end()) collect(it->second, pending, out);
+                }
+                else {
+                    const uint32_t head = expr_head(*term).id();
+                    if (auto it = net.edges.find({ KeyKind::Variadic, head, 0 }); it != net.edges.end()) {
+                        collect(it->second, pending, out);
+                    }
+                    if (auto it = net.edges.find({ KeyKind::Call, head, arity(*term) }); it != net.edges.end()) {
+                        std::vector<ExprPtr> storage;
+                        const auto& children = *elements(term, storage);
+                        const size_t base = pending.size();
+                        pending.insert(pending.end(), children.rbegin(), children.rend());
+                        collect(it->second, pending, out);
+                        pending.resize(base);
+                    }
+                }
+            }
+            pending.push_back(std::move(term));
+        }
+    };
+
+    RuleSet::RuleSet(const ExprPtr& rules) : compiled_(std::make_unique<Compiled>()) {
+        std::vector<ExprPtr> storage;
+        const std::vector<ExprPtr>* list = nullptr;
+        if (std::holds_alternative<Rule>(*rules)) {
+            storage = { rules };
+            list = &storage;
+        }
+        else if (auto l = std::get_if<List>(rules.get())) {
+            list = &l->elements;
+        }
+        else if (auto f = std::get_if<FunctionCall>(rules.get()); f && f->head == atoms::List) {
+            list = &f->args;
+        }
+        if (!list) throw std::runtime_error("ReplaceAll expects a rule or a list of rules");
+
+        compiled_->rules.reserve(list->size());
+        for (const auto& item : *list) {
+            auto rule = std::get_if<Rule>(item.get());
+            if (!rule) throw std::runtime_error("ReplaceAll expects a rule or a list of rules");
+            ExprPtr rhs = rule->rhs, condition;
+            if (is_condition(*rhs)) {
+                condition = std::get<FunctionCall>(*rhs).args[1];
+                rhs = std::get<FunctionCall>(*rhs).args[0];
+            }
+            const uint32_t end = compiled_->insert(0, rule->lhs);
+            compiled_->nodes[end].rules.push_back(static_cast<uint32_t>(compiled_->rules.size()));
+            compiled_->rules.push_back({ compile(rule->lhs), rhs, condition });
+        }
+    }
+
+    RuleSet::~RuleSet() = default;
+
+    size_t RuleSet::size() const { return compiled_->rules.size(); }
+
+    std::vector<uint32_t> RuleSet::candidates(const ExprPtr& expr) const {
+        std::vector<ExprPtr> pending{ expr };
+        std::vector<uint32_t> out;
+        compiled_->collect(0, pending, out);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return out;
+    }
+
+    ExprPtr RuleSet::apply(const ExprPtr& expr, EvaluationContext& ctx) const {
+        for (uint32_t index : candidates(expr)) {
+            const auto& rule = compiled_->rules[index];
+            Matcher matcher(ctx);
+            ExprPtr result;
+            const bool matched = matcher.match(rule.lhs, expr, [&] {
+                if (rule.condition && !matcher.holds(rule.condition)) return false;
+                result = substitute(rule.rhs, matcher.bindings);
+                return true;
+            });
+            if (matched) return result;
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const RuleSet> compile_rules(const ExprPtr& rules) {
+        // Rules held in a variable are the same node on every use
+        struct Entry {
+            std::weak_ptr<Expr> rules;
+            std::shared_ptr<const RuleSet> compiled;
+        };
+        static constexpr size_t CACHE_SIZE = 64;
+        static std::mutex mutex;
+        static std::unordered_map<const Expr*, Entry> cache;
+        {
+            std::lock_guard lock(mutex);
+            if (auto it = cache.find(rules.get()); it != cache.end() && it->second.rules.lock() == rules) {
+                return it->second.compiled;
+            }
+        }
+        auto compiled = std::make_shared<const RuleSet>(rules);
+        std::lock_guard lock(mutex);
+        if (cache.size() >= CACHE_SIZE) cache.clear();
+        cache[rules.get()] = { rules, compiled };
+        return compiled;
+    }
+
+    ExprPtr replace_all(const ExprPtr& expr, const RuleSet& rules, EvaluationContext& ctx, bool* changed) {
+        struct Frame {
+            ExprPtr node;
+            std::vector<ExprPtr> storage;
+            const std::vector<ExprPtr>* children;
+            size_t next = 0;
+            std::vector<ExprPtr> replaced;
+            bool changed = false;
+        };
+        bool any = false;
+        // The replacement of `e` by a rule, or nullptr
+        auto rewrite = [&](const ExprPtr& e) {
+            ExprPtr value = rules.apply(e, ctx);
+            any |= value != nullptr;
+            return value;
+        };
+
+        ExprPtr result = rewrite(expr);
+        if (!result && !is_compound(*expr)) result = expr;
+        std::deque<Frame> stack;  // Frames stay in place, since `children` may point into one
+        auto push = [&](const ExprPtr& node) {
+            Frame& frame = stack.emplace_back();
+            frame.node = node;
+            frame.children = elements(node, frame.storage);
+            frame.replaced.reserve(frame.children->size());
+        };
+        if (!result) push(expr);
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.next < top.children->size()) {
+                const ExprPtr& child = (*top.children)[top.next++];
+                if (ExprPtr value = rewrite(child)) {
+                    top.changed = true;
+                    top.replaced.push_back(std::move(value));
+                }
+                else if (is_compound(*child)) {
+                    push(child);
+                }
+                else {
+                    top.replaced.push_back(child);
+                }
+                continue;
+            }
+
+            ExprPtr node = std::move(top.node);
+            if (top.changed) {
+                if (auto f = std::get_if<FunctionCall>(node.get())) node = make_fcall(f->head, std::move(top.replaced));
+                else if (std::holds_alternative<Rule>(*node)) node = make_expr<Rule>(top.replaced[0], top.replaced[1]);
+                else node = make_expr<List>(std::move(top.replaced));
+            }
+            stack.pop_back();
+            if (stack.empty()) {
+                result = std::move(node);
+                break;
+            }
+            Frame& parent = stack.back();
+            parent.changed |= node != (*parent.children)[parent.next - 1];
+            parent.replaced.push_back(std::move(node));
+        }
+        if (changed) *changed = any;
+        return result;
+    }
+
+    ExprPtr replace_repeated(const ExprPtr& expr, const RuleSet& rules, EvaluationContext& ctx) {
+        ExprPtr current = expr;
+        for (size_t i = 0; i < MAX_REPLACE_ITERATIONS; ++i) {
+            bool changed = false;
+            ExprPtr next = replace_all(current, rules, ctx, &changed);
+            if (!changed) return current;
+            next = evaluate(next, ctx);
+            if (expr_equal(next, current)) return next;
+            current = std::move(next);
+        }
+        throw std::runtime_error("ReplaceRepeated did not reach a fixed point in " +
+                                 std::to_string(MAX_REPLACE_ITERATIONS) + " iterations");
+    }
+
+} // namespace aleph3
@@ -0,0 +1,242 @@
+#include "evaluator/Profiler.hpp"
+#include "expr/ExprPool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        struct HeadCounters {
+            uint64_t calls = 0;
+            std::chrono::nanoseconds self{ 0 };
+            std::chrono::nanoseconds total{ 0 };
+            uint32_t active = 0;  // Open calls of this head on the thread
+        };
+
+        struct TraceEvent {
+            Atom head;
+            std::chrono::nanoseconds start;  // Since the profiler started
+            std::chrono::nanoseconds duration;
+        };
+
+        // What one thread gathered. Only its own thread writes it, under `mutex`, so readers
+        // on other threads see consistent counters.
+        struct ThreadProfile {
+            struct Frame {
+                Atom head;
+                Clock::time_point start;
+                std::chrono::nanoseconds children{ 0 };
+            };
+
+            std::mutex mutex;
+            uint32_t id = 0;
+            uint64_t generation = 0;
+            std::unordered_map<uint32_t, HeadCounters> heads;  // By atom id
+            std::vector<TraceEvent> events;
+            size_t dropped = 0;
+            std::vector<Frame> stack;  // Open calls, only touched by the owner
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadProfile>> threads;
+        };
+
+        // When the profiler last started, the zero of trace timestamps
+        std::atomic<Clock::rep> origin{ 0 };
+
+        // Intentionally leaked, like the expression pool: scopes may close during shutdown
+        Registry& registry() {
+            static Registry* r = new Registry();
+            return *r;
+        }
+
+        ThreadProfile& thread_profile() {
+            thread_local std::shared_ptr<ThreadProfile> profile = [] {
+                auto p = std::make_shared<ThreadProfile>();
+                auto& r = registry();
+                std::lock_guard lock(r.mutex);
+                p->id = static_cast<uint32_t>(r.threads.size()) + 1;
+                r.threads.push_back(p);
+                return p;
+            }();
+            return *profile;
+        }
+
+        // Drops counters from before the latest start(), keeping the open calls
+        void renew(ThreadProfile& p, uint64_t generation) {
+            if (p.generation == generation) return;
+            for (auto it = p.heads.begin(); it != p.heads.end();) {
+                if (it->second.active == 0) {
+                    it = p.heads.erase(it);
+                    continue;
+                }
+                it->second = HeadCounters{ 0, {}, {}, it->second.active };
+                ++it;
+            }
+            p.events.clear();
+            p.dropped = 0;
+            p.generation = generation;
+        }
+
+        std::vector<std::shared_ptr<ThreadProfile>> threads() {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            return r.threads;
+        }
+
+        void write_json_string(std::ostream& out, const std::string& s) {
+            out << '"';
+            for (char c : s) {
+                if (c == '"' || c == '\\') out << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escape[8];
+                    std::snprintf(escape, sizeof escape, "\\u%04x", c);
+                    out << escape;
+                }
+                else out << c;
+            }
+            out << '"';
+        }
+
+        double milliseconds(std::chrono::nanoseconds t) {
+            return std::chrono::duration<double, std::milli>(t).count();
+        }
+    }
+
+    Profiler& Profiler::instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void Profiler::start(bool trace) {
+        origin.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_relaxed);
+        tracing_.store(trace, std::memory_order_relaxed);
+        detail::profiling.store(true, std::memory_order_relaxed);
+    }
+
+    void Profiler::stop() {
+        detail::profiling.store(false, std::memory_order_relaxed);
+    }
+
+    void Profiler::enter(Atom head) {
+        auto& p = thread_profile();
+        std::lock_guard lock(p.mutex);
+        renew(p, generation_.load(std::memory_order_relaxed));
+        ++p.heads[head.id()].active;
+        p.stack.push_back({ head, Clock::now() });
+    }
+
+    void Profiler::leave() {
+        const auto now = Clock::now();
+        auto& p = thread_profile();
+        std::lock_guard lock(p.mutex);
+        renew(p, generation_.load(std::memory_order_relaxed));
+        const auto frame = p.stack.back();
+        p.stack.pop_back();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start);
+        auto& counters = p.heads[frame.head.id()];
+        ++counters.calls;
+        counters.self += elapsed - frame.children;
+        if (--counters.active == 0) counters.total += elapsed;
+        if (!p.stack.empty()) p.stack.back().children += elapsed;
+        if (tracing()) {
+            if (p.events.size() < TRACE_EVENT_LIMIT) {
+                const Clock::time_point zero{ Clock::duration(origin.load(std::memory_order_relaxed)) };
+                p.events.push_back({ frame.head, std::chrono::duration_cast<std::chrono::nanoseconds>(frame.start - zero), elapsed });
+            }
+            else {
+                ++p.dropped;
+            }
+        }
+    }
+
+    ProfileReport Profiler::report() const {
+        const uint64_t generation = generation_.load(std::memory_order_relaxed);
+        std::unordered_map<uint32_t, HeadProfile> merged;
+        ProfileReport report;
+        for (const auto& p : threads()) {
+            std::lock_guard lock(p->mutex);
+            if (p->generation != generation) continue;
+            for (const auto& [id, counters] : p->heads) {
+                if (counters.calls == 0) continue;
+                auto& head = merged.try_emplace(id, HeadProfile{ Atom::from_id(id) }).first->second;
+                head.calls += counters.calls;
+                head.self += counters.self;
+                head.total += counters.total;
+            }
+            report.trace_events += p->events.size();
+            report.dropped_events += p->dropped;
+        }
+        for (auto& [id, head] : merged) report.heads.push_back(head);
+        std::sort(report.heads.begin(), report.heads.end(), [](const HeadProfile& a, const HeadProfile& b) {
+            if (a.self != b.self) return a.self > b.self;
+            return a.head.str() < b.head.str();
+        });
+        return report;
+    }
+
+    void Profiler::write_flat_profile(std::ostream& out) const {
+        const auto profile = report();
+        uint64_t calls = 0;
+        std::chrono::nanoseconds self{ 0 };
+        for (const auto& head : profile.heads) {
+            calls += head.calls;
+            self += head.self;
+        }
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+        out << "Flat profile: " << calls << " calls, " << milliseconds(self) << " ms\n";
+        out << std::setw(8) << "self %" << std::setw(14) << "self ms" << std::setw(14) << "total ms" << std::setw(12) << "calls" << "  head\n";
+        for (const auto& head : profile.heads) {
+            const double share = self.count() == 0 ? 0.0 : 100.0 * double(head.self.count()) / double(self.count());
+            out << std::setw(7) << std::setprecision(2) << share << '%' << std::setprecision(3)
+                << std::setw(14) << milliseconds(head.self) << std::setw(14) << milliseconds(head.total)
+                << std::setw(12) << head.calls << "  " << head.head << '\n';
+        }
+        if (tracing() || profile.trace_events > 0) {
+            out << "Trace: " << profile.trace_events << " events";
+            if (profile.dropped_events > 0) out << ", " << profile.dropped_events << " dropped";
+            out << '\n';
+        }
+        const auto pool = expr_pool_stats();
+        out << "Expression pool: " << pool.allocations << " allocations, " << pool.bytes_in_use << " bytes in use, "
+            << pool.peak_bytes_in_use << " peak, " << pool.bytes_reserved << " reserved\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    void Profiler::write_trace(std::ostream& out) const {
+        const uint64_t generation = generation_.load(std::memory_order_relaxed);
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& p : threads()) {
+            std::lock_guard lock(p->mutex);
+            if (p->generation != generation) continue;
+            for (const auto& event : p->events) {
+                out << (first ? "\n" : ",\n") << "{\"name\":";
+                write_json_string(out, event.head.str());
+                // Microseconds, as the format expects
+                out << ",\"cat\":\"evaluate\",\"ph\":\"X\",\"ts\":" << double(event.start.count()) / 1000.0
+                    << ",\"dur\":" << double(event.duration.count()) / 1000.0 << ",\"pid\":1,\"tid\":" << p->id << '}';
+                first = false;
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+} // namespace aleph3
@@ -0,0 +1,68 @@
+#include "evaluator/ResultCache.hpp"
+
+namespace aleph3 {
+
+    ResultCache& ResultCache::instance() {
+        static ResultCache cache;
+        return cache;
+    }
+
+    void ResultCache::set_capacity(size_t capacity) {
+        std::lock_guard lock(mutex);
+        capacity_.store(capacity, std::memory_order_relaxed);
+        evict_to(capacity);
+    }
+
+    ExprPtr ResultCache::lookup(const ExprPtr& call, uint64_t token, uint64_t epoch) {
+        std::lock_guard lock(mutex);
+        auto it = index.find(call);
+        if (it == index.end()) {
+            ++misses;
+            return nullptr;
+        }
+        auto entry = it->second;
+        if (entry->token != token || entry->epoch != epoch) {
+            // Computed in another state; it may no longer be valid
+            index.erase(it);
+            order.erase(entry);
+            ++misses;
+            return nullptr;
+        }
+        order.splice(order.begin(), order, entry);
+        ++hits;
+        return entry->result;
+    }
+
+    void ResultCache::store(const ExprPtr& call, const ExprPtr& result, uint64_t token, uint64_t epoch) {
+        std::lock_guard lock(mutex);
+        const size_t capacity = capacity_.load(std::memory_order_relaxed);
+        if (capacity == 0) return;
+        if (auto it = index.find(call); it != index.end()) {
+            order.erase(it->second);
+            index.erase(it);
+        }
+        order.push_front({ call, result, token, epoch });
+        index.emplace(call, order.begin());
+        evict_to(capacity);
+    }
+
+    void ResultCache::clear() {
+        std::lock_guard lock(mutex);
+        evict_to(0);
+        hits = 0;
+        misses = 0;
+    }
+
+    ResultCache::Stats ResultCache::stats() {
+        std::lock_guard lock(mutex);
+        return { hits, misses, order.size(), capacity_.load(std::memory_order_relaxed) };
+    }
+
+    void ResultCache::evict_to(size_t size) {
+        while (order.size() > size) {
+            index.erase(order.back().call);
+            order.pop_back();
+        }
+    }
+
+} // namespace aleph3
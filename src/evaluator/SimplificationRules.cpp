@@ -1,204 +1,327 @@
 #include "evaluator/SimplificationRules.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "evaluator/Threading.hpp"
 #include "expr/ExprUtils.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprOrder.hpp"
+#include "expr/PackedArray.hpp"
+#include <algorithm>
 #include <cmath>
+#include <optional>
 
 namespace aleph3 {
 
-    const std::unordered_map<std::string, SimplifyRule> simplification_rules = {
-    {"Plus", [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
-            const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
-        std::vector<ExprPtr> eval_args;
-        for (const auto& arg : args) {
-            eval_args.push_back(eval(arg, ctx));
+    namespace {
+
+        bool is_exact_number(const Expr& e) {
+            return std::holds_alternative<Number>(e) || std::holds_alternative<Rational>(e);
         }
 
-        // Rational + Rational
-        if (eval_args.size() == 2 &&
-            std::holds_alternative<Rational>(*eval_args[0]) &&
-            std::holds_alternative<Rational>(*eval_args[1])) {
-            const auto& a = std::get<Rational>(*eval_args[0]);
-            const auto& b = std::get<Rational>(*eval_args[1]);
-            int64_t n = a.numerator * b.denominator + b.numerator * a.denominator;
-            int64_t d = a.denominator * b.denominator;
-            auto [nn, dd] = normalize_rational(n, d);
-            if (dd == 0) {
-                if (nn == 0) return make_expr<Indeterminate>();
-                return make_expr<Infinity>();
-            }
-            return make_expr<Rational>(nn, dd);
+        bool is_zero_number(const Expr& e) {
+            if (auto n = std::get_if<Number>(&e)) return n->value == 0.0;
+            if (auto r = std::get_if<Rational>(&e)) return r->numerator.is_zero();
+            return false;
         }
-        // Rational + Number or Number + Rational
-        if (eval_args.size() == 2) {
-            ExprPtr rat = nullptr, num = nullptr;
-            if (std::holds_alternative<Rational>(*eval_args[0]) && std::holds_alternative<Number>(*eval_args[1])) {
-                rat = eval_args[0]; num = eval_args[1];
-            } else if (std::holds_alternative<Number>(*eval_args[0]) && std::holds_alternative<Rational>(*eval_args[1])) {
-                num = eval_args[0]; rat = eval_args[1];
-            }
-            if (rat && num) {
-                const auto& r = std::get<Rational>(*rat);
-                double n = std::get<Number>(*num).value;
-                if (std::floor(n) == n) {
-                    auto [nn, dd] = normalize_rational(r.numerator + static_cast<int64_t>(n) * r.denominator, r.denominator);
-                    return make_expr<Rational>(nn, dd);
-                } else {
-                    double val = static_cast<double>(r.numerator) / r.denominator + n;
-                    return make_expr<Number>(val);
+
+        bool is_integer(double v) {
+            return std::floor(v) == v && std::abs(v) < 9.0e15;
+        }
+
+        // Sum of numeric arguments. Rationals stay exact unless a non-integer Number joins
+        // them, as in the binary rules.
+        struct NumericSum {
+            double real = 0;
+            double imag = 0;
+            BigInt num = 0;
+            BigInt den = 1;
+            bool rational = false;
+            bool inexact = false;
+            bool complex = false;
+
+            bool add(const Expr& e) {
+                if (auto n = std::get_if<Number>(&e)) {
+                    real += n->value;
+                    inexact |= !is_integer(n->value);
+                    return true;
                 }
+                if (auto r = std::get_if<Rational>(&e)) {
+                    std::tie(num, den) = normalize_rational(num * r->denominator + r->numerator * den, den * r->denominator);
+                    rational = true;
+                    return true;
+                }
+                if (auto c = std::get_if<Complex>(&e)) {
+                    real += c->real;
+                    imag += c->imag;
+                    complex = true;
+                    return true;
+                }
+                return false;
             }
-        }
 
-        // Elementwise list support for two lists
-        if (eval_args.size() == 2 &&
-            std::holds_alternative<List>(*eval_args[0]) &&
-            std::holds_alternative<List>(*eval_args[1])) {
-            const auto& l1 = std::get<List>(*eval_args[0]).elements;
-            const auto& l2 = std::get<List>(*eval_args[1]).elements;
-            if (l1.size() != l2.size())
-                throw std::runtime_error("List sizes must match for elementwise Plus");
-            std::vector<ExprPtr> result;
-            for (size_t i = 0; i < l1.size(); ++i) {
-                result.push_back(eval(make_fcall("Plus", { l1[i], l2[i] }), ctx));
+            bool is_zero() const { return real == 0 && num == 0 && imag == 0; }
+            bool is_one() const { return !complex && !rational && real == 1; }
+
+            ExprPtr value() const {
+                const double rat = BigInt::ratio(num, den);
+                if (complex && imag != 0) return make_expr<Complex>(real + rat, imag);
+                if (complex) return make_expr<Number>(real + rat);
+                if (rational && !inexact) {
+                    auto [n, d] = normalize_rational(num + BigInt::from_double(real) * den, den);
+                    return make_expr<Rational>(n, d);
+                }
+                if (rational) return make_expr<Number>(real + rat);
+                return make_expr<Number>(real);
             }
-            return std::make_shared<Expr>(List{ result });
-        }
+        };
 
-        // Scalar and list broadcasting (optional)
-        if (eval_args.size() == 2) {
-            if (std::holds_alternative<List>(*eval_args[0]) && std::holds_alternative<Number>(*eval_args[1])) {
-                const auto& l1 = std::get<List>(*eval_args[0]).elements;
-                std::vector<ExprPtr> result;
-                for (const auto& elem : l1) {
-                    result.push_back(eval(make_fcall("Plus", { elem, eval_args[1] }), ctx));
+        // Product of numeric arguments, with the same exactness rules as NumericSum
+        struct NumericProduct {
+            double real = 1;
+            double c_real = 1;
+            double c_imag = 0;
+            BigInt num = 1;
+            BigInt den = 1;
+            bool rational = false;
+            bool inexact = false;
+            bool complex = false;
+
+            bool multiply(const Expr& e) {
+                if (auto n = std::get_if<Number>(&e)) {
+                    real *= n->value;
+                    inexact |= !is_integer(n->value);
+                    return true;
                 }
-                return std::make_shared<Expr>(List{ result });
+                if (auto r = std::get_if<Rational>(&e)) {
+                    std::tie(num, den) = normalize_rational(num * r->numerator, den * r->denominator);
+                    rational = true;
+                    return true;
+                }
+                if (auto c = std::get_if<Complex>(&e)) {
+                    double re = c_real * c->real - c_imag * c->imag;
+                    double im = c_real * c->imag + c_imag * c->real;
+                    c_real = re;
+                    c_imag = im;
+                    complex = true;
+                    return true;
+                }
+                return false;
             }
-            if (std::holds_alternative<Number>(*eval_args[0]) && std::holds_alternative<List>(*eval_args[1])) {
-                const auto& l2 = std::get<List>(*eval_args[1]).elements;
-                std::vector<ExprPtr> result;
-                for (const auto& elem : l2) {
-                    result.push_back(eval(make_fcall("Plus", { eval_args[0], elem }), ctx));
+
+            bool is_one() const { return !complex && !rational && real == 1; }
+
+            ExprPtr value() const {
+                const double scale = real * BigInt::ratio(num, den);
+                if (complex && scale * c_imag != 0) return make_expr<Complex>(scale * c_real, scale * c_imag);
+                if (complex) return make_expr<Number>(scale * c_real);
+                if (rational && !inexact) {
+                    auto [n, d] = normalize_rational(num * BigInt::from_double(real), den);
+                    return make_expr<Rational>(n, d);
                 }
-                return std::make_shared<Expr>(List{ result });
+                if (rational) return make_expr<Number>(scale);
+                return make_expr<Number>(real);
+            }
+        };
+
+        // A term of a sum split into its exact numeric coefficient and the rest
+        struct Term {
+            ExprPtr original;
+            const ExprPtr* coefficient; // nullptr for 1
+            ExprPtr rest;
+        };
+
+        Term split_term(const ExprPtr& e) {
+            if (auto f = std::get_if<FunctionCall>(e.get());
+                f && f->head == atoms::Times && f->args.size() >= 2 && is_exact_number(*f->args[0])) {
+                if (f->args.size() == 2) return { e, &f->args[0], f->args[1] };
+                return { e, &f->args[0], make_fcall(atoms::Times, std::vector<ExprPtr>(f->args.begin() + 1, f->args.end())) };
             }
+            return { e, nullptr, e };
         }
 
-        // Original Plus rule for scalars and mixed
-        double result = 0;
-        std::vector<ExprPtr> simplified;
-        for (const auto& e : eval_args) {
-            if (std::holds_alternative<Number>(*e)) {
-                double val = get_number_value(e);
-                if (val == 0) continue;
-                result += val;
+        // coefficient * rest, flattening a product rest
+        ExprPtr scale_term(const ExprPtr& coefficient, const ExprPtr& rest) {
+            std::vector<ExprPtr> factors{ coefficient };
+            if (auto f = std::get_if<FunctionCall>(rest.get()); f && f->head == atoms::Times) {
+                factors.insert(factors.end(), f->args.begin(), f->args.end());
             }
             else {
-                simplified.push_back(e);
+                factors.push_back(rest);
             }
-        }
-        if (result != 0) simplified.insert(simplified.begin(), make_expr<Number>(result));
-        if (simplified.empty()) return make_expr<Number>(0);
-        if (simplified.size() == 1) return simplified[0];
-        return make_fcall("Plus", simplified);
-    }},
-    {"Times", [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
-             const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
-        std::vector<ExprPtr> eval_args;
-        for (const auto& arg : args) {
-            eval_args.push_back(eval(arg, ctx));
+            return make_fcall(atoms::Times, factors);
         }
 
-        // Rational * Rational
-        if (eval_args.size() == 2 &&
-            std::holds_alternative<Rational>(*eval_args[0]) &&
-            std::holds_alternative<Rational>(*eval_args[1])) {
-            const auto& a = std::get<Rational>(*eval_args[0]);
-            const auto& b = std::get<Rational>(*eval_args[1]);
-            auto [nn, dd] = normalize_rational(a.numerator * b.numerator, a.denominator * b.denominator);
-            if (dd == 0) {
-                if (nn == 0) return make_expr<Indeterminate>();
-                return make_expr<Infinity>();
+        // Flat, Orderless Plus in one pass: numbers are summed, like terms (equal up to an
+        // exact coefficient) are combined, and what remains is sorted canonically
+        ExprPtr combine_plus(const std::vector<ExprPtr>& args) {
+            NumericSum constant;
+            std::vector<Term> terms;
+            terms.reserve(args.size());
+            for (const auto& arg : args) {
+                if (!constant.add(*arg)) terms.push_back(split_term(arg));
             }
-            return make_expr<Rational>(nn, dd);
-        }
-        // Rational * Number or Number * Rational
-        if (eval_args.size() == 2) {
-            ExprPtr rat = nullptr, num = nullptr;
-            if (std::holds_alternative<Rational>(*eval_args[0]) && std::holds_alternative<Number>(*eval_args[1])) {
-                rat = eval_args[0]; num = eval_args[1];
-            } else if (std::holds_alternative<Number>(*eval_args[0]) && std::holds_alternative<Rational>(*eval_args[1])) {
-                num = eval_args[0]; rat = eval_args[1];
-            }
-            if (rat && num) {
-                const auto& r = std::get<Rational>(*rat);
-                double n = std::get<Number>(*num).value;
-                if (std::floor(n) == n) {
-                    auto [nn, dd] = normalize_rational(r.numerator * static_cast<int64_t>(n), r.denominator);
-                    return make_expr<Rational>(nn, dd);
-                } else {
-                    double val = static_cast<double>(r.numerator) / r.denominator * n;
-                    return make_expr<Number>(val);
+            std::stable_sort(terms.begin(), terms.end(), [](const Term& a, const Term& b) {
+                return canonical_compare(a.rest, b.rest) < 0;
+            });
+
+            std::vector<ExprPtr> result;
+            result.reserve(terms.size() + 1);
+            for (size_t i = 0; i < terms.size();) {
+                size_t j = i + 1;
+                while (j < terms.size() && expr_equal(terms[j].rest, terms[i].rest)) ++j;
+                if (j == i + 1) {
+                    result.push_back(terms[i].original);
                 }
+                else {
+                    NumericSum coefficient;
+                    for (size_t k = i; k < j; ++k) {
+                        if (terms[k].coefficient) coefficient.add(**terms[k].coefficient);
+                        else coefficient.real += 1;
+                    }
+                    if (coefficient.is_one()) result.push_back(terms[i].rest);
+                    else if (!coefficient.is_zero()) result.push_back(scale_term(coefficient.value(), terms[i].rest));
+                }
+                i = j;
+            }
+
+            if (!constant.is_zero() || (constant.complex && result.empty())) {
+                result.insert(result.begin(), constant.value());
             }
+            if (result.empty()) return constant.rational ? constant.value() : make_expr<Number>(0);
+            if (result.size() == 1) return result[0];
+            return make_fcall(atoms::Plus, result);
         }
 
-        // Elementwise list support for two lists
-        if (eval_args.size() == 2 &&
-            std::holds_alternative<List>(*eval_args[0]) &&
-            std::holds_alternative<List>(*eval_args[1])) {
-            const auto& l1 = std::get<List>(*eval_args[0]).elements;
-            const auto& l2 = std::get<List>(*eval_args[1]).elements;
-            if (l1.size() != l2.size())
-                throw std::runtime_error("List sizes must match for elementwise Times");
-            std::vector<ExprPtr> result;
-            for (size_t i = 0; i < l1.size(); ++i) {
-                result.push_back(eval(make_fcall("Times", { l1[i], l2[i] }), ctx));
+        // A factor of a product split into base and exact exponent (nullptr for 1)
+        struct Factor {
+            ExprPtr original;
+            ExprPtr base;
+            const ExprPtr* exponent;
+        };
+
+        Factor split_factor(const ExprPtr& e) {
+            if (auto f = std::get_if<FunctionCall>(e.get());
+                f && f->head == atoms::Power && f->args.size() == 2 && is_exact_number(*f->args[1])) {
+                return { e, f->args[0], &f->args[1] };
             }
-            return std::make_shared<Expr>(List{ result });
+            return { e, e, nullptr };
         }
 
-        // Scalar and list broadcasting
-        if (eval_args.size() == 2) {
-            if (std::holds_alternative<List>(*eval_args[0]) && std::holds_alternative<Number>(*eval_args[1])) {
-                const auto& l1 = std::get<List>(*eval_args[0]).elements;
-                std::vector<ExprPtr> result;
-                for (const auto& elem : l1) {
-                    result.push_back(eval(make_fcall("Times", { elem, eval_args[1] }), ctx));
-                }
-                return std::make_shared<Expr>(List{ result });
+        // Flat, Orderless Times in one pass: numbers are multiplied, powers of a common base
+        // are combined, and the remaining factors are sorted canonically after the coefficient
+        ExprPtr combine_times(const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+                              const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) {
+            NumericProduct coefficient;
+            std::vector<Factor> factors;
+            factors.reserve(args.size());
+            for (const auto& arg : args) {
+                if (auto n = std::get_if<Number>(arg.get()); n && n->value == 0) return make_expr<Number>(0);
+                if (!coefficient.multiply(*arg)) factors.push_back(split_factor(arg));
             }
-            if (std::holds_alternative<Number>(*eval_args[0]) && std::holds_alternative<List>(*eval_args[1])) {
-                const auto& l2 = std::get<List>(*eval_args[1]).elements;
-                std::vector<ExprPtr> result;
-                for (const auto& elem : l2) {
-                    result.push_back(eval(make_fcall("Times", { eval_args[0], elem }), ctx));
+            std::stable_sort(factors.begin(), factors.end(), [](const Factor& a, const Factor& b) {
+                return canonical_compare(a.base, b.base) < 0;
+            });
+
+            std::vector<ExprPtr> result;
+            result.reserve(factors.size() + 1);
+            for (size_t i = 0; i < factors.size();) {
+                size_t j = i + 1;
+                while (j < factors.size() && expr_equal(factors[j].base, factors[i].base)) ++j;
+                if (j == i + 1) {
+                    result.push_back(factors[i].original);
+                }
+                else {
+                    NumericSum exponent;
+                    for (size_t k = i; k < j; ++k) {
+                        if (factors[k].exponent) exponent.add(**factors[k].exponent);
+                        else exponent.real += 1;
+                    }
+                    if (!exponent.is_zero()) {
+                        auto power = exponent.is_one() ? factors[i].base
+                            : eval(make_fcall(atoms::Power, { factors[i].base, exponent.value() }), ctx);
+                        if (!coefficient.multiply(*power)) result.push_back(power);
+                    }
                 }
-                return std::make_shared<Expr>(List{ result });
+                i = j;
             }
-        }
 
-        // Original Times rule for scalars and mixed
-        double result = 1;
-        std::vector<ExprPtr> simplified;
-        for (const auto& e : eval_args) {
-            if (std::holds_alternative<Number>(*e)) {
-                double val = get_number_value(e);
-                if (val == 0) return make_expr<Number>(0);
-                if (val == 1) continue;
-                result *= val;
+            if (result.empty()) return coefficient.value();
+            if (!coefficient.is_one()) {
+                auto c = coefficient.value();
+                if (auto n = std::get_if<Number>(c.get()); n && n->value == 0) return c;
+                result.insert(result.begin(), c);
             }
-            else {
-                simplified.push_back(e);
+            if (result.size() == 1) return result[0];
+            return make_fcall(atoms::Times, result);
+        }
+
+        // Folds an n-ary call with list arguments into binary calls, which thread over lists
+        // args[0] head args[1] head ... from the left, threading each step over lists
+        ExprPtr fold_binary(Atom head, const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+                            const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) {
+            ExprPtr acc = args[0];
+            for (size_t i = 1; i < args.size(); ++i) {
+                ExprPtr threaded = thread_binary(head, acc, args[i], ctx, eval);
+                acc = threaded ? threaded : eval(make_fcall(head, { acc, args[i] }), ctx);
             }
+            return acc;
+        }
+
+        bool has_list(const std::vector<ExprPtr>& args) {
+            return std::any_of(args.begin(), args.end(), [](const ExprPtr& e) {
+                return std::holds_alternative<List>(*e) || std::holds_alternative<PackedArray>(*e);
+            });
+        }
+
+    } // namespace
+
+    const std::unordered_map<Atom, SimplifyRule> simplification_rules = {
+    {atoms::Plus, [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+            const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
+        std::vector<ExprPtr> eval_args;
+        for (const auto& arg : args) {
+            eval_args.push_back(eval(arg, ctx));
+        }
+
+        // Numeric atoms and packed arrays: one dispatch on the pair of types
+        if (eval_args.size() == 2) {
+            if (auto value = numeric_binary(atoms::Plus, eval_args[0], eval_args[1])) return value;
         }
-        if (result != 1) simplified.insert(simplified.begin(), make_expr<Number>(result));
-        if (simplified.empty()) return make_expr<Number>(1);
-        if (simplified.size() == 1) return simplified[0];
-        return make_fcall("Times", simplified);
+
+        // Lists thread elementwise, and a scalar pairs with every element
+        if (eval_args.size() == 2) {
+            if (auto threaded = thread_binary(atoms::Plus, eval_args[0], eval_args[1], ctx, eval)) return threaded;
+        }
+
+        if (eval_args.size() > 2 && has_list(eval_args)) {
+            return fold_binary(atoms::Plus, eval_args, ctx, eval);
+        }
+        return combine_plus(eval_args);
     }},
-    {"Power", [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+    {atoms::Times, [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
              const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
-        if (args.size() != 2) return make_fcall("Power", args);
+        std::vector<ExprPtr> eval_args;
+        for (const auto& arg : args) {
+            eval_args.push_back(eval(arg, ctx));
+        }
+
+        // Numeric atoms and packed arrays: one dispatch on the pair of types
+        if (eval_args.size() == 2) {
+            if (auto value = numeric_binary(atoms::Times, eval_args[0], eval_args[1])) return value;
+        }
+
+        // Lists thread elementwise, and a scalar pairs with every element
+        if (eval_args.size() == 2) {
+            if (auto threaded = thread_binary(atoms::Times, eval_args[0], eval_args[1], ctx, eval)) return threaded;
+        }
+
+        if (eval_args.size() > 2 && has_list(eval_args)) {
+            return fold_binary(atoms::Times, eval_args, ctx, eval);
+        }
+        return combine_times(eval_args, ctx, eval);
+    }},
+    {atoms::Power, [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+             const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
+        if (args.size() != 2) return make_fcall(atoms::Power, args);
         auto base = eval(args[0], ctx);
         auto exp = eval(args[1], ctx);
         if (std::holds_alternative<Number>(*exp)) {
@@ -211,17 +334,26 @@ namespace aleph3 {
             if (b == 0) return make_expr<Number>(0.0);
             if (b == 1) return make_expr<Number>(1.0);
         }
+        // Integer powers of rationals stay exact
+        if (auto r = std::get_if<Rational>(base.get())) {
+            std::optional<BigInt> e;
+            if (auto n = std::get_if<Number>(exp.get()); n && is_integer(n->value)) e = static_cast<int64_t>(n->value);
+            if (auto q = std::get_if<Rational>(exp.get()); q && q->denominator == 1) e = q->numerator;
+            if (e) {
+                if (auto exact = rational_power(*r, *e)) return exact;
+            }
+        }
         // Add this block for rational exponents:
         if (std::holds_alternative<Number>(*base) && std::holds_alternative<Rational>(*exp)) {
             double b = get_number_value(base);
             const auto& r = std::get<Rational>(*exp);
             // Only handle positive denominator
             if (r.denominator > 0) {
-                double root = std::pow(b, 1.0 / r.denominator);
-                double result = std::pow(root, r.numerator);
+                double root = std::pow(b, 1.0 / static_cast<double>(r.denominator));
+                double result = std::pow(root, static_cast<double>(r.numerator));
                 // If denominator is odd, allow negative base (real root)
                 if (b < 0 && r.denominator % 2 == 1) {
-                    result = -std::pow(-b, static_cast<double>(r.numerator) / r.denominator);
+                    result = -std::pow(-b, r.value());
                 }
                 return make_expr<Number>(result);
             }
@@ -229,14 +361,14 @@ namespace aleph3 {
         if (std::holds_alternative<Rational>(*base) && std::holds_alternative<Rational>(*exp)) {
             const auto& b = std::get<Rational>(*base);
             const auto& r = std::get<Rational>(*exp);
-            double b_val = static_cast<double>(b.numerator) / b.denominator;
+            double b_val = b.value();
             // Only handle positive denominator
             if (r.denominator > 0) {
-                double root = std::pow(b_val, 1.0 / r.denominator);
-                double result = std::pow(root, r.numerator);
+                double root = std::pow(b_val, 1.0 / static_cast<double>(r.denominator));
+                double result = std::pow(root, static_cast<double>(r.numerator));
                 // If denominator is odd, allow negative base (real root)
                 if (b_val < 0 && r.denominator % 2 == 1) {
-                    result = -std::pow(-b_val, static_cast<double>(r.numerator) / r.denominator);
+                    result = -std::pow(-b_val, r.value());
                 }
                 return make_expr<Number>(result);
             }
@@ -246,61 +378,21 @@ namespace aleph3 {
             double e = get_number_value(exp);
             return make_expr<Number>(std::pow(b, e));
         }
-        return make_fcall("Power", {base, exp});
+        return make_fcall(atoms::Power, {base, exp});
     }},
-    {"Divide", [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
+    {atoms::Divide, [](const std::vector<ExprPtr>& args, EvaluationContext& ctx,
               const std::function<ExprPtr(const ExprPtr&, EvaluationContext&)>& eval) -> ExprPtr {
-        if (args.size() != 2) return make_fcall("Divide", args);
+        if (args.size() != 2) return make_fcall(atoms::Divide, args);
             auto num = eval(args[0], ctx);
             auto denom = eval(args[1], ctx);
-            // Rational / Rational
-            if (std::holds_alternative<Rational>(*num) && std::holds_alternative<Rational>(*denom)) {
-                const auto& a = std::get<Rational>(*num);
-                const auto& b = std::get<Rational>(*denom);
-                if (b.numerator == 0) {
-                    if (a.numerator == 0) return make_expr<Indeterminate>();
-                    return make_expr<Infinity>();
-                }
-                auto [nn, dd] = normalize_rational(a.numerator * b.denominator, a.denominator * b.numerator);
-                if (dd == 0) {
-                    if (nn == 0) return make_expr<Indeterminate>();
-                    return make_expr<Infinity>();
-                }
-                return make_expr<Rational>(nn, dd);
+            // Exact and machine zero divisors have their own results; the rest is the tower's
+            if (is_zero_number(*denom)) {
+                if (is_zero_number(*num)) return make_expr<Indeterminate>();
+                if (std::holds_alternative<Rational>(*denom)) return make_expr<Infinity>();
+                // TODO: Return Infinity or ComplexInfinity for a != 0
             }
-            // Rational / Number or Number / Rational
-            if (std::holds_alternative<Rational>(*num) && std::holds_alternative<Number>(*denom)) {
-                const auto& a = std::get<Rational>(*num);
-                double b = std::get<Number>(*denom).value;
-                if (std::floor(b) == b) {
-                    auto [nn, dd] = normalize_rational(a.numerator, a.denominator * static_cast<int64_t>(b));
-                    return make_expr<Rational>(nn, dd);
-                } else {
-                    double val = static_cast<double>(a.numerator) / a.denominator / b;
-                    return make_expr<Number>(val);
-                }
-            }
-            if (std::holds_alternative<Number>(*num) && std::holds_alternative<Rational>(*denom)) {
-                double a = std::get<Number>(*num).value;
-                const auto& b = std::get<Rational>(*denom);
-                if (std::floor(a) == a) {
-                    auto [nn, dd] = normalize_rational(static_cast<int64_t>(a) * b.denominator, b.numerator);
-                    return make_expr<Rational>(nn, dd);
-                } else {
-                    double val = a / (static_cast<double>(b.numerator) / b.denominator);
-                    return make_expr<Number>(val);
-                }
-            }
-            if (std::holds_alternative<Number>(*num) && std::holds_alternative<Number>(*denom)) {
-                double a = get_number_value(num);
-                double b = get_number_value(denom);
-                if (b == 0.0) {
-                    if (a == 0.0) return make_expr(Indeterminate{});
-                    // TODO: Return Infinity or ComplexInfinity for a != 0
-            }
-            return make_expr<Number>(a / b);
-        }
-        return make_fcall("Divide", {num, denom});
+            if (auto value = numeric_binary(atoms::Divide, num, denom)) return value;
+        return make_fcall(atoms::Divide, {num, denom});
     }},
     };
 }
\ No newline at end of file
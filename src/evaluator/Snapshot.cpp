@@ -0,0 +1,291 @@
+#include "evaluator/Snapshot.hpp"
+#include "evaluator/Compiler.hpp"
+#include "evaluator/ConstantFolding.hpp"
+#include "evaluator/DownValues.hpp"
+#include "expr/ExprUtils.hpp"
+#include "expr/Serialize.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aleph3 {
+
+    namespace {
+        constexpr std::string_view MAGIC = "A3SN";
+
+        [[noreturn]] void fail(const std::string& what) {
+            throw SerializationError("Snapshot: " + what);
+        }
+
+        void put_varint(std::string& out, uint64_t v) {
+            while (v >= 0x80) {
+                out.push_back(static_cast<char>(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(static_cast<char>(v));
+        }
+
+        // The file's bytes, mapped read-only where the platform allows
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) fail("cannot read '" + path + "'");
+                struct stat st{};
+                if (::fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    fail("cannot read '" + path + "'");
+                }
+                size = static_cast<size_t>(st.st_size);
+                if (size > 0) {
+                    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p == MAP_FAILED) {
+                        ::close(fd);
+                        fail("cannot map '" + path + "'");
+                    }
+                    data = static_cast<const char*>(p);
+                }
+                ::close(fd);
+#else
+                std::ifstream file(path, std::ios::binary);
+                if (!file) fail("cannot read '" + path + "'");
+                std::ostringstream contents;
+                contents << file.rdbuf();
+                buffer = std::move(contents).str();
+                data = buffer.data();
+                size = buffer.size();
+#endif
+            }
+
+            ~MappedFile() {
+#ifndef _WIN32
+                if (data) ::munmap(const_cast<char*>(data), size);
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            std::string_view bytes() const { return { data, size }; }
+
+        private:
+            const char* data = nullptr;
+            size_t size = 0;
+#ifdef _WIN32
+            std::string buffer;
+#endif
+        };
+
+        // Reads the index at the front of a snapshot
+        class IndexReader {
+        public:
+            explicit IndexReader(std::string_view bytes) : in(bytes) {}
+
+            uint64_t varint() {
+                uint64_t v = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    if (pos == in.size()) fail("truncated index");
+                    const auto b = static_cast<uint8_t>(in[pos++]);
+                    v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) return v;
+                }
+                fail("malformed index");
+            }
+
+            std::string_view take(uint64_t n) {
+                if (n > in.size() - pos) fail("truncated index");
+                auto out = in.substr(pos, n);
+                pos += n;
+                return out;
+            }
+
+            size_t position() const { return pos; }
+
+        private:
+            std::string_view in;
+            size_t pos = 0;
+        };
+
+        ExprPtr decode_variable(std::string_view bytes) {
+            return deserialize(bytes);
+        }
+
+        // {FunctionDefinition, {key -> value, ...}}
+        FunctionDefinition decode_function(std::string_view bytes) {
+            const ExprPtr payload = deserialize(bytes);
+            const auto* parts = std::get_if<List>(payload.get());
+            const FunctionDefinition* stored = parts && parts->elements.size() == 2
+                ? std::get_if<FunctionDefinition>(parts->elements[0].get()) : nullptr;
+            const auto* values = stored ? std::get_if<List>(parts->elements[1].get()) : nullptr;
+            if (!values) fail("malformed function entry");
+
+            FunctionDefinition def(stored->name, stored->params, stored->body, stored->delayed);
+            // As when the definition was evaluated: optimized once, compiled if numeric
+            if (def.body) {
+                def.body = optimize_expr(def.body);
+                def.compiled = compile_definition(def);
+            }
+            if (!values->elements.empty()) {
+                auto& downvalues = downvalues_of(def);
+                for (const auto& entry : values->elements) {
+                    const auto* rule = std::get_if<Rule>(entry.get());
+                    if (!rule) fail("malformed specific value");
+                    downvalues.define(rule->lhs, rule->rhs);
+                }
+            }
+            return def;
+        }
+
+        template <typename V>
+        class SnapshotBindings final : public LazyBindings<V> {
+        public:
+            using Decode = V (*)(std::string_view);
+
+            SnapshotBindings(std::shared_ptr<const MappedFile> file, Decode decode)
+                : file(std::move(file)), decode(decode) {}
+
+            void add(Atom name, std::string_view bytes) {
+                if (!slots.try_emplace(name, bytes).second) fail("duplicate name '" + name.str() + "'");
+                order.push_back(name);
+            }
+
+            const V* get(Atom key) const override {
+                auto it = slots.find(key);
+                if (it == slots.end()) return nullptr;
+                const Slot& slot = it->second;
+                std::call_once(slot.once, [&] { slot.value.emplace(decode(slot.bytes)); });
+                return &*slot.value;
+            }
+
+            std::vector<Atom> names() const override { return order; }
+
+        private:
+            struct Slot {
+                explicit Slot(std::string_view bytes) : bytes(bytes) {}
+                std::string_view bytes;
+                mutable std::once_flag once;
+                mutable std::optional<V> value;
+            };
+
+            std::shared_ptr<const MappedFile> file;  // Keeps the bytes of the slots mapped
+            Decode decode;
+            std::unordered_map<Atom, Slot> slots;    // Nodes never move, so values stay put
+            std::vector<Atom> order;
+        };
+
+        // Bindings of one kind visible from ctx, where inner frames hide outer ones, by name
+        template <typename V, typename Member>
+        std::vector<std::pair<Atom, const V*>> visible(const EvaluationContext& ctx, Member member) {
+            std::vector<std::pair<Atom, const V*>> out;
+            std::unordered_set<Atom> seen;
+            for (const EvaluationContext* frame = &ctx; frame; frame = frame->parent) {
+                (frame->*member).for_each([&](Atom name, const V& value) {
+                    if (seen.insert(name).second) out.emplace_back(name, &value);
+                });
+            }
+            std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.first.str() < b.first.str(); });
+            return out;
+        }
+    }
+
+    void save_snapshot(const EvaluationContext& ctx, const std::string& path) {
+        const auto variables = visible<ExprPtr>(ctx, &EvaluationContext::variables);
+        const auto functions = visible<FunctionDefinition>(ctx, &EvaluationContext::user_functions);
+
+        std::string index(MAGIC);
+        std::string data;
+        put_varint(index, SNAPSHOT_FORMAT_VERSION);
+        auto entry = [&](Atom name, const std::string& bytes) {
+            put_varint(index, name.str().size());
+            index += name.str();
+            put_varint(index, data.size());
+            put_varint(index, bytes.size());
+            data += bytes;
+        };
+        put_varint(index, variables.size());
+        for (const auto& [name, value] : variables) entry(name, serialize(*value));
+        put_varint(index, functions.size());
+        for (const auto& [name, def] : functions) {
+            std::vector<ExprPtr> values;
+            if (auto downvalues = attached_downvalues(*def)) {
+                for (const auto& [key, value] : downvalues->definitions()) values.push_back(make_expr<Rule>(key, value));
+            }
+            auto stored = make_expr<FunctionDefinition>(def->name, def->params, def->body, def->delayed);
+            entry(name, serialize(make_expr<List>(std::vector<ExprPtr>{ stored, make_expr<List>(std::move(values)) })));
+        }
+
+        // Written aside and renamed, so a reader never maps a half-written snapshot
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file || !file.write(index.data(), static_cast<std::streamsize>(index.size())) ||
+                !file.write(data.data(), static_cast<std::streamsize>(data.size())) || !file.flush()) {
+                std::remove(temporary.c_str());
+                fail("cannot write '" + path + "'");
+            }
+        }
+        std::remove(path.c_str());
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            fail("cannot write '" + path + "'");
+        }
+    }
+
+    void load_snapshot(EvaluationContext& ctx, const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        const std::string_view bytes = file->bytes();
+        if (bytes.substr(0, MAGIC.size()) != MAGIC) fail("'" + path + "' is not a snapshot");
+        IndexReader reader(bytes.substr(MAGIC.size()));
+        if (const uint64_t version = reader.varint(); version != SNAPSHOT_FORMAT_VERSION) {
+            fail("unsupported format version " + std::to_string(version));
+        }
+
+        struct Entry {
+            Atom name;
+            uint64_t offset, size;
+        };
+        std::vector<Entry> variables, functions;
+        for (auto* entries : { &variables, &functions }) {
+            const uint64_t count = reader.varint();
+            if (count > bytes.size()) fail("malformed index");
+            entries->reserve(count);
+            for (uint64_t i = 0; i < count; ++i) {
+                const Atom name(reader.take(reader.varint()));
+                const uint64_t offset = reader.varint();
+                entries->push_back({ name, offset, reader.varint() });
+            }
+        }
+        const std::string_view data = bytes.substr(MAGIC.size() + reader.position());
+        auto slice = [&](const Entry& e) {
+            if (e.offset > data.size() || e.size > data.size() - e.offset) fail("entry '" + e.name.str() + "' out of range");
+            return data.substr(e.offset, e.size);
+        };
+
+        auto lazy_variables = std::make_shared<SnapshotBindings<ExprPtr>>(file, decode_variable);
+        for (const auto& e : variables) lazy_variables->add(e.name, slice(e));
+        auto lazy_functions = std::make_shared<SnapshotBindings<FunctionDefinition>>(file, decode_function);
+        for (const auto& e : functions) lazy_functions->add(e.name, slice(e));
+
+        ctx.variables.attach(std::move(lazy_variables));
+        ctx.user_functions.attach(std::move(lazy_functions));
+        // Specific values are definitions that results stamped as final did not see
+        detail::bump_definitions_epoch();
+    }
+
+} // namespace aleph3
@@ -0,0 +1,154 @@
+#include "evaluator/SpecialValues.hpp"
+#include "expr/ExprUtils.hpp"
+#include "Constants.hpp"
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+
+        // Nesting of Times/Divide/Negate looked through before giving up
+        constexpr size_t MAX_DEPTH = 64;
+
+        RationalMultiple make_multiple(Atom unit, const BigInt& p, const BigInt& q) {
+            auto [n, d] = normalize_rational(p, q);
+            if (n.is_zero()) unit = Atom();
+            return { unit, std::move(n), std::move(d) };
+        }
+
+        std::optional<RationalMultiple> parse(const Expr& e, size_t depth) {
+            if (depth > MAX_DEPTH) return std::nullopt;
+            if (auto n = std::get_if<Number>(&e)) {
+                if (!std::isfinite(n->value) || n->value != std::floor(n->value)) return std::nullopt;
+                return RationalMultiple{ Atom(), BigInt::from_double(n->value), 1 };
+            }
+            if (auto r = std::get_if<Rational>(&e)) return RationalMultiple{ Atom(), r->numerator, r->denominator };
+            if (auto s = std::get_if<Symbol>(&e)) {
+                if (s->name == atoms::Pi) return RationalMultiple{ atoms::Pi, 1, 1 };
+                return std::nullopt;
+            }
+            auto f = std::get_if<FunctionCall>(&e);
+            if (!f) return std::nullopt;
+
+            if (f->head == atoms::Times) {
+                RationalMultiple acc{ Atom(), 1, 1 };
+                for (const auto& arg : f->args) {
+                    auto factor = parse(*arg, depth + 1);
+                    if (!factor) return std::nullopt;
+                    if (!factor->unit.empty()) {
+                        if (!acc.unit.empty()) return std::nullopt; // Pi^2
+                        acc.unit = factor->unit;
+                    }
+                    acc.p *= factor->p;
+                    acc.q *= factor->q;
+                }
+                return make_multiple(acc.unit, acc.p, acc.q);
+            }
+            if (f->head == atoms::Divide && f->args.size() == 2) {
+                auto num = parse(*f->args[0], depth + 1);
+                auto den = parse(*f->args[1], depth + 1);
+                if (!num || !den || !den->unit.empty() || den->p.is_zero()) return std::nullopt;
+                return make_multiple(num->unit, num->p * den->q, num->q * den->p);
+            }
+            if ((f->head == atoms::Negate || f->head == atoms::Minus) && f->args.size() == 1) {
+                auto x = parse(*f->args[0], depth + 1);
+                if (!x) return std::nullopt;
+                x->p = -x->p;
+                return x;
+            }
+            return std::nullopt;
+        }
+
+        // Values of one function, keyed on exact arguments
+        struct ValueTable {
+            struct Entry {
+                Atom unit;
+                int64_t p;
+                int64_t q;
+                ExprPtr value;
+            };
+
+            int64_t period = 0;           // In units of Pi; Pi-multiple keys lie in [0, period)
+            bool rational_keys = false;   // Some key other than 0 has no unit
+            std::vector<Entry> entries;
+
+            ValueTable(int64_t period_in_pi, std::vector<Entry> values)
+                : period(period_in_pi), entries(std::move(values)) {
+                for (const auto& e : entries) {
+                    if (e.unit.empty() && e.p != 0) rational_keys = true;
+                }
+            }
+
+            ExprPtr find(RationalMultiple key) const {
+                if (!key.unit.empty() && period != 0) {
+                    const BigInt span = key.q * period;
+                    key.p = key.p % span;
+                    if (key.p.sign() < 0) key.p += span;
+                    if (key.p.is_zero()) key.unit = Atom();
+                }
+                if (!key.p.is_small() || !key.q.is_small()) return nullptr;
+                for (const auto& e : entries) {
+                    if (e.unit == key.unit && key.p == e.p && key.q == e.q) return e.value;
+                }
+                return nullptr;
+            }
+        };
+
+        ValueTable::Entry zero(ExprPtr value) { return { Atom(), 0, 1, std::move(value) }; }
+        ValueTable::Entry pi(int64_t p, int64_t q, ExprPtr value) { return { atoms::Pi, p, q, std::move(value) }; }
+
+        ExprPtr num(double v) { return make_expr<Number>(v); }
+
+        const std::unordered_map<Atom, ValueTable>& tables() {
+            const double half_sqrt2 = std::sqrt(2.0) / 2.0;
+            static const std::unordered_map<Atom, ValueTable> values = {
+                { atoms::Sin, ValueTable(2, {
+                    zero(num(0.0)), pi(1, 1, num(0.0)),
+                    pi(1, 2, num(1.0)), pi(3, 2, num(-1.0)),
+                    pi(1, 4, num(half_sqrt2)), pi(7, 4, num(-half_sqrt2)) }) },
+                { atoms::Cos, ValueTable(2, {
+                    zero(num(1.0)), pi(1, 1, num(-1.0)),
+                    pi(1, 2, num(0.0)), pi(3, 2, num(0.0)),
+                    pi(1, 4, num(half_sqrt2)), pi(7, 4, num(half_sqrt2)) }) },
+                { atoms::Tan, ValueTable(1, {
+                    zero(num(0.0)),
+                    pi(1, 4, num(1.0)), pi(3, 4, num(-1.0)),
+                    pi(1, 6, num(std::tan(PI / 6))), pi(5, 6, num(std::tan(-PI / 6))),
+                    pi(1, 3, num(std::tan(PI / 3))), pi(2, 3, num(std::tan(-PI / 3))) }) },
+                { atoms::Sinc, ValueTable(0, {
+                    zero(num(1.0)),
+                    pi(1, 1, num(std::sin(PI) / PI)), pi(-1, 1, num(std::sin(-PI) / -PI)),
+                    pi(2, 1, num(std::sin(2 * PI) / (2 * PI))), pi(-2, 1, num(std::sin(-2 * PI) / (-2 * PI))) }) },
+                { atoms::Cot, ValueTable(1, {
+                    zero(make_expr<Infinity>()),
+                    pi(1, 4, num(1.0)), pi(3, 4, num(-1.0)), pi(1, 2, num(0.0)) }) },
+                { atoms::Csc, ValueTable(2, {
+                    zero(make_expr<Infinity>()), pi(1, 1, make_expr<Infinity>()),
+                    pi(1, 2, num(1.0)), pi(3, 2, num(-1.0)),
+                    pi(1, 6, num(2.0)), pi(11, 6, num(-2.0)) }) },
+            };
+            return values;
+        }
+
+    } // namespace
+
+    std::optional<RationalMultiple> rational_multiple(const Expr& e) {
+        return parse(e, 0);
+    }
+
+    ExprPtr special_value(Atom head, const ExprPtr& arg) {
+        const auto& all = tables();
+        auto it = all.find(head);
+        if (it == all.end()) return nullptr;
+        const ValueTable& table = it->second;
+
+        // Machine numbers: only 0 can match unless the table has rational keys
+        if (auto n = std::get_if<Number>(arg.get()); n && n->value != 0.0 && !table.rational_keys) return nullptr;
+        auto key = rational_multiple(*arg);
+        return key ? table.find(std::move(*key)) : nullptr;
+    }
+
+} // namespace aleph3
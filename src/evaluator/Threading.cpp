@@ -0,0 +1,84 @@
+#include "evaluator/Threading.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "expr/ExprUtils.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+        bool is_list_like(const Expr& e) {
+            return std::holds_alternative<List>(e) || std::holds_alternative<PackedArray>(e) || std::holds_alternative<LazyList>(e);
+        }
+
+        // A list-like operand as a List, or the scalar itself
+        ExprPtr as_list(const ExprPtr& e) {
+            return is_list_like(*e) ? unpack(materialize(e)) : e;
+        }
+    }
+
+    ExprPtr thread_binary(Atom op, const ExprPtr& a, const ExprPtr& b, EvaluationContext& ctx, const ElementEvaluator& eval) {
+        if (!is_list_like(*a) && !is_list_like(*b)) return nullptr;
+        const std::optional<kernels::Binary> kernel = kernels::binary_kernel(op);
+
+        // A pair with a numeric value: atoms, or packed arrays combined on their buffers
+        auto numeric = [&](const ExprPtr& x, const ExprPtr& y) -> ExprPtr {
+            return kernel ? numeric_binary(*kernel, x, y) : nullptr;
+        };
+        if (auto value = numeric(a, b)) return value;
+
+        struct Frame {
+            ExprPtr a, b;                // Lists, or a scalar paired with each element
+            size_t length = 0;
+            size_t next = 0;
+            std::vector<ExprPtr> results{};
+        };
+        std::vector<Frame> stack;
+        auto push = [&](const ExprPtr& x, const ExprPtr& y) {
+            Frame frame{ as_list(x), as_list(y) };
+            auto lx = std::get_if<List>(frame.a.get());
+            auto ly = std::get_if<List>(frame.b.get());
+            if (lx && ly && lx->elements.size() != ly->elements.size()) {
+                throw std::runtime_error("List sizes must match for elementwise operation");
+            }
+            frame.length = lx ? lx->elements.size() : ly->elements.size();
+            frame.results.reserve(frame.length);
+            stack.push_back(std::move(frame));
+        };
+        auto element = [](const ExprPtr& operand, size_t i) -> const ExprPtr& {
+            auto list = std::get_if<List>(operand.get());
+            return list ? list->elements[i] : operand;
+        };
+
+        push(a, b);
+        ExprPtr result;
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.next < top.length) {
+                const size_t i = top.next++;
+                const ExprPtr& x = element(top.a, i);
+                const ExprPtr& y = element(top.b, i);
+                if (auto value = numeric(x, y)) {
+                    top.results.push_back(std::move(value));
+                }
+                else if (is_list_like(*x) || is_list_like(*y)) {
+                    push(x, y);  // may reallocate `stack`; `top` is not used again this iteration
+                }
+                else {
+                    top.results.push_back(eval(make_fcall(op, { x, y }), ctx));
+                }
+                continue;
+            }
+            ExprPtr list = make_list_auto_packed(std::move(top.results));
+            stack.pop_back();
+            if (stack.empty()) result = std::move(list);
+            else stack.back().results.push_back(std::move(list));
+        }
+        return result;
+    }
+
+} // namespace aleph3
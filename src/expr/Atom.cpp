@@ -0,0 +1,88 @@
+#include "expr/Atom.hpp"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+
+        constexpr size_t BLOCK_BITS = 12;
+        constexpr size_t BLOCK_SIZE = size_t{1} << BLOCK_BITS;
+        constexpr size_t MAX_BLOCKS = size_t{1} << 12;
+
+        // Names live in a deque (stable addresses); the ID -> name lookup goes through a
+        // two-level block table so readers never need the lock.
+        struct AtomTable {
+            std::shared_mutex mutex;
+            std::deque<std::string> names;
+            std::unordered_map<std::string_view, uint32_t> index;
+            std::array<std::atomic<const std::string**>, MAX_BLOCKS> blocks{};
+
+            AtomTable() {
+                for (const auto& name : BUILTIN_ATOM_NAMES) {
+                    insert(name);
+                }
+            }
+
+            // Caller must hold the unique lock
+            uint32_t insert(std::string_view name) {
+                size_t id = names.size();
+                if (id >= BLOCK_SIZE * MAX_BLOCKS) {
+                    throw std::runtime_error("Atom table is full");
+                }
+                const std::string& stored = names.emplace_back(name);
+                size_t block = id >> BLOCK_BITS;
+                const std::string** slots = blocks[block].load(std::memory_order_acquire);
+                if (!slots) {
+                    slots = new const std::string*[BLOCK_SIZE]();
+                    blocks[block].store(slots, std::memory_order_release);
+                }
+                slots[id & (BLOCK_SIZE - 1)] = &stored;
+                index.emplace(stored, static_cast<uint32_t>(id));
+                return static_cast<uint32_t>(id);
+            }
+
+            const std::string& name(uint32_t id) const {
+                const std::string** slots = blocks[id >> BLOCK_BITS].load(std::memory_order_acquire);
+                return *slots[id & (BLOCK_SIZE - 1)];
+            }
+        };
+
+        // Intentionally leaked so atoms stay valid during static destruction
+        AtomTable& table() {
+            static AtomTable* instance = new AtomTable();
+            return *instance;
+        }
+
+    } // namespace
+
+    uint32_t Atom::intern(std::string_view name) {
+        auto& t = table();
+        {
+            std::shared_lock lock(t.mutex);
+            auto it = t.index.find(name);
+            if (it != t.index.end()) return it->second;
+        }
+        std::unique_lock lock(t.mutex);
+        auto it = t.index.find(name);
+        if (it != t.index.end()) return it->second;
+        return t.insert(name);
+    }
+
+    const std::string& Atom::str() const {
+        return table().name(id_);
+    }
+
+    size_t Atom::table_size() {
+        auto& t = table();
+        std::shared_lock lock(t.mutex);
+        return t.names.size();
+    }
+
+} // namespace aleph3
@@ -0,0 +1,408 @@
+#include "expr/BigInt.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+
+namespace aleph3 {
+
+    // Little-endian base-2^32 digits without leading zeros
+    struct BigInt::Limbs {
+        bool negative = false;
+        std::vector<uint32_t> digits;
+    };
+
+    namespace {
+
+        using Digits = std::vector<uint32_t>;
+
+        void trim(Digits& d) {
+            while (!d.empty() && d.back() == 0) d.pop_back();
+        }
+
+        int compare(const Digits& a, const Digits& b) {
+            if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+            for (size_t i = a.size(); i-- > 0;) {
+                if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+            }
+            return 0;
+        }
+
+        // acc += b * 2^(32 * shift); acc must have room for the carry
+        void add_into(Digits& acc, const uint32_t* b, size_t nb, size_t shift) {
+            uint64_t carry = 0;
+            size_t i = 0;
+            for (; i < nb; ++i) {
+                const uint64_t t = static_cast<uint64_t>(acc[i + shift]) + b[i] + carry;
+                acc[i + shift] = static_cast<uint32_t>(t);
+                carry = t >> 32;
+            }
+            for (size_t k = i + shift; carry; ++k) {
+                const uint64_t t = static_cast<uint64_t>(acc[k]) + carry;
+                acc[k] = static_cast<uint32_t>(t);
+                carry = t >> 32;
+            }
+        }
+
+        // acc -= b; requires acc >= b
+        void sub_into(Digits& acc, const Digits& b) {
+            int64_t borrow = 0;
+            for (size_t i = 0; i < acc.size(); ++i) {
+                int64_t t = static_cast<int64_t>(acc[i]) - borrow - (i < b.size() ? b[i] : 0);
+                borrow = t < 0;
+                acc[i] = static_cast<uint32_t>(t + (borrow << 32));
+                if (i >= b.size() && !borrow) break;
+            }
+        }
+
+        Digits add(const Digits& a, const Digits& b) {
+            const Digits& longer = a.size() >= b.size() ? a : b;
+            const Digits& shorter = a.size() >= b.size() ? b : a;
+            Digits r(longer);
+            r.push_back(0);
+            add_into(r, shorter.data(), shorter.size(), 0);
+            trim(r);
+            return r;
+        }
+
+        Digits schoolbook(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+            Digits r(na + nb, 0);
+            for (size_t i = 0; i < na; ++i) {
+                uint64_t carry = 0;
+                const uint64_t ai = a[i];
+                for (size_t j = 0; j < nb; ++j) {
+                    const uint64_t t = ai * b[j] + r[i + j] + carry;
+                    r[i + j] = static_cast<uint32_t>(t);
+                    carry = t >> 32;
+                }
+                r[i + nb] = static_cast<uint32_t>(carry);
+            }
+            return r;
+        }
+
+        Digits multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+            while (na > 0 && a[na - 1] == 0) --na;
+            while (nb > 0 && b[nb - 1] == 0) --nb;
+            if (na == 0 || nb == 0) return {};
+            if (na > nb) {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+            if (na < BigInt::KARATSUBA_THRESHOLD) {
+                Digits r = schoolbook(a, na, b, nb);
+                trim(r);
+                return r;
+            }
+            Digits r(na + nb + 1, 0);
+            if (2 * na <= nb) {
+                // Unbalanced: multiply a by na-limb slices of b
+                for (size_t offset = 0; offset < nb; offset += na) {
+                    Digits part = multiply(a, na, b + offset, std::min(na, nb - offset));
+                    add_into(r, part.data(), part.size(), offset);
+                }
+                trim(r);
+                return r;
+            }
+
+            // a = a1 B^m + a0, b = b1 B^m + b0:
+            // a b = z2 B^2m + ((a0 + a1)(b0 + b1) - z2 - z0) B^m + z0
+            const size_t m = nb / 2;
+            const size_t a0n = std::min(na, m);
+            Digits z0 = multiply(a, a0n, b, m);
+            Digits z2 = multiply(a + a0n, na - a0n, b + m, nb - m);
+            Digits sa = add(Digits(a, a + a0n), Digits(a + a0n, a + na));
+            Digits sb = add(Digits(b, b + m), Digits(b + m, b + nb));
+            Digits z1 = multiply(sa.data(), sa.size(), sb.data(), sb.size());
+            sub_into(z1, z0);
+            sub_into(z1, z2);
+            trim(z1);
+            add_into(r, z0.data(), z0.size(), 0);
+            add_into(r, z1.data(), z1.size(), m);
+            add_into(r, z2.data(), z2.size(), 2 * m);
+            trim(r);
+            return r;
+        }
+
+        // a /= d in place; returns the remainder
+        uint32_t divide_small(Digits& a, uint32_t d) {
+            uint64_t rem = 0;
+            for (size_t i = a.size(); i-- > 0;) {
+                const uint64_t cur = (rem << 32) | a[i];
+                a[i] = static_cast<uint32_t>(cur / d);
+                rem = cur % d;
+            }
+            trim(a);
+            return static_cast<uint32_t>(rem);
+        }
+
+        // a = a * m + c in place
+        void multiply_add_small(Digits& a, uint32_t m, uint32_t c) {
+            uint64_t carry = c;
+            for (auto& digit : a) {
+                const uint64_t t = static_cast<uint64_t>(digit) * m + carry;
+                digit = static_cast<uint32_t>(t);
+                carry = t >> 32;
+            }
+            if (carry) a.push_back(static_cast<uint32_t>(carry));
+        }
+
+        // Knuth's algorithm D (TAOCP 4.3.1); v has at least one digit
+        void divide(const Digits& u, const Digits& v, Digits& q, Digits& r) {
+            if (compare(u, v) < 0) {
+                q.clear();
+                r = u;
+                return;
+            }
+            if (v.size() == 1) {
+                q = u;
+                const uint32_t rem = divide_small(q, v[0]);
+                r.clear();
+                if (rem) r.push_back(rem);
+                return;
+            }
+            const size_t n = v.size(), m = u.size() - n;
+            const int s = std::countl_zero(v.back());
+            Digits vn(n), un(u.size() + 1);
+            for (size_t i = n - 1; i > 0; --i) {
+                vn[i] = static_cast<uint32_t>((static_cast<uint64_t>(v[i]) << s) | (static_cast<uint64_t>(v[i - 1]) >> (32 - s)));
+            }
+            vn[0] = v[0] << s;
+            un[m + n] = static_cast<uint32_t>(static_cast<uint64_t>(u[m + n - 1]) >> (32 - s));
+            for (size_t i = m + n - 1; i > 0; --i) {
+                un[i] = static_cast<uint32_t>((static_cast<uint64_t>(u[i]) << s) | (static_cast<uint64_t>(u[i - 1]) >> (32 - s)));
+            }
+            un[0] = u[0] << s;
+
+            constexpr uint64_t BASE = uint64_t{1} << 32;
+            q.assign(m + 1, 0);
+            for (size_t j = m + 1; j-- > 0;) {
+                const uint64_t top = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+                uint64_t qhat = top / vn[n - 1];
+                uint64_t rhat = top % vn[n - 1];
+                while (qhat >= BASE || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                    --qhat;
+                    rhat += vn[n - 1];
+                    if (rhat >= BASE) break;
+                }
+                int64_t k = 0, t;
+                for (size_t i = 0; i < n; ++i) {
+                    const uint64_t p = qhat * vn[i];
+                    t = static_cast<int64_t>(un[i + j]) - k - static_cast<int64_t>(p & 0xFFFFFFFFu);
+                    un[i + j] = static_cast<uint32_t>(t);
+                    k = static_cast<int64_t>(p >> 32) - (t >> 32);
+                }
+                t = static_cast<int64_t>(un[j + n]) - k;
+                un[j + n] = static_cast<uint32_t>(t);
+                q[j] = static_cast<uint32_t>(qhat);
+                if (t < 0) { // qhat was one too large: add v back
+                    --q[j];
+                    uint64_t carry = 0;
+                    for (size_t i = 0; i < n; ++i) {
+                        const uint64_t sum = static_cast<uint64_t>(un[i + j]) + vn[i] + carry;
+                        un[i + j] = static_cast<uint32_t>(sum);
+                        carry = sum >> 32;
+                    }
+                    un[j + n] = static_cast<uint32_t>(un[j + n] + carry);
+                }
+            }
+            trim(q);
+            r.assign(n, 0);
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = static_cast<uint32_t>((static_cast<uint64_t>(un[i]) >> s) | (static_cast<uint64_t>(un[i + 1]) << (32 - s)));
+            }
+            trim(r);
+        }
+
+        // Top bits of d as a double, and the power of two they are scaled by
+        double leading(const Digits& d, int& exponent) {
+            double value = 0;
+            const size_t take = std::min<size_t>(d.size(), 3);
+            for (size_t i = 0; i < take; ++i) value = value * 4294967296.0 + d[d.size() - 1 - i];
+            exponent = static_cast<int>(32 * (d.size() - take));
+            return value;
+        }
+
+    } // namespace
+
+    BigInt::Limbs BigInt::limbs_of(const BigInt& a) {
+        if (a.big_) return *a.big_;
+        Limbs l;
+        l.negative = a.small_ < 0;
+        uint64_t m = l.negative ? 0 - static_cast<uint64_t>(a.small_) : static_cast<uint64_t>(a.small_);
+        while (m) {
+            l.digits.push_back(static_cast<uint32_t>(m));
+            m >>= 32;
+        }
+        return l;
+    }
+
+    BigInt BigInt::from_limbs(Limbs value) {
+        trim(value.digits);
+        if (value.digits.size() <= 2) {
+            uint64_t m = 0;
+            for (size_t i = value.digits.size(); i-- > 0;) m = (m << 32) | value.digits[i];
+            if (!value.negative && m <= static_cast<uint64_t>(INT64_MAX)) return BigInt(static_cast<int64_t>(m));
+            if (value.negative && m <= uint64_t{1} << 63) return BigInt(static_cast<int64_t>(0 - m));
+        }
+        BigInt result;
+        result.big_ = std::make_shared<const Limbs>(std::move(value));
+        return result;
+    }
+
+    BigInt BigInt::from_string(const std::string& text) {
+        size_t pos = 0;
+        const bool negative = !text.empty() && text[0] == '-';
+        if (negative) ++pos;
+        if (pos == text.size()) throw std::invalid_argument("BigInt expects decimal digits");
+        Limbs l;
+        l.negative = negative;
+        for (; pos < text.size(); ++pos) {
+            const char c = text[pos];
+            if (c < '0' || c > '9') throw std::invalid_argument("BigInt expects decimal digits");
+            multiply_add_small(l.digits, 10, static_cast<uint32_t>(c - '0'));
+        }
+        return from_limbs(std::move(l));
+    }
+
+    BigInt BigInt::from_double(double value) {
+        if (!std::isfinite(value) || std::floor(value) != value) {
+            throw std::domain_error("BigInt expects a finite integral value");
+        }
+        if (std::abs(value) < 0x1p63) return BigInt(static_cast<int64_t>(value));
+        int exponent;
+        const double fraction = std::frexp(std::abs(value), &exponent);
+        BigInt result = BigInt(static_cast<int64_t>(std::ldexp(fraction, 53))) * pow(BigInt(2), exponent - 53);
+        return value < 0 ? -result : result;
+    }
+
+    int BigInt::sign() const {
+        if (big_) return big_->negative ? -1 : 1;
+        return (small_ > 0) - (small_ < 0);
+    }
+
+    bool BigInt::is_even() const {
+        return big_ ? (big_->digits[0] & 1) == 0 : (small_ & 1) == 0;
+    }
+
+    std::vector<uint32_t> BigInt::magnitude() const {
+        return limbs_of(*this).digits;
+    }
+
+    BigInt BigInt::from_magnitude(std::vector<uint32_t> limbs) {
+        Limbs value;
+        value.digits = std::move(limbs);
+        return from_limbs(std::move(value));
+    }
+
+    size_t BigInt::bit_length() const {
+        if (!big_) {
+            const uint64_t m = small_ < 0 ? 0 - static_cast<uint64_t>(small_) : static_cast<uint64_t>(small_);
+            return 64 - std::countl_zero(m);
+        }
+        return 32 * big_->digits.size() - std::countl_zero(big_->digits.back());
+    }
+
+    double BigInt::to_double() const {
+        if (!big_) return static_cast<double>(small_);
+        int exponent;
+        const double value = leading(big_->digits, exponent);
+        return (big_->negative ? -1 : 1) * std::ldexp(value, exponent);
+    }
+
+    double BigInt::ratio(const BigInt& n, const BigInt& d) {
+        if (!n.big_ && !d.big_) return static_cast<double>(n.small_) / static_cast<double>(d.small_);
+        const Limbs a = limbs_of(n), b = limbs_of(d);
+        if (b.digits.empty()) return static_cast<double>(n.sign()) / 0.0;
+        if (a.digits.empty()) return 0.0;
+        int ea, eb;
+        const double fa = leading(a.digits, ea), fb = leading(b.digits, eb);
+        return (a.negative != b.negative ? -1 : 1) * std::ldexp(fa / fb, ea - eb);
+    }
+
+    std::string BigInt::to_string() const {
+        if (!big_) return std::to_string(small_);
+        Digits d = big_->digits;
+        std::vector<uint32_t> chunks; // Base 10^9, least significant first
+        while (!d.empty()) chunks.push_back(divide_small(d, 1000000000u));
+        std::string out = big_->negative ? "-" : "";
+        out += std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            std::string part = std::to_string(chunks[i]);
+            out.append(9 - part.size(), '0');
+            out += part;
+        }
+        return out;
+    }
+
+    size_t BigInt::hash() const {
+        if (!big_) return std::hash<int64_t>()(small_);
+        size_t h = big_->negative ? 0x9e3779b97f4a7c15ull : 0;
+        for (uint32_t digit : big_->digits) h ^= digit + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    BigInt BigInt::add_slow(const BigInt& a, const BigInt& b, bool subtract) {
+        Limbs x = limbs_of(a), y = limbs_of(b);
+        if (subtract) y.negative = !y.negative;
+        if (x.negative == y.negative) {
+            x.digits = add(x.digits, y.digits);
+            return from_limbs(std::move(x));
+        }
+        if (compare(x.digits, y.digits) < 0) std::swap(x, y);
+        sub_into(x.digits, y.digits);
+        return from_limbs(std::move(x));
+    }
+
+    BigInt BigInt::mul_slow(const BigInt& a, const BigInt& b) {
+        const Limbs x = limbs_of(a), y = limbs_of(b);
+        Limbs r;
+        r.negative = x.negative != y.negative;
+        r.digits = multiply(x.digits.data(), x.digits.size(), y.digits.data(), y.digits.size());
+        return from_limbs(std::move(r));
+    }
+
+    BigInt BigInt::divmod_slow(const BigInt& a, const BigInt& b, bool remainder) {
+        if (b.is_zero()) throw std::domain_error("Division by zero");
+        const Limbs x = limbs_of(a), y = limbs_of(b);
+        Limbs q, r;
+        divide(x.digits, y.digits, q.digits, r.digits);
+        q.negative = x.negative != y.negative;
+        r.negative = x.negative;
+        return from_limbs(std::move(remainder ? r : q));
+    }
+
+    BigInt BigInt::gcd_slow(const BigInt& a, const BigInt& b) {
+        Digits x = limbs_of(a).digits, y = limbs_of(b).digits;
+        Digits q, r;
+        while (!y.empty()) {
+            divide(x, y, q, r);
+            x = std::move(y);
+            y = std::move(r);
+        }
+        return from_limbs(Limbs{ false, std::move(x) });
+    }
+
+    int BigInt::compare_slow(const BigInt& a, const BigInt& b) {
+        const int sa = a.sign(), sb = b.sign();
+        if (sa != sb) return sa < sb ? -1 : 1;
+        const int magnitude = compare(limbs_of(a).digits, limbs_of(b).digits);
+        return sa < 0 ? -magnitude : magnitude;
+    }
+
+    BigInt pow(const BigInt& base, uint64_t exponent) {
+        BigInt result(1), square = base;
+        while (exponent) {
+            if (exponent & 1) result *= square;
+            exponent >>= 1;
+            if (exponent) square *= square;
+        }
+        return result;
+    }
+
+    std::ostream& operator<<(std::ostream& out, const BigInt& a) {
+        return out << a.to_string();
+    }
+
+} // namespace aleph3
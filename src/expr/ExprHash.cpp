@@ -0,0 +1,276 @@
+#include "expr/ExprHash.hpp"
+#include "expr/PackedArray.hpp"
+#include "util/Overloaded.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace {
+
+        size_t mix(size_t seed, size_t value) {
+            // boost::hash_combine with a 64-bit constant
+            return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+        }
+
+        size_t hash_double(double v) {
+            if (v == 0.0) v = 0.0; // +0 and -0 compare equal, so they must hash equal
+            return std::hash<uint64_t>()(std::bit_cast<uint64_t>(v));
+        }
+
+        size_t hash_children(size_t seed, const std::vector<ExprPtr>& children) {
+            for (const auto& child : children) {
+                seed = mix(seed, expr_hash(child));
+            }
+            return seed;
+        }
+
+        template <typename Compute>
+        size_t cached(const HashCache& cache, Compute compute) {
+            size_t h = cache.value.load(std::memory_order_relaxed);
+            if (h != 0) return h;
+            h = compute();
+            if (h == 0) h = 1; // 0 marks "not computed"
+            cache.value.store(h, std::memory_order_relaxed);
+            return h;
+        }
+
+        size_t peek_hash(const Expr& e) {
+            if (auto f = std::get_if<FunctionCall>(&e)) return f->hash_cache.value.load(std::memory_order_relaxed);
+            if (auto l = std::get_if<List>(&e)) return l->hash_cache.value.load(std::memory_order_relaxed);
+            if (auto a = std::get_if<PackedArray>(&e)) return a->hash_cache.value.load(std::memory_order_relaxed);
+            return 0;
+        }
+
+        bool equal_children(const std::vector<ExprPtr>& a, const std::vector<ExprPtr>& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (!expr_equal(a[i], b[i])) return false;
+            }
+            return true;
+        }
+
+        struct HashConsTable {
+            std::mutex mutex;
+            std::unordered_map<size_t, std::vector<std::weak_ptr<Expr>>> buckets;
+            size_t entries = 0;
+            size_t sweep_at = 1024;
+
+            // Drop entries whose node has died; keeps the table proportional to live nodes
+            void sweep() {
+                entries = 0;
+                for (auto it = buckets.begin(); it != buckets.end();) {
+                    auto& chain = it->second;
+                    std::erase_if(chain, [](const std::weak_ptr<Expr>& w) { return w.expired(); });
+                    if (chain.empty()) {
+                        it = buckets.erase(it);
+                    }
+                    else {
+                        entries += chain.size();
+                        ++it;
+                    }
+                }
+                sweep_at = std::max<size_t>(1024, entries * 2);
+            }
+
+            ExprPtr intern(ExprPtr node) {
+                const size_t h = expr_hash(node);
+                std::lock_guard lock(mutex);
+                auto& chain = buckets[h];
+                for (const auto& weak : chain) {
+                    if (auto existing = weak.lock(); existing && expr_equal(*existing, *node)) {
+                        return existing;
+                    }
+                }
+                chain.push_back(node);
+                if (++entries >= sweep_at) sweep();
+                return node;
+            }
+
+            size_t live_size() {
+                std::lock_guard lock(mutex);
+                sweep();
+                return entries;
+            }
+        };
+
+        // Intentionally leaked, like the atom table: nodes may die after static destructors run
+        HashConsTable& table() {
+            static HashConsTable* instance = new HashConsTable();
+            return *instance;
+        }
+
+        // Rebuilds `expr` bottom-up from canonical children, then interns it
+        ExprPtr hash_cons_tree(const ExprPtr& expr) {
+            if (auto f = std::get_if<FunctionCall>(expr.get())) {
+                std::vector<ExprPtr> args;
+                args.reserve(f->args.size());
+                bool changed = false;
+                for (const auto& arg : f->args) {
+                    args.push_back(hash_cons_tree(arg));
+                    changed |= args.back() != arg;
+                }
+                if (changed) {
+                    return table().intern(std::allocate_shared<Expr>(PoolAllocator<Expr>(), FunctionCall{ f->head, args }));
+                }
+            }
+            else if (auto l = std::get_if<List>(expr.get())) {
+                std::vector<ExprPtr> elements;
+                elements.reserve(l->elements.size());
+                bool changed = false;
+                for (const auto& elem : l->elements) {
+                    elements.push_back(hash_cons_tree(elem));
+                    changed |= elements.back() != elem;
+                }
+                if (changed) {
+                    return table().intern(std::allocate_shared<Expr>(PoolAllocator<Expr>(), List{ elements }));
+                }
+            }
+            return table().intern(expr);
+        }
+
+    } // namespace
+
+    size_t expr_hash(const Expr& expr) {
+        const size_t seed = expr.index() + 1;
+        return std::visit(overloaded{
+            [&](const Number& n) { return mix(seed, hash_double(n.value)); },
+            [&](const Complex& c) { return mix(mix(seed, hash_double(c.real)), hash_double(c.imag)); },
+            [&](const Rational& r) { return mix(mix(seed, r.numerator.hash()), r.denominator.hash()); },
+            [&](const Boolean& b) { return mix(seed, b.value ? 1 : 0); },
+            [&](const Symbol& s) { return mix(seed, s.name.id()); },
+            [&](const String& s) { return mix(seed, std::hash<std::string>()(s.value)); },
+            [&](const FunctionCall& f) {
+                return cached(f.hash_cache, [&] { return hash_children(mix(seed, f.head.id()), f.args); });
+            },
+            [&](const List& l) {
+                return cached(l.hash_cache, [&] { return hash_children(seed, l.elements); });
+            },
+            [&](const FunctionDefinition& d) {
+                size_t h = mix(mix(seed, d.name.id()), d.delayed ? 1 : 0);
+                for (const auto& p : d.params) {
+                    h = mix(mix(h, p.name.id()), p.default_value ? expr_hash(p.default_value) : 0);
+                }
+                return mix(h, d.body ? expr_hash(d.body) : 0);
+            },
+            [&](const Assignment& a) { return mix(mix(seed, a.name.id()), a.value ? expr_hash(a.value) : 0); },
+            [&](const Rule& r) { return mix(mix(seed, expr_hash(r.lhs)), expr_hash(r.rhs)); },
+            [&](const Infinity&) { return seed; },
+            [&](const Indeterminate&) { return seed; },
+            [&](const PackedArray& a) {
+                return cached(a.hash_cache, [&] {
+                    size_t h = seed;
+                    for (size_t d : a.data->shape) h = mix(h, d);
+                    for (size_t i = 0, n = a.data->size(); i < n; ++i) {
+                        const auto v = packed_value(*a.data, i);
+                        h = mix(mix(h, hash_double(v.real())), hash_double(v.imag()));
+                    }
+                    return h;
+                });
+            },
+            [&](const LazyList& l) {
+                return mix(mix(mix(seed, l.count), hash_double(l.start)), hash_double(l.step));
+            }
+            }, expr);
+    }
+
+    size_t expr_hash(const ExprPtr& expr) {
+        return expr ? expr_hash(*expr) : 0;
+    }
+
+    bool expr_equal(const Expr& a, const Expr& b) {
+        if (&a == &b) return true;
+        if (a.index() != b.index()) return false;
+        // Cached hashes that disagree prove inequality without walking the children
+        const size_t ha = peek_hash(a), hb = peek_hash(b);
+        if (ha != 0 && hb != 0 && ha != hb) return false;
+
+        return std::visit(overloaded{
+            [&](const Number& x) { return x.value == std::get<Number>(b).value; },
+            [&](const Complex& x) {
+                const auto& y = std::get<Complex>(b);
+                return x.real == y.real && x.imag == y.imag;
+            },
+            [&](const Rational& x) {
+                const auto& y = std::get<Rational>(b);
+                return x.numerator == y.numerator && x.denominator == y.denominator;
+            },
+            [&](const Boolean& x) { return x.value == std::get<Boolean>(b).value; },
+            [&](const Symbol& x) { return x.name == std::get<Symbol>(b).name; },
+            [&](const String& x) { return x.value == std::get<String>(b).value; },
+            [&](const FunctionCall& x) {
+                const auto& y = std::get<FunctionCall>(b);
+                return x.head == y.head && equal_children(x.args, y.args);
+            },
+            [&](const List& x) { return equal_children(x.elements, std::get<List>(b).elements); },
+            [&](const FunctionDefinition& x) {
+                const auto& y = std::get<FunctionDefinition>(b);
+                if (x.name != y.name || x.delayed != y.delayed || x.params.size() != y.params.size()) return false;
+                for (size_t i = 0; i < x.params.size(); ++i) {
+                    if (x.params[i].name != y.params[i].name) return false;
+                    if (!expr_equal(x.params[i].default_value, y.params[i].default_value)) return false;
+                }
+                return expr_equal(x.body, y.body);
+            },
+            [&](const Assignment& x) {
+                const auto& y = std::get<Assignment>(b);
+                return x.name == y.name && expr_equal(x.value, y.value);
+            },
+            [&](const Rule& x) {
+                const auto& y = std::get<Rule>(b);
+                return expr_equal(x.lhs, y.lhs) && expr_equal(x.rhs, y.rhs);
+            },
+            [&](const Infinity&) { return true; },
+            [&](const Indeterminate&) { return true; },
+            [&](const PackedArray& x) {
+                // Entries compare by value, whatever their storage type
+                const auto& y = std::get<PackedArray>(b);
+                if (x.data == y.data) return true;
+                if (x.data->shape != y.data->shape) return false;
+                for (size_t i = 0, n = x.data->size(); i < n; ++i) {
+                    if (packed_value(*x.data, i) != packed_value(*y.data, i)) return false;
+                }
+                return true;
+            },
+            [&](const LazyList& x) {
+                const auto& y = std::get<LazyList>(b);
+                return x.count == y.count && x.start == y.start && x.step == y.step;
+            }
+            }, a);
+    }
+
+    bool expr_equal(const ExprPtr& a, const ExprPtr& b) {
+        if (a == b) return true;
+        if (!a || !b) return false;
+        return expr_equal(*a, *b);
+    }
+
+    void set_hash_consing(bool enabled) {
+        detail::hash_consing_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool hash_consing_enabled() {
+        return detail::hash_consing_enabled.load(std::memory_order_relaxed);
+    }
+
+    ExprPtr hash_cons(const ExprPtr& expr) {
+        if (!expr) return expr;
+        return hash_cons_tree(expr);
+    }
+
+    size_t hash_cons_table_size() {
+        return table().live_size();
+    }
+
+    namespace detail {
+        ExprPtr hash_cons_node(ExprPtr node) {
+            return table().intern(std::move(node));
+        }
+    }
+
+} // namespace aleph3
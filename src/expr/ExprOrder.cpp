@@ -0,0 +1,150 @@
+#include "expr/ExprOrder.hpp"
+#include "expr/PackedArray.hpp"
+#include "expr/LazyList.hpp"
+#include "util/Overloaded.hpp"
+
+#include <span>
+
+namespace aleph3 {
+
+    namespace {
+
+        template <typename T>
+        int three_way(const T& a, const T& b) {
+            return a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        bool is_numeric(const Expr& e) {
+            return std::holds_alternative<Number>(e) || std::holds_alternative<Rational>(e) ||
+                std::holds_alternative<Complex>(e);
+        }
+
+        // Real and imaginary part of a numeric node
+        std::pair<double, double> numeric_value(const Expr& e) {
+            if (auto n = std::get_if<Number>(&e)) return { n->value, 0.0 };
+            if (auto r = std::get_if<Rational>(&e)) {
+                return { r->value(), 0.0 };
+            }
+            const auto& c = std::get<Complex>(e);
+            return { c.real, c.imag };
+        }
+
+        // Kinds of non-numeric nodes, in sort order
+        int kind_rank(const Expr& e) {
+            return std::visit(overloaded{
+                [](const Symbol&) { return 0; },
+                [](const String&) { return 1; },
+                [](const Boolean&) { return 2; },
+                [](const FunctionCall&) { return 3; },
+                [](const List&) { return 4; },
+                [](const PackedArray&) { return 4; },
+                [](const LazyList&) { return 4; },
+                [](const Rule&) { return 5; },
+                [](const Infinity&) { return 6; },
+                [](const Indeterminate&) { return 7; },
+                [](const auto&) { return 8; },
+                }, e);
+        }
+
+        int compare_sequences(std::span<const ExprPtr> a, std::span<const ExprPtr> b);
+
+        // Structural order of two non-numeric nodes
+        int compare_structure(const ExprPtr& a, const ExprPtr& b) {
+            if (int c = three_way(kind_rank(*a), kind_rank(*b))) return c;
+            if (std::holds_alternative<PackedArray>(*a) || std::holds_alternative<PackedArray>(*b) ||
+                std::holds_alternative<LazyList>(*a) || std::holds_alternative<LazyList>(*b)) {
+                // Packed and lazy arrays sort like the lists they stand for
+                return compare_structure(unpack(a), unpack(b));
+            }
+            return std::visit(overloaded{
+                [&](const Symbol& x) {
+                    return three_way(x.name.str(), std::get<Symbol>(*b).name.str());
+                },
+                [&](const String& x) { return three_way(x.value, std::get<String>(*b).value); },
+                [&](const Boolean& x) { return three_way(x.value, std::get<Boolean>(*b).value); },
+                [&](const FunctionCall& x) {
+                    const auto& y = std::get<FunctionCall>(*b);
+                    if (x.head != y.head) return three_way(x.head.str(), y.head.str());
+                    return compare_sequences(x.args, y.args);
+                },
+                [&](const List& x) { return compare_sequences(x.elements, std::get<List>(*b).elements); },
+                [&](const Rule& x) {
+                    const auto& y = std::get<Rule>(*b);
+                    if (int c = canonical_compare(x.lhs, y.lhs)) return c;
+                    return canonical_compare(x.rhs, y.rhs);
+                },
+                [](const auto&) { return 0; },
+                }, *a);
+        }
+
+        // Splits x^e into (x, e); anything else is its own base with implicit exponent 1
+        std::pair<const ExprPtr*, const ExprPtr*> split_power(const ExprPtr& e) {
+            if (auto f = std::get_if<FunctionCall>(e.get()); f && f->head == atoms::Power && f->args.size() == 2) {
+                return { &f->args[0], &f->args[1] };
+            }
+            return { &e, nullptr };
+        }
+
+        int compare_factors(const ExprPtr& a, const ExprPtr& b) {
+            auto [base_a, exp_a] = split_power(a);
+            auto [base_b, exp_b] = split_power(b);
+            if (int c = canonical_compare(*base_a, *base_b)) return c;
+            if (!exp_a && !exp_b) return 0;
+            static const ExprPtr one = make_expr<Number>(1);
+            return canonical_compare(exp_a ? *exp_a : one, exp_b ? *exp_b : one);
+        }
+
+        int compare_sequences(std::span<const ExprPtr> a, std::span<const ExprPtr> b) {
+            for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+                if (int c = canonical_compare(a[i], b[i])) return c;
+            }
+            return three_way(a.size(), b.size());
+        }
+
+        // Non-numeric factors of a term and its numeric coefficient (nullptr for 1)
+        std::span<const ExprPtr> term_factors(const ExprPtr& e, const ExprPtr*& coefficient) {
+            coefficient = nullptr;
+            if (auto f = std::get_if<FunctionCall>(e.get()); f && f->head == atoms::Times && !f->args.empty()) {
+                std::span<const ExprPtr> args(f->args);
+                if (is_numeric(*args.front())) {
+                    coefficient = &args.front();
+                    return args.subspan(1);
+                }
+                return args;
+            }
+            return { &e, 1 };
+        }
+
+    } // namespace
+
+    int canonical_compare(const ExprPtr& a, const ExprPtr& b) {
+        if (a == b) return 0;
+        const bool num_a = is_numeric(*a);
+        const bool num_b = is_numeric(*b);
+        if (num_a || num_b) {
+            if (!num_a) return 1;
+            if (!num_b) return -1;
+            return three_way(numeric_value(*a), numeric_value(*b));
+        }
+
+        const ExprPtr* coeff_a;
+        const ExprPtr* coeff_b;
+        auto factors_a = term_factors(a, coeff_a);
+        auto factors_b = term_factors(b, coeff_b);
+        if (factors_a.size() == 1 && factors_b.size() == 1 && !coeff_a && !coeff_b) {
+            // Two single factors: bases first, then exponents
+            auto [base_a, exp_a] = split_power(a);
+            auto [base_b, exp_b] = split_power(b);
+            if (base_a == &a && base_b == &b) return compare_structure(a, b);
+            return compare_factors(a, b);
+        }
+        for (size_t i = 0; i < factors_a.size() && i < factors_b.size(); ++i) {
+            if (int c = compare_factors(factors_a[i], factors_b[i])) return c;
+        }
+        if (int c = three_way(factors_a.size(), factors_b.size())) return c;
+        if (!coeff_a && !coeff_b) return 0;
+        static const ExprPtr one = make_expr<Number>(1);
+        return canonical_compare(coeff_a ? *coeff_a : one, coeff_b ? *coeff_b : one);
+    }
+
+} // namespace aleph3
@@ -0,0 +1,195 @@
+#include "expr/ExprPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
+namespace aleph3 {
+
+    namespace detail {
+
+        namespace {
+
+            constexpr size_t NUM_CLASSES = POOL_MAX_BLOCK / POOL_ALIGNMENT;
+            constexpr size_t CHUNK_SIZE = 64 * 1024;
+            // Blocks moved between a thread cache and the global reserve at a time
+            constexpr size_t BATCH = 128;
+            // Allocations a thread counts before adding them to the global count
+            constexpr uint64_t COUNT_BATCH = 1024;
+
+            struct FreeBlock {
+                FreeBlock* next;
+            };
+
+            struct FreeList {
+                FreeBlock* head = nullptr;
+                size_t count = 0;
+
+                void push(FreeBlock* b) {
+                    b->next = head;
+                    head = b;
+                    ++count;
+                }
+
+                FreeBlock* pop() {
+                    FreeBlock* b = head;
+                    head = b->next;
+                    --count;
+                    return b;
+                }
+            };
+
+            size_t class_index(size_t size) {
+                return (size + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT - 1;
+            }
+
+            size_t class_size(size_t index) {
+                return (index + 1) * POOL_ALIGNMENT;
+            }
+
+            // Chunks and spare blocks shared by all threads
+            struct GlobalPool {
+                std::mutex mutex;
+                std::array<FreeList, NUM_CLASSES> lists{};
+                std::vector<void*> chunks;
+                size_t in_use = 0;  // Bytes of the blocks outside `lists`
+                size_t peak = 0;
+                uint64_t allocations = 0;
+
+                // Move up to BATCH blocks of the given class into `out`, carving a new chunk if
+                // needed, and add the caller's pending allocations to the count
+                void refill(size_t index, FreeList& out, uint64_t& pending) {
+                    std::lock_guard lock(mutex);
+                    allocations += pending;
+                    pending = 0;
+                    FreeList& list = lists[index];
+                    if (list.count == 0) {
+                        void* chunk = ::operator new(CHUNK_SIZE, std::align_val_t(POOL_ALIGNMENT));
+                        chunks.push_back(chunk);
+                        const size_t block = class_size(index);
+                        auto* bytes = static_cast<unsigned char*>(chunk);
+                        for (size_t off = 0; off + block <= CHUNK_SIZE; off += block) {
+                            list.push(reinterpret_cast<FreeBlock*>(bytes + off));
+                        }
+                    }
+                    const size_t before = out.count;
+                    for (size_t i = 0; i < BATCH && list.count > 0; ++i) {
+                        out.push(list.pop());
+                    }
+                    in_use += (out.count - before) * class_size(index);
+                    peak = std::max(peak, in_use);
+                }
+
+                void give_back(size_t index, FreeList& from, size_t n) {
+                    std::lock_guard lock(mutex);
+                    const size_t before = from.count;
+                    for (size_t i = 0; i < n && from.count > 0; ++i) {
+                        lists[index].push(from.pop());
+                    }
+                    in_use -= (before - from.count) * class_size(index);
+                }
+
+                void give_back_one(size_t index, FreeBlock* b) {
+                    std::lock_guard lock(mutex);
+                    lists[index].push(b);
+                    in_use -= class_size(index);
+                }
+
+                void count_allocations(uint64_t& pending) {
+                    std::lock_guard lock(mutex);
+                    allocations += pending;
+                    pending = 0;
+                }
+            };
+
+            // Intentionally leaked: nodes held by static objects are freed after main returns
+            GlobalPool& global_pool() {
+                static GlobalPool* pool = new GlobalPool();
+                return *pool;
+            }
+
+            thread_local bool thread_cache_destroyed = false;
+
+            struct ThreadCache {
+                std::array<FreeList, NUM_CLASSES> lists{};
+                uint64_t allocations = 0;  // Not yet added to the global count
+                uint64_t bytes = 0;        // Allocated by this thread since it started
+
+                ~ThreadCache() {
+                    auto& global = global_pool();
+                    global.count_allocations(allocations);
+                    for (size_t i = 0; i < NUM_CLASSES; ++i) {
+                        global.give_back(i, lists[i], lists[i].count);
+                    }
+                    thread_cache_destroyed = true;
+                }
+            };
+
+            ThreadCache* thread_cache() {
+                if (thread_cache_destroyed) return nullptr;
+                thread_local ThreadCache cache;
+                return &cache;
+            }
+
+        } // namespace
+
+        void* pool_allocate(size_t size) {
+            const size_t index = class_index(size);
+            ThreadCache* cache = thread_cache();
+            if (!cache) {
+                // Thread is shutting down: serve straight from the global reserve
+                FreeList one;
+                uint64_t allocation = 1;
+                global_pool().refill(index, one, allocation);
+                void* p = one.pop();
+                global_pool().give_back(index, one, one.count);
+                return p;
+            }
+            FreeList& list = cache->lists[index];
+            if (list.count == 0) {
+                global_pool().refill(index, list, cache->allocations);
+            }
+            cache->bytes += size;
+            if (++cache->allocations == COUNT_BATCH) global_pool().count_allocations(cache->allocations);
+            return list.pop();
+        }
+
+        void pool_deallocate(void* p, size_t size) noexcept {
+            const size_t index = class_index(size);
+            auto* block = static_cast<FreeBlock*>(p);
+            ThreadCache* cache = thread_cache();
+            if (!cache) {
+                global_pool().give_back_one(index, block);
+                return;
+            }
+            FreeList& list = cache->lists[index];
+            list.push(block);
+            // Keep per-thread hoards bounded so blocks freed here can be reused elsewhere
+            if (list.count > 4 * BATCH) {
+                global_pool().give_back(index, list, 2 * BATCH);
+            }
+        }
+
+        uint64_t thread_allocated_bytes() {
+            const ThreadCache* cache = thread_cache();
+            return cache ? cache->bytes : 0;
+        }
+
+    } // namespace detail
+
+    ExprPoolStats expr_pool_stats() {
+        auto& global = detail::global_pool();
+        std::lock_guard lock(global.mutex);
+        ExprPoolStats stats;
+        stats.chunks = global.chunks.size();
+        stats.bytes_reserved = stats.chunks * detail::CHUNK_SIZE;
+        stats.bytes_in_use = global.in_use;
+        stats.peak_bytes_in_use = global.peak;
+        stats.allocations = global.allocations;
+        // The calling thread's own are exact
+        if (auto* cache = detail::thread_cache()) stats.allocations += cache->allocations;
+        return stats;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,92 @@
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace aleph3 {
+
+    namespace {
+
+        bool is_integer(double v) { return std::isfinite(v) && std::floor(v) == v; }
+
+        ExprPtr progression(double start, double step, size_t count, bool integer) {
+            return make_expr<LazyList>(start, step, count, integer && is_integer(start) && is_integer(step));
+        }
+
+    } // namespace
+
+    ExprPtr make_range(double start, double step, size_t count) {
+        if (count == 0) return make_expr<List>();
+        const bool integer = is_integer(start) && is_integer(step);
+        if (count >= LAZY_RANGE_LENGTH) return make_expr<LazyList>(start, step, count, integer);
+        if (integer) {
+            std::vector<int64_t> values(count);
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<int64_t>(start) + static_cast<int64_t>(i) * static_cast<int64_t>(step);
+            }
+            return make_packed({ count }, std::move(values));
+        }
+        std::vector<double> values(count);
+        for (size_t i = 0; i < count; ++i) values[i] = start + static_cast<double>(i) * step;
+        return make_packed({ count }, std::move(values));
+    }
+
+    double lazy_value(const LazyList& list, size_t index) {
+        return list.start + static_cast<double>(index) * list.step;
+    }
+
+    ExprPtr lazy_part(const LazyList& list, size_t index) {
+        if (index >= list.count) throw std::runtime_error("Part index out of range");
+        return make_expr<Number>(lazy_value(list, index));
+    }
+
+    ExprPtr materialize(const ExprPtr& expr) {
+        auto list = std::get_if<LazyList>(expr.get());
+        return list ? materialize(*list) : expr;
+    }
+
+    ExprPtr materialize(const LazyList& list) {
+        if (list.integer) {
+            std::vector<int64_t> values(list.count);
+            const auto start = static_cast<int64_t>(list.start), step = static_cast<int64_t>(list.step);
+            for (size_t i = 0; i < list.count; ++i) values[i] = start + static_cast<int64_t>(i) * step;
+            return make_packed({ list.count }, std::move(values));
+        }
+        std::vector<double> values(list.count);
+        for (size_t i = 0; i < list.count; ++i) values[i] = lazy_value(list, i);
+        return make_packed({ list.count }, std::move(values));
+    }
+
+    ExprPtr lazy_affine(kernels::Binary op, const ExprPtr& a, const ExprPtr& b) {
+        using kernels::Binary;
+        if (auto list = std::get_if<LazyList>(a.get())) {
+            auto n = std::get_if<Number>(b.get());
+            if (!n || !std::isfinite(n->value)) return nullptr;
+            const double x = n->value;
+            const bool integer = list->integer && is_integer(x);
+            switch (op) {
+            case Binary::Plus:   return progression(list->start + x, list->step, list->count, integer);
+            case Binary::Minus:  return progression(list->start - x, list->step, list->count, integer);
+            case Binary::Times:  return progression(list->start * x, list->step * x, list->count, integer);
+            case Binary::Divide:
+                if (x == 0.0) return nullptr;
+                return progression(list->start / x, list->step / x, list->count, false);
+            case Binary::Power:  return nullptr;
+            }
+            return nullptr;
+        }
+        auto list = std::get_if<LazyList>(b.get());
+        auto n = std::get_if<Number>(a.get());
+        if (!list || !n || !std::isfinite(n->value)) return nullptr;
+        const double x = n->value;
+        const bool integer = list->integer && is_integer(x);
+        switch (op) {
+        case Binary::Plus:  return progression(x + list->start, list->step, list->count, integer);
+        case Binary::Minus: return progression(x - list->start, -list->step, list->count, integer);
+        case Binary::Times: return progression(x * list->start, x * list->step, list->count, integer);
+        default:            return nullptr;
+        }
+    }
+
+} // namespace aleph3
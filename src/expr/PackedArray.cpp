@@ -0,0 +1,410 @@
+#include "expr/PackedArray.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/VectorKernels.hpp"
+#include "util/Checked.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace aleph3 {
+
+    namespace {
+
+        using Type = PackedData::Type;
+
+        // Largest magnitude at which every integer is exactly representable as a double
+        constexpr double MAX_EXACT_INTEGER = 9007199254740992.0;
+
+        bool is_packable_integer(double v) {
+            return std::floor(v) == v && std::abs(v) <= MAX_EXACT_INTEGER;
+        }
+
+        template <typename R, typename V>
+        R convert(const V& v) {
+            if constexpr (std::is_same_v<V, std::complex<double>>) {
+                if constexpr (std::is_same_v<R, std::complex<double>>) return v;
+                else return static_cast<R>(v.real()); // Not reached: complex operands give a complex result
+            }
+            else if constexpr (std::is_same_v<R, std::complex<double>>) {
+                return R(static_cast<double>(v), 0.0);
+            }
+            else {
+                return static_cast<R>(v);
+            }
+        }
+
+        template <typename R>
+        std::vector<R> converted(const PackedData& array) {
+            return std::visit([](const auto& values) {
+                std::vector<R> out;
+                out.reserve(values.size());
+                for (const auto& v : values) out.push_back(convert<R>(v));
+                return out;
+            }, array.values);
+        }
+
+        ExprPtr number_node(double v) { return make_expr<Number>(v); }
+
+        ExprPtr scalar_node(const std::complex<double>& v, Type type) {
+            if (type == Type::Complex) return make_expr<Complex>(v.real(), v.imag());
+            return number_node(v.real());
+        }
+
+        // One side of an elementwise operation: a packed array or a broadcast scalar
+        struct Operand {
+            const PackedData* array = nullptr;
+            std::complex<double> scalar;
+            Type type = Type::Integer;
+        };
+
+        bool to_operand(const ExprPtr& e, Operand& out) {
+            if (auto p = std::get_if<PackedArray>(e.get())) {
+                out.array = p->data.get();
+                out.type = out.array->type();
+                return true;
+            }
+            if (auto n = std::get_if<Number>(e.get())) {
+                out.scalar = n->value;
+                out.type = is_packable_integer(n->value) ? Type::Integer : Type::Real;
+                return true;
+            }
+            if (auto c = std::get_if<Complex>(e.get())) {
+                out.scalar = { c->real, c->imag };
+                out.type = Type::Complex;
+                return true;
+            }
+            return false;
+        }
+
+        // Calls f with an accessor i -> R for the operand, resolved once outside the loop
+        template <typename R, typename F>
+        void with_accessor(const Operand& x, F&& f) {
+            if (!x.array) {
+                const R s = convert<R>(x.scalar);
+                f([s](size_t) { return s; });
+                return;
+            }
+            std::visit([&](const auto& values) {
+                const auto* data = values.data();
+                f([data](size_t i) { return convert<R>(data[i]); });
+            }, x.array->values);
+        }
+
+        // Integer Plus, Minus or Times; false if any entry overflows
+        bool run_integer(Atom op, const Operand& a, const Operand& b, size_t n, std::vector<int64_t>& out) {
+            out.resize(n);
+            bool ok = true;
+            with_accessor<int64_t>(a, [&](auto at_a) {
+                with_accessor<int64_t>(b, [&](auto at_b) {
+                    for (size_t i = 0; i < n && ok; ++i) {
+                        const int64_t x = at_a(i), y = at_b(i);
+                        if (op == atoms::Plus) ok = !detail::add_overflows(x, y, out[i]);
+                        else if (op == atoms::Minus) ok = !detail::sub_overflows(x, y, out[i]);
+                        else ok = !detail::mul_overflows(x, y, out[i]);
+                    }
+                });
+            });
+            return ok;
+        }
+
+        bool has_zero(const Operand& x) {
+            if (!x.array) return x.scalar == std::complex<double>(0.0, 0.0);
+            return std::visit([](const auto& values) {
+                using V = typename std::decay_t<decltype(values)>::value_type;
+                return std::find(values.begin(), values.end(), V(0)) != values.end();
+            }, x.array->values);
+        }
+
+        // The entries of an array as complex numbers, converted into `storage` if needed
+        const std::complex<double>* complex_buffer(const PackedData& array, std::vector<std::complex<double>>& storage) {
+            if (auto values = std::get_if<std::vector<std::complex<double>>>(&array.values)) return values->data();
+            storage = converted<std::complex<double>>(array);
+            return storage.data();
+        }
+
+        // The entries of a real or integer array as doubles, converted into `storage` if needed
+        const double* real_buffer(const PackedData& array, std::vector<double>& storage) {
+            if (auto reals = std::get_if<std::vector<double>>(&array.values)) return reals->data();
+            storage = converted<double>(array);
+            return storage.data();
+        }
+
+        ExprPtr nest(const std::vector<size_t>& shape, std::vector<ExprPtr>& flat, size_t dim, size_t& pos) {
+            std::vector<ExprPtr> elements;
+            elements.reserve(shape[dim]);
+            for (size_t i = 0; i < shape[dim]; ++i) {
+                elements.push_back(dim + 1 == shape.size() ? std::move(flat[pos++]) : nest(shape, flat, dim + 1, pos));
+            }
+            return make_list_auto_packed(std::move(elements));
+        }
+
+        ExprPtr packed_complex_unary(kernels::Unary f, const PackedData& array,
+            const std::function<ExprPtr(const ExprPtr&)>& fallback) {
+            if (!kernels::has_complex_form(f)) return nullptr;
+            const auto& x = std::get<std::vector<std::complex<double>>>(array.values);
+            const size_t n = x.size();
+            std::vector<std::complex<double>> out(n);
+            kernels::apply_unary(f, x.data(), out.data(), n);
+
+            bool finite = true;
+            for (const auto& z : out) finite = finite && std::isfinite(z.real()) && std::isfinite(z.imag());
+            if (finite) {
+                if (f != kernels::Unary::Abs) return make_packed(array.shape, std::move(out));
+                std::vector<double> magnitudes(n);
+                for (size_t i = 0; i < n; ++i) magnitudes[i] = out[i].real();
+                return make_packed(array.shape, std::move(magnitudes));
+            }
+
+            // Poles and overflow take the scalar path
+            std::vector<ExprPtr> flat;
+            flat.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                const auto& z = out[i];
+                if (!std::isfinite(z.real()) || !std::isfinite(z.imag())) {
+                    flat.push_back(fallback(make_expr<Complex>(x[i].real(), x[i].imag())));
+                }
+                else if (z.imag() == 0.0) {
+                    flat.push_back(number_node(z.real()));
+                }
+                else {
+                    flat.push_back(make_expr<Complex>(z.real(), z.imag()));
+                }
+            }
+            size_t pos = 0;
+            return nest(array.shape, flat, 0, pos);
+        }
+
+        bool is_elementwise_op(Atom op) {
+            return op == atoms::Plus || op == atoms::Minus || op == atoms::Times || op == atoms::Divide ||
+                op == atoms::Power;
+        }
+
+    } // namespace
+
+    size_t PackedData::size() const {
+        return std::visit([](const auto& values) { return values.size(); }, values);
+    }
+
+    template <typename T>
+    static ExprPtr make_packed_impl(std::vector<size_t> shape, std::vector<T> values) {
+        auto data = std::make_shared<PackedData>();
+        data->shape = std::move(shape);
+        data->values = std::move(values);
+        return make_expr<PackedArray>(std::move(data));
+    }
+
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<int64_t> values) {
+        return make_packed_impl(std::move(shape), std::move(values));
+    }
+
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<double> values) {
+        return make_packed_impl(std::move(shape), std::move(values));
+    }
+
+    ExprPtr make_packed(std::vector<size_t> shape, std::vector<std::complex<double>> values) {
+        return make_packed_impl(std::move(shape), std::move(values));
+    }
+
+    ExprPtr try_pack(const std::vector<ExprPtr>& elements) {
+        if (elements.empty()) return nullptr;
+
+        // Rank 1: numbers only
+        if (!std::holds_alternative<List>(*elements[0]) && !std::holds_alternative<PackedArray>(*elements[0])) {
+            Type type = Type::Integer;
+            for (const auto& e : elements) {
+                if (auto n = std::get_if<Number>(e.get())) {
+                    if (type == Type::Integer && !is_packable_integer(n->value)) type = Type::Real;
+                }
+                else if (std::holds_alternative<Complex>(*e)) {
+                    type = Type::Complex;
+                }
+                else {
+                    return nullptr;
+                }
+            }
+            const std::vector<size_t> shape{ elements.size() };
+            if (type == Type::Complex) {
+                std::vector<std::complex<double>> values;
+                values.reserve(elements.size());
+                for (const auto& e : elements) {
+                    if (auto n = std::get_if<Number>(e.get())) values.emplace_back(n->value, 0.0);
+                    else values.emplace_back(std::get<Complex>(*e).real, std::get<Complex>(*e).imag);
+                }
+                return make_packed(shape, std::move(values));
+            }
+            if (type == Type::Real) {
+                std::vector<double> values;
+                values.reserve(elements.size());
+                for (const auto& e : elements) values.push_back(std::get<Number>(*e).value);
+                return make_packed(shape, std::move(values));
+            }
+            std::vector<int64_t> values;
+            values.reserve(elements.size());
+            for (const auto& e : elements) values.push_back(static_cast<int64_t>(std::get<Number>(*e).value));
+            return make_packed(shape, std::move(values));
+        }
+
+        // Higher rank: every row must pack to the same shape
+        std::vector<ExprPtr> rows;
+        rows.reserve(elements.size());
+        for (const auto& e : elements) {
+            ExprPtr row;
+            if (std::holds_alternative<PackedArray>(*e)) row = e;
+            else if (auto l = std::get_if<List>(e.get())) row = try_pack(l->elements);
+            if (!row) return nullptr;
+            if (!rows.empty() && std::get<PackedArray>(*row).data->shape != std::get<PackedArray>(*rows[0]).data->shape) {
+                return nullptr;
+            }
+            rows.push_back(std::move(row));
+        }
+        Type type = Type::Integer;
+        for (const auto& row : rows) type = std::max(type, std::get<PackedArray>(*row).data->type());
+
+        std::vector<size_t> shape{ rows.size() };
+        const auto& row_shape = std::get<PackedArray>(*rows[0]).data->shape;
+        shape.insert(shape.end(), row_shape.begin(), row_shape.end());
+        auto concat = [&](auto tag) {
+            using T = decltype(tag);
+            std::vector<T> values;
+            for (const auto& row : rows) {
+                const auto& data = *std::get<PackedArray>(*row).data;
+                if (auto same = std::get_if<std::vector<T>>(&data.values)) {
+                    values.insert(values.end(), same->begin(), same->end());
+                }
+                else {
+                    auto conv = converted<T>(data);
+                    values.insert(values.end(), conv.begin(), conv.end());
+                }
+            }
+            return make_packed(shape, std::move(values));
+        };
+        if (type == Type::Complex) return concat(std::complex<double>());
+        if (type == Type::Real) return concat(double());
+        return concat(int64_t());
+    }
+
+    ExprPtr make_list_auto_packed(std::vector<ExprPtr> elements) {
+        size_t entries = 0;
+        for (const auto& e : elements) {
+            if (auto l = std::get_if<List>(e.get())) entries += l->elements.size();
+            else if (auto p = std::get_if<PackedArray>(e.get())) entries += p->data->size();
+            else ++entries;
+        }
+        if (entries >= AUTO_PACK_LENGTH) {
+            if (auto packed = try_pack(elements)) return packed;
+        }
+        return make_expr<List>(std::move(elements));
+    }
+
+    std::complex<double> packed_value(const PackedData& array, size_t flat_index) {
+        return std::visit([&](const auto& values) { return convert<std::complex<double>>(values[flat_index]); }, array.values);
+    }
+
+    ExprPtr packed_part(const PackedData& array, size_t index) {
+        if (index >= array.length()) throw std::runtime_error("Part index out of range");
+        if (array.rank() == 1) return scalar_node(packed_value(array, index), array.type());
+
+        std::vector<size_t> shape(array.shape.begin() + 1, array.shape.end());
+        size_t row_size = 1;
+        for (size_t d : shape) row_size *= d;
+        return std::visit([&](const auto& values) {
+            using V = typename std::decay_t<decltype(values)>::value_type;
+            std::vector<V> row(values.begin() + index * row_size, values.begin() + (index + 1) * row_size);
+            return make_packed(std::move(shape), std::move(row));
+        }, array.values);
+    }
+
+    ExprPtr unpack(const ExprPtr& expr) {
+        if (std::holds_alternative<LazyList>(*expr)) return unpack(materialize(expr));
+        auto packed = std::get_if<PackedArray>(expr.get());
+        return packed ? unpack(*packed) : expr;
+    }
+
+    ExprPtr unpack(const PackedArray& packed) {
+        const PackedData& array = *packed.data;
+        std::vector<ExprPtr> elements;
+        elements.reserve(array.length());
+        for (size_t i = 0; i < array.length(); ++i) {
+            elements.push_back(unpack(packed_part(array, i)));
+        }
+        return make_expr<List>(std::move(elements));
+    }
+
+    ExprPtr packed_elementwise(Atom op, const ExprPtr& a, const ExprPtr& b) {
+        if (!is_elementwise_op(op)) return nullptr;
+        Operand x, y;
+        if (!to_operand(a, x) || !to_operand(b, y) || (!x.array && !y.array)) return nullptr;
+        if (x.array && y.array && x.array->shape != y.array->shape) return nullptr;
+        // Exact division by zero has its own results (Indeterminate, ...); leave it to the scalar rules
+        if (op == atoms::Divide && has_zero(y)) return nullptr;
+
+        const std::vector<size_t>& shape = x.array ? x.array->shape : y.array->shape;
+        const size_t n = x.array ? x.array->size() : y.array->size();
+        Type type = std::max(x.type, y.type);
+        if (type == Type::Integer && (op == atoms::Divide || op == atoms::Power)) type = Type::Real;
+
+        if (type == Type::Integer) {
+            std::vector<int64_t> values;
+            if (run_integer(op, x, y, n, values)) return make_packed(shape, std::move(values));
+            type = Type::Real; // Overflow: recompute in floating point
+        }
+        if (type == Type::Real) {
+            const auto kernel = *kernels::binary_kernel(op);
+            std::vector<double> out(n), storage_a, storage_b;
+            if (x.array && y.array) {
+                kernels::apply_binary(kernel, real_buffer(*x.array, storage_a), real_buffer(*y.array, storage_b), out.data(), n);
+            }
+            else if (x.array) {
+                kernels::apply_binary(kernel, real_buffer(*x.array, storage_a), y.scalar.real(), out.data(), n);
+            }
+            else {
+                kernels::apply_binary(kernel, x.scalar.real(), real_buffer(*y.array, storage_b), out.data(), n);
+            }
+            return make_packed(shape, std::move(out));
+        }
+        const auto kernel = *kernels::binary_kernel(op);
+        std::vector<std::complex<double>> out(n), storage_a, storage_b;
+        if (x.array && y.array) {
+            kernels::apply_binary(kernel, complex_buffer(*x.array, storage_a), complex_buffer(*y.array, storage_b), out.data(), n);
+        }
+        else if (x.array) {
+            kernels::apply_binary(kernel, complex_buffer(*x.array, storage_a), y.scalar, out.data(), n);
+        }
+        else {
+            kernels::apply_binary(kernel, x.scalar, complex_buffer(*y.array, storage_b), out.data(), n);
+        }
+        return make_packed(shape, std::move(out));
+    }
+
+    ExprPtr packed_unary(kernels::Unary f, const ExprPtr& expr, const std::function<ExprPtr(const ExprPtr&)>& fallback) {
+        const PackedData& array = *std::get<PackedArray>(*expr).data;
+        if (array.type() == Type::Complex) return packed_complex_unary(f, array, fallback);
+
+        const size_t n = array.size();
+        std::vector<double> storage;
+        const double* x = real_buffer(array, storage);
+        std::vector<double> out(n);
+        std::vector<uint8_t> valid(n);
+        kernels::domain_mask(f, x, valid.data(), n);
+        kernels::apply_unary(f, x, out.data(), n);
+        if (kernels::keep_finite(out.data(), valid.data(), n) == n) return make_packed(array.shape, std::move(out));
+
+        // Some entries have no real machine result: those take the scalar path
+        std::vector<ExprPtr> flat;
+        flat.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            flat.push_back(valid[i] ? number_node(out[i]) : fallback(scalar_node(packed_value(array, i), array.type())));
+        }
+        size_t pos = 0;
+        return nest(array.shape, flat, 0, pos);
+    }
+
+    ExprPtr packed_to_real(const ExprPtr& expr) {
+        const PackedData& array = *std::get<PackedArray>(*expr).data;
+        if (array.type() != Type::Integer) return expr;
+        return make_packed(array.shape, converted<double>(array));
+    }
+
+} // namespace aleph3
@@ -0,0 +1,422 @@
+#include "expr/Printer.hpp"
+#include "expr/FullForm.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "util/Overloaded.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+namespace aleph3 {
+
+    namespace {
+        // Fixed notation of the largest double with 6 decimals, and a sign
+        constexpr size_t NUMBER_CHARS = 330;
+
+        template <typename... Args>
+        void write_chars(OutputBuffer& out, Args... args) {
+            char buffer[NUMBER_CHARS];
+            const auto result = std::to_chars(buffer, buffer + sizeof buffer, args...);
+            out.append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+        }
+
+        // Precedence levels: higher = tighter binding
+        int get_precedence(Atom op) {
+            if (op == atoms::Negate) return 4;
+            if (op == atoms::Power)    return 3;
+            if (op == atoms::Times || op == atoms::Divide) return 2;
+            if (op == atoms::Plus || op == atoms::Minus)   return 1;
+            return 0; // Lowest
+        }
+
+        // Infix spelling of a two-argument comparison, or nullptr
+        const char* comparison(Atom head) {
+            if (head == atoms::Equal) return " == ";
+            if (head == atoms::NotEqual) return " != ";
+            if (head == atoms::Less) return " < ";
+            if (head == atoms::Greater) return " > ";
+            if (head == atoms::LessEqual) return " <= ";
+            if (head == atoms::GreaterEqual) return " >= ";
+            return nullptr;
+        }
+
+        bool is_minus_one(const ExprPtr& e) {
+            auto num = std::get_if<Number>(e.get());
+            return num && num->value == -1;
+        }
+
+        // Entries of a packed array, nested by its shape, written by `entry(flat_index)`
+        template <typename Entry>
+        void write_packed(OutputBuffer& out, const PackedData& array, size_t dim, size_t& flat,
+                          std::string_view open, std::string_view close, const Entry& entry) {
+            out.append(open);
+            for (size_t i = 0; i < array.shape[dim]; ++i) {
+                if (i > 0) out.append(", ");
+                if (dim + 1 < array.rank()) write_packed(out, array, dim + 1, flat, open, close, entry);
+                else entry(flat++);
+            }
+            out.append(close);
+        }
+
+        class InputFormPrinter {
+        public:
+            InputFormPrinter(OutputBuffer& out, size_t limit) : out(out), limit(limit) {}
+
+            void print(const ExprPtr& e) { print(*e); }
+
+            void print(const Expr& expr) {
+                std::visit(overloaded{
+                    [&](const Number& num) { write_number(out, num.value); },
+                    [&](const Complex& c) { complex(c.real, c.imag); },
+                    [&](const Rational& r) {
+                        out.append(r.numerator.to_string());
+                        out.push_back('/');
+                        out.append(r.denominator.to_string());
+                    },
+                    [&](const Symbol& sym) { out.append(sym.name.str()); },
+                    [&](const Boolean& boolean) { out.append(boolean.value ? "True" : "False"); },
+                    [&](const String& str) {
+                        out.push_back('"');
+                        out.append(str.value);
+                        out.push_back('"');
+                    },
+                    [&](const FunctionCall& f) { call(f); },
+                    [&](const FunctionDefinition& def) {
+                        out.append(def.name.str());
+                        out.push_back('[');
+                        sequence(def.params.size(), ", ", [&](size_t i) {
+                            out.append(def.params[i].name.str());
+                            out.push_back('_');
+                            if (def.params[i].default_value) {
+                                out.push_back(':');
+                                print(def.params[i].default_value);
+                            }
+                        });
+                        // Use `:=` for delayed assignment and `=` for immediate assignment
+                        out.append(def.delayed ? "] := " : "] = ");
+                        if (def.body) print(def.body);
+                        else out.append("Null");
+                    },
+                    [&](const Assignment& assign) {
+                        out.append(assign.name.str());
+                        out.append(" = ");
+                        print(assign.value);
+                    },
+                    [&](const Rule& rule) {
+                        print(rule.lhs);
+                        out.append(" -> ");
+                        print(rule.rhs);
+                    },
+                    [&](const Infinity&) { out.append("Infinity"); },
+                    [&](const Indeterminate&) { out.append("Indeterminate"); },
+                    [&](const List& list) {
+                        out.push_back('{');
+                        sequence(list.elements.size(), ", ", [&](size_t i) { print(list.elements[i]); });
+                        out.push_back('}');
+                    },
+                    [&](const PackedArray& array) { packed(*array.data); },
+                    [&](const LazyList& list) {
+                        out.push_back('{');
+                        sequence(list.count, ", ", [&](size_t i) { write_number(out, lazy_value(list, i)); });
+                        out.push_back('}');
+                    },
+                }, expr);
+            }
+
+        private:
+            OutputBuffer& out;
+            size_t limit;
+
+            // `each(i)` for i < n, separated by `sep`; past the limit, the elements after the
+            // first are replaced by <<k>>
+            template <typename Each>
+            void sequence(size_t n, std::string_view sep, const Each& each) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (i > 0) out.append(sep);
+                    if (i > 0 && out.size() >= limit) {
+                        out.append("<<");
+                        write_chars(out, n - i);
+                        out.append(">>");
+                        return;
+                    }
+                    each(i);
+                }
+            }
+
+            // Wrap with parentheses if needed based on precedence
+            void operand(const ExprPtr& e, int parent_precedence, bool is_right = false) {
+                if (auto* f = std::get_if<FunctionCall>(e.get())) {
+                    int prec = get_precedence(f->head);
+                    if (prec < parent_precedence || (prec == parent_precedence && is_right)) {
+                        out.push_back('(');
+                        print(*e);
+                        out.push_back(')');
+                        return;
+                    }
+                }
+                print(*e);
+            }
+
+            void infix(const FunctionCall& f, std::string_view op) {
+                const int prec = get_precedence(f.head);
+                operand(f.args[0], prec);
+                out.append(op);
+                operand(f.args[1], prec, true);
+            }
+
+            void complex(double real, double imag) {
+                if (real == 0.0 && imag == 0.0) return out.push_back('0');
+                if (real == 0.0) {
+                    write_number(out, imag);
+                    return out.append("*I");
+                }
+                write_number(out, real);
+                if (imag == 0.0) return;
+                out.append(imag > 0 ? " + " : " - ");
+                write_number(out, std::abs(imag));
+                out.append("*I");
+            }
+
+            // Rows of a packed array nested by its shape, from entry `offset` on
+            void packed(const PackedData& array, size_t dim = 0, size_t offset = 0) {
+                size_t stride = 1;
+                for (size_t d = dim + 1; d < array.rank(); ++d) stride *= array.shape[d];
+                out.push_back('{');
+                sequence(array.shape[dim], ", ", [&](size_t i) {
+                    if (dim + 1 < array.rank()) packed(array, dim + 1, offset + i * stride);
+                    else entry(array, offset + i);
+                });
+                out.push_back('}');
+            }
+
+            void entry(const PackedData& array, size_t flat) {
+                std::visit(overloaded{
+                    [&](const std::vector<int64_t>& v) { write_number(out, static_cast<double>(v[flat])); },
+                    [&](const std::vector<double>& v) { write_number(out, v[flat]); },
+                    [&](const std::vector<std::complex<double>>& v) { complex(v[flat].real(), v[flat].imag()); },
+                }, array.values);
+            }
+
+            void call(const FunctionCall& f) {
+                const auto& args = f.args;
+
+                if (f.head == atoms::Plus) {
+                    const int prec = get_precedence(atoms::Plus);
+                    return sequence(args.size(), " + ", [&](size_t i) { operand(args[i], prec); });
+                }
+                if (f.head == atoms::Times) {
+                    // Special case: Times[-1, x] => -x
+                    if (args.size() == 2 && (is_minus_one(args[0]) || is_minus_one(args[1]))) {
+                        out.push_back('-');
+                        return operand(is_minus_one(args[0]) ? args[1] : args[0], get_precedence(atoms::Negate));
+                    }
+                    const int prec = get_precedence(atoms::Times);
+                    return sequence(args.size(), " * ", [&](size_t i) { operand(args[i], prec); });
+                }
+                if (args.size() == 2) {
+                    if (f.head == atoms::Minus) return infix(f, " - ");
+                    if (f.head == atoms::Divide) return infix(f, " / ");
+                    if (f.head == atoms::Power) return infix(f, "^");
+                    if (const char* op = comparison(f.head)) {
+                        operand(args[0], 0);
+                        out.append(op);
+                        return operand(args[1], 0);
+                    }
+                    // Short[expr, n]: expr cut to n lines
+                    if (f.head == atoms::Short) {
+                        if (auto n = std::get_if<Number>(args[1].get()); n && n->value > 0) {
+                            const size_t saved = limit;
+                            const double budget = n->value * static_cast<double>(SHORT_LINE_WIDTH);
+                            if (budget < static_cast<double>(limit - out.size())) {
+                                limit = out.size() + static_cast<size_t>(budget);
+                            }
+                            print(args[0]);
+                            limit = saved;
+                            return;
+                        }
+                    }
+                }
+                if (f.head == atoms::Negate && args.size() == 1) {
+                    out.push_back('-');
+                    return operand(args[0], get_precedence(atoms::Negate));
+                }
+
+                // Default: head[arg1, arg2, ...]
+                out.append(f.head.str());
+                out.push_back('[');
+                sequence(args.size(), ", ", [&](size_t i) { print(args[i]); });
+                out.push_back(']');
+            }
+        };
+
+        class FullFormPrinter {
+        public:
+            explicit FullFormPrinter(OutputBuffer& out) : out(out) {}
+
+            void print(const ExprPtr& e) {
+                if (!e) return out.append("Null");
+                std::visit(overloaded{
+                    [&](const Number& n) { full_number(n.value); },
+                    [&](const Complex& c) { complex(c.real, c.imag); },
+                    [&](const Symbol& s) { out.append(s.name.str()); },
+                    [&](const String& s) {
+                        out.push_back('"');
+                        out.append(s.value);
+                        out.push_back('"');
+                    },
+                    [&](const Boolean& b) { out.append(b.value ? "True" : "False"); },
+                    [&](const Rational& r) {
+                        out.append("Rational[");
+                        out.append(r.numerator.to_string());
+                        out.append(", ");
+                        out.append(r.denominator.to_string());
+                        out.push_back(']');
+                    },
+                    [&](const FunctionCall& f) {
+                        out.append(f.head.str());
+                        out.push_back('[');
+                        elements(f.args);
+                        out.push_back(']');
+                    },
+                    [&](const FunctionDefinition& f) {
+                        out.append("FunctionDefinition[");
+                        out.append(f.name.str());
+                        out.append(", List[");
+                        for (size_t i = 0; i < f.params.size(); ++i) {
+                            if (i > 0) out.append(", ");
+                            out.append("Parameter[");
+                            out.append(f.params[i].name.str());
+                            if (f.params[i].default_value) {
+                                out.append(", ");
+                                print(f.params[i].default_value);
+                            }
+                            out.push_back(']');
+                        }
+                        out.append("], ");
+                        print(f.body);
+                        out.append(f.delayed ? ", True]" : ", False]");
+                    },
+                    [&](const Assignment& a) {
+                        out.append("Set[");
+                        out.append(a.name.str());
+                        out.append(", ");
+                        print(a.value);
+                        out.push_back(']');
+                    },
+                    [&](const Rule& r) {
+                        out.append("Rule[");
+                        print(r.lhs);
+                        out.append(", ");
+                        print(r.rhs);
+                        out.push_back(']');
+                    },
+                    [&](const List& l) {
+                        out.append("List[");
+                        elements(l.elements);
+                        out.push_back(']');
+                    },
+                    [&](const PackedArray& a) {
+                        size_t flat = 0;
+                        write_packed(out, *a.data, 0, flat, "List[", "]", [&](size_t i) {
+                            std::visit(overloaded{
+                                [&](const std::vector<int64_t>& v) { full_number(static_cast<double>(v[i])); },
+                                [&](const std::vector<double>& v) { full_number(v[i]); },
+                                [&](const std::vector<std::complex<double>>& v) { complex(v[i].real(), v[i].imag()); },
+                            }, a.data->values);
+                        });
+                    },
+                    [&](const LazyList& l) {
+                        out.append("List[");
+                        for (size_t i = 0; i < l.count; ++i) {
+                            if (i > 0) out.append(", ");
+                            full_number(lazy_value(l, i));
+                        }
+                        out.push_back(']');
+                    },
+                    [&](const Infinity&) { out.append("Infinity"); },
+                    [&](const Indeterminate&) { out.append("Indeterminate"); },
+                }, *e);
+            }
+
+        private:
+            OutputBuffer& out;
+
+            void elements(const std::vector<ExprPtr>& items) {
+                for (size_t i = 0; i < items.size(); ++i) {
+                    if (i > 0) out.append(", ");
+                    print(items[i]);
+                }
+            }
+
+            // 16 significant digits
+            void full_number(double value) { write_chars(out, value, std::chars_format::general, 16); }
+
+            void complex(double real, double imag) {
+                out.append("Complex[");
+                write_chars(out, real, std::chars_format::general, 6);
+                out.append(", ");
+                write_chars(out, imag, std::chars_format::general, 6);
+                out.push_back(']');
+            }
+        };
+    }
+
+    void write_number(OutputBuffer& out, double value) {
+        if (std::isinf(value)) return out.append(value > 0 ? "Infinity" : "-Infinity");
+        if (std::floor(value) == value && std::abs(value) < 9.2e18) {
+            // Format as integer without decimals
+            return write_chars(out, static_cast<int64_t>(value));
+        }
+        char buffer[NUMBER_CHARS];
+        const auto result = std::to_chars(buffer, buffer + sizeof buffer, value, std::chars_format::fixed, 6);
+        std::string_view text(buffer, static_cast<size_t>(result.ptr - buffer));
+        // Remove trailing zeros, then a trailing '.'
+        if (text.find('.') != std::string_view::npos) {
+            text.remove_suffix(text.size() - 1 - text.find_last_not_of('0'));
+            if (text.back() == '.') text.remove_suffix(1);
+        }
+        out.append(text);
+    }
+
+    std::string format_number(double value) {
+        std::string text;
+        OutputBuffer out(text);
+        write_number(out, value);
+        return text;
+    }
+
+    void write_expr(OutputBuffer& out, const Expr& expr, size_t limit) {
+        InputFormPrinter(out, limit).print(expr);
+    }
+
+    void write_expr(std::ostream& out, const ExprPtr& expr) {
+        OutputBuffer buffer(out);
+        write_expr(buffer, *expr);
+    }
+
+    void write_fullform(OutputBuffer& out, const ExprPtr& expr) {
+        FullFormPrinter(out).print(expr);
+    }
+
+    void write_fullform(std::ostream& out, const ExprPtr& expr) {
+        OutputBuffer buffer(out);
+        write_fullform(buffer, expr);
+    }
+
+    std::string to_string(const Expr& expr) {
+        std::string text;
+        OutputBuffer out(text);
+        write_expr(out, expr);
+        return text;
+    }
+
+    std::string to_fullform(const ExprPtr& expr) {
+        std::string text;
+        OutputBuffer out(text);
+        write_fullform(out, expr);
+        return text;
+    }
+
+} // namespace aleph3
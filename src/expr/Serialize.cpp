@@ -0,0 +1,542 @@
+#include "expr/Serialize.hpp"
+#include "expr/PackedArray.hpp"
+#include "util/Overloaded.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+        constexpr std::string_view MAGIC = "A3EX";
+
+        // Rational parts: zigzag varint, or sign and limbs
+        enum : uint8_t { SMALL_INT = 0, BIG_POSITIVE = 1, BIG_NEGATIVE = 2 };
+
+        class Writer {
+        public:
+            std::string write(const ExprPtr& root) {
+                std::vector<const ExprPtr*> stack{ &root };
+                while (!stack.empty()) {
+                    const ExprPtr& node = *stack.back();
+                    stack.pop_back();
+                    const size_t first_child = stack.size();
+                    write_node(node, stack);
+                    // Children come off the stack in order
+                    std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(first_child), stack.end());
+                }
+
+                // The atom table is known only now; it goes in front of the nodes
+                Writer file;
+                file.out.append(MAGIC);
+                file.varint(SERIAL_FORMAT_VERSION);
+                file.varint(atoms.size());
+                for (Atom atom : atoms) {
+                    file.varint(atom.str().size());
+                    file.out.append(atom.str());
+                }
+                file.out.reserve(file.out.size() + out.size());
+                file.out.append(out);
+                return std::move(file.out);
+            }
+
+        private:
+            std::string out;
+            std::vector<Atom> atoms;
+            std::vector<uint32_t> atom_slots;  // By atom id: 1 + index in `atoms`, 0 if absent
+            std::unordered_map<const Expr*, uint64_t> shared;
+
+            void byte(uint8_t b) { out.push_back(static_cast<char>(b)); }
+
+            void varint(uint64_t v) {
+                while (v >= 0x80) {
+                    byte(static_cast<uint8_t>(v | 0x80));
+                    v >>= 7;
+                }
+                byte(static_cast<uint8_t>(v));
+            }
+
+            void zigzag(int64_t v) { varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+
+            void fixed64(uint64_t v) {
+                char bytes[8];
+                for (int i = 0; i < 8; ++i) bytes[i] = static_cast<char>(v >> (8 * i));
+                out.append(bytes, 8);
+            }
+
+            void real(double v) { fixed64(std::bit_cast<uint64_t>(v)); }
+
+            void atom(Atom a) {
+                if (atom_slots.size() <= a.id()) atom_slots.resize(a.id() + 1, 0);
+                uint32_t& slot = atom_slots[a.id()];
+                if (slot == 0) {
+                    atoms.push_back(a);
+                    slot = static_cast<uint32_t>(atoms.size());
+                }
+                varint(slot - 1);
+            }
+
+            void integer(const BigInt& n) {
+                if (n.is_small()) {
+                    const int64_t v = n.small_value();
+                    byte(SMALL_INT);
+                    zigzag(v);
+                    return;
+                }
+                byte(n.sign() < 0 ? BIG_NEGATIVE : BIG_POSITIVE);
+                const auto limbs = n.magnitude();
+                varint(limbs.size());
+                for (uint32_t limb : limbs) {
+                    for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(limb >> (8 * i)));
+                }
+            }
+
+            template <typename T>
+            void raw(const std::vector<T>& values) {
+                if constexpr (std::endian::native == std::endian::little) {
+                    out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+                }
+                else {
+                    for (const T& v : values) {
+                        if constexpr (std::is_same_v<T, std::complex<double>>) {
+                            real(v.real());
+                            real(v.imag());
+                        }
+                        else if constexpr (std::is_same_v<T, double>) {
+                            real(v);
+                        }
+                        else {
+                            fixed64(static_cast<uint64_t>(v));
+                        }
+                    }
+                }
+            }
+
+            void header(SerialTag tag, bool is_shared) { byte(static_cast<uint8_t>((static_cast<uint8_t>(tag) << 1) | is_shared)); }
+
+            // Writes the node's header and payload and pushes its children
+            void write_node(const ExprPtr& node, std::vector<const ExprPtr*>& children) {
+                bool is_shared = false;
+                if (node.use_count() > 1) {
+                    auto [it, inserted] = shared.try_emplace(node.get(), shared.size());
+                    if (!inserted) {
+                        header(SerialTag::BackRef, false);
+                        varint(it->second);
+                        return;
+                    }
+                    is_shared = true;
+                }
+                std::visit(overloaded{
+                    [&](const Symbol& s) {
+                        header(SerialTag::Symbol, is_shared);
+                        atom(s.name);
+                    },
+                    [&](const Number& n) {
+                        // -0.0 keeps its sign only as a double
+                        const double v = n.value;
+                        if (std::abs(v) < 0x1p53 && v == std::trunc(v) && !(v == 0 && std::signbit(v))) {
+                            header(SerialTag::IntegralNumber, is_shared);
+                            zigzag(static_cast<int64_t>(v));
+                        }
+                        else {
+                            header(SerialTag::Number, is_shared);
+                            real(v);
+                        }
+                    },
+                    [&](const Complex& c) {
+                        header(SerialTag::Complex, is_shared);
+                        real(c.real);
+                        real(c.imag);
+                    },
+                    [&](const Rational& r) {
+                        header(SerialTag::Rational, is_shared);
+                        integer(r.numerator);
+                        integer(r.denominator);
+                    },
+                    [&](const Boolean& b) {
+                        header(SerialTag::Boolean, is_shared);
+                        byte(b.value ? 1 : 0);
+                    },
+                    [&](const String& s) {
+                        header(SerialTag::String, is_shared);
+                        varint(s.value.size());
+                        out.append(s.value);
+                    },
+                    [&](const FunctionCall& f) {
+                        header(SerialTag::FunctionCall, is_shared);
+                        atom(f.head);
+                        varint(f.args.size());
+                        for (const auto& arg : f.args) children.push_back(&arg);
+                    },
+                    [&](const FunctionDefinition& def) {
+                        header(SerialTag::FunctionDefinition, is_shared);
+                        atom(def.name);
+                        byte((def.delayed ? 1 : 0) | (def.body ? 2 : 0));
+                        varint(def.params.size());
+                        for (const auto& param : def.params) {
+                            atom(param.name);
+                            byte(param.default_value ? 1 : 0);
+                            if (param.default_value) children.push_back(&param.default_value);
+                        }
+                        if (def.body) children.push_back(&def.body);
+                    },
+                    [&](const Assignment& a) {
+                        header(SerialTag::Assignment, is_shared);
+                        atom(a.name);
+                        children.push_back(&a.value);
+                    },
+                    [&](const Rule& r) {
+                        header(SerialTag::Rule, is_shared);
+                        children.push_back(&r.lhs);
+                        children.push_back(&r.rhs);
+                    },
+                    [&](const List& l) {
+                        header(SerialTag::List, is_shared);
+                        varint(l.elements.size());
+                        for (const auto& e : l.elements) children.push_back(&e);
+                    },
+                    [&](const Infinity&) { header(SerialTag::Infinity, is_shared); },
+                    [&](const Indeterminate&) { header(SerialTag::Indeterminate, is_shared); },
+                    [&](const PackedArray& p) {
+                        header(SerialTag::PackedArray, is_shared);
+                        const PackedData& data = *p.data;
+                        byte(static_cast<uint8_t>(data.type()));
+                        varint(data.shape.size());
+                        for (size_t d : data.shape) varint(d);
+                        std::visit([&](const auto& values) { raw(values); }, data.values);
+                    },
+                    [&](const LazyList& l) {
+                        header(SerialTag::LazyList, is_shared);
+                        real(l.start);
+                        real(l.step);
+                        varint(l.count);
+                        byte(l.integer ? 1 : 0);
+                    },
+                    }, *node);
+            }
+        };
+
+        class Reader {
+        public:
+            explicit Reader(std::string_view bytes) : in(bytes) {}
+
+            ExprPtr read() {
+                if (in.substr(0, MAGIC.size()) != MAGIC) fail("not a serialized expression");
+                pos = MAGIC.size();
+                if (const uint64_t version = varint(); version != SERIAL_FORMAT_VERSION) {
+                    fail("unsupported format version " + std::to_string(version));
+                }
+                const uint64_t atom_count = count();
+                atoms.reserve(atom_count);
+                for (uint64_t i = 0; i < atom_count; ++i) {
+                    const uint64_t size = count();
+                    atoms.emplace_back(in.substr(pos, size));
+                    pos += size;
+                }
+
+                ExprPtr root;
+                while (!root) {
+                    ExprPtr value = read_node();
+                    // Complete every frame the value finishes
+                    while (value) {
+                        if (frames.empty()) {
+                            root = std::move(value);
+                            break;
+                        }
+                        Frame& top = frames.back();
+                        top.children.push_back(std::move(value));
+                        if (top.children.size() < top.expected) break;
+                        value = build(top);
+                        frames.pop_back();
+                    }
+                }
+                if (pos != in.size()) fail("trailing bytes");
+                return root;
+            }
+
+        private:
+            // A node whose children are still being read
+            struct Frame {
+                SerialTag tag;
+                int64_t ref;            // Back-reference number, -1 if not shared
+                size_t expected;        // Number of children
+                std::vector<ExprPtr> children;
+                Atom atom{};
+                bool delayed = false;
+                bool has_body = false;
+                std::vector<Parameter> params{};  // Defaults are filled in from children
+            };
+
+            std::string_view in;
+            size_t pos = 0;
+            std::vector<Atom> atoms;
+            std::vector<ExprPtr> refs;
+            std::vector<Frame> frames;
+
+            [[noreturn]] void fail(const std::string& what) const {
+                throw SerializationError("BinaryDeserialize: " + what + " at byte " + std::to_string(pos));
+            }
+
+            void need(uint64_t n) const {
+                if (n > in.size() - pos) fail("truncated input");
+            }
+
+            uint8_t byte() {
+                need(1);
+                return static_cast<uint8_t>(in[pos++]);
+            }
+
+            uint64_t varint() {
+                uint64_t v = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    const uint8_t b = byte();
+                    v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) return v;
+                }
+                fail("overlong varint");
+            }
+
+            // A length or element count: every element takes at least one byte
+            uint64_t count() {
+                const uint64_t n = varint();
+                need(n);
+                return n;
+            }
+
+            uint64_t fixed64() {
+                need(8);
+                uint64_t v = 0;
+                for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+                pos += 8;
+                return v;
+            }
+
+            double real() { return std::bit_cast<double>(fixed64()); }
+
+            int64_t zigzag() {
+                const uint64_t z = varint();
+                return static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1));
+            }
+
+            Atom atom() {
+                const uint64_t index = varint();
+                if (index >= atoms.size()) fail("atom index out of range");
+                return atoms[index];
+            }
+
+            BigInt integer() {
+                const uint8_t kind = byte();
+                if (kind == SMALL_INT) return BigInt(zigzag());
+                if (kind != BIG_POSITIVE && kind != BIG_NEGATIVE) fail("invalid integer");
+                const uint64_t size = varint();
+                need(size * 4);
+                std::vector<uint32_t> limbs(size);
+                for (auto& limb : limbs) {
+                    limb = 0;
+                    for (int i = 0; i < 4; ++i) limb |= static_cast<uint32_t>(static_cast<uint8_t>(in[pos++])) << (8 * i);
+                }
+                BigInt magnitude = BigInt::from_magnitude(std::move(limbs));
+                return kind == BIG_NEGATIVE ? -magnitude : magnitude;
+            }
+
+            template <typename T>
+            std::vector<T> raw(uint64_t n) {
+                if (n > (in.size() - pos) / sizeof(T)) fail("truncated input");
+                std::vector<T> values(n);
+                if constexpr (std::endian::native == std::endian::little) {
+                    std::memcpy(values.data(), in.data() + pos, n * sizeof(T));
+                    pos += n * sizeof(T);
+                }
+                else {
+                    for (auto& v : values) {
+                        if constexpr (std::is_same_v<T, std::complex<double>>) {
+                            const double re = real();
+                            v = { re, real() };
+                        }
+                        else if constexpr (std::is_same_v<T, double>) {
+                            v = real();
+                        }
+                        else {
+                            v = static_cast<int64_t>(fixed64());
+                        }
+                    }
+                }
+                return values;
+            }
+
+            ExprPtr packed() {
+                const uint8_t type = byte();
+                const uint64_t rank = count();
+                if (rank == 0) fail("packed array of rank 0");
+                std::vector<size_t> shape(rank);
+                uint64_t size = 1;
+                for (auto& d : shape) {
+                    d = varint();
+                    if (d != 0 && size > std::numeric_limits<uint64_t>::max() / d) fail("packed array too large");
+                    size *= d;
+                }
+                switch (static_cast<PackedData::Type>(type)) {
+                case PackedData::Type::Integer: return make_packed(std::move(shape), raw<int64_t>(size));
+                case PackedData::Type::Real: return make_packed(std::move(shape), raw<double>(size));
+                case PackedData::Type::Complex: return make_packed(std::move(shape), raw<std::complex<double>>(size));
+                }
+                fail("invalid packed array type");
+            }
+
+            // Reads one node header; returns the node if it has no children left to read,
+            // otherwise pushes a frame and returns nullptr
+            ExprPtr read_node() {
+                const uint8_t h = byte();
+                const auto tag = static_cast<SerialTag>(h >> 1);
+                if (tag == SerialTag::BackRef) {
+                    const uint64_t index = varint();
+                    if (index >= refs.size() || !refs[index]) fail("invalid back-reference");
+                    return refs[index];
+                }
+                int64_t ref = -1;
+                if (h & 1) {
+                    ref = static_cast<int64_t>(refs.size());
+                    refs.emplace_back();
+                }
+                auto leaf = [&](ExprPtr node) {
+                    if (ref >= 0) refs[static_cast<size_t>(ref)] = node;
+                    return node;
+                };
+                auto open = [&](Frame frame) -> ExprPtr {
+                    frame.ref = ref;
+                    frame.children.reserve(frame.expected);
+                    if (frame.expected == 0) return build(frame);
+                    frames.push_back(std::move(frame));
+                    return nullptr;
+                };
+
+                switch (tag) {
+                case SerialTag::Symbol: return leaf(make_expr<Symbol>(atom()));
+                case SerialTag::Number: return leaf(make_expr<Number>(real()));
+                case SerialTag::IntegralNumber: return leaf(make_expr<Number>(static_cast<double>(zigzag())));
+                case SerialTag::Complex: {
+                    const double re = real();
+                    return leaf(make_expr<Complex>(re, real()));
+                }
+                case SerialTag::Rational: {
+                    BigInt n = integer();
+                    BigInt d = integer();
+                    if (d.is_zero()) fail("zero denominator");
+                    return leaf(make_expr<Rational>(std::move(n), std::move(d)));
+                }
+                case SerialTag::Boolean: return leaf(make_expr<Boolean>(byte() != 0));
+                case SerialTag::String: {
+                    const uint64_t size = count();
+                    std::string value(in.substr(pos, size));
+                    pos += size;
+                    return leaf(make_expr<String>(value));
+                }
+                case SerialTag::Infinity: return leaf(make_expr<Infinity>());
+                case SerialTag::Indeterminate: return leaf(make_expr<Indeterminate>());
+                case SerialTag::PackedArray: return leaf(packed());
+                case SerialTag::LazyList: {
+                    const double start = real();
+                    const double step = real();
+                    const uint64_t n = varint();
+                    return leaf(make_expr<LazyList>(start, step, static_cast<size_t>(n), byte() != 0));
+                }
+                case SerialTag::FunctionCall: {
+                    Frame frame{ tag, ref, 0, {}, atom() };
+                    frame.expected = count();
+                    return open(std::move(frame));
+                }
+                case SerialTag::List: {
+                    Frame frame{ tag, ref, 0, {} };
+                    frame.expected = count();
+                    return open(std::move(frame));
+                }
+                case SerialTag::Rule: return open(Frame{ tag, ref, 2, {} });
+                case SerialTag::Assignment: return open(Frame{ tag, ref, 1, {}, atom() });
+                case SerialTag::FunctionDefinition: {
+                    Frame frame{ tag, ref, 0, {}, atom() };
+                    const uint8_t flags = byte();
+                    frame.delayed = flags & 1;
+                    frame.has_body = flags & 2;
+                    const uint64_t param_count = count();
+                    frame.params.reserve(param_count);
+                    for (uint64_t i = 0; i < param_count; ++i) {
+                        const Atom name = atom();
+                        frame.params.emplace_back(name);
+                        // A placeholder until the default is read
+                        if (byte() != 0) {
+                            frame.params.back().default_value = make_expr<Indeterminate>();
+                            ++frame.expected;
+                        }
+                    }
+                    frame.expected += frame.has_body ? 1 : 0;
+                    return open(std::move(frame));
+                }
+                default:
+                    fail("invalid node tag " + std::to_string(h >> 1));
+                }
+            }
+
+            ExprPtr build(Frame& frame) {
+                ExprPtr node;
+                switch (frame.tag) {
+                case SerialTag::FunctionCall:
+                    node = make_expr<FunctionCall>(frame.atom, std::move(frame.children));
+                    break;
+                case SerialTag::List:
+                    node = make_expr<List>(std::move(frame.children));
+                    break;
+                case SerialTag::Rule:
+                    node = make_expr<Rule>(frame.children[0], frame.children[1]);
+                    break;
+                case SerialTag::Assignment:
+                    node = make_expr<Assignment>(frame.atom, frame.children[0]);
+                    break;
+                default: {
+                    size_t next = 0;
+                    for (auto& param : frame.params) {
+                        if (param.default_value) param.default_value = frame.children[next++];
+                    }
+                    ExprPtr body = frame.has_body ? frame.children[next] : nullptr;
+                    node = make_expr<FunctionDefinition>(frame.atom, frame.params, body, frame.delayed);
+                    break;
+                }
+                }
+                if (frame.ref >= 0) refs[static_cast<size_t>(frame.ref)] = node;
+                return node;
+            }
+        };
+    }
+
+    std::string serialize(const ExprPtr& expr) {
+        return Writer().write(expr);
+    }
+
+    ExprPtr deserialize(std::string_view bytes) {
+        return Reader(bytes).read();
+    }
+
+    void write_serialized(const std::string& path, const ExprPtr& expr) {
+        const std::string bytes = serialize(expr);
+        std::ofstream file(path, std::ios::binary);
+        if (!file || !file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            throw SerializationError("BinarySerialize: cannot write '" + path + "'");
+        }
+    }
+
+    ExprPtr read_serialized(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw SerializationError("BinaryDeserialize: cannot read '" + path + "'");
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return deserialize(contents.view());
+    }
+
+} // namespace aleph3
@@ -0,0 +1,503 @@
+#include "expr/VectorKernels.hpp"
+#include "ExtraMath.hpp"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Every exported loop is compiled once per instruction set and resolved at load time
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+#define ALEPH3_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define ALEPH3_KERNEL
+#endif
+
+#if defined(__GNUC__)
+#define ALEPH3_INLINE inline __attribute__((always_inline))
+#else
+#define ALEPH3_INLINE inline
+#endif
+
+namespace aleph3::kernels {
+
+    namespace {
+
+        // Round-to-nearest integer of x for |x| < 2^51: (x + SHIFTER) - SHIFTER, and the
+        // integer itself in the low mantissa bits of x + SHIFTER
+        constexpr double SHIFTER = 0x1.8p52;
+
+        constexpr double LN2_HI = 0x1.62e42fee00000p-1;
+        constexpr double LN2_LO = 0x1.a39ef35793c76p-33;
+        constexpr double LOG2E = 0x1.71547652b82fep0;
+        constexpr double SQRT2 = 0x1.6a09e667f3bcdp0;
+
+        // Pi/2 in three parts; the first two have 33 significant bits, so q * part is exact
+        // for the |q| < 2^20 allowed by TRIG_LIMIT
+        constexpr double PIO2_1 = 0x1.921fb54400000p0;
+        constexpr double PIO2_2 = 0x1.0b4611a600000p-34;
+        constexpr double PIO2_3 = 0x1.3198a2e037073p-69;
+        constexpr double TWO_OVER_PI = 0x1.45f306dc9c883p-1;
+
+        // Beyond these the reductions lose accuracy; such lanes are recomputed with <cmath>
+        constexpr double TRIG_LIMIT = 1.0e5;
+        constexpr double EXP_LIMIT = 708.0;
+        constexpr double LOG_MIN = 0x1p-1022;
+        constexpr double LOG_MAX = 0x1.fffffffffffffp1023;
+
+        // (-1)^i / k! for k = first, first + step, ... when alternating, 1 / k! otherwise
+        template <size_t N>
+        constexpr std::array<double, N> taylor_coefficients(int first, int step, bool alternate) {
+            std::array<double, N> c{};
+            double fact = 1.0;
+            for (int j = 2; j <= first; ++j) fact *= j;
+            int k = first;
+            for (size_t i = 0; i < N; ++i) {
+                c[i] = ((alternate && i % 2) ? -1.0 : 1.0) / fact;
+                for (int s = 0; s < step; ++s) fact *= ++k;
+            }
+            return c;
+        }
+
+        constexpr auto EXP_COEFFS = taylor_coefficients<14>(0, 1, false); // e^r up to r^13
+        constexpr auto SIN_COEFFS = taylor_coefficients<9>(1, 2, true);   // sin r up to r^17
+        constexpr auto COS_COEFFS = taylor_coefficients<10>(0, 2, true);  // cos r up to r^18
+
+        // 1/1, 1/3, 1/5, ...: 2 atanh(s) = 2s (1 + s^2/3 + s^4/5 + ...)
+        template <size_t N>
+        constexpr std::array<double, N> atanh_coefficients() {
+            std::array<double, N> c{};
+            for (size_t i = 0; i < N; ++i) c[i] = 1.0 / static_cast<double>(2 * i + 1);
+            return c;
+        }
+
+        constexpr auto LOG_COEFFS = atanh_coefficients<12>(); // up to s^22/23
+
+        // c[0] + c[1] x + ... + c[N-1] x^(N-1), unrolled so that the calling loop stays innermost
+        template <size_t N, size_t... I>
+        ALEPH3_INLINE double horner(const std::array<double, N>& c, double x, std::index_sequence<I...>) {
+            double p = c[N - 1];
+            ((p = p * x + c[N - 2 - I]), ...);
+            return p;
+        }
+
+        template <size_t N>
+        ALEPH3_INLINE double horner(const std::array<double, N>& c, double x) {
+            return horner(c, x, std::make_index_sequence<N - 1>());
+        }
+
+        // e^x for |x| <= EXP_LIMIT: x = k ln2 + r with |r| <= ln2/2, e^x = 2^k e^r
+        ALEPH3_INLINE double exp_reduced(double x) {
+            const double kd = x * LOG2E + SHIFTER;
+            const double k = kd - SHIFTER;
+            const int64_t ki = std::bit_cast<int64_t>(kd) - std::bit_cast<int64_t>(SHIFTER);
+            const double r = (x - k * LN2_HI) - k * LN2_LO;
+            const double scale = std::bit_cast<double>(static_cast<uint64_t>(ki + 1023) << 52);
+            return horner(EXP_COEFFS, r) * scale;
+        }
+
+        // log x for normal positive x: x = 2^e m with m in [sqrt(2)/2, sqrt(2)),
+        // log m = 2 atanh(s) with s = (m - 1) / (m + 1)
+        ALEPH3_INLINE double log_reduced(double x) {
+            const uint64_t bits = std::bit_cast<uint64_t>(x);
+            double e = std::bit_cast<double>((bits >> 52) | 0x4330000000000000ULL) - (0x1p52 + 1023.0);
+            double m = std::bit_cast<double>((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+            const bool high = m > SQRT2;
+            m = high ? m * 0.5 : m;
+            e = high ? e + 1.0 : e;
+            const double f = m - 1.0;
+            const double s = f / (2.0 + f);
+            const double s2 = s * s;
+            // |s| <= 0.1716, so the series converges to double precision by s^23
+            return e * LN2_HI + (e * LN2_LO + 2.0 * s * horner(LOG_COEFFS, s2));
+        }
+
+        // x = q pi/2 + r with |r| <= pi/4
+        ALEPH3_INLINE double reduce_half_pi(double x, int64_t& q) {
+            const double qd = x * TWO_OVER_PI + SHIFTER;
+            const double k = qd - SHIFTER;
+            q = std::bit_cast<int64_t>(qd) - std::bit_cast<int64_t>(SHIFTER);
+            return ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+        }
+
+        ALEPH3_INLINE double sin_poly(double r) { return r * horner(SIN_COEFFS, r * r); }
+        ALEPH3_INLINE double cos_poly(double r) { return horner(COS_COEFFS, r * r); }
+
+        ALEPH3_INLINE double sin_reduced(double x) {
+            int64_t q;
+            const double r = reduce_half_pi(x, q);
+            const double s = sin_poly(r);
+            const double c = cos_poly(r);
+            const double v = (q & 1) ? c : s;
+            return (q & 2) ? -v : v;
+        }
+
+        ALEPH3_INLINE double cos_reduced(double x) {
+            int64_t q;
+            const double r = reduce_half_pi(x, q);
+            const double s = sin_poly(r);
+            const double c = cos_poly(r);
+            const double v = (q & 1) ? s : c;
+            return ((q + 1) & 2) ? -v : v;
+        }
+
+        ALEPH3_INLINE double tan_reduced(double x) {
+            int64_t q;
+            const double r = reduce_half_pi(x, q);
+            const double s = sin_poly(r);
+            const double c = cos_poly(r);
+            return (q & 1) ? -c / s : s / c;
+        }
+
+        // out[i] = f(x[i]) for a reduced-range kernel f; lanes outside [lo, hi] (and NaN) are
+        // computed on a safe input and then redone with the <cmath> reference
+        template <typename F, typename Ref>
+        ALEPH3_INLINE void reduced_loop(const double* x, double* out, size_t n, double lo, double hi,
+            double safe, F f, Ref ref) {
+            int64_t any_outside = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const double v = x[i];
+                const bool inside = (v >= lo) & (v <= hi);
+                any_outside |= !inside;
+                out[i] = f(inside ? v : safe);
+            }
+            if (!any_outside) return;
+            for (size_t i = 0; i < n; ++i) {
+                if (!(x[i] >= lo && x[i] <= hi)) out[i] = ref(x[i]);
+            }
+        }
+
+        template <typename F>
+        ALEPH3_INLINE void map_loop(const double* x, double* out, size_t n, F f) {
+            for (size_t i = 0; i < n; ++i) out[i] = f(x[i]);
+        }
+
+        ALEPH3_KERNEL void unary_loop(Unary f, const double* x, double* out, size_t n) {
+            switch (f) {
+            case Unary::Sin:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0, [](double v) { return sin_reduced(v); }, [](double v) { return std::sin(v); });
+            case Unary::Cos:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0, [](double v) { return cos_reduced(v); }, [](double v) { return std::cos(v); });
+            case Unary::Tan:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0, [](double v) { return tan_reduced(v); }, [](double v) { return std::tan(v); });
+            case Unary::Csc:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0,
+                    [](double v) { return 1.0 / sin_reduced(v); }, [](double v) { return csc(v); });
+            case Unary::Sec:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0,
+                    [](double v) { return 1.0 / cos_reduced(v); }, [](double v) { return sec(v); });
+            case Unary::Cot:
+                return reduced_loop(x, out, n, -TRIG_LIMIT, TRIG_LIMIT, 0.0,
+                    [](double v) { return 1.0 / tan_reduced(v); }, [](double v) { return cot(v); });
+            case Unary::Exp:
+                return reduced_loop(x, out, n, -EXP_LIMIT, EXP_LIMIT, 0.0, [](double v) { return exp_reduced(v); }, [](double v) { return std::exp(v); });
+            case Unary::Log:
+                return reduced_loop(x, out, n, LOG_MIN, LOG_MAX, 1.0, [](double v) { return log_reduced(v); }, [](double v) { return std::log(v); });
+            case Unary::Abs:     return map_loop(x, out, n, [](double v) { return std::fabs(v); });
+            case Unary::Sqrt:    return map_loop(x, out, n, [](double v) { return std::sqrt(v); });
+            case Unary::Floor:   return map_loop(x, out, n, [](double v) { return std::floor(v); });
+            case Unary::Ceiling: return map_loop(x, out, n, [](double v) { return std::ceil(v); });
+            case Unary::Round:   return map_loop(x, out, n, [](double v) { return std::round(v); });
+            // No vector implementation: a plain loop over the <cmath> function
+            case Unary::Sinh:    return map_loop(x, out, n, [](double v) { return std::sinh(v); });
+            case Unary::Cosh:    return map_loop(x, out, n, [](double v) { return std::cosh(v); });
+            case Unary::Tanh:    return map_loop(x, out, n, [](double v) { return std::tanh(v); });
+            case Unary::Coth:    return map_loop(x, out, n, [](double v) { return coth(v); });
+            case Unary::Sech:    return map_loop(x, out, n, [](double v) { return sech(v); });
+            case Unary::Csch:    return map_loop(x, out, n, [](double v) { return csch(v); });
+            case Unary::ArcSin:  return map_loop(x, out, n, [](double v) { return std::asin(v); });
+            case Unary::ArcCos:  return map_loop(x, out, n, [](double v) { return std::acos(v); });
+            case Unary::ArcTan:  return map_loop(x, out, n, [](double v) { return std::atan(v); });
+            case Unary::Gamma:   return map_loop(x, out, n, [](double v) { return std::tgamma(v); });
+            }
+        }
+
+        template <typename P>
+        ALEPH3_INLINE size_t mask_loop(const double* x, uint8_t* mask, size_t n, P in_domain) {
+            size_t count = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t m = in_domain(x[i]) ? 1 : 0;
+                mask[i] = m;
+                count += m;
+            }
+            return count;
+        }
+
+        ALEPH3_KERNEL size_t mask_kernel(Unary f, const double* x, uint8_t* mask, size_t n) {
+            switch (f) {
+            case Unary::ArcSin:
+            case Unary::ArcCos:
+                return mask_loop(x, mask, n, [](double v) { return v >= -1.0 && v <= 1.0; });
+            case Unary::Log:
+            case Unary::Gamma:
+                return mask_loop(x, mask, n, [](double v) { return v > 0.0; });
+            case Unary::Sqrt:
+                return mask_loop(x, mask, n, [](double v) { return v >= 0.0; });
+            default:
+                return mask_loop(x, mask, n, [](double) { return true; });
+            }
+        }
+
+        ALEPH3_KERNEL size_t finite_kernel(const double* x, uint8_t* mask, size_t n) {
+            constexpr uint64_t EXPONENT = 0x7ff0000000000000ULL;
+            size_t count = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t m = mask[i] & ((std::bit_cast<uint64_t>(x[i]) & EXPONENT) != EXPONENT ? 1 : 0);
+                mask[i] = m;
+                count += m;
+            }
+            return count;
+        }
+
+        template <typename A, typename B>
+        ALEPH3_INLINE void binary_body(Binary op, A a, B b, double* out, size_t n) {
+            switch (op) {
+            case Binary::Plus:   for (size_t i = 0; i < n; ++i) out[i] = a(i) + b(i); return;
+            case Binary::Minus:  for (size_t i = 0; i < n; ++i) out[i] = a(i) - b(i); return;
+            case Binary::Times:  for (size_t i = 0; i < n; ++i) out[i] = a(i) * b(i); return;
+            case Binary::Divide: for (size_t i = 0; i < n; ++i) out[i] = a(i) / b(i); return;
+            case Binary::Power:  for (size_t i = 0; i < n; ++i) out[i] = std::pow(a(i), b(i)); return;
+            }
+        }
+
+        ALEPH3_KERNEL void binary_vv(Binary op, const double* a, const double* b, double* out, size_t n) {
+            binary_body(op, [a](size_t i) { return a[i]; }, [b](size_t i) { return b[i]; }, out, n);
+        }
+
+        ALEPH3_KERNEL void binary_vs(Binary op, const double* a, double b, double* out, size_t n) {
+            if (op == Binary::Power && b == 2.0) {
+                for (size_t i = 0; i < n; ++i) out[i] = a[i] * a[i];
+                return;
+            }
+            binary_body(op, [a](size_t i) { return a[i]; }, [b](size_t) { return b; }, out, n);
+        }
+
+        ALEPH3_KERNEL void binary_sv(Binary op, double a, const double* b, double* out, size_t n) {
+            binary_body(op, [a](size_t) { return a; }, [b](size_t i) { return b[i]; }, out, n);
+        }
+
+        struct Parts {
+            double re;
+            double im;
+        };
+
+        // Complex arithmetic on interleaved buffers; a(i) and b(i) give the parts of entry i
+        template <typename A, typename B>
+        ALEPH3_INLINE void complex_body(Binary op, A a, B b, double* out, size_t n) {
+            switch (op) {
+            case Binary::Plus:
+                for (size_t i = 0; i < n; ++i) {
+                    const Parts x = a(i), y = b(i);
+                    out[2 * i] = x.re + y.re;
+                    out[2 * i + 1] = x.im + y.im;
+                }
+                return;
+            case Binary::Minus:
+                for (size_t i = 0; i < n; ++i) {
+                    const Parts x = a(i), y = b(i);
+                    out[2 * i] = x.re - y.re;
+                    out[2 * i + 1] = x.im - y.im;
+                }
+                return;
+            case Binary::Times:
+                for (size_t i = 0; i < n; ++i) {
+                    const Parts x = a(i), y = b(i);
+                    out[2 * i] = x.re * y.re - x.im * y.im;
+                    out[2 * i + 1] = x.re * y.im + x.im * y.re;
+                }
+                return;
+            case Binary::Divide:
+                // Unscaled; lanes that overflow are redone with std::complex by the caller
+                for (size_t i = 0; i < n; ++i) {
+                    const Parts x = a(i), y = b(i);
+                    const double d = y.re * y.re + y.im * y.im;
+                    out[2 * i] = (x.re * y.re + x.im * y.im) / d;
+                    out[2 * i + 1] = (x.im * y.re - x.re * y.im) / d;
+                }
+                return;
+            case Binary::Power:
+                for (size_t i = 0; i < n; ++i) {
+                    const Parts x = a(i), y = b(i);
+                    const auto z = std::pow(std::complex<double>(x.re, x.im), std::complex<double>(y.re, y.im));
+                    out[2 * i] = z.real();
+                    out[2 * i + 1] = z.imag();
+                }
+                return;
+            }
+        }
+
+        ALEPH3_KERNEL void complex_vv(Binary op, const double* a, const double* b, double* out, size_t n) {
+            complex_body(op, [a](size_t i) { return Parts{ a[2 * i], a[2 * i + 1] }; },
+                [b](size_t i) { return Parts{ b[2 * i], b[2 * i + 1] }; }, out, n);
+        }
+
+        ALEPH3_KERNEL void complex_vs(Binary op, const double* a, Parts b, double* out, size_t n) {
+            if (op == Binary::Power && b.re == 2.0 && b.im == 0.0) {
+                complex_body(Binary::Times, [a](size_t i) { return Parts{ a[2 * i], a[2 * i + 1] }; },
+                    [a](size_t i) { return Parts{ a[2 * i], a[2 * i + 1] }; }, out, n);
+                return;
+            }
+            complex_body(op, [a](size_t i) { return Parts{ a[2 * i], a[2 * i + 1] }; }, [b](size_t) { return b; }, out, n);
+        }
+
+        ALEPH3_KERNEL void complex_sv(Binary op, Parts a, const double* b, double* out, size_t n) {
+            complex_body(op, [a](size_t) { return a; }, [b](size_t i) { return Parts{ b[2 * i], b[2 * i + 1] }; }, out, n);
+        }
+
+        double* parts(std::complex<double>* z) { return reinterpret_cast<double*>(z); }
+        const double* parts(const std::complex<double>* z) { return reinterpret_cast<const double*>(z); }
+
+        bool finite(const std::complex<double>& z) { return std::isfinite(z.real()) && std::isfinite(z.imag()); }
+
+    } // namespace
+
+    const char* active_isa() {
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+        if (__builtin_cpu_supports("avx512f")) return "avx512";
+        if (__builtin_cpu_supports("avx2")) return "avx2";
+        return "scalar";
+#elif defined(__aarch64__)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+    void apply_unary(Unary f, const double* x, double* out, size_t n) {
+        unary_loop(f, x, out, n);
+    }
+
+    double apply_unary(Unary f, double x) {
+        switch (f) {
+        case Unary::Sin:     return std::sin(x);
+        case Unary::Cos:     return std::cos(x);
+        case Unary::Tan:     return std::tan(x);
+        case Unary::Csc:     return csc(x);
+        case Unary::Sec:     return sec(x);
+        case Unary::Cot:     return cot(x);
+        case Unary::Sinh:    return std::sinh(x);
+        case Unary::Cosh:    return std::cosh(x);
+        case Unary::Tanh:    return std::tanh(x);
+        case Unary::Coth:    return coth(x);
+        case Unary::Sech:    return sech(x);
+        case Unary::Csch:    return csch(x);
+        case Unary::Abs:     return std::fabs(x);
+        case Unary::Sqrt:    return std::sqrt(x);
+        case Unary::Exp:     return std::exp(x);
+        case Unary::Log:     return std::log(x);
+        case Unary::Floor:   return std::floor(x);
+        case Unary::Ceiling: return std::ceil(x);
+        case Unary::Round:   return std::round(x);
+        case Unary::ArcSin:  return std::asin(x);
+        case Unary::ArcCos:  return std::acos(x);
+        case Unary::ArcTan:  return std::atan(x);
+        case Unary::Gamma:   return std::tgamma(x);
+        }
+        return x;
+    }
+
+    bool in_real_domain(Unary f, double x) {
+        uint8_t in;
+        mask_kernel(f, &x, &in, 1);
+        return in != 0;
+    }
+
+    size_t domain_mask(Unary f, const double* x, uint8_t* mask, size_t n) {
+        return mask_kernel(f, x, mask, n);
+    }
+
+    size_t keep_finite(const double* x, uint8_t* mask, size_t n) {
+        return finite_kernel(x, mask, n);
+    }
+
+    void apply_binary(Binary op, const double* a, const double* b, double* out, size_t n) {
+        binary_vv(op, a, b, out, n);
+    }
+
+    void apply_binary(Binary op, const double* a, double b, double* out, size_t n) {
+        binary_vs(op, a, b, out, n);
+    }
+
+    void apply_binary(Binary op, double a, const double* b, double* out, size_t n) {
+        binary_sv(op, a, b, out, n);
+    }
+
+    bool has_complex_form(Unary f) {
+        switch (f) {
+        case Unary::Floor: case Unary::Ceiling: case Unary::Round: case Unary::Gamma:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    bool apply_unary(Unary f, const std::complex<double>& x, std::complex<double>& out) {
+        const std::complex<double> one(1.0, 0.0);
+        switch (f) {
+        case Unary::Sin:    out = std::sin(x); return true;
+        case Unary::Cos:    out = std::cos(x); return true;
+        case Unary::Tan:    out = std::tan(x); return true;
+        case Unary::Csc:    out = one / std::sin(x); return true;
+        case Unary::Sec:    out = one / std::cos(x); return true;
+        case Unary::Cot:    out = one / std::tan(x); return true;
+        case Unary::Sinh:   out = std::sinh(x); return true;
+        case Unary::Cosh:   out = std::cosh(x); return true;
+        case Unary::Tanh:   out = std::tanh(x); return true;
+        case Unary::Coth:   out = one / std::tanh(x); return true;
+        case Unary::Sech:   out = one / std::cosh(x); return true;
+        case Unary::Csch:   out = one / std::sinh(x); return true;
+        case Unary::Abs:    out = std::abs(x); return true;
+        case Unary::Sqrt:   out = std::sqrt(x); return true;
+        case Unary::Exp:    out = std::exp(x); return true;
+        case Unary::Log:    out = std::log(x); return true;
+        case Unary::ArcSin: out = std::asin(x); return true;
+        case Unary::ArcCos: out = std::acos(x); return true;
+        case Unary::ArcTan: out = std::atan(x); return true;
+        default:            return false;
+        }
+    }
+
+    void apply_unary(Unary f, const std::complex<double>* x, std::complex<double>* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) apply_unary(f, x[i], out[i]);
+    }
+
+    void apply_binary(Binary op, const std::complex<double>* a, const std::complex<double>* b,
+        std::complex<double>* out, size_t n) {
+        if (op == Binary::Plus || op == Binary::Minus) {
+            binary_vv(op, parts(a), parts(b), parts(out), 2 * n);
+            return;
+        }
+        if (op != Binary::Divide) {
+            complex_vv(op, parts(a), parts(b), parts(out), n);
+            return;
+        }
+        // The inputs are needed again for lanes that overflow, so divide into scratch space
+        std::vector<std::complex<double>> q(n);
+        complex_vv(op, parts(a), parts(b), parts(q.data()), n);
+        for (size_t i = 0; i < n; ++i) out[i] = finite(q[i]) ? q[i] : a[i] / b[i];
+    }
+
+    void apply_binary(Binary op, const std::complex<double>* a, std::complex<double> b,
+        std::complex<double>* out, size_t n) {
+        if (op != Binary::Divide) {
+            complex_vs(op, parts(a), Parts{ b.real(), b.imag() }, parts(out), n);
+            return;
+        }
+        std::vector<std::complex<double>> q(n);
+        complex_vs(op, parts(a), Parts{ b.real(), b.imag() }, parts(q.data()), n);
+        for (size_t i = 0; i < n; ++i) out[i] = finite(q[i]) ? q[i] : a[i] / b;
+    }
+
+    void apply_binary(Binary op, std::complex<double> a, const std::complex<double>* b,
+        std::complex<double>* out, size_t n) {
+        if (op != Binary::Divide) {
+            complex_sv(op, Parts{ a.real(), a.imag() }, parts(b), parts(out), n);
+            return;
+        }
+        std::vector<std::complex<double>> q(n);
+        complex_sv(op, Parts{ a.real(), a.imag() }, parts(b), parts(q.data()), n);
+        for (size_t i = 0; i < n; ++i) out[i] = finite(q[i]) ? q[i] : a / b[i];
+    }
+
+} // namespace aleph3::kernels
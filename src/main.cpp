@@ -1,18 +1,28 @@
 ﻿#include "expr/Expr.hpp"
 #include "expr/FullForm.hpp"
+#include "expr/Printer.hpp"
 #include "evaluator/Evaluator.hpp"
 #include "evaluator/EvaluationContext.hpp"
 #include "evaluator/BuiltInFunctions.hpp"
+#include "evaluator/Profiler.hpp"
 #include "parser/Parser.hpp"
 #include "help/HelpTexts.hpp"
+#include "cli/Batch.hpp"
+#include "server/Server.hpp"
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <map>
 #include <algorithm>
 #include <locale>
+#include <csignal>
 #ifdef _WIN32
 #include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
 #endif
 
 using namespace aleph3;
@@ -56,7 +66,111 @@ void show_paginated(const std::vector<std::string>& lines, size_t page_size = 20
     }
 }
 
-int main() {
+void print_usage(std::ostream& out) {
+    out << "Usage: aleph3 [options]\n"
+        << "  -f, --file FILE    Run the statements of FILE and exit\n"
+        << "  -i, --interactive  Start the REPL even if standard input is not a terminal\n"
+        << "      --labels       Print Out[n]= before each result of a script\n"
+        << "      --stop-on-error  Stop a script at its first error\n"
+        << "      --profile      Write a flat profile of the script to standard error\n"
+        << "      --trace FILE   Write a Chrome trace of the script's evaluation to FILE\n"
+        << "      --serve ADDR   Serve JSON-lines requests on ADDR: unix:PATH, tcp:[HOST:]PORT,\n"
+        << "                     or - for standard input and output\n"
+        << "      --workers N    Evaluation threads of the server (default: one per core)\n"
+        << "      --timeout MS   Default time limit of a server request (default: 10000)\n"
+        << "  -h, --help         Show this help\n"
+        << "Without -f, a script piped into standard input runs in batch mode.\n";
+}
+
+bool stdin_is_terminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdin)) != 0;
+#else
+    return isatty(fileno(stdin)) != 0;
+#endif
+}
+
+// Runs a script from `path`, or from standard input if path is empty; the exit status is 1
+// if any statement failed and 2 if the file cannot be read
+// Writes the profiler's trace to `path`; false if the file cannot be written
+bool write_trace_file(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (file) Profiler::instance().write_trace(file);
+    return static_cast<bool>(file);
+}
+
+// :profile on | trace | off | save FILE, or :profile alone for the flat profile so far
+void run_profile_command(const std::string& input) {
+    std::istringstream words(input);
+    std::string command, argument;
+    words >> command >> command >> argument;
+    auto& profiler = Profiler::instance();
+    if (command.empty()) profiler.write_flat_profile(std::cout);
+    else if (command == "on" || command == "trace") profiler.start(command == "trace");
+    else if (command == "off") profiler.stop();
+    else if (command == "save" && !argument.empty()) {
+        if (!write_trace_file(argument)) std::cout << COLOR_ERR << "Error: cannot write '" << argument << "'" << COLOR_RESET << std::endl;
+    }
+    else std::cout << COLOR_ERR << "Usage: :profile [on | trace | off | save FILE]" << COLOR_RESET << std::endl;
+}
+
+int run_batch(const std::string& path, BatchOptions options) {
+    // Results are written in blocks, not per line
+    std::ios::sync_with_stdio(false);
+    EvaluationContext ctx;
+    aleph3::register_built_in_functions();
+
+    std::string source;
+    if (!path.empty()) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "aleph3: cannot open '" << path << "'\n";
+            return 2;
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        source = std::move(contents).str();
+        options.source_name = path;
+    }
+
+    BatchRunner runner(ctx, std::cout, std::cerr, options);
+    if (path.empty()) runner.run(std::cin);
+    else runner.run(source);
+    std::cout.flush();
+    return runner.failures() == 0 ? 0 : 1;
+}
+
+Server* active_server = nullptr;
+
+extern "C" void stop_server(int) {
+    if (active_server) active_server->stop();
+}
+
+// Serves requests on `address` until interrupted, or until standard input ends for "-"
+int run_server(const std::string& address, const ServerOptions& options) {
+    std::ios::sync_with_stdio(false);
+    aleph3::register_built_in_functions();
+    try {
+        Server server(options);
+        if (address == "-") {
+            server.serve(std::cin, std::cout);
+            return 0;
+        }
+        active_server = &server;
+        std::signal(SIGINT, stop_server);
+        std::signal(SIGTERM, stop_server);
+        server.listen(address);
+        active_server = nullptr;
+        return 0;
+    }
+    catch (const std::exception& ex) {
+        active_server = nullptr;
+        std::cerr << "aleph3: " << ex.what() << '\n';
+        return 2;
+    }
+}
+
+int run_repl() {
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
@@ -77,10 +191,15 @@ int main() {
         if (input == "exit") break;
         if (input.empty()) continue;
 
+        if (input == ":profile" || input.starts_with(":profile ")) {
+            run_profile_command(input);
+            continue;
+        }
+
         if (input == "?" || input == "help") {
             std::map<std::string, std::vector<std::pair<std::string, std::string>>> categories;
             for (const auto& entry : aleph3::get_help_entries()) {
-                categories[entry.category].emplace_back(entry.name, entry.description);
+                categories[std::string(entry.category)].emplace_back(entry.name, entry.description);
             }
             std::vector<std::string> lines;
             lines.push_back(COLOR_BOLD "Available functions:" COLOR_RESET);
@@ -99,10 +218,7 @@ int main() {
             std::string func = input.substr(1);
             func.erase(0, func.find_first_not_of(" \t"));
             func.erase(func.find_last_not_of(" \t") + 1);
-            const auto& entries = aleph3::get_help_entries();
-            auto it = std::find_if(entries.begin(), entries.end(),
-                [&](const aleph3::HelpEntry& e) { return e.name == func; });
-            if (it != entries.end()) {
+            if (const auto* it = aleph3::find_help_entry(func)) {
                 std::cout << COLOR_FUNC << it->name << COLOR_RESET << ": "
                     << COLOR_DESC << it->description << COLOR_RESET << std::endl;
             }
@@ -132,46 +248,19 @@ int main() {
             auto result = evaluate(expr, ctx);
             ctx.variables[varname] = result;
 
-            std::cout << COLOR_OUT << "Out[" << counter << "]= " << COLOR_RESET
-                << COLOR_FUNC << varname << COLOR_RESET << " = "
-                << COLOR_DESC << to_string(result) << COLOR_RESET << std::endl;
+            OutputBuffer out(std::cout);
+            out.append(COLOR_OUT "Out[" + std::to_string(counter) + "]= " COLOR_RESET COLOR_FUNC + varname + COLOR_RESET " = " COLOR_DESC);
+            write_expr(out, *result);
+            out.append(COLOR_RESET "\n");
             counter++;
             continue;
         }
 
         try {
-            auto expr = parse_expression(input);
-
-            // Handle function definition
-            if (auto def = std::get_if<FunctionDefinition>(&*expr)) {
-                ctx.user_functions[def->name] = *def;
-                std::cout << COLOR_OUT << "Out[" << counter << "]= " << COLOR_RESET
-                    << COLOR_DESC << to_string(*expr) << COLOR_RESET << std::endl;
-                counter++;
-                continue;
-            }
-
-            // Check for FullForm[expr]
-            if (auto* call = std::get_if<FunctionCall>(&*expr)) {
-                if (call->head == "FullForm" && call->args.size() == 1) {
-                    std::cout << COLOR_OUT << "Out[" << counter << "]= " << COLOR_RESET
-                        << to_fullform(call->args[0]) << std::endl;
-                    counter++;
-                    continue;
-                }
-            }
-
-            // Evaluate and simplify expression
-            auto result = evaluate(expr, ctx);
-            auto simplified = simplify(result);
-
-            std::cout << COLOR_OUT << "Out[" << counter << "]= " << COLOR_RESET;
-            if (auto num = std::get_if<Number>(&*simplified)) {
-                std::cout << COLOR_NUM << num->value << COLOR_RESET << std::endl;
-            }
-            else {
-                std::cout << COLOR_DESC << to_string(simplified) << COLOR_RESET << std::endl;
-            }
+            // Definitions, FullForm and simplified results print as in batch mode
+            OutputBuffer out(std::cout);
+            const std::string label = COLOR_OUT "Out[" + std::to_string(counter) + "]= " COLOR_RESET COLOR_DESC;
+            if (write_statement(parse_expression(input), false, ctx, out, label, true)) out.append(COLOR_RESET "\n");
         }
         catch (const std::exception& ex) {
             std::cout << COLOR_ERR << "Error: " << ex.what() << COLOR_RESET << std::endl;
@@ -183,3 +272,75 @@ int main() {
     std::cout << COLOR_BOLD << "Goodbye!" << COLOR_RESET << std::endl;
     return 0;
 }
+
+int main(int argc, char** argv) {
+    std::string path;
+    bool interactive = false;
+    BatchOptions options;
+    std::string serve_address;
+    ServerOptions server_options;
+    bool profile = false;
+    std::string trace_path;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "-f" || arg == "--file") && i + 1 < argc) {
+            path = argv[++i];
+        }
+        else if (arg == "-i" || arg == "--interactive") {
+            interactive = true;
+        }
+        else if (arg == "--labels") {
+            options.labels = true;
+        }
+        else if (arg == "--stop-on-error") {
+            options.stop_on_error = true;
+        }
+        else if (arg == "--profile") {
+            profile = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else if (arg == "--serve" && i + 1 < argc) {
+            serve_address = argv[++i];
+        }
+        else if ((arg == "--workers" || arg == "--timeout") && i + 1 < argc) {
+            const std::string value = argv[++i];
+            size_t n = 0;
+            try {
+                size_t used = 0;
+                n = std::stoul(value, &used);
+                if (used != value.size()) throw std::invalid_argument(value);
+            }
+            catch (const std::exception&) {
+                std::cerr << "aleph3: invalid value '" << value << "' for " << arg << '\n';
+                return 2;
+            }
+            if (arg == "--workers") server_options.workers = n;
+            else server_options.default_timeout = std::chrono::milliseconds(n);
+        }
+        else if (arg == "-h" || arg == "--help") {
+            print_usage(std::cout);
+            return 0;
+        }
+        else {
+            std::cerr << "aleph3: unknown option '" << arg << "'\n";
+            print_usage(std::cerr);
+            return 2;
+        }
+    }
+
+    if (!serve_address.empty()) return run_server(serve_address, server_options);
+    if (path.empty() && (interactive || stdin_is_terminal())) return run_repl();
+    if (!profile && trace_path.empty()) return run_batch(path, options);
+
+    Profiler::instance().start(!trace_path.empty());
+    int status = run_batch(path, options);
+    Profiler::instance().stop();
+    if (profile) Profiler::instance().write_flat_profile(std::cerr);
+    if (!trace_path.empty() && !write_trace_file(trace_path)) {
+        std::cerr << "aleph3: cannot write '" << trace_path << "'\n";
+        status = 2;
+    }
+    return status;
+}
@@ -0,0 +1,265 @@
+#include "server/Protocol.hpp"
+
+#include <charconv>
+
+namespace aleph3 {
+
+    namespace {
+        // Nesting allowed inside ignored members
+        constexpr int MAX_DEPTH = 64;
+
+        class JsonReader {
+        public:
+            explicit JsonReader(std::string_view text) : text(text) {}
+
+            void skip_space() {
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) ++pos;
+            }
+
+            bool at_end() {
+                skip_space();
+                return pos == text.size();
+            }
+
+            char peek() {
+                skip_space();
+                return pos < text.size() ? text[pos] : '\0';
+            }
+
+            void expect(char c) {
+                if (peek() != c) fail(std::string("expected '") + c + "'");
+                ++pos;
+            }
+
+            bool consume(char c) {
+                if (peek() != c) return false;
+                ++pos;
+                return true;
+            }
+
+            std::string string() {
+                expect('"');
+                std::string out;
+                while (true) {
+                    if (pos == text.size()) fail("unterminated string");
+                    const char c = text[pos++];
+                    if (c == '"') return out;
+                    if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+                    if (c != '\\') {
+                        out += c;
+                        continue;
+                    }
+                    if (pos == text.size()) fail("unterminated string");
+                    switch (text[pos++]) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': append_utf8(out, code_point()); break;
+                    default: fail("invalid escape");
+                    }
+                }
+            }
+
+            // The JSON text of a number
+            std::string_view number() {
+                skip_space();
+                const size_t start = pos;
+                if (pos < text.size() && text[pos] == '-') ++pos;
+                auto digits = [&] {
+                    const size_t from = pos;
+                    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') ++pos;
+                    return pos > from;
+                };
+                if (!digits()) fail("invalid number");
+                if (pos < text.size() && text[pos] == '.') {
+                    ++pos;
+                    if (!digits()) fail("invalid number");
+                }
+                if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+                    ++pos;
+                    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) ++pos;
+                    if (!digits()) fail("invalid number");
+                }
+                return text.substr(start, pos - start);
+            }
+
+            // The JSON text of any value, checked but not decoded
+            std::string_view value(int depth = 0) {
+                if (depth > MAX_DEPTH) fail("nesting too deep");
+                skip_space();
+                const size_t start = pos;
+                switch (peek()) {
+                case '"': string(); break;
+                case '{':
+                    ++pos;
+                    if (!consume('}')) {
+                        do {
+                            string();
+                            expect(':');
+                            value(depth + 1);
+                        } while (consume(','));
+                        expect('}');
+                    }
+                    break;
+                case '[':
+                    ++pos;
+                    if (!consume(']')) {
+                        do {
+                            value(depth + 1);
+                        } while (consume(','));
+                        expect(']');
+                    }
+                    break;
+                case 't': word("true"); break;
+                case 'f': word("false"); break;
+                case 'n': word("null"); break;
+                default: number(); break;
+                }
+                return text.substr(start, pos - start);
+            }
+
+            [[noreturn]] void fail(const std::string& what) const {
+                throw ProtocolError("Invalid request: " + what + " at offset " + std::to_string(pos));
+            }
+
+        private:
+            std::string_view text;
+            size_t pos = 0;
+
+            void word(std::string_view w) {
+                if (text.compare(pos, w.size(), w) != 0) fail("invalid value");
+                pos += w.size();
+            }
+
+            uint32_t hex4() {
+                if (text.size() - pos < 4) fail("invalid escape");
+                uint32_t value = 0;
+                auto [end, ec] = std::from_chars(text.data() + pos, text.data() + pos + 4, value, 16);
+                if (ec != std::errc() || end != text.data() + pos + 4) fail("invalid escape");
+                pos += 4;
+                return value;
+            }
+
+            uint32_t code_point() {
+                const uint32_t high = hex4();
+                if (high < 0xD800 || high > 0xDFFF) return high;
+                if (high > 0xDBFF || text.compare(pos, 2, "\\u") != 0) fail("unpaired surrogate");
+                pos += 2;
+                const uint32_t low = hex4();
+                if (low < 0xDC00 || low > 0xDFFF) fail("unpaired surrogate");
+                return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            static void append_utf8(std::string& out, uint32_t cp) {
+                if (cp < 0x80) {
+                    out += static_cast<char>(cp);
+                }
+                else if (cp < 0x800) {
+                    out += static_cast<char>(0xC0 | (cp >> 6));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+                else if (cp < 0x10000) {
+                    out += static_cast<char>(0xE0 | (cp >> 12));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+                else {
+                    out += static_cast<char>(0xF0 | (cp >> 18));
+                    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+            }
+        };
+    }
+
+    Request parse_request(std::string_view line) {
+        JsonReader reader(line);
+        Request request;
+        reader.expect('{');
+        if (!reader.consume('}')) {
+            do {
+                const std::string key = reader.string();
+                reader.expect(':');
+                if (key == "id") {
+                    request.id = std::string(reader.value());
+                }
+                else if (key == "session" || key == "op" || key == "input") {
+                    if (reader.peek() != '"') reader.fail("'" + key + "' must be a string");
+                    std::string value = reader.string();
+                    if (key == "session") request.session = std::move(value);
+                    else if (key == "op") request.op = std::move(value);
+                    else request.input = std::move(value);
+                }
+                else if (key == "timeout_ms") {
+                    const auto text = reader.number();
+                    int64_t ms = 0;
+                    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), ms);
+                    if (ec != std::errc() || end != text.data() + text.size() || ms < 0) {
+                        reader.fail("'timeout_ms' must be a non-negative integer");
+                    }
+                    request.timeout_ms = ms;
+                }
+                else {
+                    reader.value();
+                }
+            } while (reader.consume(','));
+            reader.expect('}');
+        }
+        if (!reader.at_end()) reader.fail("trailing characters");
+        if (request.op != "eval" && request.op != "close" && request.op != "cancel") {
+            throw ProtocolError("Invalid request: unknown op '" + request.op + "'");
+        }
+        return request;
+    }
+
+    std::string json_quote(std::string_view s) {
+        static constexpr char HEX[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(s.size() + 2);
+        out += '"';
+        for (char c : s) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 0xF];
+                }
+                else {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+        return out;
+    }
+
+    std::string format_response(const Response& response) {
+        std::string out = "{\"id\": " + response.id + ", \"session\": " + json_quote(response.session) +
+                          ", \"ok\": " + (response.ok ? "true" : "false") + ", \"results\": [";
+        for (size_t i = 0; i < response.results.size(); ++i) {
+            if (i > 0) out += ", ";
+            out += json_quote(response.results[i]);
+        }
+        out += ']';
+        if (!response.ok) {
+            out += ", \"code\": " + json_quote(response.code);
+            if (response.line > 0) out += ", \"line\": " + std::to_string(response.line);
+            out += ", \"error\": " + json_quote(response.error);
+        }
+        out += '}';
+        return out;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,442 @@
+#include "server/Server.hpp"
+#include "cli/Batch.hpp"
+#include "evaluator/Attributes.hpp"
+#include "evaluator/Budget.hpp"
+#include "evaluator/EvaluationContext.hpp"
+#include "parser/Statements.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <list>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace aleph3 {
+
+    struct Server::Task {
+        Request request;
+        std::shared_ptr<Connection> connection;
+        CancelToken cancel;
+    };
+
+    struct Server::Session {
+        std::string name;
+        EvaluationContext ctx;
+        SymbolAttributes attributes;
+        std::deque<Task> queue;
+        bool scheduled = false;  // In `ready` or running on a worker
+        CancelToken cancel;      // Shared by the requests queued since the last "cancel"
+
+        Session() { ctx.attributes = &attributes; }
+    };
+
+    // Where the responses of one client go. Writes are serialized, and the reader waits for
+    // the connection's outstanding requests before it lets the connection go.
+    struct Server::Connection {
+        std::function<void(const std::string&)> write;
+        std::mutex mutex;
+        std::condition_variable idle;
+        size_t outstanding = 0;
+
+        void send(const Response& response) {
+            std::string line = format_response(response);
+            line += '\n';
+            std::lock_guard lock(mutex);
+            write(line);
+        }
+
+        void begin() {
+            std::lock_guard lock(mutex);
+            ++outstanding;
+        }
+
+        void finish() {
+            std::lock_guard lock(mutex);
+            if (--outstanding == 0) idle.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock lock(mutex);
+            idle.wait(lock, [&] { return outstanding == 0; });
+        }
+    };
+
+    namespace {
+        Response failure(std::string id, std::string session, std::string code, std::string error) {
+            Response response;
+            response.id = std::move(id);
+            response.session = std::move(session);
+            response.ok = false;
+            response.code = std::move(code);
+            response.error = std::move(error);
+            return response;
+        }
+    }
+
+    Server::Server(ServerOptions options) : options(options) {
+        size_t count = options.workers;
+        if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+        workers.reserve(count);
+        for (size_t i = 0; i < count; ++i) workers.emplace_back([this] { worker_loop(); });
+    }
+
+    Server::~Server() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        work.notify_all();
+        space.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t Server::session_count() {
+        std::lock_guard lock(mutex);
+        return sessions.size();
+    }
+
+    void Server::submit(std::string_view line, const std::shared_ptr<Connection>& connection) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") == std::string_view::npos) return;
+        if (line.size() > options.max_request_bytes) {
+            connection->send(failure("null", "", "bad_request", "Request too large"));
+            return;
+        }
+
+        Request request;
+        try {
+            request = parse_request(line);
+        }
+        catch (const ProtocolError& ex) {
+            connection->send(failure("null", "", "bad_request", ex.what()));
+            return;
+        }
+
+        std::unique_lock lock(mutex);
+        if (request.op == "cancel") {
+            // Answered at once rather than queued behind the requests it stops
+            auto it = sessions.find(request.session);
+            if (it != sessions.end()) {
+                it->second->cancel.cancel();
+                it->second->cancel = CancelToken();
+            }
+            lock.unlock();
+            Response response;
+            response.id = request.id;
+            response.session = request.session;
+            connection->send(response);
+            return;
+        }
+        space.wait(lock, [&] { return pending < options.max_pending || stopping; });
+        auto it = sessions.find(request.session);
+        if (it == sessions.end()) {
+            std::optional<Response> answer;
+            if (request.op == "close") {
+                // Nothing to discard
+                answer.emplace();
+                answer->id = request.id;
+                answer->session = request.session;
+            }
+            else if (sessions.size() >= options.max_sessions) {
+                answer = failure(request.id, request.session, "busy", "Too many sessions");
+            }
+            if (answer) {
+                lock.unlock();
+                connection->send(*answer);
+                return;
+            }
+            auto session = std::make_shared<Session>();
+            session->name = request.session;
+            it = sessions.emplace(request.session, std::move(session)).first;
+        }
+
+        const auto& session = it->second;
+        ++pending;
+        connection->begin();
+        session->queue.push_back({ std::move(request), connection, session->cancel });
+        if (!session->scheduled) {
+            session->scheduled = true;
+            ready.push_back(session);
+            work.notify_one();
+        }
+    }
+
+    void Server::worker_loop() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            work.wait(lock, [&] { return stopping || !ready.empty(); });
+            if (ready.empty()) return;
+            auto session = std::move(ready.front());
+            ready.pop_front();
+            Task task = std::move(session->queue.front());
+            session->queue.pop_front();
+            lock.unlock();
+
+            task.connection->send(execute(*session, task.request, task.cancel));
+            task.connection->finish();
+
+            lock.lock();
+            --pending;
+            space.notify_one();
+            if (!session->queue.empty()) {
+                // Back of the line, behind the other ready sessions
+                ready.push_back(std::move(session));
+            }
+            else {
+                session->scheduled = false;
+                if (task.request.op == "close") {
+                    auto it = sessions.find(session->name);
+                    if (it != sessions.end() && it->second == session) sessions.erase(it);
+                }
+            }
+        }
+    }
+
+    Response Server::execute(Session& session, const Request& request, const CancelToken& cancel) {
+        Response response;
+        response.id = request.id;
+        response.session = request.session;
+        if (request.op == "close") {
+            session.ctx = EvaluationContext();
+            session.attributes.clear();
+            session.ctx.attributes = &session.attributes;
+            detail::bump_definitions_epoch();
+            return response;
+        }
+
+        auto limit = request.timeout_ms ? std::chrono::milliseconds(*request.timeout_ms) : options.default_timeout;
+        if (options.max_timeout.count() > 0 && (limit.count() == 0 || limit > options.max_timeout)) {
+            limit = options.max_timeout;
+        }
+        EvaluationBudget budget;
+        budget.time = limit;
+        budget.steps = options.max_steps;
+        budget.cancel = cancel;
+        BudgetScope scope(budget);
+
+        for (const auto& statement : split_statements(request.input)) {
+            try {
+                if (auto printed = evaluate_statement(statement, session.ctx)) {
+                    response.results.push_back(std::move(*printed));
+                }
+            }
+            catch (const BudgetExceeded& ex) {
+                response.ok = false;
+                response.error = ex.what();
+                if (ex.limit == BudgetLimit::Time) {
+                    response.code = "timeout";
+                    response.error += " (" + std::to_string(limit.count()) + " ms)";
+                }
+                else {
+                    response.code = ex.limit == BudgetLimit::Cancelled ? "cancelled" : "error";
+                }
+            }
+            catch (const std::exception& ex) {
+                response.ok = false;
+                response.code = "error";
+                response.error = ex.what();
+            }
+            if (!response.ok) {
+                response.line = statement.line;
+                break;
+            }
+        }
+        return response;
+    }
+
+    void Server::serve(std::istream& in, std::ostream& out) {
+        auto connection = std::make_shared<Connection>();
+        connection->write = [&out](const std::string& line) {
+            out << line;
+            out.flush();
+        };
+        std::string line;
+        while (std::getline(in, line)) submit(line, connection);
+        connection->wait();
+    }
+
+#ifdef _WIN32
+
+    void Server::listen(const std::string&) {
+        throw std::runtime_error("Server sockets are not supported on Windows");
+    }
+
+    void Server::serve_socket(int) {}
+
+#else
+
+    namespace {
+        [[noreturn]] void fail(const std::string& what) {
+            throw std::runtime_error(what + ": " + std::strerror(errno));
+        }
+
+        // Listening socket for "unix:PATH" or "tcp:[HOST:]PORT"
+        int open_listener(const std::string& address, std::string& unix_path) {
+            if (address.rfind("unix:", 0) == 0) {
+                unix_path = address.substr(5);
+                sockaddr_un addr{};
+                addr.sun_family = AF_UNIX;
+                if (unix_path.empty() || unix_path.size() >= sizeof(addr.sun_path)) {
+                    throw std::runtime_error("Invalid socket path '" + unix_path + "'");
+                }
+                std::memcpy(addr.sun_path, unix_path.c_str(), unix_path.size() + 1);
+                // Replace a stale socket left by an earlier run, but nothing else
+                struct stat st{};
+                if (::stat(unix_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) ::unlink(unix_path.c_str());
+                const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                if (fd < 0) fail("socket");
+                if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+                    ::close(fd);
+                    fail("Cannot listen on '" + unix_path + "'");
+                }
+                return fd;
+            }
+            if (address.rfind("tcp:", 0) != 0) {
+                throw std::runtime_error("Invalid address '" + address + "' (expected unix:PATH or tcp:[HOST:]PORT)");
+            }
+            const std::string rest = address.substr(4);
+            const size_t colon = rest.rfind(':');
+            const std::string host = colon == std::string::npos ? "127.0.0.1" : rest.substr(0, colon);
+            const std::string port = colon == std::string::npos ? rest : rest.substr(colon + 1);
+
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_PASSIVE;
+            addrinfo* found = nullptr;
+            if (const int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &found); rc != 0) {
+                throw std::runtime_error("Cannot resolve '" + rest + "': " + ::gai_strerror(rc));
+            }
+            int fd = -1;
+            for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+                fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+                if (fd < 0) continue;
+                const int on = 1;
+                ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+                if (::bind(fd, ai->ai_addr, ai->ai_addrlen) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+                    ::close(fd);
+                    fd = -1;
+                }
+            }
+            ::freeaddrinfo(found);
+            if (fd < 0) fail("Cannot listen on '" + rest + "'");
+            return fd;
+        }
+
+        int local_port(int fd) {
+            sockaddr_storage addr{};
+            socklen_t length = sizeof(addr);
+            if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0) return 0;
+            if (addr.ss_family == AF_INET) return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+            if (addr.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+            return 0;
+        }
+
+        void send_all(int fd, const std::string& data) {
+#ifdef MSG_NOSIGNAL
+            constexpr int flags = MSG_NOSIGNAL;
+#else
+            constexpr int flags = 0;
+#endif
+            size_t sent = 0;
+            while (sent < data.size()) {
+                const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, flags);
+                if (n < 0 && errno == EINTR) continue;
+                // The client is gone; its remaining responses are dropped
+                if (n <= 0) return;
+                sent += static_cast<size_t>(n);
+            }
+        }
+    }
+
+    void Server::listen(const std::string& address) {
+        std::string unix_path;
+        const int listener = open_listener(address, unix_path);
+        bound_port.store(local_port(listener));
+
+        struct Client {
+            int fd;
+            std::thread thread;
+            std::atomic<bool> done{ false };
+        };
+        std::list<Client> clients;
+        auto reap = [&](bool all) {
+            for (auto it = clients.begin(); it != clients.end();) {
+                if (!all && !it->done.load()) {
+                    ++it;
+                    continue;
+                }
+                ::shutdown(it->fd, SHUT_RDWR);
+                it->thread.join();
+                ::close(it->fd);
+                it = clients.erase(it);
+            }
+        };
+
+        while (!stop_requested.load()) {
+            pollfd waiting{ listener, POLLIN, 0 };
+            // Wake up now and then to notice stop()
+            if (::poll(&waiting, 1, 100) <= 0) {
+                reap(false);
+                continue;
+            }
+            const int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) continue;
+            auto& client = clients.emplace_back();
+            client.fd = fd;
+            client.thread = std::thread([this, &client] {
+                serve_socket(client.fd);
+                client.done.store(true);
+            });
+            reap(false);
+        }
+
+        reap(true);
+        ::close(listener);
+        if (!unix_path.empty()) ::unlink(unix_path.c_str());
+        bound_port.store(0);
+    }
+
+    void Server::serve_socket(int fd) {
+        auto connection = std::make_shared<Connection>();
+        connection->write = [fd](const std::string& line) { send_all(fd, line); };
+        std::string buffer;
+        std::vector<char> chunk(64 * 1024);
+        while (true) {
+            const ssize_t n = ::recv(fd, chunk.data(), chunk.size(), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            buffer.append(chunk.data(), static_cast<size_t>(n));
+            size_t start = 0;
+            for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1) {
+                submit(std::string_view(buffer).substr(start, end - start), connection);
+            }
+            buffer.erase(0, start);
+            if (buffer.size() > options.max_request_bytes) {
+                // No line end in sight; there is no way to resynchronize
+                connection->send(failure("null", "", "bad_request", "Request too large"));
+                buffer.clear();
+                break;
+            }
+        }
+        if (!buffer.empty()) submit(buffer, connection);
+        connection->wait();
+    }
+
+#endif
+
+} // namespace aleph3
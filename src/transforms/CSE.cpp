@@ -0,0 +1,140 @@
+#include "transforms/CSE.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprUtils.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace aleph3 {
+
+    namespace {
+        // A call or list by its head and the classes of its children
+        struct Key {
+            Atom head;
+            bool list;
+            std::vector<uint32_t> children;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                size_t h = std::hash<Atom>()(key.head) ^ (key.list ? 0x51ed270b : 0);
+                for (uint32_t child : key.children) h ^= child + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+
+        struct Class {
+            ExprPtr node;       // A representative
+            bool compound;
+            std::vector<uint32_t> children;
+            size_t uses = 0;    // Parent positions, counting each parent class once
+        };
+
+        const std::vector<ExprPtr>* children_of(const Expr& e) {
+            if (auto f = std::get_if<FunctionCall>(&e)) return &f->args;
+            if (auto l = std::get_if<List>(&e)) return &l->elements;
+            return nullptr;
+        }
+    }
+
+    CommonSubexpressions eliminate_common_subexpressions(const ExprPtr& expr) {
+        std::vector<Class> classes;
+        std::unordered_map<const Expr*, uint32_t> class_of;
+        std::unordered_map<Key, uint32_t, KeyHash> calls;
+        std::unordered_map<ExprPtr, uint32_t, ExprPtrHash, ExprPtrEqual> leaves;
+        std::unordered_set<Atom> symbols;
+
+        auto leaf = [&](const ExprPtr& e) {
+            if (auto sym = std::get_if<Symbol>(e.get())) symbols.insert(sym->name);
+            auto [it, added] = leaves.try_emplace(e, static_cast<uint32_t>(classes.size()));
+            if (added) classes.push_back({ e, false, {} });
+            return it->second;
+        };
+
+        // Post-order over the distinct nodes: children get lower ids than their parents
+        struct Frame {
+            ExprPtr node;
+            size_t next = 0;
+            std::vector<uint32_t> children{};
+        };
+        uint32_t root = 0;
+        if (!children_of(*expr)) {
+            root = leaf(expr);
+        }
+        else {
+            std::vector<Frame> stack{ { expr } };
+            while (!stack.empty()) {
+                Frame& top = stack.back();
+                const auto& args = *children_of(*top.node);
+                if (top.next < args.size()) {
+                    const ExprPtr& arg = args[top.next++];
+                    if (auto it = class_of.find(arg.get()); it != class_of.end()) top.children.push_back(it->second);
+                    else if (children_of(*arg)) stack.push_back({ arg });
+                    else top.children.push_back(leaf(arg));
+                    continue;
+                }
+                auto call = std::get_if<FunctionCall>(top.node.get());
+                Key key{ call ? call->head : Atom(), !call, std::move(top.children) };
+                auto [it, added] = calls.try_emplace(std::move(key), static_cast<uint32_t>(classes.size()));
+                if (added) {
+                    for (uint32_t child : it->first.children) ++classes[child].uses;
+                    classes.push_back({ top.node, true, it->first.children });
+                }
+                const uint32_t id = it->second;
+                class_of.emplace(top.node.get(), id);
+                stack.pop_back();
+                if (stack.empty()) root = id;
+                else stack.back().children.push_back(id);
+            }
+        }
+
+        // Rebuild in id order, naming the calls used more than once
+        CommonSubexpressions result;
+        std::vector<ExprPtr> refs(classes.size());
+        size_t counter = 0;
+        auto fresh_name = [&] {
+            while (true) {
+                Atom name("c" + std::to_string(++counter));
+                if (!symbols.count(name)) return name;
+            }
+        };
+        for (uint32_t id = 0; id < classes.size(); ++id) {
+            const Class& c = classes[id];
+            if (!c.compound) {
+                refs[id] = c.node;
+                continue;
+            }
+            std::vector<ExprPtr> args;
+            args.reserve(c.children.size());
+            for (uint32_t child : c.children) args.push_back(refs[child]);
+            ExprPtr node;
+            if (auto call = std::get_if<FunctionCall>(c.node.get())) node = make_fcall(call->head, std::move(args));
+            else node = make_expr<List>(std::move(args));
+            if (c.uses > 1 && id != root) {
+                Atom name = fresh_name();
+                result.bindings.emplace_back(name, std::move(node));
+                refs[id] = make_expr<Symbol>(name);
+            }
+            else {
+                refs[id] = std::move(node);
+            }
+        }
+        result.body = refs[root];
+        return result;
+    }
+
+    ExprPtr to_with(const CommonSubexpressions& cse) {
+        if (cse.bindings.empty()) return cse.body;
+        std::vector<ExprPtr> rules;
+        rules.reserve(cse.bindings.size());
+        for (const auto& [name, value] : cse.bindings) {
+            rules.push_back(make_expr<Rule>(make_expr<Symbol>(name), value));
+        }
+        static const Atom with("With");
+        return make_fcall(with, { make_expr<List>(std::move(rules)), cse.body });
+    }
+
+} // namespace aleph3
@@ -0,0 +1,256 @@
+#include "transforms/Derivative.hpp"
+#include "expr/ExprUtils.hpp"
+
+#include <unordered_map>
+
+namespace aleph3 {
+
+    namespace {
+        bool is_value(const ExprPtr& e, double v) {
+            auto n = std::get_if<Number>(e.get());
+            return n && n->value == v;
+        }
+
+        // a * b without factors of 1; nullptr stands for 0 throughout
+        ExprPtr times(const ExprPtr& a, const ExprPtr& b) {
+            if (is_value(a, 1)) return b;
+            if (is_value(b, 1)) return a;
+            return make_fcall(atoms::Times, { a, b });
+        }
+
+        ExprPtr negative(const ExprPtr& e) { return times(make_number(-1), e); }
+
+        ExprPtr power(const ExprPtr& u, double n) { return make_fcall(atoms::Power, { u, make_number(n) }); }
+
+        ExprPtr fcall(Atom head, const ExprPtr& u) { return make_fcall(head, { u }); }
+
+        ExprPtr sum(std::vector<ExprPtr> terms) {
+            if (terms.empty()) return nullptr;
+            if (terms.size() == 1) return terms[0];
+            return make_fcall(atoms::Plus, std::move(terms));
+        }
+
+        const std::vector<ExprPtr>* children_of(const Expr& e) {
+            if (auto f = std::get_if<FunctionCall>(&e)) return &f->args;
+            if (auto l = std::get_if<List>(&e)) return &l->elements;
+            return nullptr;
+        }
+
+        // d f[u] / du for the elementary functions, or nullptr
+        ExprPtr unary_derivative(Atom head, const ExprPtr& u) {
+            auto one_minus_square = [&] { return make_fcall(atoms::Plus, { make_number(1), negative(power(u, 2)) }); };
+            if (head == atoms::Sin) return fcall(atoms::Cos, u);
+            if (head == atoms::Cos) return negative(fcall(atoms::Sin, u));
+            if (head == atoms::Tan) return power(fcall(atoms::Sec, u), 2);
+            if (head == atoms::Cot) return negative(power(fcall(atoms::Csc, u), 2));
+            if (head == atoms::Sec) return times(fcall(atoms::Sec, u), fcall(atoms::Tan, u));
+            if (head == atoms::Csc) return negative(times(fcall(atoms::Cot, u), fcall(atoms::Csc, u)));
+            if (head == atoms::Sinh) return fcall(atoms::Cosh, u);
+            if (head == atoms::Cosh) return fcall(atoms::Sinh, u);
+            if (head == atoms::Tanh) return power(fcall(atoms::Sech, u), 2);
+            if (head == atoms::Coth) return negative(power(fcall(atoms::Csch, u), 2));
+            if (head == atoms::Sech) return negative(times(fcall(atoms::Sech, u), fcall(atoms::Tanh, u)));
+            if (head == atoms::Csch) return negative(times(fcall(atoms::Coth, u), fcall(atoms::Csch, u)));
+            if (head == atoms::ArcSin) return power(fcall(atoms::Sqrt, one_minus_square()), -1);
+            if (head == atoms::ArcCos) return negative(power(fcall(atoms::Sqrt, one_minus_square()), -1));
+            if (head == atoms::ArcTan) return power(make_fcall(atoms::Plus, { make_number(1), power(u, 2) }), -1);
+            if (head == atoms::Exp) return fcall(atoms::Exp, u);
+            if (head == atoms::Log) return power(u, -1);
+            if (head == atoms::Sqrt) return times(make_number(0.5), power(fcall(atoms::Sqrt, u), -1));
+            return nullptr;
+        }
+
+        // d node / d args[i], or nullptr if the head has no known derivative
+        ExprPtr partial(const ExprPtr& node, size_t i) {
+            const auto& f = std::get<FunctionCall>(*node);
+            const auto& args = f.args;
+            if (f.head == atoms::Plus) return make_number(1);
+            if (f.head == atoms::Times) {
+                if (args.size() == 2) return args[1 - i];
+                std::vector<ExprPtr> others;
+                others.reserve(args.size() - 1);
+                for (size_t k = 0; k < args.size(); ++k) {
+                    if (k != i) others.push_back(args[k]);
+                }
+                return make_fcall(atoms::Times, std::move(others));
+            }
+            if (f.head == atoms::Negate && args.size() == 1) return make_number(-1);
+            if (f.head == atoms::Minus && args.size() <= 2) return make_number(i == 0 && args.size() == 2 ? 1 : -1);
+            if (f.head == atoms::Divide && args.size() == 2) {
+                if (i == 0) return power(args[1], -1);
+                return make_fcall(atoms::Times, { make_number(-1), args[0], power(args[1], -2) });
+            }
+            if (f.head == atoms::Power && args.size() == 2) {
+                const ExprPtr& u = args[0];
+                const ExprPtr& v = args[1];
+                if (i == 1) return times(fcall(atoms::Log, u), node);  // d u^v / dv = Log[u] u^v
+                if (auto n = std::get_if<Number>(v.get())) {
+                    if (n->value == 1) return make_number(1);
+                    return times(v, n->value == 2 ? u : power(u, n->value - 1));
+                }
+                return times(v, make_fcall(atoms::Power, { u, make_fcall(atoms::Plus, { v, make_number(-1) }) }));
+            }
+            if (args.size() == 1) return unary_derivative(f.head, args[0]);
+            return nullptr;
+        }
+    }
+
+    ExprPtr differentiate(const ExprPtr& expr, Atom x) {
+        auto leaf = [x](const ExprPtr& e) -> ExprPtr {
+            auto sym = std::get_if<Symbol>(e.get());
+            return sym && sym->name == x ? make_number(1) : nullptr;
+        };
+        if (!children_of(*expr)) {
+            ExprPtr d = leaf(expr);
+            return d ? d : make_number(0);
+        }
+
+        // Post-order over the distinct nodes; the derivative of each is computed once
+        std::unordered_map<const Expr*, ExprPtr> derivative;
+        auto derivative_of = [&](const ExprPtr& e) {
+            return children_of(*e) ? derivative.at(e.get()) : leaf(e);
+        };
+        struct Frame {
+            const ExprPtr* node;
+            size_t next = 0;
+        };
+        std::vector<Frame> stack{ { &expr } };
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            const ExprPtr& node = *top.node;
+            const auto& args = *children_of(*node);
+            if (top.next < args.size()) {
+                const ExprPtr& arg = args[top.next++];
+                if (children_of(*arg) && !derivative.count(arg.get())) stack.push_back({ &arg });
+                continue;
+            }
+            stack.pop_back();
+            if (derivative.count(node.get())) continue;  // Reached twice before its first visit finished
+
+            ExprPtr d;
+            if (std::holds_alternative<List>(*node)) {
+                std::vector<ExprPtr> elements;
+                elements.reserve(args.size());
+                bool any = false;
+                for (const auto& arg : args) {
+                    ExprPtr e = derivative_of(arg);
+                    any |= e != nullptr;
+                    elements.push_back(e ? e : make_number(0));
+                }
+                if (any) d = make_fcall(atoms::List, std::move(elements));
+            }
+            else {
+                std::vector<ExprPtr> terms;
+                for (size_t i = 0; i < args.size(); ++i) {
+                    ExprPtr di = derivative_of(args[i]);
+                    if (!di) continue;
+                    ExprPtr p = partial(node, i);
+                    if (!p) {
+                        terms = { make_fcall(atoms::D, { node, make_expr<Symbol>(x) }) };
+                        break;
+                    }
+                    terms.push_back(times(p, di));
+                }
+                d = sum(std::move(terms));
+            }
+            derivative.emplace(node.get(), std::move(d));
+        }
+        ExprPtr d = derivative.at(expr.get());
+        return d ? d : make_number(0);
+    }
+
+    ExprPtr gradient(const ExprPtr& expr, const std::vector<Atom>& vars) {
+        if (auto list = std::get_if<List>(expr.get())) {
+            std::vector<ExprPtr> rows;
+            rows.reserve(list->elements.size());
+            for (const auto& element : list->elements) rows.push_back(gradient(element, vars));
+            return make_fcall(atoms::List, std::move(rows));
+        }
+
+        std::unordered_map<Atom, size_t> index;
+        for (size_t k = 0; k < vars.size(); ++k) index.emplace(vars[k], k);
+        std::vector<std::vector<ExprPtr>> grads(vars.size());
+        auto var_of = [&](const ExprPtr& e) -> const size_t* {
+            auto sym = std::get_if<Symbol>(e.get());
+            if (!sym) return nullptr;
+            auto it = index.find(sym->name);
+            return it != index.end() ? &it->second : nullptr;
+        };
+
+        // Post-order over the distinct calls, noting which depend on a variable. Lists
+        // inside an expression are counted as dependent, and their parent falls back to D[].
+        std::vector<const ExprPtr*> order;
+        std::unordered_map<const Expr*, bool> depends;
+        auto depends_on = [&](const ExprPtr& e) {
+            if (std::holds_alternative<FunctionCall>(*e)) return depends.at(e.get());
+            return var_of(e) != nullptr || std::holds_alternative<List>(*e);
+        };
+        if (std::holds_alternative<FunctionCall>(*expr)) {
+            struct Frame {
+                const ExprPtr* node;
+                size_t next = 0;
+            };
+            std::vector<Frame> stack{ { &expr } };
+            while (!stack.empty()) {
+                Frame& top = stack.back();
+                const ExprPtr& node = *top.node;
+                const auto& args = std::get<FunctionCall>(*node).args;
+                if (top.next < args.size()) {
+                    const ExprPtr& arg = args[top.next++];
+                    if (std::holds_alternative<FunctionCall>(*arg) && !depends.count(arg.get())) stack.push_back({ &arg });
+                    continue;
+                }
+                stack.pop_back();
+                if (depends.count(node.get())) continue;
+                bool any = false;
+                for (const auto& arg : args) any |= depends_on(arg);
+                depends.emplace(node.get(), any);
+                order.push_back(&node);
+            }
+        }
+        else if (const size_t* k = var_of(expr)) {
+            grads[*k].push_back(make_number(1));
+        }
+
+        // Reverse pass: each call's adjoint is complete before it is passed to its arguments
+        std::unordered_map<const Expr*, std::vector<ExprPtr>> adjoint;
+        if (!order.empty()) adjoint[expr.get()].push_back(make_number(1));
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const ExprPtr& node = **it;
+            auto found = adjoint.find(node.get());
+            if (found == adjoint.end() || !depends.at(node.get())) continue;
+            const ExprPtr a = sum(std::move(found->second));
+            adjoint.erase(found);
+
+            const auto& args = std::get<FunctionCall>(*node).args;
+            std::vector<std::pair<size_t, ExprPtr>> partials;
+            bool known = true;
+            for (size_t i = 0; i < args.size() && known; ++i) {
+                if (!depends_on(args[i])) continue;
+                ExprPtr p = std::holds_alternative<List>(*args[i]) ? nullptr : partial(node, i);
+                known = p != nullptr;
+                partials.emplace_back(i, std::move(p));
+            }
+            if (!known) {
+                for (size_t k = 0; k < vars.size(); ++k) {
+                    grads[k].push_back(times(make_fcall(atoms::D, { node, make_expr<Symbol>(vars[k]) }), a));
+                }
+                continue;
+            }
+            for (auto& [i, p] : partials) {
+                ExprPtr contribution = times(p, a);
+                if (const size_t* k = var_of(args[i])) grads[*k].push_back(std::move(contribution));
+                else adjoint[args[i].get()].push_back(std::move(contribution));
+            }
+        }
+
+        std::vector<ExprPtr> result;
+        result.reserve(vars.size());
+        for (auto& terms : grads) {
+            ExprPtr g = sum(std::move(terms));
+            result.push_back(g ? g : make_number(0));
+        }
+        return make_fcall(atoms::List, std::move(result));
+    }
+
+} // namespace aleph3
@@ -0,0 +1,184 @@
+#include "transforms/EGraph.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprUtils.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace aleph3 {
+
+    bool ENode::operator==(const ENode& other) const {
+        if (head != other.head || children != other.children) return false;
+        if (!leaf || !other.leaf) return leaf == other.leaf;
+        return expr_equal(leaf, other.leaf);
+    }
+
+    size_t ENodeHash::operator()(const ENode& node) const {
+        size_t h = node.leaf ? expr_hash(node.leaf) : std::hash<Atom>()(node.head);
+        for (EClassId child : node.children) h ^= child + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    EClassId EGraph::find(EClassId id) const {
+        EClassId root = id;
+        while (parent_[root] != root) root = parent_[root];
+        while (parent_[id] != root) id = std::exchange(parent_[id], root);
+        return root;
+    }
+
+    ENode EGraph::canonical(ENode node) const {
+        for (EClassId& child : node.children) child = find(child);
+        return node;
+    }
+
+    EClassId EGraph::add(ENode node) {
+        node = canonical(std::move(node));
+        if (auto it = memo_.find(node); it != memo_.end()) return find(it->second);
+        const auto id = static_cast<EClassId>(classes_.size());
+        parent_.push_back(id);
+        classes_.push_back({ node });
+        memo_.emplace(std::move(node), id);
+        return id;
+    }
+
+    EClassId EGraph::add(const ExprPtr& expr) {
+        auto call = std::get_if<FunctionCall>(expr.get());
+        if (!call) return add(ENode{ Atom(), expr, {} });
+
+        // Post-order on an explicit stack: arguments before the call that holds them
+        struct Frame {
+            const FunctionCall* call;
+            size_t next = 0;
+            std::vector<EClassId> children{};
+        };
+        std::vector<Frame> stack{ { call } };
+        EClassId result = 0;
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.next < top.call->args.size()) {
+                const ExprPtr& arg = top.call->args[top.next++];
+                if (auto inner = std::get_if<FunctionCall>(arg.get())) stack.push_back({ inner });
+                else top.children.push_back(add(ENode{ Atom(), arg, {} }));
+                continue;
+            }
+            result = add(ENode{ top.call->head, nullptr, std::move(top.children) });
+            stack.pop_back();
+            if (!stack.empty()) stack.back().children.push_back(result);
+        }
+        return result;
+    }
+
+    bool EGraph::merge(EClassId a, EClassId b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (classes_[a].size() < classes_[b].size()) std::swap(a, b);
+        parent_[b] = a;
+        auto& into = classes_[a];
+        into.insert(into.end(), std::make_move_iterator(classes_[b].begin()), std::make_move_iterator(classes_[b].end()));
+        classes_[b].clear();
+        classes_[b].shrink_to_fit();
+        return true;
+    }
+
+    void EGraph::rebuild() {
+        while (true) {
+            // Canonicalize every node; a node found in two classes makes them equal
+            std::unordered_map<ENode, EClassId, ENodeHash> memo;
+            memo.reserve(memo_.size());
+            std::vector<std::pair<EClassId, EClassId>> equal;
+            for (EClassId id = 0; id < classes_.size(); ++id) {
+                if (find(id) != id) continue;
+                auto& nodes = classes_[id];
+                std::vector<ENode> unique;
+                unique.reserve(nodes.size());
+                for (ENode& node : nodes) {
+                    node = canonical(std::move(node));
+                    auto [it, added] = memo.try_emplace(node, id);
+                    if (added) unique.push_back(std::move(node));
+                    else if (it->second != id) equal.emplace_back(it->second, id);
+                }
+                nodes = std::move(unique);
+            }
+            memo_ = std::move(memo);
+            bool merged = false;
+            for (auto [a, b] : equal) merged |= merge(a, b);
+            if (!merged) return;
+        }
+    }
+
+    std::vector<EClassId> EGraph::classes() const {
+        std::vector<EClassId> out;
+        for (EClassId id = 0; id < classes_.size(); ++id) {
+            if (find(id) == id) out.push_back(id);
+        }
+        return out;
+    }
+
+    const ExprPtr* EGraph::constant(EClassId id) const {
+        for (const ENode& node : nodes(id)) {
+            if (node.leaf && numeric_kind(*node.leaf)) return &node.leaf;
+        }
+        return nullptr;
+    }
+
+    ExprPtr EGraph::extract(EClassId id) const {
+        // Cost of each class and its cheapest node, relaxed until no cost improves. A node
+        // costs more than any of its children, so the choices never form a cycle.
+        constexpr size_t UNKNOWN = std::numeric_limits<size_t>::max();
+        std::vector<size_t> cost(classes_.size(), UNKNOWN);
+        std::vector<const ENode*> best(classes_.size(), nullptr);
+        auto node_cost = [&](const ENode& node) {
+            size_t total = 1;
+            for (EClassId child : node.children) {
+                const size_t c = cost[find(child)];
+                if (c == UNKNOWN) return UNKNOWN;
+                total += c;
+            }
+            return total;
+        };
+        for (bool improved = true; improved;) {
+            improved = false;
+            for (EClassId c = 0; c < classes_.size(); ++c) {
+                if (find(c) != c) continue;
+                for (const ENode& node : classes_[c]) {
+                    const size_t total = node_cost(node);
+                    if (total < cost[c]) {
+                        cost[c] = total;
+                        best[c] = &node;
+                        improved = true;
+                    }
+                }
+            }
+        }
+
+        // Build the chosen nodes post-order, as add() reads them
+        struct Frame {
+            const ENode* node;
+            size_t next = 0;
+            std::vector<ExprPtr> args{};
+        };
+        auto chosen = [&](EClassId c) { return best[find(c)]; };
+        std::vector<Frame> stack{ { chosen(id) } };
+        ExprPtr result;
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.node->leaf) {
+                result = top.node->leaf;
+            }
+            else if (top.next < top.node->children.size()) {
+                stack.push_back({ chosen(top.node->children[top.next++]) });
+                continue;
+            }
+            else {
+                result = make_fcall(top.node->head, std::move(top.args));
+            }
+            stack.pop_back();
+            if (!stack.empty()) stack.back().args.push_back(result);
+        }
+        return result;
+    }
+
+} // namespace aleph3
@@ -0,0 +1,402 @@
+#include "transforms/Simplifier.hpp"
+#include "evaluator/BuiltinTables.hpp"
+#include "evaluator/ConstantFolding.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprUtils.hpp"
+#include "expr/PackedArray.hpp"
+#include "transforms/EGraph.hpp"
+#include "transforms/Transforms.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace aleph3 {
+
+    size_t leaf_count(const ExprPtr& expr) {
+        size_t count = 0;
+        std::vector<const Expr*> todo{ expr.get() };
+        while (!todo.empty()) {
+            const Expr& e = *todo.back();
+            todo.pop_back();
+            if (auto f = std::get_if<FunctionCall>(&e)) {
+                ++count;
+                for (const auto& arg : f->args) todo.push_back(arg.get());
+            }
+            else if (auto l = std::get_if<List>(&e)) {
+                ++count;
+                for (const auto& element : l->elements) todo.push_back(element.get());
+            }
+            else if (auto r = std::get_if<Rule>(&e)) {
+                ++count;
+                todo.push_back(r->lhs.get());
+                todo.push_back(r->rhs.get());
+            }
+            else if (auto p = std::get_if<PackedArray>(&e)) {
+                count += 1 + p->data->size();
+            }
+            else {
+                // Rational[n, d] and Complex[re, im] count their head and both parts
+                count += std::holds_alternative<Rational>(e) || std::holds_alternative<Complex>(e) ? 3 : 1;
+            }
+        }
+        return count;
+    }
+
+    ExprPtr simplify_to_fixed_point(const ExprPtr& expr, const SimplifyOptions& options) {
+        std::unordered_set<ExprPtr, ExprPtrHash, ExprPtrEqual> seen{ expr };
+        ExprPtr current = expr, best = expr;
+        size_t best_cost = leaf_count(expr);
+        for (size_t pass = 0; pass < options.max_passes; ++pass) {
+            ExprPtr next = simplify(current);
+            if (!seen.insert(next).second) break;  // A fixed point, or a cycle
+            if (const size_t cost = leaf_count(next); cost <= best_cost) {
+                best = next;
+                best_cost = cost;
+            }
+            current = std::move(next);
+        }
+        return best;
+    }
+
+    namespace {
+        constexpr size_t MAX_DISTRIBUTED_TERMS = 8;
+
+        // The value of head[args...] on numeric atoms, or nullptr
+        ExprPtr fold(Atom head, std::vector<ExprPtr> args) {
+            ExprPtr value = fold_constants(make_fcall(head, std::move(args)));
+            return numeric_kind(*value) ? value : nullptr;
+        }
+
+        bool is_value(const ExprPtr* constant, double v) {
+            if (!constant) return false;
+            auto n = std::get_if<Number>(constant->get());
+            return n && n->value == v;
+        }
+
+        std::optional<int64_t> integer_value(const ExprPtr* constant) {
+            if (!constant) return std::nullopt;
+            auto n = std::get_if<Number>(constant->get());
+            if (!n || std::floor(n->value) != n->value) return std::nullopt;
+            return static_cast<int64_t>(n->value);
+        }
+
+        // Applies the identities to one node of class `cls`. Nodes of other classes are
+        // copied before anything is added, since adding may move them.
+        class Rewriter {
+        public:
+            explicit Rewriter(EGraph& g) : g(g) {}
+
+            void apply(EClassId cls, const ENode& node) {
+                if (!node.leaf) {
+                    fold_node(cls, node);
+                    if (node.head == atoms::Plus) plus(cls, node);
+                    else if (node.head == atoms::Times) times(cls, node);
+                    else if (node.head == atoms::Power && node.children.size() == 2) power(cls, node);
+                    else if (node.children.size() == 1) inverse(cls, node);
+                }
+            }
+
+        private:
+            EGraph& g;
+
+            std::vector<ENode> calls(EClassId c, Atom head) const {
+                std::vector<ENode> out;
+                for (const ENode& n : g.nodes(c)) {
+                    if (!n.leaf && n.head == head) out.push_back(n);
+                }
+                return out;
+            }
+
+            ExprPtr constant(EClassId c) const {
+                const ExprPtr* value = g.constant(c);
+                return value ? *value : nullptr;
+            }
+
+            EClassId leaf(const ExprPtr& value) { return g.add(ENode{ Atom(), value, {} }); }
+
+            EClassId call(Atom head, std::vector<EClassId> children) {
+                return g.add(ENode{ head, nullptr, std::move(children) });
+            }
+
+            // head[children...], or the single child, or `empty` when there are none
+            EClassId call_or_single(Atom head, std::vector<EClassId> children, double empty) {
+                if (children.empty()) return leaf(make_number(empty));
+                if (children.size() == 1) return children[0];
+                return call(head, std::move(children));
+            }
+
+            void fold_node(EClassId cls, const ENode& node) {
+                if (node.head != atoms::Plus && node.head != atoms::Times && node.head != atoms::Power) return;
+                std::vector<ExprPtr> args;
+                for (EClassId child : node.children) {
+                    ExprPtr value = constant(child);
+                    if (!value) return;
+                    args.push_back(std::move(value));
+                }
+                if (ExprPtr value = fold(node.head, std::move(args))) g.merge(cls, leaf(value));
+            }
+
+            // Like terms: k1 x + k2 x -> (k1 + k2) x, numbers added, zeros dropped;
+            // Sin[x]^2 + Cos[x]^2 -> 1; a b + a c -> a (b + c)
+            void plus(EClassId cls, const ENode& node) {
+                struct Term {
+                    std::vector<ExprPtr> coefficients;
+                    EClassId rest;
+                };
+                std::vector<Term> terms;
+                std::vector<ExprPtr> numbers;
+                size_t number_position = SIZE_MAX;
+                for (EClassId child : node.children) {
+                    if (ExprPtr value = constant(child)) {
+                        if (numbers.empty()) number_position = terms.size();
+                        numbers.push_back(std::move(value));
+                        continue;
+                    }
+                    ExprPtr k = make_number(1);
+                    EClassId rest = g.find(child);
+                    for (const ENode& product : calls(child, atoms::Times)) {
+                        if (product.children.size() != 2) continue;
+                        if (ExprPtr value = constant(product.children[0])) {
+                            k = std::move(value);
+                            rest = g.find(product.children[1]);
+                            break;
+                        }
+                    }
+                    auto same = std::find_if(terms.begin(), terms.end(), [&](const Term& t) { return t.rest == rest; });
+                    if (same != terms.end()) same->coefficients.push_back(std::move(k));
+                    else terms.push_back({ { std::move(k) }, rest });
+                }
+                const bool combined = terms.size() + (numbers.empty() ? 0 : 1) < node.children.size() ||
+                    (numbers.size() == 1 && is_value(&numbers[0], 0));
+                if (combined) {
+                    std::vector<EClassId> args;
+                    for (size_t i = 0; i <= terms.size(); ++i) {
+                        if (i == number_position) {
+                            ExprPtr sum = numbers.size() == 1 ? numbers[0] : fold(atoms::Plus, numbers);
+                            if (!sum) return;
+                            if (!is_value(&sum, 0)) args.push_back(leaf(sum));
+                        }
+                        if (i == terms.size()) break;
+                        const Term& t = terms[i];
+                        ExprPtr k = t.coefficients.size() == 1 ? t.coefficients[0] : fold(atoms::Plus, t.coefficients);
+                        if (!k) return;
+                        if (is_value(&k, 0)) continue;
+                        args.push_back(is_value(&k, 1) ? t.rest : call(atoms::Times, { leaf(k), t.rest }));
+                    }
+                    g.merge(cls, call_or_single(atoms::Plus, std::move(args), 0));
+                }
+                pythagorean(cls, node);
+                factor_out(cls, node);
+            }
+
+            // The argument of Sin[x]^2 (or Cos[x]^2) in class c, if there is one
+            std::optional<EClassId> squared(EClassId c, Atom head) const {
+                for (const ENode& p : calls(c, atoms::Power)) {
+                    if (p.children.size() != 2 || !is_value(g.constant(p.children[1]), 2)) continue;
+                    for (const ENode& f : calls(p.children[0], head)) {
+                        if (f.children.size() == 1) return g.find(f.children[0]);
+                    }
+                }
+                return std::nullopt;
+            }
+
+            void pythagorean(EClassId cls, const ENode& node) {
+                const auto& args = node.children;
+                for (size_t i = 0; i < args.size(); ++i) {
+                    auto x = squared(args[i], atoms::Sin);
+                    if (!x) continue;
+                    for (size_t j = 0; j < args.size(); ++j) {
+                        if (j == i || squared(args[j], atoms::Cos) != x) continue;
+                        std::vector<EClassId> rest;
+                        for (size_t k = 0; k < args.size(); ++k) {
+                            if (k == std::min(i, j)) rest.push_back(leaf(make_number(1)));
+                            else if (k != i && k != j) rest.push_back(args[k]);
+                        }
+                        g.merge(cls, call_or_single(atoms::Plus, std::move(rest), 0));
+                        return;
+                    }
+                }
+            }
+
+            // Factors of class c: the arguments of a product in it, or c itself
+            std::vector<EClassId> factors(EClassId c) const {
+                for (const ENode& product : calls(c, atoms::Times)) {
+                    std::vector<EClassId> out;
+                    for (EClassId f : product.children) out.push_back(g.find(f));
+                    return out;
+                }
+                return { g.find(c) };
+            }
+
+            void factor_out(EClassId cls, const ENode& node) {
+                if (node.children.size() < 2) return;
+                std::vector<std::vector<EClassId>> terms;
+                for (EClassId child : node.children) terms.push_back(factors(child));
+                for (EClassId common : terms[0]) {
+                    if (g.constant(common)) continue;
+                    const bool everywhere = std::all_of(terms.begin() + 1, terms.end(), [&](const auto& t) {
+                        return std::find(t.begin(), t.end(), common) != t.end();
+                    });
+                    if (!everywhere) continue;
+                    std::vector<EClassId> rests;
+                    for (auto t : terms) {
+                        t.erase(std::find(t.begin(), t.end(), common));
+                        rests.push_back(call_or_single(atoms::Times, std::move(t), 1));
+                    }
+                    g.merge(cls, call(atoms::Times, { common, call(atoms::Plus, std::move(rests)) }));
+                    return;
+                }
+            }
+
+            // x^a x^b -> x^(a + b), numbers multiplied, ones dropped, zero absorbs;
+            // a (b + c) -> a b + a c
+            void times(EClassId cls, const ENode& node) {
+                struct Factor {
+                    EClassId base;
+                    std::vector<EClassId> exponents;
+                };
+                std::vector<Factor> bases;
+                std::vector<ExprPtr> numbers;
+                size_t number_position = SIZE_MAX;
+                const EClassId one = leaf(make_number(1));
+                for (EClassId child : node.children) {
+                    if (ExprPtr value = constant(child)) {
+                        if (is_value(&value, 0)) {
+                            g.merge(cls, child);
+                            return;
+                        }
+                        if (numbers.empty()) number_position = bases.size();
+                        numbers.push_back(std::move(value));
+                        continue;
+                    }
+                    EClassId base = g.find(child), exponent = one;
+                    for (const ENode& p : calls(child, atoms::Power)) {
+                        if (p.children.size() == 2) {
+                            base = g.find(p.children[0]);
+                            exponent = p.children[1];
+                            break;
+                        }
+                    }
+                    auto same = std::find_if(bases.begin(), bases.end(), [&](const Factor& f) { return f.base == base; });
+                    if (same != bases.end()) same->exponents.push_back(exponent);
+                    else bases.push_back({ base, { exponent } });
+                }
+                const bool combined = bases.size() + (numbers.empty() ? 0 : 1) < node.children.size() ||
+                    (numbers.size() == 1 && is_value(&numbers[0], 1));
+                if (combined) {
+                    std::vector<EClassId> args;
+                    for (size_t i = 0; i <= bases.size(); ++i) {
+                        if (i == number_position) {
+                            ExprPtr product = numbers.size() == 1 ? numbers[0] : fold(atoms::Times, numbers);
+                            if (!product) return;
+                            if (!is_value(&product, 1)) args.push_back(leaf(product));
+                        }
+                        if (i == bases.size()) break;
+                        const Factor& f = bases[i];
+                        EClassId exponent = f.exponents.size() == 1 ? f.exponents[0] : call(atoms::Plus, f.exponents);
+                        if (f.exponents.size() > 1) {
+                            std::vector<ExprPtr> values;
+                            for (EClassId e : f.exponents) {
+                                if (ExprPtr v = constant(e)) values.push_back(std::move(v));
+                            }
+                            if (values.size() == f.exponents.size()) {
+                                if (ExprPtr sum = fold(atoms::Plus, std::move(values))) exponent = leaf(sum);
+                            }
+                        }
+                        const ExprPtr* e = g.constant(exponent);
+                        if (is_value(e, 0)) continue;
+                        args.push_back(is_value(e, 1) ? f.base : call(atoms::Power, { f.base, exponent }));
+                    }
+                    g.merge(cls, call_or_single(atoms::Times, std::move(args), 1));
+                }
+                distribute(cls, node);
+            }
+
+            void distribute(EClassId cls, const ENode& node) {
+                for (size_t i = 0; i < node.children.size(); ++i) {
+                    for (const ENode& sum : calls(node.children[i], atoms::Plus)) {
+                        if (sum.children.size() > MAX_DISTRIBUTED_TERMS) continue;
+                        std::vector<EClassId> terms;
+                        for (EClassId term : sum.children) {
+                            std::vector<EClassId> product = node.children;
+                            product[i] = term;
+                            terms.push_back(call(atoms::Times, std::move(product)));
+                        }
+                        g.merge(cls, call(atoms::Plus, std::move(terms)));
+                        return;
+                    }
+                }
+            }
+
+            // x^1 -> x, x^0 -> 1, 1^n -> 1, (x^a)^n -> x^(a n) and (a b)^n -> a^n b^n for an integer n
+            void power(EClassId cls, const ENode& node) {
+                const EClassId base = node.children[0], exponent = node.children[1];
+                const ExprPtr* e = g.constant(exponent);
+                if (is_value(e, 1)) {
+                    g.merge(cls, base);
+                    return;
+                }
+                if (is_value(e, 0) || is_value(g.constant(base), 1)) {
+                    g.merge(cls, leaf(make_number(1)));
+                    return;
+                }
+                if (!integer_value(e)) return;
+                const ExprPtr n = *e;
+                for (const ENode& inner : calls(base, atoms::Power)) {
+                    if (inner.children.size() != 2) continue;
+                    EClassId product = call(atoms::Times, { inner.children[1], exponent });
+                    if (ExprPtr a = constant(inner.children[1])) {
+                        if (ExprPtr value = fold(atoms::Times, { a, n })) product = leaf(value);
+                    }
+                    g.merge(cls, call(atoms::Power, { inner.children[0], product }));
+                    break;
+                }
+                for (const ENode& product : calls(base, atoms::Times)) {
+                    std::vector<EClassId> powers;
+                    for (EClassId f : product.children) powers.push_back(call(atoms::Power, { f, exponent }));
+                    g.merge(cls, call(atoms::Times, std::move(powers)));
+                    break;
+                }
+            }
+
+            // f[g[x]] -> x for the pairs the evaluator inverts (other than Abs[Abs[x]])
+            void inverse(EClassId cls, const ENode& node) {
+                const Atom* inner = INVERSE_FUNCTIONS.find(node.head);
+                if (!inner || *inner == node.head) return;
+                for (const ENode& call : calls(node.children[0], *inner)) {
+                    if (call.children.size() == 1) {
+                        g.merge(cls, call.children[0]);
+                        return;
+                    }
+                }
+            }
+        };
+    }
+
+    ExprPtr full_simplify(const ExprPtr& expr, const SimplifyOptions& options) {
+        if (!std::holds_alternative<FunctionCall>(*expr)) return expr;
+        EGraph g;
+        const EClassId root = g.add(expr);
+        Rewriter rewriter(g);
+        for (size_t round = 0; round < options.max_iterations && g.node_count() < options.max_nodes; ++round) {
+            const size_t nodes = g.node_count(), classes = g.classes().size();
+            std::vector<std::pair<EClassId, ENode>> snapshot;
+            for (EClassId c : g.classes()) {
+                for (const ENode& node : g.nodes(c)) snapshot.emplace_back(c, node);
+            }
+            for (const auto& [c, node] : snapshot) {
+                rewriter.apply(c, node);
+                if (g.node_count() >= options.max_nodes) break;
+            }
+            g.rebuild();
+            if (g.node_count() == nodes && g.classes().size() == classes) break;  // Saturated
+        }
+        return g.extract(root);
+    }
+
+} // namespace aleph3
@@ -1,14 +1,19 @@
 ﻿#include "transforms/Transforms.hpp"
 #include "expr/Expr.hpp"
+#include "expr/ExprHash.hpp"
 #include "expr/ExprUtils.hpp"
 
 #include <cmath>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <algorithm>
+#include <vector>
 
 namespace aleph3 {
 
-    ExprPtr simplify_relational(const std::string& head, const ExprPtr& left, const ExprPtr& right) {
+    ExprPtr simplify_relational(Atom head, const ExprPtr& left, const ExprPtr& right) {
         auto simplified_left = simplify(left);
         auto simplified_right = simplify(right);
 
@@ -17,23 +22,23 @@ namespace aleph3 {
             double left_value = get_number_value(simplified_left);
             double right_value = get_number_value(simplified_right);
 
-            if (head == "Equal") {
-                return make_expr<Symbol>(left_value == right_value ? "True" : "False");
+            if (head == atoms::Equal) {
+                return make_expr<Symbol>(left_value == right_value ? atoms::True : atoms::False);
             }
-            else if (head == "NotEqual") {
-                return make_expr<Symbol>(left_value != right_value ? "True" : "False");
+            else if (head == atoms::NotEqual) {
+                return make_expr<Symbol>(left_value != right_value ? atoms::True : atoms::False);
             }
-            else if (head == "Less") {
-                return make_expr<Symbol>(left_value < right_value ? "True" : "False");
+            else if (head == atoms::Less) {
+                return make_expr<Symbol>(left_value < right_value ? atoms::True : atoms::False);
             }
-            else if (head == "Greater") {
-                return make_expr<Symbol>(left_value > right_value ? "True" : "False");
+            else if (head == atoms::Greater) {
+                return make_expr<Symbol>(left_value > right_value ? atoms::True : atoms::False);
             }
-            else if (head == "LessEqual") {
-                return make_expr<Symbol>(left_value <= right_value ? "True" : "False");
+            else if (head == atoms::LessEqual) {
+                return make_expr<Symbol>(left_value <= right_value ? atoms::True : atoms::False);
             }
-            else if (head == "GreaterEqual") {
-                return make_expr<Symbol>(left_value >= right_value ? "True" : "False");
+            else if (head == atoms::GreaterEqual) {
+                return make_expr<Symbol>(left_value >= right_value ? atoms::True : atoms::False);
             }
         }
 
@@ -42,9 +47,9 @@ namespace aleph3 {
     }
 
     // Simplify trivial cases
-    ExprPtr simplify(const ExprPtr& expr) {
+    ExprPtr simplify_uncached(const ExprPtr& expr) {
         if (auto f = std::get_if<FunctionCall>(expr.get())) {
-            if (f->head == "Times") {
+            if (f->head == atoms::Times) {
                 std::map<std::string, int> symbol_counts;
                 double coefficient = 1.0;
                 std::vector<ExprPtr> others;
@@ -58,7 +63,7 @@ namespace aleph3 {
                         symbol_counts[sym->name] += 1;
                     }
                     else if (auto pow = std::get_if<FunctionCall>(simplified_arg.get())) {
-                        if (pow->head == "Power") {
+                        if (pow->head == atoms::Power) {
                             if (auto base = std::get_if<Symbol>(pow->args[0].get())) {
                                 if (auto exp = std::get_if<Number>(pow->args[1].get())) {
                                     symbol_counts[base->name] += static_cast<int>(exp->value);
@@ -99,10 +104,10 @@ namespace aleph3 {
                 result.insert(result.end(), others.begin(), others.end());
 
                 if (result.size() == 1) return result[0];
-                return make_expr<FunctionCall>("Times", result);
+                return make_expr<FunctionCall>(atoms::Times, result);
             }
 
-            if (f->head == "Power") {
+            if (f->head == atoms::Power) {
                 auto base = f->args[0];
                 auto exponent = f->args[1];
 
@@ -127,17 +132,17 @@ namespace aleph3 {
 
                 // Simplify (a * b)^n → a^n * b^n
                 if (auto base_func = std::get_if<FunctionCall>(base.get())) {
-                    if (base_func->head == "Times") {
+                    if (base_func->head == atoms::Times) {
                         std::vector<ExprPtr> expanded_terms;
                         for (const auto& term : base_func->args) {
                             expanded_terms.push_back(make_pow(term, get_integer_value(exponent)));
                         }
-                        return simplify(make_expr<FunctionCall>("Times", expanded_terms));
+                        return simplify(make_expr<FunctionCall>(atoms::Times, expanded_terms));
                     }
                 }
             }
 
-            if (f->head == "Plus") {
+            if (f->head == atoms::Plus) {
                 std::vector<ExprPtr> simplified_args;
                 for (const auto& arg : f->args) {
                     simplified_args.push_back(simplify(arg));
@@ -149,7 +154,7 @@ namespace aleph3 {
 
                 for (const auto& arg : simplified_args) {
                     if (auto times_func = std::get_if<FunctionCall>(arg.get())) {
-                        if (times_func->head == "Times" && times_func->args.size() == 2) {
+                        if (times_func->head == atoms::Times && times_func->args.size() == 2) {
                             if (auto coeff = std::get_if<Number>(times_func->args[0].get())) {
                                 if (auto symbol = std::get_if<Symbol>(times_func->args[1].get())) {
                                     term_coefficients[symbol->name] += coeff->value;
@@ -179,15 +184,15 @@ namespace aleph3 {
                 std::sort(non_numeric_terms.begin(), non_numeric_terms.end(), [](const ExprPtr& a, const ExprPtr& b) {
                     auto degree = [](const ExprPtr& term) -> int {
                         if (auto pow = std::get_if<FunctionCall>(term.get())) {
-                            if (pow->head == "Power") {
+                            if (pow->head == atoms::Power) {
                                 if (auto exp = std::get_if<Number>(pow->args[1].get())) {
                                     return static_cast<int>(exp->value);
                                 }
                             }
-                            if (pow->head == "Times") {
+                            if (pow->head == atoms::Times) {
                                 for (auto& arg : pow->args) {
                                     if (auto inner_pow = std::get_if<FunctionCall>(arg.get())) {
-                                        if (inner_pow->head == "Power") {
+                                        if (inner_pow->head == atoms::Power) {
                                             if (auto exp = std::get_if<Number>(inner_pow->args[1].get())) {
                                                 return static_cast<int>(exp->value);
                                             }
@@ -215,17 +220,113 @@ namespace aleph3 {
                     return to_string(a) < to_string(b); // tie-breaker: lex order
                 });
 
-                return make_expr<FunctionCall>("Plus", non_numeric_terms);
+                return make_expr<FunctionCall>(atoms::Plus, non_numeric_terms);
             }
 
-            if (f->head == "Equal" || f->head == "NotEqual" || f->head == "Less" ||
-                f->head == "Greater" || f->head == "LessEqual" || f->head == "GreaterEqual") {
+            if (f->head == atoms::Equal || f->head == atoms::NotEqual || f->head == atoms::Less ||
+                f->head == atoms::Greater || f->head == atoms::LessEqual || f->head == atoms::GreaterEqual) {
                 return simplify_relational(f->head, f->args[0], f->args[1]);
             }
         }
         return expr; // Return the original expression if no simplification is possible
     }
 
+    namespace {
+        // Results of simplify() keyed on the structure of the input. Atoms are not stored;
+        // when the table is full it starts over.
+        struct SimplifyMemo {
+            static constexpr size_t CAPACITY = size_t(1) << 16;
+
+            std::mutex mutex;
+            std::unordered_map<ExprPtr, ExprPtr, ExprPtrHash, ExprPtrEqual> results;
+            size_t hits = 0;
+            size_t misses = 0;
+
+            static SimplifyMemo& instance() {
+                static SimplifyMemo memo;
+                return memo;
+            }
+        };
+    }
+
+    ExprPtr simplify(const ExprPtr& expr) {
+        if (!std::holds_alternative<FunctionCall>(*expr)) return expr;
+        auto& memo = SimplifyMemo::instance();
+        {
+            std::lock_guard lock(memo.mutex);
+            if (auto it = memo.results.find(expr); it != memo.results.end()) {
+                ++memo.hits;
+                return it->second;
+            }
+            ++memo.misses;
+        }
+        ExprPtr result = simplify_uncached(expr);
+        std::lock_guard lock(memo.mutex);
+        if (memo.results.size() >= SimplifyMemo::CAPACITY) memo.results.clear();
+        memo.results.emplace(expr, result);
+        return result;
+    }
+
+    SimplifyStats simplify_stats() {
+        auto& memo = SimplifyMemo::instance();
+        std::lock_guard lock(memo.mutex);
+        return { memo.hits, memo.misses, memo.results.size() };
+    }
+
+    void clear_simplify_memo() {
+        auto& memo = SimplifyMemo::instance();
+        std::lock_guard lock(memo.mutex);
+        memo.results.clear();
+        memo.hits = memo.misses = 0;
+    }
+
+    namespace {
+        // The arguments of a Plus, with nested sums like (a + b) + c flattened
+        std::vector<ExprPtr> summands(const ExprPtr& sum) {
+            std::vector<ExprPtr> out;
+            for (const auto& arg : std::get<FunctionCall>(*sum).args) {
+                if (is_function(arg, atoms::Plus)) {
+                    auto inner = summands(arg);
+                    out.insert(out.end(), inner.begin(), inner.end());
+                }
+                else {
+                    out.push_back(arg);
+                }
+            }
+            return out;
+        }
+
+        // The terms of (args[0] + args[1] + ...)^n, one per split a_0 + a_1 + ... = n with
+        // coefficient n! / (a_0! a_1! ...), in order of decreasing a_0, then a_1, ...
+        std::vector<ExprPtr> multinomial_terms(const std::vector<ExprPtr>& args, int n) {
+            std::vector<ExprPtr> terms;
+            std::vector<ExprPtr> factors;
+            // Picks a_i for args[i], with `remaining` still to split and `coeff` the
+            // product of the binomials C(remaining before args[j], a_j) so far
+            std::function<void(size_t, int, double)> visit = [&](size_t i, int remaining, double coeff) {
+                if (i + 1 == args.size()) {
+                    if (remaining > 0) factors.push_back(remaining == 1 ? args[i] : make_pow(args[i], remaining));
+                    std::vector<ExprPtr> product;
+                    if (coeff != 1) product.push_back(make_number(coeff));
+                    product.insert(product.end(), factors.begin(), factors.end());
+                    if (product.empty()) terms.push_back(make_number(1));
+                    else terms.push_back(product.size() == 1 ? product[0] : make_times(product));
+                    if (remaining > 0) factors.pop_back();
+                    return;
+                }
+                double binomial = 1;  // C(remaining, a)
+                for (int a = remaining; a >= 0; --a) {
+                    if (a > 0) factors.push_back(a == 1 ? args[i] : make_pow(args[i], a));
+                    visit(i + 1, remaining - a, coeff * binomial);
+                    if (a > 0) factors.pop_back();
+                    binomial = binomial * a / (remaining - a + 1);
+                }
+            };
+            visit(0, n, 1);
+            return terms;
+        }
+    }
+
     // Recursive expand
     ExprPtr expand(const ExprPtr& expr) {
         if (auto f = std::get_if<FunctionCall>(expr.get())) {
@@ -234,12 +335,12 @@ namespace aleph3 {
                 new_args.push_back(expand(arg)); // Recursively expand arguments
             }
 
-            if (f->head == "Times" && new_args.size() == 2) {
+            if (f->head == atoms::Times && new_args.size() == 2) {
                 auto lhs = new_args[0];
                 auto rhs = new_args[1];
 
                 // Expand: (a + b) * (c + d)
-                if (is_function(lhs, "Plus") && is_function(rhs, "Plus")) {
+                if (is_function(lhs, atoms::Plus) && is_function(rhs, atoms::Plus)) {
                     const auto& lhs_func = std::get<FunctionCall>(*lhs);
                     const auto& rhs_func = std::get<FunctionCall>(*rhs);
 
@@ -253,7 +354,7 @@ namespace aleph3 {
                 }
 
                 // Expand: (a + b) * c
-                if (is_function(lhs, "Plus")) {
+                if (is_function(lhs, atoms::Plus)) {
                     const auto& lhs_func = std::get<FunctionCall>(*lhs);
                     return simplify(make_plus({
                         make_times(lhs_func.args[0], rhs),
@@ -262,7 +363,7 @@ namespace aleph3 {
                 }
 
                 // Expand: a * (b + c)
-                if (is_function(rhs, "Plus")) {
+                if (is_function(rhs, atoms::Plus)) {
                     const auto& rhs_func = std::get<FunctionCall>(*rhs);
                     return simplify(make_plus({
                         make_times(lhs, rhs_func.args[0]),
@@ -271,10 +372,10 @@ namespace aleph3 {
                 }
 
                 // No expansion possible
-                return simplify(make_expr<FunctionCall>("Times", new_args));
+                return simplify(make_expr<FunctionCall>(atoms::Times, new_args));
             }
 
-            if (f->head == "Power" && new_args.size() == 2) {
+            if (f->head == atoms::Power && new_args.size() == 2) {
                 auto base = new_args[0];
                 int exp;
 
@@ -283,25 +384,18 @@ namespace aleph3 {
                 }
                 catch (...) {
                     // Return unevaluated if exponent is not an integer
-                    return make_expr<FunctionCall>("Power", new_args);
+                    return make_expr<FunctionCall>(atoms::Power, new_args);
                 }
 
-                // Check for (a + b)^2 pattern
+                // (a + b + ...)^n by the multinomial theorem
                 if (const auto* base_func = std::get_if<FunctionCall>(base.get())) {
-                    if (base_func->head == "Plus" && base_func->args.size() == 2 && exp == 2) {
-                        auto a = base_func->args[0];
-                        auto b = base_func->args[1];
-
-                        return simplify(make_plus({
-                            make_pow(a, 2),                           // a^2
-                            make_times({make_number(2), a, b}),       // 2 * a * b
-                            make_pow(b, 2)                            // b^2
-                            }));
+                    if (base_func->head == atoms::Plus && !base_func->args.empty() && exp >= 2) {
+                        return simplify(make_plus(multinomial_terms(summands(base), exp)));
                     }
                 }
 
                 // No special expansion case
-                return simplify(make_expr<FunctionCall>("Power", new_args));
+                return simplify(make_expr<FunctionCall>(atoms::Power, new_args));
             }
 
             return simplify(make_expr<FunctionCall>(f->head, new_args));
@@ -0,0 +1,188 @@
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace aleph3 {
+
+    namespace {
+        thread_local bool running_chunk = false;
+
+        // Marks the thread as running pool work while in scope
+        struct JobScope {
+            bool previous = running_chunk;
+            JobScope() { running_chunk = true; }
+            ~JobScope() { running_chunk = previous; }
+        };
+    }
+
+    // Chunks [lo, hi) still owned by one participant
+    struct ThreadPool::Run {
+        std::mutex mutex;
+        size_t lo = 0;
+        size_t hi = 0;
+    };
+
+    struct ThreadPool::Job {
+        const Body* body;
+        size_t n;
+        size_t grain;
+        std::unique_ptr<Run[]> runs;
+        size_t participants;
+        std::atomic<bool> failed{false};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        void run_chunk(size_t chunk) {
+            if (failed.load(std::memory_order_relaxed)) return;
+            const size_t begin = chunk * grain;
+            try {
+                (*body)(chunk, begin, std::min(n, begin + grain));
+            }
+            catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    ThreadPool& ThreadPool::instance() {
+        static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return pool;
+    }
+
+    ThreadPool::ThreadPool(size_t count) {
+        start(count);
+    }
+
+    ThreadPool::~ThreadPool() {
+        stop();
+    }
+
+    bool ThreadPool::in_job() {
+        return running_chunk;
+    }
+
+    void ThreadPool::resize(size_t count) {
+        std::lock_guard lock(job_mutex);
+        stop();
+        start(count);
+    }
+
+    void ThreadPool::start(size_t count) {
+        // Captured here, not read by the new thread: a job may be posted before it first runs
+        const uint64_t current = generation;
+        workers.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            workers.emplace_back([this, i, current] { worker_loop(i + 1, current); }); // Slot 0 is the caller
+        }
+    }
+
+    void ThreadPool::stop() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+        stopping = false;
+    }
+
+    void ThreadPool::worker_loop(size_t slot, uint64_t seen) {
+        std::unique_lock lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            Job* current = job;
+            lock.unlock();
+            participate(*current, slot);
+            lock.lock();
+            if (--busy == 0) done.notify_all();
+        }
+    }
+
+    void ThreadPool::participate(Job& job, size_t slot) {
+        JobScope scope;
+        Run& own = job.runs[slot];
+        for (;;) {
+            size_t chunk;
+            {
+                std::lock_guard lock(own.mutex);
+                chunk = own.lo < own.hi ? own.lo++ : SIZE_MAX;
+            }
+            if (chunk != SIZE_MAX) {
+                job.run_chunk(chunk);
+                continue;
+            }
+
+            // Own run is empty: steal the back half of the largest run left
+            size_t victim = SIZE_MAX, largest = 0;
+            for (size_t i = 0; i < job.participants; ++i) {
+                if (i == slot) continue;
+                std::lock_guard lock(job.runs[i].mutex);
+                if (job.runs[i].hi - job.runs[i].lo > largest) {
+                    largest = job.runs[i].hi - job.runs[i].lo;
+                    victim = i;
+                }
+            }
+            if (victim == SIZE_MAX) return; // Every chunk is taken; the ones in flight finish on their own
+            size_t lo, hi;
+            {
+                std::lock_guard lock(job.runs[victim].mutex);
+                Run& run = job.runs[victim];
+                const size_t left = run.hi - run.lo;
+                if (left == 0) continue; // Emptied meanwhile; look again
+                hi = run.hi;
+                lo = hi - (left + 1) / 2;
+                run.hi = lo;
+            }
+            std::lock_guard lock(own.mutex);
+            own.lo = lo;
+            own.hi = hi;
+        }
+    }
+
+    void ThreadPool::parallel_for(size_t n, size_t grain, const Body& body) {
+        const size_t chunks = chunk_count(n, grain);
+        if (chunks == 0) return;
+        if (running_chunk || workers.empty() || chunks == 1) {
+            JobScope scope;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                const size_t begin = chunk * grain;
+                body(chunk, begin, std::min(n, begin + grain));
+            }
+            return;
+        }
+
+        std::lock_guard job_lock(job_mutex);
+        Job current;
+        current.body = &body;
+        current.n = n;
+        current.grain = grain;
+        current.participants = concurrency();
+        current.runs = std::make_unique<Run[]>(current.participants);
+        for (size_t i = 0; i < current.participants; ++i) {
+            current.runs[i].lo = i * chunks / current.participants;
+            current.runs[i].hi = (i + 1) * chunks / current.participants;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            job = &current;
+            busy = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        participate(current, 0);
+        {
+            std::unique_lock lock(mutex);
+            done.wait(lock, [&] { return busy == 0; });
+            job = nullptr;
+        }
+        if (current.error) std::rethrow_exception(current.error);
+    }
+
+} // namespace aleph3
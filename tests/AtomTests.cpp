@@ -0,0 +1,58 @@
+#include "expr/Atom.hpp"
+#include "expr/AtomTable.hpp"
+#include "expr/Expr.hpp"
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace aleph3;
+
+TEST_CASE("Interning the same name yields the same atom", "[atom]") {
+    Atom a("someUniqueName");
+    Atom b(std::string("someUniqueName"));
+    REQUIRE(a == b);
+    REQUIRE(a.id() == b.id());
+    REQUIRE(a.str() == "someUniqueName");
+    REQUIRE(Atom("otherUniqueName") != a);
+}
+
+TEST_CASE("Builtin atoms are pre-interned with fixed ids", "[atom]") {
+    REQUIRE(Atom("Plus") == atoms::Plus);
+    REQUIRE(Atom("List") == atoms::List);
+    REQUIRE(atoms::Times.str() == "Times");
+    REQUIRE(Atom().empty());
+    REQUIRE(Atom("") == Atom());
+}
+
+TEST_CASE("Parsed heads and symbols are atoms", "[atom]") {
+    auto expr = parse_expression("f[x, y]");
+    const auto& call = std::get<FunctionCall>(*expr);
+    REQUIRE(call.head == Atom("f"));
+    REQUIRE(call.head == "f");
+    REQUIRE(std::get<Symbol>(*call.args[0]).name == Atom("x"));
+
+    auto sum = parse_expression("a + b");
+    REQUIRE(std::get<FunctionCall>(*sum).head == atoms::Plus);
+}
+
+TEST_CASE("Context lookups are keyed on atoms", "[atom][evaluator]") {
+    EvaluationContext ctx;
+    ctx.variables[Atom("x")] = make_expr<Number>(4.0);
+    auto result = evaluate(parse_expression("x * 2"), ctx);
+    REQUIRE(get_number_value(result) == 8.0);
+    REQUIRE(ctx.variables.count("x") == 1);
+}
+
+TEST_CASE("AtomTable finds built-in heads by ID", "[atom]") {
+    static constexpr AtomTable<int> table = { { "Sin", 1 }, { "Plus", 2 } };
+    static_assert(*table.find(atoms::Sin) == 1);
+    static_assert(table.find(atoms::Cos) == nullptr);
+    REQUIRE(*table.find(Atom("Plus")) == 2);
+    REQUIRE_FALSE(table.contains(Atom("NotABuiltinHead")));
+
+    static constexpr AtomSet set = { "List", "Rule" };
+    static_assert(set.contains(atoms::Rule) && !set.contains(atoms::Set));
+    REQUIRE(set.contains(Atom("List")));
+    REQUIRE_FALSE(set.contains(Atom("AnotherUserSymbol")));
+}
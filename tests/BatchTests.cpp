@@ -0,0 +1,83 @@
+#include "cli/Batch.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    struct Run {
+        std::string out, err;
+        size_t failures;
+    };
+
+    Run run_script(const std::string& source, BatchOptions options = {}, bool streamed = false) {
+        EvaluationContext ctx;
+        std::ostringstream out, err;
+        BatchRunner runner(ctx, out, err, options);
+        if (streamed) {
+            std::istringstream in(source);
+            runner.run(in);
+        }
+        else {
+            runner.run(source);
+        }
+        return { out.str(), err.str(), runner.failures() };
+    }
+}
+
+TEST_CASE("Batch scripts print one plain line per result", "[batch]") {
+    const std::string script = "f[x_] := x^2 + 1\nx = 3;\nf[x]; f[2]\n(* a comment *)\nf[x] + 1\nFullForm[a + b]\n";
+    auto run = run_script(script);
+    REQUIRE(run.out == "5\n11\nPlus[a, b]\n");
+    REQUIRE(run.err.empty());
+    REQUIRE(run.failures == 0);
+
+    BatchOptions labels;
+    labels.labels = true;
+    REQUIRE(run_script("1 + 1\n2 + 2", labels).out == "Out[1]= 2\nOut[2]= 4\n");
+}
+
+TEST_CASE("Batch errors name their line and the run goes on", "[batch]") {
+    auto run = run_script("1 + 1\n(2 + \n3\n");
+    REQUIRE(run.out == "2\n");
+    REQUIRE(run.err.rfind("<stdin>:2: Error: ", 0) == 0);
+    REQUIRE(run.failures == 1);
+
+    BatchOptions stop;
+    stop.stop_on_error = true;
+    auto stopped = run_script("}\n1 + 1", stop);
+    REQUIRE(stopped.out.empty());
+    REQUIRE(stopped.failures == 1);
+}
+
+TEST_CASE("Streamed scripts match scripts read whole", "[batch]") {
+    std::string script;
+    for (int k = 0; k < 200; ++k) script += "a" + std::to_string(k) + " = " + std::to_string(k) + "; a" + std::to_string(k) + " +\n 1\n";
+    script += "}\n";
+    BatchOptions small;
+    small.block_size = 7;  // Cuts statements, numbers and symbols apart
+    const auto whole = run_script(script), streamed = run_script(script, small, true);
+    REQUIRE(streamed.out == whole.out);
+    REQUIRE(streamed.err == whole.err);
+    REQUIRE(whole.err.rfind("<stdin>:401: Error: ", 0) == 0);
+}
+
+TEST_CASE("Large scripts parse in parallel and run in order", "[batch]") {
+    // Each assignment uses the one before it, so evaluation order shows in the results
+    std::string script = "g0 = 0;\n";
+    std::string expected;
+    for (int k = 1; k <= 3000; ++k) {
+        const std::string n = std::to_string(k);
+        script += "g" + n + " = g" + std::to_string(k - 1) + " + 1;\n";
+        if (k % 1000 == 0) {
+            script += "g" + n + "\n";
+            expected += n + "\n";
+        }
+    }
+    script += "g3000 +\n";
+    auto run = run_script(script);
+    REQUIRE(run.out == expected);
+    REQUIRE(run.failures == 1);
+    REQUIRE(run.err.rfind("<stdin>:3005: Error: ", 0) == 0);
+}
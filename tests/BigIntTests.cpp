@@ -0,0 +1,77 @@
+#include "expr/BigInt.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cstdint>
+#include <random>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    // Random number with `digits` decimal digits
+    BigInt random_big(std::mt19937_64& rng, size_t digits) {
+        std::string s(1, static_cast<char>('1' + rng() % 9));
+        while (s.size() < digits) s += static_cast<char>('0' + rng() % 10);
+        return BigInt::from_string(s);
+    }
+}
+
+TEST_CASE("Small values stay machine integers", "[bigint]") {
+    BigInt a = 1234567, b = -89;
+    REQUIRE((a * b).is_small());
+    REQUIRE(a * b == -109876463);
+    REQUIRE(a / b == -13871);
+    REQUIRE(a % b == 48);
+    REQUIRE(gcd(BigInt(84), BigInt(-36)) == 12);
+
+    // Overflow promotes, and coming back into range demotes again
+    BigInt max = INT64_MAX;
+    BigInt over = max + 1;
+    REQUIRE_FALSE(over.is_small());
+    REQUIRE(over.to_string() == "9223372036854775808");
+    REQUIRE((over - 1).is_small());
+    REQUIRE(over - 1 == max);
+    REQUIRE((-BigInt(INT64_MIN)).to_string() == "9223372036854775808");
+    REQUIRE((BigInt(INT64_MIN) / -1).to_string() == "9223372036854775808");
+    REQUIRE(BigInt(INT64_MIN) % -1 == 0);
+    REQUIRE(over > max);
+    REQUIRE((-over).is_small());
+    REQUIRE(-over == BigInt(INT64_MIN));
+    REQUIRE_THROWS(a / 0);
+}
+
+TEST_CASE("Big values convert and compare", "[bigint]") {
+    REQUIRE(pow(BigInt(2), 64).to_string() == "18446744073709551616");
+    BigInt factorial = 1;
+    for (int i = 2; i <= 30; ++i) factorial *= i;
+    REQUIRE(factorial.to_string() == "265252859812191058636308480000000");
+    REQUIRE(BigInt::from_string("-265252859812191058636308480000000") == -factorial);
+    REQUIRE(factorial.to_double() == Catch::Approx(2.6525285981219107e32));
+    REQUIRE(BigInt::from_double(1e30).to_string() == "1000000000000000019884624838656");
+    REQUIRE_THROWS(BigInt::from_double(0.5));
+    REQUIRE(factorial.bit_length() == 108);
+    REQUIRE(factorial.hash() == BigInt::from_string("265252859812191058636308480000000").hash());
+
+    // Quotients of values far beyond the double range
+    BigInt huge = pow(BigInt(10), 400);
+    REQUIRE(BigInt::ratio(huge, huge * 4) == 0.25);
+    REQUIRE(BigInt::ratio(-huge * 3, huge) == -3.0);
+}
+
+TEST_CASE("Karatsuba products match division", "[bigint]") {
+    std::mt19937_64 rng(42);
+    // From schoolbook sizes through balanced and unbalanced Karatsuba
+    for (auto [da, db] : { std::pair{ 30, 40 }, std::pair{ 400, 450 }, std::pair{ 900, 3000 }, std::pair{ 2500, 2500 } }) {
+        BigInt a = random_big(rng, da), b = random_big(rng, db), r = random_big(rng, da / 2);
+        BigInt product = a * b;
+        REQUIRE(product / b == a);
+        REQUIRE(product % a == 0);
+        REQUIRE((product + r) / a == b);
+        REQUIRE((product + r) % a == r);
+        REQUIRE((a - b) + b == a);
+        REQUIRE(gcd(product, a * r) % a == 0);
+    }
+    // Squares of 2^k - 1 exercise every carry
+    BigInt all_ones = pow(BigInt(2), 4000) - 1;
+    REQUIRE(all_ones * all_ones == pow(BigInt(2), 8000) - pow(BigInt(2), 4001) + 1);
+}
@@ -0,0 +1,40 @@
+#include "transforms/CSE.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src) {
+        EvaluationContext ctx;
+        return to_string(evaluate(parse_expression(src), ctx));
+    }
+}
+
+TEST_CASE("CSE names repeated subexpressions", "[cse]") {
+    REQUIRE(eval("CSE[f[x + y, x + y]]") == "With[{c1 -> x + y}, f[c1, c1]]");
+    REQUIRE(eval("CSE[x + y]") == "x + y");
+    // a + b only occurs inside the one shared (a + b)^2
+    auto cse = eliminate_common_subexpressions(parse_expression("g[(a + b)^2, h[(a + b)^2]]"));
+    REQUIRE(cse.bindings.size() == 1);
+    REQUIRE(to_string(cse.bindings[0].second) == "(a + b)^2");
+    REQUIRE(to_string(cse.body) == "g[c1, h[c1]]");
+}
+
+TEST_CASE("CSE names avoid symbols in the expression", "[cse]") {
+    auto cse = eliminate_common_subexpressions(parse_expression("{Sin[x], c1 * Sin[x]}"));
+    REQUIRE(cse.bindings.size() == 1);
+    REQUIRE(cse.bindings[0].first == "c2");
+}
+
+TEST_CASE("CSE walks a shared DAG once", "[cse]") {
+    ExprPtr e = make_expr<Symbol>("x");
+    for (int i = 0; i < 64; ++i) e = make_fcall(Atom("f"), { e, e });
+    auto cse = eliminate_common_subexpressions(e);
+    REQUIRE(cse.bindings.size() == 63);
+    REQUIRE(to_string(cse.body) == "f[c63, c63]");
+    REQUIRE(to_string(cse.bindings[1].second) == "f[c1, c1]");
+}
@@ -0,0 +1,72 @@
+#include "transforms/EGraph.hpp"
+#include "transforms/Simplifier.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/ExprUtils.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src) {
+        EvaluationContext ctx;
+        return to_string(evaluate(parse_expression(src), ctx));
+    }
+}
+
+TEST_CASE("E-graph shares equal terms", "[egraph]") {
+    EGraph g;
+    auto a = g.add(parse_expression("f[x, g[x]]"));
+    auto b = g.add(parse_expression("g[x]"));
+    REQUIRE(g.add(parse_expression("f[x, g[x]]")) == a);
+    REQUIRE(a != b);
+    REQUIRE(g.node_count() == 3);  // x, g[x], f[x, g[x]]
+}
+
+TEST_CASE("E-graph merges restore congruence", "[egraph]") {
+    EGraph g;
+    auto fx = g.add(parse_expression("f[x]"));
+    auto fy = g.add(parse_expression("f[y]"));
+    auto x = g.add(parse_expression("x"));
+    auto y = g.add(parse_expression("y"));
+    REQUIRE(g.find(fx) != g.find(fy));
+
+    REQUIRE(g.merge(x, y));
+    REQUIRE_FALSE(g.merge(y, x));
+    g.rebuild();
+    REQUIRE(g.find(fx) == g.find(fy));
+}
+
+TEST_CASE("E-graph extracts the smallest form", "[egraph]") {
+    EGraph g;
+    auto big = g.add(parse_expression("Plus[Times[a, b], Times[a, c]]"));
+    auto small = g.add(parse_expression("Times[a, Plus[b, c]]"));
+    g.merge(big, small);
+    g.rebuild();
+    REQUIRE(to_string(g.extract(big)) == "a * (b + c)");
+
+    auto n = g.add(make_number(2));
+    REQUIRE(g.constant(n));
+    REQUIRE_FALSE(g.constant(small));
+}
+
+TEST_CASE("FullSimplify saturates algebraic identities", "[egraph][simplify]") {
+    REQUIRE(eval("FullSimplify[a*b + a*c]") == "a * (b + c)");
+    REQUIRE(eval("FullSimplify[Sin[x]^2 + Cos[x]^2]") == "1");
+    REQUIRE(eval("FullSimplify[x - x]") == "0");
+    REQUIRE(eval("FullSimplify[x*x]") == "x^2");
+    REQUIRE(eval("FullSimplify[(a + b)*c - a*c]") == "b * c");
+    REQUIRE(eval("FullSimplify[(x^2)^3]") == "x^6");
+    REQUIRE(eval("FullSimplify[Exp[Log[y]]]") == "y");
+    REQUIRE(eval("Simplify[x*1 + 0*y]") == "x");
+}
+
+TEST_CASE("FullSimplify stops at the node budget", "[egraph][simplify]") {
+    SimplifyOptions tight;
+    tight.max_nodes = 1;
+    auto expr = parse_expression("Plus[Times[a, b], Times[a, c]]");
+    REQUIRE(full_simplify(expr, tight) != nullptr);
+    REQUIRE(leaf_count(full_simplify(expr)) < leaf_count(expr));
+}
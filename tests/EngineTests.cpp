@@ -0,0 +1,96 @@
+#include "engine/Engine.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    BudgetLimit exceeded(std::future<ExprPtr> value) {
+        try {
+            value.get();
+        }
+        catch (const BudgetExceeded& ex) {
+            return ex.limit;
+        }
+        FAIL("No limit was exceeded");
+        return BudgetLimit::Cancelled;
+    }
+}
+
+TEST_CASE("Engine sessions keep their own bindings and attributes", "[engine]") {
+    EngineOptions options;
+    options.threads = 2;
+    options.extend = [](FunctionRegistry& registry) {
+        registry.register_function("HostAnswer", [](const FunctionCall&, EvaluationContext&) { return make_expr<Number>(42); });
+    };
+    Engine engine(options);
+    REQUIRE(engine.threads() == 2);
+    REQUIRE(engine.registry().frozen());
+    REQUIRE(engine.registry().has_function("HostAnswer"));
+    REQUIRE_FALSE(FunctionRegistry::instance().has_function("HostAnswer"));
+
+    Session a = engine.open_session(), b = engine.open_session();
+    REQUIRE(to_string(a.evaluate("x = 2; x^2 + 1")) == "5");
+    REQUIRE(to_string(b.evaluate("x")) == "x");
+    REQUIRE(to_string(b.evaluate("HostAnswer[] + 1")) == "43");
+    // Silent last statements and empty sources give Null
+    REQUIRE(to_string(a.evaluate("y = 3;")) == "Null");
+    REQUIRE(to_string(a.evaluate(parse_expression("x + y"))) == "5");
+
+    a.evaluate("engineAc[x_, y_] := x - y");
+    a.evaluate("SetAttributes[engineAc, Orderless]");
+    REQUIRE(to_string(a.evaluate("Attributes[engineAc]")) == "{Orderless}");
+    REQUIRE(to_string(b.evaluate("Attributes[engineAc]")) == "{}");
+    EvaluationContext plain;
+    REQUIRE(to_string(evaluate(parse_expression("Attributes[engineAc]"), plain)) == "{}");
+
+    REQUIRE_THROWS_AS(a.evaluate("1 +"), std::runtime_error);
+    REQUIRE(to_string(a.evaluate("x")) == "2");
+}
+
+TEST_CASE("Engine runs sessions concurrently and each in order", "[engine]") {
+    EngineOptions options;
+    options.threads = 4;
+    Engine engine(options);
+    std::vector<Session> sessions;
+    for (int s = 0; s < 8; ++s) sessions.push_back(engine.open_session());
+
+    std::vector<std::future<ExprPtr>> values;
+    for (int s = 0; s < 8; ++s) {
+        sessions[s].evaluate_async("n = " + std::to_string(s));
+        for (int k = 0; k < 20; ++k) values.push_back(sessions[s].evaluate_async("n = n + 1; n"));
+    }
+    for (int s = 0; s < 8; ++s) {
+        for (int k = 0; k < 20; ++k) {
+            REQUIRE(to_string(values[s * 20 + k].get()) == std::to_string(s + k + 1));
+        }
+    }
+}
+
+TEST_CASE("Engine evaluations run under budgets and can be cancelled", "[engine]") {
+    EngineOptions options;
+    options.threads = 1;
+    options.budget.steps = 100000;
+    Engine engine(options);
+    Session session = engine.open_session();
+    const std::string slow = "Length[Table[Sin[k] + x, {k, 1, 100000000}]]";
+
+    REQUIRE(exceeded(session.evaluate_async(slow)) == BudgetLimit::Steps);
+    EvaluationBudget brief;
+    brief.time = std::chrono::milliseconds(20);
+    REQUIRE(exceeded(session.evaluate_async(slow, brief)) == BudgetLimit::Time);
+
+    // Both the running evaluation and the one queued behind it stop
+    EvaluationBudget unlimited;
+    auto running = session.evaluate_async(slow, unlimited);
+    auto queued = session.evaluate_async(slow, unlimited);
+    session.cancel();
+    REQUIRE(exceeded(std::move(running)) == BudgetLimit::Cancelled);
+    REQUIRE(exceeded(std::move(queued)) == BudgetLimit::Cancelled);
+    REQUIRE(to_string(session.evaluate("1 + 1")) == "2");
+}
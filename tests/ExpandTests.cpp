@@ -47,8 +47,14 @@ TEST_CASE("Expand does not change flat multiplication") {
     REQUIRE(to_string(expanded) == "a * b");
 }
 
-TEST_CASE("Expand does not handle (a + b)^3 (yet)") {
+TEST_CASE("Expand handles (a + b)^3 by the multinomial theorem") {
     auto expr = parse_expression("(a + b)^3");
     auto expanded = expand(expr);
-    REQUIRE(to_string(expanded) == "(a + b)^3");
+    REQUIRE(to_string(expanded) == "a^3 + b^3 + 3 * a^2 * b + 3 * a * b^2");
+}
+
+TEST_CASE("Expand handles trinomial powers") {
+    auto expr = parse_expression("(a + b + c)^2");
+    auto expanded = expand(expr);
+    REQUIRE(to_string(expanded) == "a^2 + b^2 + c^2 + 2 * a * b + 2 * a * c + 2 * b * c");
 }
@@ -0,0 +1,50 @@
+#include "expr/Expr.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprUtils.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <unordered_map>
+
+using namespace aleph3;
+
+TEST_CASE("Structural hash and equality", "[hash]") {
+    auto a = parse_expression("Sin[x + 2*y]");
+    auto b = parse_expression("Sin[x + 2*y]");
+    auto c = parse_expression("Sin[x + 3*y]");
+
+    REQUIRE(a != b);
+    REQUIRE(expr_hash(a) == expr_hash(b));
+    REQUIRE(expr_equal(a, b));
+    REQUIRE_FALSE(expr_equal(a, c));
+
+    // Numbers compare by value, so the two zeros must agree on their hash too
+    REQUIRE(expr_hash(make_expr<Number>(0.0)) == expr_hash(make_expr<Number>(-0.0)));
+    REQUIRE_FALSE(expr_equal(make_expr<Number>(1.0), make_expr<Rational>(1, 1)));
+    REQUIRE_FALSE(expr_equal(make_fcall(atoms::Plus, { make_expr<Symbol>("x") }),
+                             make_fcall(atoms::Times, { make_expr<Symbol>("x") })));
+}
+
+TEST_CASE("Structural keys in unordered containers", "[hash]") {
+    std::unordered_map<ExprPtr, int, ExprPtrHash, ExprPtrEqual> table;
+    table[parse_expression("{1, x, f[y]}")] = 7;
+    REQUIRE(table.count(parse_expression("{1, x, f[y]}")) == 1);
+    REQUIRE(table.count(parse_expression("{1, x, f[z]}")) == 0);
+}
+
+TEST_CASE("Hash-consing shares identical subtrees", "[hash]") {
+    set_hash_consing(true);
+    auto x1 = make_expr<Symbol>("x");
+    auto x2 = make_expr<Symbol>("x");
+    auto p1 = make_fcall(atoms::Power, { x1, make_expr<Number>(2) });
+    auto p2 = make_fcall(atoms::Power, { x2, make_expr<Number>(2) });
+    set_hash_consing(false);
+
+    REQUIRE(x1 == x2);
+    REQUIRE(p1 == p2);
+    REQUIRE(make_expr<Symbol>("x") != x1);
+
+    // Explicit interning rebuilds a tree on top of the canonical nodes
+    auto p3 = hash_cons(make_fcall(atoms::Power, { make_expr<Symbol>("x"), make_expr<Number>(2) }));
+    REQUIRE(p3 == p1);
+    REQUIRE(hash_cons_table_size() > 0);
+}
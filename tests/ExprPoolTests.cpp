@@ -0,0 +1,32 @@
+#include "expr/Expr.hpp"
+#include "expr/ExprPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+using namespace aleph3;
+
+TEST_CASE("Freed nodes are recycled by the pool", "[pool]") {
+    {
+        std::vector<ExprPtr> warmup;
+        for (int i = 0; i < 10000; ++i) warmup.push_back(make_expr<Number>(i));
+    }
+    auto before = expr_pool_stats();
+    for (int round = 0; round < 10; ++round) {
+        std::vector<ExprPtr> nodes;
+        for (int i = 0; i < 10000; ++i) nodes.push_back(make_expr<Number>(i));
+        REQUIRE(std::get<Number>(*nodes.back()).value == 9999.0);
+    }
+    REQUIRE(expr_pool_stats().chunks == before.chunks);
+}
+
+TEST_CASE("Nodes can be freed on a different thread", "[pool]") {
+    std::vector<ExprPtr> nodes;
+    for (int i = 0; i < 5000; ++i) {
+        nodes.push_back(make_expr<FunctionCall>(atoms::Plus, std::vector<ExprPtr>{ make_expr<Number>(i) }));
+    }
+    std::thread consumer([moved = std::move(nodes)]() mutable { moved.clear(); });
+    consumer.join();
+    auto again = make_expr<Symbol>("x");
+    REQUIRE(std::get<Symbol>(*again).name == "x");
+}
@@ -0,0 +1,27 @@
+#include "util/PerfectHash.hpp"
+#include "help/HelpTexts.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace aleph3;
+
+TEST_CASE("Perfect hashes find every key and nothing else", "[perfecthash]") {
+    static constexpr PerfectHash<5> hash({ "alpha", "beta", "gamma", "beta", "" });
+    static_assert(hash.find("gamma") == 2);
+    REQUIRE(hash.find("alpha") == 0);
+    REQUIRE(hash.find("beta") == 1);  // First of the repeated keys
+    REQUIRE(hash.find("") == 4);
+    REQUIRE(hash.find("delta") == hash.NOT_FOUND);
+    REQUIRE(hash.find("alph") == hash.NOT_FOUND);
+}
+
+TEST_CASE("Help entries are found by name", "[perfecthash][help]") {
+    for (const auto& entry : get_help_entries()) {
+        const HelpEntry* found = find_help_entry(entry.name);
+        REQUIRE(found);
+        REQUIRE(found->name == entry.name);
+    }
+    static_assert(find_help_entry("Sin") != nullptr);
+    REQUIRE(find_help_entry("Log")->description.starts_with("Log[b, x]"));  // The first of two
+    REQUIRE(find_help_entry("NoSuchFunction") == nullptr);
+}
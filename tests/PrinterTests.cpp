@@ -0,0 +1,74 @@
+#include "expr/Printer.hpp"
+#include "expr/FullForm.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <complex>
+#include <sstream>
+
+using namespace aleph3;
+
+TEST_CASE("Numbers print with to_chars as with iostreams", "[printer]") {
+    REQUIRE(format_number(3) == "3");
+    REQUIRE(format_number(-42) == "-42");
+    REQUIRE(format_number(0.5) == "0.5");
+    REQUIRE(format_number(1.0 / 3) == "0.333333");
+    REQUIRE(format_number(-2.25) == "-2.25");
+    REQUIRE(format_number(-1e-9) == "-0");
+    REQUIRE(format_number(1e20) == "100000000000000000000");
+    REQUIRE(format_number(-1.0 / 0.0) == "-Infinity");
+
+    REQUIRE(to_fullform(make_expr<Number>(0.1)) == "0.1");
+    REQUIRE(to_fullform(make_expr<Number>(1.0 / 3)) == "0.3333333333333333");
+    REQUIRE(to_fullform(make_expr<Complex>(1.0 / 3, -2.0)) == "Complex[0.333333, -2]");
+}
+
+TEST_CASE("Packed arrays and lazy lists print from their buffers", "[printer]") {
+    auto ints = make_packed({ 2, 3 }, std::vector<int64_t>{ 1, -2, 3, 4, 5, 6 });
+    auto reals = make_packed({ 3 }, std::vector<double>{ 0.25, -1.5, 2 });
+    auto complexes = make_packed({ 2 }, std::vector<std::complex<double>>{ { 1, 2 }, { 0, -1 } });
+    auto empty = make_packed({ 2, 0 }, std::vector<int64_t>{});
+    for (const auto& array : { ints, reals, complexes, empty }) {
+        REQUIRE(to_string(array) == to_string(unpack(array)));
+        REQUIRE(to_fullform(array) == to_fullform(unpack(array)));
+    }
+    REQUIRE(to_string(ints) == "{{1, -2, 3}, {4, 5, 6}}");
+
+    auto lazy = make_range(1, 2, LAZY_RANGE_LENGTH);
+    REQUIRE(to_string(lazy) == to_string(materialize(lazy)));
+}
+
+TEST_CASE("Expressions stream to an ostream in chunks", "[printer]") {
+    EvaluationContext ctx;
+    auto sum = evaluate(parse_expression("Table[x^k, {k, 1, 20000}]"), ctx);
+    std::ostringstream out;
+    write_expr(out, sum);
+    REQUIRE(out.str() == to_string(sum));
+    std::ostringstream full;
+    write_fullform(full, sum);
+    REQUIRE(full.str() == to_fullform(sum));
+}
+
+TEST_CASE("Short cuts output to a number of lines", "[printer]") {
+    EvaluationContext ctx;
+    auto run = [&](const std::string& src) { return to_string(evaluate(parse_expression(src), ctx)); };
+
+    REQUIRE(run("Short[{1, 2, 3}]") == "{1, 2, 3}");
+    // The argument is simplified as a printed result is
+    REQUIRE(run("Short[1 + x^2 + x]") == "x^2 + x + 1");
+    const std::string cut = run("Short[Range[1000], 2]");
+    REQUIRE(cut.size() < 2 * SHORT_LINE_WIDTH + 16);
+    REQUIRE(cut.starts_with("{1, 2, 3, "));
+    REQUIRE(cut.ends_with(">>}"));
+    REQUIRE(cut.find("<<") != std::string::npos);
+
+    // Omitted elements are counted at each open level
+    const std::string nested = run("Short[{Table[k, {k, 1, 100}], a, b}, 1]");
+    REQUIRE(nested.ends_with(">>}, <<2>>}"));
+    REQUIRE(run("Short[{a, b, c}, 0.01]") == "{a, <<2>>}");
+
+    REQUIRE_THROWS(run("Short[x, 0]"));
+    REQUIRE_THROWS(run("Short[x, y]"));
+}
@@ -0,0 +1,87 @@
+#include "expr/Serialize.hpp"
+#include "expr/ExprHash.hpp"
+#include "expr/ExprUtils.hpp"
+#include "expr/FullForm.hpp"
+#include "expr/LazyList.hpp"
+#include "expr/PackedArray.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <complex>
+#include <cstdio>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr round_trip(const ExprPtr& expr) { return deserialize(serialize(expr)); }
+}
+
+TEST_CASE("Serialized expressions read back equal", "[serialize]") {
+    for (const char* source : { "Sin[x + 2*y] -> {1.5, \"a b\", True, -3/4}", "f[x_, y_:2] := x^y",
+                                "z = Complex[1, -2]", "{}", "g[]" }) {
+        auto expr = parse_expression(source);
+        REQUIRE(to_fullform(round_trip(expr)) == to_fullform(expr));
+    }
+
+    auto big = make_expr<Rational>(-pow(BigInt(3), 100), pow(BigInt(2), 70));
+    REQUIRE(expr_equal(round_trip(big), big));
+    for (auto expr : { make_expr<Infinity>(), make_expr<Indeterminate>(), make_expr<Number>(-0.0), make_expr<Number>(-7), make_expr<Number>(1e300),
+                       make_expr<Rational>(BigInt(INT64_MIN), BigInt(INT64_MAX)) }) {
+        REQUIRE(expr_equal(round_trip(expr), expr));
+    }
+
+    auto ints = make_packed({ 2, 3 }, std::vector<int64_t>{ 1, -2, 3, INT64_MAX, 5, INT64_MIN });
+    auto reals = make_packed({ 2 }, std::vector<double>{ 0.25, -1e300 });
+    auto complexes = make_packed({ 1 }, std::vector<std::complex<double>>{ { 1, 2 } });
+    for (const auto& array : { ints, reals, complexes }) {
+        auto back = round_trip(array);
+        REQUIRE(std::holds_alternative<PackedArray>(*back));
+        REQUIRE(expr_equal(back, array));
+    }
+
+    auto lazy = make_range(1, 2, LAZY_RANGE_LENGTH);
+    auto back = round_trip(lazy);
+    REQUIRE(std::get<LazyList>(*back).count == LAZY_RANGE_LENGTH);
+    REQUIRE(std::get<LazyList>(*back).step == 2);
+}
+
+TEST_CASE("Serialized shared subtrees are written once", "[serialize]") {
+    // 2^40 paths through 40 levels of sharing
+    ExprPtr node = make_expr<Symbol>("x");
+    for (int i = 0; i < 40; ++i) node = make_fcall(atoms::Plus, { node, node });
+    const std::string bytes = serialize(node);
+    REQUIRE(bytes.size() < 400);
+    auto back = deserialize(bytes);
+    const auto& args = std::get<FunctionCall>(*back).args;
+    REQUIRE(args[0] == args[1]);
+
+    // Deep trees are written and read without recursion
+    ExprPtr deep = make_expr<Number>(1);
+    for (int i = 0; i < 200000; ++i) deep = make_fcall("f", { deep });
+    back = deserialize(serialize(deep));
+    for (int i = 0; i < 200000; ++i) back = std::get<FunctionCall>(*back).args[0];
+    REQUIRE(std::get<Number>(*back).value == 1);
+}
+
+TEST_CASE("Malformed serialized input is rejected", "[serialize]") {
+    const std::string bytes = serialize(parse_expression("f[x, {1, 2}]"));
+    REQUIRE_THROWS_AS(deserialize(""), SerializationError);
+    REQUIRE_THROWS_AS(deserialize("A3EX\x07"), SerializationError);
+    for (size_t n = 0; n < bytes.size(); ++n) {
+        REQUIRE_THROWS_AS(deserialize(std::string_view(bytes).substr(0, n)), SerializationError);
+    }
+    REQUIRE_THROWS_AS(deserialize(bytes + "x"), SerializationError);
+}
+
+TEST_CASE("BinarySerialize and BinaryDeserialize builtins", "[serialize]") {
+    EvaluationContext ctx;
+    auto result = evaluate(parse_expression("BinaryDeserialize[BinarySerialize[{a, 2/3, \"s\"}]]"), ctx);
+    REQUIRE(to_string(result) == "{a, 2/3, \"s\"}");
+
+    const std::string path = "aleph3_serialize_test.bin";
+    evaluate(parse_expression("BinarySerialize[Sin[y]^2, \"" + path + "\"]"), ctx);
+    result = evaluate(parse_expression("BinaryDeserialize[\"" + path + "\"]"), ctx);
+    std::remove(path.c_str());
+    REQUIRE(to_string(result) == "(Sin[y])^2");
+    REQUIRE_THROWS(evaluate(parse_expression("BinaryDeserialize[{1, 2, 300}]"), ctx));
+}
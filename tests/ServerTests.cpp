@@ -0,0 +1,178 @@
+#include "server/Server.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#endif
+
+using namespace aleph3;
+
+namespace {
+    // Response lines for a script of request lines, in the order they were written
+    std::vector<std::string> serve(Server& server, const std::string& requests) {
+        std::istringstream in(requests);
+        std::ostringstream out;
+        server.serve(in, out);
+        std::vector<std::string> lines;
+        std::istringstream responses(out.str());
+        for (std::string line; std::getline(responses, line);) lines.push_back(line);
+        return lines;
+    }
+}
+
+TEST_CASE("Server requests parse and responses format as JSON", "[server]") {
+    auto request = parse_request(R"({"id": "a\"1", "session": "s", "input": "x\né😀", "timeout_ms": 5, "extra": [1, {"b": null}]})");
+    REQUIRE(request.id == R"("a\"1")");
+    REQUIRE(request.session == "s");
+    REQUIRE(request.op == "eval");
+    REQUIRE(request.input == "x\n\xC3\xA9\xF0\x9F\x98\x80");
+    REQUIRE(request.timeout_ms == 5);
+    REQUIRE(parse_request("{}").session == "default");
+
+    REQUIRE_THROWS_AS(parse_request("{\"input\": 3}"), ProtocolError);
+    REQUIRE_THROWS_AS(parse_request("{\"op\": \"reboot\"}"), ProtocolError);
+    REQUIRE_THROWS_AS(parse_request("{\"id\": 1} x"), ProtocolError);
+    REQUIRE_THROWS_AS(parse_request("[1]"), ProtocolError);
+
+    Response response;
+    response.id = "7";
+    response.session = "s";
+    response.results = { "a\tb" };
+    REQUIRE(format_response(response) == R"({"id": 7, "session": "s", "ok": true, "results": ["a\tb"]})");
+    response.ok = false;
+    response.code = "error";
+    response.line = 2;
+    response.error = "bad\n";
+    REQUIRE(format_response(response) ==
+            R"({"id": 7, "session": "s", "ok": false, "results": ["a\tb"], "code": "error", "line": 2, "error": "bad\n"})");
+}
+
+TEST_CASE("Server sessions are isolated and run in order", "[server]") {
+    ServerOptions options;
+    options.workers = 4;
+    options.max_pending = 3;  // Forces the reader to wait for the workers
+    Server server(options);
+
+    std::string requests;
+    for (int k = 0; k < 20; ++k) {
+        requests += R"({"id": )" + std::to_string(2 * k) + R"(, "session": "a", "input": "x = )" + std::to_string(k) + R"(; x"})" "\n";
+        requests += R"({"id": )" + std::to_string(2 * k + 1) + R"(, "session": "b", "input": "x"})" "\n";
+    }
+    const auto lines = serve(server, requests);
+    REQUIRE(lines.size() == 40);
+    for (int k = 0; k < 20; ++k) {
+        const auto a = R"({"id": )" + std::to_string(2 * k) + R"(, "session": "a", "ok": true, "results": [")" + std::to_string(k) + R"("]})";
+        const auto b = R"({"id": )" + std::to_string(2 * k + 1) + R"(, "session": "b", "ok": true, "results": ["x"]})";
+        REQUIRE(std::count(lines.begin(), lines.end(), a) == 1);
+        REQUIRE(std::count(lines.begin(), lines.end(), b) == 1);
+    }
+    // Session a answers in order
+    REQUIRE(std::find(lines.begin(), lines.end(), R"({"id": 0, "session": "a", "ok": true, "results": ["0"]})") <
+            std::find(lines.begin(), lines.end(), R"({"id": 38, "session": "a", "ok": true, "results": ["19"]})"));
+    REQUIRE(server.session_count() == 2);
+
+    // Closing a session discards its bindings
+    REQUIRE(serve(server, "{\"id\": 1, \"session\": \"a\", \"op\": \"close\"}\n{\"id\": 2, \"session\": \"a\", \"input\": \"x\"}\n") ==
+            std::vector<std::string>{ R"({"id": 1, "session": "a", "ok": true, "results": []})",
+                                      R"({"id": 2, "session": "a", "ok": true, "results": ["x"]})" });
+}
+
+TEST_CASE("Server sessions keep their own attributes", "[server]") {
+    Server server;
+    REQUIRE(serve(server, R"({"id": 1, "session": "a", "input": "SetAttributes[serverOl, Orderless]; serverOl[2, 1]"})" "\n") ==
+            std::vector<std::string>{ R"({"id": 1, "session": "a", "ok": true, "results": ["serverOl[1, 2]"]})" });
+    REQUIRE(serve(server, R"({"id": 2, "session": "b", "input": "Attributes[serverOl]\nserverOl[2, 1]"})" "\n") ==
+            std::vector<std::string>{ R"({"id": 2, "session": "b", "ok": true, "results": ["{}", "serverOl[2, 1]"]})" });
+
+    // Closing a session discards its attributes too
+    REQUIRE(serve(server, "{\"id\": 3, \"session\": \"a\", \"op\": \"close\"}\n"
+                          "{\"id\": 4, \"session\": \"a\", \"input\": \"serverOl[2, 1]\"}\n") ==
+            std::vector<std::string>{ R"({"id": 3, "session": "a", "ok": true, "results": []})",
+                                      R"({"id": 4, "session": "a", "ok": true, "results": ["serverOl[2, 1]"]})" });
+}
+
+TEST_CASE("Server reports errors, timeouts and bad requests", "[server]") {
+    ServerOptions options;
+    options.workers = 2;
+    options.max_sessions = 2;
+    Server server(options);
+
+    auto lines = serve(server, "{\"id\": 1, \"input\": \"y = 2; y + 1\\n(1 +\\ny\"}\n");
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].rfind(R"({"id": 1, "session": "default", "ok": false, "results": ["3"], "code": "error", "line": 2, )", 0) == 0);
+
+    lines = serve(server, "{\"id\": 2, \"session\": \"slow\", \"timeout_ms\": 50, \"input\": \"Length[Table[Sin[k] + x, {k, 1, 100000000}]]\"}\n");
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].find(R"("code": "timeout", "line": 1)") != std::string::npos);
+
+    lines = serve(server, "not json\n\n{\"id\": 3, \"session\": \"third\", \"input\": \"1\"}\n");
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[0].find(R"("code": "bad_request")") != std::string::npos);
+    REQUIRE(lines[1].find(R"("code": "busy")") != std::string::npos);
+}
+
+TEST_CASE("Server cancels earlier requests and limits steps", "[server]") {
+    ServerOptions options;
+    options.workers = 2;
+    options.max_steps = 100000;
+    Server server(options);
+
+    const std::string slow = "Length[Table[Sin[k] + x, {k, 1, 100000000}]]";
+    auto lines = serve(server, "{\"id\": 1, \"session\": \"s\", \"input\": \"" + slow + "\"}\n"
+                               "{\"id\": 2, \"session\": \"s\", \"op\": \"cancel\"}\n"
+                               "{\"id\": 3, \"session\": \"s\", \"input\": \"1 + 1\"}\n");
+    REQUIRE(lines.size() == 3);
+    // The cancel is answered at once, ahead of the request it stopped
+    REQUIRE(lines[0] == R"({"id": 2, "session": "s", "ok": true, "results": []})");
+    REQUIRE(lines[1].find(R"("id": 1)") != std::string::npos);
+    REQUIRE(lines[1].find(R"("code": "cancelled", "line": 1)") != std::string::npos);
+    REQUIRE(lines[2] == R"({"id": 3, "session": "s", "ok": true, "results": ["2"]})");
+
+    lines = serve(server, "{\"id\": 4, \"session\": \"s\", \"timeout_ms\": 0, \"input\": \"" + slow + "\"}\n");
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].find(R"("code": "error", "line": 1, "error": "Step limit exceeded")") != std::string::npos);
+}
+
+#ifndef _WIN32
+TEST_CASE("Server listens on a Unix socket", "[server]") {
+    Server server(ServerOptions{});
+    const std::string path = "/tmp/aleph3_server_test_" + std::to_string(::getpid()) + ".sock";
+    std::thread listener([&] { server.listen("unix:" + path); });
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    // The listener binds asynchronously
+    bool connected = false;
+    for (int attempt = 0; attempt < 200 && !connected; ++attempt) {
+        connected = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (!connected) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(connected);
+
+    const std::string request = "{\"id\": 1, \"input\": \"2 + 3\"}\n";
+    REQUIRE(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+    std::string reply;
+    char chunk[256];
+    while (reply.find('\n') == std::string::npos) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        reply.append(chunk, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    server.stop();
+    listener.join();
+    REQUIRE(reply == "{\"id\": 1, \"session\": \"default\", \"ok\": true, \"results\": [\"5\"]}\n");
+    REQUIRE(::access(path.c_str(), F_OK) != 0);
+}
+#endif
@@ -1,4 +1,5 @@
 #include "transforms/Transforms.hpp"
+#include "transforms/Simplifier.hpp"
 #include "expr/ExprUtils.hpp"
 #include <catch2/catch_test_macros.hpp>
 
@@ -34,4 +35,42 @@ TEST_CASE("Simplify relational functions to True/False", "[simplify]") {
         make_number(3), make_number(2)
     });
     REQUIRE(to_string(simplify(expr)) == "True");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Simplify memoizes results per node", "[simplify]") {
+    clear_simplify_memo();
+    auto expr = make_expr<FunctionCall>("Plus", std::vector<ExprPtr>{
+        make_expr<Symbol>("x"), make_number(0)
+    });
+    auto first = simplify(expr);
+    const auto misses = simplify_stats().misses;
+    auto second = simplify(expr);
+    REQUIRE(second == first);
+    REQUIRE(simplify_stats().misses == misses);
+    REQUIRE(simplify_stats().hits >= 1);
+    clear_simplify_memo();
+    REQUIRE(simplify_stats().entries == 0);
+}
+
+TEST_CASE("Simplify to a fixed point", "[simplify]") {
+    // 2 * x + 3 * x combines to 5 * x, which no further pass changes
+    auto x = make_expr<Symbol>("x");
+    auto expr = make_expr<FunctionCall>("Plus", std::vector<ExprPtr>{
+        make_times(make_number(2), x), make_times(make_number(3), x)
+    });
+    auto result = simplify_to_fixed_point(expr);
+    REQUIRE(to_string(result) == "5 * x");
+    REQUIRE(to_string(simplify(result)) == to_string(result));
+
+    SimplifyOptions none;
+    none.max_passes = 0;
+    REQUIRE(simplify_to_fixed_point(expr, none) == expr);
+}
+
+TEST_CASE("Leaf count", "[simplify]") {
+    auto expr = make_expr<FunctionCall>("Plus", std::vector<ExprPtr>{
+        make_expr<Symbol>("x"), make_expr<FunctionCall>("Power", std::vector<ExprPtr>{ make_expr<Symbol>("y"), make_number(2) })
+    });
+    REQUIRE(leaf_count(expr) == 5);
+    REQUIRE(leaf_count(make_expr<Rational>(1, 2)) == 3);
+}
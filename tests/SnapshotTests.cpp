@@ -0,0 +1,91 @@
+#include "evaluator/Snapshot.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/Serialize.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+}
+
+TEST_CASE("Snapshots restore variables and definitions", "[snapshot]") {
+    const std::string path = "aleph3_snapshot_test.snap";
+    {
+        EvaluationContext ctx;
+        run("x = 3", ctx);
+        run("poly = (a + b)^2", ctx);
+        run("f[n_, k_:2] := n^k + x", ctx);
+        run("fact[0] = 1", ctx);
+        run("fact[n_] := n * fact[n - 1]", ctx);
+        run("fib[0] = 0", ctx);
+        run("fib[1] = 1", ctx);
+        run("fib[n_] := fib[n] = fib[n - 1] + fib[n - 2]", ctx);
+        run("fib[30]", ctx);
+        save_snapshot(ctx, path);
+    }
+
+    EvaluationContext ctx;
+    load_snapshot(ctx, path);
+    std::remove(path.c_str());  // The mapping outlives the name
+
+    REQUIRE(get_number_value(run("x", ctx)) == 3.0);
+    REQUIRE(to_string(run("poly", ctx)) == to_string(run("(a + b)^2", ctx)));
+    REQUIRE(get_number_value(run("f[4]", ctx)) == 19.0);
+    REQUIRE(get_number_value(run("f[2, 3]", ctx)) == 11.0);
+    REQUIRE(get_number_value(run("fact[10]", ctx)) == 3628800.0);
+    REQUIRE(get_number_value(run("fib[40]", ctx)) == 102334155.0);
+
+    // Loaded bindings behave like any other
+    run("x = 10", ctx);
+    REQUIRE(get_number_value(run("f[1]", ctx)) == 11.0);
+    run("f[n_] := -n", ctx);
+    REQUIRE(get_number_value(run("f[5]", ctx)) == -5.0);
+    run("fact[3] = 0", ctx);
+    REQUIRE(get_number_value(run("fact[4]", ctx)) == 0.0);
+}
+
+TEST_CASE("Snapshots replace bindings of the same name only", "[snapshot]") {
+    const std::string path = "aleph3_snapshot_merge.snap";
+    {
+        EvaluationContext ctx;
+        run("a = 1", ctx);
+        run("g[y_] := y + 1", ctx);
+        save_snapshot(ctx, path);
+    }
+    EvaluationContext ctx;
+    run("a = 5", ctx);
+    run("b = 7", ctx);
+    run("g[y_] := y - 1", ctx);
+    run("LoadSnapshot[\"" + path + "\"]", ctx);
+    std::remove(path.c_str());
+
+    REQUIRE(get_number_value(run("a", ctx)) == 1.0);
+    REQUIRE(get_number_value(run("b", ctx)) == 7.0);
+    REQUIRE(get_number_value(run("g[1]", ctx)) == 2.0);
+}
+
+TEST_CASE("Unreadable snapshots are rejected", "[snapshot]") {
+    EvaluationContext ctx;
+    REQUIRE_THROWS_AS(load_snapshot(ctx, "aleph3_no_such.snap"), SerializationError);
+
+    const std::string path = "aleph3_snapshot_bad.snap";
+    run("v = {1, 2, 3}", ctx);
+    save_snapshot(ctx, path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    for (size_t n : { size_t(0), size_t(3), size_t(6) }) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(n));
+        EvaluationContext fresh;
+        REQUIRE_THROWS_AS(load_snapshot(fresh, path), SerializationError);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,54 @@
+#include "util/ThreadPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace aleph3;
+
+TEST_CASE("Every chunk runs exactly once", "[threadpool]") {
+    ThreadPool pool(3);
+    REQUIRE(pool.concurrency() == 4);
+    for (size_t grain : { size_t{1}, size_t{7}, size_t{1000}, size_t{5000} }) {
+        std::vector<std::atomic<int>> hits(4321);
+        pool.parallel_for(hits.size(), grain, [&](size_t chunk, size_t begin, size_t end) {
+            REQUIRE(begin == chunk * grain);
+            for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+            });
+        for (const auto& h : hits) REQUIRE(h.load() == 1);
+    }
+    pool.parallel_for(0, 16, [](size_t, size_t, size_t) { FAIL("No chunks expected"); });
+}
+
+TEST_CASE("Uneven chunks are stolen by idle threads", "[threadpool]") {
+    ThreadPool pool(3);
+    std::vector<double> partial(ThreadPool::chunk_count(256, 1));
+    // The first quarter of the chunks is far slower than the rest
+    pool.parallel_for(256, 1, [&](size_t chunk, size_t, size_t) {
+        double x = 0;
+        for (int i = 0; i < (chunk < 64 ? 20000 : 10); ++i) x += 1.0 / (i + 1);
+        partial[chunk] = x;
+        });
+    for (const auto& p : partial) REQUIRE(p > 0);
+}
+
+TEST_CASE("Exceptions reach the caller and nested jobs run serially", "[threadpool]") {
+    ThreadPool pool(2);
+    REQUIRE_THROWS_AS(pool.parallel_for(100, 1, [](size_t chunk, size_t, size_t) {
+        if (chunk == 42) throw std::runtime_error("boom");
+        }), std::runtime_error);
+
+    std::atomic<size_t> inner_total{0};
+    pool.parallel_for(8, 1, [&](size_t, size_t, size_t) {
+        REQUIRE(ThreadPool::in_job());
+        pool.parallel_for(10, 3, [&](size_t, size_t begin, size_t end) { inner_total += end - begin; });
+        });
+    REQUIRE(inner_total == 80);
+    REQUIRE_FALSE(ThreadPool::in_job());
+
+    pool.resize(0);
+    size_t serial = 0;
+    pool.parallel_for(10, 4, [&](size_t, size_t begin, size_t end) { serial += end - begin; });
+    REQUIRE(serial == 10);
+}
@@ -0,0 +1,70 @@
+#include "algebra/Coefficients.hpp"
+#include "algebra/SparsePolynomial.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+TEST_CASE("Modular fields reduce with Montgomery and Barrett arithmetic", "[algebra][coefficients]") {
+    ModularField small(101);
+    const auto a = small.from_uint(57), b = small.from_uint(88);
+    REQUIRE(small.to_uint(small.mul(a, b)) == (57 * 88) % 101);
+    REQUIRE(small.to_uint(small.add(a, b)) == (57 + 88) % 101);
+    REQUIRE(small.to_uint(small.sub(a, b)) == 101 + 57 - 88);
+    REQUIRE(small.to_uint(small.mul(a, small.inverse(a))) == 1);
+    REQUIRE(small.to_uint(small.from_integer(BigInt(-3))) == 98);
+    REQUIRE(small.to_uint(small.from_rational(BigInt(1), BigInt(2))) == 51);
+    REQUIRE_THROWS_AS(small.inverse(small.zero()), std::domain_error);
+
+    // Word-sized: (p - 1)^2 = 1 and Fermat's little theorem
+    ModularField big;
+    const uint64_t p = big.modulus();
+    const auto minus_one = big.from_uint(p - 1);
+    REQUIRE(big.to_uint(big.mul(minus_one, minus_one)) == 1);
+    REQUIRE(big.pow(big.from_uint(123456789), p - 1) == big.one());
+    REQUIRE(big.to_uint(big.from_integer(pow(BigInt(2), 64))) == (uint64_t(1) << 63) % p * 2 % p);
+
+    REQUIRE_THROWS_AS(ModularField(91), std::invalid_argument);          // 7 * 13
+    REQUIRE_THROWS_AS(ModularField(uint64_t(1) << 63), std::invalid_argument);
+}
+
+TEST_CASE("Exact coefficient rings keep large products exact", "[algebra][coefficients]") {
+    auto ring = std::make_shared<const PolynomialRing>(std::vector<std::string>{ "x" });
+    auto x = IntegerPolynomial::variable(ring, 0);
+
+    // (x + 2^40)^2 has 2^80 as its constant term, past int64 and double precision
+    auto shifted = x + IntegerPolynomial::constant(ring, pow(BigInt(2), 40));
+    auto square = shifted * shifted;
+    REQUIRE(square.coefficient(Exponents{}) == pow(BigInt(2), 80));
+    REQUIRE((square - square).is_zero());
+
+    // Long integer products take the Kronecker path and stay exact
+    std::vector<IntegerPolynomial::Term> terms;
+    for (uint32_t i = 0; i < 300; ++i) terms.push_back({ ring->pack({ i }), BigInt(int64_t(i % 5) - 2) });
+    auto f = IntegerPolynomial::from_terms(ring, terms);
+    auto product = f * f;
+    auto expected = multiply_heap(f, f);
+    REQUIRE(product.size() == expected.size());
+    for (size_t k = 0; k < expected.size(); ++k) REQUIRE(product.terms()[k].coeff == expected.terms()[k].coeff);
+
+    // (x/3 - 1/2) * (x/3 + 1/2) = x^2/9 - 1/4, with nothing dropped
+    RationalField q;
+    auto rx = RationalPolynomial::variable(ring, 0);
+    auto a = rx * q.from_rational(1, 3) - RationalPolynomial::constant(ring, q.from_rational(1, 2));
+    auto b = rx * q.from_rational(1, 3) + RationalPolynomial::constant(ring, q.from_rational(1, 2));
+    auto r = a * b;
+    REQUIRE(r.size() == 2);
+    REQUIRE(r.coefficient(ring->pack({ 2 })) == Fraction{ 1, 9 });
+    REQUIRE(r.coefficient(Exponents{}) == Fraction{ -1, 4 });
+
+    // Z/7: (x + 1)^7 = x^7 + 1
+    ModularField f7(7);
+    auto mx = ModularPolynomial::variable(ring, 0, 1, f7);
+    auto m = mx + ModularPolynomial::constant(ring, f7.one(), f7);
+    auto power = m;
+    for (int i = 1; i < 7; ++i) power = power * m;
+    REQUIRE(power.size() == 2);
+    REQUIRE_THROWS_AS(m + ModularPolynomial::variable(ring, 0, 1, ModularField(11)), std::invalid_argument);
+}
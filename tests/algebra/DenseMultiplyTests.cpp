@@ -0,0 +1,70 @@
+#include "algebra/DenseMultiply.hpp"
+#include "algebra/SparsePolynomial.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <memory>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    // Integer coefficients in [-50, 50], without a fixed pattern
+    std::vector<double> coefficients(size_t n, uint32_t seed) {
+        std::vector<double> c(n);
+        for (size_t i = 0; i < n; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            c[i] = static_cast<double>(static_cast<int>((seed >> 16) % 101) - 50);
+        }
+        return c;
+    }
+}
+
+TEST_CASE("Dense multiplication methods agree with schoolbook", "[algebra][dense]") {
+    using dense::Method;
+    // Lengths past each threshold, balanced and unbalanced
+    for (auto [la, lb] : { std::pair<size_t, size_t>{ 5, 3 }, { 70, 45 }, { 400, 400 }, { 900, 250 }, { 1000, 1000 } }) {
+        const auto a = coefficients(la, 1), b = coefficients(lb, 2);
+        const auto expected = dense::multiply(a, b, Method::Schoolbook);
+        REQUIRE(expected.size() == la + lb - 1);
+        for (auto method : { Method::Karatsuba, Method::Toom3, Method::NTT, Method::Automatic }) {
+            // Integer inputs stay exact on every path
+            REQUIRE(dense::multiply(a, b, method) == expected);
+        }
+        const auto fft = dense::multiply(a, b, Method::FFT);
+        for (size_t k = 0; k < expected.size(); ++k) REQUIRE(fft[k] == Catch::Approx(expected[k]).margin(1e-6));
+    }
+    REQUIRE(dense::multiply({}, { 1.0 }).empty());
+}
+
+TEST_CASE("NTT products are exact beyond double-sized partial sums", "[algebra][dense]") {
+    // (2^40 x^2 - 3) * (2^40 x + 1) has the coefficient 2^80, past the 2^53 of a double sum
+    const std::vector<double> a{ -3.0, 0.0, 1099511627776.0 }, b{ 1.0, 1099511627776.0 };
+    REQUIRE(dense::ntt_exact(a, b));
+    const auto c = dense::multiply(a, b, dense::Method::NTT);
+    REQUIRE(c == dense::multiply(a, b, dense::Method::Schoolbook));
+    REQUIRE(c[0] == -3.0);
+    REQUIRE(c[1] == -3298534883328.0);
+
+    REQUIRE_FALSE(dense::ntt_exact({ 0.5 }, { 1.0 }));
+    REQUIRE_FALSE(dense::ntt_exact({ 1e20 }, { 1e20 }));
+    REQUIRE_THROWS_AS(dense::multiply({ 0.5 }, { 1.0 }, dense::Method::NTT), std::domain_error);
+}
+
+TEST_CASE("Kronecker substitution multiplies multivariate polynomials", "[algebra][dense]") {
+    auto ring = std::make_shared<const PolynomialRing>(std::vector<std::string>{ "x", "y" });
+    // Dense in x and y: (sum of c_ij x^i y^j, i, j < 12)^2
+    std::vector<SparsePolynomial::Term> terms;
+    const auto c = coefficients(144, 3);
+    for (uint32_t i = 0; i < 12; ++i) {
+        for (uint32_t j = 0; j < 12; ++j) terms.push_back({ ring->pack({ i, j }), c[i * 12 + j] + 0.25 });
+    }
+    auto f = SparsePolynomial::from_terms(ring, terms);
+    auto kronecker = multiply_kronecker(f, f);
+    auto heap = multiply_heap(f, f);
+    REQUIRE(kronecker.size() == heap.size());
+    for (size_t k = 0; k < heap.size(); ++k) {
+        REQUIRE(kronecker.terms()[k].exponents == heap.terms()[k].exponents);
+        REQUIRE(kronecker.terms()[k].coeff == Catch::Approx(heap.terms()[k].coeff));
+    }
+    REQUIRE((f * f).size() == heap.size());
+}
@@ -131,4 +131,20 @@ TEST_CASE("Polynomial Addition: Multivariate with negative and positive terms")
     REQUIRE(get_coeff(sum, {{"x",2},{"y",1}}) == 0.0);
     REQUIRE(get_coeff(sum, {{"x",1},{"y",2}}) == 0.0);
     REQUIRE(get_coeff(sum, {}) == 2.0);
-}
\ No newline at end of file
+}
+TEST_CASE("Polynomial Addition: In place") {
+    // (x + 1) += (x - 1), then -= 2x leaves the zero polynomial
+    Polynomial p = make_poly({{1.0, {{"x",1}}}, {1.0, {}}});
+    p += make_poly({{1.0, {{"x",1}}}, {-1.0, {}}});
+    REQUIRE(get_coeff(p, {{"x",1}}) == 2.0);
+    REQUIRE(p.terms.size() == 1);
+    p -= make_poly({{2.0, {{"x",1}}}});
+    REQUIRE(p.is_zero());
+
+    // 0 + x*(x + y) by addmul, then the zero constant is gone
+    p.addmul(make_poly({{1.0, {{"x",1}}}}), make_poly({{1.0, {{"x",1}}}, {1.0, {{"y",1}}}}));
+    REQUIRE(p.terms.size() == 2);
+    REQUIRE(get_coeff(p, {{"x",1},{"y",1}}) == 1.0);
+    p *= make_poly({{3.0, {}}});
+    REQUIRE(get_coeff(p, {{"x",2}}) == 3.0);
+}
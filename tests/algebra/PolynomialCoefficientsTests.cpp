@@ -0,0 +1,77 @@
+#include "algebra/PolynomialCoefficients.hpp"
+#include "algebra/PolyUtils.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/PackedArray.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr input(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    std::string run(const std::string& source) {
+        return to_string(input(source));
+    }
+}
+
+TEST_CASE("Terms are grouped by the exponents of the main variables", "[algebra][coefficients]") {
+    const auto p = expr_to_polynomial<IntegerRing>(input("a*x^2*y + b*x^2*y + 3*x^2 + 2*y + a"), { "x", "y", "a", "b" });
+    const auto groups = group_by_main_variables(p, 2);
+
+    REQUIRE(groups.size() == 4);
+    REQUIRE(groups[0].exponents == std::vector<uint32_t>{ 2, 1 });
+    REQUIRE(groups[1].exponents == std::vector<uint32_t>{ 2, 0 });
+    REQUIRE(groups[2].exponents == std::vector<uint32_t>{ 0, 1 });
+    REQUIRE(groups[3].exponents == std::vector<uint32_t>{ 0, 0 });
+    // The coefficients keep the ring and lose the main variables
+    REQUIRE(groups[0].coefficient.size() == 2);
+    REQUIRE(groups[0].coefficient.degree(0) == 0);
+    REQUIRE(groups[0].coefficient.degree(2) == 1);
+    REQUIRE(groups[1].coefficient.coefficient(Exponents{}) == BigInt(3));
+
+    REQUIRE(group_by_main_variables(p, 0).size() == 1);
+    REQUIRE_THROWS_AS(group_by_main_variables(p, 5), std::invalid_argument);
+}
+
+TEST_CASE("Collect nests coefficients by the main variables", "[algebra][coefficients]") {
+    REQUIRE(run("Collect[a*x + b*x + c, x]") == "c + x * (a + b)");
+    REQUIRE(run("Collect[a*x^2*y + b*x^2*y + c*x^2 + d*y + e, {x, y}]") == "d * y + e + x^2 * (c + y * (a + b))");
+    REQUIRE(run("Collect[(1 + x)^2, x]") == "1 + 2 * x + x^2");
+    REQUIRE(run("Collect[0, x]") == "0");
+}
+
+TEST_CASE("Coefficient picks one monomial of the main variables", "[algebra][coefficients]") {
+    REQUIRE(run("Coefficient[x*y + x + 3, x]") == "1 + y");
+    REQUIRE(run("Coefficient[(x + y)^3, x^2*y]") == "3");
+    REQUIRE(run("Coefficient[(x + y)^3, x*x*y]") == "3");
+    REQUIRE(run("Coefficient[(x + 1)^3, x, 0]") == "1");
+    REQUIRE(run("Coefficient[(x + 1)^3, x, 2]") == "3");
+    REQUIRE(run("Coefficient[a*x^2 + b, x^3]") == "0");
+    REQUIRE(run("Coefficient[(1/2)*x + 1, x]") == "1/2");
+    REQUIRE_THROWS(input("Coefficient[x + 1, 2*x]"));
+}
+
+TEST_CASE("CoefficientList lays coefficients out densely", "[algebra][coefficients]") {
+    REQUIRE(run("CoefficientList[(x + 1)^3, x]") == "{1, 3, 3, 1}");
+    REQUIRE(run("CoefficientList[1 + 2*x + 3*y + 4*x*y, {x, y}]") == "{{1, 3}, {2, 4}}");
+    REQUIRE(run("CoefficientList[a*x^2 + b, x]") == "{b, 0, a}");
+    REQUIRE(run("CoefficientList[x^2 + y, {x, y}]") == "{{0, 1}, {0, 0}, {1, 0}}");
+    REQUIRE(run("CoefficientList[0, x]") == "{}");
+
+    // Numeric coefficients come back packed
+    auto list = input("CoefficientList[Expand[(1 + x)^299], x]");
+    REQUIRE(std::holds_alternative<PackedArray>(*list));
+    REQUIRE(std::get<PackedArray>(*list).data->size() == 300);
+}
+
+TEST_CASE("Exponent is the degree in one variable", "[algebra][coefficients]") {
+    REQUIRE(run("Exponent[(x + 1)^5 + y, x]") == "5");
+    REQUIRE(run("Exponent[a*y, x]") == "0");
+    REQUIRE(run("Exponent[0, x]") == "-Infinity");
+}
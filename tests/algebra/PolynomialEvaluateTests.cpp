@@ -0,0 +1,119 @@
+#include "algebra/PolynomialEvaluate.hpp"
+#include "algebra/PolyUtils.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include "util/ThreadPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    SparsePolynomial real(const std::string& source, const std::vector<std::string>& variables) {
+        EvaluationContext ctx;
+        return expr_to_polynomial<RealField>(evaluate(parse_expression(source), ctx), variables);
+    }
+
+    // p at each point by summing its terms one by one
+    std::vector<double> term_by_term(const SparsePolynomial& p, const std::vector<double>& points) {
+        const size_t n = p.ring().size();
+        std::vector<double> values;
+        for (size_t k = 0; k < points.size(); k += n) {
+            double sum = 0.0;
+            for (const auto& t : p.terms()) {
+                double term = t.coeff;
+                for (size_t v = 0; v < n; ++v) term *= std::pow(points[k + v], p.ring().exponent(t.exponents, v));
+                sum += term;
+            }
+            values.push_back(sum);
+        }
+        return values;
+    }
+
+    struct PoolWorkers {
+        size_t previous = ThreadPool::instance().concurrency() - 1;
+        explicit PoolWorkers(size_t workers) { ThreadPool::instance().resize(workers); }
+        ~PoolWorkers() { ThreadPool::instance().resize(previous); }
+    };
+}
+
+TEST_CASE("Compiled polynomials agree with term-by-term evaluation", "[algebra][evaluate]") {
+    const auto p = real("3*x^2*y + 2*y^3 - x*z^5 + x^7 + 4*z - 5", { "x", "y", "z" });
+    const CompiledPolynomial compiled(p);
+    REQUIRE(compiled.variables() == 3);
+
+    // 37 points: two full blocks and a partial one
+    std::vector<double> points;
+    for (int k = 0; k < 37 * 3; ++k) points.push_back(std::sin(0.7 * k) * 2.0);
+    const auto values = compiled.evaluate(points);
+    const auto expected = term_by_term(p, points);
+    REQUIRE(values.size() == 37);
+    for (size_t i = 0; i < values.size(); ++i) REQUIRE(values[i] == Catch::Approx(expected[i]));
+
+    const double point[] = { 2.0, -1.0, 0.5 };
+    REQUIRE(compiled(point) == Catch::Approx(3 * 4 * -1.0 + 2 * -1.0 - 2 * std::pow(0.5, 5) + 128 + 2 - 5));
+
+    // The zero polynomial, a constant, and variables that never occur
+    REQUIRE(CompiledPolynomial(real("0", { "x" }))(point) == 0.0);
+    REQUIRE(CompiledPolynomial(real("7", { "x", "y" }))(point) == 7.0);
+    REQUIRE(CompiledPolynomial(real("y^2", { "x", "y" }))(point) == 1.0);
+    REQUIRE_THROWS_AS(compiled.evaluate(std::vector<double>{ 1.0, 2.0 }), std::invalid_argument);
+}
+
+TEST_CASE("Map polynomials compile in the given variable order", "[algebra][evaluate]") {
+    Polynomial p({ { { { "x", 2 }, { "y", 1 } }, 3.0 }, { { { "y", 3 } }, 2.0 }, { {}, 1.0 } });
+    const CompiledPolynomial yx(p, { "y", "x" });
+    const double point[] = { 2.0, 5.0 };  // y = 2, x = 5
+    REQUIRE(yx(point) == 3 * 25 * 2 + 2 * 8 + 1);
+    REQUIRE_THROWS_AS(CompiledPolynomial(p, { "x" }), std::invalid_argument);
+}
+
+TEST_CASE("Long univariate polynomials split Horner's rule across lanes", "[algebra][evaluate]") {
+    // Degree 999 with coefficients 1 / (k + 1)
+    std::vector<SparsePolynomial::Term> terms;
+    auto ring = std::make_shared<const PolynomialRing>(std::vector<std::string>{ "x" });
+    for (uint32_t k = 0; k < 1000; ++k) terms.push_back({ ring->pack({ k }), 1.0 / (k + 1) });
+    const CompiledPolynomial compiled(SparsePolynomial::from_terms(ring, terms));
+
+    const std::vector<double> few{ 0.5, -0.9, 0.999, 1.0 };
+    std::vector<double> many(64);
+    for (size_t i = 0; i < many.size(); ++i) many[i] = few[i % few.size()];
+    const auto split = compiled.evaluate(few), blocked = compiled.evaluate(many);
+    for (size_t i = 0; i < few.size(); ++i) {
+        double horner = 0.0;
+        for (size_t k = 1000; k-- > 0;) horner = horner * few[i] + 1.0 / (k + 1);
+        REQUIRE(split[i] == Catch::Approx(horner).epsilon(1e-12));
+        REQUIRE(blocked[i] == Catch::Approx(horner).epsilon(1e-12));
+    }
+    // At x = 1 the sum is the harmonic number H_1000
+    REQUIRE(split[3] == Catch::Approx(7.485470860550345));
+}
+
+TEST_CASE("Large batches evaluate across threads", "[algebra][evaluate][parallel]") {
+    const CompiledPolynomial compiled(real("x^3*y - 2*x*y^2 + y - 1", { "x", "y" }));
+    std::vector<double> points(2 * (CompiledPolynomial::PARALLEL_POINTS + 5));
+    for (size_t k = 0; k < points.size(); ++k) points[k] = std::cos(0.01 * k);
+    const auto serial = compiled.evaluate(points);
+    PoolWorkers workers(3);
+    REQUIRE(compiled.evaluate(points) == serial);
+}
+
+TEST_CASE("PolynomialEvaluate maps a polynomial over points", "[algebra][evaluate]") {
+    EvaluationContext ctx;
+    const auto run = [&](const std::string& source) { return evaluate(parse_expression(source), ctx); };
+    const auto numbers = [](const ExprPtr& e) {
+        std::vector<double> out;
+        const ExprPtr list = unpack(e);
+        for (const auto& item : std::get<List>(*list).elements) out.push_back(std::get<Number>(*item).value);
+        return out;
+    };
+    REQUIRE(numbers(run("PolynomialEvaluate[x^2 + y, {x, y}, {{1, 2}, {3, 4}}]")) == std::vector<double>{ 3.0, 13.0 });
+    REQUIRE(numbers(run("PolynomialEvaluate[x^2 - 1, x, {0, 1, 1/2}]")) == std::vector<double>{ -1.0, 0.0, -0.75 });
+    REQUIRE(numbers(run("PolynomialEvaluate[(x + 1)^2, x, Range[300]]")).back() == 301.0 * 301.0);
+    REQUIRE(std::holds_alternative<PackedArray>(*run("PolynomialEvaluate[x, x, Range[300]]")));
+    REQUIRE_THROWS(run("PolynomialEvaluate[x + y, {x, y}, {1, 2}]"));
+    REQUIRE_THROWS(run("PolynomialEvaluate[Sin[x], x, {1}]"));
+}
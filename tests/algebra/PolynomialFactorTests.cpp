@@ -0,0 +1,130 @@
+#include "algebra/PolynomialFactor.hpp"
+#include "algebra/PolyUtils.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    const std::vector<std::string> XY{ "x", "y" };
+
+    // Evaluated first, so differences become sums
+    ExprPtr input(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    IntegerPolynomial integer(const std::string& source) {
+        return expr_to_polynomial<IntegerRing>(input(source), XY);
+    }
+
+    bool same(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+        if (a.size() != b.size()) return false;
+        for (const auto& t : b.terms()) {
+            if (a.coefficient(t.exponents) != t.coeff) return false;
+        }
+        return true;
+    }
+
+    IntegerPolynomial expand(const Factorization& f, const IntegerPolynomial& like) {
+        IntegerPolynomial out = IntegerPolynomial::constant(like.ring_ptr(), f.unit);
+        for (const auto& [factor, multiplicity] : f.factors) {
+            for (uint32_t k = 0; k < multiplicity; ++k) out = out * factor;
+        }
+        return out;
+    }
+}
+
+TEST_CASE("Modular factorization splits by degree", "[algebra][factor]") {
+    ModularField field(101);
+    const auto poly = [&](std::vector<uint64_t> c) {
+        for (auto& v : c) v = field.from_uint(v);
+        return c;
+    };
+    // (x + 1)(x + 2)(x^2 + 2), with x^2 + 2 irreducible since -2 is not a square mod 101
+    const auto f = modular::mul(field, modular::mul(field, poly({ 1, 1 }), poly({ 2, 1 })), poly({ 2, 0, 1 }));
+    const auto factors = factor_modular(field, f);
+    REQUIRE(factors.size() == 3);
+    REQUIRE(modular::degree(factors[0]) == 1);
+    REQUIRE(modular::degree(factors[1]) == 1);
+    REQUIRE(factors[2] == poly({ 2, 0, 1 }));
+    REQUIRE_THROWS_AS(factor_modular(field, poly({ 1, 2 })), std::domain_error);
+}
+
+TEST_CASE("Univariate factors carry the unit and multiplicities", "[algebra][factor]") {
+    const auto p = integer("-6") * integer("x - 1") * integer("x - 1") * integer("2*x + 3") * integer("x^2 + 1");
+    const auto f = factor(p);
+    REQUIRE(f.unit == BigInt(-6));
+    REQUIRE(f.factors.size() == 3);
+    REQUIRE(same(f.factors[0].first, integer("x - 1")));
+    REQUIRE(f.factors[0].second == 2);
+    REQUIRE(same(f.factors[1].first, integer("2*x + 3")));
+    REQUIRE(f.factors[1].second == 1);
+    REQUIRE(same(f.factors[2].first, integer("x^2 + 1")));
+    REQUIRE(same(expand(f, p), p));
+
+    REQUIRE(factor(integer("0")).unit.is_zero());
+    REQUIRE(factor(integer("7")).factors.empty());
+}
+
+TEST_CASE("Recombination finds factors with no linear modular image", "[algebra][factor]") {
+    // x^4 + 4 splits into quadratics over Z; x^4 + 1 splits mod every prime but not over Z
+    auto f = factor(integer("x^4 + 4"));
+    REQUIRE(f.factors.size() == 2);
+    REQUIRE(same(f.factors[0].first, integer("x^2 - 2*x + 2")));
+    REQUIRE(same(f.factors[1].first, integer("x^2 + 2*x + 2")));
+    REQUIRE(factor(integer("x^4 + 1")).factors.size() == 1);
+}
+
+TEST_CASE("Long products lift and recombine", "[algebra][factor]") {
+    const std::vector<std::string> parts{ "x^50 + 3*x^17 - 2", "x^60 - x^31 + 5*x + 1", "7*x^40 + x^2 - 4", "x^50 - 2*x^49 + 9" };
+    IntegerPolynomial p = integer("1");
+    for (const auto& s : parts) p = p * integer(s);
+    const auto f = factor(p);
+    REQUIRE(f.unit == BigInt(1));
+    REQUIRE(f.factors.size() == parts.size());
+    REQUIRE(same(expand(f, p), p));
+
+    // x^105 - 1 is the product of the cyclotomic polynomials for the 8 divisors of 105
+    REQUIRE(factor(integer("x^105 - 1")).factors.size() == 8);
+}
+
+TEST_CASE("Multivariate factors come back through Kronecker images", "[algebra][factor]") {
+    auto f = factor(integer("x^3*y - x*y^3"));
+    REQUIRE(f.factors.size() == 4);
+    REQUIRE(same(expand(f, integer("1")), integer("x^3*y - x*y^3")));
+
+    const auto g = integer("x^2*y + 3*y - 1");
+    const auto p = g * g * integer("x*y^2 - x + 2");
+    f = factor(p);
+    REQUIRE(f.factors.size() == 2);
+    REQUIRE(same(expand(f, p), p));
+
+    const auto parts = square_free(p);
+    REQUIRE(parts.factors.size() == 2);
+    REQUIRE(parts.factors[0].second + parts.factors[1].second == 3);
+}
+
+TEST_CASE("Factor expresses the factorization as a product", "[algebra][factor]") {
+    EvaluationContext ctx;
+    auto factored = evaluate(parse_expression("Factor[x^2 - y^2]"), ctx);
+    auto expanded = evaluate(make_fcall("Expand", { factored }), ctx);
+    REQUIRE(same(expr_to_polynomial<IntegerRing>(expanded, XY), integer("x^2 - y^2")));
+    REQUIRE(std::holds_alternative<FunctionCall>(*factored));
+    REQUIRE(std::get<FunctionCall>(*factored).head == "Times");
+}
+
+TEST_CASE("Factor gives the evaluator's canonical form", "[algebra][factor]") {
+    EvaluationContext ctx;
+    auto factor = [&](const std::string& src) { return to_string(evaluate(parse_expression("Factor[" + src + "]"), ctx)); };
+    REQUIRE(factor("x^2 + 2*x + 1") == "(1 + x)^2");
+    REQUIRE(factor("x^3 + 3*x^2 + 3*x + 1") == "(1 + x)^3");
+    REQUIRE(factor("(x^2 - 1)^2") == "(-1 + x)^2 * (1 + x)^2");
+    REQUIRE(factor("2*x^2 - 2") == "2 * (-1 + x) * (1 + x)");
+    // Evaluating the result again changes nothing
+    const std::string once = factor("x^2 + 2*x + 1");
+    REQUIRE(to_string(evaluate(parse_expression(once), ctx)) == once);
+}
@@ -0,0 +1,86 @@
+#include "algebra/PolynomialGcd.hpp"
+#include "algebra/PolyUtils.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    const std::vector<std::string> XYZ{ "x", "y", "z" };
+
+    // Evaluated first, so differences become sums
+    ExprPtr input(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    IntegerPolynomial integer(const std::string& source) {
+        return expr_to_polynomial<IntegerRing>(input(source), XYZ);
+    }
+
+    void require_same(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+        REQUIRE(a.size() == b.size());
+        for (const auto& t : b.terms()) REQUIRE(a.coefficient(t.exponents) == t.coeff);
+    }
+}
+
+TEST_CASE("Exponent division borrows per field", "[algebra][gcd]") {
+    PolynomialRing ring(XYZ);
+    REQUIRE(ring.divide(ring.pack({ 3, 1, 4 }), ring.pack({ 1, 1, 2 })) == ring.pack({ 2, 0, 2 }));
+    REQUIRE_FALSE(ring.divide(ring.pack({ 3, 0, 4 }), ring.pack({ 1, 1, 0 })));
+    REQUIRE(ring.without(ring.pack({ 3, 1, 4 }), 1) == ring.pack({ 3, 0, 4 }));
+}
+
+TEST_CASE("Exact division recovers cofactors", "[algebra][gcd]") {
+    auto g = integer("x*y + 2*z - 3");
+    auto h = integer("x^2 - y*z + 5");
+    auto q = divide_exact(g * h, g);
+    REQUIRE(q);
+    require_same(*q, h);
+    REQUIRE_FALSE(divide_exact(g * h + integer("1"), g));
+    REQUIRE_FALSE(divide_exact(integer("3*x"), integer("2*x")));  // 3/2 is not an integer
+    REQUIRE_THROWS_AS(divide_exact(g, integer("0")), std::domain_error);
+}
+
+TEST_CASE("Multivariate integer gcds come from modular images", "[algebra][gcd]") {
+    auto g = integer("x^2*y - 3*x*z + y^3 - 7");
+    auto a = g * integer("x*y*z + x - 2*y + 1") * integer("4");
+    auto b = g * integer("x^3 - y^2*z^2 + 11*z") * integer("6");
+    require_same(gcd(a, b), g * integer("2"));
+    require_same(gcd(b, a), g * integer("2"));
+
+    // Coprime inputs, and one input a multiple of the other
+    require_same(gcd(integer("x + y"), integer("x - y")), integer("1"));
+    require_same(gcd(a, g), g);
+    require_same(gcd(integer("0"), g * integer("-1")), g);
+
+    // Coefficients past one 62-bit prime need the Chinese remainder theorem
+    auto big = integer("x*z + 3*y - 1") + integer("x") * IntegerPolynomial::constant(g.ring_ptr(), pow(BigInt(2), 90));
+    require_same(gcd(big * integer("x - y + 5"), big * integer("x^2 + z")), big);
+}
+
+TEST_CASE("Modular gcds are monic", "[algebra][gcd]") {
+    ModularField field(1000003);
+    auto ring = std::make_shared<const PolynomialRing>(XYZ);
+    auto x = ModularPolynomial::variable(ring, 0, 1, field);
+    auto y = ModularPolynomial::variable(ring, 1, 1, field);
+    auto z = ModularPolynomial::variable(ring, 2, 1, field);
+    auto g = x * y * field.from_uint(5) + z * z + y;
+    auto a = g * (x + z * field.from_uint(3));
+    auto b = g * (x * x - y);
+    auto r = gcd(a, b);
+    REQUIRE(r.terms().front().coeff == field.one());
+    REQUIRE((r * field.from_uint(5) - g).is_zero());
+}
+
+TEST_CASE("GCD handles several variables and exact coefficients", "[algebra][gcd]") {
+    auto p = expr_to_polynomial(input("x^3*y*z - x*y*z^3"), XYZ);
+    auto q = expr_to_polynomial(input("x^2*z - z^3 + x*y*z - y*z^2"), XYZ);
+    auto g = to_polynomial(integer("x*z - z^2"));
+    auto r = gcd(to_polynomial(p), to_polynomial(q), XYZ);
+    REQUIRE(r.terms == g.terms);
+}
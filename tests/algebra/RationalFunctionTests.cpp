@@ -0,0 +1,97 @@
+#include "algebra/PolyUtils.hpp"
+#include "algebra/RationalFunction.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr input(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    std::string run(const std::string& source) {
+        return to_string(input(source));
+    }
+
+    IntegerPolynomial integer(const std::string& source, const std::vector<std::string>& variables) {
+        return expr_to_polynomial<IntegerRing>(input(source), variables);
+    }
+
+    bool equal(const IntegerPolynomial& a, const IntegerPolynomial& b) {
+        return (a - b).is_zero();
+    }
+}
+
+TEST_CASE("Henrici products cancel across the operands", "[algebra][ratfun]") {
+    const std::vector<std::string> xy{ "x", "y" };
+    const auto p = [&](const std::string& source) { return integer(source, xy); };
+    // (x^2 - y^2)/(x + 2) * (x + 2)/(x - y) = x + y
+    const RationalFunction a(p("Expand[(x - y)*(x + y)]"), p("x + 2")), b(p("x + 2"), p("x - y"));
+    const auto product = a * b;
+    REQUIRE(product.is_reduced() == false);
+    REQUIRE(equal(product.numerator(), p("x + y")));
+    REQUIRE(equal(product.denominator(), p("1")));
+
+    // Reduced operands give a reduced product, with no full gcd taken
+    const auto x = RationalFunction(p("x")), y = RationalFunction(p("y"));
+    const auto quotient = (x / y) * (y / (x + y));
+    REQUIRE(quotient.is_reduced());
+    REQUIRE(equal(quotient.numerator(), p("x")));
+    REQUIRE(equal(quotient.denominator(), p("x + y")));
+    REQUIRE(equal(power(quotient, -2).numerator(), p("Expand[(x + y)^2]")));
+    REQUIRE(power(quotient, -2).is_reduced());
+
+    REQUIRE_THROWS_AS(RationalFunction(p("x"), p("0")), std::domain_error);
+    REQUIRE_THROWS_AS(x / RationalFunction(p("0")), std::domain_error);
+    REQUIRE_THROWS_AS(power(RationalFunction(p("0")), -1), std::domain_error);
+}
+
+TEST_CASE("Henrici sums defer the gcd with the common denominator part", "[algebra][ratfun]") {
+    const std::vector<std::string> x{ "x" };
+    const auto p = [&](const std::string& source) { return integer(source, x); };
+    const auto one = RationalFunction(p("1"));
+    // Coprime denominators: 1/x + 1/(x + 1) is reduced at once
+    const auto coprime = one / RationalFunction(p("x")) + one / RationalFunction(p("x + 1"));
+    REQUIRE(coprime.is_reduced());
+    REQUIRE(equal(coprime.numerator(), p("2*x + 1")));
+
+    // 1/(x - 1) - 2/(x^2 - 1) has g = x - 1 and cancels down to 1/(x + 1) only on normalize()
+    auto sum = one / RationalFunction(p("x - 1")) - RationalFunction(p("2")) / RationalFunction(p("x^2 - 1"));
+    REQUIRE_FALSE(sum.is_reduced());
+    REQUIRE(equal(sum.denominator(), p("x^2 - 1")));
+    sum.normalize();
+    REQUIRE(sum.is_reduced());
+    REQUIRE(equal(sum.numerator(), p("1")));
+    REQUIRE(equal(sum.denominator(), p("x + 1")));
+
+    // A long unreduced chain normalizes itself before it grows past the threshold
+    auto chain = one / RationalFunction(p("x - 1"));
+    for (int k = 0; k < 200; ++k) chain = chain + one / RationalFunction(p("x^2 - 1")) - one / RationalFunction(p("x^2 - 1"));
+    REQUIRE(chain.size() <= 2 * RATIONAL_NORMALIZE_TERMS);
+    chain.normalize();
+    REQUIRE(equal(chain.numerator(), p("1")));
+    REQUIRE(equal(chain.denominator(), p("x - 1")));
+}
+
+TEST_CASE("Together puts an expression over one reduced denominator", "[algebra][ratfun]") {
+    REQUIRE(run("Together[(x^2 - 1)/(x - 1) + 1/x]") == run("(1 + x + x^2)*(x)^-1"));
+    REQUIRE(run("Together[a/b + c/d]") == run("(b*c + a*d)*(b*d)^-1"));
+    REQUIRE(run("Together[1/(x - 1) - 1/(x + 1)]") == run("2*(-1 + x^2)^-1"));
+    REQUIRE(run("Together[x/2 + x/3]") == run("(5/6)*x"));
+    REQUIRE(run("Together[(x^2 - y^2)/(2*x - 2*y)]") == run("(1/2)*x + (1/2)*y"));
+    REQUIRE(run("Together[(x + 1)^-2*(x + 1)^3]") == run("1 + x"));
+    REQUIRE_THROWS(run("Together[Sin[x]/x]"));
+    REQUIRE_THROWS(run("Together[x^(1/2)]"));
+}
+
+TEST_CASE("Cancel reduces each term on its own", "[algebra][ratfun]") {
+    REQUIRE(run("Cancel[(x^2 - 1)/(x - 1)]") == run("1 + x"));
+    REQUIRE(run("Cancel[(x^2 - 1)/(x - 1) + 1/x]") == run("1 + x + x^-1"));
+    REQUIRE(run("Cancel[(x*y + y^2)/(x^2 - y^2)]") == run("y*(x - y)^-1"));
+}
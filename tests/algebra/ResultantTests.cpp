@@ -0,0 +1,106 @@
+#include "algebra/PolyUtils.hpp"
+#include "algebra/Resultant.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include "util/ThreadPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr input(const std::string& source) {
+        EvaluationContext ctx;
+        return evaluate(parse_expression(source), ctx);
+    }
+
+    std::string run(const std::string& source) {
+        return to_string(input(source));
+    }
+
+    IntegerPolynomial integer(const std::string& source, const std::vector<std::string>& variables) {
+        return expr_to_polynomial<IntegerRing>(input(source), variables);
+    }
+}
+
+TEST_CASE("Resultant eliminates a variable", "[algebra][resultant]") {
+    REQUIRE(run("Resultant[x^2 - 2, x - y, x]") == run("y^2 - 2"));
+    // A common root makes it vanish
+    REQUIRE(run("Resultant[x^2 - 1, x^2 + x - 2, x]") == "0");
+    REQUIRE(run("Resultant[x^2 + 1, x - 3, x]") == "10");
+    // Res(a, b) = (-1)^(deg a deg b) Res(b, a), and constants give powers of themselves
+    REQUIRE(run("Resultant[x - 3, x^2 + 1, x]") == "10");
+    REQUIRE(run("Resultant[x^3 - 2, x^3 + x, x]") == "10");
+    REQUIRE(run("Resultant[x^3 + x, x^3 - 2, x]") == "-10");
+    REQUIRE(run("Resultant[3, x^2 + 1, x]") == "9");
+    REQUIRE(run("Resultant[0, x^2 + 1, x]") == "0");
+    // Rational coefficients are scaled back
+    REQUIRE(run("Resultant[(1/2)*x - 1, x^2 - 3, x]") == "1/4");
+    // The intersection of two circles, projected on y
+    REQUIRE(run("Resultant[x^2 + y^2 - 1, (x - 1)^2 + y^2 - 1, x]") == run("4*y^2 - 3"));
+    REQUIRE(run("Subresultants[x^4 + y*x + 1, x^2 - y, x]") == run("{1 + 2*y^2 - y^3 + y^4, -y, 1}"));
+}
+
+TEST_CASE("Discriminant of the generic quadratic and cubic", "[algebra][resultant]") {
+    REQUIRE(run("Discriminant[a*x^2 + b*x + c, x]") == run("b^2 - 4*a*c"));
+    REQUIRE(run("Discriminant[x^3 + p*x + q, x]") == run("-4*p^3 - 27*q^2"));
+    REQUIRE(run("Discriminant[(x - 1)^2*(x + 2), x]") == "0");
+    REQUIRE(run("Discriminant[a*x + b, x]") == "1");
+}
+
+TEST_CASE("Subresultants detect the degree of the gcd", "[algebra][resultant]") {
+    REQUIRE(run("Subresultants[a*x^2 + b*x + c, 2*a*x + b, x]") == run("{-a*b^2 + 4*a^2*c, 2*a}"));
+    // gcd x - 1 of degree 1: psc_0 vanishes and psc_1 does not
+    const std::vector<std::string> x{ "x" };
+    const auto psc = principal_subresultants(integer("Expand[(x - 1)*(x + 2)*(x - 5)]", x), integer("Expand[(x - 1)*(x^2 + 3)]", x), 0);
+    REQUIRE(psc.size() == 4);
+    REQUIRE(psc[0].is_zero());
+    REQUIRE_FALSE(psc[1].is_zero());
+    REQUIRE(to_string(polynomial_to_expr(psc[3])) == "1");
+}
+
+TEST_CASE("Subresultant and modular resultants agree", "[algebra][resultant]") {
+    const std::vector<std::string> xy{ "x", "y" };
+    const auto a = integer("Expand[(3*x^2*y - 2*x + y^3 - 7)^3 + 5*x*y - 11]", xy);
+    const auto b = integer("Expand[(x^3 - 4*x*y^2 + 2*y + 9)^2 - 6*x^2 + 13*y]", xy);
+    const auto one_step = subresultant_resultant(a, b, 0);
+    REQUIRE(one_step.degree(0) == 0);
+    REQUIRE((modular_resultant(a, b, 0) - one_step).is_zero());
+
+    // Either way round, whichever variable, and on one thread
+    const auto in_y = subresultant_resultant(a, b, 1);
+    REQUIRE((modular_resultant(b, a, 1) - in_y).is_zero());
+    const size_t workers = ThreadPool::instance().concurrency() - 1;
+    ThreadPool::instance().resize(0);
+    REQUIRE((modular_resultant(a, b, 0) - one_step).is_zero());
+    ThreadPool::instance().resize(workers);
+
+    // Over Z/pZ the resultant is the image of the one over Z
+    const ModularField field(1000003);
+    const auto modular = [&](const IntegerPolynomial& p) {
+        std::vector<ModularPolynomial::Term> terms;
+        for (const auto& t : p.terms()) terms.push_back({ t.exponents, field.from_integer(t.coeff) });
+        return ModularPolynomial::from_terms(p.ring_ptr(), std::move(terms), field);
+    };
+    REQUIRE((resultant(modular(a), modular(b), 0) - modular(one_step)).is_zero());
+
+    // The psc_0 of the Sylvester determinant is the resultant too
+    const auto small_a = integer("2*x^3*y - x + y^2", xy), small_b = integer("x^2 - 3*y*x + 4", xy);
+    REQUIRE((principal_subresultants(small_a, small_b, 0).front() - subresultant_resultant(small_a, small_b, 0)).is_zero());
+}
+
+TEST_CASE("Large univariate resultants stay exact", "[algebra][resultant]") {
+    const std::vector<std::string> x{ "x" };
+    // Degrees past RESULTANT_MODULAR_DEGREE, whose resultant is known; Res(f, g) is the
+    // product of g over the roots of f, here g(k) for k = 1..20
+    auto f = integer("1", x);
+    for (int k = 1; k <= 20; ++k) f *= integer("x - " + std::to_string(k), x);
+    const auto g = integer("Expand[x^20 + 3]", x);
+    const auto res = resultant(f, g, 0);
+    BigInt expected = 1;
+    for (int k = 1; k <= 20; ++k) expected = expected * (pow(BigInt(k), 20) + BigInt(3));
+    REQUIRE(res.size() == 1);
+    REQUIRE(res.terms().front().coeff == expected);
+    REQUIRE((subresultant_resultant(f, g, 0) - res).is_zero());
+}
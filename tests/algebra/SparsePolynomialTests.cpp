@@ -0,0 +1,274 @@
+#include "algebra/SparsePolynomial.hpp"
+#include "algebra/PolyUtils.hpp"
+#include "parser/Parser.hpp"
+#include "util/ThreadPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    std::shared_ptr<const PolynomialRing> ring_of(std::vector<std::string> variables) {
+        return std::make_shared<const PolynomialRing>(std::move(variables));
+    }
+
+    // Gives the shared pool real workers for the scope, even on a single-core machine
+    struct PoolWorkers {
+        size_t previous = ThreadPool::instance().concurrency() - 1;
+        explicit PoolWorkers(size_t workers) { ThreadPool::instance().resize(workers); }
+        ~PoolWorkers() { ThreadPool::instance().resize(previous); }
+    };
+
+    template <class P>
+    bool same_terms(const P& a, const P& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t k = 0; k < a.size(); ++k) {
+            if (a.terms()[k].exponents != b.terms()[k].exponents || !(a.terms()[k].coeff == b.terms()[k].coeff)) return false;
+        }
+        return true;
+    }
+}
+
+TEST_CASE("Packed exponents order lexicographically", "[algebra][sparse]") {
+    PolynomialRing ring({ "x", "y", "z" });
+    const auto x2 = ring.pack({ 2, 0, 0 });
+    const auto xy5 = ring.pack({ 1, 5, 0 });
+    const auto z9 = ring.pack({ 0, 0, 9 });
+    REQUIRE(x2 > xy5);
+    REQUIRE(xy5 > z9);
+    REQUIRE(ring.exponent(xy5, 1) == 5);
+    REQUIRE(ring.total_degree(xy5) == 6);
+
+    const auto product = ring.multiply(xy5, z9);
+    REQUIRE(product == ring.pack({ 1, 5, 9 }));
+    REQUIRE_THROWS_AS(ring.multiply(ring.power_of(0, ring.max_exponent()), x2), std::overflow_error);
+    REQUIRE_THROWS_AS(PolynomialRing(std::vector<std::string>(PolynomialRing::MAX_VARIABLES + 1, "v")), std::invalid_argument);
+}
+
+TEST_CASE("Field widths shrink with the number of variables", "[algebra][sparse]") {
+    REQUIRE(PolynomialRing({ "x" }).max_exponent() == (1u << 31) - 1);
+    REQUIRE(PolynomialRing(std::vector<std::string>(8, "v")).max_exponent() == (1u << 15) - 1);
+    PolynomialRing wide(std::vector<std::string>(12, "v"));
+    REQUIRE(wide.max_exponent() == 127);
+    std::vector<uint32_t> exponents(12, 0);
+    exponents[11] = 127;
+    exponents[3] = 1;
+    const auto e = wide.pack(exponents);
+    REQUIRE(wide.exponent(e, 11) == 127);
+    REQUIRE(wide.exponent(e, 3) == 1);
+    REQUIRE(wide.exponent(e, 10) == 0);
+}
+
+TEST_CASE("Sparse polynomial arithmetic keeps terms sorted and combined", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y" });
+    auto x = SparsePolynomial::variable(ring, 0);
+    auto y = SparsePolynomial::variable(ring, 1);
+    auto one = SparsePolynomial::constant(ring, 1.0);
+
+    // (x + y) * (x - y) = x^2 - y^2
+    auto p = (x + y) * (x - y);
+    REQUIRE(p.size() == 2);
+    REQUIRE(p.coefficient(ring->pack({ 2, 0 })) == 1.0);
+    REQUIRE(p.coefficient(ring->pack({ 0, 2 })) == -1.0);
+    REQUIRE(p.coefficient(ring->pack({ 1, 1 })) == 0.0);
+    REQUIRE(p.terms().front().exponents > p.terms().back().exponents);
+
+    // (x + 1)^3 has 4 terms with binomial coefficients
+    auto q = (x + one) * (x + one) * (x + one);
+    REQUIRE(q.size() == 4);
+    REQUIRE(q.coefficient(ring->pack({ 2, 0 })) == 3.0);
+    REQUIRE(q.total_degree() == 3);
+    REQUIRE(q.degree(1) == 0);
+
+    REQUIRE((q - q).is_zero());
+    REQUIRE((q * 0.0).is_zero());
+    auto other = SparsePolynomial::variable(ring_of({ "y", "x" }), 0);
+    REQUIRE_THROWS_AS(x + other, std::invalid_argument);
+}
+
+TEST_CASE("In-place sums merge into the left operand", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y" });
+    auto x = IntegerPolynomial::variable(ring, 0);
+    auto y = IntegerPolynomial::variable(ring, 1);
+    auto one = IntegerPolynomial::constant(ring, BigInt(1));
+
+    auto p = x * x + one;
+    p += y;
+    p -= one;
+    REQUIRE(p.size() == 2);
+    REQUIRE(p.coefficient(ring->pack({ 2, 0 })) == 1);
+    REQUIRE(p.coefficient(ring->pack({ 0, 1 })) == 1);
+    p += p;
+    REQUIRE(p.coefficient(ring->pack({ 0, 1 })) == 2);
+
+    // x^2 y + 2 y^2 - (x^2 + 2 y) * y = 0, by a one-term addmul
+    auto q = x * x * y + y * y * BigInt(2);
+    q.addmul(x * x + y * BigInt(2), y * BigInt(-1));
+    REQUIRE(q.is_zero());
+    q.addmul(x + one, x - one);
+    REQUIRE(q.size() == 2);
+    q *= x;
+    REQUIRE(q.coefficient(ring->pack({ 3, 0 })) == 1);
+    REQUIRE(q.coefficient(ring->pack({ 1, 0 })) == -1);
+
+    // A k-way sum cancels across parts and drops the zeros at the end
+    auto total = IntegerPolynomial::sum(ring, { x, y, x * BigInt(-1), one, y * BigInt(2) });
+    REQUIRE(total.size() == 2);
+    REQUIRE(total.coefficient(ring->pack({ 0, 1 })) == 3);
+    REQUIRE(IntegerPolynomial::sum(ring, {}).is_zero());
+    REQUIRE_THROWS_AS(IntegerPolynomial::sum(ring, { x, IntegerPolynomial::variable(ring_of({ "z" }), 0) }), std::invalid_argument);
+}
+
+TEST_CASE("Powers expand by multinomials or repeated squaring", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y", "z" });
+    auto x = IntegerPolynomial::variable(ring, 0);
+    auto y = IntegerPolynomial::variable(ring, 1);
+    auto z = IntegerPolynomial::variable(ring, 2);
+    auto one = IntegerPolynomial::constant(ring, BigInt(1));
+
+    // (x + y + z)^30 has C(32, 2) terms, with the central coefficient 30! / (10!)^3
+    auto p = power(x + y + z, 30);
+    REQUIRE(p.size() == 496);
+    REQUIRE(p.coefficient(ring->pack({ 10, 10, 10 })) == BigInt(5550996791340));
+    REQUIRE(p.coefficient(ring->pack({ 30, 0, 0 })) == 1);
+
+    // A dense univariate base goes through squaring; both agree with repeated products
+    auto dense = one;
+    for (int k = 1; k <= 40; ++k) dense += power(x, k) * BigInt(k);
+    auto cube = power(dense, 3);
+    REQUIRE(cube.size() == 121);
+    auto expected = dense * dense * dense;
+    for (const auto& t : expected.terms()) REQUIRE(cube.coefficient(t.exponents) == t.coeff);
+    auto binomial = power(x - one, 7);
+    REQUIRE(binomial.coefficient(ring->pack({ 3, 0, 0 })) == 35);
+    REQUIRE(binomial.coefficient(Exponents{}) == -1);
+
+    REQUIRE(power(IntegerPolynomial(ring), 0).coefficient(Exponents{}) == 1);
+    REQUIRE(power(x * y, 5).coefficient(ring->pack({ 5, 5, 0 })) == 1);
+    REQUIRE_THROWS_AS(power(x, ring->max_exponent() + 1), std::overflow_error);
+
+    auto converted = expr_to_polynomial<IntegerRing>(parse_expression("(x + 2*y)^4 * z"), { "x", "y", "z" });
+    REQUIRE(converted.coefficient(ring->pack({ 2, 2, 1 })) == 24);
+}
+
+TEST_CASE("Expressions convert to and from sparse polynomials", "[algebra][sparse]") {
+    auto p = std::get<IntegerPolynomial>(expr_to_polynomial(parse_expression("(a + b) * (a + 2*b) * c"), { "a", "b", "c" }));
+    REQUIRE(p.size() == 3);
+    REQUIRE(p.coefficient(p.ring().pack({ 1, 1, 1 })) == 3);
+    REQUIRE(p.coefficient(p.ring().pack({ 0, 2, 1 })) == 2);
+
+    auto round_trip = expr_to_polynomial<IntegerRing>(polynomial_to_expr(p), { "a", "b", "c" });
+    REQUIRE(round_trip.size() == p.size());
+    for (const auto& t : p.terms()) REQUIRE(round_trip.coefficient(t.exponents) == t.coeff);
+
+    REQUIRE(to_polynomial(p).terms.size() == 3);
+    REQUIRE_THROWS(expr_to_polynomial(parse_expression("a + z"), { "a" }));
+
+    // The ring follows the input's numbers
+    auto third = make_fcall(atoms::Times, { make_expr<Rational>(BigInt(1), BigInt(3)), make_expr<Symbol>("a") });
+    auto exact = expr_to_polynomial(make_fcall(atoms::Plus, { third, make_expr<Number>(1.0) }), { "a" });
+    REQUIRE(std::get<RationalPolynomial>(exact).coefficient(Exponents{}) == Fraction{ 1, 1 });
+    auto inexact = expr_to_polynomial(make_fcall(atoms::Plus, { third, make_expr<Number>(0.5) }), { "a" });
+    REQUIRE(std::holds_alternative<SparsePolynomial>(inexact));
+    auto real = expr_to_polynomial<RealField>(parse_expression("2*a + 1"), { "a" });
+    REQUIRE(real.coefficient(real.ring().pack({ 1 })) == 2.0);
+}
+
+TEST_CASE("Heap and dense products agree with pairwise multiplication", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y", "z" });
+    std::vector<SparsePolynomial::Term> f_terms, g_terms;
+    for (uint32_t i = 0; i < 12; ++i) {
+        f_terms.push_back({ ring->pack({ i % 4, (i * 5) % 7, i / 3 }), 1.0 + i });
+        g_terms.push_back({ ring->pack({ (i * 3) % 5, i % 2, (i * 7) % 4 }), i % 3 == 0 ? -2.0 : 0.5 * i });
+    }
+    auto f = SparsePolynomial::from_terms(ring, f_terms);
+    auto g = SparsePolynomial::from_terms(ring, g_terms);
+
+    std::vector<SparsePolynomial::Term> pairs;
+    for (const auto& a : f.terms()) {
+        for (const auto& b : g.terms()) pairs.push_back({ ring->multiply(a.exponents, b.exponents), a.coeff * b.coeff });
+    }
+    auto expected = SparsePolynomial::from_terms(ring, pairs);
+
+    for (const auto& product : { multiply_heap(f, g), multiply_heap(g, f), multiply_dense(f, g), f * g }) {
+        REQUIRE(product.size() == expected.size());
+        for (size_t k = 0; k < expected.size(); ++k) {
+            REQUIRE(product.terms()[k].exponents == expected.terms()[k].exponents);
+            REQUIRE(product.terms()[k].coeff == Catch::Approx(expected.terms()[k].coeff));
+        }
+    }
+
+    // Cancellation leaves no zero terms
+    auto x = SparsePolynomial::variable(ring, 0);
+    auto y = SparsePolynomial::variable(ring, 1);
+    REQUIRE(multiply_heap(x + y, x - y).size() == 2);
+    REQUIRE(multiply_dense(x + y, x - y).size() == 2);
+
+    // Sparse factors of high degree go through the heap
+    auto sparse = SparsePolynomial::variable(ring, 0, 1000) + SparsePolynomial::variable(ring, 1, 1000);
+    REQUIRE_THROWS_AS(multiply_dense(sparse * sparse, SparsePolynomial::variable(ring, 2, 3000)), std::length_error);
+    REQUIRE((sparse * sparse).size() == 3);
+}
+
+TEST_CASE("Integer products add word-sized coefficients in wide sums", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y" });
+    const auto x = IntegerPolynomial::variable(ring, 0), y = IntegerPolynomial::variable(ring, 1);
+    const auto one = IntegerPolynomial::constant(ring, BigInt(1));
+    // Sums near 2^124 and of both signs, then factors too large for the wide sums
+    for (const BigInt& c : { pow(BigInt(2), 61) - BigInt(1), -pow(BigInt(2), 61), pow(BigInt(2), 80) }) {
+        const auto f = x * c + y * c + one, g = x * c - y * c + one * c;
+        std::vector<IntegerPolynomial::Term> pairs;
+        for (const auto& a : f.terms()) {
+            for (const auto& b : g.terms()) pairs.push_back({ ring->multiply(a.exponents, b.exponents), a.coeff * b.coeff });
+        }
+        const auto expected = IntegerPolynomial::from_terms(ring, pairs);
+        REQUIRE(same_terms(multiply_heap(f, g), expected));
+        REQUIRE(same_terms(multiply_dense(f, g), expected));
+        REQUIRE(expected.coefficient(ring->pack({ 1, 0 })) == c * c + c);
+    }
+}
+
+TEST_CASE("Large products split by monomial ranges across threads", "[algebra][sparse][parallel]") {
+    auto ring = ring_of({ "x", "y", "z", "t" });
+    auto sum = IntegerPolynomial::constant(ring, BigInt(1));
+    for (size_t v = 0; v < 4; ++v) sum += IntegerPolynomial::variable(ring, v);
+    // 1365 terms each: the product's box is small, so it takes the dense kernel
+    const auto f = power(sum, 11), g = f + IntegerPolynomial::constant(ring, BigInt(1));
+    REQUIRE(f.size() * g.size() >= PARALLEL_PAIRS);
+    // Widely spread exponents take the heap kernel
+    auto spread = IntegerPolynomial(ring);
+    for (uint32_t k = 0; k < 1300; ++k) {
+        spread += IntegerPolynomial::from_terms(ring, { { ring->pack({ k * 7919 % 1000, k * 104729 % 997, k % 31, k * 31 % 61 }), BigInt(int64_t(k % 13) - 6) } });
+    }
+    REQUIRE(spread.size() * spread.size() >= PARALLEL_PAIRS);
+
+    const auto serial_dense = f * g, serial_heap = spread * spread;
+    PoolWorkers workers(3);
+    REQUIRE(same_terms(f * g, serial_dense));
+    REQUIRE(same_terms(multiply_heap(spread, spread), serial_heap));
+    REQUIRE(same_terms(multiply_dense(f, g), serial_dense));
+}
+
+TEST_CASE("Heap division leaves a reduced remainder", "[algebra][sparse]") {
+    auto ring = ring_of({ "x", "y" });
+    const auto poly = [&](const std::string& s) { return expr_to_polynomial<RationalField>(parse_expression(s), { "x", "y" }); };
+
+    // x^2 y + x y^2 + y^2 = (x + y)(x y - 1) + x + y^2 + y
+    auto [q, r] = divide(poly("x^2*y + x*y^2 + y^2"), poly("x*y + -1"));
+    REQUIRE(same_terms(q, poly("x + y")));
+    REQUIRE(same_terms(r, poly("x + y^2 + y")));
+
+    // Exact division, and an integer one that stops at an indivisible coefficient
+    auto a = power(expr_to_polynomial<IntegerRing>(parse_expression("x + 2*y + 3"), { "x", "y" }), 6);
+    auto b = expr_to_polynomial<IntegerRing>(parse_expression("x*y + 5"), { "x", "y" });
+    auto [exact, zero] = divide(a * b, b);
+    REQUIRE(same_terms(exact, a));
+    REQUIRE(zero.is_zero());
+    auto [partial, rest] = divide(a * BigInt(3) + IntegerPolynomial::constant(a.ring_ptr(), BigInt(1)), a * BigInt(2), true);
+    REQUIRE(rest.size() == 1);
+    REQUIRE_THROWS_AS(divide(a, IntegerPolynomial(a.ring_ptr())), std::domain_error);
+}
@@ -0,0 +1,75 @@
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src, EvaluationContext& ctx) { return to_string(evaluate(parse_expression(src), ctx)); }
+
+    std::string eval(const std::string& src) {
+        EvaluationContext ctx;
+        return eval(src, ctx);
+    }
+
+    // Attributes are global; tests clear the ones they set
+    struct ClearedAttributes {
+        std::vector<Atom> names;
+        ~ClearedAttributes() {
+            for (Atom name : names) FunctionRegistry::instance().set_attributes(name, {});
+        }
+    };
+}
+
+TEST_CASE("Built-in heads report their attributes", "[attributes]") {
+    REQUIRE(eval("Attributes[Plus]") == "{Flat, Listable, NumericFunction, Orderless}");
+    REQUIRE(eval("Attributes[Sin]") == "{Listable, NumericFunction}");
+    REQUIRE(eval("Attributes[If]") == "{HoldRest}");
+    REQUIRE(eval("Attributes[Table]") == "{HoldAll}");
+    REQUIRE(eval("Attributes[attrNothing]") == "{}");
+    REQUIRE_THROWS(eval("SetAttributes[Plus, Listable]"));
+    REQUIRE_THROWS(eval("SetAttributes[attrNothing, Bogus]"));
+}
+
+TEST_CASE("Listable user functions thread over lists", "[attributes]") {
+    ClearedAttributes cleanup{ { Atom("attrSquare"), Atom("attrPair") } };
+    EvaluationContext ctx;
+    eval("attrSquare[x_] := x^2", ctx);
+    REQUIRE(eval("SetAttributes[attrSquare, Listable]", ctx) == "{Listable}");
+    REQUIRE(eval("attrSquare[{1, 2, 3}]", ctx) == "{1, 4, 9}");
+    REQUIRE(eval("attrSquare[Range[3]]", ctx) == "{1, 4, 9}");
+
+    eval("SetAttributes[attrPair, Listable]", ctx);
+    REQUIRE(eval("attrPair[{1, 2}, {a, b}]", ctx) == "{attrPair[1, a], attrPair[2, b]}");
+    REQUIRE(eval("attrPair[{1, 2}, c]", ctx) == "{attrPair[1, c], attrPair[2, c]}");
+    REQUIRE_THROWS(eval("attrPair[{1, 2}, {a}]", ctx));
+
+    REQUIRE(eval("ClearAttributes[attrSquare, Listable]", ctx) == "{}");
+    REQUIRE(eval("attrSquare[3]", ctx) == "9");
+}
+
+TEST_CASE("Flat and Orderless symbols are canonicalized", "[attributes]") {
+    ClearedAttributes cleanup{ { Atom("attrAc") } };
+    REQUIRE(eval("SetAttributes[attrAc, {Flat, Orderless}]") == "{Flat, Orderless}");
+    REQUIRE(eval("attrAc[c, b, attrAc[a, d]]") == "attrAc[a, b, c, d]");
+    REQUIRE(eval("attrAc[2, 1]") == eval("attrAc[1, 2]"));
+}
+
+TEST_CASE("Held arguments reach the definition unevaluated", "[attributes]") {
+    ClearedAttributes cleanup{ { Atom("attrLazy"), Atom("attrHoldAll") } };
+    EvaluationContext ctx;
+    // The second argument is only evaluated when the branch taken uses it
+    eval("attrLazy[x_, y_] := If[x > 0, x, y]", ctx);
+    eval("SetAttributes[attrLazy, HoldRest]", ctx);
+    eval("n = 0", ctx);
+    REQUIRE(eval("attrLazy[1, Set[n, 5]]", ctx) == "1");
+    REQUIRE(eval("n", ctx) == "0");
+    REQUIRE(eval("attrLazy[-1, Set[n, 5]]", ctx) == "5");
+
+    eval("attrHoldAll[x_] := x", ctx);
+    eval("SetAttributes[attrHoldAll, HoldAll]", ctx);
+    REQUIRE(eval("Attributes[attrHoldAll]", ctx) == "{HoldAll}");
+    REQUIRE(eval("attrHoldAll[1 + 2]", ctx) == "3");
+}
@@ -0,0 +1,107 @@
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/Budget.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src, EvaluationContext& ctx) { return to_string(evaluate(parse_expression(src), ctx)); }
+
+    BudgetLimit exceeded(const std::string& src, EvaluationContext& ctx) {
+        try {
+            eval(src, ctx);
+        }
+        catch (const BudgetExceeded& ex) {
+            return ex.limit;
+        }
+        FAIL("No limit was exceeded");
+        return BudgetLimit::Cancelled;
+    }
+}
+
+TEST_CASE("Runaway recursion stops at the depth limit", "[budget]") {
+    EvaluationContext ctx;
+    eval("f[n_] := f[n + 1]", ctx);
+    REQUIRE(exceeded("f[1]", ctx) == BudgetLimit::Depth);
+    // The depth unwinds with the error
+    REQUIRE(detail::budget.depth == 0);
+
+    eval("g[n_] := If[n == 0, 0, 1 + g[n - 1]]", ctx);
+    REQUIRE(eval("g[100]", ctx) == "100");
+
+    EvaluationBudget shallow;
+    shallow.depth = 50;
+    BudgetScope scope(shallow);
+    REQUIRE(exceeded("g[100]", ctx) == BudgetLimit::Depth);
+    REQUIRE(eval("g[3]", ctx) == "3");
+}
+
+TEST_CASE("Step limits count evaluate calls exactly", "[budget]") {
+    EvaluationContext ctx;
+    eval("g[n_] := If[n == 0, 0, 1 + g[n - 1]]", ctx);
+    const uint64_t before = detail::budget.steps;
+    eval("g[10]", ctx);
+    const uint64_t steps = detail::budget.steps - before;
+    REQUIRE(steps > 10);
+
+    EvaluationBudget enough;
+    enough.steps = steps;
+    {
+        BudgetScope scope(enough);
+        REQUIRE(eval("g[10]", ctx) == "10");
+    }
+    EvaluationBudget short_of = enough;
+    short_of.steps = steps - 1;
+    BudgetScope scope(short_of);
+    REQUIRE(exceeded("g[10]", ctx) == BudgetLimit::Steps);
+    // Exceeded limits stay exceeded while their scope is open
+    REQUIRE(exceeded("1 + 1", ctx) == BudgetLimit::Steps);
+}
+
+TEST_CASE("TimeConstrained and MemoryConstrained give up on their budget", "[budget]") {
+    EvaluationContext ctx;
+    REQUIRE(eval("Attributes[TimeConstrained]", ctx) == "{HoldAll}");
+    REQUIRE(eval("TimeConstrained[2 + 2, 10]", ctx) == "4");
+    REQUIRE(eval("TimeConstrained[Length[Table[Sin[k] + x, {k, 1, 100000000}]], 0.05]", ctx) == "$Aborted");
+    REQUIRE(eval("TimeConstrained[Length[Table[Sin[k] + x, {k, 1, 100000000}]], 0.05, failed]", ctx) == "failed");
+    // The failure value is only evaluated on failure
+    REQUIRE(eval("TimeConstrained[1, 10, Set[y, 2]]", ctx) == "1");
+    REQUIRE(eval("y", ctx) == "y");
+
+    REQUIRE(eval("MemoryConstrained[Length[Range[10]], 1000000]", ctx) == "10");
+    REQUIRE(eval("MemoryConstrained[Length[Table[k + x, {k, 1, 100000}]], 10000]", ctx) == "$Aborted");
+    REQUIRE(eval("MemoryConstrained[Expand[(1 + x + y + z)^40], 100000, big]", ctx) == "big");
+
+    // An enclosing limit is not caught by an inner one
+    EvaluationBudget outer;
+    outer.time = std::chrono::milliseconds(50);
+    BudgetScope scope(outer);
+    REQUIRE(exceeded("TimeConstrained[Length[Table[Sin[k] + x, {k, 1, 100000000}]], 100]", ctx) == BudgetLimit::Time);
+
+    REQUIRE_THROWS(eval("TimeConstrained[1]", ctx));
+    REQUIRE_THROWS(eval("MemoryConstrained[1, -5]", ctx));
+}
+
+TEST_CASE("A cancel token stops an evaluation from another thread", "[budget]") {
+    EvaluationContext ctx;
+    CancelToken token;
+    EvaluationBudget budget;
+    budget.cancel = token;
+    std::thread canceller([token] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+    });
+    {
+        BudgetScope scope(budget);
+        // Cancelling is not a limit TimeConstrained handles
+        REQUIRE(exceeded("TimeConstrained[Length[Table[Sin[k] + x, {k, 1, 100000000}]], 100]", ctx) == BudgetLimit::Cancelled);
+    }
+    canceller.join();
+    REQUIRE(token.cancelled());
+    REQUIRE(eval("1 + 2", ctx) == "3");
+}
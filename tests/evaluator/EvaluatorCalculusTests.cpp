@@ -0,0 +1,69 @@
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include "transforms/Derivative.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src) {
+        EvaluationContext ctx;
+        return to_string(evaluate(parse_expression(src), ctx));
+    }
+}
+
+TEST_CASE("D differentiates sums, products, powers and elementary functions", "[calculus]") {
+    REQUIRE(eval("D[x^2, x]") == "2 * x");
+    REQUIRE(eval("D[x^3 + 2*x + 1, x]") == eval("3 * x^2 + 2"));
+    REQUIRE(eval("D[Sin[x]*x, x]") == eval("x * Cos[x] + Sin[x]"));
+    REQUIRE(eval("D[Exp[2*x], x]") == eval("2 * Exp[2 * x]"));
+    REQUIRE(eval("D[Log[x], x]") == eval("x^-1"));
+    REQUIRE(eval("D[y, x]") == "0");
+    REQUIRE(eval("D[{x, x^2}, x]") == "{1, 2 * x}");
+}
+
+TEST_CASE("D of higher order", "[calculus]") {
+    REQUIRE(eval("D[x^3, {x, 2}]") == "6 * x");
+    REQUIRE(eval("D[x^3, {x, 0}]") == "x^3");
+    REQUIRE_THROWS(eval("D[x^3, {x, -1}]"));
+    REQUIRE_THROWS(eval("D[x^3, 2]"));
+}
+
+TEST_CASE("D keeps unknown functions unevaluated", "[calculus]") {
+    REQUIRE(eval("D[f[x], x]") == "D[f[x], x]");
+    REQUIRE(eval("D[f[y], x]") == "0");
+    REQUIRE(eval("D[x * f[x], x]") == eval("x * D[f[x], x] + f[x]"));
+}
+
+TEST_CASE("Grad gives every partial derivative", "[calculus]") {
+    REQUIRE(eval("Grad[x^2*y + Sin[y], {x, y}]") == eval("{2 * x * y, Cos[y] + x^2}"));
+    REQUIRE(eval("Grad[Sin[x*y], {x, y, z}]") == eval("{y * Cos[x * y], x * Cos[x * y], 0}"));
+    REQUIRE(eval("Grad[x, {x}]") == "{1}");
+    REQUIRE_THROWS(eval("Grad[x, x]"));
+}
+
+TEST_CASE("Derivatives of a shared DAG stay linear", "[calculus][dag]") {
+    // e[k + 1] = Sin[e[k]] * e[k], each level sharing e[k]: the tree doubles per level
+    constexpr int depth = 60;
+    ExprPtr e = make_expr<Symbol>("x");
+    double value = 0.5, slope = 1;
+    for (int k = 0; k < depth; ++k) {
+        e = make_fcall(atoms::Times, { make_fcall(atoms::Sin, { e }), e });
+        slope = (std::cos(value) * value + std::sin(value)) * slope;
+        value = std::sin(value) * value;
+    }
+
+    EvaluationContext ctx;
+    ctx.variables["x"] = make_number(0.5);
+    auto forward = std::get_if<Number>(evaluate(differentiate(e, Atom("x")), ctx).get());
+    REQUIRE(forward);
+    REQUIRE(std::abs(forward->value - slope) <= 1e-9 * std::abs(slope));
+
+    auto grad = evaluate(gradient(e, { Atom("x"), Atom("y") }), ctx);
+    auto reverse = std::get_if<Number>(std::get<List>(*unpack(grad)).elements[0].get());
+    REQUIRE(reverse);
+    REQUIRE(std::abs(reverse->value - slope) <= 1e-9 * std::abs(slope));
+}
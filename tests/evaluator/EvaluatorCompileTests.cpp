@@ -0,0 +1,88 @@
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/Compiler.hpp"
+#include "expr/Expr.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+
+    std::shared_ptr<const CompiledFunction> compile(const std::string& body, CompileMode mode) {
+        return compile_function({ Atom("x"), Atom("y") }, normalize_expr(parse_expression(body)), mode);
+    }
+}
+
+TEST_CASE("Compile evaluates numeric bodies as bytecode", "[evaluator][compile]") {
+    EvaluationContext ctx;
+    run("cf = Compile[{x, y}, Sin[x]*y + x/2]", ctx);
+    REQUIRE(get_number_value(run("cf[1, 2]", ctx)) == Catch::Approx(std::sin(1.0) * 2 + 0.5));
+    REQUIRE(get_number_value(run("cf[1/2, 2]", ctx)) == Catch::Approx(std::sin(0.5) * 2 + 0.25));
+    REQUIRE_THROWS(run("cf[1]", ctx));
+
+    run("g = Compile[{x}, If[x > 0, Sqrt[x], -x]]", ctx);
+    REQUIRE(get_number_value(run("g[4]", ctx)) == 2.0);
+    REQUIRE(get_number_value(run("g[-3]", ctx)) == 3.0);
+
+    run("b = Compile[{x}, (x > 2) && (x < 5)]", ctx);
+    REQUIRE(std::get<Boolean>(*run("b[3]", ctx)).value);
+    REQUIRE_FALSE(std::get<Boolean>(*run("b[6]", ctx)).value);
+
+    run("h = Compile[{z}, z*I + Pi]", ctx);
+    const auto& c = std::get<Complex>(*run("h[2]", ctx));
+    REQUIRE(c.real == Catch::Approx(3.141592653589793));
+    REQUIRE(c.imag == 2.0);
+}
+
+TEST_CASE("Compiled functions fall back to symbolic evaluation", "[evaluator][compile]") {
+    EvaluationContext ctx;
+    run("cf = Compile[{x, y}, Sin[x]*y]", ctx);
+    REQUIRE(to_string(run("cf[a, 2]", ctx)) == to_string(run("2*Sin[a]", ctx)));
+
+    // Out of the real domain, or non-finite: the evaluator decides
+    run("k = Compile[{x}, Log[x]]", ctx);
+    REQUIRE(to_string(run("k[0]", ctx)) == "Log[0]");
+    REQUIRE(to_string(run("k[-1]", ctx)) == "Log[-1]");
+    REQUIRE(get_number_value(run("k[1]", ctx)) == 0.0);
+
+    // A body that does not compile still works
+    run("u = Compile[{x}, x + StringLength[\"ab\"]]", ctx);
+    REQUIRE(get_number_value(run("u[1]", ctx)) == 3.0);
+}
+
+TEST_CASE("Programs and their raw entry point", "[evaluator][compile]") {
+    auto program = compile("x^2 + 3*x*y + 1", CompileMode::Machine);
+    REQUIRE(program);
+    const double args[] = { 2.0, 5.0 };
+    double result = 0.0;
+    REQUIRE(run_compiled(*program, args, result));
+    REQUIRE(result == 35.0);
+
+    REQUIRE_FALSE(compile("x + z", CompileMode::Machine)); // Free symbol
+    REQUIRE(compile("x*Pi", CompileMode::Machine));
+    REQUIRE_FALSE(compile("x*Pi", CompileMode::Definition)); // Pi stays exact in the evaluator
+    REQUIRE_FALSE(compile("x + 1/3", CompileMode::Definition)); // So do rationals
+    REQUIRE(compile("Sqrt[x] / y + x^-1", CompileMode::Definition));
+}
+
+TEST_CASE("Numeric user definitions run compiled", "[evaluator][compile]") {
+    EvaluationContext ctx;
+    run("f[x_] := x^2 + 3*x + Sin[x]", ctx);
+    REQUIRE(ctx.find_function("f")->compiled);
+    REQUIRE(get_number_value(run("f[2]", ctx)) == Catch::Approx(10 + std::sin(2.0)));
+    REQUIRE(to_string(run("f[y]", ctx)) == to_string(run("y^2 + 3*y + Sin[y]", ctx)));
+
+    // Exact results are left to the evaluator
+    run("q[x_] := x + 1/3", ctx);
+    REQUIRE_FALSE(ctx.find_function("q")->compiled);
+    REQUIRE(to_string(run("q[1]", ctx)) == to_string(run("1 + 1/3", ctx)));
+
+    // A later definition of a function the body uses takes effect
+    run("Sin[x_] := 100", ctx);
+    REQUIRE(get_number_value(run("f[2]", ctx)) == 110.0);
+}
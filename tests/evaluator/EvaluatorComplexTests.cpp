@@ -1,8 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include "parser/Parser.hpp"
 #include "evaluator/Evaluator.hpp"
 #include "expr/Expr.hpp"
 #include "evaluator/EvaluationContext.hpp"
+#include "evaluator/NumericTower.hpp"
+#include "expr/PackedArray.hpp"
+#include <cmath>
 
 using namespace aleph3;
 
@@ -71,4 +75,89 @@ TEST_CASE("Evaluator: Complex number arithmetic", "[evaluator][complex]") {
         CHECK(c.real == 13.0);
         CHECK(c.imag == -1.0);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Evaluator: Complex numeric tower", "[evaluator][complex]") {
+    EvaluationContext ctx;
+    auto complex = [&](const std::string& src) {
+        auto result = evaluate(parse_expression(src), ctx);
+        REQUIRE(std::holds_alternative<Complex>(*result));
+        return std::get<Complex>(*result);
+    };
+    auto number = [&](const std::string& src) {
+        auto result = evaluate(parse_expression(src), ctx);
+        REQUIRE(std::holds_alternative<Number>(*result));
+        return std::get<Number>(*result).value;
+    };
+
+    SECTION("Division and powers") {
+        auto q = complex("(1 + 2*I) / (3 - I)");
+        CHECK(q.real == Catch::Approx(0.1));
+        CHECK(q.imag == Catch::Approx(0.7));
+        auto p = complex("(1 + 2*I)^2");
+        CHECK(p.real == -3.0);
+        CHECK(p.imag == 4.0);
+        CHECK(number("(1 + I)^8") == 16.0); // Repeated squaring keeps Gaussian integers exact
+        auto r = complex("(1 + 2*I)^(1/2)");
+        CHECK(r.real * r.real - r.imag * r.imag == Catch::Approx(1.0));
+        auto s = complex("(-4)^0.5");
+        CHECK(s.real == 0.0);
+        CHECK(s.imag == 2.0);
+        auto h = complex("(1/2) * (1 + I)");
+        CHECK(h.real == 0.5);
+        CHECK(h.imag == 0.5);
+    }
+
+    SECTION("Elementary functions") {
+        CHECK(number("Abs[3 + 4*I]") == 5.0);
+        auto e = complex("Exp[1 + I]");
+        CHECK(e.real == Catch::Approx(std::exp(1.0) * std::cos(1.0)));
+        CHECK(e.imag == Catch::Approx(std::exp(1.0) * std::sin(1.0)));
+        auto l = complex("Log[Complex[-1, 0.5]]");
+        CHECK(l.imag == Catch::Approx(std::atan2(0.5, -1.0)));
+        auto sn = complex("Sin[1 + I]");
+        CHECK(sn.real == Catch::Approx(std::sin(1.0) * std::cosh(1.0)));
+    }
+
+    SECTION("Equality and exact results") {
+        CHECK(std::get<Boolean>(*evaluate(parse_expression("(1 + 2*I) == (1 + 2*I)"), ctx)).value);
+        CHECK(std::get<Boolean>(*evaluate(parse_expression("(1 + I) != 1"), ctx)).value);
+        CHECK(number("(1 + I) + (1 - I)") == 2.0);
+        // Division by an exact zero is left to the rules
+        CHECK(std::holds_alternative<FunctionCall>(*evaluate(parse_expression("(1 + I) / 0"), ctx)));
+    }
+}
+
+TEST_CASE("Numeric tower dispatches on the pair of operand types", "[evaluator][complex]") {
+    using kernels::Binary;
+    const ExprPtr two = make_expr<Number>(2.0);
+    const ExprPtr half = make_expr<Rational>(1, 2);
+    const ExprPtr i = make_expr<Complex>(0.0, 1.0);
+    const ExprPtr x = make_expr<Symbol>("x");
+    const ExprPtr packed = make_packed({ 3 }, std::vector<int64_t>{ 1, 2, 3 });
+
+    SECTION("Numeric pairs") {
+        CHECK(std::get<Number>(*numeric_binary(Binary::Minus, two, make_expr<Number>(0.5))).value == 1.5);
+        auto q = std::get<Rational>(*numeric_binary(Binary::Plus, half, two));
+        CHECK(q.numerator == 5);
+        CHECK(q.denominator == 2);
+        auto z = std::get<Complex>(*numeric_binary(Binary::Times, half, i));
+        CHECK(z.imag == 0.5);
+        CHECK_THROWS(numeric_binary(Binary::Divide, half, make_expr<Rational>(0, 1)));
+    }
+
+    SECTION("Packed arrays with scalars and arrays") {
+        auto sum = numeric_binary(Binary::Plus, packed, two);
+        REQUIRE(std::holds_alternative<PackedArray>(*sum));
+        CHECK(std::get<Number>(*packed_part(*std::get<PackedArray>(*sum).data, 2)).value == 5.0);
+        auto product = numeric_binary(Binary::Times, i, packed);
+        REQUIRE(std::holds_alternative<PackedArray>(*product));
+        CHECK(std::holds_alternative<PackedArray>(*numeric_binary(Binary::Minus, packed, packed)));
+    }
+
+    SECTION("Pairs without arithmetic are declined") {
+        CHECK(numeric_binary(Binary::Plus, x, two) == nullptr);
+        CHECK(numeric_binary(Binary::Times, two, x) == nullptr);
+        CHECK(numeric_binary(Binary::Plus, packed, x) == nullptr);
+        CHECK(numeric_binary(Atom("Log"), two, two) == nullptr);
+    }
+}
@@ -0,0 +1,39 @@
+#include "evaluator/ConstantFolding.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/FullForm.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace aleph3;
+
+namespace {
+    std::string folded(const std::string& src) { return to_fullform(optimize_expr(parse_expression(src))); }
+}
+
+TEST_CASE("Constant arithmetic folds to its value", "[evaluator][folding]") {
+    REQUIRE(folded("2*3 + 4") == "10");
+    EvaluationContext ctx;
+    REQUIRE(folded("2*3 + 4/2") == to_fullform(evaluate(parse_expression("2*3 + 4/2"), ctx)));
+    REQUIRE(folded("2/3 + 1/6") == "Rational[5, 6]");
+    REQUIRE(folded("x - 2*3") == "Plus[x, -6]");
+    REQUIRE(folded("-(1 + 2) * y") == "Times[-3, y]");
+    REQUIRE(folded("f[{1 + 1, 2^10}, a -> 3 - 4]") == "f[List[2, 1024], Rule[a, -1]]");
+
+    // What evaluation would not turn into a number is left alone
+    REQUIRE(folded("x + Divide[1, 0]") == to_fullform(normalize_expr(parse_expression("x + Divide[1, 0]"))));
+    REQUIRE(folded("Power[0, -1]") == "Power[0, -1]");
+    REQUIRE(folded("2^(1/2)") == to_fullform(evaluate(parse_expression("2^(1/2)"), ctx)));
+
+    // Without constants the tree is shared
+    auto expr = normalize_expr(parse_expression("f[x, Sin[y] + z]"));
+    REQUIRE(fold_constants(expr) == expr);
+}
+
+TEST_CASE("Definition bodies are folded once when stored", "[evaluator][folding]") {
+    EvaluationContext ctx;
+    evaluate(parse_expression("f[x_] := x * (2 + 3) - 2^2"), ctx);
+    REQUIRE(to_fullform(ctx.find_function("f")->body) == "Plus[Times[x, 5], -4]");
+    REQUIRE(get_number_value(evaluate(parse_expression("f[3]"), ctx)) == 11.0);
+    REQUIRE(to_string(evaluate(parse_expression("f[y]"), ctx)) ==
+            to_string(evaluate(parse_expression("y * (2 + 3) - 2^2"), ctx)));
+}
@@ -0,0 +1,41 @@
+#include "evaluator/Evaluator.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+
+using namespace aleph3;
+
+namespace {
+    // Sin[e] + Cos[e] nested `depth` times over x, each level sharing one node twice: a DAG
+    // of 3 * depth nodes that unfolds to a tree of about 2^depth
+    ExprPtr shared_tower(int depth) {
+        ExprPtr e = make_expr<Symbol>("x");
+        for (int i = 0; i < depth; ++i) {
+            e = make_fcall(atoms::Plus, { make_fcall(atoms::Sin, { e }), make_fcall(atoms::Cos, { e }) });
+        }
+        return e;
+    }
+}
+
+TEST_CASE("Shared subexpressions are evaluated once", "[dag]") {
+    EvaluationContext ctx;
+    ctx.variables["x"] = make_number(0.5);
+    double expected = 0.5;
+    for (int i = 0; i < 60; ++i) expected = std::sin(expected) + std::cos(expected);
+
+    // 2^60 evaluations if the sharing were not seen
+    auto result = evaluate(shared_tower(60), ctx);
+    auto n = std::get_if<Number>(result.get());
+    REQUIRE(n);
+    REQUIRE(std::abs(n->value - expected) < 1e-12);
+}
+
+TEST_CASE("Shared subexpressions keep their sharing through normalization", "[dag]") {
+    // x - y normalizes to Plus[x, Times[-1, y]]; both parents must get the same node
+    auto diff = make_fcall(atoms::Minus, { make_expr<Symbol>("x"), make_expr<Symbol>("y") });
+    auto norm = normalize_expr(make_fcall(Atom("f"), { diff, diff }));
+    const auto& args = std::get<FunctionCall>(*norm).args;
+    REQUIRE(args[0] == args[1]);
+    REQUIRE(std::get<FunctionCall>(*args[0]).head == atoms::Plus);
+}
@@ -1,5 +1,6 @@
 #include "parser/Parser.hpp"
 #include "evaluator/Evaluator.hpp"
+#include "evaluator/SpecialValues.hpp"
 #include "expr/Expr.hpp"
 #include "Constants.hpp"
 #include "evaluator/EvaluationContext.hpp"
@@ -416,6 +417,33 @@ void validate_evaluator_result(
     }
 }
 
+TEST_CASE("Special values are indexed by exact multiples of Pi", "[evaluator][functions][builtins]") {
+    auto multiple = [](const std::string& src) {
+        EvaluationContext ctx;
+        return rational_multiple(*evaluate(parse_expression(src), ctx));
+    };
+    auto m = multiple("-(3*Pi/2)");
+    REQUIRE(m);
+    REQUIRE(m->unit == atoms::Pi);
+    REQUIRE((m->p == -3 && m->q == 2));
+    m = multiple("(3/4)*Pi*2");
+    REQUIRE((m && m->unit == atoms::Pi && m->p == 3 && m->q == 2));
+    m = multiple("0*Pi");
+    REQUIRE((m && m->unit.empty() && m->p == 0));
+    REQUIRE_FALSE(multiple("Pi*Pi"));
+    REQUIRE_FALSE(multiple("x*Pi"));
+    REQUIRE_FALSE(multiple("0.5"));
+
+    // Periodic tables cover every congruent argument; machine numbers other than 0 skip them
+    REQUIRE_FALSE(special_value(atoms::Sin, make_expr<Number>(2.0)));
+    EvaluationContext ctx;
+    REQUIRE(get_number_value(evaluate(parse_expression("Sin[5*Pi/2]"), ctx)) == 1.0);
+    REQUIRE(get_number_value(evaluate(parse_expression("Cos[-7*Pi]"), ctx)) == -1.0);
+    REQUIRE(get_number_value(evaluate(parse_expression("Cot[(3/4)*Pi]"), ctx)) == -1.0);
+    REQUIRE(std::holds_alternative<Infinity>(*evaluate(parse_expression("Csc[3*Pi]"), ctx)));
+    REQUIRE(to_string(evaluate(parse_expression("Sinc[3*Pi]"), ctx)) == "Sinc[3 * Pi]");
+}
+
 TEST_CASE("Evaluator behaviour for nested function calls", "[evaluator][functions]") {
     struct TestCase {
         std::string expr_str;
@@ -445,4 +473,72 @@ TEST_CASE("Evaluator behaviour for nested function calls", "[evaluator][function
     for (const auto& tc : cases) {
         validate_evaluator_result(tc.expr_str, tc.expected);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("User-function calls run in a child scope", "[evaluator][functions]") {
+    EvaluationContext ctx;
+    ctx.variables["x"] = make_expr<Number>(100);
+    for (int i = 0; i < 300; ++i) {
+        ctx.variables["v" + std::to_string(i)] = make_expr<Number>(i);
+    }
+    evaluate(parse_expression("g[x_] := x + v7"), ctx);
+
+    SECTION("Parameters shadow outer bindings without touching them") {
+        auto result = evaluate(parse_expression("g[1]"), ctx);
+        REQUIRE(get_number_value(result) == 8.0);
+        REQUIRE(get_number_value(ctx.variables["x"]) == 100.0);
+        REQUIRE(ctx.variables.size() == 301);
+    }
+
+    SECTION("Nested frames fall through to the outermost scope") {
+        EvaluationContext inner(&ctx);
+        inner.variables["v7"] = make_expr<Number>(-7);
+        REQUIRE(get_number_value(evaluate(parse_expression("g[1]"), inner)) == -6.0);
+        REQUIRE(get_number_value(evaluate(parse_expression("v8"), inner)) == 8.0);
+        REQUIRE(inner.find_function("g") == ctx.find_function("g"));
+        REQUIRE(inner.find_variable("missing") == nullptr);
+    }
+
+    SECTION("Recursive calls see the enclosing definitions") {
+        evaluate(parse_expression("fact[n_] := If[n == 0, 1, n * fact[n - 1]]"), ctx);
+        REQUIRE(get_number_value(evaluate(parse_expression("fact[10]"), ctx)) == 3628800.0);
+    }
+}
+
+TEST_CASE("FunctionRegistry hands out stable handles cached on call nodes", "[evaluator][functions]") {
+    auto& registry = FunctionRegistry::instance();
+    EvaluationContext ctx;
+
+    auto call = parse_expression("RegistryProbe[1]");
+    const auto& node = std::get<FunctionCall>(*call);
+    REQUIRE(registry.resolve(node) == NO_FUNCTION);
+
+    // Registering a new head must invalidate the cached miss
+    FunctionHandle handle = registry.register_function("RegistryProbe", [](const FunctionCall&, EvaluationContext&) {
+        return make_expr<Number>(1.0);
+    });
+    REQUIRE(handle != NO_FUNCTION);
+    REQUIRE(registry.resolve(node) == handle);
+    REQUIRE(get_number_value(evaluate(call, ctx)) == 1.0);
+
+    // Replacing the handler keeps the handle, so cached nodes pick up the new one
+    REQUIRE(registry.register_function("RegistryProbe", [](const FunctionCall&, EvaluationContext&) {
+        return make_expr<Number>(2.0);
+    }) == handle);
+    REQUIRE(get_number_value(evaluate(call, ctx)) == 2.0);
+}
+
+TEST_CASE("A handler may register functions while it runs", "[evaluator][functions]") {
+    FunctionRegistry registry;
+    EvaluationContext ctx;
+    ctx.registry = &registry;
+    const double answer = 7.0;
+    registry.register_function("Grow", [&registry, answer](const FunctionCall&, EvaluationContext&) {
+        for (int i = 0; i < 1000; ++i) {
+            registry.register_function("Grown" + std::to_string(i), [](const FunctionCall&, EvaluationContext&) { return make_expr<Number>(0); });
+        }
+        // Reads this handler's own captures after the registrations
+        return make_expr<Number>(answer);
+    });
+    REQUIRE(get_number_value(evaluate(parse_expression("Grow[]"), ctx)) == 7.0);
+    REQUIRE(registry.has_function("Grown999"));
+}
@@ -0,0 +1,84 @@
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/ResultCache.hpp"
+#include "expr/Expr.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+}
+
+TEST_CASE("Specific values take precedence over the pattern definition", "[evaluator][memo]") {
+    EvaluationContext ctx;
+    run("f[0] = 100", ctx);
+    run("f[n_] := n + 1", ctx);
+
+    REQUIRE(get_number_value(run("f[0]", ctx)) == 100.0);
+    REQUIRE(get_number_value(run("f[4]", ctx)) == 5.0);
+
+    // Unrelated changes keep explicit values
+    run("x = 3", ctx);
+    REQUIRE(get_number_value(run("f[0]", ctx)) == 100.0);
+
+    SECTION("Specific values without a pattern definition") {
+        run("g[1] = 7", ctx);
+        REQUIRE(get_number_value(run("g[1]", ctx)) == 7.0);
+        REQUIRE(to_string(run("g[2]", ctx)) == "g[2]");
+    }
+}
+
+TEST_CASE("Memo definitions make recursion linear", "[evaluator][memo]") {
+    EvaluationContext ctx;
+    run("fib[0] = 0", ctx);
+    run("fib[1] = 1", ctx);
+    run("fib[n_] := fib[n] = fib[n - 1] + fib[n - 2]", ctx);
+
+    REQUIRE(get_number_value(run("fib[60]", ctx)) == 1548008755920.0);
+
+    auto stats = ctx.user_functions["fib"].downvalues->stats();
+    REQUIRE(stats.entries == 61);
+    REQUIRE(stats.hits > 0);
+    // Without memoization fib[60] would need ~10^12 calls
+    REQUIRE(stats.misses < 200);
+
+    SECTION("Memo entries are dropped when the scope changes") {
+        run("k = 1", ctx);
+        REQUIRE(get_number_value(run("fib[10]", ctx)) == 55.0);
+        REQUIRE(ctx.user_functions["fib"].downvalues->stats().entries == 11);
+    }
+}
+
+TEST_CASE("Result cache serves repeated pure built-in calls", "[evaluator][memo]") {
+    auto& cache = ResultCache::instance();
+    cache.clear();
+    cache.set_capacity(2);
+    EvaluationContext ctx;
+
+    auto first = run("Expand[(a + b)*(a + c)]", ctx);
+    auto second = run("Expand[(a + b)*(a + c)]", ctx);
+    REQUIRE(second == first);
+    REQUIRE(cache.stats().hits == 1);
+    REQUIRE(cache.stats().misses == 1);
+
+    SECTION("Entries are evicted least recently used first") {
+        run("Expand[(a + c)*(b + c)]", ctx);
+        run("Expand[(a + d)*(b + d)]", ctx);
+        REQUIRE(cache.stats().entries == 2);
+        run("Expand[(a + b)*(a + c)]", ctx);
+        REQUIRE(cache.stats().hits == 1);
+    }
+
+    SECTION("A change of bindings invalidates cached results") {
+        ctx.variables["a"] = make_expr<Number>(1.0);
+        auto rebound = run("Expand[(a + b)*(a + c)]", ctx);
+        REQUIRE(rebound != first);
+        REQUIRE(cache.stats().hits == 1);
+    }
+
+    cache.set_capacity(0);
+    cache.clear();
+}
@@ -0,0 +1,70 @@
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/NumericEval.hpp"
+#include "expr/Expr.hpp"
+#include "Constants.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <cmath>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+
+    ExprPtr direct(const std::string& src, const EvaluationContext& ctx) {
+        return numeric_value(normalize_expr(parse_expression(src)), ctx);
+    }
+}
+
+TEST_CASE("N computes formulas over bound variables directly", "[evaluator][numeric]") {
+    EvaluationContext ctx;
+    run("x = 2", ctx);
+    run("y = 1/4", ctx);
+    REQUIRE(get_number_value(run("N[x^2 + Sin[y]*Pi - x/3]", ctx)) ==
+        Catch::Approx(4 + std::sin(0.25) * PI - 2.0 / 3));
+    REQUIRE(get_number_value(run("N[2*Pi*x*Degree]", ctx)) == Catch::Approx(4 * PI * PI / 180));
+    REQUIRE(std::get<Boolean>(*run("N[x > y]", ctx)).value);
+
+    const auto& c = std::get<Complex>(*run("N[x*I + E]", ctx));
+    REQUIRE(c.real == Catch::Approx(E));
+    REQUIRE(c.imag == 2.0);
+
+    // Rebinding reuses the cached program
+    for (int i = 1; i <= 5; ++i) {
+        ctx.variables[Atom("x")] = make_expr<Number>(i);
+        REQUIRE(get_number_value(run("N[x^2 + Sin[y]*Pi - x/3]", ctx)) ==
+            Catch::Approx(i * i + std::sin(0.25) * PI - i / 3.0));
+    }
+}
+
+TEST_CASE("N falls back to exact evaluation", "[evaluator][numeric]") {
+    EvaluationContext ctx;
+    run("x = 1", ctx);
+    REQUIRE(direct("x^2 + 1", ctx));
+
+    // Special values of exact constants stay exact
+    REQUIRE_FALSE(direct("Sin[Pi*x]", ctx));
+    REQUIRE(get_number_value(run("N[Sin[Pi*x]]", ctx)) == 0.0);
+    REQUIRE_FALSE(direct("Cot[Pi/4]", ctx)); // Nothing to bind: evaluated exactly
+    REQUIRE(get_number_value(run("N[Cot[Pi/4]]", ctx)) == 1.0);
+
+    // Unbound and non-numeric variables
+    REQUIRE_FALSE(direct("x + z", ctx));
+    REQUIRE(to_string(run("N[x + z]", ctx)) == to_string(run("1 + z", ctx)));
+    run("w = {1, 2}", ctx);
+    REQUIRE_FALSE(direct("x + w", ctx));
+    REQUIRE(to_string(run("N[x + w]", ctx)) == to_string(run("{2, 3}", ctx)));
+
+    // Out of the real domain
+    run("n = -1", ctx);
+    REQUIRE_FALSE(direct("Log[n]", ctx));
+
+    // A user definition of a function the formula uses takes effect
+    REQUIRE(direct("Sin[x] + x", ctx));
+    run("Sin[u_] := 100", ctx);
+    REQUIRE_FALSE(direct("Sin[x] + x", ctx));
+    REQUIRE(get_number_value(run("N[Sin[x] + x]", ctx)) == 101.0);
+}
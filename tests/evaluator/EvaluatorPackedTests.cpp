@@ -0,0 +1,194 @@
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/Expr.hpp"
+#include "expr/PackedArray.hpp"
+#include "expr/LazyList.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+
+    std::shared_ptr<const PackedData> packed(const ExprPtr& e) {
+        REQUIRE(std::holds_alternative<PackedArray>(*e));
+        return std::get<PackedArray>(*e).data;
+    }
+}
+
+TEST_CASE("Range produces packed integer arrays", "[evaluator][packed]") {
+    EvaluationContext ctx;
+    auto r = packed(run("Range[1000]", ctx));
+    REQUIRE(r->type() == PackedData::Type::Integer);
+    REQUIRE(r->shape == std::vector<size_t>{ 1000 });
+    REQUIRE(std::get<std::vector<int64_t>>(r->values)[999] == 1000);
+    REQUIRE(get_number_value(run("Length[Range[1000]]", ctx)) == 1000.0);
+
+    REQUIRE(to_string(run("Range[3]", ctx)) == "{1, 2, 3}");
+    REQUIRE(to_string(run("Range[2, 8, 3]", ctx)) == "{2, 5, 8}");
+    REQUIRE(packed(run("Range[0, 1, 0.25]", ctx))->type() == PackedData::Type::Real);
+    REQUIRE(to_string(run("Range[n]", ctx)) == "Range[n]");
+}
+
+TEST_CASE("Arithmetic on packed arrays stays packed", "[evaluator][packed]") {
+    EvaluationContext ctx;
+
+    auto sum = packed(run("Range[1000] + Range[1000]", ctx));
+    REQUIRE(sum->type() == PackedData::Type::Integer);
+    REQUIRE(std::get<std::vector<int64_t>>(sum->values)[499] == 1000);
+
+    auto scaled = packed(run("2.5 * Range[300]", ctx));
+    REQUIRE(scaled->type() == PackedData::Type::Real);
+    REQUIRE(std::get<std::vector<double>>(scaled->values)[1] == 5.0);
+
+    auto quotient = packed(run("Range[300] / 2", ctx));
+    REQUIRE(quotient->type() == PackedData::Type::Real);
+    REQUIRE(std::get<std::vector<double>>(quotient->values)[0] == 0.5);
+
+    auto real = packed(run("N[Range[300]]", ctx));
+    REQUIRE(real->type() == PackedData::Type::Real);
+
+    // A mismatched shape is not a packed operation
+    REQUIRE_THROWS(run("Range[300] + Range[301]", ctx));
+}
+
+TEST_CASE("Long numeric lists pack, short ones stay lists", "[evaluator][packed]") {
+    EvaluationContext ctx;
+    REQUIRE(std::holds_alternative<List>(*run("{1, 2, 3}", ctx)));
+    REQUIRE(std::holds_alternative<List>(*run("{1, 2} + {3, 4}", ctx)));
+
+    std::string src = "{";
+    for (int i = 0; i < 300; ++i) src += (i ? ", " : "") + std::to_string(i);
+    src += "}";
+    auto list = run(src, ctx);
+    REQUIRE(packed(list)->type() == PackedData::Type::Integer);
+
+    auto unpacked = unpack(list);
+    REQUIRE(std::holds_alternative<List>(*unpacked));
+    REQUIRE(std::get<List>(*unpacked).elements.size() == 300);
+    REQUIRE(to_string(unpacked) == to_string(list));
+}
+
+TEST_CASE("Table builds packed arrays from numeric values", "[evaluator][packed]") {
+    EvaluationContext ctx;
+    auto squares = packed(run("Table[i^2, {i, 1, 300}]", ctx));
+    REQUIRE(std::get<std::vector<int64_t>>(squares->values)[299] == 90000);
+
+    auto grid = packed(run("Table[i + j, {i, 20}, {j, 20}]", ctx));
+    REQUIRE(grid->shape == std::vector<size_t>{ 20, 20 });
+
+    REQUIRE(to_string(run("Table[x^i, {i, 3}]", ctx)) == "{x, x^2, x^3}");
+    REQUIRE(to_string(run("Table[i, {i, {5, 7}}]", ctx)) == "{5, 7}");
+}
+
+TEST_CASE("Vector kernels agree with <cmath>", "[evaluator][packed][kernels]") {
+    using kernels::Unary;
+    std::vector<double> x;
+    for (int i = -2000; i <= 2000; ++i) x.push_back(i * 0.37);
+    x.push_back(3.0e6); // Outside the reduced range of the trig kernels
+    std::vector<double> out(x.size());
+
+    auto check = [&](Unary f, double (*ref)(double), const std::vector<double>& in) {
+        kernels::apply_unary(f, in.data(), out.data(), in.size());
+        for (size_t i = 0; i < in.size(); ++i) {
+            const double expected = ref(in[i]);
+            REQUIRE((out[i] == expected || std::abs(out[i] - expected) <= 1e-15 * std::max(1.0, std::abs(expected))));
+        }
+    };
+    check(Unary::Sin, [](double v) { return std::sin(v); }, x);
+    check(Unary::Cos, [](double v) { return std::cos(v); }, x);
+    check(Unary::Exp, [](double v) { return std::exp(v); }, x);
+
+    std::vector<double> positive;
+    for (int i = 1; i <= 4000; ++i) positive.push_back(i * 0.013);
+    positive.push_back(1.0e-310); // Subnormal: recomputed with std::log
+    check(Unary::Log, [](double v) { return std::log(v); }, positive);
+
+    std::vector<uint8_t> mask(3);
+    const double values[] = { 4.0, -1.0, 0.0 };
+    REQUIRE(kernels::domain_mask(Unary::Sqrt, values, mask.data(), 3) == 2);
+    REQUIRE(mask == std::vector<uint8_t>{ 1, 0, 1 });
+}
+
+TEST_CASE("Listable functions thread over lists and packed arrays", "[evaluator][packed]") {
+    EvaluationContext ctx;
+    REQUIRE(to_string(run("Sin[{0, x}]", ctx)) == "{0, Sin[x]}");
+    REQUIRE(to_string(run("Sqrt[{4, -1}]", ctx)) == "{2, Sqrt[-1]}");
+    REQUIRE(to_string(run("Log[{0, 1}]", ctx)) == "{Log[0], 0}");
+
+    auto sines = packed(run("Sin[Range[1000]]", ctx));
+    REQUIRE(sines->type() == PackedData::Type::Real);
+    REQUIRE(std::abs(std::get<std::vector<double>>(sines->values)[9] - std::sin(10.0)) < 1e-15);
+
+    // Out-of-domain entries take the symbolic path and the result unpacks
+    auto roots = run("Sqrt[Range[300] - 2]", ctx);
+    REQUIRE(std::holds_alternative<List>(*roots));
+    REQUIRE(to_string(std::get<List>(*roots).elements[0]) == "Sqrt[-1]");
+    REQUIRE(get_number_value(std::get<List>(*roots).elements[2]) == 1.0);
+}
+
+TEST_CASE("Complex packed arrays run on interleaved buffers", "[evaluator][packed][complex]") {
+    EvaluationContext ctx;
+    auto z = packed(run("Range[300] * (1 + I)", ctx));
+    REQUIRE(z->type() == PackedData::Type::Complex);
+    REQUIRE(packed_value(*z, 2) == std::complex<double>(3.0, 3.0));
+
+    auto product = packed(run("(Range[300] * (1 + I)) * (Range[300] * (2 - I))", ctx));
+    REQUIRE(packed_value(*product, 0) == std::complex<double>(3.0, 1.0));
+    auto quotient = packed(run("(Range[300] * (1 + I)) / (1 - I)", ctx));
+    REQUIRE(std::abs(packed_value(*quotient, 1) - std::complex<double>(0.0, 2.0)) < 1e-15);
+
+    auto magnitudes = packed(run("Abs[Range[300] * (3 + 4*I)]", ctx));
+    REQUIRE(magnitudes->type() == PackedData::Type::Real);
+    REQUIRE(std::get<std::vector<double>>(magnitudes->values)[1] == 10.0);
+    auto exps = packed(run("Exp[Range[300] * I]", ctx));
+    REQUIRE(std::abs(packed_value(*exps, 0) - std::exp(std::complex<double>(0.0, 1.0))) < 1e-15);
+
+    // Kernels: overflowing quotients are redone with std::complex
+    const std::complex<double> a[] = { { 1e300, 1e300 }, { 1.0, 2.0 } };
+    const std::complex<double> b[] = { { 1e300, -1e300 }, { 3.0, -1.0 } };
+    std::complex<double> out[2];
+    kernels::apply_binary(kernels::Binary::Divide, a, b, out, 2);
+    REQUIRE(std::abs(out[0] - std::complex<double>(0.0, 1.0)) < 1e-15);
+    REQUIRE(std::abs(out[1] - std::complex<double>(0.1, 0.7)) < 1e-15);
+}
+
+TEST_CASE("Long ranges stay lazy through reductions", "[evaluator][packed][lazy]") {
+    EvaluationContext ctx;
+    run("r = Range[10^9]", ctx);
+    REQUIRE(std::holds_alternative<LazyList>(*run("r", ctx)));
+    REQUIRE(get_number_value(run("Length[r]", ctx)) == 1.0e9);
+    REQUIRE(get_number_value(run("Total[r]", ctx)) == 500000000500000000.0);
+    REQUIRE(get_number_value(run("Max[r]", ctx)) == 1.0e9);
+    REQUIRE(get_number_value(run("Min[Range[5, 10^8, 3]]", ctx)) == 5.0);
+    REQUIRE(get_number_value(run("Part[r, -1]", ctx)) == 1.0e9);
+
+    // Affine maps stay lazy; printing and other arithmetic materialize a packed array
+    REQUIRE(std::holds_alternative<LazyList>(*run("2*r + 1", ctx)));
+    REQUIRE(get_number_value(run("Part[2*r + 1, 3]", ctx)) == 7.0);
+    auto lazy = make_expr<LazyList>(1.0, 2.0, size_t{4}, true);
+    REQUIRE(to_string(lazy) == "{1, 3, 5, 7}");
+    REQUIRE(packed(materialize(lazy))->type() == PackedData::Type::Integer);
+}
+
+TEST_CASE("Reductions stream through Map, Select and Table", "[evaluator][packed][lazy]") {
+    EvaluationContext ctx;
+    run("f[x_] := x^2", ctx);
+    run("small[x_] := x < 50", ctx);
+    REQUIRE(get_number_value(run("Length[Select[Map[f, Range[100]], small]]", ctx)) == 7.0);
+    REQUIRE(get_number_value(run("Total[Map[f, Range[100]]]", ctx)) == 338350.0);
+    REQUIRE(get_number_value(run("Total[Table[i, {i, 1, 10^4}]]", ctx)) == 50005000.0);
+    REQUIRE(get_number_value(run("Length[Table[i, {i, 2, 20, 2}]]", ctx)) == 10.0);
+    REQUIRE(get_number_value(run("Sum[i, {i, Range[10]}]", ctx)) == 55.0);
+    REQUIRE(to_string(run("Select[Range[10], small]", ctx)) == "{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}");
+    REQUIRE(to_string(run("Select[Map[f, Range[10]], small]", ctx)) == "{1, 4, 9, 16, 25, 36, 49}");
+
+    REQUIRE(to_string(run("Total[{1/2, 1/3, x}]", ctx)) == "5/6 + x");
+    REQUIRE(get_number_value(run("Max[3, {1, 7}, 2.5]", ctx)) == 7.0);
+    REQUIRE(to_string(run("Min[x, 3, 1]", ctx)) == "Min[1, x]");
+    REQUIRE(to_string(run("Part[g[a, b], 0]", ctx)) == "g");
+    REQUIRE_THROWS(run("Length[x]", ctx));
+}
@@ -0,0 +1,61 @@
+#include "parser/Parser.hpp"
+#include "evaluator/Evaluator.hpp"
+#include "expr/Expr.hpp"
+#include "util/ThreadPool.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <thread>
+
+using namespace aleph3;
+
+namespace {
+    ExprPtr run(const std::string& src, EvaluationContext& ctx) {
+        return evaluate(parse_expression(src), ctx);
+    }
+
+    // Gives the shared pool real workers for the scope, even on a single-core machine
+    struct PoolWorkers {
+        size_t previous = ThreadPool::instance().concurrency() - 1;
+        explicit PoolWorkers(size_t workers) { ThreadPool::instance().resize(workers); }
+        ~PoolWorkers() { ThreadPool::instance().resize(previous); }
+    };
+}
+
+TEST_CASE("Sum and Map", "[evaluator][parallel]") {
+    EvaluationContext ctx;
+    REQUIRE(get_number_value(run("Sum[i, {i, 1, 100}]", ctx)) == 5050.0);
+    REQUIRE(get_number_value(run("Sum[i*j, {i, 3}, {j, 2}]", ctx)) == 18.0);
+    REQUIRE(get_number_value(run("Sum[i, {i, 1, 0}]", ctx)) == 0.0);
+    REQUIRE(to_string(run("Sum[x^i, {i, 0, 2}]", ctx)) == to_string(run("1 + x + x^2", ctx)));
+
+    run("f[x_] := x^2", ctx);
+    REQUIRE(to_string(run("Map[f, {1, 2, 3}]", ctx)) == "{1, 4, 9}");
+    REQUIRE(to_string(run("Map[f, {a, b}]", ctx)) == to_string(run("{a^2, b^2}", ctx)));
+    REQUIRE(get_number_value(run("Length[Map[f, Range[1000]]]", ctx)) == 1000.0);
+    REQUIRE(to_string(run("Map[f, 3]", ctx)) == "3");
+    REQUIRE_THROWS(run("Map[f]", ctx));
+}
+
+TEST_CASE("Parallel forms agree with the serial ones", "[evaluator][parallel]") {
+    PoolWorkers workers(3);
+    EvaluationContext ctx;
+    run("f[x_] := Sin[x] + x^2", ctx);
+    run("g[x_] := x + 1", ctx);
+
+    REQUIRE(to_string(run("ParallelTable[f[i], {i, 0, 2000}]", ctx)) == to_string(run("Table[f[i], {i, 0, 2000}]", ctx)));
+    REQUIRE(to_string(run("ParallelTable[i + j, {i, 3}, {j, 4}]", ctx)) == to_string(run("Table[i + j, {i, 3}, {j, 4}]", ctx)));
+    REQUIRE(to_string(run("ParallelTable[{i, x}, {i, 2}]", ctx)) == to_string(run("{{1, x}, {2, x}}", ctx)));
+    REQUIRE(to_string(run("ParallelTable[i, {i, 3}, {j, 0}]", ctx)) == "{{}, {}, {}}");
+
+    // Same chunks, same order of additions: bitwise identical
+    REQUIRE(get_number_value(run("ParallelSum[f[i/7], {i, 1, 100000}]", ctx)) ==
+        get_number_value(run("Sum[f[i/7], {i, 1, 100000}]", ctx)));
+    REQUIRE(to_string(run("ParallelSum[g[i] * y, {i, 2}]", ctx)) == to_string(run("Sum[g[i] * y, {i, 2}]", ctx)));
+
+    REQUIRE(to_string(run("ParallelMap[g, Range[3000]]", ctx)) == to_string(run("Map[g, Range[3000]]", ctx)));
+
+    // Errors in a worker reach the caller; bindings made by the body stay in its frame
+    REQUIRE_THROWS(run("ParallelTable[StringLength[i], {i, 1000}]", ctx));
+    run("ParallelTable[Set[t, i], {i, 1000}]", ctx);
+    REQUIRE(to_string(run("t", ctx)) == "t");
+}
@@ -0,0 +1,98 @@
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/Patterns.hpp"
+#include "expr/FullForm.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src, EvaluationContext& ctx) { return to_string(evaluate(parse_expression(src), ctx)); }
+
+    std::string eval(const std::string& src) {
+        EvaluationContext ctx;
+        return eval(src, ctx);
+    }
+}
+
+TEST_CASE("Replacement operators parse to calls", "[patterns][parser]") {
+    REQUIRE(to_fullform(parse_expression("x /. a -> b /. c -> d")) == "ReplaceAll[ReplaceAll[x, Rule[a, b]], Rule[c, d]]");
+    REQUIRE(to_fullform(parse_expression("x //. {a -> b}")) == "ReplaceRepeated[x, List[Rule[a, b]]]");
+    REQUIRE(to_fullform(parse_expression("x_ /; x > 0 -> 1")) == "Rule[Condition[x_, Greater[x, 0]], 1]");
+    REQUIRE(to_fullform(parse_expression("f[_, __Integer, ___]")) == "f[_, __Integer, ___]");
+    REQUIRE(to_fullform(parse_expression("1/.5")) == "Divide[1, 0.5]");
+}
+
+TEST_CASE("Blank symbols are read as patterns", "[patterns]") {
+    auto blank = parse_blank("x__Integer");
+    REQUIRE(blank);
+    REQUIRE(blank->name == Atom("x"));
+    REQUIRE(blank->kind == BlankKind::BlankSequence);
+    REQUIRE(blank->head == Atom("Integer"));
+    REQUIRE(parse_blank("___")->kind == BlankKind::BlankNullSequence);
+    REQUIRE(parse_blank("_")->name.empty());
+    REQUIRE_FALSE(parse_blank("x"));
+    REQUIRE_FALSE(parse_blank("x____"));
+    REQUIRE_FALSE(parse_blank("x_a_b"));
+}
+
+TEST_CASE("ReplaceAll matches blanks, heads and conditions", "[patterns]") {
+    REQUIRE(eval("f[3] /. f[n_Integer] -> n^2") == "9");
+    REQUIRE(eval("{1, 2.5, a, \"s\"} /. x_Integer -> 0") == "{0, 2.5, a, \"s\"}");
+    REQUIRE(eval("{1, 2.5, a, \"s\"} /. {_Real -> r, _Symbol -> s, _String -> t}") == "{1, r, s, t}");
+    REQUIRE(eval("{1, -2, 3} /. x_ /; x < 0 -> 0") == "{1, 0, 3}");
+    REQUIRE(eval("{1, 5} /. x_Integer -> big /; x > 2") == "{1, big}");
+    REQUIRE(eval("{f[a, a], f[a, b]} /. f[x_, x_] -> same[x]") == "{same[a], f[a, b]}");
+    REQUIRE(eval("x + y /. {x -> 1, y -> 2}") == "3");
+
+    // Only the outermost match is replaced, and the first rule that matches applies
+    REQUIRE(eval("f[f[1]] /. f[x_] -> g[x]") == "g[f[1]]");
+    REQUIRE(eval("f[1] /. {f[x_] -> first, f[1] -> second}") == "first");
+
+    REQUIRE_THROWS_AS(eval("x /. 1"), std::runtime_error);
+}
+
+TEST_CASE("Sequence patterns bind runs of arguments", "[patterns]") {
+    REQUIRE(eval("g[1, 2, 3] /. g[x__] -> {x}") == "{1, 2, 3}");
+    REQUIRE(eval("g[1, 2, 3] /. g[a_, x___] -> h[x, a]") == "h[2, 3, 1]");
+    REQUIRE(eval("g[1] /. g[a_, x___] -> h[x, a]") == "h[1]");
+    REQUIRE(eval("g[] /. g[x__] -> none") == "g[]");
+    REQUIRE(eval("g[1, a, 2] /. g[x__Integer, y_] -> {y}") == "g[1, a, 2]");
+    // Shorter sequences are tried first, and a failed condition backtracks into them
+    REQUIRE(eval("g[1, 2, 3, 4] /. g[x__, y__] -> {{x}, {y}}") == "{{1}, {2, 3, 4}}");
+    REQUIRE(eval("g[1, 2, 3, 4] /. g[x__, y__] -> {{x}, {y}} /; Length[{x}] == 3") == "{{1, 2, 3}, {4}}");
+}
+
+TEST_CASE("ReplaceRepeated rewrites to a fixed point", "[patterns]") {
+    REQUIRE(eval("h[h[h[1]]] //. h[z_] -> z") == "1");
+    REQUIRE(eval("{a, b} //. {a -> b, b -> c}") == "{c, c}");
+    REQUIRE_THROWS_AS(eval("x //. x -> x + 1"), std::runtime_error);
+}
+
+TEST_CASE("Rules held in a variable are compiled once", "[patterns]") {
+    EvaluationContext ctx;
+    eval("rules = {f[0] -> zero, f[n_] -> other}", ctx);
+    const ExprPtr rules = *ctx.find_variable("rules");
+    REQUIRE(compile_rules(rules) == compile_rules(rules));
+    REQUIRE(eval("{f[0], f[1]} /. rules", ctx) == "{zero, other}");
+}
+
+TEST_CASE("The discrimination net finds only the rules that can match", "[patterns]") {
+    std::string source = "{";
+    for (int i = 0; i < 10000; ++i) source += "f[" + std::to_string(i) + "] -> " + std::to_string(i) + ", ";
+    source += "f[x_, y_] -> pair, g[___] -> any, _h -> head}";
+    EvaluationContext ctx;
+    const RuleSet rules(evaluate(parse_expression(source), ctx));
+    REQUIRE(rules.size() == 10003);
+
+    REQUIRE(rules.candidates(parse_expression("f[1234]")) == std::vector<uint32_t>{ 1234 });
+    REQUIRE(rules.candidates(parse_expression("f[1, 2]")) == std::vector<uint32_t>{ 10000 });
+    REQUIRE(rules.candidates(parse_expression("g[1, 2, 3]")) == std::vector<uint32_t>{ 10001 });
+    REQUIRE(rules.candidates(parse_expression("h[1]")) == std::vector<uint32_t>{ 10002 });
+    REQUIRE(rules.candidates(parse_expression("f[-1]")).empty());
+
+    REQUIRE(to_string(evaluate(replace_all(parse_expression("{f[7], f[9999], f[a], f[a, b]}"), rules, ctx), ctx)) ==
+            "{7, 9999, f[a], pair}");
+}
@@ -0,0 +1,110 @@
+#include "evaluator/Evaluator.hpp"
+#include "evaluator/Profiler.hpp"
+#include "expr/ExprPool.hpp"
+#include "parser/Parser.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    std::string eval(const std::string& src, EvaluationContext& ctx) { return to_string(evaluate(parse_expression(src), ctx)); }
+
+    const HeadProfile* find(const ProfileReport& report, const std::string& head) {
+        for (const auto& h : report.heads) {
+            if (h.head.str() == head) return &h;
+        }
+        return nullptr;
+    }
+
+    // The profiler is global; tests leave it off
+    struct StoppedProfiler {
+        ~StoppedProfiler() { Profiler::instance().stop(); }
+    };
+}
+
+TEST_CASE("The profiler counts calls and time per head", "[profiler]") {
+    StoppedProfiler guard;
+    EvaluationContext ctx;
+    eval("fib[n_] := If[n < 2, n, fib[n - 1] + fib[n - 2]]", ctx);
+
+    auto& profiler = Profiler::instance();
+    profiler.start();
+    REQUIRE(eval("fib[10]", ctx) == "55");
+    profiler.stop();
+    REQUIRE(eval("fib[5]", ctx) == "5");  // Not recorded
+
+    const auto report = profiler.report();
+    const HeadProfile* fib = find(report, "fib");
+    REQUIRE(fib);
+    REQUIRE(fib->calls == 177);
+    REQUIRE(fib->self <= fib->total);
+    // Recursive calls count once in the total, so the If that every fib calls stays within it
+    REQUIRE(find(report, "If")->calls == 177);
+    REQUIRE(find(report, "If")->total <= fib->total);
+    REQUIRE(std::is_sorted(report.heads.begin(), report.heads.end(),
+                           [](const HeadProfile& a, const HeadProfile& b) { return a.self > b.self; }));
+    REQUIRE(report.trace_events == 0);
+
+    std::ostringstream flat;
+    profiler.write_flat_profile(flat);
+    REQUIRE(flat.str().find("fib") != std::string::npos);
+    REQUIRE(flat.str().find("Expression pool:") != std::string::npos);
+
+    // start() clears the earlier run
+    profiler.start();
+    eval("fib[3]", ctx);
+    REQUIRE(find(profiler.report(), "fib")->calls == 5);
+}
+
+TEST_CASE("The profiler traces each call as a complete event", "[profiler]") {
+    StoppedProfiler guard;
+    EvaluationContext ctx;
+    auto& profiler = Profiler::instance();
+    profiler.start(true);
+    eval("Sin[x] + Cos[y]", ctx);
+    profiler.stop();
+
+    const auto report = profiler.report();
+    uint64_t calls = 0;
+    for (const auto& head : report.heads) calls += head.calls;
+    REQUIRE(report.trace_events == calls);
+    REQUIRE(report.dropped_events == 0);
+
+    std::ostringstream trace;
+    profiler.write_trace(trace);
+    const std::string json = trace.str();
+    REQUIRE(json.starts_with("{\"traceEvents\":["));
+    REQUIRE(json.find("\"name\":\"Sin\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"X\"") != std::string::npos);
+}
+
+TEST_CASE("Timing holds its argument and returns the time with the value", "[profiler]") {
+    EvaluationContext ctx;
+    REQUIRE(eval("Attributes[Timing]", ctx) == "{HoldAll}");
+    REQUIRE(eval("Part[Timing[Set[x, 3]], 2]", ctx) == "3");
+    REQUIRE(eval("x", ctx) == "3");
+    REQUIRE(eval("Part[AbsoluteTiming[2 + 2], 2]", ctx) == "4");
+    REQUIRE(eval("Part[AbsoluteTiming[2 + 2], 1] >= 0", ctx) == "True");
+    REQUIRE_THROWS(eval("Timing[]", ctx));
+}
+
+TEST_CASE("MemoryInUse follows the expression pool", "[profiler][pool]") {
+    EvaluationContext ctx;
+    const auto before = expr_pool_stats();
+    std::vector<ExprPtr> nodes;
+    for (int i = 0; i < 100000; ++i) nodes.push_back(make_expr<Number>(i));
+    const auto during = expr_pool_stats();
+    REQUIRE(during.bytes_in_use > before.bytes_in_use);
+    REQUIRE(during.peak_bytes_in_use >= during.bytes_in_use);
+    REQUIRE(during.bytes_in_use <= during.bytes_reserved);
+    REQUIRE(during.allocations >= before.allocations + 100000);
+
+    REQUIRE(eval("MemoryInUse[] > 0", ctx) == "True");
+    REQUIRE(eval("MaxMemoryUsed[] >= MemoryInUse[]", ctx) == "True");
+    REQUIRE_THROWS(eval("MemoryInUse[1]", ctx));
+}
@@ -326,3 +326,22 @@ TEST_CASE("Evaluator: Rational comparison operators", "[evaluator][rational][com
     }
 }
 
+
+TEST_CASE("Evaluator: Rationals past the machine integer range stay exact", "[evaluator][rational]") {
+    EvaluationContext ctx;
+    auto run = [&](const std::string& src) { return to_string(evaluate(parse_expression(src), ctx)); };
+
+    REQUIRE(run("(2/3)^100") == "1267650600228229401496703205376/515377520732011331036461129765621272702107522001");
+    REQUIRE(run("(1/3)^40 + (1/7)^30") == "22539352448357717144792050/274025758922079422971608511195740898417534449");
+    REQUIRE(run("(-3/5)^(-41)") == "-45474735088646411895751953125/36472996377170786403");
+    REQUIRE(run("(1/3)^30 * 3^30") == "1/1");
+    REQUIRE(run("(1/2)^70 * 2^70") == "1/1"); // 2^70 is a machine real past the int64 range
+    REQUIRE(run("(1/3)^40 < (1/3)^39") == "True");
+    REQUIRE(run("(0/1)^(-2)") == "Infinity");
+
+    // A long exact computation: the denominator passes 2^63 halfway through
+    auto sum = evaluate(parse_expression("Sum[(1/2)^k, {k, 1, 80}]"), ctx);
+    REQUIRE(std::holds_alternative<Rational>(*sum));
+    REQUIRE_FALSE(std::get<Rational>(*sum).denominator.is_small());
+    REQUIRE(to_string(sum) == "1208925819614629174706175/1208925819614629174706176");
+}
@@ -2,6 +2,7 @@
 #include "evaluator/Evaluator.hpp"
 #include "expr/Expr.hpp"
 #include "evaluator/EvaluationContext.hpp"
+#include "evaluator/Budget.hpp"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_all.hpp>
 #include <catch2/catch_approx.hpp>
@@ -248,6 +249,22 @@ TEST_CASE("Evaluator handles variable assignments", "[evaluator]") {
     REQUIRE(std::get<Number>(*result).value == 2);
 }
 
+TEST_CASE("Binding lookups leave the state token alone", "[evaluator]") {
+    EvaluationContext ctx;
+    ctx.variables["x"] = make_expr<Number>(1);
+    const uint64_t token = ctx.state_token();
+    REQUIRE(ctx.variables.find("x") != ctx.variables.end());
+    REQUIRE(ctx.variables.find("y") == ctx.variables.end());
+    REQUIRE(ctx.user_functions.begin() == ctx.user_functions.end());
+    REQUIRE(ctx.state_token() == token);
+
+    ctx.variables["x"] = make_expr<Number>(2);
+    REQUIRE(ctx.state_token() > token);
+    const uint64_t assigned = ctx.state_token();
+    ctx.variables.erase("x");
+    REQUIRE(ctx.state_token() > assigned);
+}
+
 //TODO: needs support for complex numbers, disable temporarily
 #if 0
 TEST_CASE("Evaluator handles division by zero as DirectedInfinity", "[evaluator][infinity]") {
@@ -600,6 +617,26 @@ TEST_CASE("Evaluator throws on mismatched list sizes", "[evaluator][lists]") {
     REQUIRE_THROWS_WITH(evaluate(expr, ctx), "List sizes must match for elementwise operation");
 }
 
+TEST_CASE("Evaluator threads binary operations over nested lists and scalars", "[evaluator][lists]") {
+    EvaluationContext ctx;
+    auto run = [&](const std::string& src) { return to_string(evaluate(parse_expression(src), ctx)); };
+
+    // A list pairs with each row of a matrix; a symbol pairs with every element
+    REQUIRE(run("{{1, 2}, {3, 4}} + {10, 20}") == "{{11, 12}, {23, 24}}");
+    REQUIRE(run("{1, 2} + x") == "{1 + x, 2 + x}");
+    REQUIRE(run("{x, {1, 2}} * {2, 3}") == "{2 * x, {3, 6}}");
+    REQUIRE(run("{1/3, 2} + {1/3, 1}") == "{2/3, 3}");
+    REQUIRE(run("{1, 2, 3}^2") == "{1, 4, 9}");
+
+    // More than two arguments thread step by step
+    REQUIRE(run("Plus[{1, 2}, {3, 4}, {5, 6}]") == "{9, 12}");
+    REQUIRE(run("Times[2, {1, 2}, {3, 4}]") == "{6, 16}");
+
+    // Lengths are checked at every level
+    REQUIRE_THROWS_WITH(evaluate(parse_expression("{{1, 2}, {3}} + {{1, 2}, {3, 4}}"), ctx),
+                        "List sizes must match for elementwise operation");
+}
+
 TEST_CASE("Evaluator handles lists with symbolic elements", "[evaluator][lists]") {
     EvaluationContext ctx;
     auto expr = parse_expression("{x, y, 3} + {1, 2, z}");
@@ -672,11 +709,152 @@ TEST_CASE("Evaluator handles division by products and negatives") {
             value = num->value;
         }
         else if (auto* rat = std::get_if<Rational>(&(*result_expr))) {
-            value = static_cast<double>(rat->numerator) / rat->denominator;
+            value = rat->value();
         }
         else {
             FAIL("Evaluator did not return a numeric result");
         }
         REQUIRE(value == Catch::Approx(c.expected));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Evaluation preserves unchanged nodes and stamps fixed points", "[evaluator]") {
+    EvaluationContext ctx;
+
+    SECTION("Atoms and lists evaluate to the input node") {
+        for (const char* src : { "42", "3/4", "\"text\"", "True", "x" }) {
+            auto expr = parse_expression(src);
+            REQUIRE(evaluate(expr, ctx) == expr);
+        }
+        // The parser's List[...] call becomes a List once; after that it is kept as is
+        auto list = evaluate(parse_expression("{1, 2, 3}"), ctx);
+        REQUIRE(std::holds_alternative<List>(*list));
+        REQUIRE(evaluate(list, ctx) == list);
+    }
+
+    SECTION("Re-evaluating a result in the same state returns it unchanged") {
+        auto result = evaluate(parse_expression("Sin[x] + y"), ctx);
+        REQUIRE(std::holds_alternative<FunctionCall>(*result));
+        REQUIRE(evaluate(result, ctx) == result);
+    }
+
+    SECTION("Changing a binding invalidates the stamp") {
+        auto result = evaluate(parse_expression("Sin[x]"), ctx);
+        REQUIRE(evaluate(result, ctx) == result);
+        ctx.variables["x"] = make_expr<Number>(0.0);
+        REQUIRE(get_number_value(evaluate(result, ctx)) == 0.0);
+    }
+
+    SECTION("Stamps from a call frame do not leak into the caller") {
+        evaluate(parse_expression("g[a_] := Sin[a] + Sin[x]"), ctx);
+        auto inner = evaluate(parse_expression("g[z]"), ctx);
+        ctx.variables["x"] = make_expr<Number>(0.0);
+        auto again = evaluate(inner, ctx);
+        REQUIRE(again != inner);
+        REQUIRE(to_string(again) == "Sin[z]");
+    }
+}
+
+TEST_CASE("Deep expression trees evaluate, normalize and free without recursion", "[evaluator][deep]") {
+    EvaluationContext ctx;
+    const int n = 50000;
+
+    SECTION("Left-nested numeric sum") {
+        ExprPtr sum = make_expr<Number>(0);
+        for (int i = 1; i <= n; ++i) {
+            sum = make_fcall(atoms::Plus, { sum, make_expr<Number>(i) });
+        }
+        auto result = evaluate(sum, ctx);
+        REQUIRE(get_number_value(result) == 1250025000.0);
+    }
+
+    SECTION("Right-nested differences are normalized") {
+        ExprPtr diff = make_expr<Number>(0);
+        for (int i = 1; i <= n; ++i) {
+            diff = make_fcall(atoms::Minus, { make_expr<Number>(1), diff });
+        }
+        auto result = evaluate(diff, ctx);
+        REQUIRE(get_number_value(result) == 0.0);
+    }
+
+    SECTION("Nested unary calls") {
+        ExprPtr nested = make_expr<Number>(0);
+        for (int i = 0; i < n; ++i) {
+            nested = make_fcall(Atom("Abs"), { make_fcall(atoms::Negate, { nested }) });
+        }
+        auto result = evaluate(nested, ctx);
+        REQUIRE(get_number_value(result) == 0.0);
+    }
+
+    SECTION("Impure trees keep evaluation order") {
+        auto expr = make_fcall(atoms::Plus, {
+            make_fcall(atoms::Set, { make_expr<Symbol>("x"), make_expr<Number>(3) }),
+            make_fcall(atoms::Times, { make_expr<Symbol>("x"), make_fcall(atoms::Plus, { make_expr<Symbol>("x"), make_expr<Number>(1) }) }) });
+        auto result = evaluate(expr, ctx);
+        REQUIRE(get_number_value(result) == 15.0);
+    }
+
+    SECTION("Deep impure trees recurse and stop at the depth limit") {
+        evaluate(parse_expression("deepId[x_] := x"), ctx);
+        ExprPtr shallow = make_expr<Number>(1);
+        for (int i = 0; i < 100; ++i) shallow = make_fcall(Atom("deepId"), { shallow });
+        REQUIRE(get_number_value(evaluate(shallow, ctx)) == 1.0);
+
+        ExprPtr nested = make_expr<Number>(1);
+        for (size_t i = 0; i <= RECURSION_LIMIT; ++i) nested = make_fcall(Atom("deepId"), { nested });
+        try {
+            evaluate(nested, ctx);
+            FAIL("The depth limit was not reached");
+        }
+        catch (const BudgetExceeded& ex) {
+            REQUIRE(ex.limit == BudgetLimit::Depth);
+        }
+    }
+}
+
+TEST_CASE("Normalization runs once per node", "[evaluator][normalize]") {
+    EvaluationContext ctx;
+    auto expr = parse_expression("{x - y, a - 2, Sin[b - c]}");
+    auto norm = normalize_expr(expr);
+    REQUIRE(norm != expr);
+    REQUIRE(std::get<FunctionCall>(*norm).normal.is_set());
+    // Already canonical: returned as-is, without another pass
+    REQUIRE(normalize_expr(norm) == norm);
+
+    // A node built on top of a normalized tree only normalizes the new root
+    auto wrapped = make_fcall(atoms::Minus, { norm, make_expr<Symbol>("z") });
+    auto rewrapped = normalize_expr(wrapped);
+    const auto& plus = std::get<FunctionCall>(*rewrapped);
+    REQUIRE(plus.head == atoms::Plus);
+    REQUIRE(plus.args[0] == norm);
+
+    // The internal entry point agrees with the public one
+    auto internal = make_fcall(atoms::Minus, { make_expr<Number>(5), make_expr<Number>(3) });
+    REQUIRE(get_number_value(evaluate_normalized(internal, ctx)) == 2.0);
+    REQUIRE(get_number_value(evaluate(internal, ctx)) == 2.0);
+}
+
+TEST_CASE("Plus and Times are flat, orderless and combine like terms", "[evaluator][orderless]") {
+    EvaluationContext ctx;
+    auto eval_str = [&](const std::string& s) { return to_string(evaluate(parse_expression(s), ctx)); };
+
+    REQUIRE(eval_str("y + x + 2 + x") == "2 + 2 * x + y");
+    REQUIRE(eval_str("x * y * x * 3") == "3 * x^2 * y");
+    REQUIRE(eval_str("1/2 + x + 1/3 - x") == "5/6");
+    REQUIRE(eval_str("2*x^2 + x + x^2*3") == "x + 5 * x^2");
+    REQUIRE(eval_str("a*b + b*a") == "2 * a * b");
+    REQUIRE(eval_str("{1, 2} + {3, 4} + {5, 6}") == "{9, 12}");
+    REQUIRE(expr_equal(evaluate(parse_expression("c + b + a"), ctx), evaluate(parse_expression("a + c + b"), ctx)));
+
+    SECTION("A long sum is one flat call") {
+        const int n = 100000;
+        ExprPtr sum = make_expr<Symbol>("x0");
+        for (int i = 1; i < n; ++i) {
+            sum = make_fcall(atoms::Plus, { sum, make_expr<Symbol>("x" + std::to_string(i % 1000)) });
+        }
+        auto result = evaluate(sum, ctx);
+        const auto& plus = std::get<FunctionCall>(*result);
+        REQUIRE(plus.head == atoms::Plus);
+        REQUIRE(plus.args.size() == 1000);
+        REQUIRE(to_string(plus.args[0]) == "100 * x0");
+    }
+}
@@ -0,0 +1,78 @@
+#include "parser/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "ParserTestHelper.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace aleph3;
+
+namespace {
+    std::vector<TokenKind> kinds(std::string_view source) {
+        std::vector<TokenKind> out;
+        for (const auto& token : Lexer::tokenize(source)) out.push_back(token.kind);
+        return out;
+    }
+}
+
+TEST_CASE("Lexer splits operators longest match first") {
+    using K = TokenKind;
+    REQUIRE(kinds("a->b") == std::vector<K>{ K::Symbol, K::Rule, K::Symbol, K::End });
+    REQUIRE(kinds("a - >b") == std::vector<K>{ K::Symbol, K::Minus, K::Greater, K::Symbol, K::End });
+    REQUIRE(kinds("== != <= >= < > || && <>") ==
+            std::vector<K>{ K::Equal, K::NotEqual, K::LessEqual, K::GreaterEqual, K::Less, K::Greater, K::Or, K::And,
+                            K::StringJoin, K::End });
+    REQUIRE(kinds("f[x_] := x = 1") ==
+            std::vector<K>{ K::Symbol, K::LeftBracket, K::Symbol, K::RightBracket, K::SetDelayed, K::Symbol, K::Set,
+                            K::Number, K::End });
+    // /. before a digit is a division by a number such as .5
+    REQUIRE(kinds("a /. b //. c /; d/.5") ==
+            std::vector<K>{ K::Symbol, K::ReplaceAll, K::Symbol, K::ReplaceRepeated, K::Symbol, K::Condition, K::Symbol,
+                            K::Divide, K::Number, K::End });
+    REQUIRE(kinds("! | & ;") == std::vector<K>{ K::Unknown, K::Unknown, K::Unknown, K::Semicolon, K::End });
+    // Comments nest and are skipped like whitespace
+    REQUIRE(kinds("a (* b (* c *) d *) * e (* open") == std::vector<K>{ K::Symbol, K::Times, K::Symbol, K::End });
+    REQUIRE(kinds("") == std::vector<K>{ K::End });
+}
+
+TEST_CASE("Lexer tokens point into the source") {
+    const std::string source = "  foo_1 + 2.5*\"a b\"";
+    const auto tokens = Lexer::tokenize(source);
+    REQUIRE(tokens.size() == 6);
+    REQUIRE(tokens[0].text == "foo_1");
+    REQUIRE(tokens[0].text.data() == source.data() + 2);
+    REQUIRE(tokens[2].kind == TokenKind::Number);
+    REQUIRE(tokens[2].text == "2.5");
+    REQUIRE(tokens[4].kind == TokenKind::String);
+    REQUIRE(tokens[4].text == "a b");
+    REQUIRE(tokens[5].text.data() == source.data() + source.size());
+
+    // '_' starts no longer symbol; an open quote runs to the end
+    REQUIRE(Lexer::tokenize("_foo")[0].text == "_");
+    REQUIRE(Lexer::tokenize("\"abc")[0].kind == TokenKind::UnterminatedString);
+}
+
+TEST_CASE("Lexer keeps Unicode letters inside symbols") {
+    // alpha = U+03B1, UTF-8: CE B1
+    std::string alpha = "\xCE\xB1";
+    const auto tokens = Lexer::tokenize(alpha + "x " + alpha);
+    REQUIRE(tokens.size() == 3);
+    REQUIRE(tokens[0].kind == TokenKind::Symbol);
+    REQUIRE(tokens[0].text == alpha + "x");
+    REQUIRE(tokens[1].text == alpha);
+
+    // A lone continuation byte is not a letter
+    REQUIRE(Lexer::tokenize("x\xB1")[0].kind == TokenKind::InvalidUtf8);
+    REQUIRE_THROWS_AS(parse_expression("1 + x\xB1"), std::runtime_error);
+}
+
+TEST_CASE("Parser matches tokens after advancing") {
+    Parser p("(a, b)");
+    REQUIRE(ParserTestHelper::match(p, TokenKind::LeftParen));
+    REQUIRE_FALSE(ParserTestHelper::match(p, TokenKind::Comma));
+    REQUIRE(ParserTestHelper::parse_identifier(p) == "a");
+    REQUIRE(ParserTestHelper::match(p, TokenKind::Comma));
+    REQUIRE_FALSE(ParserTestHelper::match(p, TokenKind::Comma)); // already advanced
+    REQUIRE(ParserTestHelper::parse_identifier(p) == "b");
+    REQUIRE(ParserTestHelper::match(p, TokenKind::RightParen));
+    REQUIRE_FALSE(ParserTestHelper::match(p, TokenKind::RightParen));
+}
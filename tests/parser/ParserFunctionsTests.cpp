@@ -451,3 +451,21 @@ TEST_CASE("Parser handles round(floor(ceil(2.9)))", "[parser][functions]") {
     REQUIRE(std::get<Number>(*inner->args[0]).value == 2.9);
 }
 
+
+TEST_CASE("Parser reads specific-value and memo definitions as Set", "[parser]") {
+    auto value = parse_expression("f[0] = 1");
+    REQUIRE(std::holds_alternative<FunctionCall>(*value));
+    const auto& set = std::get<FunctionCall>(*value);
+    REQUIRE(set.head == "Set");
+    REQUIRE(std::get<FunctionCall>(*set.args[0]).head == "f");
+    REQUIRE(std::get<Number>(*set.args[1]).value == 1.0);
+
+    auto memo = parse_expression("f[n_] := f[n] = n + 1");
+    REQUIRE(std::holds_alternative<FunctionDefinition>(*memo));
+    const auto& body = std::get<FunctionCall>(*std::get<FunctionDefinition>(*memo).body);
+    REQUIRE(body.head == "Set");
+    REQUIRE(std::get<FunctionCall>(*body.args[1]).head == "Plus");
+
+    // Comparisons are not assignments
+    REQUIRE(std::get<FunctionCall>(*parse_expression("f[0] == 1")).head == "Equal");
+}
@@ -6,12 +6,12 @@ namespace aleph3 {
     class ParserTestHelper {
     public:
         static std::string parse_identifier(Parser& parser) {
-            return parser.parse_identifier();
+            return std::string(parser.parse_identifier());
         }
         static ExprPtr parse_symbol(Parser& parser) {
             return parser.parse_symbol();
         }
-        static bool match(Parser& parser, char expected) {
+        static bool match(Parser& parser, TokenKind expected) {
             return parser.match(expected);
         }
     };
@@ -781,3 +781,44 @@ TEST_CASE("Parser handles division with negative numerators and products in deno
         }
     }
 }
+
+TEST_CASE("Parser leaves quotients that are not integer ratios to Divide", "[parser]") {
+    REQUIRE(to_string(parse_expression("2/x")) == "2 / x");
+    REQUIRE(to_string(parse_expression("2.5/3")) == "2.5 / 3");
+    REQUIRE(to_string(parse_expression("3/-4")) == "3/-4");
+    REQUIRE(to_string(parse_expression("If [x, 1, 2]")) == "If[x, 1, 2]");
+}
+
+TEST_CASE("Parser builds flat sums and products from chains", "[parser]") {
+    auto sum = parse_expression("1 + x + x^2 - y + z");
+    const auto& minus = std::get<FunctionCall>(*std::get<FunctionCall>(*sum).args[0]);
+    REQUIRE(std::get<FunctionCall>(*sum).head == "Plus");
+    REQUIRE(minus.head == "Minus");
+    REQUIRE(std::get<FunctionCall>(*minus.args[0]).args.size() == 3);
+
+    // Implicit and explicit multiplication join one product; parentheses keep their own node
+    auto product = parse_expression("2 x y * z");
+    REQUIRE(std::get<FunctionCall>(*product).args.size() == 4);
+    auto grouped = parse_expression("(a + b) + c");
+    REQUIRE(std::get<FunctionCall>(*grouped).args.size() == 2);
+}
+
+TEST_CASE("Parser handles long and deeply nested input", "[parser]") {
+    std::string sum = "x";
+    for (int k = 1; k < 200000; ++k) sum += " + " + std::to_string(k);
+    REQUIRE(std::get<FunctionCall>(*parse_expression(sum)).args.size() == 200000);
+
+    const int depth = 100000;
+    auto parens = parse_expression(std::string(depth, '(') + "x" + std::string(depth, ')'));
+    REQUIRE(to_string(parens) == "x");
+
+    std::string calls;
+    for (int k = 0; k < depth; ++k) calls += "f[";
+    calls += "-x" + std::string(depth, ']');
+    auto call = parse_expression(calls);
+    for (int k = 0; k < depth; ++k) call = std::get<FunctionCall>(*call).args[0];
+    REQUIRE(std::get<FunctionCall>(*call).head == "Negate");
+
+    auto list = parse_expression(std::string(depth, '{') + std::string(depth, '}'));
+    REQUIRE(std::get<FunctionCall>(*list).head == "List");
+}
@@ -0,0 +1,54 @@
+#include "parser/Statements.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+using namespace aleph3;
+
+namespace {
+    std::vector<std::string> texts(std::string_view source) {
+        std::vector<std::string> out;
+        for (const auto& s : split_statements(source)) out.emplace_back(s.text);
+        return out;
+    }
+}
+
+TEST_CASE("Statements end at semicolons and complete lines", "[parser][statements]") {
+    const auto statements = split_statements("x = 1; y = 2\nf[x_] := x^2\n\n  f[y]");
+    REQUIRE(statements.size() == 4);
+    REQUIRE(statements[0].text == "x = 1");
+    REQUIRE(statements[0].silent);
+    REQUIRE(statements[1].text == "y = 2");
+    REQUIRE_FALSE(statements[1].silent);
+    REQUIRE(statements[2].line == 2);
+    REQUIRE(statements[3].text == "f[y]");
+    REQUIRE(statements[3].line == 4);
+
+    REQUIRE(texts(";;\n  ;").empty());
+    REQUIRE(texts("") == std::vector<std::string>{});
+}
+
+TEST_CASE("Statements continue over open brackets and trailing operators", "[parser][statements]") {
+    REQUIRE(texts("f[x_] := x +\n  1\ng[{1,\n 2}]") == std::vector<std::string>{ "f[x_] := x +\n  1", "g[{1,\n 2}]" });
+    REQUIRE(texts("a =\n b\nc") == std::vector<std::string>{ "a =\n b", "c" });
+    // Brackets and ';' inside strings and comments do not count
+    REQUIRE(texts("\"[;\" <> x (* ; ( *)\ny") == std::vector<std::string>{ "\"[;\" <> x", "y" });
+    REQUIRE(texts("(* a (* nested *) comment *) 1 + 2") == std::vector<std::string>{ "1 + 2" });
+}
+
+TEST_CASE("Statement batches parse in parallel", "[parser][statements]") {
+    std::string source;
+    for (int k = 0; k < 1000; ++k) source += k == 500 ? "f[\n;" : "f[" + std::to_string(k) + "] + x\n";
+    const auto statements = split_statements(source);
+    const auto parsed = parse_statements(statements, 10, statements.size());
+    REQUIRE(parsed.size() == statements.size() - 10);
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        if (i + 10 == 500) {
+            REQUIRE(parsed[i].error);
+            REQUIRE_FALSE(parsed[i].expr);
+        }
+        else {
+            REQUIRE(to_string(parsed[i].expr) == to_string(parse_expression(statements[i + 10].text)));
+        }
+    }
+}